@@ -0,0 +1,677 @@
+/**
+ * bench_load.c - curlrq 定速负载测试
+ *
+ * 在进程内启动本机 HTTP 替身服务器（tinycsocket 的 TcsServer），响应延迟、
+ * 响应体大小与错误注入比例可配置；按固定速率开环提交请求（不等前一个完成），
+ * 不需要网络，用于发现引擎调度与内存行为的回归。
+ *
+ * 替身服务器:
+ *   h1   HTTP/1.1 keep-alive，每遇到一个 "\r\n\r\n" 回一个响应
+ *   h2   明文 HTTP/2（prior knowledge），不解析 HPACK，每个请求结束的 HEADERS 回一个响应；
+ *        不做发送方流量控制，依赖 libcurl 通告的大窗口，body 不宜超过 1MB；
+ *        libcurl 7.88 复用明文 HTTP/2 连接会报 CURLE_HTTP2（见 curlrq_set_http2），h2 档位需要更新的 libcurl
+ *   有延迟时由单独的线程按到期时间发出响应，不占用服务器 Worker
+ *   注入的错误回 500，单独计数，不算失败
+ *
+ * 每个速率档位输出:
+ *   rate     目标速率与实际完成速率，completed/injected/failed 计数
+ *   latency  p50 / p99 / p999 / 最大值（毫秒），从计划发送时间算起，客户端排队也计入
+ *   cpu      每请求的进程 CPU 时间（微秒），括号内为其中替身服务器的部分
+ *   engine   区间内新建连接数与复用连接的传输数（curlrq_stats）
+ *   rss      档位结束时的 RSS 与进程峰值（MB）
+ *
+ * 编译:
+ *   cc -std=gnu99 -O2 -o bench_load bench_load.c curlrq.c -lcurl -lpthread
+ * 运行:
+ *   ./bench_load [proto=h1] [rates=1000,5000,20000] [seconds=3] [latency_ms=1] [body=1024] [errors=0]
+ *                [workers=2] [max_concurrent=256] [max_p99_ms=0] [max_rss_mb=0]
+ *   errors 为百分比，可带小数；max_p99_ms / max_rss_mb 不为 0 时任一档位超出即以 2 退出，
+ *   请求失败以 1 退出，可直接用作回归检查。
+ */
+
+#define TINYCSOCKET_IMPLEMENTATION
+#include "../tcs/tinycsocket.h"
+
+#include "curlrq.h"
+
+#include <curl/curl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#define H2_FRAME_MAX    16384   /* 未改 SETTINGS_MAX_FRAME_SIZE，双方都用默认值 */
+#define H2_PREFACE_LEN  24
+#define MAX_RATES       16
+
+static const char H2_PREFACE[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+static struct {
+    int         h2;
+    long long   latency_ns;
+    size_t      body;
+    double      errors;         /* 百分比 */
+} cfg;
+
+static char    *h1_ok;          /* 预先拼好的完整 HTTP/1.1 响应 */
+static char    *h1_error;
+static size_t   h1_ok_len;
+static size_t   h1_error_len;
+static char    *body_bytes;
+
+static unsigned long long served;       /* 替身服务器收到的请求数，用于错误注入 */
+static long long          server_cpu_ns; /* 替身服务器线程处理请求耗用的 CPU */
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static long long thread_cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static long long process_cpu_ns(void)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ((long long)ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000LL +
+           ((long long)ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000LL;
+}
+
+/* 当前 RSS 与峰值（VmHWM），单位 MB */
+static void read_rss(double *rss, double *peak)
+{
+    char line[128];
+    long kb;
+    FILE *f = fopen("/proc/self/status", "r");
+
+    *rss = *peak = 0;
+    if (!f) return;
+    while (fgets(line, sizeof line, f)) {
+        if (sscanf(line, "VmRSS: %ld kB", &kb) == 1) *rss = kb / 1024.0;
+        else if (sscanf(line, "VmHWM: %ld kB", &kb) == 1) *peak = kb / 1024.0;
+    }
+    fclose(f);
+}
+
+/* ------------------------------------------------------------------ */
+/*  HTTP 替身服务器：连接                                              */
+/* ------------------------------------------------------------------ */
+
+/*
+ * 连接由服务器 Worker 与延迟线程共享：Worker 持有一个引用，每个待发响应各持有一个，
+ * 最后一个引用释放时才 free。写 socket 与 closed 都在 mutex 下，
+ * on_close 返回后服务器才关闭 socket，延迟线程不会写到已关闭的描述符。
+ */
+typedef struct {
+    pthread_mutex_t mutex;
+    int             refs;
+    int             closed;
+    TcsSocket       socket;
+    size_t          matched;        /* h1: 已匹配的 "\r\n\r\n" 字符数 */
+    int             preface;        /* h2: 已收到客户端连接前言 */
+    uint32_t        cont_stream;    /* h2: 等待 CONTINUATION 结束的请求 stream，0=无 */
+    size_t          len;            /* h2: buf 中未处理的字节数 */
+    uint8_t         buf[9 + H2_FRAME_MAX];
+} conn_t;
+
+static void conn_release(conn_t *conn)
+{
+    int refs;
+
+    pthread_mutex_lock(&conn->mutex);
+    refs = --conn->refs;
+    pthread_mutex_unlock(&conn->mutex);
+    if (refs == 0) {
+        pthread_mutex_destroy(&conn->mutex);
+        free(conn);
+    }
+}
+
+/* 写失败的连接标记为已关闭，之后的响应直接丢弃，由 Worker 在读到错误时关闭 */
+static int conn_send(conn_t *conn, const void *data, size_t len)
+{
+    int ok = 0;
+
+    pthread_mutex_lock(&conn->mutex);
+    if (!conn->closed) {
+        ok = tcs_send(conn->socket, (const uint8_t *)data, len, TCS_MSG_SENDALL, NULL) == TCS_SUCCESS;
+        if (!ok) conn->closed = 1;
+    }
+    pthread_mutex_unlock(&conn->mutex);
+    return ok;
+}
+
+static void h2_frame_header(uint8_t *p, size_t len, int type, int flags, uint32_t stream)
+{
+    p[0] = (uint8_t)(len >> 16);
+    p[1] = (uint8_t)(len >> 8);
+    p[2] = (uint8_t)len;
+    p[3] = (uint8_t)type;
+    p[4] = (uint8_t)flags;
+    p[5] = (uint8_t)(stream >> 24 & 0x7f);
+    p[6] = (uint8_t)(stream >> 16);
+    p[7] = (uint8_t)(stream >> 8);
+    p[8] = (uint8_t)stream;
+}
+
+/*
+ * HTTP/2 响应：HEADERS（:status 用静态表索引 8=200、14=500，
+ * content-length 用静态表第 28 项作名字的不索引字面量）加若干 DATA 帧。
+ */
+static int h2_respond(conn_t *conn, uint32_t stream, int status)
+{
+    size_t body = status == 200 ? cfg.body : 0;
+    size_t frames = (body + H2_FRAME_MAX - 1) / H2_FRAME_MAX;
+    uint8_t *out = (uint8_t *)malloc(9 + 32 + frames * 9 + body);
+    uint8_t *p;
+    char digits[24];
+    int n, ok;
+
+    if (!out) return 0;
+    n = snprintf(digits, sizeof digits, "%zu", body);
+    p = out + 9;
+    *p++ = status == 200 ? 0x88 : 0x8e;
+    *p++ = 0x0f;
+    *p++ = 28 - 15;
+    *p++ = (uint8_t)n;
+    memcpy(p, digits, (size_t)n);
+    p += n;
+    h2_frame_header(out, (size_t)(p - out - 9), 1, 0x4 | (body ? 0 : 0x1), stream);
+    for (size_t off = 0; off < body; off += H2_FRAME_MAX) {
+        size_t chunk = body - off < H2_FRAME_MAX ? body - off : H2_FRAME_MAX;
+        h2_frame_header(p, chunk, 0, off + chunk == body ? 0x1 : 0, stream);
+        memcpy(p + 9, body_bytes + off, chunk);
+        p += 9 + chunk;
+    }
+    ok = conn_send(conn, out, (size_t)(p - out));
+    free(out);
+    return ok;
+}
+
+static int send_response(conn_t *conn, uint32_t stream, int status)
+{
+    if (cfg.h2) return h2_respond(conn, stream, status);
+    return status == 200 ? conn_send(conn, h1_ok, h1_ok_len) : conn_send(conn, h1_error, h1_error_len);
+}
+
+/* ------------------------------------------------------------------ */
+/*  HTTP 替身服务器：延迟响应                                          */
+/* ------------------------------------------------------------------ */
+
+/* 同一连接的响应到期时间随到达顺序递增，seq 保证到期时间相同时也按顺序发出 */
+typedef struct {
+    long long           due_ns;
+    unsigned long long  seq;
+    conn_t             *conn;
+    uint32_t            stream;
+    int                 status;
+} delayed_t;
+
+static struct {
+    pthread_mutex_t     mutex;
+    pthread_cond_t      cond;
+    delayed_t          *heap;
+    size_t              len;
+    size_t              cap;
+    unsigned long long  seq;
+    int                 stop;
+} delay;
+
+static int delayed_before(const delayed_t *a, const delayed_t *b)
+{
+    return a->due_ns != b->due_ns ? a->due_ns < b->due_ns : a->seq < b->seq;
+}
+
+static int delay_push(conn_t *conn, uint32_t stream, int status)
+{
+    delayed_t item;
+    size_t i;
+
+    pthread_mutex_lock(&delay.mutex);
+    if (delay.len == delay.cap) {
+        size_t cap = delay.cap ? delay.cap * 2 : 1024;
+        delayed_t *heap = (delayed_t *)realloc(delay.heap, cap * sizeof(*heap));
+        if (!heap) {
+            pthread_mutex_unlock(&delay.mutex);
+            return 0;
+        }
+        delay.heap = heap;
+        delay.cap  = cap;
+    }
+    pthread_mutex_lock(&conn->mutex);
+    conn->refs++;
+    pthread_mutex_unlock(&conn->mutex);
+
+    item.due_ns = now_ns() + cfg.latency_ns;
+    item.seq    = delay.seq++;
+    item.conn   = conn;
+    item.stream = stream;
+    item.status = status;
+    for (i = delay.len++; i > 0 && delayed_before(&item, &delay.heap[(i - 1) / 2]); i = (i - 1) / 2)
+        delay.heap[i] = delay.heap[(i - 1) / 2];
+    delay.heap[i] = item;
+    if (i == 0) pthread_cond_signal(&delay.cond);
+    pthread_mutex_unlock(&delay.mutex);
+    return 1;
+}
+
+static delayed_t delay_pop(void)
+{
+    delayed_t top = delay.heap[0];
+    delayed_t last = delay.heap[--delay.len];
+    size_t i = 0;
+
+    for (;;) {
+        size_t child = i * 2 + 1;
+        if (child >= delay.len) break;
+        if (child + 1 < delay.len && delayed_before(&delay.heap[child + 1], &delay.heap[child])) child++;
+        if (!delayed_before(&delay.heap[child], &last)) break;
+        delay.heap[i] = delay.heap[child];
+        i = child;
+    }
+    if (delay.len) delay.heap[i] = last;
+    return top;
+}
+
+static void *delay_thread(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&delay.mutex);
+    while (!delay.stop || delay.len) {
+        if (delay.len == 0) {
+            pthread_cond_wait(&delay.cond, &delay.mutex);
+        } else if (!delay.stop && delay.heap[0].due_ns > now_ns()) {
+            struct timespec ts;
+            ts.tv_sec  = (time_t)(delay.heap[0].due_ns / 1000000000LL);
+            ts.tv_nsec = (long)(delay.heap[0].due_ns % 1000000000LL);
+            pthread_cond_timedwait(&delay.cond, &delay.mutex, &ts);
+        } else {
+            delayed_t item = delay_pop();
+            int stop = delay.stop;
+            pthread_mutex_unlock(&delay.mutex);
+            if (!stop) {
+                long long t0 = thread_cpu_ns();
+                send_response(item.conn, item.stream, item.status);
+                __atomic_add_fetch(&server_cpu_ns, thread_cpu_ns() - t0, __ATOMIC_RELAXED);
+            }
+            conn_release(item.conn);
+            pthread_mutex_lock(&delay.mutex);
+        }
+    }
+    pthread_mutex_unlock(&delay.mutex);
+    return NULL;
+}
+
+/* ------------------------------------------------------------------ */
+/*  HTTP 替身服务器：请求解析                                          */
+/* ------------------------------------------------------------------ */
+
+static int respond(conn_t *conn, uint32_t stream)
+{
+    unsigned long long n = __atomic_add_fetch(&served, 1, __ATOMIC_RELAXED);
+    int status = 200;
+
+    /* 用序号的乘法散列决定是否注入错误，错误均匀分散而不是连成一段 */
+    if (cfg.errors > 0 && (double)((n * 2654435761ULL >> 8) % 10000) < cfg.errors * 100) status = 500;
+    if (cfg.latency_ns > 0) return delay_push(conn, stream, status);
+    return send_response(conn, stream, status);
+}
+
+static bool h1_readable(conn_t *conn)
+{
+    static const char end[] = "\r\n\r\n";
+    uint8_t buffer[8192];
+    size_t received = 0;
+
+    if (tcs_receive(conn->socket, buffer, sizeof buffer, TCS_FLAG_NONE, &received) != TCS_SUCCESS ||
+        received == 0)
+        return false;
+    for (size_t i = 0; i < received; i++) {
+        if (buffer[i] == (uint8_t)end[conn->matched]) {
+            if (++conn->matched == 4) {
+                conn->matched = 0;
+                if (!respond(conn, 0)) return false;
+            }
+        } else {
+            conn->matched = buffer[i] == '\r' ? 1 : 0;
+        }
+    }
+    return true;
+}
+
+/*
+ * 只处理压测用得到的帧：SETTINGS 与 PING 回 ACK，请求结束（END_STREAM）的 HEADERS
+ * 在头块结束时回响应，GOAWAY 关闭连接，其余（WINDOW_UPDATE、PRIORITY 等）忽略。
+ */
+static bool h2_readable(conn_t *conn)
+{
+    size_t received = 0, off = 0;
+
+    if (tcs_receive(conn->socket, conn->buf + conn->len, sizeof conn->buf - conn->len, TCS_FLAG_NONE,
+                    &received) != TCS_SUCCESS ||
+        received == 0)
+        return false;
+    conn->len += received;
+
+    if (!conn->preface) {
+        if (conn->len < H2_PREFACE_LEN) return true;
+        if (memcmp(conn->buf, H2_PREFACE, H2_PREFACE_LEN) != 0) return false;
+        conn->preface = 1;
+        off = H2_PREFACE_LEN;
+    }
+    while (conn->len - off >= 9) {
+        const uint8_t *f = conn->buf + off;
+        size_t len = (size_t)f[0] << 16 | (size_t)f[1] << 8 | f[2];
+        int type = f[3], flags = f[4];
+        uint32_t stream = ((uint32_t)f[5] << 24 | (uint32_t)f[6] << 16 | (uint32_t)f[7] << 8 | f[8]) & 0x7fffffff;
+
+        if (len > H2_FRAME_MAX) return false;
+        if (conn->len - off < 9 + len) break;
+        off += 9 + len;
+
+        if (type == 4 && !(flags & 0x1)) {              /* SETTINGS */
+            uint8_t ack[9];
+            h2_frame_header(ack, 0, 4, 0x1, 0);
+            if (!conn_send(conn, ack, sizeof ack)) return false;
+        } else if (type == 6 && !(flags & 0x1) && len == 8) { /* PING */
+            uint8_t pong[17];
+            h2_frame_header(pong, 8, 6, 0x1, 0);
+            memcpy(pong + 9, f + 9, 8);
+            if (!conn_send(conn, pong, sizeof pong)) return false;
+        } else if (type == 1) {                         /* HEADERS */
+            if (!(flags & 0x1)) continue;
+            if (!(flags & 0x4)) {
+                conn->cont_stream = stream;
+                continue;
+            }
+            if (!respond(conn, stream)) return false;
+        } else if (type == 9 && (flags & 0x4) && conn->cont_stream == stream) { /* CONTINUATION */
+            conn->cont_stream = 0;
+            if (!respond(conn, stream)) return false;
+        } else if (type == 7) {                         /* GOAWAY */
+            return false;
+        }
+    }
+    conn->len -= off;
+    memmove(conn->buf, conn->buf + off, conn->len);
+    return true;
+}
+
+static bool on_connect(struct TcsServer *server, struct TcsServerConnection *connection)
+{
+    conn_t *conn = (conn_t *)calloc(1, sizeof(*conn));
+    (void)server;
+
+    if (!conn) return false;
+    pthread_mutex_init(&conn->mutex, NULL);
+    conn->refs   = 1;
+    conn->socket = connection->socket;
+    connection->user_data = conn;
+    if (cfg.h2) {
+        /* 服务器连接前言：空 SETTINGS，全部使用默认值 */
+        uint8_t settings[9];
+        h2_frame_header(settings, 0, 4, 0, 0);
+        return conn_send(conn, settings, sizeof settings);
+    }
+    return true;
+}
+
+static bool on_readable(struct TcsServer *server, struct TcsServerConnection *connection)
+{
+    conn_t *conn = (conn_t *)connection->user_data;
+    long long t0 = thread_cpu_ns();
+    bool ok;
+    (void)server;
+
+    ok = cfg.h2 ? h2_readable(conn) : h1_readable(conn);
+    __atomic_add_fetch(&server_cpu_ns, thread_cpu_ns() - t0, __ATOMIC_RELAXED);
+    return ok;
+}
+
+static void on_close(struct TcsServer *server, struct TcsServerConnection *connection)
+{
+    conn_t *conn = (conn_t *)connection->user_data;
+    (void)server;
+
+    if (!conn) return;
+    pthread_mutex_lock(&conn->mutex);
+    conn->closed = 1;
+    pthread_mutex_unlock(&conn->mutex);
+    conn_release(conn);
+}
+
+static char *h1_build(int status, size_t body, size_t *len)
+{
+    char head[128];
+    int n = snprintf(head, sizeof head, "HTTP/1.1 %d %s\r\nContent-Length: %zu\r\nContent-Type: text/plain\r\n\r\n",
+                     status, status == 200 ? "OK" : "Internal Server Error", body);
+    char *out = (char *)malloc((size_t)n + body);
+
+    if (!out) return NULL;
+    memcpy(out, head, (size_t)n);
+    memcpy(out + n, body_bytes, body);
+    *len = (size_t)n + body;
+    return out;
+}
+
+/* ------------------------------------------------------------------ */
+/*  定速提交                                                           */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+    long long   scheduled_ns;   /* 计划发送时间 */
+    long long   done_ns;        /* 回调时间，0=尚未完成 */
+} slot_t;
+
+static int completed;
+static int injected;
+static int failed;
+
+static void on_done(curlrq_response_t *resp, void *user_data)
+{
+    slot_t *slot = (slot_t *)user_data;
+
+    slot->done_ns = now_ns();
+    if (resp->curl_code == 0 && resp->http_code == 200)
+        __atomic_add_fetch(&completed, 1, __ATOMIC_RELAXED);
+    else if (resp->curl_code == 0 && resp->http_code == 500)
+        __atomic_add_fetch(&injected, 1, __ATOMIC_RELAXED);
+    else
+        __atomic_add_fetch(&failed, 1, __ATOMIC_RELAXED);
+    curlrq_response_free(resp);
+}
+
+static int cmp_ll(const void *a, const void *b)
+{
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+    return x < y ? -1 : x > y;
+}
+
+/*
+ * 按 rate 匀速提交 rate*seconds 个请求。落后于计划时不补睡，
+ * 立即提交所有已到期的请求，延迟仍从计划时间算起（避免协调遗漏）。
+ */
+static int run_step(curlrq_engine_t *engine, const char *url, int rate, double seconds, double max_p99_ms,
+                    double max_rss_mb)
+{
+    int total = (int)(rate * seconds);
+    slot_t *slots;
+    long long *latency;
+    long long t0, t_end = 0, cpu0, server0, cpu, server;
+    curlrq_stats_t st0, st1;
+    curlrq_request_t req;
+    int n = 0, rc = 0;
+    double p99, rss, peak;
+
+    if (total < 1) total = 1;
+    slots   = (slot_t *)calloc((size_t)total, sizeof(*slots));
+    latency = (long long *)calloc((size_t)total, sizeof(*latency));
+    if (!slots || !latency) {
+        printf("out of memory\n");
+        exit(1);
+    }
+    completed = injected = failed = 0;
+    memset(&req, 0, sizeof(req));
+    req.url = url;
+    req.timeout_ms = 30000;
+
+    curlrq_stats(engine, &st0);
+    cpu0    = process_cpu_ns();
+    server0 = __atomic_load_n(&server_cpu_ns, __ATOMIC_RELAXED);
+    t0 = now_ns();
+    for (int i = 0; i < total; i++) {
+        long long due = t0 + (long long)((double)i * 1e9 / rate);
+        if (now_ns() < due) {
+            struct timespec ts;
+            ts.tv_sec  = (time_t)(due / 1000000000LL);
+            ts.tv_nsec = (long)(due % 1000000000LL);
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        }
+        slots[i].scheduled_ns = due;
+        req.user_data = &slots[i];
+        if (curlrq_add(engine, &req, on_done) != 0) __atomic_add_fetch(&failed, 1, __ATOMIC_RELAXED);
+    }
+    curlrq_wait(engine);
+    cpu    = process_cpu_ns() - cpu0;
+    server = __atomic_load_n(&server_cpu_ns, __ATOMIC_RELAXED) - server0;
+    curlrq_stats(engine, &st1);
+
+    for (int i = 0; i < total; i++) {
+        if (!slots[i].done_ns) continue;
+        latency[n++] = slots[i].done_ns - slots[i].scheduled_ns;
+        if (slots[i].done_ns > t_end) t_end = slots[i].done_ns;
+    }
+    qsort(latency, (size_t)n, sizeof(*latency), cmp_ll);
+    p99 = n ? (double)latency[(size_t)n * 99 / 100] / 1e6 : 0;
+    read_rss(&rss, &peak);
+
+    printf("rate    %d req/s -> %.0f req/s  completed=%d injected=%d failed=%d\n", rate,
+           n && t_end > t0 ? n / ((double)(t_end - t0) / 1e9) : 0.0, completed, injected, failed);
+    if (n)
+        printf("latency p50 %.3f ms  p99 %.3f ms  p999 %.3f ms  max %.3f ms\n",
+               (double)latency[(size_t)n / 2] / 1e6, p99, (double)latency[(size_t)n * 999 / 1000] / 1e6,
+               (double)latency[n - 1] / 1e6);
+    printf("cpu     %.2f us/req  (server %.2f us/req)\n", (double)cpu / 1e3 / total, (double)server / 1e3 / total);
+    printf("engine  connects=%llu reused=%llu\n", st1.connects - st0.connects, st1.reused - st0.reused);
+    printf("rss     %.1f MB  peak %.1f MB\n", rss, peak);
+
+    if (failed) rc = 1;
+    if ((max_p99_ms > 0 && p99 > max_p99_ms) || (max_rss_mb > 0 && rss > max_rss_mb)) {
+        printf("FAIL    over limit (max_p99_ms=%g max_rss_mb=%g)\n", max_p99_ms, max_rss_mb);
+        if (!rc) rc = 2;
+    }
+    free(latency);
+    free(slots);
+    return rc;
+}
+
+static const char *arg_value(int argc, char **argv, const char *key, const char *fallback)
+{
+    size_t len = strlen(key);
+    for (int i = 1; i < argc; i++)
+        if (strncmp(argv[i], key, len) == 0 && argv[i][len] == '=') return argv[i] + len + 1;
+    return fallback;
+}
+
+int main(int argc, char **argv)
+{
+    const char *proto    = arg_value(argc, argv, "proto", "h1");
+    const char *rate_arg = arg_value(argc, argv, "rates", "1000,5000,20000");
+    double seconds       = atof(arg_value(argc, argv, "seconds", "3"));
+    double latency_ms    = atof(arg_value(argc, argv, "latency_ms", "1"));
+    int workers          = atoi(arg_value(argc, argv, "workers", "2"));
+    int max_concurrent   = atoi(arg_value(argc, argv, "max_concurrent", "256"));
+    double max_p99_ms    = atof(arg_value(argc, argv, "max_p99_ms", "0"));
+    double max_rss_mb    = atof(arg_value(argc, argv, "max_rss_mb", "0"));
+    int rates[MAX_RATES], nrates = 0, rc = 0;
+    struct TcsServerConfig config = TCS_SERVER_CONFIG_DEFAULT;
+    struct TcsServerCallbacks callbacks = {on_connect, on_readable, on_close};
+    struct TcsServer *server = NULL;
+    struct TcsAddress address = TCS_ADDRESS_NONE;
+    pthread_condattr_t attr;
+    pthread_t delayer;
+    char url[64];
+    curlrq_engine_t *engine;
+
+    cfg.h2         = strcmp(proto, "h2") == 0;
+    cfg.latency_ns = (long long)(latency_ms * 1e6);
+    cfg.body       = (size_t)atol(arg_value(argc, argv, "body", "1024"));
+    cfg.errors     = atof(arg_value(argc, argv, "errors", "0"));
+    for (const char *p = rate_arg; *p && nrates < MAX_RATES; p = strchr(p, ',') ? strchr(p, ',') + 1 : "") {
+        int rate = atoi(p);
+        if (rate > 0) rates[nrates++] = rate;
+    }
+    if (nrates == 0 || seconds <= 0) {
+        printf("usage: %s [proto=h1|h2] [rates=1000,5000] [seconds=3] [latency_ms=1] [body=1024] [errors=0]"
+               " [workers=2] [max_concurrent=256] [max_p99_ms=0] [max_rss_mb=0]\n",
+               argv[0]);
+        return 1;
+    }
+
+    body_bytes = (char *)malloc(cfg.body + 1);
+    memset(body_bytes, 'x', cfg.body);
+    h1_ok    = h1_build(200, cfg.body, &h1_ok_len);
+    h1_error = h1_build(500, 0, &h1_error_len);
+
+    pthread_mutex_init(&delay.mutex, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&delay.cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_create(&delayer, NULL, delay_thread, NULL);
+
+    tcs_lib_init();
+    tcs_address_parse("127.0.0.1:0", &config.address);
+    config.worker_count = 2;
+    if (tcs_server_create(&server, &config, &callbacks, NULL) != TCS_SUCCESS ||
+        tcs_server_start(server) != TCS_SUCCESS) {
+        printf("could not start the HTTP stand-in\n");
+        return 1;
+    }
+    tcs_server_address(server, &address);
+    snprintf(url, sizeof url, "http://127.0.0.1:%u/", (unsigned)address.data.ip4.port);
+
+    curl_global_init(CURL_GLOBAL_ALL);
+    engine = curlrq_init_workers(max_concurrent, workers, CURLRQ_DISPATCH_ROUND_ROBIN);
+    if (!engine) {
+        printf("curlrq_init_workers failed\n");
+        return 1;
+    }
+    if (cfg.h2) curlrq_set_http2(engine, CURLRQ_HTTP2_PRIOR_KNOWLEDGE);
+
+    printf("proto=%s libcurl=%s workers=%d max_concurrent=%d latency_ms=%g body=%zu errors=%g%% seconds=%g\n",
+           cfg.h2 ? "h2" : "h1", curl_version_info(CURLVERSION_NOW)->version, workers, max_concurrent, latency_ms, cfg.body, cfg.errors, seconds);
+    for (int i = 0; i < nrates; i++) {
+        int step = run_step(engine, url, rates[i], seconds, max_p99_ms, max_rss_mb);
+        if (step && (!rc || step < rc)) rc = step;
+    }
+
+    curlrq_cleanup(engine);
+    curl_global_cleanup();
+    tcs_server_stop(server, 1000);
+    tcs_server_destroy(&server);
+    tcs_lib_free();
+
+    pthread_mutex_lock(&delay.mutex);
+    delay.stop = 1;
+    pthread_cond_signal(&delay.cond);
+    pthread_mutex_unlock(&delay.mutex);
+    pthread_join(delayer, NULL);
+    pthread_cond_destroy(&delay.cond);
+    pthread_mutex_destroy(&delay.mutex);
+    free(delay.heap);
+    free(h1_ok);
+    free(h1_error);
+    free(body_bytes);
+    return rc;
+}
@@ -0,0 +1,203 @@
+/**
+ * bench_submit.c - curlrq_add 提交路径竞争测试
+ *
+ * 多个生产者线程同时向同一个引擎提交请求，目标是本机的 HTTP 替身服务器
+ * （tinycsocket 的 TcsServer，对每个请求回固定的 200 响应），网络开销很小，
+ * 耗时主要在提交路径与 Worker 调度上。
+ *
+ * 输出:
+ *   submit   所有生产者提交完毕的耗时与每秒提交数
+ *   add      单次 curlrq_add 耗时的平均值 / p99 / 最大值（微秒）
+ *   total    全部请求完成（curlrq_wait 返回）的耗时与每秒完成数
+ *
+ * 编译:
+ *   cc -std=gnu99 -O2 -o bench_submit bench_submit.c curlrq.c -lcurl -lpthread
+ * 运行:
+ *   ./bench_submit [producers=32] [requests_per_producer=2000] [workers=4] [max_concurrent=64]
+ */
+
+#define TINYCSOCKET_IMPLEMENTATION
+#include "../tcs/tinycsocket.h"
+
+#include "curlrq.h"
+
+#include <curl/curl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char HTTP_RESPONSE[] =
+    "HTTP/1.1 200 OK\r\nContent-Length: 5\r\nContent-Type: text/plain\r\n\r\nhello";
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* ------------------------------------------------------------------ */
+/*  HTTP 替身服务器                                                    */
+/* ------------------------------------------------------------------ */
+
+/*
+ * 每遇到一个 "\r\n\r\n" 回一个响应（请求都没有 body）。
+ * 已匹配的字符数存在 user_data 中，请求头跨两次读取时也能识别。
+ */
+static bool on_readable(struct TcsServer *server, struct TcsServerConnection *connection)
+{
+    static const char end[] = "\r\n\r\n";
+    uint8_t buffer[8192];
+    size_t received = 0;
+    uintptr_t matched = (uintptr_t)connection->user_data;
+    (void)server;
+
+    if (tcs_receive(connection->socket, buffer, sizeof buffer, TCS_FLAG_NONE, &received) != TCS_SUCCESS ||
+        received == 0)
+        return false;
+    for (size_t i = 0; i < received; i++) {
+        if (buffer[i] == (uint8_t)end[matched]) {
+            if (++matched == 4) {
+                matched = 0;
+                if (tcs_send(connection->socket, (const uint8_t *)HTTP_RESPONSE, sizeof HTTP_RESPONSE - 1,
+                             TCS_MSG_SENDALL, NULL) != TCS_SUCCESS)
+                    return false;
+            }
+        } else {
+            matched = buffer[i] == '\r' ? 1 : 0;
+        }
+    }
+    connection->user_data = (void *)matched;
+    return true;
+}
+
+/* ------------------------------------------------------------------ */
+/*  生产者                                                             */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+    curlrq_engine_t *engine;
+    const char      *url;
+    int              requests;
+    long long       *latency_ns;   /* 每次 curlrq_add 的耗时 */
+    int              rejected;
+} producer_t;
+
+static int completed;
+static int failed;
+
+static void on_done(curlrq_response_t *resp, void *user_data)
+{
+    (void)user_data;
+    if (resp->curl_code == 0 && resp->http_code == 200)
+        __atomic_add_fetch(&completed, 1, __ATOMIC_RELAXED);
+    else
+        __atomic_add_fetch(&failed, 1, __ATOMIC_RELAXED);
+    curlrq_response_free(resp);
+}
+
+static void *producer_thread(void *arg)
+{
+    producer_t *p = (producer_t *)arg;
+    curlrq_request_t req;
+
+    memset(&req, 0, sizeof(req));
+    req.url = p->url;
+    req.timeout_ms = 30000;
+
+    for (int i = 0; i < p->requests; i++) {
+        long long t0 = now_ns();
+        if (curlrq_add(p->engine, &req, on_done) != 0) p->rejected++;
+        p->latency_ns[i] = now_ns() - t0;
+    }
+    return NULL;
+}
+
+static int cmp_ll(const void *a, const void *b)
+{
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+    return x < y ? -1 : x > y;
+}
+
+int main(int argc, char **argv)
+{
+    int producers      = argc > 1 ? atoi(argv[1]) : 32;
+    int per_producer   = argc > 2 ? atoi(argv[2]) : 2000;
+    int workers        = argc > 3 ? atoi(argv[3]) : 4;
+    int max_concurrent = argc > 4 ? atoi(argv[4]) : 64;
+    int total;
+    struct TcsServerConfig config = TCS_SERVER_CONFIG_DEFAULT;
+    struct TcsServerCallbacks callbacks = {NULL, on_readable, NULL};
+    struct TcsServer *server = NULL;
+    struct TcsAddress address;
+    char url[64];
+    curlrq_engine_t *engine;
+    producer_t *ps;
+    pthread_t *ids;
+    long long *latency;
+    long long t0, t_submit, t_total, sum = 0;
+    int rejected = 0;
+
+    if (producers < 1) producers = 1;
+    if (per_producer < 1) per_producer = 1;
+    total = producers * per_producer;
+
+    tcs_lib_init();
+    tcs_address_parse("127.0.0.1:0", &config.address);
+    config.worker_count = 2;
+    if (tcs_server_create(&server, &config, &callbacks, NULL) != TCS_SUCCESS ||
+        tcs_server_start(server) != TCS_SUCCESS) {
+        printf("could not start the HTTP stand-in\n");
+        return 1;
+    }
+    tcs_server_address(server, &address);
+    snprintf(url, sizeof url, "http://127.0.0.1:%u/", (unsigned)address.data.ip4.port);
+
+    curl_global_init(CURL_GLOBAL_ALL);
+    engine = curlrq_init_workers(max_concurrent, workers, CURLRQ_DISPATCH_ROUND_ROBIN);
+    if (!engine) {
+        printf("curlrq_init_workers failed\n");
+        return 1;
+    }
+
+    ps      = (producer_t *)calloc((size_t)producers, sizeof(*ps));
+    ids     = (pthread_t *)calloc((size_t)producers, sizeof(*ids));
+    latency = (long long *)calloc((size_t)total, sizeof(*latency));
+    for (int i = 0; i < producers; i++) {
+        ps[i].engine     = engine;
+        ps[i].url        = url;
+        ps[i].requests   = per_producer;
+        ps[i].latency_ns = latency + (size_t)i * (size_t)per_producer;
+    }
+
+    t0 = now_ns();
+    for (int i = 0; i < producers; i++) pthread_create(&ids[i], NULL, producer_thread, &ps[i]);
+    for (int i = 0; i < producers; i++) pthread_join(ids[i], NULL);
+    t_submit = now_ns() - t0;
+    curlrq_wait(engine);
+    t_total = now_ns() - t0;
+
+    for (int i = 0; i < producers; i++) rejected += ps[i].rejected;
+    for (int i = 0; i < total; i++) sum += latency[i];
+    qsort(latency, (size_t)total, sizeof(*latency), cmp_ll);
+
+    printf("producers=%d requests=%d workers=%d max_concurrent=%d\n", producers, total, workers, max_concurrent);
+    printf("submit  %.3f s  %.0f adds/s\n", (double)t_submit / 1e9, total / ((double)t_submit / 1e9));
+    printf("add     avg %.2f us  p99 %.2f us  max %.2f us\n", (double)sum / total / 1e3,
+           (double)latency[(size_t)total * 99 / 100] / 1e3, (double)latency[total - 1] / 1e3);
+    printf("total   %.3f s  %.0f req/s  completed=%d failed=%d rejected=%d\n", (double)t_total / 1e9,
+           total / ((double)t_total / 1e9), completed, failed, rejected);
+
+    curlrq_cleanup(engine);
+    curl_global_cleanup();
+    tcs_server_stop(server, 1000);
+    tcs_server_destroy(&server);
+    tcs_lib_free();
+    free(latency);
+    free(ids);
+    free(ps);
+    return failed == 0 && rejected == 0 ? 0 : 1;
+}
@@ -3,10 +3,17 @@
  * 基于 libcurl multi 接口 + pthread 的并发 HTTP 请求引擎实现
  *
  * 内部结构:
- *   - 请求队列 (request_node_t 单向链表)：待发请求
- *   - 活跃列表 (active_request_t 单向链表)：正在执行的请求
- *   - Worker 线程：运行 curl_multi_perform 循环，自动调度
- *   - 互斥锁 + 条件变量：线程安全的任务投递与唤醒
+ *   - Worker 分片 (worker_t)：每个 Worker 拥有独立线程、multi 句柄、请求队列和活跃列表
+ *   - 提交队列 (inbox)：无锁多生产者栈，curlrq_add 按分派策略选择 Worker 后压入，不加锁
+ *   - 优先级队列 (request_heap_t)：Worker 取走提交队列后按优先级/截止时间排序的待发请求
+ *   - 活跃列表 (active_request_t 单向链表)：正在执行的请求，只在 Worker 线程中访问，控制块回收复用
+ *   - 重试与对冲：失败的请求按策略退避后回到优先级队列；慢请求在 p95 延迟后发出副本，先完成者胜出
+ *   - 请求 arena：队列节点与拷贝的 URL/方法/body/请求头在同一块内存中，每个请求只分配一次
+ *   - Worker 线程：Linux 下运行 epoll + curl_multi_socket_action 事件循环，
+ *     timerfd 驱动 libcurl 定时器，eventfd 接收新任务/关闭通知；其他平台回退到 curl_multi_poll 循环
+ *   - 互斥锁 + 条件变量：只用于线程启停、选项修改和 curlrq_wait 等待
+ *   - easy 句柄池：请求结束后 curl_easy_reset 回收，保留连接/TLS 会话/DNS 缓存
+ *   - CURLSH 共享对象：DNS 缓存与 TLS 会话在引擎内所有 easy 句柄间共享
  */
 
 #include "curlrq.h"
@@ -19,14 +26,44 @@
 #include <stdio.h>
 #include <time.h>
 #include <errno.h>
+#include <limits.h>
+#include <sched.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+/* Linux 下使用 epoll + timerfd + eventfd 事件循环，其他平台回退到 curl_multi_poll */
+#if defined(__linux__) && !defined(CURLRQ_NO_EPOLL)
+#define CURLRQ_USE_EPOLL 1
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#else
+#define CURLRQ_USE_EPOLL 0
+#endif
 
 /* ------------------------------------------------------------------ */
 /*  内部常量                                                           */
 /* ------------------------------------------------------------------ */
 
-#define CURLRQ_MAX_CONCURRENT   3   /* 最大并发数硬限制 */
-#define CURLRQ_MULTI_WAIT_MS   50   /* curl_multi_wait 超时(毫秒) */
+#define CURLRQ_MAX_CONCURRENT 1024 /* 每个 Worker 最大并发数硬限制 */
+#define CURLRQ_MAX_WORKERS      64  /* Worker 数硬限制 */
+#define CURLRQ_MULTI_WAIT_MS   50   /* curl_multi_poll 超时(毫秒)，仅非 epoll 平台 */
 #define CURLRQ_IDLE_TIMEOUT_SEC 5   /* Worker 线程空闲超时(秒) */
+#define CURLRQ_EPOLL_EVENTS    64   /* 每次 epoll_wait 处理的事件数 */
+#define CURLRQ_PREALLOC_MAX (64L * 1024 * 1024) /* 按 Content-Length 预分配响应缓存的上限(字节) */
+#define CURLRQ_RETRY_BASE_MS   100  /* 重试退避基准延迟默认值(毫秒) */
+#define CURLRQ_RETRY_MAX_MS  10000  /* 单次重试退避上限默认值(毫秒) */
+#define CURLRQ_MAX_RETRY_STATUS 16  /* 重试状态码列表最大长度 */
+#define CURLRQ_LATENCY_SAMPLES 256  /* 每个 Worker 保留的最近耗时样本数，用于估算对冲延迟 p95 */
+#define CURLRQ_HEDGE_MIN_SAMPLES 32 /* 样本数达到此值后才开始对冲 */
+#define CURLRQ_HEDGE_RECALC    16   /* 每新增多少个样本重新计算一次 p95 */
+#define CURLRQ_CACHE_MEMORY (32L * 1024 * 1024)  /* 响应缓存内存层上限默认值(字节) */
+#define CURLRQ_CACHE_DISK  (256L * 1024 * 1024)  /* 响应缓存磁盘层上限默认值(字节) */
+#define CURLRQ_CACHE_BUCKETS  1024  /* 响应缓存哈希桶数（2 的幂） */
+#define CURLRQ_RATE_BUCKETS    256  /* 限速表哈希桶数（2 的幂） */
+#define CURLRQ_RATE_HOSTS_MAX 4096  /* 按默认限速创建的主机数超过此值时清理已回满的桶 */
+#define CURLRQ_HOST_MAX        256  /* 参与限速的 host[:port] 最大长度，更长的不限速 */
 
 /* ------------------------------------------------------------------ */
 /*  内部数据结构                                                       */
@@ -34,113 +71,512 @@
 
 /**
  * request_node_t - 队列节点
- * 内部持有请求配置的深层拷贝，确保外部数据释放后仍可安全使用。
+ * 内部持有请求配置的深层拷贝，确保外部数据释放后仍可安全使用（curlrq_add_nocopy 时只引用调用方内存）。
+ * 节点之后紧跟 arena：请求头的 curl_slist 节点数组，然后是拷贝的字符串，整体一次 malloc、一次 free。
  */
 typedef struct request_node_s {
-    curlrq_request_t     req;              /* 请求配置拷贝 */
-    struct curl_slist   *headers;          /* 转换后的 curl_slist 链表 */
+    curlrq_request_t     req;              /* 请求配置拷贝，字符串指向 arena 或调用方内存 */
+    struct curl_slist   *headers;          /* 请求头链表，节点在 arena 中 */
     curlrq_callback_t    callback;         /* 完成回调 */
+    curlrq_stream_t      stream;           /* 流式回调拷贝，req.stream 指向此处 */
+    unsigned long long   seq;              /* 加入顺序，截止时间相同时先到先启动，重试时保持不变 */
+    int                  attempts;         /* 已发出的传输次数（含重试与对冲） */
+    long long            retry_at;         /* 退避结束时间（curlrq_now_ms 时钟），在重试堆中时有效 */
+    long long            enqueued_us;      /* 加入时间（now_us 时钟） */
+    long long            queue_us;         /* 加入到首次启动的时间，未启动时为 0 */
+    int                  rate_reserved;    /* 1=已预留令牌，在重试堆中等待可用时间，下次启动不再取令牌 */
     struct request_node_s *next;           /* 链表下一节点 */
 } request_node_t;
 
+/**
+ * request_heap_t - 请求二叉最小堆
+ * 优先级队列按 (截止时间, 加入顺序) 排列，无截止时间视为无穷大，堆顶即下一个要启动的请求；
+ * 重试堆按 (退避结束时间, 加入顺序) 排列。
+ */
+typedef struct {
+    request_node_t     **items;            /* 堆数组 */
+    int                  len;              /* 元素个数 */
+    int                  cap;              /* 数组容量 */
+} request_heap_t;
+
 /**
  * active_request_t - 活跃请求控制块
  * 每个正在执行的请求对应一个此结构体。
  */
 typedef struct active_request_s {
     CURL                 *easy;            /* libcurl easy 句柄 */
-    request_node_t       *node;            /* 原始请求数据 */
-    char                 *url;             /* 拷贝的 URL */
-    char                 *body;            /* 拷贝的请求体 */
-    size_t                body_len;        /* 请求体长度 */
-    struct curl_slist    *headers;         /* 请求头链表 */
+    request_node_t       *node;            /* 原始请求数据，URL/body 直接使用节点中的拷贝 */
+    struct curl_slist    *headers;         /* 最终请求头链表（引擎默认头 + 请求头） */
+    struct curl_slist    *default_block;   /* 引擎默认头的拷贝，链尾接节点的请求头，NULL=无默认头 */
     char                 *write_buf;       /* 响应 body 缓存 */
     size_t                write_len;       /* 已写入长度 */
     size_t                write_cap;       /* 缓存容量 */
     char                 *header_buf;      /* 响应头缓存 */
     size_t                header_len;      /* 已写入的头长度 */
     size_t                header_cap;      /* 头缓存容量 */
+    int                   delivered;       /* 1=已有数据交给流式回调或 output_fd，不能再重试 */
+    long long             hedge_at;        /* 发出对冲副本的时间，0=不对冲或已处理 */
+    struct active_request_s *peer;         /* 对冲中的另一个传输（同一个 node），NULL=未对冲 */
+    struct cache_entry_s *cache_entry;     /* 正在重新验证的缓存条目（持有引用），NULL=无 */
+    struct curl_slist    *cond_block;      /* 条件请求头，链尾接 headers，NULL=无 */
     struct active_request_s *next;         /* 链表下一节点 */
 } active_request_t;
 
 /**
- * curlrq_engine_s - 引擎主结构体
+ * retry_policy_t - 重试策略的内部拷贝
  */
-struct curlrq_engine_s {
-    int              max_concurrent;       /* 最大并发数（<=3） */
-    int              active_count;         /* 当前活跃请求数 */
-    int              shutdown;             /* 清理标志，1=正在关闭 */
+typedef struct {
+    int                   max_attempts;    /* 最多传输次数（含首次），<=1 不重试 */
+    long                  base_delay_ms;   /* 退避基准延迟 */
+    long                  max_delay_ms;    /* 单次退避上限 */
+    int                   retry_network_errors; /* 1=传输错误重试 */
+    int                   honor_retry_after;    /* 1=按 Retry-After 延迟 */
+    int                   retry_non_idempotent; /* 1=POST/PATCH 也重试 */
+    int                   status[CURLRQ_MAX_RETRY_STATUS + 1]; /* 可重试的状态码，0 结尾 */
+} retry_policy_t;
 
-    request_node_t  *queue_head;           /* 请求队列头 */
-    request_node_t  *queue_tail;           /* 请求队列尾 */
+/**
+ * cache_entry_t - 响应缓存条目
+ * 条目之后紧跟所有字符串与 body，整体一次 malloc、一次 free。
+ * 被替换或淘汰时仍有引用（正在重新验证的请求）的条目，在最后一个引用释放时销毁。
+ */
+typedef struct cache_entry_s {
+    const char           *url;             /* 键 */
+    const char           *vary;            /* 响应的 Vary 头原文，NULL=无 */
+    const char           *vary_values;     /* 存入时 Vary 所列请求头的值，每个以 '\n' 结尾 */
+    const char           *etag;            /* ETag，NULL=无 */
+    const char           *last_modified;   /* Last-Modified，NULL=无 */
+    const char           *headers;         /* 原始响应头（最后一个响应） */
+    size_t                headers_len;
+    const char           *body;            /* 响应 body */
+    size_t                body_len;
+    size_t                size;            /* 条目总字节数，计入内存层上限 */
+    long long             fresh_until;     /* 新鲜期结束时间（实时时钟毫秒），cache->mutex 保护 */
+    unsigned int          hash;            /* URL 哈希，也是磁盘文件名 */
+    int                   refs;            /* 请求持有的引用数，cache->mutex 保护 */
+    int                   linked;          /* 1=在哈希表与 LRU 中 */
+    struct cache_entry_s *hnext;           /* 哈希桶链 */
+    struct cache_entry_s *prev;            /* LRU，头部最近使用 */
+    struct cache_entry_s *next;
+} cache_entry_t;
 
-    active_request_t *active_list;         /* 活跃请求链表 */
+/**
+ * response_cache_t - 响应缓存，所有 Worker 共享，mutex 保护哈希表、LRU 与计数
+ */
+typedef struct {
+    pthread_mutex_t       mutex;
+    cache_entry_t       **buckets;         /* 哈希桶，个数为 2 的幂 */
+    size_t                nbuckets;
+    cache_entry_t        *lru_head;
+    cache_entry_t        *lru_tail;
+    size_t                mem_bytes;       /* 内存层当前字节数 */
+    size_t                max_memory;      /* 内存层上限 */
+    long long             ttl_ms;          /* 新鲜期上限 */
+    char                 *disk_dir;        /* 磁盘层目录，NULL=只用内存 */
+    size_t                disk_bytes;      /* 磁盘层当前字节数（估计值，disk_trim 时校正） */
+    size_t                max_disk;        /* 磁盘层上限 */
+} response_cache_t;
+
+/*
+ * disk_header_t - 磁盘层文件头（本机字节序，只在本机使用）
+ * 之后依次是 url、vary、vary_values、etag、last_modified、headers、body。
+ * 文件名为 URL 哈希，读取时比对 URL 排除哈希冲突。
+ */
+typedef struct {
+    char                  magic[8];        /* DISK_MAGIC */
+    long long             fresh_until;     /* 实时时钟毫秒 */
+    unsigned long long    len[7];          /* 各段长度，不存在的段为 ~0ULL */
+} disk_header_t;
 
-    CURLM           *multi;                /* curl multi 句柄 */
+#define DISK_MAGIC "CURLRQC1"
+
+/**
+ * disk_file_t - disk_trim 时的目录项
+ */
+typedef struct {
+    char                  name[16];        /* "<hash>.rqc" */
+    long long             mtime;
+    size_t                size;
+} disk_file_t;
+
+/**
+ * cancel_node_t - 取消请求，压入请求所在 Worker 的取消队列
+ */
+typedef struct cancel_node_s {
+    unsigned long long    seq;             /* 要取消的请求的加入顺序号 */
+    struct cancel_node_s *next;
+} cancel_node_t;
+
+/**
+ * host_limit_t - 一个主机的令牌桶
+ * 按 GCRA 实现，只记录理论到达时间：tat - now 不超过突发容差时有令牌，
+ * 取一个令牌 tat 后移一个间隔。之后紧跟 host 字符串，一次分配。
+ */
+typedef struct host_limit_s {
+    unsigned int          hash;            /* host_hash */
+    int                   configured;      /* 1=curlrq_set_rate_limit 单独设置，0=按默认限速创建 */
+    long long             interval_us;     /* 令牌间隔 = 1e6 / 速率 */
+    long long             tolerance_us;    /* 突发容差 = (burst - 1) * interval_us */
+    long long             tat_us;          /* 理论到达时间（now_us 时钟），<= now 表示桶满 */
+    struct host_limit_s  *next;            /* 哈希桶链 */
+    char                  host[];          /* 小写的 host[:port] */
+} host_limit_t;
+
+/**
+ * worker_t - Worker 分片
+ * 每个 Worker 拥有独立的线程、multi 句柄（连接缓存）、请求队列和 easy 句柄池。
+ *
+ * curlrq_add 只把请求无锁压入 inbox 并唤醒 Worker，其余调度状态（优先级队列、活跃列表、
+ * 句柄池、multi 句柄）都只在 Worker 线程中访问，不需要加锁。
+ * 标注"原子"的字段用 RQ_* 原子操作读写。
+ */
+typedef struct worker_s {
+    curlrq_engine_t *engine;               /* 所属引擎 */
+
+    /* 提交队列：多生产者压栈，Worker 一次取走整条链（MPSC） */
+    request_node_t  *inbox;                /* 原子，栈顶（后进先出，取走后反转） */
+    cancel_node_t   *cancels;              /* 原子，取消队列栈顶，同样整体取走 */
 
-    pthread_mutex_t  mutex;                /* 保护队列+活跃列表 */
-    pthread_cond_t   cond;                 /* 条件变量（新任务/关闭通知） */
-    pthread_t        thread;               /* Worker 线程 ID */
-    int              thread_running;       /* 0=无线程, 1=线程运行中 */
-    int              max_queue_len;        /* 最大队列长度，0=无限制 */
-    int              queue_len;            /* 当前队列长度 */
+    /* 以下字段只在 Worker 线程中访问 */
+    request_heap_t   queues[CURLRQ_PRIORITY_LEVELS]; /* 待启动请求，按调度顺序（高/普通/低）分级 */
+    int              queue_len;            /* 优先级队列长度（各级合计） */
+    active_request_t *active_list;         /* 活跃请求链表 */
+    CURLM           *multi;                /* curl multi 句柄 */
+    CURL           **easy_pool;            /* 空闲 easy 句柄，容量 max_concurrent */
+    int              easy_pool_len;        /* 空闲 easy 句柄数 */
+    active_request_t *active_pool;         /* 回收的活跃请求控制块（单向链表），最多 max_concurrent 个 */
+    int              active_pool_len;      /* 回收的控制块数 */
+    int              http2;                /* 引擎 http2 选项的副本 */
+    int              multi_http2;          /* 已应用到 multi 句柄的 http2 值 */
+    struct curl_slist *default_headers;    /* 引擎默认头的副本 */
+    retry_policy_t   retry;                /* 引擎重试策略的副本 */
+    int              hedging;              /* 引擎对冲开关的副本 */
+    long             hedge_min_delay_ms;   /* 引擎对冲最小延迟的副本 */
+
+    request_heap_t   retry_heap;           /* 退避中的请求，按退避结束时间排列，计入 engine->queue_len */
+    int              hedge_count;          /* 进行中的对冲副本数，与 active_count 一起受 max_concurrent 限制 */
+    int              hedge_armed;          /* 设置了 hedge_at 的活跃请求数，为 0 时不扫描活跃列表 */
+    long             latency[CURLRQ_LATENCY_SAMPLES]; /* 最近成功传输的耗时（毫秒），环形 */
+    unsigned long long latency_count;      /* 累计样本数 */
+    long             hedge_delay_ms;       /* 最近样本的 p95，0=样本不足 */
+    unsigned long long rng;                /* 退避抖动的 xorshift 随机数状态 */
+
+    curlrq_stats_t   stats;                /* 统计计数，RQ_COUNT 累加；关闭后由 curlrq_cleanup 线程累加 */
+
+    int              active_count;         /* 原子，当前活跃请求数（只由 Worker 线程修改） */
+    int              opts_dirty;           /* 原子，1=引擎选项有变更，Worker 下一轮重新拷贝 */
+    int              state;                /* 原子，WORKER_STOPPED / WORKER_RUNNING */
+
+#if CURLRQ_USE_EPOLL
+    int              epoll_fd;             /* 事件循环：libcurl socket + wake_fd + timer_fd */
+    int              wake_fd;              /* eventfd，新任务/关闭通知 */
+    int              timer_fd;             /* timerfd，CURLMOPT_TIMERFUNCTION 的定时器 */
+#endif
+    pthread_t        thread;               /* Worker 线程 ID（engine->mutex 保护） */
+    int              thread_alive;         /* 1=thread 尚未 join（运行中或已退出），engine->mutex 保护 */
+} worker_t;
+
+#define WORKER_STOPPED 0                   /* 无线程，下一个 curlrq_add 创建 */
+#define WORKER_RUNNING 1                   /* 线程运行中 */
 
-    /* 引擎级默认值 */
+/**
+ * curlrq_engine_s - 引擎主结构体
+ */
+struct curlrq_engine_s {
+    int              max_concurrent;       /* 每个 Worker 最大并发数（<=CURLRQ_MAX_CONCURRENT） */
+    int              shutdown;             /* 原子，清理标志，1=正在关闭 */
+    int              adders;               /* 原子，正在执行 curlrq_add 的线程数，cleanup 等其归零 */
+
+    worker_t        *workers;              /* Worker 分片数组 */
+    int              num_workers;          /* Worker 数 */
+    curlrq_dispatch_t dispatch;            /* 分派策略 */
+    unsigned int     next_worker;          /* 原子，轮询分派的下一个 Worker */
+
+    CURLSH          *share;                /* DNS/TLS 会话共享对象，所有 Worker 共用 */
+    pthread_mutex_t  share_locks[CURL_LOCK_DATA_LAST]; /* 共享对象按数据类型加锁 */
+
+    /* mutex 只用于慢路径：线程启停、选项修改和 curlrq_wait，提交与调度不加锁 */
+    pthread_mutex_t  mutex;
+    pthread_cond_t   cond;                 /* 条件变量（请求完成通知，curlrq_wait 使用） */
+    int              waiters;              /* 原子，curlrq_wait 中的线程数，为 0 时完成请求不加锁通知 */
+    int              max_queue_len;        /* 原子，最大队列长度（所有 Worker 合计），0=无限制 */
+    int              queue_len;            /* 原子，已提交未启动的请求数（所有 Worker 合计） */
+    int              class_len[CURLRQ_PRIORITY_LEVELS]; /* 原子，各优先级的排队数 */
+    unsigned long long next_seq;           /* 原子，下一个请求的加入顺序号 */
+
+    /* 引擎级默认值（原子读写，curlrq_add 中读取） */
     long             default_timeout_ms;
     long             default_connect_timeout_ms;
     long             default_max_response_size;
     int              default_verify_ssl;
+
+    /* 以下选项由 mutex 保护，修改后置位各 Worker 的 opts_dirty，由 Worker 拷贝后使用 */
     struct curl_slist *default_headers;    /* 引擎级默认头链表 */
+    int              http2;                /* 1=HTTP/2 多路复用，2=明文 HTTP/2 */
+    long             max_host_connections; /* 每个主机最大连接数，0=不限制 */
+    retry_policy_t   retry;                /* 重试策略 */
+    int              hedging;              /* 1=对冲慢请求 */
+    long             hedge_min_delay_ms;   /* 对冲延迟下限 */
+
+    response_cache_t *cache;               /* 响应缓存，NULL=未开启；只在没有请求执行时由 curlrq_set_cache 修改 */
+
+    /* 按主机限速，rate_mutex 保护（Worker 启动传输时短暂持有），没有设置限速时不加锁 */
+    pthread_mutex_t  rate_mutex;
+    int              rate_enabled;         /* 原子，1=设置过限速 */
+    host_limit_t    *rate_table[CURLRQ_RATE_BUCKETS];
+    int              rate_hosts;           /* 按默认限速创建的主机数 */
+    long long        rate_interval_us;     /* 默认限速的令牌间隔，0=无默认限速 */
+    long long        rate_tolerance_us;    /* 默认限速的突发容差 */
 };
 
+/* 原子操作（GCC/Clang 内建），顺序一致性 */
+#define RQ_LOAD(p)          __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define RQ_STORE(p, v)      __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define RQ_ADD(p, v)        __atomic_add_fetch((p), (v), __ATOMIC_SEQ_CST)
+#define RQ_XCHG(p, v)       __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#define RQ_CAS(p, e, d)     __atomic_compare_exchange_n((p), (e), (d), 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+
+/* 单写者统计计数：只由所属 Worker 线程累加，不需要原子读改写；其他线程用 RQ_PEEK 读取 */
+#define RQ_COUNT(p, v)      __atomic_store_n((p), __atomic_load_n((p), __ATOMIC_RELAXED) + (v), __ATOMIC_RELAXED)
+#define RQ_PEEK(p)          __atomic_load_n((p), __ATOMIC_RELAXED)
+
 /* ------------------------------------------------------------------ */
 /*  前向声明（内部函数）                                                */
 /* ------------------------------------------------------------------ */
 
 static void *worker_thread(void *arg);
-static int  start_request(curlrq_engine_t *engine, request_node_t *node);
-static void complete_request(curlrq_engine_t *engine, CURL *easy, CURLcode cr);
-static void cleanup_active(curlrq_engine_t *engine, active_request_t *ar, CURLcode cr);
-static void drain_queue(curlrq_engine_t *engine);
+static int  start_worker(worker_t *worker);
+static int  stop_worker(worker_t *worker);
+static int  worker_wait(worker_t *worker, int idle, long wait_ms);
+static void wake_worker(worker_t *worker);
+static void check_multi_info(worker_t *worker);
+static int  start_request(worker_t *worker, request_node_t *node);
+static void complete_request(worker_t *worker, CURL *easy, CURLcode cr);
+static void cleanup_active(worker_t *worker, active_request_t *ar, CURLcode cr);
+static void drain_queue(worker_t *worker);
+static int  inbox_push(worker_t *worker, request_node_t *node);
+static void take_inbox(worker_t *worker);
+static void finish_unstarted(worker_t *worker, request_node_t *node, CURLcode code, const char *msg);
+static void notify_waiters(curlrq_engine_t *engine);
+static void mark_opts_dirty(curlrq_engine_t *engine);
+static CURL *acquire_easy(worker_t *worker);
+static void release_easy(worker_t *worker, CURL *easy);
+static void apply_engine_opts(worker_t *worker);
+static worker_t *pick_worker(curlrq_engine_t *engine, const char *url);
+static int  active_total(curlrq_engine_t *engine);
+static int  queue_class(curlrq_priority_t priority);
+static int  queue_push(worker_t *worker, request_node_t *node);
+static request_node_t *queue_pop(worker_t *worker);
+static request_node_t *queue_pop_expired(worker_t *worker, long long now);
+static request_node_t *retry_pop_expired(worker_t *worker, long long now);
+static long queue_deadline_wait(worker_t *worker, long long now);
+static int  heap_push(request_heap_t *heap, request_node_t *node,
+                      int (*before)(const request_node_t *, const request_node_t *));
+static request_node_t *heap_pop(request_heap_t *heap,
+                                int (*before)(const request_node_t *, const request_node_t *));
+static int  node_before(const request_node_t *a, const request_node_t *b);
+static int  retry_before(const request_node_t *a, const request_node_t *b);
+static void promote_retries(worker_t *worker, long long now);
+static long start_hedges(worker_t *worker, long long now);
+static long schedule_wait(worker_t *worker, long long now, long hedge_wait);
+static active_request_t *start_transfer(worker_t *worker, request_node_t *node, cache_entry_t *entry);
+static int  retryable_failure(const worker_t *worker, CURLcode cr, int http_code);
+static int  should_retry(worker_t *worker, active_request_t *ar, CURLcode cr, int http_code, long *delay_ms);
+static long backoff_delay(worker_t *worker, int attempts);
+static void record_latency(worker_t *worker, long ms);
+static void retry_policy_copy(retry_policy_t *dst, const curlrq_retry_policy_t *src);
+static int  method_idempotent(const char *method);
+static int  method_safe(const char *method);
+static response_cache_t *cache_create(const curlrq_cache_config_t *config);
+static void cache_destroy(response_cache_t *cache);
+static int  cache_eligible(const request_node_t *node);
+static cache_entry_t *cache_lookup(worker_t *worker, request_node_t *node);
+static int  cache_fresh(response_cache_t *cache, const cache_entry_t *e);
+static void cache_retain(response_cache_t *cache, cache_entry_t *e);
+static void cache_release(response_cache_t *cache, cache_entry_t *e);
+static void cache_store(worker_t *worker, request_node_t *node, active_request_t *ar);
+static void cache_refresh(response_cache_t *cache, cache_entry_t *e, const char *headers, size_t headers_len);
+static int  cache_fill_response(const cache_entry_t *e, curlrq_response_t *resp);
+static int  deliver_cached(worker_t *worker, request_node_t *node, cache_entry_t *e);
+static void cache_insert(response_cache_t *cache, cache_entry_t *e);
+static void cache_unlink(response_cache_t *cache, cache_entry_t *e);
+static void lru_touch(response_cache_t *cache, cache_entry_t *e);
+static cache_entry_t *entry_create(const char *url, const char *vary, size_t vary_len, const char *vary_vals,
+                                   const char *etag, size_t etag_len,
+                                   const char *last_modified, size_t last_modified_len,
+                                   const char *headers, size_t headers_len,
+                                   const char *body, size_t body_len);
+static struct curl_slist *conditional_headers(const cache_entry_t *e, struct curl_slist *tail);
+static char *vary_values(worker_t *worker, const request_node_t *node, const char *vary);
+static const char *slist_header_value(const struct curl_slist *list, const char *name, size_t name_len,
+                                      size_t *value_len);
+static void last_header_block(const char *headers, size_t len, const char **block, size_t *block_len);
+static const char *header_value(const char *block, size_t len, const char *name, size_t *value_len);
+static int  cache_control_lifetime(const char *value, size_t len, long long *lifetime);
+static unsigned int cache_hash(const char *url);
+static long long wall_ms(void);
+static void disk_path(const response_cache_t *cache, unsigned int hash, char *path, size_t size);
+static int  disk_file_name(const char *name);
+static void disk_write(response_cache_t *cache, const cache_entry_t *e);
+static cache_entry_t *disk_read(response_cache_t *cache, const char *url, unsigned int hash);
+static int  cmp_disk_file(const void *a, const void *b);
+static void disk_trim(response_cache_t *cache);
+static int  strncasecmp_ascii(const char *a, const char *b, size_t n);
+static void fail_request(request_node_t *node, CURLcode code, const char *msg);
+static void fill_timing(CURL *easy, request_node_t *node, curlrq_response_t *resp);
+static void count_transfer(worker_t *worker, CURL *easy);
+static void count_result(worker_t *worker, int error_class);
+static void record_queue_time(worker_t *worker, request_node_t *node);
+static int  error_class(CURLcode cr, int http_code);
+static long long now_us(void);
+static void free_node(request_node_t *node);
+static request_node_t *node_create(const curlrq_request_t *req, int copy);
+static curlrq_handle_t add_request(curlrq_engine_t *engine, const curlrq_request_t *req, curlrq_callback_t cb,
+                                   int copy);
+static void take_cancels(worker_t *worker, cancel_node_t *cancels);
+static int  cancel_request(worker_t *worker, unsigned long long seq);
+static void cancel_active(worker_t *worker, active_request_t *ar);
+static void heap_remove(request_heap_t *heap, int i,
+                        int (*before)(const request_node_t *, const request_node_t *));
+static long long rate_reserve(curlrq_engine_t *engine, const char *url, int try_only);
+static void rate_release(curlrq_engine_t *engine, const char *url);
+static host_limit_t *rate_find(curlrq_engine_t *engine, const char *host, unsigned int hash);
+static host_limit_t *rate_insert(curlrq_engine_t *engine, const char *host, unsigned int hash,
+                                 long long interval_us, long long tolerance_us, int configured);
+static void rate_remove(curlrq_engine_t *engine, host_limit_t *limit);
+static void rate_prune(curlrq_engine_t *engine, long long now);
+static void rate_clear(curlrq_engine_t *engine, int configured_too);
+static int  url_host(const char *url, char *host, size_t size);
+static active_request_t *acquire_active(worker_t *worker);
+static void release_active(worker_t *worker, active_request_t *ar);
+static int  copy_default_headers(const struct curl_slist *defaults, struct curl_slist *tail,
+                                 struct curl_slist **block);
+static int  header_overridden(const char *header, const struct curl_slist *list);
+static void free_engine(curlrq_engine_t *engine);
 
 /* CURLOPT_WRITEFUNCTION / HEADERFUNCTION 回调 */
 static size_t write_body_cb(void *data, size_t size, size_t nmemb, void *userp);
 static size_t write_header_cb(void *data, size_t size, size_t nmemb, void *userp);
 
+#if CURLRQ_USE_EPOLL
+/* CURLMOPT_SOCKETFUNCTION / TIMERFUNCTION 回调 */
+static int socket_cb(CURL *easy, curl_socket_t s, int what, void *userp, void *socketp);
+static int timer_cb(CURLM *multi, long timeout_ms, void *userp);
+#endif
+
+/* CURLSHOPT_LOCKFUNC / UNLOCKFUNC 回调 */
+static void share_lock_cb(CURL *handle, curl_lock_data data, curl_lock_access access, void *userp);
+static void share_unlock_cb(CURL *handle, curl_lock_data data, void *userp);
+
 /* 工具函数 */
 static char *strdup_safe(const char *s);
-static struct curl_slist *build_slist(const char * const *headers);
+static int  write_all(int fd, const char *data, size_t len);
+static char *arena_copy(char **arena, const char *s, size_t len);
+static unsigned int host_hash(const char *url);
 
 /* ------------------------------------------------------------------ */
 /*  公共 API 实现                                                      */
 /* ------------------------------------------------------------------ */
 
 curlrq_engine_t *curlrq_init(int max_concurrent)
+{
+    return curlrq_init_workers(max_concurrent, 1, CURLRQ_DISPATCH_ROUND_ROBIN);
+}
+
+curlrq_engine_t *curlrq_init_workers(int max_concurrent, int num_workers, curlrq_dispatch_t dispatch)
 {
     curlrq_engine_t *engine;
 
-    /* 限制最大并发数 */
+    /* 限制最大并发数与 Worker 数 */
     if (max_concurrent < 1) max_concurrent = 1;
     if (max_concurrent > CURLRQ_MAX_CONCURRENT) max_concurrent = CURLRQ_MAX_CONCURRENT;
+    if (num_workers < 1) num_workers = 1;
+    if (num_workers > CURLRQ_MAX_WORKERS) num_workers = CURLRQ_MAX_WORKERS;
 
     engine = (curlrq_engine_t *)calloc(1, sizeof(*engine));
     if (!engine) return NULL;
 
     engine->max_concurrent = max_concurrent;
-    engine->multi = curl_multi_init();
-    if (!engine->multi) {
-        free(engine);
-        return NULL;
-    }
+    engine->dispatch       = dispatch;
+    engine->num_workers    = num_workers;
 
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_init(&engine->share_locks[i], NULL);
+    }
     pthread_mutex_init(&engine->mutex, NULL);
+    pthread_mutex_init(&engine->rate_mutex, NULL);
     pthread_cond_init(&engine->cond, NULL);
 
     /*
-     * 不启动 Worker 线程，首次 curlrq_add 时惰性创建。
+     * 连接本身由各 Worker 的 multi 句柄连接缓存复用；DNS 和 TLS 会话放进共享对象，
+     * 所有 Worker 与回收重建的 easy 句柄都可命中。libcurl 不支持跨线程共享连接，所以不共享 CONNECT。
+     */
+    engine->share = curl_share_init();
+    if (!engine->share) {
+        free_engine(engine);
+        return NULL;
+    }
+    curl_share_setopt(engine->share, CURLSHOPT_LOCKFUNC, share_lock_cb);
+    curl_share_setopt(engine->share, CURLSHOPT_UNLOCKFUNC, share_unlock_cb);
+    curl_share_setopt(engine->share, CURLSHOPT_USERDATA, engine);
+    curl_share_setopt(engine->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(engine->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+    engine->workers = (worker_t *)calloc((size_t)num_workers, sizeof(worker_t));
+    if (!engine->workers) {
+        free_engine(engine);
+        return NULL;
+    }
+    for (int i = 0; i < num_workers; i++) {
+        worker_t *worker = &engine->workers[i];
+        worker->engine = engine;
+        worker->state  = WORKER_STOPPED;
+        /* 首轮循环拷贝引擎选项（重试策略的默认状态码列表等） */
+        worker->opts_dirty = 1;
+        worker->rng = ((unsigned long long)(size_t)worker << 16) ^ (unsigned long long)curlrq_now_ms() ^
+                      0x9E3779B97F4A7C15ULL;
+#if CURLRQ_USE_EPOLL
+        worker->epoll_fd = -1;
+        worker->wake_fd  = -1;
+        worker->timer_fd = -1;
+#endif
+    }
+    for (int i = 0; i < num_workers; i++) {
+        worker_t *worker = &engine->workers[i];
+        worker->multi = curl_multi_init();
+        worker->easy_pool = (CURL **)calloc((size_t)max_concurrent, sizeof(CURL *));
+        if (!worker->multi || !worker->easy_pool) {
+            free_engine(engine);
+            return NULL;
+        }
+#if CURLRQ_USE_EPOLL
+        /* libcurl 通过回调告知需要监听的 socket 和下一次超时，由 Worker 的 epoll 统一等待 */
+        struct epoll_event ev;
+        worker->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        worker->wake_fd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        worker->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (worker->epoll_fd < 0 || worker->wake_fd < 0 || worker->timer_fd < 0) {
+            free_engine(engine);
+            return NULL;
+        }
+        memset(&ev, 0, sizeof(ev));
+        ev.events  = EPOLLIN;
+        ev.data.fd = worker->wake_fd;
+        epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, worker->wake_fd, &ev);
+        ev.data.fd = worker->timer_fd;
+        epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, worker->timer_fd, &ev);
+
+        curl_multi_setopt(worker->multi, CURLMOPT_SOCKETFUNCTION, socket_cb);
+        curl_multi_setopt(worker->multi, CURLMOPT_SOCKETDATA, worker);
+        curl_multi_setopt(worker->multi, CURLMOPT_TIMERFUNCTION, timer_cb);
+        curl_multi_setopt(worker->multi, CURLMOPT_TIMERDATA, worker);
+#endif
+    }
+
+    /*
+     * 不启动 Worker 线程，首次分派到该 Worker 的 curlrq_add 时惰性创建。
      * 避免引擎空闲时也占用线程资源。
      */
-    engine->thread_running = 0;
     engine->max_queue_len   = 0;    /* 默认无限制 */
     engine->queue_len       = 0;
 
@@ -151,209 +587,475 @@ curlrq_engine_t *curlrq_init(int max_concurrent)
     engine->default_verify_ssl         = 0;
     engine->default_headers            = NULL;
 
+    /* 连接复用选项默认不改变 libcurl 行为 */
+    engine->http2                = 0;
+    engine->max_host_connections = 0;
+
+    /* 默认不重试、不对冲 */
+    retry_policy_copy(&engine->retry, NULL);
+    engine->hedging            = 0;
+    engine->hedge_min_delay_ms = 0;
+
     return engine;
 }
 
 void curlrq_set_max_queue_len(curlrq_engine_t *engine, int max_len)
 {
     if (!engine) return;
+    RQ_STORE(&engine->max_queue_len, (max_len < 0) ? 0 : max_len);
+}
+
+void curlrq_set_default_timeout_ms(curlrq_engine_t *engine, long ms)
+{
+    if (!engine) return;
+    RQ_STORE(&engine->default_timeout_ms, ms > 0 ? ms : 0);
+}
+
+void curlrq_set_default_connect_timeout_ms(curlrq_engine_t *engine, long ms)
+{
+    if (!engine) return;
+    RQ_STORE(&engine->default_connect_timeout_ms, ms > 0 ? ms : 0);
+}
+
+void curlrq_set_default_max_response_size(curlrq_engine_t *engine, long size)
+{
+    if (!engine) return;
+    RQ_STORE(&engine->default_max_response_size, size > 0 ? size : 0);
+}
+
+void curlrq_set_default_verify_ssl(curlrq_engine_t *engine, int verify)
+{
+    if (!engine) return;
+    RQ_STORE(&engine->default_verify_ssl, verify ? 1 : 0);
+}
+
+void curlrq_set_default_header(curlrq_engine_t *engine, const char *header)
+{
+    if (!engine || !header || header[0] == '\0') return;
     pthread_mutex_lock(&engine->mutex);
-    engine->max_queue_len = (max_len < 0) ? 0 : max_len;
+    struct curl_slist *new_list = curl_slist_append(engine->default_headers, header);
+    if (new_list) engine->default_headers = new_list;
+    mark_opts_dirty(engine);
     pthread_mutex_unlock(&engine->mutex);
 }
 
-void curlrq_set_default_timeout_ms(curlrq_engine_t *engine, long ms)
+void curlrq_set_http2(curlrq_engine_t *engine, int enable)
 {
     if (!engine) return;
     pthread_mutex_lock(&engine->mutex);
-    engine->default_timeout_ms = ms > 0 ? ms : 0;
+    engine->http2 = enable == CURLRQ_HTTP2_PRIOR_KNOWLEDGE ? enable : enable ? 1 : 0;
+    mark_opts_dirty(engine);
     pthread_mutex_unlock(&engine->mutex);
 }
 
-void curlrq_set_default_connect_timeout_ms(curlrq_engine_t *engine, long ms)
+void curlrq_set_max_host_connections(curlrq_engine_t *engine, long max_conns)
 {
     if (!engine) return;
     pthread_mutex_lock(&engine->mutex);
-    engine->default_connect_timeout_ms = ms > 0 ? ms : 0;
+    engine->max_host_connections = max_conns > 0 ? max_conns : 0;
+    mark_opts_dirty(engine);
     pthread_mutex_unlock(&engine->mutex);
 }
 
-void curlrq_set_default_max_response_size(curlrq_engine_t *engine, long size)
+void curlrq_set_retry_policy(curlrq_engine_t *engine, const curlrq_retry_policy_t *policy)
 {
+    retry_policy_t copy;
+
     if (!engine) return;
+    retry_policy_copy(&copy, policy);
     pthread_mutex_lock(&engine->mutex);
-    engine->default_max_response_size = size > 0 ? size : 0;
+    engine->retry = copy;
+    mark_opts_dirty(engine);
     pthread_mutex_unlock(&engine->mutex);
 }
 
-void curlrq_set_default_verify_ssl(curlrq_engine_t *engine, int verify)
+void curlrq_set_hedging(curlrq_engine_t *engine, int enable, long min_delay_ms)
 {
     if (!engine) return;
     pthread_mutex_lock(&engine->mutex);
-    engine->default_verify_ssl = verify ? 1 : 0;
+    engine->hedging            = enable ? 1 : 0;
+    engine->hedge_min_delay_ms = min_delay_ms > 0 ? min_delay_ms : 0;
+    mark_opts_dirty(engine);
     pthread_mutex_unlock(&engine->mutex);
 }
 
-void curlrq_set_default_header(curlrq_engine_t *engine, const char *header)
+int curlrq_set_cache(curlrq_engine_t *engine, const curlrq_cache_config_t *config)
 {
-    if (!engine || !header || header[0] == '\0') return;
+    response_cache_t *cache = NULL;
+    response_cache_t *old = NULL;
+    int busy;
+
+    if (!engine) return -1;
+    if (config && !(cache = cache_create(config))) return -1;
+
+    /*
+     * Worker 线程不加锁读取 engine->cache，只能在没有线程运行时替换。
+     * 之后创建的线程在 start_worker 中持同一把锁，能看到新值。
+     */
     pthread_mutex_lock(&engine->mutex);
-    struct curl_slist *new_list = curl_slist_append(engine->default_headers, header);
-    if (new_list) engine->default_headers = new_list;
+    busy = RQ_LOAD(&engine->queue_len) > 0;
+    for (int i = 0; i < engine->num_workers; i++) {
+        if (RQ_LOAD(&engine->workers[i].state) != WORKER_STOPPED) busy = 1;
+    }
+    if (!busy) {
+        old = engine->cache;
+        engine->cache = cache;
+    }
     pthread_mutex_unlock(&engine->mutex);
+
+    if (busy) {
+        if (cache) cache_destroy(cache);
+        return -1;
+    }
+    if (old) cache_destroy(old);
+    return 0;
 }
 
 void curlrq_cleanup(curlrq_engine_t *engine)
 {
+    int joinable[CURLRQ_MAX_WORKERS];
+
     if (!engine) return;
 
+    /*
+     * 置关闭标志后等待正在执行的 curlrq_add 返回：之后不会再有请求入队，也不会再创建线程。
+     * shutdown 与 adders 都是顺序一致的原子操作，双方至少有一方能看到对方的写入。
+     */
+    RQ_STORE(&engine->shutdown, 1);
+    while (RQ_LOAD(&engine->adders) > 0) {
+        sched_yield();
+    }
+
+    /* 通知所有 Worker 线程关闭，等待线程退出（包括空闲退出后尚未 join 的线程） */
     pthread_mutex_lock(&engine->mutex);
-    if (engine->thread_running) {
-        /* 通知 Worker 线程关闭，等待退出 */
-        engine->shutdown = 1;
-        pthread_cond_broadcast(&engine->cond);
-        pthread_mutex_unlock(&engine->mutex);
-        pthread_join(engine->thread, NULL);
-    } else {
-        /* 无线程，无需 join */
-        pthread_mutex_unlock(&engine->mutex);
+    for (int i = 0; i < engine->num_workers; i++) {
+        worker_t *worker = &engine->workers[i];
+        joinable[i] = worker->thread_alive;
+        wake_worker(worker);
+    }
+    pthread_mutex_unlock(&engine->mutex);
+
+    for (int i = 0; i < engine->num_workers; i++) {
+        if (joinable[i]) pthread_join(engine->workers[i].thread, NULL);
     }
 
-    /* 清理资源 */
+    /* 线程已全部退出，取消仍留在提交队列中的请求（如线程创建失败时入队的请求） */
+    for (int i = 0; i < engine->num_workers; i++) {
+        take_inbox(&engine->workers[i]);
+        drain_queue(&engine->workers[i]);
+    }
+
+    free_engine(engine);
+}
+
+/**
+ * free_engine - 释放引擎资源（Worker 线程已全部退出，或尚未创建）
+ * 也用于 curlrq_init_workers 失败时释放部分初始化的引擎。
+ */
+static void free_engine(curlrq_engine_t *engine)
+{
     if (engine->default_headers) curl_slist_free_all(engine->default_headers);
-    curl_multi_cleanup(engine->multi);
+
+    /* easy 句柄先于共享对象释放，否则 curl_share_cleanup 返回 CURLSHE_IN_USE */
+    if (engine->workers) {
+        for (int i = 0; i < engine->num_workers; i++) {
+            worker_t *worker = &engine->workers[i];
+            for (int k = 0; k < worker->easy_pool_len; k++) {
+                curl_easy_cleanup(worker->easy_pool[k]);
+            }
+            free(worker->easy_pool);
+            while (worker->active_pool) {
+                active_request_t *ar = worker->active_pool;
+                worker->active_pool = ar->next;
+                free(ar);
+            }
+            for (int c = 0; c < CURLRQ_PRIORITY_LEVELS; c++) free(worker->queues[c].items);
+            free(worker->retry_heap.items);
+            while (worker->cancels) {
+                cancel_node_t *c = worker->cancels;
+                worker->cancels = c->next;
+                free(c);
+            }
+            if (worker->default_headers) curl_slist_free_all(worker->default_headers);
+            if (worker->multi) curl_multi_cleanup(worker->multi);
+#if CURLRQ_USE_EPOLL
+            if (worker->epoll_fd >= 0) close(worker->epoll_fd);
+            if (worker->wake_fd >= 0) close(worker->wake_fd);
+            if (worker->timer_fd >= 0) close(worker->timer_fd);
+#endif
+        }
+        free(engine->workers);
+    }
+    if (engine->share) curl_share_cleanup(engine->share);
+    if (engine->cache) cache_destroy(engine->cache);
+    rate_clear(engine, 1);
+
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_destroy(&engine->share_locks[i]);
+    }
     pthread_mutex_destroy(&engine->mutex);
+    pthread_mutex_destroy(&engine->rate_mutex);
     pthread_cond_destroy(&engine->cond);
     free(engine);
 }
 
 int curlrq_add(curlrq_engine_t *engine, const curlrq_request_t *req, curlrq_callback_t cb)
 {
+    return add_request(engine, req, cb, 1) ? 0 : -1;
+}
+
+int curlrq_add_nocopy(curlrq_engine_t *engine, const curlrq_request_t *req, curlrq_callback_t cb)
+{
+    return add_request(engine, req, cb, 0) ? 0 : -1;
+}
+
+curlrq_handle_t curlrq_submit(curlrq_engine_t *engine, const curlrq_request_t *req, curlrq_callback_t cb)
+{
+    return add_request(engine, req, cb, 1);
+}
+
+int curlrq_cancel(curlrq_engine_t *engine, curlrq_handle_t handle)
+{
+    unsigned int index = (unsigned int)(handle % CURLRQ_MAX_WORKERS);
+    worker_t *worker;
+    cancel_node_t *cancel;
+    cancel_node_t *head;
+
+    if (!engine || handle == 0 || index >= (unsigned int)engine->num_workers) return -1;
+    worker = &engine->workers[index];
+
+    cancel = (cancel_node_t *)malloc(sizeof(*cancel));
+    if (!cancel) return -1;
+    cancel->seq = handle / CURLRQ_MAX_WORKERS;
+
+    /* 与 curlrq_add 一样登记后检查关闭标志，curlrq_cleanup 会等待登记的调用返回 */
+    RQ_ADD(&engine->adders, 1);
+    if (RQ_LOAD(&engine->shutdown)) {
+        RQ_ADD(&engine->adders, -1);
+        free(cancel);
+        return -1;
+    }
+
+    /*
+     * 无线程的 Worker 上没有执行中的请求；取消留在队列中，下次线程启动时处理（找不到请求则忽略）。
+     * 取消队列由空变非空时才唤醒，与提交队列相同。
+     */
+    head = RQ_LOAD(&worker->cancels);
+    do {
+        cancel->next = head;
+    } while (!RQ_CAS(&worker->cancels, &head, cancel));
+    if (head == NULL && RQ_LOAD(&worker->state) == WORKER_RUNNING) {
+        wake_worker(worker);
+    }
+
+    RQ_ADD(&engine->adders, -1);
+    return 0;
+}
+
+int curlrq_set_rate_limit(curlrq_engine_t *engine, const char *host, double requests_per_sec, int burst)
+{
+    long long interval_us = 0, tolerance_us = 0;
+    int rc = 0;
+
+    if (!engine) return -1;
+    if (requests_per_sec > 0) {
+        interval_us = (long long)(1e6 / requests_per_sec);
+        if (interval_us < 1) interval_us = 1;
+        tolerance_us = (long long)(burst > 1 ? burst - 1 : 0) * interval_us;
+    }
+
+    pthread_mutex_lock(&engine->rate_mutex);
+    if (!host) {
+        /* 默认限速改变：丢弃按旧默认值创建的桶，之后按新值重建 */
+        engine->rate_interval_us  = interval_us;
+        engine->rate_tolerance_us = tolerance_us;
+        rate_clear(engine, 0);
+    } else {
+        char lower[CURLRQ_HOST_MAX];
+        size_t len = strlen(host);
+        host_limit_t *limit;
+
+        if (len == 0 || len >= sizeof(lower)) {
+            pthread_mutex_unlock(&engine->rate_mutex);
+            return -1;
+        }
+        for (size_t i = 0; i <= len; i++) {
+            char c = host[i];
+            lower[i] = c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+        }
+        limit = rate_find(engine, lower, host_hash(lower));
+        if (limit && interval_us > 0) {
+            limit->configured   = 1;
+            limit->interval_us  = interval_us;
+            limit->tolerance_us = tolerance_us;
+        } else if (limit) {
+            /* 取消单独设置：删除后按默认限速（如有）重建 */
+            rate_remove(engine, limit);
+        } else if (interval_us > 0 && !rate_insert(engine, lower, host_hash(lower), interval_us, tolerance_us, 1)) {
+            rc = -1;
+        }
+    }
+    if (interval_us > 0) RQ_STORE(&engine->rate_enabled, 1);
+    pthread_mutex_unlock(&engine->rate_mutex);
+    return rc;
+}
+
+/**
+ * add_request - curlrq_add / curlrq_add_nocopy / curlrq_submit 的共同实现
+ * @param copy 1=拷贝请求字符串，0=引用调用方内存
+ * @return 请求句柄（加入顺序号与 Worker 下标），失败返回 0
+ */
+static curlrq_handle_t add_request(curlrq_engine_t *engine, const curlrq_request_t *req, curlrq_callback_t cb,
+                                   int copy)
+{
+    curlrq_handle_t handle;
     request_node_t *node;
+    worker_t *worker;
+    int max_queue_len;
+    int c;
+
+    if (!engine || !req || !cb) return 0;
+    if (!req->url || req->url[0] == '\0') return 0;
 
-    if (!engine || !req || !cb) return -1;
-    if (!req->url || req->url[0] == '\0') return -1;
-
-    /* 分配队列节点 */
-    node = (request_node_t *)calloc(1, sizeof(*node));
-    if (!node) return -1;
-
-    /* 深层拷贝请求数据，未被用户显式设置的字段继承引擎默认值 */
-    node->req.url               = strdup_safe(req->url);
-    node->req.method            = strdup_safe(req->method);
-    node->req.body              = strdup_safe(req->body);
-    node->req.body_len          = (req->body && req->body_len == 0) ? strlen(req->body)
-                                : (req->body ? req->body_len : 0);
-    node->req.headers           = NULL;
-    node->req.timeout_ms        = req->timeout_ms > 0 ? req->timeout_ms : engine->default_timeout_ms;
+    /* 分配队列节点，请求字符串与请求头一起放入节点的 arena */
+    node = node_create(req, copy);
+    if (!node) return 0;
+
+    /* 未被用户显式设置的字段继承引擎默认值 */
+    node->req.timeout_ms        = req->timeout_ms > 0 ? req->timeout_ms
+                                : RQ_LOAD(&engine->default_timeout_ms);
     node->req.connect_timeout_ms= req->connect_timeout_ms > 0 ? req->connect_timeout_ms
-                                : engine->default_connect_timeout_ms;
+                                : RQ_LOAD(&engine->default_connect_timeout_ms);
     node->req.max_response_size = req->max_response_size > 0 ? req->max_response_size
-                                : engine->default_max_response_size;
-    node->req.verify_ssl        = (req->verify_ssl || !engine->default_verify_ssl)
-                                ? req->verify_ssl : engine->default_verify_ssl;
+                                : RQ_LOAD(&engine->default_max_response_size);
+    node->req.verify_ssl        = (req->verify_ssl || !RQ_LOAD(&engine->default_verify_ssl))
+                                ? req->verify_ssl : 1;
     node->req.user_data         = req->user_data;
-
-    /* 将请求头转为 curl_slist（不含引擎默认头，在 start_request 中合并） */
-    if (req->headers) {
-        node->headers = build_slist(req->headers);
+    node->req.output_fd         = req->output_fd > 0 ? req->output_fd : 0;
+    node->req.priority          = req->priority;
+    node->req.deadline_ms       = req->deadline_ms > 0 ? req->deadline_ms : 0;
+    node->req.no_cache          = req->no_cache;
+    node->enqueued_us           = now_us();
+    if (req->stream) {
+        node->stream     = *req->stream;
+        node->req.stream = &node->stream;
     }
 
     node->callback = cb;
     node->next = NULL;
 
-    /* 加入队列尾部 */
-    pthread_mutex_lock(&engine->mutex);
-
     /*
-     * 引擎正在清理中，拒绝新请求。
-     * 避免 curlrq_cleanup 与 curlrq_add 并发时请求丢失。
+     * 以下不加锁。先登记为正在提交，再检查关闭标志：
+     * curlrq_cleanup 置位 shutdown 后会等所有已登记的提交返回，避免请求在引擎释放后入队。
      */
-    if (engine->shutdown) {
-        pthread_mutex_unlock(&engine->mutex);
-        if (node->headers) curl_slist_free_all(node->headers);
-        free((void *)node->req.url);
-        free((void *)node->req.method);
-        free((void *)node->req.body);
-        free(node);
-        return -1;
+    RQ_ADD(&engine->adders, 1);
+    if (RQ_LOAD(&engine->shutdown)) {
+        RQ_ADD(&engine->adders, -1);
+        free_node(node);
+        return 0;
     }
 
     /*
      * 队列满检查。max_queue_len=0 表示无限制。
+     * 先占位再比较，并发提交也不会超过上限。
      */
-    if (engine->max_queue_len > 0 && engine->queue_len >= engine->max_queue_len) {
-        pthread_mutex_unlock(&engine->mutex);
-        if (node->headers) curl_slist_free_all(node->headers);
-        free((void *)node->req.url);
-        free((void *)node->req.method);
-        free((void *)node->req.body);
-        free(node);
-        return -1;
+    max_queue_len = RQ_LOAD(&engine->max_queue_len);
+    if (RQ_ADD(&engine->queue_len, 1) > max_queue_len && max_queue_len > 0) {
+        RQ_ADD(&engine->queue_len, -1);
+        RQ_ADD(&engine->adders, -1);
+        free_node(node);
+        return 0;
     }
 
-    if (engine->queue_tail) {
-        engine->queue_tail->next = node;
-    } else {
-        engine->queue_head = node;
+    /*
+     * 惰性启动：Worker 无线程时先创建线程，失败则不入队。
+     * 线程创建走 engine->mutex 慢路径，只在 Worker 空闲退出后的第一个请求发生。
+     */
+    worker = pick_worker(engine, node->req.url);
+    if (RQ_LOAD(&worker->state) == WORKER_STOPPED && start_worker(worker) != 0) {
+        RQ_ADD(&engine->queue_len, -1);
+        RQ_ADD(&engine->adders, -1);
+        free_node(node);
+        return 0;
+    }
+
+    c = queue_class(node->req.priority);
+    node->seq = RQ_ADD(&engine->next_seq, 1);
+    handle = node->seq * CURLRQ_MAX_WORKERS + (curlrq_handle_t)(worker - engine->workers);
+    RQ_ADD(&engine->class_len[c], 1);
+
+    /* 提交队列由空变非空时才需要唤醒，否则 Worker 尚未取走，已有唤醒在途 */
+    if (inbox_push(worker, node)) {
+        wake_worker(worker);
     }
-    engine->queue_tail = node;
-    engine->queue_len++;
 
     /*
-     * 惰性启动：无线程时创建新线程，已有线程则 signal 唤醒。
-     * thread_running 在 mutex 保护下读写，避免竞态。
+     * 入队前检查到线程运行中，但它可能随后空闲退出：
+     * Worker 退出前会在 state 置为 STOPPED 后再检查一次提交队列，
+     * 这里在入队后再读一次 state，两次检查保证请求不会滞留在无线程的 Worker 上。
+     * 此处线程创建失败时请求留在队列中，由下一次 curlrq_add 或 curlrq_cleanup 处理。
      */
-    if (!engine->thread_running) {
-        engine->thread_running = 1;
-        if (pthread_create(&engine->thread, NULL, worker_thread, engine) != 0) {
-            engine->thread_running = 0;
-            pthread_mutex_unlock(&engine->mutex);
-            /* 释放节点 */
-            if (node->headers) curl_slist_free_all(node->headers);
-            free((void *)node->req.url);
-            free((void *)node->req.method);
-            free((void *)node->req.body);
-            free(node);
-            return -1;
-        }
-    } else {
-        pthread_cond_broadcast(&engine->cond);
+    if (RQ_LOAD(&worker->state) == WORKER_STOPPED) {
+        start_worker(worker);
     }
-    pthread_mutex_unlock(&engine->mutex);
 
-    return 0;
+    RQ_ADD(&engine->adders, -1);
+    return handle;
 }
 
 void curlrq_wait(curlrq_engine_t *engine)
 {
     if (!engine) return;
 
+    /* 登记为等待者后，Worker 完成请求时才会加锁广播 */
+    RQ_ADD(&engine->waiters, 1);
     pthread_mutex_lock(&engine->mutex);
-    while (engine->queue_head != NULL || engine->active_count > 0) {
+    while (RQ_LOAD(&engine->queue_len) > 0 || active_total(engine) > 0) {
         pthread_cond_wait(&engine->cond, &engine->mutex);
     }
     pthread_mutex_unlock(&engine->mutex);
+    RQ_ADD(&engine->waiters, -1);
 }
 
 int curlrq_pending(curlrq_engine_t *engine)
 {
-    int count = 0;
     if (!engine) return 0;
-    pthread_mutex_lock(&engine->mutex);
-    for (request_node_t *n = engine->queue_head; n; n = n->next) count++;
-    pthread_mutex_unlock(&engine->mutex);
-    return count;
+    return RQ_LOAD(&engine->queue_len);
 }
 
 int curlrq_active(curlrq_engine_t *engine)
 {
-    int count = 0;
     if (!engine) return 0;
-    pthread_mutex_lock(&engine->mutex);
-    count = engine->active_count;
-    pthread_mutex_unlock(&engine->mutex);
-    return count;
+    return active_total(engine);
+}
+
+int curlrq_pending_priority(curlrq_engine_t *engine, curlrq_priority_t priority)
+{
+    if (!engine) return 0;
+    return RQ_LOAD(&engine->class_len[queue_class(priority)]);
+}
+
+void curlrq_stats(curlrq_engine_t *engine, curlrq_stats_t *stats)
+{
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!engine) return;
+
+    /* curlrq_stats_t 全部是 unsigned long long，按数组逐项合计 */
+    for (int i = 0; i < engine->num_workers; i++) {
+        const unsigned long long *src = (const unsigned long long *)&engine->workers[i].stats;
+        unsigned long long *dst = (unsigned long long *)stats;
+        for (size_t k = 0; k < sizeof(*stats) / sizeof(unsigned long long); k++) {
+            dst[k] += RQ_PEEK(&src[k]);
+        }
+    }
+}
+
+long long curlrq_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
 }
 
 void curlrq_response_free(curlrq_response_t *resp)
@@ -371,184 +1073,466 @@ void curlrq_response_free(curlrq_response_t *resp)
 
 static void *worker_thread(void *arg)
 {
-    curlrq_engine_t *engine = (curlrq_engine_t *)arg;
+    worker_t *worker = (worker_t *)arg;
+    curlrq_engine_t *engine = worker->engine;
 
     while (1) {
-        pthread_mutex_lock(&engine->mutex);
+        int idle;
+        int shutdown;
+        long wait_ms = -1;
 
         /*
-         * 如果队列空且无活跃请求，等待新任务或关闭信号。
-         * 使用 pthread_cond_timedwait 带超时等待，空闲超时后线程自行退出。
+         * 取走新提交的请求，放入优先级队列，然后处理取消。
+         * 先取取消队列：取消总在请求入队之后提交，看到取消时一定也能取到对应的请求。
          */
-        while (engine->queue_head == NULL && engine->active_count == 0 && !engine->shutdown) {
-            struct timespec ts;
-            clock_gettime(CLOCK_REALTIME, &ts);
-            ts.tv_sec += CURLRQ_IDLE_TIMEOUT_SEC;
-            int rc = pthread_cond_timedwait(&engine->cond, &engine->mutex, &ts);
-            if (rc == ETIMEDOUT) {
-                /*
-                 * 超时返回，需二次确认条件（超时期间可能有 curlrq_add 加入请求）。
-                 * while 条件不满足（即有请求或 shutdown）则继续，否则在此退出。
-                 */
-                if (engine->queue_head == NULL && engine->active_count == 0 && !engine->shutdown) {
-                    /* 真正空闲，退出线程 */
-                    engine->thread_running = 0;
-                    pthread_mutex_unlock(&engine->mutex);
-                    return NULL;
-                }
-            }
+        {
+            cancel_node_t *cancels = RQ_XCHG(&worker->cancels, (cancel_node_t *)NULL);
+            take_inbox(worker);
+            take_cancels(worker, cancels);
         }
+        shutdown = RQ_LOAD(&engine->shutdown);
 
-        /* 关闭处理：先等待所有活跃请求完成，再清理队列 */
-        if (engine->shutdown) {
-            if (engine->active_count > 0) {
-                /* 还有活跃请求，继续处理 */
-                pthread_mutex_unlock(&engine->mutex);
-                goto do_multi;
-            }
-            /* 无活跃请求，清理队列中剩余请求 */
-            drain_queue(engine);
-            engine->thread_running = 0;
-            pthread_mutex_unlock(&engine->mutex);
+        /* 关闭处理：先等待所有活跃请求完成，再清理队列；线程由 curlrq_cleanup join */
+        if (shutdown && worker->active_count == 0) {
+            drain_queue(worker);
             break;
         }
 
-        /*
-         * 从队列取出请求，启动新的 HTTP 请求，
-         * 直到达到最大并发数或队列为空。
-         */
-        while (engine->active_count < engine->max_concurrent && engine->queue_head != NULL) {
-            request_node_t *node = engine->queue_head;
-            engine->queue_head = node->next;
-            if (engine->queue_tail == node) engine->queue_tail = NULL;
-            node->next = NULL;
-            engine->queue_len--;
-
-            if (start_request(engine, node) != 0) {
-                /* 启动失败，立即回调返回错误 */
-                node->next = NULL;
-                pthread_mutex_unlock(&engine->mutex);
-
-                curlrq_response_t resp;
-                memset(&resp, 0, sizeof(resp));
-                resp.curl_code  = CURLE_FAILED_INIT;
-                resp.error_msg  = strdup_safe("failed to initialize easy handle");
-                resp.http_code  = 0;
-
-                /* 回调负责调用 curlrq_response_free 释放响应数据 */
-                node->callback(&resp, node->req.user_data);
-
-                /* 释放节点 */
-                if (node->headers) curl_slist_free_all(node->headers);
-                free((void *)node->req.url);
-                free((void *)node->req.method);
-                free((void *)node->req.body);
-                free(node);
-
-                pthread_mutex_lock(&engine->mutex);
-            }
-        }
-
-        pthread_mutex_unlock(&engine->mutex);
+        if (!shutdown) {
+            request_node_t *node;
+            long long now = curlrq_now_ms();
 
-do_multi:
-        /*
-         * 执行 curl_multi_perform 驱动数据传输。
-         * 非活跃时跳过，避免 busy-loop。
-         */
-        if (engine->active_count == 0) {
-            /* 无活跃请求，回到循环顶部等待 */
-            continue;
-        }
+            /* multi 句柄只在所属 Worker 线程中使用，选项变更也在这里应用 */
+            if (RQ_XCHG(&worker->opts_dirty, 0)) {
+                apply_engine_opts(worker);
+            }
 
-        {
-            int running_handles;
-            CURLMcode mc;
+            /* 退避结束的重试请求回到优先级队列 */
+            promote_retries(worker, now);
 
-            /* 驱动 libcurl 数据传输 */
-            mc = curl_multi_perform(engine->multi, &running_handles);
-            if (mc != CURLM_OK) {
-                /* multi 接口错误，尝试继续 */
+            /* 已过截止时间的请求不再发送，直接失败 */
+            while ((node = queue_pop_expired(worker, now)) != NULL) {
+                finish_unstarted(worker, node, CURLE_OPERATION_TIMEDOUT,
+                                 "deadline expired before the request was started");
+            }
+            while ((node = retry_pop_expired(worker, now)) != NULL) {
+                finish_unstarted(worker, node, CURLE_OPERATION_TIMEDOUT,
+                                 "deadline expired before the request was started");
             }
 
             /*
-             * 检查已完成的请求（传输结束，不论成功或失败）。
-             * curl_multi_info_read 返回所有完成的 easy 句柄。
+             * 按优先级与截止时间从队列取出请求，启动新的 HTTP 请求，
+             * 直到达到最大并发数或队列为空。
+             * 先计入活跃数再减少排队数，curlrq_wait 不会在两者之间看到全为 0。
              */
-            CURLMsg *msg;
-            int msgs_left;
-            while ((msg = curl_multi_info_read(engine->multi, &msgs_left)) != NULL) {
-                if (msg->msg == CURLMSG_DONE) {
-                    complete_request(engine, msg->easy_handle, msg->data.result);
+            while (worker->active_count + worker->hedge_count < engine->max_concurrent &&
+                   (node = queue_pop(worker)) != NULL) {
+                RQ_ADD(&worker->active_count, 1);
+                RQ_ADD(&engine->queue_len, -1);
+
+                switch (start_request(worker, node)) {
+                case 0:
+                    break;
+                case 2:
+                    /* 等待限速令牌，已进入重试堆，不占并发槽位 */
+                    RQ_ADD(&engine->queue_len, 1);
+                    RQ_ADD(&worker->active_count, -1);
+                    break;
+                case 1:
+                    /* 缓存命中，已回调 */
+                    RQ_ADD(&worker->active_count, -1);
+                    notify_waiters(engine);
+                    break;
+                case 3:
+                    /* 截止时间前等不到限速令牌，按过期失败 */
+                    count_result(worker, error_class(CURLE_OPERATION_TIMEDOUT, 0));
+                    fail_request(node, CURLE_OPERATION_TIMEDOUT, "deadline expired before the request was started");
+                    RQ_ADD(&worker->active_count, -1);
+                    notify_waiters(engine);
+                    break;
+                default:
+                    /* 启动失败，立即回调返回错误 */
+                    count_result(worker, CURLRQ_ERR_OTHER);
+                    fail_request(node, CURLE_FAILED_INIT, "failed to initialize easy handle");
+                    RQ_ADD(&worker->active_count, -1);
+                    notify_waiters(engine);
+                    break;
                 }
             }
+            wait_ms = schedule_wait(worker, now, start_hedges(worker, now));
+        }
 
-            /* 等待 socket 活动，有超时防止永久阻塞 */
-            if (running_handles > 0) {
-                curl_multi_wait(engine->multi, NULL, 0, CURLRQ_MULTI_WAIT_MS, NULL);
-            }
+        idle = worker->queue_len == 0 && worker->retry_heap.len == 0 && worker->active_count == 0 && !shutdown;
+
+        /*
+         * 等待 socket/定时器/新任务并驱动传输。
+         * 空闲时最多等待 CURLRQ_IDLE_TIMEOUT_SEC，超时后需二次确认条件
+         * （期间可能有 curlrq_add 加入请求），真正空闲则线程自行退出。
+         * 队列中有带截止时间的请求时最多等到最早的截止时间，到期即失败。
+         */
+        if (worker_wait(worker, idle, wait_ms) == 0 && idle && stop_worker(worker)) {
+            break;
         }
     }
 
     return NULL;
 }
 
-/* ------------------------------------------------------------------ */
-/*  启动单个请求                                                       */
-/* ------------------------------------------------------------------ */
-
 /**
- * start_request - 将一个队列节点转为活跃请求
- * 调用时必须持有 engine->mutex
+ * start_worker - Worker 无线程时创建线程
+ * @return 0 线程已在运行或创建成功，-1 创建失败
+ *
+ * 慢路径，持 engine->mutex。空闲退出的旧线程在这里 join 后再创建新线程。
  */
-static int start_request(curlrq_engine_t *engine, request_node_t *node)
+static int start_worker(worker_t *worker)
 {
-    CURL *easy;
-    active_request_t *ar;
-    const char *method;
-    long verify_ssl;
-
-    easy = curl_easy_init();
-    if (!easy) return -1;
+    curlrq_engine_t *engine = worker->engine;
+    int rc = 0;
 
-    ar = (active_request_t *)calloc(1, sizeof(*ar));
-    if (!ar) {
-        curl_easy_cleanup(easy);
-        return -1;
+    pthread_mutex_lock(&engine->mutex);
+    if (RQ_LOAD(&worker->state) == WORKER_STOPPED) {
+        if (worker->thread_alive) {
+            /* 旧线程已置 STOPPED，正在或已经返回 */
+            pthread_join(worker->thread, NULL);
+            worker->thread_alive = 0;
+        }
+        RQ_STORE(&worker->state, WORKER_RUNNING);
+        if (pthread_create(&worker->thread, NULL, worker_thread, worker) == 0) {
+            worker->thread_alive = 1;
+        } else {
+            RQ_STORE(&worker->state, WORKER_STOPPED);
+            rc = -1;
+        }
     }
+    pthread_mutex_unlock(&engine->mutex);
+    return rc;
+}
 
-    ar->easy   = easy;
-    ar->node   = node;
-    ar->url    = strdup_safe(node->req.url);
-    ar->body   = strdup_safe(node->req.body);
-    ar->body_len = node->req.body_len;
-    /*
-     * 构建最终头链表：引擎默认头在前，请求头在后。
-     * 后添加的同名头会覆盖前者，实现请求头 > 引擎默认头 的优先级。
-     */
-    {
-        struct curl_slist *merged = NULL;
-        /* 先拷贝引擎默认头 */
-        if (engine->default_headers) {
-            for (struct curl_slist *cur = engine->default_headers; cur; cur = cur->next) {
-                struct curl_slist *tmp = curl_slist_append(merged, cur->data);
-                if (tmp) merged = tmp;
-            }
+/**
+ * stop_worker - 空闲超时后尝试让 Worker 线程退出
+ * @return 1 线程应当退出，0 期间有新请求，继续运行
+ *
+ * 先把 state 置为 STOPPED 再检查提交队列，与 curlrq_add 的"入队后读 state"配对：
+ * 要么这里看到新请求继续运行，要么 curlrq_add 看到 STOPPED 并创建新线程。
+ */
+static int stop_worker(worker_t *worker)
+{
+    curlrq_engine_t *engine = worker->engine;
+    int stop = 1;
+
+    pthread_mutex_lock(&engine->mutex);
+    RQ_STORE(&worker->state, WORKER_STOPPED);
+    if (RQ_LOAD(&worker->inbox) != NULL || RQ_LOAD(&engine->shutdown)) {
+        RQ_STORE(&worker->state, WORKER_RUNNING);
+        stop = 0;
+    }
+    pthread_mutex_unlock(&engine->mutex);
+    return stop;
+}
+
+/**
+ * check_multi_info - 处理所有已完成的传输（不论成功或失败）
+ */
+static void check_multi_info(worker_t *worker)
+{
+    CURLMsg *msg;
+    int msgs_left;
+
+    while ((msg = curl_multi_info_read(worker->multi, &msgs_left)) != NULL) {
+        if (msg->msg == CURLMSG_DONE) {
+            complete_request(worker, msg->easy_handle, msg->data.result);
+        }
+    }
+}
+
+#if CURLRQ_USE_EPOLL
+
+/* ------------------------------------------------------------------ */
+/*  epoll 事件循环                                                     */
+/* ------------------------------------------------------------------ */
+
+/**
+ * worker_wait - 等待一轮事件并驱动 curl_multi_socket_action
+ * @param idle    1=Worker 空闲，最多等待 CURLRQ_IDLE_TIMEOUT_SEC；0=由事件唤醒
+ * @param wait_ms 非空闲时的最长等待（毫秒），-1=不限
+ * @return 0 等待超时，1 处理了事件
+ *
+ * 不持有 engine->mutex 调用。没有事件时线程阻塞在 epoll_wait 中，不占用 CPU；
+ * libcurl 的超时由 timerfd 触发，新任务由 curlrq_add 写 eventfd 立即唤醒。
+ */
+static int worker_wait(worker_t *worker, int idle, long wait_ms)
+{
+    struct epoll_event events[CURLRQ_EPOLL_EVENTS];
+    int running_handles;
+    int n;
+
+    n = epoll_wait(worker->epoll_fd, events, CURLRQ_EPOLL_EVENTS,
+                   idle ? CURLRQ_IDLE_TIMEOUT_SEC * 1000 : (int)wait_ms);
+    if (n == 0) return 0;
+    if (n < 0) return 1;  /* EINTR，回到循环顶部重新检查 */
+
+    for (int i = 0; i < n; i++) {
+        int fd = events[i].data.fd;
+        uint64_t count;
+
+        if (fd == worker->wake_fd) {
+            /* 只需清空计数，新任务在循环顶部启动 */
+            if (read(worker->wake_fd, &count, sizeof(count)) < 0) { /* EAGAIN */ }
+        } else if (fd == worker->timer_fd) {
+            if (read(worker->timer_fd, &count, sizeof(count)) < 0) { /* EAGAIN */ }
+            curl_multi_socket_action(worker->multi, CURL_SOCKET_TIMEOUT, 0, &running_handles);
+        } else {
+            int flags = 0;
+            if (events[i].events & EPOLLIN)  flags |= CURL_CSELECT_IN;
+            if (events[i].events & EPOLLOUT) flags |= CURL_CSELECT_OUT;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) flags |= CURL_CSELECT_ERR;
+            curl_multi_socket_action(worker->multi, fd, flags, &running_handles);
+        }
+    }
+
+    check_multi_info(worker);
+    return 1;
+}
+
+/**
+ * wake_worker - 唤醒阻塞在 epoll_wait 中的 Worker
+ */
+static void wake_worker(worker_t *worker)
+{
+    uint64_t one = 1;
+    if (write(worker->wake_fd, &one, sizeof(one)) < 0) { /* 计数溢出时已处于可读状态 */ }
+}
+
+/**
+ * socket_cb - CURLMOPT_SOCKETFUNCTION
+ * 按 libcurl 的要求在 epoll 中添加/修改/删除 socket。
+ * socketp 非 NULL 表示该 socket 已在 epoll 中（通过 curl_multi_assign 标记）。
+ */
+static int socket_cb(CURL *easy, curl_socket_t s, int what, void *userp, void *socketp)
+{
+    worker_t *worker = (worker_t *)userp;
+    struct epoll_event ev;
+    (void)easy;
+
+    if (what == CURL_POLL_REMOVE) {
+        if (socketp) {
+            epoll_ctl(worker->epoll_fd, EPOLL_CTL_DEL, s, NULL);
+            curl_multi_assign(worker->multi, s, NULL);
+        }
+        return 0;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.data.fd = s;
+    if (what & CURL_POLL_IN)  ev.events |= EPOLLIN;
+    if (what & CURL_POLL_OUT) ev.events |= EPOLLOUT;
+
+    if (socketp) {
+        epoll_ctl(worker->epoll_fd, EPOLL_CTL_MOD, s, &ev);
+    } else {
+        epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, s, &ev);
+        curl_multi_assign(worker->multi, s, worker);
+    }
+    return 0;
+}
+
+/**
+ * timer_cb - CURLMOPT_TIMERFUNCTION
+ * 将 libcurl 请求的超时设置到 timerfd：-1=停止，0=尽快（不能在回调中直接调用 socket_action）。
+ */
+static int timer_cb(CURLM *multi, long timeout_ms, void *userp)
+{
+    worker_t *worker = (worker_t *)userp;
+    struct itimerspec its;
+    (void)multi;
+
+    memset(&its, 0, sizeof(its));
+    if (timeout_ms > 0) {
+        its.it_value.tv_sec  = timeout_ms / 1000;
+        its.it_value.tv_nsec = (timeout_ms % 1000) * 1000000L;
+    } else if (timeout_ms == 0) {
+        its.it_value.tv_nsec = 1;
+    }
+    timerfd_settime(worker->timer_fd, 0, &its, NULL);
+    return 0;
+}
+
+#else
+
+/* ------------------------------------------------------------------ */
+/*  curl_multi_poll 循环（非 epoll 平台）                               */
+/* ------------------------------------------------------------------ */
+
+/**
+ * worker_wait - 空闲时等待新任务，否则执行一轮 curl_multi_perform + curl_multi_poll
+ * @param wait_ms 非空闲时的最长等待（毫秒），-1=不限；轮询本身最多 CURLRQ_MULTI_WAIT_MS
+ * @return 0 空闲等待超时，1 其他情况
+ */
+static int worker_wait(worker_t *worker, int idle, long wait_ms)
+{
+    curlrq_engine_t *engine = worker->engine;
+    int running_handles;
+
+    if (idle) {
+        /* 没有传输时 curl_multi_poll 只等 curl_multi_wakeup，唤醒信号不会丢失 */
+        long long start = curlrq_now_ms();
+        curl_multi_poll(worker->multi, NULL, 0, CURLRQ_IDLE_TIMEOUT_SEC * 1000, NULL);
+        if (RQ_LOAD(&worker->inbox) == NULL && !RQ_LOAD(&engine->shutdown) &&
+            curlrq_now_ms() - start >= CURLRQ_IDLE_TIMEOUT_SEC * 1000) {
+            return 0;
+        }
+        return 1;
+    }
+
+    curl_multi_perform(worker->multi, &running_handles);
+    check_multi_info(worker);
+
+    /* 等待 socket 活动，有超时防止永久阻塞；新任务入队时 curl_multi_wakeup 提前唤醒 */
+    if (running_handles > 0) {
+        int poll_ms = CURLRQ_MULTI_WAIT_MS;
+        if (wait_ms >= 0 && wait_ms < poll_ms) poll_ms = (int)wait_ms;
+        curl_multi_poll(worker->multi, NULL, 0, poll_ms, NULL);
+    }
+    return 1;
+}
+
+/**
+ * wake_worker - 唤醒阻塞在 curl_multi_poll 中的 Worker（线程安全，不需加锁）
+ */
+static void wake_worker(worker_t *worker)
+{
+    curl_multi_wakeup(worker->multi);
+}
+
+#endif
+
+/* ------------------------------------------------------------------ */
+/*  启动单个请求                                                       */
+/* ------------------------------------------------------------------ */
+
+/**
+ * start_request - 将一个队列节点转为活跃请求
+ * 只在 Worker 线程中调用；活跃计数由调用方维护
+ *
+ * @return 0 已启动，1 新鲜期内命中缓存、已回调（节点已释放），2 等待限速令牌（节点已进入重试堆），
+ *         3 截止时间前等不到限速令牌（令牌已归还，节点由调用方失败），-1 失败
+ *
+ * 开启缓存时，缓存条目新鲜则直接回调；过期但有 ETag/Last-Modified 时带条件请求头重新验证。
+ * 主机设置了限速时先预留令牌，需要等待的请求按令牌可用时间进入重试堆；
+ * 令牌可用时间已超过截止时间的请求不占令牌，直接按过期处理。
+ * 开启对冲且已有足够耗时样本时，只读、非流式的请求在 max(p95, 最小延迟) 后由 start_hedges 发出副本。
+ */
+static int start_request(worker_t *worker, request_node_t *node)
+{
+    response_cache_t *cache = worker->engine->cache;
+    cache_entry_t *entry = NULL;
+    active_request_t *ar;
+
+    if (cache && cache_eligible(node) && (entry = cache_lookup(worker, node)) != NULL) {
+        if (cache_fresh(cache, entry)) {
+            if (node->attempts == 0) record_queue_time(worker, node);
+            if (deliver_cached(worker, node, entry) == 0) return 1;
+        }
+        if (!entry->etag && !entry->last_modified) {
+            cache_release(cache, entry);
+            entry = NULL;
         }
-        /* 再追加请求头 */
-        if (node->headers) {
-            for (struct curl_slist *cur = node->headers; cur; cur = cur->next) {
-                struct curl_slist *tmp = curl_slist_append(merged, cur->data);
-                if (tmp) merged = tmp;
+    }
+
+    if (node->rate_reserved) {
+        node->rate_reserved = 0;
+    } else if (RQ_LOAD(&worker->engine->rate_enabled)) {
+        long long now = curlrq_now_ms();
+        long long delay_us;
+        if (node->req.deadline_ms > 0 && node->req.deadline_ms <= now) {
+            if (entry) cache_release(cache, entry);
+            return 3;
+        }
+        delay_us = rate_reserve(worker->engine, node->req.url, 0);
+        if (delay_us > 0) {
+            node->retry_at = now + (delay_us + 999) / 1000;
+            if (node->req.deadline_ms > 0 && node->retry_at > node->req.deadline_ms) {
+                rate_release(worker->engine, node->req.url);
+                if (entry) cache_release(cache, entry);
+                return 3;
+            }
+            node->rate_reserved = 1;
+            if (heap_push(&worker->retry_heap, node, retry_before) == 0) {
+                if (entry) cache_release(cache, entry);
+                return 2;
             }
-            curl_slist_free_all(node->headers);
+            node->rate_reserved = 0;
         }
-        ar->headers = merged;
-        node->headers = NULL;
+    }
+
+    if (node->attempts == 0) record_queue_time(worker, node);
+    ar = start_transfer(worker, node, entry);
+    if (entry) cache_release(cache, entry);  /* start_transfer 持有自己的引用 */
+
+    if (!ar) return -1;
+    if (worker->hedging && worker->hedge_delay_ms > 0 && method_safe(node->req.method) &&
+        !node->req.stream && node->req.output_fd <= 0) {
+        long delay = worker->hedge_delay_ms > worker->hedge_min_delay_ms ? worker->hedge_delay_ms
+                                                                        : worker->hedge_min_delay_ms;
+        ar->hedge_at = curlrq_now_ms() + delay;
+        worker->hedge_armed++;
+    }
+    return 0;
+}
+
+/**
+ * start_transfer - 为节点配置一个 easy 句柄并加入 multi 句柄
+ * @return 活跃请求控制块，失败返回 NULL
+ *
+ * @param entry 要重新验证的缓存条目，NULL=普通请求
+ *
+ * 对冲副本与原请求共用同一个节点，各自有独立的 easy 句柄和响应缓存。
+ */
+static active_request_t *start_transfer(worker_t *worker, request_node_t *node, cache_entry_t *entry)
+{
+    CURL *easy;
+    active_request_t *ar;
+    const char *method;
+    long verify_ssl;
+
+    easy = acquire_easy(worker);
+    if (!easy) return NULL;
+
+    ar = acquire_active(worker);
+    if (!ar) {
+        release_easy(worker, easy);
+        return NULL;
+    }
+
+    ar->easy   = easy;
+    ar->node   = node;
+    /*
+     * 构建最终头链表：引擎默认头在前，请求头在后。
+     * 与请求头同名的默认头不拷贝，实现请求头 > 引擎默认头 的优先级。
+     * 请求头链表在节点 arena 中，直接接在默认头拷贝之后，不再逐个 curl_slist_append。
+     */
+    if (copy_default_headers(worker->default_headers, node->headers, &ar->default_block) != 0) {
+        release_active(worker, ar);
+        release_easy(worker, easy);
+        return NULL;
+    }
+    ar->headers = ar->default_block ? ar->default_block : node->headers;
+
+    /* 重新验证：条件请求头放在最前面 */
+    if (entry) {
+        ar->cond_block = conditional_headers(entry, ar->headers);
+        if (!ar->cond_block) {
+            release_active(worker, ar);
+            release_easy(worker, easy);
+            return NULL;
+        }
+        ar->headers = ar->cond_block;
+        ar->cache_entry = entry;
+        cache_retain(worker->engine->cache, entry);
     }
 
     /* 设置 URL */
-    curl_easy_setopt(easy, CURLOPT_URL, ar->url);
+    curl_easy_setopt(easy, CURLOPT_URL, node->req.url);
 
     /* 设置 HTTP 方法 */
     method = node->req.method;
@@ -563,9 +1547,9 @@ static int start_request(curlrq_engine_t *engine, request_node_t *node)
     }
 
     /* 设置请求体（非 GET/HEAD 且提供了 body） */
-    if (ar->body && method && strcmp(method, "GET") != 0 && strcmp(method, "HEAD") != 0) {
-        curl_easy_setopt(easy, CURLOPT_POSTFIELDS, ar->body);
-        curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, (long)ar->body_len);
+    if (node->req.body && method && strcmp(method, "GET") != 0 && strcmp(method, "HEAD") != 0) {
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDS, node->req.body);
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, (long)node->req.body_len);
     }
 
     /* 设置请求头 */
@@ -573,9 +1557,17 @@ static int start_request(curlrq_engine_t *engine, request_node_t *node)
         curl_easy_setopt(easy, CURLOPT_HTTPHEADER, ar->headers);
     }
 
-    /* 超时设置 */
-    if (node->req.timeout_ms > 0) {
-        curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, (long)node->req.timeout_ms);
+    /* 超时设置，有截止时间时总超时不超过剩余时间 */
+    {
+        long timeout_ms = node->req.timeout_ms;
+        if (node->req.deadline_ms > 0) {
+            long long remaining = node->req.deadline_ms - curlrq_now_ms();
+            if (remaining < 1) remaining = 1;
+            if (timeout_ms <= 0 || remaining < timeout_ms) timeout_ms = (long)remaining;
+        }
+        if (timeout_ms > 0) {
+            curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, timeout_ms);
+        }
     }
     if (node->req.connect_timeout_ms > 0) {
         curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, (long)node->req.connect_timeout_ms);
@@ -591,6 +1583,17 @@ static int start_request(curlrq_engine_t *engine, request_node_t *node)
         curl_easy_setopt(easy, CURLOPT_SSL_VERIFYHOST, 2L);
     }
 
+    /*
+     * HTTP/2 多路复用：PIPEWAIT 让请求优先等待已有连接协商完成，
+     * 以便复用同一连接的多个 stream，而不是并发建立多个连接。
+     */
+    if (worker->http2) {
+        curl_easy_setopt(easy, CURLOPT_HTTP_VERSION,
+                         worker->http2 == CURLRQ_HTTP2_PRIOR_KNOWLEDGE ? (long)CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE
+                                                                       : (long)CURL_HTTP_VERSION_2TLS);
+        curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+    }
+
     /* 自动跟随重定向 */
     curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
     curl_easy_setopt(easy, CURLOPT_MAXREDIRS, 10L);
@@ -607,14 +1610,14 @@ static int start_request(curlrq_engine_t *engine, request_node_t *node)
     curl_easy_setopt(easy, CURLOPT_PRIVATE, ar);
 
     /* 加入 multi 句柄 */
-    curl_multi_add_handle(engine->multi, easy);
+    curl_multi_add_handle(worker->multi, easy);
 
     /* 加入活跃列表 */
-    ar->next = engine->active_list;
-    engine->active_list = ar;
-    engine->active_count++;
+    ar->next = worker->active_list;
+    worker->active_list = ar;
+    node->attempts++;
 
-    return 0;
+    return ar;
 }
 
 /* ------------------------------------------------------------------ */
@@ -625,13 +1628,17 @@ static int start_request(curlrq_engine_t *engine, request_node_t *node)
  * complete_request - 处理一个完成的请求
  * 从活跃列表中查找对应的 easy_handle，提取响应数据，调用回调。
  *
- * 注意：完成处理分两步:
- *   1. cleanup_active (持锁) — 从活跃列表移除，提取信息
- *   2. callback (释锁后) — 调用用户回调
- * 这样避免回调中调用 curlrq_add 导致死锁。
+ * 注意：完成处理分三步，都在 Worker 线程中、不持锁执行:
+ *   1. cleanup_active — 从活跃列表移除，提取信息
+ *   2. callback — 调用用户回调（回调中可以调用 curlrq_add）
+ *   3. 活跃计数减一 — 之后 curlrq_wait 才可能返回
+ *
+ * 对冲中的一对传输先完成的一方若是可重试的失败则丢弃、另一方继续，否则取消另一方；
+ * 按重试策略需要重试时不回调，节点进入重试堆。
  */
-static void complete_request(curlrq_engine_t *engine, CURL *easy, CURLcode cr)
+static void complete_request(worker_t *worker, CURL *easy, CURLcode cr)
 {
+    curlrq_engine_t *engine = worker->engine;
     active_request_t *ar = NULL;
     curlrq_response_t resp;
     request_node_t *node;
@@ -643,6 +1650,7 @@ static void complete_request(curlrq_engine_t *engine, CURL *easy, CURLcode cr)
     if (!ar) return;
 
     node = ar->node;
+    count_transfer(worker, easy);
 
     /*
      * 在 cleanup_active 销毁 easy 句柄之前提取所有需要的信息。
@@ -653,31 +1661,86 @@ static void complete_request(curlrq_engine_t *engine, CURL *easy, CURLcode cr)
         curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME, &total_time);
         resp.total_time_ms = (long)(total_time * 1000.0 + 0.5);
     }
-    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &resp.http_code);
+    {
+        long http_code = 0;
+        curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &http_code);
+        resp.http_code = (int)http_code;
+    }
+
+    if (ar->peer) {
+        active_request_t *peer = ar->peer;
+
+        ar->peer   = NULL;
+        peer->peer = NULL;
+        worker->hedge_count--;
+        if (retryable_failure(worker, cr, resp.http_code)) {
+            cleanup_active(worker, ar, cr);
+            release_active(worker, ar);
+            return;
+        }
+        count_transfer(worker, peer->easy);
+        cleanup_active(worker, peer, CURLE_ABORTED_BY_CALLBACK);
+        release_active(worker, peer);
+    }
+
+    /* 只在开启对冲时采样，关闭时完成路径不多做工作 */
+    if (worker->hedging && cr == CURLE_OK && resp.http_code < 500) {
+        record_latency(worker, resp.total_time_ms);
+    }
+
+    /*
+     * 重试：节点进入重试堆，退避结束后按原来的加入顺序回到优先级队列。
+     * 先计入排队数再减少活跃数，curlrq_wait 不会在两者之间看到全为 0。
+     */
+    {
+        long delay_ms;
+        if (!RQ_LOAD(&engine->shutdown) && should_retry(worker, ar, cr, resp.http_code, &delay_ms)) {
+            node->retry_at = curlrq_now_ms() + delay_ms;
+            if (heap_push(&worker->retry_heap, node, retry_before) == 0) {
+                RQ_ADD(&engine->queue_len, 1);
+                cleanup_active(worker, ar, cr);
+                release_active(worker, ar);
+                RQ_ADD(&worker->active_count, -1);
+                return;
+            }
+        }
+    }
     {
         char *eff_url = NULL;
         curl_easy_getinfo(easy, CURLINFO_EFFECTIVE_URL, &eff_url);
         if (eff_url) resp.effective_url = strdup_safe(eff_url);
     }
+    fill_timing(easy, node, &resp);
+    count_result(worker, error_class(cr, resp.http_code));
 
-    /* 从引擎的活跃列表中移除（此函数会销毁 easy 句柄） */
-    pthread_mutex_lock(&engine->mutex);
-    cleanup_active(engine, ar, cr);
-    pthread_mutex_unlock(&engine->mutex);
+    /* 从活跃列表中移除（easy 句柄回收到句柄池） */
+    cleanup_active(worker, ar, cr);
 
-    /* --- 以下不再持有互斥锁 --- */
+    /*
+     * 响应缓存：304 用缓存条目的 body 与响应头回调（网络收到的 304 由 release_active 释放），
+     * 可缓存的 200 在转移所有权之前存入缓存。
+     */
+    if (ar->cache_entry && cr == CURLE_OK && resp.http_code == 304) {
+        cache_refresh(engine->cache, ar->cache_entry, ar->header_buf, ar->header_len);
+        if (cache_fill_response(ar->cache_entry, &resp) == 0) resp.cache_status = CURLRQ_CACHE_REVALIDATED;
+    } else if (engine->cache && cr == CURLE_OK && resp.http_code == 200 && cache_eligible(node)) {
+        cache_store(worker, node, ar);
+    }
 
-    /* 响应 body — 转移所有权 */
-    resp.response_body     = ar->write_buf;
-    resp.response_body_len = ar->write_len;
-    ar->write_buf = NULL;  /* 防止 cleanup 时二次释放 */
+    if (resp.cache_status == CURLRQ_CACHE_NONE) {
+        /* 响应 body — 转移所有权 */
+        resp.response_body     = ar->write_buf;
+        resp.response_body_len = ar->write_len;
+        ar->write_buf = NULL;  /* 防止 cleanup 时二次释放 */
 
-    /* 响应 headers — 转移所有权 */
-    resp.response_headers     = ar->header_buf;
-    resp.response_headers_len = ar->header_len;
-    ar->header_buf = NULL;
+        /* 响应 headers — 转移所有权 */
+        resp.response_headers     = ar->header_buf;
+        resp.response_headers_len = ar->header_len;
+        ar->header_buf = NULL;
+    }
 
     /* 错误信息 */
+    resp.attempts  = node->attempts;
     resp.curl_code = (int)cr;
     if (cr != CURLE_OK) {
         resp.error_msg = strdup_safe(curl_easy_strerror(cr));
@@ -692,31 +1755,28 @@ static void complete_request(curlrq_engine_t *engine, CURL *easy, CURLcode cr)
         node->callback(&resp, node->req.user_data);
     }
 
-    /* 释放资源 */
-    if (ar->headers) curl_slist_free_all(ar->headers);
-    if (ar->body) free(ar->body);
-    free(ar->url);
-    free(ar);
+    /* 控制块回收到 Worker 的控制块池 */
+    release_active(worker, ar);
 
     /* 释放请求节点 */
-    if (node) {
-        free((void *)node->req.url);
-        free((void *)node->req.method);
-        free((void *)node->req.body);
-        if (node->headers) curl_slist_free_all(node->headers);
-        free(node);
-    }
+    if (node) free_node(node);
+
+    /*
+     * 回调返回后才减少活跃计数，保证 curlrq_wait 返回时所有回调都已执行完毕。
+     * active_count 只在本 Worker 线程中修改，不会在回调期间启动超额请求。
+     */
+    RQ_ADD(&worker->active_count, -1);
+    notify_waiters(engine);
 }
 
 /**
  * cleanup_active - 从活跃列表移除指定 easy_handle
- * 同时从 multi 句柄移除并销毁 easy 句柄。
- * 调用时必须持有 engine->mutex。
+ * 同时从 multi 句柄移除，easy 句柄回收到句柄池。
  */
-static void cleanup_active(curlrq_engine_t *engine, active_request_t *target, CURLcode cr)
+static void cleanup_active(worker_t *worker, active_request_t *target, CURLcode cr)
 {
     (void)cr;  /* 暂未使用，保留参数供后续扩展 */
-    active_request_t **pp = &engine->active_list;
+    active_request_t **pp = &worker->active_list;
 
     while (*pp) {
         if (*pp == target) {
@@ -726,162 +1786,2193 @@ static void cleanup_active(curlrq_engine_t *engine, active_request_t *target, CU
         pp = &(*pp)->next;
     }
 
-    /* 从 multi 句柄移除 */
+    /* 从 multi 句柄移除，easy 句柄回收到句柄池 */
     if (target->easy) {
-        curl_multi_remove_handle(engine->multi, target->easy);
-        curl_easy_cleanup(target->easy);
+        curl_multi_remove_handle(worker->multi, target->easy);
+        release_easy(worker, target->easy);
         target->easy = NULL;
     }
-
-    if (engine->active_count > 0) engine->active_count--;
-
-    /* 唤醒可能正在 curlrq_wait 中等待的线程 */
-    pthread_cond_broadcast(&engine->cond);
 }
 
 /**
- * drain_queue - 清理队列中所有剩余请求
- * 对每个请求调用回调并标记为失败。
- * 调用时必须持有 engine->mutex。
+ * drain_queue - 清理 Worker 队列中所有剩余请求
+ * 按调度顺序对每个请求调用回调并标记为失败，然后是退避中的重试请求。
  */
-static void drain_queue(curlrq_engine_t *engine)
+static void drain_queue(worker_t *worker)
 {
-    request_node_t *node = engine->queue_head;
-    engine->queue_head = NULL;
-    engine->queue_tail = NULL;
-    engine->queue_len = 0;
-
-    /* 解锁，在回调前释放锁 */
-    pthread_mutex_unlock(&engine->mutex);
-
-    while (node) {
-        request_node_t *next = node->next;
-
-        /* 构造失败响应 */
-        curlrq_response_t resp;
-        memset(&resp, 0, sizeof(resp));
-        resp.curl_code = CURLE_OPERATION_TIMEDOUT;  /* 近似表示取消 */
-        resp.error_msg = strdup_safe("request cancelled during engine shutdown");
-
-        /* 回调负责调用 curlrq_response_free 释放响应数据 */
-        if (node->callback) {
-            node->callback(&resp, node->req.user_data);
-        }
-
-        /* 释放节点 */
-        free((void *)node->req.url);
-        free((void *)node->req.method);
-        free((void *)node->req.body);
-        if (node->headers) curl_slist_free_all(node->headers);
-        free(node);
+    request_node_t *node;
 
-        node = next;
+    while ((node = queue_pop(worker)) != NULL) {
+        /* 近似表示取消 */
+        finish_unstarted(worker, node, CURLE_OPERATION_TIMEDOUT, "request cancelled during engine shutdown");
+    }
+    while ((node = heap_pop(&worker->retry_heap, retry_before)) != NULL) {
+        finish_unstarted(worker, node, CURLE_OPERATION_TIMEDOUT, "request cancelled during engine shutdown");
     }
-
-    /* 重新加锁，保持调用者预期 */
-    pthread_mutex_lock(&engine->mutex);
 }
 
-/* ------------------------------------------------------------------ */
-/*  libcurl 写入回调                                                   */
-/* ------------------------------------------------------------------ */
-
 /**
- * write_body_cb - CURLOPT_WRITEFUNCTION
- * 将响应 body 写入动态缓存。
- * 支持 max_response_size 限制：超过限制时返回 0 中断传输。
+ * finish_unstarted - 以错误结束一个已从优先级队列取出、未启动的请求
+ * 回调期间计入 active_count，curlrq_wait 不会在回调返回前结束。
  */
-static size_t write_body_cb(void *data, size_t size, size_t nmemb, void *userp)
+static void finish_unstarted(worker_t *worker, request_node_t *node, CURLcode code, const char *msg)
 {
-    active_request_t *ar = (active_request_t *)userp;
-    size_t total = size * nmemb;
-    size_t new_len = ar->write_len + total;
+    curlrq_engine_t *engine = worker->engine;
+
+    RQ_ADD(&worker->active_count, 1);
+    RQ_ADD(&engine->queue_len, -1);
+    count_result(worker, RQ_LOAD(&engine->shutdown) ? CURLRQ_ERR_CANCELLED : error_class(code, 0));
+    fail_request(node, code, msg);
+    RQ_ADD(&worker->active_count, -1);
+    notify_waiters(engine);
+}
 
-    /* 检查响应大小限制 */
-    if (ar->node->req.max_response_size > 0 &&
-        (long)new_len > ar->node->req.max_response_size) {
-        return 0;  /* 返回 0 告诉 libcurl 中断传输 */
+/**
+ * notify_waiters - 请求结束后唤醒 curlrq_wait
+ * 没有等待者时不加锁；等待者先登记再检查计数，与这里"先改计数再读 waiters"配对，不会漏唤醒。
+ */
+static void notify_waiters(curlrq_engine_t *engine)
+{
+    if (RQ_LOAD(&engine->waiters) > 0) {
+        pthread_mutex_lock(&engine->mutex);
+        pthread_cond_broadcast(&engine->cond);
+        pthread_mutex_unlock(&engine->mutex);
     }
+}
 
-    /* 扩展缓存 */
-    if (new_len >= ar->write_cap) {
-        size_t new_cap = ar->write_cap ? ar->write_cap * 2 : 4096;
-        while (new_cap < new_len + 1) new_cap *= 2;
+/**
+ * fail_request - 以错误结束一个未启动的请求：调用回调并释放节点
+ */
+static void fail_request(request_node_t *node, CURLcode code, const char *msg)
+{
+    curlrq_response_t resp;
+    memset(&resp, 0, sizeof(resp));
+    resp.curl_code = code;
+    resp.attempts  = node->attempts;
+    resp.error_msg = strdup_safe(msg);
 
-        char *new_buf = (char *)realloc(ar->write_buf, new_cap);
-        if (!new_buf) return 0;
-        ar->write_buf = new_buf;
-        ar->write_cap = new_cap;
+    /* 回调负责调用 curlrq_response_free 释放响应数据 */
+    if (node->callback) {
+        node->callback(&resp, node->req.user_data);
     }
+    free_node(node);
+}
 
-    memcpy(ar->write_buf + ar->write_len, data, total);
-    ar->write_len = new_len;
-    ar->write_buf[ar->write_len] = '\0';  /* 保持字符串结尾 */
-
-    return total;
+/**
+ * free_node - 释放队列节点及其拷贝的请求数据（都在同一块 arena 中）
+ */
+static void free_node(request_node_t *node)
+{
+    free(node);
 }
 
 /**
- * write_header_cb - CURLOPT_HEADERFUNCTION
- * 将响应头写入动态缓存。
+ * node_create - 分配队列节点，请求字符串与请求头放在节点之后的 arena 中
+ * @param copy 1=拷贝 url/method/body/请求头字符串，0=零拷贝，只引用调用方内存
+ * @return 节点（只填充 url/method/body/body_len/headers），失败返回 NULL
+ *
+ * 内存布局: [request_node_t][curl_slist x 请求头数][url\0 method\0 body\0 header\0 ...]
+ * curl_slist 节点总在 arena 中（libcurl 只遍历链表），零拷贝时 data 指向调用方的字符串。
+ * body 按 body_len 拷贝，可以包含 '\0'。
  */
-static size_t write_header_cb(void *data, size_t size, size_t nmemb, void *userp)
+static request_node_t *node_create(const curlrq_request_t *req, int copy)
 {
-    active_request_t *ar = (active_request_t *)userp;
-    size_t total = size * nmemb;
-    size_t new_len = ar->header_len + total;
+    size_t url_len    = strlen(req->url);
+    size_t method_len = req->method ? strlen(req->method) : 0;
+    size_t body_len   = req->body ? (req->body_len ? req->body_len : strlen(req->body)) : 0;
+    size_t n_headers  = 0;
+    size_t size;
+    request_node_t *node;
+    struct curl_slist *slist;
+    char *arena;
 
-    /* 扩展缓存 */
-    if (new_len >= ar->header_cap) {
-        size_t new_cap = ar->header_cap ? ar->header_cap * 2 : 2048;
-        while (new_cap < new_len + 1) new_cap *= 2;
+    if (req->headers) {
+        while (req->headers[n_headers]) n_headers++;
+    }
 
-        char *new_buf = (char *)realloc(ar->header_buf, new_cap);
-        if (!new_buf) return 0;
-        ar->header_buf = new_buf;
-        ar->header_cap = new_cap;
+    /* request_node_t 含指针与 long long，大小按其对齐，之后的 curl_slist 数组天然对齐 */
+    size = sizeof(request_node_t) + n_headers * sizeof(struct curl_slist);
+    if (copy) {
+        size += url_len + 1;
+        if (req->method) size += method_len + 1;
+        if (req->body) size += body_len + 1;
+        for (size_t i = 0; i < n_headers; i++) size += strlen(req->headers[i]) + 1;
     }
 
-    memcpy(ar->header_buf + ar->header_len, data, total);
-    ar->header_len = new_len;
-    ar->header_buf[ar->header_len] = '\0';
+    node = (request_node_t *)malloc(size);
+    if (!node) return NULL;
+    memset(node, 0, sizeof(*node));
+    slist = (struct curl_slist *)(node + 1);
+    arena = (char *)(slist + n_headers);
 
-    return total;
-}
+    if (copy) {
+        node->req.url    = arena_copy(&arena, req->url, url_len);
+        node->req.method = req->method ? arena_copy(&arena, req->method, method_len) : NULL;
+        node->req.body   = req->body ? arena_copy(&arena, req->body, body_len) : NULL;
+    } else {
+        node->req.url    = req->url;
+        node->req.method = req->method;
+        node->req.body   = req->body;
+    }
+    node->req.body_len = body_len;
 
-/* ------------------------------------------------------------------ */
-/*  工具函数                                                           */
-/* ------------------------------------------------------------------ */
+    for (size_t i = 0; i < n_headers; i++) {
+        slist[i].data = copy ? arena_copy(&arena, req->headers[i], strlen(req->headers[i]))
+                             : (char *)req->headers[i];
+        slist[i].next = i + 1 < n_headers ? &slist[i + 1] : NULL;
+    }
+    node->headers = n_headers ? slist : NULL;
+    return node;
+}
 
 /**
- * strdup_safe - 安全的 strdup，对 NULL 返回 NULL
+ * acquire_active - 从 Worker 的控制块池取出活跃请求控制块，池空时新建
+ * 控制块池只在 Worker 线程中访问
  */
-static char *strdup_safe(const char *s)
+static active_request_t *acquire_active(worker_t *worker)
 {
-    if (!s) return NULL;
-    size_t len = strlen(s);
-    char *d = (char *)malloc(len + 1);
-    if (!d) return NULL;
-    memcpy(d, s, len + 1);
-    return d;
+    active_request_t *ar = worker->active_pool;
+
+    if (!ar) return (active_request_t *)calloc(1, sizeof(*ar));
+    worker->active_pool = ar->next;
+    worker->active_pool_len--;
+    return ar;
 }
 
 /**
- * build_slist - 将 NULL-terminated 字符串数组转为 curl_slist
+ * release_active - 释放控制块持有的请求头拷贝、缓存条目引用与响应缓存，清零后放回控制块池，池满时释放
+ * 正常完成时响应缓存的所有权已转移给 curlrq_response_t，这里只释放被丢弃的传输（重试、对冲失败方）的缓存。
  */
-static struct curl_slist *build_slist(const char * const *headers)
+static void release_active(worker_t *worker, active_request_t *ar)
 {
-    struct curl_slist *list = NULL;
-    if (!headers) return NULL;
-
-    for (int i = 0; headers[i] != NULL; i++) {
-        struct curl_slist *new_list = curl_slist_append(list, headers[i]);
-        if (!new_list) {
-            /* 追加失败，清理已添加的部分 */
-            curl_slist_free_all(list);
-            return NULL;
+    if (ar->hedge_at) worker->hedge_armed--;
+    if (ar->cache_entry) cache_release(worker->engine->cache, ar->cache_entry);
+    free(ar->cond_block);
+    free(ar->default_block);
+    free(ar->write_buf);
+    free(ar->header_buf);
+    if (worker->active_pool_len < worker->engine->max_concurrent) {
+        memset(ar, 0, sizeof(*ar));
+        ar->next = worker->active_pool;
+        worker->active_pool = ar;
+        worker->active_pool_len++;
+    } else {
+        free(ar);
+    }
+}
+
+/**
+ * copy_default_headers - 把 Worker 的默认头拷贝到一块内存中，链尾接上请求头 tail
+ * @param block 输出拷贝的链表头（也是整块内存，free 一次释放），没有要拷贝的默认头时为 NULL
+ * @return 0 成功，-1 内存不足
+ *
+ * 与 tail 中同名的默认头被跳过。默认头可能在请求执行期间被 apply_engine_opts 替换，
+ * 所以每个请求持有自己的拷贝。
+ */
+static int copy_default_headers(const struct curl_slist *defaults, struct curl_slist *tail,
+                                struct curl_slist **block)
+{
+    size_t n = 0, size = 0;
+    struct curl_slist *list;
+    char *arena;
+
+    *block = NULL;
+    for (const struct curl_slist *cur = defaults; cur; cur = cur->next) {
+        if (header_overridden(cur->data, tail)) continue;
+        n++;
+        size += strlen(cur->data) + 1;
+    }
+    if (n == 0) return 0;
+
+    list = (struct curl_slist *)malloc(n * sizeof(struct curl_slist) + size);
+    if (!list) return -1;
+    arena = (char *)(list + n);
+
+    n = 0;
+    for (const struct curl_slist *cur = defaults; cur; cur = cur->next) {
+        if (header_overridden(cur->data, tail)) continue;
+        list[n].data = arena_copy(&arena, cur->data, strlen(cur->data));
+        list[n].next = &list[n + 1];
+        n++;
+    }
+    list[n - 1].next = tail;
+    *block = list;
+    return 0;
+}
+
+/**
+ * header_overridden - list 中是否有与 header 同名的头（名称忽略大小写，到 ':' 或 ';' 为止）
+ */
+static int header_overridden(const char *header, const struct curl_slist *list)
+{
+    size_t len = strcspn(header, ":;");
+
+    for (; list; list = list->next) {
+        const char *other = list->data;
+        size_t i;
+
+        if (strcspn(other, ":;") != len) continue;
+        for (i = 0; i < len; i++) {
+            unsigned char a = (unsigned char)header[i], b = (unsigned char)other[i];
+            if (a >= 'A' && a <= 'Z') a = (unsigned char)(a - 'A' + 'a');
+            if (b >= 'A' && b <= 'Z') b = (unsigned char)(b - 'A' + 'a');
+            if (a != b) break;
+        }
+        if (i == len) return 1;
+    }
+    return 0;
+}
+
+/**
+ * queue_class - 优先级对应的队列下标，下标越小越先调度
+ */
+static int queue_class(curlrq_priority_t priority)
+{
+    switch (priority) {
+    case CURLRQ_PRIORITY_HIGH: return 0;
+    case CURLRQ_PRIORITY_LOW:  return 2;
+    default:                   return 1;
+    }
+}
+
+/**
+ * node_before - 堆排序规则：截止时间早的在前，无截止时间的最后，相同时按加入顺序
+ */
+static int node_before(const request_node_t *a, const request_node_t *b)
+{
+    long long da = a->req.deadline_ms > 0 ? a->req.deadline_ms : LLONG_MAX;
+    long long db = b->req.deadline_ms > 0 ? b->req.deadline_ms : LLONG_MAX;
+    if (da != db) return da < db;
+    return a->seq < b->seq;
+}
+
+/**
+ * retry_before - 重试堆的排序：退避先结束的在前，同时结束的按加入顺序
+ */
+static int retry_before(const request_node_t *a, const request_node_t *b)
+{
+    if (a->retry_at != b->retry_at) return a->retry_at < b->retry_at;
+    return a->seq < b->seq;
+}
+
+/* ------------------------------------------------------------------ */
+/*  耗时与统计                                                         */
+/* ------------------------------------------------------------------ */
+
+/**
+ * fill_timing - 从 easy 句柄读取分阶段耗时，各阶段为相邻时间点之差
+ *
+ * libcurl 的时间点都从传输开始计: NAMELOOKUP <= CONNECT <= APPCONNECT <= PRETRANSFER <= STARTTRANSFER <= TOTAL，
+ * 复用连接或明文 HTTP 时前面的时间点可能为 0，差值按 0 处理。
+ */
+static void fill_timing(CURL *easy, request_node_t *node, curlrq_response_t *resp)
+{
+    curl_off_t dns = 0, connect = 0, tls = 0, pretransfer = 0, start = 0, total = 0;
+
+    curl_easy_getinfo(easy, CURLINFO_NAMELOOKUP_TIME_T, &dns);
+    curl_easy_getinfo(easy, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(easy, CURLINFO_APPCONNECT_TIME_T, &tls);
+    curl_easy_getinfo(easy, CURLINFO_PRETRANSFER_TIME_T, &pretransfer);
+    curl_easy_getinfo(easy, CURLINFO_STARTTRANSFER_TIME_T, &start);
+    curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME_T, &total);
+
+    resp->queue_time_us    = node->queue_us;
+    resp->dns_time_us      = dns;
+    resp->connect_time_us  = connect > dns ? connect - dns : 0;
+    resp->tls_time_us      = tls > connect ? tls - connect : 0;
+    resp->ttfb_us          = start > pretransfer ? start - pretransfer : 0;
+    resp->transfer_time_us = total > start ? total - start : 0;
+}
+
+/**
+ * count_transfer - 统计一次结束的传输：新建连接数、连接复用、收发字节数
+ * 每个传输（含重试与被取消的对冲副本）调用一次，在 easy 句柄回收之前。
+ * 连接失败的传输 NUM_CONNECTS 也为 0，所以只把收到响应的传输算作复用。
+ */
+static void count_transfer(worker_t *worker, CURL *easy)
+{
+    long connects = 0, http_code = 0, header_size = 0, request_size = 0;
+    curl_off_t down = 0, up = 0;
+
+    curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &connects);
+    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &http_code);
+    curl_easy_getinfo(easy, CURLINFO_HEADER_SIZE, &header_size);
+    curl_easy_getinfo(easy, CURLINFO_REQUEST_SIZE, &request_size);
+    curl_easy_getinfo(easy, CURLINFO_SIZE_DOWNLOAD_T, &down);
+    curl_easy_getinfo(easy, CURLINFO_SIZE_UPLOAD_T, &up);
+
+    RQ_COUNT(&worker->stats.transfers, 1);
+    RQ_COUNT(&worker->stats.connects, (unsigned long long)connects);
+    if (connects == 0 && http_code > 0) RQ_COUNT(&worker->stats.reused, 1);
+    RQ_COUNT(&worker->stats.bytes_in, (unsigned long long)header_size + (unsigned long long)down);
+    RQ_COUNT(&worker->stats.bytes_out, (unsigned long long)request_size + (unsigned long long)up);
+}
+
+/**
+ * count_result - 统计一个交给回调的结果
+ * @param error_class curlrq_error_class_t，-1 表示成功
+ */
+static void count_result(worker_t *worker, int error_class)
+{
+    RQ_COUNT(&worker->stats.requests, 1);
+    if (error_class >= 0) RQ_COUNT(&worker->stats.errors[error_class], 1);
+}
+
+/**
+ * record_queue_time - 首次启动时记录排队时间并计入直方图
+ * 第 i 格为 [2^(i-1), 2^i) 微秒，第 0 格为 0。
+ */
+static void record_queue_time(worker_t *worker, request_node_t *node)
+{
+    long long us = now_us() - node->enqueued_us;
+    int bucket = 0;
+
+    if (us < 0) us = 0;
+    node->queue_us = us;
+    while (us > 0 && bucket < CURLRQ_QUEUE_HIST_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    RQ_COUNT(&worker->stats.queue_hist[bucket], 1);
+}
+
+/**
+ * error_class - 按 libcurl 返回码与状态码分类
+ * @return curlrq_error_class_t，成功返回 -1
+ */
+static int error_class(CURLcode cr, int http_code)
+{
+    switch (cr) {
+    case CURLE_OK:
+        if (http_code >= 500) return CURLRQ_ERR_HTTP_5XX;
+        if (http_code >= 400) return CURLRQ_ERR_HTTP_4XX;
+        return -1;
+    case CURLE_COULDNT_RESOLVE_HOST:
+    case CURLE_COULDNT_RESOLVE_PROXY:
+        return CURLRQ_ERR_DNS;
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_GOT_NOTHING:
+    case CURLE_PARTIAL_FILE:
+        return CURLRQ_ERR_CONNECT;
+    case CURLE_SSL_CONNECT_ERROR:
+    case CURLE_PEER_FAILED_VERIFICATION:
+    case CURLE_SSL_CERTPROBLEM:
+    case CURLE_SSL_CIPHER:
+    case CURLE_SSL_CACERT_BADFILE:
+    case CURLE_SSL_ISSUER_ERROR:
+    case CURLE_SSL_PINNEDPUBKEYNOTMATCH:
+    case CURLE_SSL_INVALIDCERTSTATUS:
+        return CURLRQ_ERR_TLS;
+    case CURLE_OPERATION_TIMEDOUT:
+        return CURLRQ_ERR_TIMEOUT;
+    case CURLE_WRITE_ERROR:
+    case CURLE_FILESIZE_EXCEEDED:
+    case CURLE_ABORTED_BY_CALLBACK:
+        return CURLRQ_ERR_CANCELLED;
+    default:
+        return CURLRQ_ERR_OTHER;
+    }
+}
+
+/**
+ * now_us - 单调时钟（微秒），用于排队时间
+ */
+static long long now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* ------------------------------------------------------------------ */
+/*  提交队列（无锁 MPSC）                                              */
+/* ------------------------------------------------------------------ */
+
+/**
+ * inbox_push - 将请求压入 Worker 的提交队列，任意线程可并发调用
+ * @return 1 队列原本为空（调用方需要唤醒 Worker），0 否则
+ *
+ * Treiber 栈压栈。消费者只会整体交换取走，不会单个弹出，因此没有 ABA 问题。
+ */
+static int inbox_push(worker_t *worker, request_node_t *node)
+{
+    request_node_t *head = RQ_LOAD(&worker->inbox);
+    do {
+        node->next = head;
+    } while (!RQ_CAS(&worker->inbox, &head, node));
+    return head == NULL;
+}
+
+/**
+ * take_inbox - 取走提交队列中的全部请求，按提交顺序放入优先级队列
+ * 只在 Worker 线程中调用（或线程全部退出后由 curlrq_cleanup 调用）
+ */
+static void take_inbox(worker_t *worker)
+{
+    request_node_t *list = RQ_XCHG(&worker->inbox, (request_node_t *)NULL);
+    request_node_t *fifo = NULL;
+
+    /* 栈是后进先出，反转成提交顺序 */
+    while (list) {
+        request_node_t *next = list->next;
+        list->next = fifo;
+        fifo = list;
+        list = next;
+    }
+    while (fifo) {
+        request_node_t *next = fifo->next;
+        fifo->next = NULL;
+        if (queue_push(worker, fifo) != 0) {
+            RQ_ADD(&worker->engine->class_len[queue_class(fifo->req.priority)], -1);
+            finish_unstarted(worker, fifo, CURLE_OUT_OF_MEMORY, "out of memory");
+        }
+        fifo = next;
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/*  优先级队列（只在 Worker 线程中访问）                                */
+/* ------------------------------------------------------------------ */
+
+/**
+ * queue_push - 请求加入所属优先级的堆
+ * @return 0 成功，-1 内存不足
+ */
+static int queue_push(worker_t *worker, request_node_t *node)
+{
+    if (heap_push(&worker->queues[queue_class(node->req.priority)], node, node_before) != 0) return -1;
+    worker->queue_len++;
+    return 0;
+}
+
+/**
+ * heap_push - 元素入堆，before(a, b) 为真表示 a 排在 b 之前
+ * @return 0 成功，-1 内存不足
+ */
+static int heap_push(request_heap_t *heap, request_node_t *node,
+                     int (*before)(const request_node_t *, const request_node_t *))
+{
+    int i;
+
+    if (heap->len == heap->cap) {
+        int cap = heap->cap ? heap->cap * 2 : 16;
+        request_node_t **items = (request_node_t **)realloc(heap->items, (size_t)cap * sizeof(*items));
+        if (!items) return -1;
+        heap->items = items;
+        heap->cap   = cap;
+    }
+
+    /* 上浮 */
+    i = heap->len++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!before(node, heap->items[parent])) break;
+        heap->items[i] = heap->items[parent];
+        i = parent;
+    }
+    heap->items[i] = node;
+    return 0;
+}
+
+/**
+ * heap_pop - 取出堆顶
+ */
+static request_node_t *heap_pop(request_heap_t *heap,
+                                int (*before)(const request_node_t *, const request_node_t *))
+{
+    request_node_t *top;
+    request_node_t *last;
+    int i = 0;
+
+    if (heap->len == 0) return NULL;
+    top  = heap->items[0];
+    last = heap->items[--heap->len];
+
+    /* 下沉 */
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= heap->len) break;
+        if (child + 1 < heap->len && before(heap->items[child + 1], heap->items[child])) child++;
+        if (!before(heap->items[child], last)) break;
+        heap->items[i] = heap->items[child];
+        i = child;
+    }
+    if (heap->len > 0) heap->items[i] = last;
+
+    top->next = NULL;
+    return top;
+}
+
+/**
+ * heap_remove - 删除下标 i 处的元素：用末尾元素填补，再按需上浮或下沉
+ */
+static void heap_remove(request_heap_t *heap, int i,
+                        int (*before)(const request_node_t *, const request_node_t *))
+{
+    request_node_t *last = heap->items[--heap->len];
+
+    if (i == heap->len) return;
+    /* 上浮 */
+    while (i > 0 && before(last, heap->items[(i - 1) / 2])) {
+        heap->items[i] = heap->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    /* 下沉 */
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= heap->len) break;
+        if (child + 1 < heap->len && before(heap->items[child + 1], heap->items[child])) child++;
+        if (!before(heap->items[child], last)) break;
+        heap->items[i] = heap->items[child];
+        i = child;
+    }
+    heap->items[i] = last;
+}
+
+/**
+ * queue_pop - 取出下一个要启动的请求：最高优先级中截止时间最早的
+ */
+static request_node_t *queue_pop(worker_t *worker)
+{
+    for (int c = 0; c < CURLRQ_PRIORITY_LEVELS; c++) {
+        request_node_t *node = heap_pop(&worker->queues[c], node_before);
+        if (node) {
+            worker->queue_len--;
+            RQ_ADD(&worker->engine->class_len[c], -1);
+            return node;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * queue_pop_expired - 取出一个已过截止时间的请求，没有则返回 NULL
+ * 每级的堆顶就是该级截止时间最早的请求，只需检查堆顶。
+ */
+static request_node_t *queue_pop_expired(worker_t *worker, long long now)
+{
+    for (int c = 0; c < CURLRQ_PRIORITY_LEVELS; c++) {
+        request_heap_t *heap = &worker->queues[c];
+        if (heap->len > 0 && heap->items[0]->req.deadline_ms > 0 &&
+            heap->items[0]->req.deadline_ms <= now) {
+            worker->queue_len--;
+            RQ_ADD(&worker->engine->class_len[c], -1);
+            return heap_pop(heap, node_before);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * retry_pop_expired - 从重试堆取出一个已过截止时间的请求，没有则返回 NULL
+ * 重试堆按可用时间排列，需要逐个检查；预留的限速令牌归还给主机。
+ */
+static request_node_t *retry_pop_expired(worker_t *worker, long long now)
+{
+    request_heap_t *heap = &worker->retry_heap;
+
+    for (int i = 0; i < heap->len; i++) {
+        request_node_t *node = heap->items[i];
+        if (node->req.deadline_ms <= 0 || node->req.deadline_ms > now) continue;
+        heap_remove(heap, i, retry_before);
+        if (node->rate_reserved) {
+            node->rate_reserved = 0;
+            rate_release(worker->engine, node->req.url);
+        }
+        return node;
+    }
+    return NULL;
+}
+
+/**
+ * queue_deadline_wait - 距队列与重试堆中最早截止时间的毫秒数，没有截止时间返回 -1
+ */
+static long queue_deadline_wait(worker_t *worker, long long now)
+{
+    long long earliest = LLONG_MAX;
+
+    for (int c = 0; c < CURLRQ_PRIORITY_LEVELS; c++) {
+        request_heap_t *heap = &worker->queues[c];
+        if (heap->len > 0 && heap->items[0]->req.deadline_ms > 0 &&
+            heap->items[0]->req.deadline_ms < earliest) {
+            earliest = heap->items[0]->req.deadline_ms;
+        }
+    }
+    /* 重试堆按可用时间排列，截止时间要逐个看 */
+    for (int i = 0; i < worker->retry_heap.len; i++) {
+        long long deadline = worker->retry_heap.items[i]->req.deadline_ms;
+        if (deadline > 0 && deadline < earliest) earliest = deadline;
+    }
+    if (earliest == LLONG_MAX) return -1;
+    if (earliest <= now) return 0;
+    return earliest - now > INT_MAX ? INT_MAX : (long)(earliest - now);
+}
+
+/* ------------------------------------------------------------------ */
+/*  重试与对冲（只在 Worker 线程中访问）                                */
+/* ------------------------------------------------------------------ */
+
+/**
+ * promote_retries - 退避结束的请求回到优先级队列
+ * 保留原来的加入顺序，重试的请求按原位置排队，而不是排到队尾。
+ * 退避期间请求一直计入 engine->queue_len，这里只更新各优先级的排队数。
+ */
+static void promote_retries(worker_t *worker, long long now)
+{
+    request_heap_t *heap = &worker->retry_heap;
+
+    while (heap->len > 0 && heap->items[0]->retry_at <= now) {
+        request_node_t *node = heap_pop(heap, retry_before);
+        if (queue_push(worker, node) != 0) {
+            finish_unstarted(worker, node, CURLE_OUT_OF_MEMORY, "out of memory");
+            continue;
+        }
+        RQ_ADD(&worker->engine->class_len[queue_class(node->req.priority)], 1);
+    }
+}
+
+/**
+ * start_hedges - 为到达对冲时间、仍未完成的请求发出副本
+ * @return 距下一个对冲时间的毫秒数，没有返回 -1
+ *
+ * 槽位优先留给排队的请求：队列非空、并发已满或主机暂时没有限速令牌时放弃这次对冲。
+ */
+static long start_hedges(worker_t *worker, long long now)
+{
+    long long earliest = LLONG_MAX;
+
+    if (worker->hedge_armed == 0) return -1;
+
+    /* start_transfer 把副本插到链表头，不影响从当前位置往后的遍历 */
+    for (active_request_t *ar = worker->active_list; ar; ar = ar->next) {
+        active_request_t *hedge;
+
+        if (ar->hedge_at == 0) continue;
+        if (ar->hedge_at > now) {
+            if (ar->hedge_at < earliest) earliest = ar->hedge_at;
+            continue;
+        }
+        ar->hedge_at = 0;
+        worker->hedge_armed--;
+        if (worker->queue_len > 0 ||
+            worker->active_count + worker->hedge_count >= worker->engine->max_concurrent) {
+            continue;
+        }
+        if (RQ_LOAD(&worker->engine->rate_enabled) && rate_reserve(worker->engine, ar->node->req.url, 1) < 0) {
+            continue;
+        }
+        hedge = start_transfer(worker, ar->node, ar->cache_entry);
+        if (!hedge) continue;
+        hedge->peer = ar;
+        ar->peer    = hedge;
+        worker->hedge_count++;
+    }
+    if (earliest == LLONG_MAX) return -1;
+    return earliest - now > INT_MAX ? INT_MAX : (long)(earliest - now);
+}
+
+/**
+ * schedule_wait - 事件循环最多等待多久：最早的截止时间、退避结束时间与对冲时间
+ * @return 毫秒数，-1=不限
+ */
+static long schedule_wait(worker_t *worker, long long now, long hedge_wait)
+{
+    long wait_ms = queue_deadline_wait(worker, now);
+
+    if (worker->retry_heap.len > 0) {
+        long long at = worker->retry_heap.items[0]->retry_at;
+        long retry_wait = at <= now ? 0 : (at - now > INT_MAX ? INT_MAX : (long)(at - now));
+        if (wait_ms < 0 || retry_wait < wait_ms) wait_ms = retry_wait;
+    }
+    if (hedge_wait >= 0 && (wait_ms < 0 || hedge_wait < wait_ms)) wait_ms = hedge_wait;
+    return wait_ms;
+}
+
+/**
+ * retryable_failure - 传输结果是否属于可重试的失败
+ * 传输错误只认连接/解析/超时/收发类；HTTP 响应看状态码是否在策略的列表中。
+ * 对冲时也用它判断先完成的一方是否算作结果。
+ */
+static int retryable_failure(const worker_t *worker, CURLcode cr, int http_code)
+{
+    switch (cr) {
+    case CURLE_OK:
+        for (const int *code = worker->retry.status; *code; code++) {
+            if (*code == http_code) return 1;
+        }
+        return 0;
+    case CURLE_COULDNT_RESOLVE_HOST:
+    case CURLE_COULDNT_RESOLVE_PROXY:
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_OPERATION_TIMEDOUT:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_GOT_NOTHING:
+    case CURLE_PARTIAL_FILE:
+    case CURLE_SSL_CONNECT_ERROR:
+    case CURLE_HTTP2:
+    case CURLE_HTTP2_STREAM:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * should_retry - 按重试策略判断是否重试，并计算退避时间
+ * 必须在 easy 句柄回收前调用（读取 Retry-After）。
+ *
+ * 不重试的情况：次数用完、不可重试的失败、非幂等方法、已向流式回调交付过数据、
+ * Retry-After 超过 max_delay_ms、退避结束时已过截止时间。
+ */
+static int should_retry(worker_t *worker, active_request_t *ar, CURLcode cr, int http_code, long *delay_ms)
+{
+    const retry_policy_t *policy = &worker->retry;
+    request_node_t *node = ar->node;
+    long delay;
+
+    if (node->attempts >= policy->max_attempts) return 0;
+    if (!retryable_failure(worker, cr, http_code)) return 0;
+    if (cr != CURLE_OK && !policy->retry_network_errors) return 0;
+    if (!policy->retry_non_idempotent && !method_idempotent(node->req.method)) return 0;
+    if (ar->delivered) return 0;
+
+    delay = backoff_delay(worker, node->attempts);
+    if (policy->honor_retry_after && cr == CURLE_OK) {
+        curl_off_t retry_after = 0;
+        curl_easy_getinfo(ar->easy, CURLINFO_RETRY_AFTER, &retry_after);
+        if (retry_after > 0) {
+            if ((long long)retry_after * 1000 > policy->max_delay_ms) return 0;
+            delay = (long)retry_after * 1000;
+        }
+    }
+    if (node->req.deadline_ms > 0 && curlrq_now_ms() + delay >= node->req.deadline_ms) return 0;
+
+    *delay_ms = delay;
+    return 1;
+}
+
+/**
+ * backoff_delay - 指数退避 + 完全抖动（full jitter）
+ * 第 n 次重试的延迟在 [0, min(max_delay, base * 2^(n-1))] 中均匀随机，
+ * 同时失败的大量请求不会在同一时刻一起重试。
+ */
+static long backoff_delay(worker_t *worker, int attempts)
+{
+    const retry_policy_t *policy = &worker->retry;
+    long cap = policy->base_delay_ms;
+    unsigned long long x = worker->rng;
+
+    for (int i = 1; i < attempts && cap < policy->max_delay_ms; i++) cap *= 2;
+    if (cap > policy->max_delay_ms) cap = policy->max_delay_ms;
+
+    /* xorshift64 */
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    worker->rng = x;
+    return (long)(x % (unsigned long long)(cap + 1));
+}
+
+/**
+ * cmp_long - qsort 比较函数
+ */
+static int cmp_long(const void *a, const void *b)
+{
+    long x = *(const long *)a;
+    long y = *(const long *)b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * record_latency - 记录一次成功传输的耗时，定期重新计算 p95 作为对冲延迟
+ */
+static void record_latency(worker_t *worker, long ms)
+{
+    long sorted[CURLRQ_LATENCY_SAMPLES];
+    size_t n;
+
+    worker->latency[worker->latency_count++ % CURLRQ_LATENCY_SAMPLES] = ms;
+    if (worker->latency_count < CURLRQ_HEDGE_MIN_SAMPLES ||
+        worker->latency_count % CURLRQ_HEDGE_RECALC != 0) {
+        return;
+    }
+
+    n = worker->latency_count < CURLRQ_LATENCY_SAMPLES ? (size_t)worker->latency_count
+                                                       : CURLRQ_LATENCY_SAMPLES;
+    memcpy(sorted, worker->latency, n * sizeof(long));
+    qsort(sorted, n, sizeof(long), cmp_long);
+    worker->hedge_delay_ms = sorted[n * 95 / 100];
+    if (worker->hedge_delay_ms < 1) worker->hedge_delay_ms = 1;
+}
+
+/**
+ * retry_policy_copy - 把公开的重试策略转成内部拷贝，补齐默认值
+ * @param src NULL 表示不重试（状态码列表仍取默认值，供对冲判断失败使用）
+ */
+static void retry_policy_copy(retry_policy_t *dst, const curlrq_retry_policy_t *src)
+{
+    static const int default_status[] = {429, 502, 503, 504, 0};
+    const int *status = src && src->retry_status ? src->retry_status : default_status;
+    int n = 0;
+
+    memset(dst, 0, sizeof(*dst));
+    dst->base_delay_ms = CURLRQ_RETRY_BASE_MS;
+    dst->max_delay_ms  = CURLRQ_RETRY_MAX_MS;
+    if (src) {
+        dst->max_attempts         = src->max_attempts;
+        dst->retry_network_errors = src->retry_network_errors ? 1 : 0;
+        dst->honor_retry_after    = src->honor_retry_after ? 1 : 0;
+        dst->retry_non_idempotent = src->retry_non_idempotent ? 1 : 0;
+        if (src->base_delay_ms > 0) dst->base_delay_ms = src->base_delay_ms;
+        if (src->max_delay_ms > 0)  dst->max_delay_ms  = src->max_delay_ms;
+        if (dst->base_delay_ms > dst->max_delay_ms) dst->base_delay_ms = dst->max_delay_ms;
+    }
+    while (status[n] && n < CURLRQ_MAX_RETRY_STATUS) {
+        dst->status[n] = status[n];
+        n++;
+    }
+    dst->status[n] = 0;
+}
+
+/**
+ * method_idempotent - 重复发送不改变结果的方法（RFC 9110）：GET/HEAD/PUT/DELETE/OPTIONS/TRACE
+ */
+static int method_idempotent(const char *method)
+{
+    return method_safe(method) || strcmp(method, "PUT") == 0 || strcmp(method, "DELETE") == 0 ||
+           strcmp(method, "OPTIONS") == 0 || strcmp(method, "TRACE") == 0;
+}
+
+/**
+ * method_safe - 只读方法（GET/HEAD），可以同时发出两份，用于对冲
+ */
+static int method_safe(const char *method)
+{
+    return method == NULL || method[0] == '\0' || strcmp(method, "GET") == 0 || strcmp(method, "HEAD") == 0;
+}
+
+/* ------------------------------------------------------------------ */
+/*  响应缓存                                                           */
+/* ------------------------------------------------------------------ */
+
+/**
+ * cache_create - 按配置创建缓存，磁盘目录不存在时创建，并统计已有文件大小
+ */
+static response_cache_t *cache_create(const curlrq_cache_config_t *config)
+{
+    response_cache_t *cache = (response_cache_t *)calloc(1, sizeof(*cache));
+    if (!cache) return NULL;
+
+    cache->max_memory = config->max_memory_bytes ? config->max_memory_bytes : CURLRQ_CACHE_MEMORY;
+    cache->max_disk   = config->max_disk_bytes ? config->max_disk_bytes : CURLRQ_CACHE_DISK;
+    cache->ttl_ms     = config->ttl_ms > 0 ? config->ttl_ms : 0;
+    cache->nbuckets   = CURLRQ_CACHE_BUCKETS;
+    cache->buckets    = (cache_entry_t **)calloc(cache->nbuckets, sizeof(cache_entry_t *));
+    pthread_mutex_init(&cache->mutex, NULL);
+    if (!cache->buckets) {
+        cache_destroy(cache);
+        return NULL;
+    }
+
+    if (config->disk_dir && config->disk_dir[0]) {
+        DIR *dir;
+        struct dirent *de;
+
+        cache->disk_dir = strdup_safe(config->disk_dir);
+        if (!cache->disk_dir || (mkdir(cache->disk_dir, 0700) != 0 && errno != EEXIST) ||
+            !(dir = opendir(cache->disk_dir))) {
+            cache_destroy(cache);
+            return NULL;
+        }
+        while ((de = readdir(dir)) != NULL) {
+            char path[PATH_MAX];
+            struct stat st;
+            if (!disk_file_name(de->d_name)) continue;
+            snprintf(path, sizeof(path), "%s/%s", cache->disk_dir, de->d_name);
+            if (stat(path, &st) == 0) cache->disk_bytes += (size_t)st.st_size;
+        }
+        closedir(dir);
+    }
+    return cache;
+}
+
+/**
+ * cache_destroy - 释放缓存及所有条目，引擎关闭后调用，此时已没有引用
+ */
+static void cache_destroy(response_cache_t *cache)
+{
+    cache_entry_t *e = cache->lru_head;
+    while (e) {
+        cache_entry_t *next = e->next;
+        free(e);
+        e = next;
+    }
+    free(cache->buckets);
+    free(cache->disk_dir);
+    pthread_mutex_destroy(&cache->mutex);
+    free(cache);
+}
+
+/**
+ * cache_eligible - 请求是否使用缓存：非流式的 GET，未设置 no_cache，且没有自带条件请求头
+ */
+static int cache_eligible(const request_node_t *node)
+{
+    const char *method = node->req.method;
+
+    if (node->req.no_cache || node->req.stream || node->req.output_fd > 0) return 0;
+    if (method && method[0] && strcmp(method, "GET") != 0) return 0;
+    return !header_overridden("If-None-Match:", node->headers) &&
+           !header_overridden("If-Modified-Since:", node->headers);
+}
+
+/**
+ * cache_lookup - 查找请求对应的缓存条目，内存层未命中时尝试磁盘层
+ * @return 持有引用的条目（用完调用 cache_release），未命中返回 NULL
+ *
+ * 条目的 Vary 头所列请求头的值与本次请求不同时视为未命中。
+ */
+static cache_entry_t *cache_lookup(worker_t *worker, request_node_t *node)
+{
+    response_cache_t *cache = worker->engine->cache;
+    unsigned int hash = cache_hash(node->req.url);
+    cache_entry_t *e;
+    char *values;
+
+    pthread_mutex_lock(&cache->mutex);
+    for (e = cache->buckets[hash & (cache->nbuckets - 1)]; e; e = e->hnext) {
+        if (e->hash == hash && strcmp(e->url, node->req.url) == 0) break;
+    }
+    if (e) {
+        e->refs++;
+        lru_touch(cache, e);
+    }
+    pthread_mutex_unlock(&cache->mutex);
+
+    /* 磁盘读取不持锁，加载后放入内存层 */
+    if (!e && cache->disk_dir) {
+        e = disk_read(cache, node->req.url, hash);
+        if (e) {
+            pthread_mutex_lock(&cache->mutex);
+            e->refs = 1;
+            cache_insert(cache, e);
+            pthread_mutex_unlock(&cache->mutex);
+        }
+    }
+    if (!e) return NULL;
+
+    values = e->vary ? vary_values(worker, node, e->vary) : NULL;
+    if (e->vary && (!values || strcmp(values, e->vary_values) != 0)) {
+        free(values);
+        cache_release(cache, e);
+        return NULL;
+    }
+    free(values);
+    return e;
+}
+
+/**
+ * cache_fresh - 条目是否仍在新鲜期内
+ */
+static int cache_fresh(response_cache_t *cache, const cache_entry_t *e)
+{
+    long long fresh_until;
+
+    pthread_mutex_lock(&cache->mutex);
+    fresh_until = e->fresh_until;
+    pthread_mutex_unlock(&cache->mutex);
+    return fresh_until > wall_ms();
+}
+
+/**
+ * cache_retain - 增加条目引用，重新验证的请求（含对冲副本）各持有一个
+ */
+static void cache_retain(response_cache_t *cache, cache_entry_t *e)
+{
+    pthread_mutex_lock(&cache->mutex);
+    e->refs++;
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+/**
+ * cache_release - 释放 cache_lookup 取得的引用，已被替换或淘汰的条目在最后一个引用释放时销毁
+ */
+static void cache_release(response_cache_t *cache, cache_entry_t *e)
+{
+    int destroy;
+
+    pthread_mutex_lock(&cache->mutex);
+    destroy = --e->refs == 0 && !e->linked;
+    pthread_mutex_unlock(&cache->mutex);
+    if (destroy) free(e);
+}
+
+/**
+ * cache_store - 把完成的 200 响应放入缓存（内存层，设置了磁盘目录时同时写入磁盘）
+ * 只在 complete_request 中、响应缓存所有权转移之前调用。
+ */
+static void cache_store(worker_t *worker, request_node_t *node, active_request_t *ar)
+{
+    response_cache_t *cache = worker->engine->cache;
+    const char *block;
+    size_t block_len;
+    const char *value;
+    size_t len;
+    long long lifetime = cache->ttl_ms;
+    const char *etag = NULL, *last_modified = NULL, *vary = NULL;
+    size_t etag_len = 0, last_modified_len = 0, vary_len = 0;
+    char *values = NULL;
+    cache_entry_t *e;
+
+    if (!ar->header_buf) return;
+    last_header_block(ar->header_buf, ar->header_len, &block, &block_len);
+
+    value = header_value(block, block_len, "cache-control", &len);
+    if (value && !cache_control_lifetime(value, len, &lifetime)) return;  /* no-store */
+
+    vary = header_value(block, block_len, "vary", &vary_len);
+    if (vary && memchr(vary, '*', vary_len)) return;
+    etag = header_value(block, block_len, "etag", &etag_len);
+    last_modified = header_value(block, block_len, "last-modified", &last_modified_len);
+
+    /* 没有验证器又不新鲜的响应存了也用不上 */
+    if (!etag && !last_modified && lifetime <= 0) return;
+    if (ar->write_len + block_len > cache->max_memory) return;
+
+    if (vary) {
+        char *names = (char *)malloc(vary_len + 1);
+        if (!names) return;
+        memcpy(names, vary, vary_len);
+        names[vary_len] = '\0';
+        values = vary_values(worker, node, names);
+        free(names);
+        if (!values) return;
+    }
+
+    e = entry_create(node->req.url, vary, vary_len, values, etag, etag_len, last_modified, last_modified_len,
+                     block, block_len, ar->write_buf, ar->write_len);
+    free(values);
+    if (!e) return;
+    e->hash        = cache_hash(node->req.url);
+    e->fresh_until = wall_ms() + lifetime;
+
+    if (cache->disk_dir) disk_write(cache, e);
+
+    pthread_mutex_lock(&cache->mutex);
+    cache_insert(cache, e);
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+/**
+ * cache_refresh - 304 响应后按其 Cache-Control 重新计算新鲜期
+ */
+static void cache_refresh(response_cache_t *cache, cache_entry_t *e, const char *headers, size_t headers_len)
+{
+    const char *block;
+    size_t block_len;
+    const char *value;
+    size_t len;
+    long long lifetime = cache->ttl_ms;
+
+    if (headers) {
+        last_header_block(headers, headers_len, &block, &block_len);
+        value = header_value(block, block_len, "cache-control", &len);
+        if (value && !cache_control_lifetime(value, len, &lifetime)) lifetime = 0;
+    }
+    pthread_mutex_lock(&cache->mutex);
+    e->fresh_until = wall_ms() + lifetime;
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+/**
+ * cache_fill_response - 用缓存条目填充响应，body 与响应头为 malloc 拷贝，由 curlrq_response_free 释放
+ * @return 0 成功，-1 内存不足
+ */
+static int cache_fill_response(const cache_entry_t *e, curlrq_response_t *resp)
+{
+    resp->response_body    = (char *)malloc(e->body_len + 1);
+    resp->response_headers = (char *)malloc(e->headers_len + 1);
+    if (!resp->response_body || !resp->response_headers) {
+        free(resp->response_body);
+        free(resp->response_headers);
+        resp->response_body = resp->response_headers = NULL;
+        return -1;
+    }
+    memcpy(resp->response_body, e->body, e->body_len);
+    resp->response_body[e->body_len] = '\0';
+    resp->response_body_len = e->body_len;
+    memcpy(resp->response_headers, e->headers, e->headers_len);
+    resp->response_headers[e->headers_len] = '\0';
+    resp->response_headers_len = e->headers_len;
+    resp->http_code = 200;
+    return 0;
+}
+
+/**
+ * deliver_cached - 新鲜期内命中：不发请求，直接用缓存回调并释放节点
+ * 活跃计数由调用方维护；内存不足时回退为发起请求。
+ * @return 0 已回调，-1 未回调
+ */
+static int deliver_cached(worker_t *worker, request_node_t *node, cache_entry_t *e)
+{
+    curlrq_response_t resp;
+
+    memset(&resp, 0, sizeof(resp));
+    if (cache_fill_response(e, &resp) != 0) return -1;
+    cache_release(worker->engine->cache, e);
+    resp.effective_url = strdup_safe(node->req.url);
+    resp.cache_status  = CURLRQ_CACHE_HIT;
+    resp.curl_code     = CURLE_OK;
+    resp.queue_time_us = node->queue_us;
+    RQ_COUNT(&worker->stats.cache_hits, 1);
+    count_result(worker, -1);
+
+    if (node->callback) {
+        node->callback(&resp, node->req.user_data);
+    }
+    free_node(node);
+    return 0;
+}
+
+/**
+ * cache_insert - 条目放入哈希表与 LRU 头部，替换同一 URL 的旧条目，超出内存上限时淘汰最久未用的
+ * 持 cache->mutex 调用。
+ */
+static void cache_insert(response_cache_t *cache, cache_entry_t *e)
+{
+    cache_entry_t **pp = &cache->buckets[e->hash & (cache->nbuckets - 1)];
+
+    while (*pp) {
+        if ((*pp)->hash == e->hash && strcmp((*pp)->url, e->url) == 0) {
+            cache_unlink(cache, *pp);
+            break;
+        }
+        pp = &(*pp)->hnext;
+    }
+
+    e->hnext = cache->buckets[e->hash & (cache->nbuckets - 1)];
+    cache->buckets[e->hash & (cache->nbuckets - 1)] = e;
+    e->prev = NULL;
+    e->next = cache->lru_head;
+    if (cache->lru_head) cache->lru_head->prev = e;
+    cache->lru_head = e;
+    if (!cache->lru_tail) cache->lru_tail = e;
+    e->linked = 1;
+    cache->mem_bytes += e->size;
+
+    while (cache->mem_bytes > cache->max_memory && cache->lru_tail && cache->lru_tail != e) {
+        cache_unlink(cache, cache->lru_tail);
+    }
+}
+
+/**
+ * cache_unlink - 从哈希表与 LRU 移除条目，没有引用时立即释放
+ * 持 cache->mutex 调用。磁盘层的文件保留。
+ */
+static void cache_unlink(response_cache_t *cache, cache_entry_t *e)
+{
+    cache_entry_t **pp = &cache->buckets[e->hash & (cache->nbuckets - 1)];
+
+    while (*pp && *pp != e) pp = &(*pp)->hnext;
+    if (*pp) *pp = e->hnext;
+
+    if (e->prev) e->prev->next = e->next;
+    else cache->lru_head = e->next;
+    if (e->next) e->next->prev = e->prev;
+    else cache->lru_tail = e->prev;
+
+    cache->mem_bytes -= e->size;
+    e->linked = 0;
+    if (e->refs == 0) free(e);
+}
+
+/**
+ * lru_touch - 条目移到 LRU 头部，持 cache->mutex 调用
+ */
+static void lru_touch(response_cache_t *cache, cache_entry_t *e)
+{
+    if (cache->lru_head == e) return;
+    e->prev->next = e->next;
+    if (e->next) e->next->prev = e->prev;
+    else cache->lru_tail = e->prev;
+    e->prev = NULL;
+    e->next = cache->lru_head;
+    cache->lru_head->prev = e;
+    cache->lru_head = e;
+}
+
+/**
+ * entry_create - 分配缓存条目，所有字符串与 body 放在条目之后的同一块内存中
+ */
+static cache_entry_t *entry_create(const char *url, const char *vary, size_t vary_len, const char *vary_vals,
+                                   const char *etag, size_t etag_len,
+                                   const char *last_modified, size_t last_modified_len,
+                                   const char *headers, size_t headers_len,
+                                   const char *body, size_t body_len)
+{
+    size_t url_len = strlen(url);
+    size_t values_len = vary_vals ? strlen(vary_vals) : 0;
+    size_t size = sizeof(cache_entry_t) + url_len + 1 + headers_len + 1 + body_len + 1;
+    cache_entry_t *e;
+    char *arena;
+
+    if (vary) size += vary_len + 1 + values_len + 1;
+    if (etag) size += etag_len + 1;
+    if (last_modified) size += last_modified_len + 1;
+
+    e = (cache_entry_t *)malloc(size);
+    if (!e) return NULL;
+    memset(e, 0, sizeof(*e));
+    arena = (char *)(e + 1);
+
+    e->url           = arena_copy(&arena, url, url_len);
+    e->vary          = vary ? arena_copy(&arena, vary, vary_len) : NULL;
+    e->vary_values   = vary ? arena_copy(&arena, vary_vals ? vary_vals : "", values_len) : NULL;
+    e->etag          = etag ? arena_copy(&arena, etag, etag_len) : NULL;
+    e->last_modified = last_modified ? arena_copy(&arena, last_modified, last_modified_len) : NULL;
+    e->headers       = arena_copy(&arena, headers, headers_len);
+    e->headers_len   = headers_len;
+    e->body          = arena_copy(&arena, body ? body : "", body_len);
+    e->body_len      = body_len;
+    e->size          = size;
+    return e;
+}
+
+/**
+ * conditional_headers - 重新验证用的 If-None-Match / If-Modified-Since，链尾接上 tail
+ * @return 链表头（整块内存，free 一次释放），失败返回 NULL
+ */
+static struct curl_slist *conditional_headers(const cache_entry_t *e, struct curl_slist *tail)
+{
+    size_t size = 2 * sizeof(struct curl_slist) + 64 +
+                  (e->etag ? strlen(e->etag) : 0) + (e->last_modified ? strlen(e->last_modified) : 0);
+    struct curl_slist *list = (struct curl_slist *)malloc(size);
+    char *arena;
+    int n = 0;
+
+    if (!list) return NULL;
+    arena = (char *)(list + 2);
+    if (e->etag) {
+        list[n].data = arena;
+        arena += sprintf(arena, "If-None-Match: %s", e->etag) + 1;
+        n++;
+    }
+    if (e->last_modified) {
+        list[n].data = arena;
+        arena += sprintf(arena, "If-Modified-Since: %s", e->last_modified) + 1;
+        n++;
+    }
+    if (n == 0) {
+        free(list);
+        return NULL;
+    }
+    list[0].next = n > 1 ? &list[1] : tail;
+    list[n - 1].next = tail;
+    return list;
+}
+
+/**
+ * vary_values - 按 Vary 头列出的请求头名取本次请求的值，每个值以 '\n' 结尾
+ * @return malloc 的字符串，内存不足返回 NULL
+ *
+ * 请求自身的头优先于引擎默认头，与实际发出的请求头一致。
+ */
+static char *vary_values(worker_t *worker, const request_node_t *node, const char *vary)
+{
+    size_t cap = 64, len = 0;
+    char *out = (char *)malloc(cap);
+    const char *p = vary;
+
+    if (!out) return NULL;
+    while (*p) {
+        const char *name, *value;
+        size_t name_len, value_len = 0;
+
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        name = p;
+        while (*p && *p != ',' && *p != ' ' && *p != '\t') p++;
+        name_len = (size_t)(p - name);
+        if (name_len == 0) continue;
+
+        value = slist_header_value(node->headers, name, name_len, &value_len);
+        if (!value) value = slist_header_value(worker->default_headers, name, name_len, &value_len);
+        if (len + value_len + 2 > cap) {
+            char *tmp;
+            while (len + value_len + 2 > cap) cap *= 2;
+            tmp = (char *)realloc(out, cap);
+            if (!tmp) {
+                free(out);
+                return NULL;
+            }
+            out = tmp;
+        }
+        if (value) memcpy(out + len, value, value_len);
+        len += value_len;
+        out[len++] = '\n';
+    }
+    out[len] = '\0';
+    return out;
+}
+
+/**
+ * slist_header_value - 在请求头链表中按名称（忽略大小写）查找值，去掉首尾空白
+ * @return 指向链表中字符串的值，没有返回 NULL
+ */
+static const char *slist_header_value(const struct curl_slist *list, const char *name, size_t name_len,
+                                      size_t *value_len)
+{
+    for (; list; list = list->next) {
+        const char *value;
+        if (strncasecmp_ascii(list->data, name, name_len) != 0 || list->data[name_len] != ':') continue;
+        value = list->data + name_len + 1;
+        while (*value == ' ' || *value == '\t') value++;
+        *value_len = strlen(value);
+        while (*value_len > 0 && (value[*value_len - 1] == ' ' || value[*value_len - 1] == '\t')) (*value_len)--;
+        return value;
+    }
+    return NULL;
+}
+
+/**
+ * last_header_block - 取原始响应头中最后一个响应的头（跟随重定向时前面还有中间响应的头）
+ */
+static void last_header_block(const char *headers, size_t len, const char **block, size_t *block_len)
+{
+    const char *start = headers;
+
+    for (size_t i = 0; i + 5 <= len; i++) {
+        if ((i == 0 || headers[i - 1] == '\n') && memcmp(headers + i, "HTTP/", 5) == 0) start = headers + i;
+    }
+    *block     = start;
+    *block_len = len - (size_t)(start - headers);
+}
+
+/**
+ * header_value - 在响应头块中按名称（小写，忽略大小写匹配）查找值，去掉首尾空白
+ * @return 指向响应头块内的值（不以 '\0' 结尾），没有返回 NULL
+ */
+static const char *header_value(const char *block, size_t len, const char *name, size_t *value_len)
+{
+    size_t name_len = strlen(name);
+    const char *end = block + len;
+    const char *line = block;
+
+    while (line < end) {
+        const char *eol = (const char *)memchr(line, '\n', (size_t)(end - line));
+        const char *line_end = eol ? eol : end;
+
+        if ((size_t)(line_end - line) > name_len && line[name_len] == ':' &&
+            strncasecmp_ascii(line, name, name_len) == 0) {
+            const char *v = line + name_len + 1;
+            const char *ve = line_end;
+            while (v < ve && (*v == ' ' || *v == '\t')) v++;
+            while (ve > v && (ve[-1] == '\r' || ve[-1] == ' ' || ve[-1] == '\t')) ve--;
+            *value_len = (size_t)(ve - v);
+            return v;
+        }
+        if (!eol) break;
+        line = eol + 1;
+    }
+    return NULL;
+}
+
+/**
+ * cache_control_lifetime - 按 Cache-Control 调整新鲜期
+ * @param lifetime 输入为配置的 TTL，输出为 min(TTL, max-age)，no-cache 时为 0
+ * @return 0 表示 no-store（不可缓存），1 可缓存
+ */
+static int cache_control_lifetime(const char *value, size_t len, long long *lifetime)
+{
+    const char *p = value, *end = value + len;
+
+    while (p < end) {
+        const char *tok;
+        size_t tok_len;
+
+        while (p < end && (*p == ' ' || *p == '\t' || *p == ',')) p++;
+        tok = p;
+        while (p < end && *p != ',') p++;
+        tok_len = (size_t)(p - tok);
+        while (tok_len > 0 && (tok[tok_len - 1] == ' ' || tok[tok_len - 1] == '\t')) tok_len--;
+
+        if (tok_len == 8 && strncasecmp_ascii(tok, "no-store", 8) == 0) return 0;
+        if (tok_len == 8 && strncasecmp_ascii(tok, "no-cache", 8) == 0) *lifetime = 0;
+        if (tok_len > 8 && strncasecmp_ascii(tok, "max-age=", 8) == 0) {
+            long long max_age = 0;
+            for (size_t i = 8; i < tok_len && tok[i] >= '0' && tok[i] <= '9'; i++) {
+                if (max_age < LLONG_MAX / 10000) max_age = max_age * 10 + (tok[i] - '0');
+            }
+            if (max_age * 1000 < *lifetime) *lifetime = max_age * 1000;
+        }
+    }
+    return 1;
+}
+
+/**
+ * cache_hash - URL 的 FNV-1a 哈希
+ */
+static unsigned int cache_hash(const char *url)
+{
+    unsigned int hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)url; *p; p++) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * wall_ms - 实时时钟（毫秒），缓存的新鲜期要写入磁盘、跨进程有效，不能用单调时钟
+ */
+static long long wall_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* ------------------------------------------------------------------ */
+/*  响应缓存磁盘层                                                     */
+/* ------------------------------------------------------------------ */
+
+/**
+ * disk_path - 缓存文件路径：<disk_dir>/<hash>.rqc
+ */
+static void disk_path(const response_cache_t *cache, unsigned int hash, char *path, size_t size)
+{
+    snprintf(path, size, "%s/%08x.rqc", cache->disk_dir, hash);
+}
+
+/**
+ * disk_file_name - 是否为缓存文件名
+ */
+static int disk_file_name(const char *name)
+{
+    size_t len = strlen(name);
+    return len == 12 && strcmp(name + 8, ".rqc") == 0;
+}
+
+/**
+ * disk_write - 条目写入磁盘层：先写临时文件再 rename，读者不会看到写了一半的文件
+ * 超出磁盘上限时删除最旧的文件。失败时忽略（只影响磁盘层）。
+ */
+static void disk_write(response_cache_t *cache, const cache_entry_t *e)
+{
+    const char *parts[7] = {e->url, e->vary, e->vary_values, e->etag, e->last_modified, e->headers, e->body};
+    char path[PATH_MAX], tmp[PATH_MAX + 32];
+    disk_header_t hdr;
+    struct stat st;
+    size_t total = sizeof(hdr);
+    FILE *f;
+    int ok;
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, DISK_MAGIC, sizeof(hdr.magic));
+    hdr.fresh_until = e->fresh_until;
+    for (int i = 0; i < 7; i++) {
+        hdr.len[i] = !parts[i] ? ~0ULL : i == 5 ? e->headers_len : i == 6 ? e->body_len : strlen(parts[i]);
+        if (parts[i]) total += (size_t)hdr.len[i];
+    }
+
+    disk_path(cache, e->hash, path, sizeof(path));
+    snprintf(tmp, sizeof(tmp), "%s.%lx.tmp", path, (unsigned long)pthread_self());
+    f = fopen(tmp, "wb");
+    if (!f) return;
+    ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+    for (int i = 0; ok && i < 7; i++) {
+        if (parts[i] && hdr.len[i] > 0) ok = fwrite(parts[i], (size_t)hdr.len[i], 1, f) == 1;
+    }
+    if (fclose(f) != 0) ok = 0;
+
+    pthread_mutex_lock(&cache->mutex);
+    if (ok && stat(path, &st) == 0) {
+        cache->disk_bytes -= (size_t)st.st_size < cache->disk_bytes ? (size_t)st.st_size : cache->disk_bytes;
+    }
+    if (ok && rename(tmp, path) == 0) {
+        cache->disk_bytes += total;
+    } else {
+        unlink(tmp);
+    }
+    if (cache->disk_bytes > cache->max_disk) disk_trim(cache);
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+/**
+ * disk_read - 从磁盘层加载 URL 对应的条目（未加入内存层）
+ * @return 条目，没有或文件损坏返回 NULL
+ */
+static cache_entry_t *disk_read(response_cache_t *cache, const char *url, unsigned int hash)
+{
+    char path[PATH_MAX];
+    char *parts[7] = {NULL};
+    disk_header_t hdr;
+    cache_entry_t *e = NULL;
+    FILE *f;
+    int ok;
+
+    disk_path(cache, hash, path, sizeof(path));
+    f = fopen(path, "rb");
+    if (!f) return NULL;
+
+    ok = fread(&hdr, sizeof(hdr), 1, f) == 1 && memcmp(hdr.magic, DISK_MAGIC, sizeof(hdr.magic)) == 0;
+    for (int i = 0; ok && i < 7; i++) {
+        if (hdr.len[i] == ~0ULL) continue;
+        if (hdr.len[i] > (unsigned long long)cache->max_memory) {
+            ok = 0;
+            break;
+        }
+        parts[i] = (char *)malloc((size_t)hdr.len[i] + 1);
+        ok = parts[i] && (hdr.len[i] == 0 || fread(parts[i], (size_t)hdr.len[i], 1, f) == 1);
+        if (ok) parts[i][hdr.len[i]] = '\0';
+    }
+    fclose(f);
+
+    if (ok && parts[0] && parts[5] && parts[6] && strcmp(parts[0], url) == 0) {
+        e = entry_create(parts[0], parts[1], parts[1] ? (size_t)hdr.len[1] : 0, parts[2],
+                         parts[3], parts[3] ? (size_t)hdr.len[3] : 0, parts[4], parts[4] ? (size_t)hdr.len[4] : 0,
+                         parts[5], (size_t)hdr.len[5], parts[6], (size_t)hdr.len[6]);
+        if (e) {
+            e->hash        = hash;
+            e->fresh_until = hdr.fresh_until;
+        }
+    }
+    for (int i = 0; i < 7; i++) free(parts[i]);
+    return e;
+}
+
+/**
+ * cmp_disk_file - 按修改时间升序排列缓存文件
+ */
+static int cmp_disk_file(const void *a, const void *b)
+{
+    const disk_file_t *x = (const disk_file_t *)a;
+    const disk_file_t *y = (const disk_file_t *)b;
+    return x->mtime < y->mtime ? -1 : x->mtime > y->mtime;
+}
+
+/**
+ * disk_trim - 按修改时间删除最旧的缓存文件，直到低于上限的 90%
+ * 持 cache->mutex 调用。
+ */
+static void disk_trim(response_cache_t *cache)
+{
+    DIR *dir = opendir(cache->disk_dir);
+    disk_file_t *files = NULL;
+    size_t n = 0, cap = 0, total = 0;
+    struct dirent *de;
+
+    if (!dir) return;
+    while ((de = readdir(dir)) != NULL) {
+        struct stat st;
+        char path[PATH_MAX];
+        if (!disk_file_name(de->d_name)) continue;
+        snprintf(path, sizeof(path), "%s/%s", cache->disk_dir, de->d_name);
+        if (stat(path, &st) != 0) continue;
+        if (n == cap) {
+            disk_file_t *tmp;
+            cap = cap ? cap * 2 : 64;
+            tmp = (disk_file_t *)realloc(files, cap * sizeof(*files));
+            if (!tmp) break;
+            files = tmp;
+        }
+        memcpy(files[n].name, de->d_name, sizeof(files[n].name));
+        files[n].mtime = (long long)st.st_mtime;
+        files[n].size  = (size_t)st.st_size;
+        total += files[n].size;
+        n++;
+    }
+    closedir(dir);
+
+    qsort(files, n, sizeof(*files), cmp_disk_file);
+    for (size_t i = 0; i < n && total > cache->max_disk / 10 * 9; i++) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", cache->disk_dir, files[i].name);
+        if (unlink(path) == 0) total -= files[i].size;
+    }
+    cache->disk_bytes = total;
+    free(files);
+}
+
+/**
+ * strncasecmp_ascii - 忽略 ASCII 大小写比较前 n 个字符
+ */
+static int strncasecmp_ascii(const char *a, const char *b, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        unsigned char x = (unsigned char)a[i], y = (unsigned char)b[i];
+        if (x >= 'A' && x <= 'Z') x = (unsigned char)(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = (unsigned char)(y - 'A' + 'a');
+        if (x != y) return x - y;
+        if (x == '\0') return 0;
+    }
+    return 0;
+}
+
+/* ------------------------------------------------------------------ */
+/*  取消（只在 Worker 线程中访问）                                     */
+/* ------------------------------------------------------------------ */
+
+/**
+ * take_cancels - 处理取走的取消请求，找不到的（已完成）忽略
+ */
+static void take_cancels(worker_t *worker, cancel_node_t *cancels)
+{
+    while (cancels) {
+        cancel_node_t *next = cancels->next;
+        cancel_request(worker, cancels->seq);
+        free(cancels);
+        cancels = next;
+    }
+}
+
+/**
+ * cancel_request - 按加入顺序号查找并取消请求：执行中、优先级队列、重试堆依次查找
+ * @return 1 已取消，0 未找到
+ *
+ * 队列中查找是线性扫描，取消是低频操作，不为它维护索引。
+ */
+static int cancel_request(worker_t *worker, unsigned long long seq)
+{
+    for (active_request_t *ar = worker->active_list; ar; ar = ar->next) {
+        if (ar->node->seq == seq) {
+            cancel_active(worker, ar);
+            return 1;
         }
-        list = new_list;
     }
-    return list;
+    for (int c = 0; c < CURLRQ_PRIORITY_LEVELS; c++) {
+        request_heap_t *heap = &worker->queues[c];
+        for (int i = 0; i < heap->len; i++) {
+            request_node_t *node = heap->items[i];
+            if (node->seq != seq) continue;
+            heap_remove(heap, i, node_before);
+            worker->queue_len--;
+            RQ_ADD(&worker->engine->class_len[c], -1);
+            finish_unstarted(worker, node, CURLE_ABORTED_BY_CALLBACK, "request cancelled");
+            return 1;
+        }
+    }
+    for (int i = 0; i < worker->retry_heap.len; i++) {
+        request_node_t *node = worker->retry_heap.items[i];
+        if (node->seq != seq) continue;
+        heap_remove(&worker->retry_heap, i, retry_before);
+        if (node->rate_reserved) rate_release(worker->engine, node->req.url);
+        finish_unstarted(worker, node, CURLE_ABORTED_BY_CALLBACK, "request cancelled");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * cancel_active - 中止执行中的请求（及其对冲副本），以取消结果回调
+ * 与 complete_request 相同，回调返回后才减少活跃计数。
+ */
+static void cancel_active(worker_t *worker, active_request_t *ar)
+{
+    request_node_t *node = ar->node;
+    curlrq_response_t resp;
+
+    if (ar->peer) {
+        active_request_t *peer = ar->peer;
+        ar->peer = NULL;
+        worker->hedge_count--;
+        count_transfer(worker, peer->easy);
+        cleanup_active(worker, peer, CURLE_ABORTED_BY_CALLBACK);
+        release_active(worker, peer);
+    }
+    count_transfer(worker, ar->easy);
+    cleanup_active(worker, ar, CURLE_ABORTED_BY_CALLBACK);
+    release_active(worker, ar);
+
+    memset(&resp, 0, sizeof(resp));
+    resp.curl_code     = CURLE_ABORTED_BY_CALLBACK;
+    resp.error_msg     = strdup_safe("request cancelled");
+    resp.attempts      = node->attempts;
+    resp.queue_time_us = node->queue_us;
+    count_result(worker, CURLRQ_ERR_CANCELLED);
+    if (node->callback) {
+        node->callback(&resp, node->req.user_data);
+    }
+    free_node(node);
+
+    RQ_ADD(&worker->active_count, -1);
+    notify_waiters(worker->engine);
+}
+
+/* ------------------------------------------------------------------ */
+/*  按主机限速                                                         */
+/* ------------------------------------------------------------------ */
+
+/**
+ * rate_reserve - 为 URL 的主机取一个令牌
+ * @param try_only 1=没有令牌时不预留，直接返回 -1
+ * @return 0 立即可用，>0 已预留、需等待的微秒数，-1 try_only 时没有令牌
+ *
+ * 主机没有单独限速、也没有默认限速时不限制。host 在锁外取出，锁内只做查表与一次 GCRA 计算。
+ */
+static long long rate_reserve(curlrq_engine_t *engine, const char *url, int try_only)
+{
+    char host[CURLRQ_HOST_MAX];
+    unsigned int hash;
+    host_limit_t *limit;
+    long long now, tat, delay = 0;
+
+    if (url_host(url, host, sizeof(host)) != 0) return 0;
+    hash = host_hash(host);
+    now  = now_us();
+
+    pthread_mutex_lock(&engine->rate_mutex);
+    limit = rate_find(engine, host, hash);
+    if (!limit && engine->rate_interval_us > 0) {
+        if (engine->rate_hosts >= CURLRQ_RATE_HOSTS_MAX) rate_prune(engine, now);
+        limit = rate_insert(engine, host, hash, engine->rate_interval_us, engine->rate_tolerance_us, 0);
+    }
+    if (limit) {
+        tat = limit->tat_us > now ? limit->tat_us : now;
+        if (tat - limit->tolerance_us > now) delay = tat - limit->tolerance_us - now;
+        if (delay > 0 && try_only) {
+            delay = -1;
+        } else {
+            limit->tat_us = tat + limit->interval_us;
+        }
+    }
+    pthread_mutex_unlock(&engine->rate_mutex);
+    return delay;
+}
+
+/**
+ * rate_release - 归还 rate_reserve 预留、最终没有发出的令牌
+ * GCRA 下归还即把理论到达时间回退一个间隔；令牌桶已被删除时无需处理。
+ */
+static void rate_release(curlrq_engine_t *engine, const char *url)
+{
+    char host[CURLRQ_HOST_MAX];
+    host_limit_t *limit;
+
+    if (url_host(url, host, sizeof(host)) != 0) return;
+
+    pthread_mutex_lock(&engine->rate_mutex);
+    limit = rate_find(engine, host, host_hash(host));
+    if (limit) limit->tat_us -= limit->interval_us;
+    pthread_mutex_unlock(&engine->rate_mutex);
+}
+
+/**
+ * rate_find - 查找主机的令牌桶，持 rate_mutex 调用
+ */
+static host_limit_t *rate_find(curlrq_engine_t *engine, const char *host, unsigned int hash)
+{
+    for (host_limit_t *limit = engine->rate_table[hash & (CURLRQ_RATE_BUCKETS - 1)]; limit; limit = limit->next) {
+        if (limit->hash == hash && strcmp(limit->host, host) == 0) return limit;
+    }
+    return NULL;
+}
+
+/**
+ * rate_insert - 新建主机的令牌桶（桶满），持 rate_mutex 调用
+ * @return 令牌桶，内存不足返回 NULL
+ */
+static host_limit_t *rate_insert(curlrq_engine_t *engine, const char *host, unsigned int hash,
+                                 long long interval_us, long long tolerance_us, int configured)
+{
+    size_t len = strlen(host);
+    host_limit_t *limit = (host_limit_t *)malloc(sizeof(*limit) + len + 1);
+    host_limit_t **bucket = &engine->rate_table[hash & (CURLRQ_RATE_BUCKETS - 1)];
+
+    if (!limit) return NULL;
+    limit->hash         = hash;
+    limit->configured   = configured;
+    limit->interval_us  = interval_us;
+    limit->tolerance_us = tolerance_us;
+    limit->tat_us       = 0;
+    memcpy(limit->host, host, len + 1);
+    limit->next = *bucket;
+    *bucket = limit;
+    if (!configured) engine->rate_hosts++;
+    return limit;
+}
+
+/**
+ * rate_remove - 删除一个令牌桶，持 rate_mutex 调用
+ */
+static void rate_remove(curlrq_engine_t *engine, host_limit_t *limit)
+{
+    host_limit_t **pp = &engine->rate_table[limit->hash & (CURLRQ_RATE_BUCKETS - 1)];
+
+    while (*pp != limit) pp = &(*pp)->next;
+    *pp = limit->next;
+    if (!limit->configured) engine->rate_hosts--;
+    free(limit);
+}
+
+/**
+ * rate_prune - 删除按默认限速创建、已经回满的令牌桶（与新建的桶等价），持 rate_mutex 调用
+ */
+static void rate_prune(curlrq_engine_t *engine, long long now)
+{
+    for (int b = 0; b < CURLRQ_RATE_BUCKETS; b++) {
+        host_limit_t **pp = &engine->rate_table[b];
+        while (*pp) {
+            host_limit_t *limit = *pp;
+            if (!limit->configured && limit->tat_us <= now) {
+                *pp = limit->next;
+                engine->rate_hosts--;
+                free(limit);
+            } else {
+                pp = &limit->next;
+            }
+        }
+    }
+}
+
+/**
+ * rate_clear - 删除按默认限速创建的令牌桶，configured_too=1 时全部删除
+ * 持 rate_mutex 调用（free_engine 中不需要）。
+ */
+static void rate_clear(curlrq_engine_t *engine, int configured_too)
+{
+    for (int b = 0; b < CURLRQ_RATE_BUCKETS; b++) {
+        host_limit_t **pp = &engine->rate_table[b];
+        while (*pp) {
+            host_limit_t *limit = *pp;
+            if (configured_too || !limit->configured) {
+                *pp = limit->next;
+                if (!limit->configured) engine->rate_hosts--;
+                free(limit);
+            } else {
+                pp = &limit->next;
+            }
+        }
+    }
+}
+
+/**
+ * url_host - 取 URL 中的 host[:port]（小写，跳过 userinfo），与 host_hash 的范围一致
+ * @return 0 成功，-1 过长
+ */
+static int url_host(const char *url, char *host, size_t size)
+{
+    const char *p = strstr(url, "://");
+    const char *at, *end;
+    size_t n = 0;
+
+    p = p ? p + 3 : url;
+    at  = strchr(p, '@');
+    end = strpbrk(p, "/?#");
+    if (at && (!end || at < end)) p = at + 1;
+
+    for (; *p && *p != '/' && *p != '?' && *p != '#'; p++) {
+        char c = *p;
+        if (n + 1 >= size) return -1;
+        host[n++] = c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+    }
+    host[n] = '\0';
+    return 0;
+}
+
+/* ------------------------------------------------------------------ */
+/*  easy 句柄池与连接复用                                              */
+/* ------------------------------------------------------------------ */
+
+/**
+ * acquire_easy - 从 Worker 的句柄池取出 easy 句柄，池空时新建
+ * 句柄池只在 Worker 线程中访问
+ */
+static CURL *acquire_easy(worker_t *worker)
+{
+    CURL *easy;
+
+    if (worker->easy_pool_len > 0) {
+        return worker->easy_pool[--worker->easy_pool_len];
+    }
+
+    easy = curl_easy_init();
+    if (!easy) return NULL;
+    /* curl_easy_reset 不会清除共享对象，只需在新建时设置一次 */
+    curl_easy_setopt(easy, CURLOPT_SHARE, worker->engine->share);
+    return easy;
+}
+
+/**
+ * release_easy - 重置 easy 句柄并放回 Worker 的句柄池，池满时销毁
+ * curl_easy_reset 保留连接、TLS 会话与 DNS 缓存，下次请求可直接复用。
+ * 池容量等于 max_concurrent，稳定负载下不再新建句柄。
+ */
+static void release_easy(worker_t *worker, CURL *easy)
+{
+    if (worker->easy_pool_len < worker->engine->max_concurrent) {
+        curl_easy_reset(easy);
+        worker->easy_pool[worker->easy_pool_len++] = easy;
+    } else {
+        curl_easy_cleanup(easy);
+    }
+}
+
+/**
+ * apply_engine_opts - 拷贝引擎的默认头、连接复用、重试与对冲选项，并应用到 Worker 的 multi 句柄
+ * 只能在该 Worker 线程中调用；引擎选项由 engine->mutex 保护，拷贝后调度时不再加锁。
+ */
+static void apply_engine_opts(worker_t *worker)
+{
+    curlrq_engine_t *engine = worker->engine;
+    struct curl_slist *headers = NULL;
+    long max_host_connections;
+
+    pthread_mutex_lock(&engine->mutex);
+    for (struct curl_slist *cur = engine->default_headers; cur; cur = cur->next) {
+        struct curl_slist *tmp = curl_slist_append(headers, cur->data);
+        if (tmp) headers = tmp;
+    }
+    worker->http2        = engine->http2;
+    max_host_connections = engine->max_host_connections;
+    worker->retry        = engine->retry;
+    worker->hedging      = engine->hedging;
+    worker->hedge_min_delay_ms = engine->hedge_min_delay_ms;
+    pthread_mutex_unlock(&engine->mutex);
+
+    if (worker->default_headers) curl_slist_free_all(worker->default_headers);
+    worker->default_headers = headers;
+
+    /* 未开启过 HTTP/2 时不改动 libcurl 的默认 CURLMOPT_PIPELINING */
+    if (worker->http2 != worker->multi_http2) {
+        curl_multi_setopt(worker->multi, CURLMOPT_PIPELINING,
+                          worker->http2 ? (long)CURLPIPE_MULTIPLEX : (long)CURLPIPE_NOTHING);
+        worker->multi_http2 = worker->http2;
+    }
+    curl_multi_setopt(worker->multi, CURLMOPT_MAX_HOST_CONNECTIONS, max_host_connections);
+}
+
+/**
+ * mark_opts_dirty - 引擎选项变更后通知所有 Worker 重新拷贝
+ * 调用时必须持有 engine->mutex。之后提交的请求被 Worker 取走时一定能看到新选项。
+ */
+static void mark_opts_dirty(curlrq_engine_t *engine)
+{
+    for (int i = 0; i < engine->num_workers; i++) {
+        RQ_STORE(&engine->workers[i].opts_dirty, 1);
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/*  Worker 分派                                                        */
+/* ------------------------------------------------------------------ */
+
+/**
+ * pick_worker - 按分派策略为请求选择 Worker（无锁）
+ *
+ * 按主机分派时同一主机的请求固定在一个 Worker 上，
+ * 连接缓存和 CURLMOPT_MAX_HOST_CONNECTIONS 都是按 multi 句柄计算的，这样复用率最高。
+ */
+static worker_t *pick_worker(curlrq_engine_t *engine, const char *url)
+{
+    unsigned int index;
+
+    if (engine->num_workers == 1) return &engine->workers[0];
+
+    if (engine->dispatch == CURLRQ_DISPATCH_BY_HOST) {
+        index = host_hash(url);
+    } else {
+        index = RQ_ADD(&engine->next_worker, 1u) - 1u;
+    }
+    return &engine->workers[index % (unsigned int)engine->num_workers];
+}
+
+/**
+ * active_total - 所有 Worker 的活跃请求数之和
+ */
+static int active_total(curlrq_engine_t *engine)
+{
+    int count = 0;
+    for (int i = 0; i < engine->num_workers; i++) count += RQ_LOAD(&engine->workers[i].active_count);
+    return count;
+}
+
+static void share_lock_cb(CURL *handle, curl_lock_data data, curl_lock_access access, void *userp)
+{
+    curlrq_engine_t *engine = (curlrq_engine_t *)userp;
+    (void)handle;
+    (void)access;
+    pthread_mutex_lock(&engine->share_locks[data]);
+}
+
+static void share_unlock_cb(CURL *handle, curl_lock_data data, void *userp)
+{
+    curlrq_engine_t *engine = (curlrq_engine_t *)userp;
+    (void)handle;
+    pthread_mutex_unlock(&engine->share_locks[data]);
+}
+
+/* ------------------------------------------------------------------ */
+/*  libcurl 写入回调                                                   */
+/* ------------------------------------------------------------------ */
+
+/**
+ * write_body_cb - CURLOPT_WRITEFUNCTION
+ * 将响应 body 写入 output_fd、交给 on_data 或写入动态缓存。
+ * 支持 max_response_size 限制：超过限制时返回 0 中断传输。
+ */
+static size_t write_body_cb(void *data, size_t size, size_t nmemb, void *userp)
+{
+    active_request_t *ar = (active_request_t *)userp;
+    const curlrq_request_t *req = &ar->node->req;
+    size_t total = size * nmemb;
+    size_t new_len = ar->write_len + total;
+
+    /* 检查响应大小限制 */
+    if (req->max_response_size > 0 &&
+        (long)new_len > req->max_response_size) {
+        return 0;  /* 返回 0 告诉 libcurl 中断传输 */
+    }
+
+    /* 流式模式：不缓存，write_len 只记录已交付字节数 */
+    if (req->output_fd > 0) {
+        ar->delivered = 1;
+        if (write_all(req->output_fd, (const char *)data, total) != 0) return 0;
+        ar->write_len = new_len;
+        return total;
+    }
+    if (req->stream && req->stream->on_data) {
+        ar->delivered = 1;
+        if (req->stream->on_data((const char *)data, total, req->user_data) != 0) return 0;
+        ar->write_len = new_len;
+        return total;
+    }
+
+    /*
+     * 首次写入时按 Content-Length 一次分配到位，避免大响应反复 realloc。
+     * 预分配不超过 max_response_size 与 CURLRQ_PREALLOC_MAX，长度不符时照常倍增。
+     */
+    if (ar->write_cap == 0) {
+        curl_off_t content_length = -1;
+        curl_easy_getinfo(ar->easy, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &content_length);
+        if (content_length > 0 && content_length <= CURLRQ_PREALLOC_MAX &&
+            (req->max_response_size <= 0 || content_length <= req->max_response_size)) {
+            ar->write_buf = (char *)malloc((size_t)content_length + 1);
+            if (!ar->write_buf) return 0;
+            ar->write_cap = (size_t)content_length + 1;
+        }
+    }
+
+    /* 扩展缓存 */
+    if (new_len >= ar->write_cap) {
+        size_t new_cap = ar->write_cap ? ar->write_cap * 2 : 4096;
+        while (new_cap < new_len + 1) new_cap *= 2;
+
+        char *new_buf = (char *)realloc(ar->write_buf, new_cap);
+        if (!new_buf) return 0;
+        ar->write_buf = new_buf;
+        ar->write_cap = new_cap;
+    }
+
+    memcpy(ar->write_buf + ar->write_len, data, total);
+    ar->write_len = new_len;
+    ar->write_buf[ar->write_len] = '\0';  /* 保持字符串结尾 */
+
+    return total;
+}
+
+/**
+ * write_header_cb - CURLOPT_HEADERFUNCTION
+ * 将响应头交给 on_header 或写入动态缓存。
+ */
+static size_t write_header_cb(void *data, size_t size, size_t nmemb, void *userp)
+{
+    active_request_t *ar = (active_request_t *)userp;
+    const curlrq_request_t *req = &ar->node->req;
+    size_t total = size * nmemb;
+    size_t new_len = ar->header_len + total;
+
+    if (req->stream && req->stream->on_header) {
+        ar->delivered = 1;
+        if (req->stream->on_header((const char *)data, total, req->user_data) != 0) return 0;
+        return total;
+    }
+
+    /* 扩展缓存 */
+    if (new_len >= ar->header_cap) {
+        size_t new_cap = ar->header_cap ? ar->header_cap * 2 : 2048;
+        while (new_cap < new_len + 1) new_cap *= 2;
+
+        char *new_buf = (char *)realloc(ar->header_buf, new_cap);
+        if (!new_buf) return 0;
+        ar->header_buf = new_buf;
+        ar->header_cap = new_cap;
+    }
+
+    memcpy(ar->header_buf + ar->header_len, data, total);
+    ar->header_len = new_len;
+    ar->header_buf[ar->header_len] = '\0';
+
+    return total;
+}
+
+/* ------------------------------------------------------------------ */
+/*  工具函数                                                           */
+/* ------------------------------------------------------------------ */
+
+/**
+ * strdup_safe - 安全的 strdup，对 NULL 返回 NULL
+ */
+static char *strdup_safe(const char *s)
+{
+    if (!s) return NULL;
+    size_t len = strlen(s);
+    char *d = (char *)malloc(len + 1);
+    if (!d) return NULL;
+    memcpy(d, s, len + 1);
+    return d;
+}
+
+/**
+ * arena_copy - 把 len 字节拷贝到 arena 当前位置并补 '\0'，arena 前移
+ * @return 拷贝的起始地址
+ */
+static char *arena_copy(char **arena, const char *s, size_t len)
+{
+    char *d = *arena;
+    memcpy(d, s, len);
+    d[len] = '\0';
+    *arena = d + len + 1;
+    return d;
+}
+
+/**
+ * write_all - 写完全部数据，处理部分写入与 EINTR
+ * @return 0 成功，-1 失败
+ */
+static int write_all(int fd, const char *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += n;
+        len  -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * host_hash - URL 中主机部分（含端口，忽略大小写与 userinfo）的 FNV-1a 哈希
+ */
+static unsigned int host_hash(const char *url)
+{
+    const char *p = strstr(url, "://");
+    unsigned int hash = 2166136261u;
+
+    p = p ? p + 3 : url;
+    /* 跳过 user:password@ */
+    const char *at = strchr(p, '@');
+    const char *end = strpbrk(p, "/?#");
+    if (at && (!end || at < end)) p = at + 1;
+
+    for (; *p && *p != '/' && *p != '?' && *p != '#'; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 'A' && c <= 'Z') c = (unsigned char)(c - 'A' + 'a');
+        hash = (hash ^ c) * 16777619u;
+    }
+    return hash;
 }
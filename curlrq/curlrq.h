@@ -6,11 +6,19 @@
  * 基于 libcurl multi 接口 + pthread 的并发 HTTP 请求引擎
  *
  * 核心特点:
- *   - 使用 curl_multi_perform 实现滚动并发窗口
+ *   - Linux 下由 epoll + timerfd 事件循环驱动 curl_multi_socket_action 实现滚动并发窗口，
+ *     其他平台（或定义 CURLRQ_NO_EPOLL）回退到 curl_multi_poll
  *   - Worker 线程自动管理请求生命周期
  *   - 所有任务完成后线程等待，新任务自动唤醒
- *   - 并发数可控（不超过 3）
+ *   - 并发数可控（每个 Worker 不超过 1024），可分片到多个 Worker 线程
  *   - 通过回调返回结果，不阻塞调用方
+ *   - curlrq_add 无锁提交，多线程并发提交不争用互斥锁
+ *   - easy 句柄池 + 共享 DNS/TLS 会话缓存，跨批次复用连接，可选 HTTP/2 多路复用
+ *   - 可选自动重试（指数退避 + 抖动，支持 Retry-After）与对冲请求，降低不稳定上游的尾延迟
+ *   - 请求可通过句柄取消（排队中或执行中）；按主机令牌桶限速，等待令牌的请求不占并发槽位
+ *   - 可选响应缓存（LRU 内存层 + 磁盘层），自动 ETag/Last-Modified 重新验证
+ *   - 每个响应带分阶段耗时（排队/DNS/连接/TLS/首字节/传输），引擎提供统计快照
+ *   - 请求数据与节点同一块内存分配，控制块回收复用；可选零拷贝提交 curlrq_add_nocopy
  */
 
 #include <stddef.h>
@@ -19,6 +27,95 @@
 extern "C" {
 #endif
 
+/* ------------------------------------------------------------------ */
+/*  流式回调                                                           */
+/* ------------------------------------------------------------------ */
+
+/**
+ * curlrq_stream_t - 流式响应回调
+ *
+ * 在 Worker 线程中、传输进行中被调用，回调内不要阻塞太久。
+ * 返回 0 继续传输，非 0 中止传输（完成回调收到 CURLE_WRITE_ERROR）。
+ * 任一回调可为 NULL。
+ */
+typedef struct {
+    /* 每收到一行响应头（含结尾 \r\n，跟随重定向时包含中间响应的头）调用一次，设置后不再缓存响应头 */
+    int (*on_header)(const char *line, size_t len, void *user_data);
+    /* 每收到一段响应 body 调用一次，设置后不再缓存 body */
+    int (*on_data)(const char *data, size_t len, void *user_data);
+} curlrq_stream_t;
+
+/* ------------------------------------------------------------------ */
+/*  优先级                                                             */
+/* ------------------------------------------------------------------ */
+
+/**
+ * curlrq_priority_t - 请求优先级
+ *
+ * Worker 总是先启动高优先级的请求，同一优先级内按截止时间最早优先，
+ * 无截止时间的请求排在有截止时间的之后、按加入顺序启动。
+ * 优先级是严格的：高优先级请求持续不断时低优先级请求会一直排队，可通过 curlrq_pending_priority 观察。
+ */
+typedef enum {
+    CURLRQ_PRIORITY_NORMAL = 0,    /* 默认 */
+    CURLRQ_PRIORITY_HIGH   = 1,    /* 延迟敏感的请求，如 API 调用 */
+    CURLRQ_PRIORITY_LOW    = 2     /* 后台批量请求，如大文件下载 */
+} curlrq_priority_t;
+
+#define CURLRQ_PRIORITY_LEVELS 3   /* 优先级个数 */
+
+/* ------------------------------------------------------------------ */
+/*  重试策略                                                           */
+/* ------------------------------------------------------------------ */
+
+/**
+ * curlrq_retry_policy_t - 引擎级自动重试策略
+ *
+ * 失败的请求在 Worker 内部按指数退避 + 完全抖动延迟后重新排队，保持原来的优先级与加入顺序，
+ * 只有最后一次的结果交给完成回调。以下情况不重试：
+ *   - 非幂等方法（POST/PATCH 等），除非 retry_non_idempotent=1
+ *   - 已向 stream 回调或 output_fd 交付过数据
+ *   - 退避结束时已过 deadline_ms
+ * 所有字段为 0 时使用括号中的默认值。
+ */
+typedef struct {
+    int         max_attempts;        /* 最多传输次数（含首次），<=1 表示不重试 */
+    long        base_delay_ms;       /* 退避基准，第 n 次重试的延迟在 [0, base * 2^(n-1)] 中随机（100） */
+    long        max_delay_ms;        /* 单次退避上限（10000） */
+    int         retry_network_errors;/* 1=重试连接/DNS/超时/收发失败等传输错误 */
+    const int  *retry_status;        /* 需要重试的 HTTP 状态码，0 结尾（内部拷贝，最多 16 个），NULL=429/502/503/504 */
+    int         honor_retry_after;   /* 1=响应带 Retry-After 时按其延迟，超过 max_delay_ms 则不再重试 */
+    int         retry_non_idempotent;/* 1=POST/PATCH 等非幂等方法也重试 */
+} curlrq_retry_policy_t;
+
+/* ------------------------------------------------------------------ */
+/*  响应缓存                                                           */
+/* ------------------------------------------------------------------ */
+
+/**
+ * curlrq_cache_config_t - 引擎内 HTTP 响应缓存配置
+ *
+ * 缓存 GET 请求的 200 响应，键为 方法 + URL + 响应 Vary 头所列请求头的值。
+ * 新鲜期内直接用缓存回调、不发请求；过期后自动带 If-None-Match / If-Modified-Since 重新验证，
+ * 服务器返回 304 时用缓存的 body 回调（http_code 为 200）。
+ * 内存层按 LRU 淘汰；设置 disk_dir 后响应同时写入磁盘，内存未命中时从磁盘加载，引擎重启后仍可用。
+ */
+typedef struct {
+    size_t      max_memory_bytes;   /* 内存层上限（body + 响应头），0=32MB */
+    long        ttl_ms;             /* 新鲜期上限（毫秒），响应带 max-age 时取较小值；0=每次都重新验证 */
+    const char *disk_dir;           /* 磁盘层目录（不存在时创建，内部拷贝），NULL=只用内存 */
+    size_t      max_disk_bytes;     /* 磁盘层上限，0=256MB */
+} curlrq_cache_config_t;
+
+/**
+ * curlrq_cache_status_t - 响应与缓存的关系
+ */
+typedef enum {
+    CURLRQ_CACHE_NONE        = 0,   /* 来自网络（未命中或未使用缓存） */
+    CURLRQ_CACHE_HIT         = 1,   /* 新鲜期内命中，未发请求 */
+    CURLRQ_CACHE_REVALIDATED = 2    /* 服务器返回 304，body 来自缓存 */
+} curlrq_cache_status_t;
+
 /* ------------------------------------------------------------------ */
 /*  请求配置结构体                                                      */
 /* ------------------------------------------------------------------ */
@@ -46,6 +143,20 @@ typedef struct {
     long                 max_response_size; /* 响应 body 最大字节数，0 表示无限制 */
     int                  verify_ssl;        /* 是否验证 SSL 证书: 1=验证，0=跳过 */
     void                *user_data;         /* 用户自定义数据，回调时原样传回 */
+    /**
+     * 流式模式：body 不再整体缓存，完成回调中 response_body 为 NULL，
+     * response_body_len 为已交付的字节数。内存占用与响应大小无关。
+     */
+    const curlrq_stream_t *stream;          /* 流式回调（内部会拷贝），NULL 表示整体缓存 */
+    int                  output_fd;         /* body 直接写入此文件描述符（优先于 on_data），0 表示不使用 */
+    curlrq_priority_t    priority;          /* 优先级，默认 CURLRQ_PRIORITY_NORMAL */
+    /**
+     * 绝对截止时间（毫秒，curlrq_now_ms() 时钟），0 表示无截止时间。
+     * 到期仍未启动的请求不再发送，直接以 CURLE_OPERATION_TIMEDOUT 回调；
+     * 已启动的请求总超时不超过剩余时间。
+     */
+    long long            deadline_ms;
+    int                  no_cache;          /* 1=不读也不写响应缓存 */
 } curlrq_request_t;
 
 /* ------------------------------------------------------------------ */
@@ -60,15 +171,71 @@ typedef struct {
 typedef struct {
     int    http_code;               /* HTTP 状态码（如 200/404/500），请求失败时为 0 */
     long   total_time_ms;           /* 请求总耗时（毫秒） */
-    char  *response_body;           /* 响应 body 数据（malloc 分配） */
-    size_t response_body_len;       /* 响应 body 长度 */
-    char  *response_headers;        /* 原始响应头（完整字符串，malloc 分配） */
+    char  *response_body;           /* 响应 body 数据（malloc 分配），流式模式下为 NULL */
+    size_t response_body_len;       /* 响应 body 长度，流式模式下为已交付字节数 */
+    char  *response_headers;        /* 原始响应头（完整字符串，malloc 分配），设置 on_header 时为 NULL */
     size_t response_headers_len;    /* 响应头字符串长度 */
     char  *effective_url;           /* 最终请求 URL（跟随重定向后） */
     int    curl_code;               /* libcurl 返回码，CURLE_OK 表示成功 */
     char  *error_msg;              /* 错误描述，成功时为 NULL（malloc 分配） */
+    int    attempts;                /* 发出的传输次数（含重试与对冲副本），未启动即失败时为 0 */
+    int    cache_status;            /* curlrq_cache_status_t */
+
+    /*
+     * 分阶段耗时（微秒，来自 CURLINFO_*_TIME_T，为最后一次传输的值），缓存命中时除 queue_time_us 外为 0。
+     * 复用连接时 DNS/连接/TLS 为 0；跟随重定向时重定向耗时计入 transfer_time_us。
+     */
+    long long queue_time_us;        /* 加入队列到首次启动 */
+    long long dns_time_us;          /* DNS 解析 */
+    long long connect_time_us;      /* TCP 连接建立 */
+    long long tls_time_us;          /* TLS 握手，明文 HTTP 为 0 */
+    long long ttfb_us;              /* 请求发出到收到响应首字节 */
+    long long transfer_time_us;     /* 首字节到传输结束 */
 } curlrq_response_t;
 
+/* ------------------------------------------------------------------ */
+/*  引擎统计                                                           */
+/* ------------------------------------------------------------------ */
+
+#define CURLRQ_QUEUE_HIST_BUCKETS 28 /* 排队时间直方图格数 */
+
+/**
+ * curlrq_error_class_t - 请求结果的错误分类，用于 curlrq_stats_t.errors
+ */
+typedef enum {
+    CURLRQ_ERR_DNS = 0,             /* 域名解析失败 */
+    CURLRQ_ERR_CONNECT,             /* 连接失败或连接中断 */
+    CURLRQ_ERR_TLS,                 /* TLS 握手或证书错误 */
+    CURLRQ_ERR_TIMEOUT,             /* 超时，含截止时间到期未启动 */
+    CURLRQ_ERR_CANCELLED,           /* 回调中止、超过响应上限或引擎关闭时取消 */
+    CURLRQ_ERR_OTHER,               /* 其他 libcurl 错误 */
+    CURLRQ_ERR_HTTP_4XX,            /* 传输成功但状态码为 4xx */
+    CURLRQ_ERR_HTTP_5XX,            /* 传输成功但状态码为 5xx */
+    CURLRQ_ERR_CLASSES
+} curlrq_error_class_t;
+
+/**
+ * curlrq_stats_t - 引擎统计快照（引擎创建以来的累计值，所有 Worker 合计）
+ *
+ * 计数在 Worker 线程中无锁累加，快照各字段单独读取，不保证彼此严格一致。
+ * 连接复用率 = reused / (reused + connects)；两次快照相减可得到区间内的值。
+ */
+typedef struct {
+    unsigned long long requests;    /* 已回调的请求数（含失败与缓存命中） */
+    unsigned long long transfers;   /* 结束的传输数（含重试与对冲副本） */
+    unsigned long long connects;    /* 新建的连接数（含跟随重定向时新建的） */
+    unsigned long long reused;      /* 复用已有连接且收到响应的传输数 */
+    unsigned long long cache_hits;  /* 新鲜期内命中缓存、未发请求的请求数 */
+    unsigned long long bytes_in;    /* 接收字节数（响应头 + body） */
+    unsigned long long bytes_out;   /* 发送字节数（请求头 + body） */
+    unsigned long long errors[CURLRQ_ERR_CLASSES]; /* 按 curlrq_error_class_t 分类的失败请求数 */
+    /*
+     * 排队时间（加入队列到首次启动）直方图，单位微秒：
+     * 第 0 格为 0，第 i 格为 [2^(i-1), 2^i)，最后一格包含更大的值。
+     */
+    unsigned long long queue_hist[CURLRQ_QUEUE_HIST_BUCKETS];
+} curlrq_stats_t;
+
 /* ------------------------------------------------------------------ */
 /*  回调函数类型                                                       */
 /* ------------------------------------------------------------------ */
@@ -86,19 +253,42 @@ typedef void (*curlrq_callback_t)(curlrq_response_t *resp, void *user_data);
 
 typedef struct curlrq_engine_s curlrq_engine_t;
 
+/**
+ * curlrq_dispatch_t - 多 Worker 引擎的请求分派策略
+ */
+typedef enum {
+    CURLRQ_DISPATCH_ROUND_ROBIN = 0,   /* 依次轮流分派到各 Worker */
+    CURLRQ_DISPATCH_BY_HOST     = 1    /* 按 URL 主机哈希分派，同一主机固定在一个 Worker，连接复用率最高 */
+} curlrq_dispatch_t;
+
 /* ------------------------------------------------------------------ */
 /*  API 函数                                                           */
 /* ------------------------------------------------------------------ */
 
 /**
- * curlrq_init - 创建请求引擎
- * @param max_concurrent 最大并发请求数（不超过 3）
+ * curlrq_init - 创建请求引擎（单 Worker）
+ * @param max_concurrent 最大并发请求数（不超过 1024）
  * @return 引擎句柄，失败返回 NULL
  *
  * Worker 线程首次 curlrq_add 时惰性创建，空闲 5 秒后自动退出。
+ * 等同于 curlrq_init_workers(max_concurrent, 1, CURLRQ_DISPATCH_ROUND_ROBIN)。
  */
 curlrq_engine_t *curlrq_init(int max_concurrent);
 
+/**
+ * curlrq_init_workers - 创建多 Worker 请求引擎
+ * @param max_concurrent 每个 Worker 的最大并发请求数（不超过 1024）
+ * @param num_workers    Worker 线程数（不超过 64）
+ * @param dispatch       请求分派策略
+ * @return 引擎句柄，失败返回 NULL
+ *
+ * 每个 Worker 有独立的线程和 multi 句柄（连接缓存），TLS 握手与回调分摊到多个线程，
+ * 总并发上限为 max_concurrent * num_workers。DNS 与 TLS 会话缓存在 Worker 间共享。
+ * 每个 Worker 的线程在首个分派给它的请求到来时创建，空闲 5 秒后自动退出。
+ * 不同 Worker 上的回调会并发执行。
+ */
+curlrq_engine_t *curlrq_init_workers(int max_concurrent, int num_workers, curlrq_dispatch_t dispatch);
+
 /**
  * curlrq_cleanup - 销毁引擎，等待所有请求完成
  * @param engine 引擎句柄
@@ -117,12 +307,53 @@ void curlrq_cleanup(curlrq_engine_t *engine);
  *
  * 请求加入内部队列，Worker 线程自动调度执行。
  * 当并发数未满时立即启动，否则排队等待。
+ * 可在任意线程（包括回调中）并发调用，提交路径不加锁。
  *
  * 注意：如果引擎正在销毁（curlrq_cleanup 已调用），
  * 新请求会被拒绝并返回 -1。
  */
 int curlrq_add(curlrq_engine_t *engine, const curlrq_request_t *req, curlrq_callback_t cb);
 
+/**
+ * curlrq_add_nocopy - 添加 HTTP 请求，不拷贝请求字符串（零拷贝）
+ * @param engine 引擎句柄
+ * @param req    请求配置
+ * @param cb     完成回调函数
+ * @return 0 成功，-1 失败
+ *
+ * 与 curlrq_add 相同，但 url、method、body 以及 headers 数组中的各个字符串只被引用、不拷贝，
+ * 调用方必须保证它们在完成回调被调用之前一直有效（返回 -1 时可立即释放）。
+ * headers 数组本身、stream 结构体与其余字段仍在调用时读取，之后可释放。
+ * 适合 body 较大或请求模板长期不变（如常量 URL/请求头）的高频提交。
+ */
+int curlrq_add_nocopy(curlrq_engine_t *engine, const curlrq_request_t *req, curlrq_callback_t cb);
+
+/**
+ * curlrq_handle_t - 请求句柄，用于 curlrq_cancel，0 表示无效
+ */
+typedef unsigned long long curlrq_handle_t;
+
+/**
+ * curlrq_submit - 添加 HTTP 请求并返回句柄
+ * @return 请求句柄，失败返回 0
+ *
+ * 与 curlrq_add 相同（拷贝请求数据）。句柄在引擎内唯一，请求结束后失效，不会被复用。
+ */
+curlrq_handle_t curlrq_submit(curlrq_engine_t *engine, const curlrq_request_t *req, curlrq_callback_t cb);
+
+/**
+ * curlrq_cancel - 取消一个请求
+ * @param engine 引擎句柄
+ * @param handle curlrq_submit 返回的句柄
+ * @return 0 已提交取消，-1 句柄无效或引擎正在关闭
+ *
+ * 取消是异步的：由请求所在的 Worker 处理，排队中（含退避、限速等待）的请求不再发送，
+ * 执行中的请求中止传输（含对冲副本）。回调照常调用一次，curl_code 为 CURLE_ABORTED_BY_CALLBACK，
+ * error_msg 为 "request cancelled"。请求在取消生效前已完成时，取消被忽略，回调为正常结果。
+ * 可在任意线程（包括回调中）调用。
+ */
+int curlrq_cancel(curlrq_engine_t *engine, curlrq_handle_t handle);
+
 /**
  * curlrq_set_max_queue_len - 设置最大队列长度
  * @param engine 引擎句柄
@@ -173,6 +404,83 @@ void curlrq_set_default_verify_ssl(curlrq_engine_t *engine, int verify);
  */
 void curlrq_set_default_header(curlrq_engine_t *engine, const char *header);
 
+#define CURLRQ_HTTP2_PRIOR_KNOWLEDGE 2 /* curlrq_set_http2 的 enable 取值：明文 HTTP/2（h2c） */
+
+/**
+ * curlrq_set_http2 - 开启 HTTP/2 多路复用
+ * @param engine 引擎句柄
+ * @param enable 1=开启，0=关闭（默认），CURLRQ_HTTP2_PRIOR_KNOWLEDGE=明文 HTTP/2
+ *
+ * 开启后 HTTPS 请求通过 ALPN 协商 HTTP/2（CURL_HTTP_VERSION_2TLS），
+ * multi 句柄使用 CURLPIPE_MULTIPLEX，同一主机的并发请求复用一条连接的多个 stream，
+ * 新请求会等待已有连接协商完成（CURLOPT_PIPEWAIT），避免重复握手。
+ * 服务器不支持 HTTP/2 时自动回退到 HTTP/1.1。
+ * CURLRQ_HTTP2_PRIOR_KNOWLEDGE 对 http:// 也直接使用 HTTP/2（h2c，不经 Upgrade），
+ * 服务器必须支持 HTTP/2，主要用于本机测试与压测。
+ * 注意 libcurl 7.88 上同一明文 HTTP/2 连接只有第一批 stream 成功，之后复用该连接的请求报 CURLE_HTTP2。
+ */
+void curlrq_set_http2(curlrq_engine_t *engine, int enable);
+
+/**
+ * curlrq_set_max_host_connections - 设置每个主机的最大连接数
+ * @param engine 引擎句柄
+ * @param max_conns 最大连接数，0=不限制（默认）
+ *
+ * 对应 CURLMOPT_MAX_HOST_CONNECTIONS。超出的请求等待已有连接空闲后复用，
+ * 配合 curlrq_set_http2 可将同一主机的请求收敛到少量连接上。
+ * 上限按 Worker 计算；需要精确的每主机上限时使用 CURLRQ_DISPATCH_BY_HOST。
+ */
+void curlrq_set_max_host_connections(curlrq_engine_t *engine, long max_conns);
+
+/**
+ * curlrq_set_retry_policy - 设置自动重试策略
+ * @param engine 引擎句柄
+ * @param policy 重试策略（内部拷贝），NULL=不重试（默认）
+ *
+ * 对之后完成的传输生效。退避中的请求计入 curlrq_pending，curlrq_wait 会等它们最终完成。
+ */
+void curlrq_set_retry_policy(curlrq_engine_t *engine, const curlrq_retry_policy_t *policy);
+
+/**
+ * curlrq_set_hedging - 开启对冲请求
+ * @param engine       引擎句柄
+ * @param enable       1=开启，0=关闭（默认）
+ * @param min_delay_ms 对冲延迟下限（毫秒）
+ *
+ * GET/HEAD 且非流式的请求在 max(p95, min_delay_ms) 毫秒后仍未完成时，再发出一个相同的请求，
+ * 先得到结果的一方胜出，另一方被取消；先完成的一方若是可重试的失败（见 curlrq_retry_policy_t），
+ * 则等待另一方。p95 取自该 Worker 最近 256 个成功请求的耗时，样本不足 32 个时不对冲。
+ * 副本占用并发槽位，只在队列为空且有空闲槽位时发出，不计入 curlrq_active。
+ */
+void curlrq_set_hedging(curlrq_engine_t *engine, int enable, long min_delay_ms);
+
+/**
+ * curlrq_set_rate_limit - 设置按主机的令牌桶限速
+ * @param engine          引擎句柄
+ * @param host            主机名（URL 中的 host[:port]，忽略大小写），NULL=所有未单独设置的主机各自使用此限速
+ * @param requests_per_sec 令牌生成速率（每秒请求数），<=0 取消该限速
+ * @param burst           桶容量（允许的突发请求数），<1 按 1 处理
+ * @return 0 成功，-1 失败（内存不足）
+ *
+ * 每个主机一个令牌桶，所有 Worker 共享。传输启动前取令牌：没有令牌的请求按可用时间进入等待，
+ * 不占用并发槽位，其他主机的请求照常启动；重试也需要取令牌，对冲副本只在有令牌时发出。
+ * 设置了 deadline_ms 的请求在截止时间前等不到令牌时直接按过期失败，不消耗令牌。
+ * 缓存命中不消耗令牌。可随时调用，对之后启动的传输生效。
+ */
+int curlrq_set_rate_limit(curlrq_engine_t *engine, const char *host, double requests_per_sec, int burst);
+
+/**
+ * curlrq_set_cache - 开启 HTTP 响应缓存
+ * @param engine 引擎句柄
+ * @param config 缓存配置（内部拷贝），NULL=关闭
+ * @return 0 成功，-1 失败（内存不足、磁盘目录不可用，或引擎已有请求在执行）
+ *
+ * 须在提交第一个请求之前调用。只缓存非流式（无 stream/output_fd）的 GET 请求，
+ * 带 no_cache、自带 If-None-Match/If-Modified-Since 的请求和 Cache-Control: no-store 的响应不缓存。
+ * 缓存在 Worker 间共享；磁盘层的读写在 Worker 线程中同步进行。
+ */
+int curlrq_set_cache(curlrq_engine_t *engine, const curlrq_cache_config_t *config);
+
 /**
  * curlrq_wait - 等待所有待处理请求完成
  * @param engine 引擎句柄
@@ -186,11 +494,34 @@ void curlrq_wait(curlrq_engine_t *engine);
  */
 int curlrq_pending(curlrq_engine_t *engine);
 
+/**
+ * curlrq_pending_priority - 获取某一优先级在队列中等待的请求数
+ * @param engine   引擎句柄
+ * @param priority 优先级
+ *
+ * 低优先级的数量持续增长说明它被高优先级请求饿死。
+ */
+int curlrq_pending_priority(curlrq_engine_t *engine, curlrq_priority_t priority);
+
 /**
  * curlrq_active - 获取正在执行的请求数
  */
 int curlrq_active(curlrq_engine_t *engine);
 
+/**
+ * curlrq_stats - 获取引擎统计快照
+ * @param engine 引擎句柄
+ * @param stats  输出，engine 为 NULL 时清零
+ */
+void curlrq_stats(curlrq_engine_t *engine, curlrq_stats_t *stats);
+
+/**
+ * curlrq_now_ms - 截止时间使用的单调时钟（毫秒）
+ *
+ * 如 req.deadline_ms = curlrq_now_ms() + 200 表示 200 毫秒内必须启动。
+ */
+long long curlrq_now_ms(void);
+
 /**
  * curlrq_response_free - 释放响应数据结构体内部缓存
  * @param resp 响应结果（不 free 结构体本身，仅释放内部成员）
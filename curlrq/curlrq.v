@@ -19,6 +19,50 @@ pub struct C.curlrq_response_t {
     effective_url        &C.char
     curl_code            int
     error_msg            &C.char
+    attempts             int
+    cache_status         int
+    queue_time_us        i64
+    dns_time_us          i64
+    connect_time_us      i64
+    tls_time_us          i64
+    ttfb_us              i64
+    transfer_time_us     i64
+}
+
+// ErrorClass indexes Stats.errors
+pub enum ErrorClass {
+	dns       = 0
+	connect   = 1
+	tls       = 2
+	timeout   = 3
+	cancelled = 4
+	other     = 5
+	http_4xx  = 6
+	http_5xx  = 7
+}
+
+// C.curlrq_stats_t is a cumulative snapshot, reuse ratio is reused / (reused + connects)
+@[typedef]
+pub struct C.curlrq_stats_t {
+pub:
+    requests   u64
+    transfers  u64
+    connects   u64
+    reused     u64
+    cache_hits u64
+    bytes_in   u64
+    bytes_out  u64
+    errors     [8]u64
+    queue_hist [28]u64 // bucket i counts waits in [2^(i-1), 2^i) microseconds
+}
+
+pub type StreamFn = fn (&char, usize, voidptr) int
+
+// C.curlrq_stream_t delivers headers and body while the transfer runs, return non zero to abort
+@[typedef]
+pub struct C.curlrq_stream_t {
+    on_header StreamFn
+    on_data   StreamFn
 }
 
 @[typedef]
@@ -33,22 +77,100 @@ pub struct C.curlrq_request_t {
     max_response_size   int
     verify_ssl          int
     user_data           voidptr
+    stream              &C.curlrq_stream_t
+    output_fd           int
+    priority            int
+    deadline_ms         i64
+    no_cache            int
+}
+
+// Priority is the scheduling class of a request, higher classes always start first
+pub enum Priority {
+	normal = 0
+	high   = 1
+	low    = 2
 }
 
 pub type Callback = fn (&C.curlrq_response_t, voidptr)
 
+@[typedef]
+pub struct C.curlrq_retry_policy_t {
+    max_attempts         int
+    base_delay_ms        int
+    max_delay_ms         int
+    retry_network_errors int
+    retry_status         &int
+    honor_retry_after    int
+    retry_non_idempotent int
+}
+
+// RetryPolicy configures automatic retries with backoff, zero fields take the C defaults
+pub struct RetryPolicy {
+pub:
+	max_attempts         int
+	base_delay_ms        int
+	max_delay_ms         int
+	retry_network_errors bool
+	retry_status         []int // empty for 429/502/503/504
+	honor_retry_after    bool
+	retry_non_idempotent bool
+}
+
+@[typedef]
+pub struct C.curlrq_cache_config_t {
+    max_memory_bytes usize
+    ttl_ms           int
+    disk_dir         &C.char
+    max_disk_bytes   usize
+}
+
+// CacheConfig enables the response cache, zero fields take the C defaults
+pub struct CacheConfig {
+pub:
+	max_memory_bytes usize
+	ttl_ms           int
+	disk_dir         string // empty for memory only
+	max_disk_bytes   usize
+}
+
+// CacheStatus tells whether a response came from the response cache
+pub enum CacheStatus {
+	@none       = 0
+	hit         = 1
+	revalidated = 2
+}
+
+// Dispatch selects the worker of a request in a multi-worker engine
+pub enum Dispatch {
+	round_robin = 0
+	by_host     = 1
+}
+
 fn C.curlrq_init(int) &C.curlrq_engine_t
+fn C.curlrq_init_workers(int, int, int) &C.curlrq_engine_t
 fn C.curlrq_cleanup(&C.curlrq_engine_t)
 fn C.curlrq_add(&C.curlrq_engine_t, &C.curlrq_request_t, Callback) int
+fn C.curlrq_add_nocopy(&C.curlrq_engine_t, &C.curlrq_request_t, Callback) int
+fn C.curlrq_submit(&C.curlrq_engine_t, &C.curlrq_request_t, Callback) u64
+fn C.curlrq_cancel(&C.curlrq_engine_t, u64) int
 fn C.curlrq_set_max_queue_len(&C.curlrq_engine_t, int)
 fn C.curlrq_set_default_timeout_ms(&C.curlrq_engine_t, int)
 fn C.curlrq_set_default_connect_timeout_ms(&C.curlrq_engine_t, int)
 fn C.curlrq_set_default_max_response_size(&C.curlrq_engine_t, int)
 fn C.curlrq_set_default_verify_ssl(&C.curlrq_engine_t, int)
 fn C.curlrq_set_default_header(&C.curlrq_engine_t, &C.char)
+fn C.curlrq_set_http2(&C.curlrq_engine_t, int)
+fn C.curlrq_set_max_host_connections(&C.curlrq_engine_t, int)
+fn C.curlrq_set_retry_policy(&C.curlrq_engine_t, &C.curlrq_retry_policy_t)
+fn C.curlrq_set_hedging(&C.curlrq_engine_t, int, int)
+fn C.curlrq_set_cache(&C.curlrq_engine_t, &C.curlrq_cache_config_t) int
+fn C.curlrq_set_rate_limit(&C.curlrq_engine_t, &char, f64, int) int
 fn C.curlrq_wait(&C.curlrq_engine_t)
 fn C.curlrq_pending(&C.curlrq_engine_t) int
 fn C.curlrq_active(&C.curlrq_engine_t) int
+fn C.curlrq_pending_priority(&C.curlrq_engine_t, int) int
+fn C.curlrq_now_ms() i64
+fn C.curlrq_stats(&C.curlrq_engine_t, &C.curlrq_stats_t)
 fn C.curlrq_response_free(&C.curlrq_response_t)
 
 pub struct Request {
@@ -63,6 +185,11 @@ pub:
 	max_response_size  int
 	verify_ssl         bool
 	user_data          voidptr
+	stream             &C.curlrq_stream_t = unsafe { nil }
+	output_fd          int
+	priority           Priority
+	deadline_ms        i64 // absolute, on the now_ms() clock, 0 for none
+	no_cache           bool
 }
 
 __global default_eng &C.curlrq_engine_t
@@ -93,6 +220,15 @@ pub fn pending() int {
 	return C.curlrq_pending(default_engine())
 }
 
+pub fn pending_priority(priority Priority) int {
+	return C.curlrq_pending_priority(default_engine(), int(priority))
+}
+
+// now_ms is the monotonic clock used by Request.deadline_ms
+pub fn now_ms() i64 {
+	return C.curlrq_now_ms()
+}
+
 pub fn active() int {
 	return C.curlrq_active(default_engine())
 }
@@ -132,6 +268,26 @@ pub fn set_default_header(header string) {
 	C.curlrq_set_default_header(default_engine(), header.str)
 }
 
+pub fn set_http2(enable bool) {
+	C.curlrq_set_http2(default_engine(), if enable { 1 } else { 0 })
+}
+
+pub fn set_max_host_connections(max_conns int) {
+	C.curlrq_set_max_host_connections(default_engine(), max_conns)
+}
+
+pub fn set_retry_policy(policy RetryPolicy) {
+	Engine{default_engine()}.set_retry_policy(policy)
+}
+
+pub fn set_hedging(enable bool, min_delay_ms int) {
+	C.curlrq_set_hedging(default_engine(), if enable { 1 } else { 0 }, min_delay_ms)
+}
+
+pub fn set_cache(config CacheConfig) ! {
+	Engine{default_engine()}.set_cache(config)!
+}
+
 pub struct Engine {
 	handle &C.curlrq_engine_t
 }
@@ -144,12 +300,47 @@ pub fn new_engine(max_concurrent int) !Engine {
 	return Engine{handle}
 }
 
+// new_engine_workers shards requests over num_workers threads, max_concurrent is per worker
+pub fn new_engine_workers(max_concurrent int, num_workers int, dispatch Dispatch) !Engine {
+	handle := C.curlrq_init_workers(max_concurrent, num_workers, int(dispatch))
+	if handle == 0 {
+		return error('curlrq_init_workers failed')
+	}
+	return Engine{handle}
+}
+
 pub fn (e Engine) add(req Request, cb Callback) ! {
+	creq := req.to_c()
+	ret := C.curlrq_add(e.handle, &creq, cb)
+	if ret != 0 {
+		return error('curlrq_add failed')
+	}
+}
+
+// submit is add returning a handle for cancel
+pub fn (e Engine) submit(req Request, cb Callback) !u64 {
+	creq := req.to_c()
+	handle := C.curlrq_submit(e.handle, &creq, cb)
+	if handle == 0 {
+		return error('curlrq_submit failed')
+	}
+	return handle
+}
+
+// cancel aborts a queued or running request, its callback still runs once with CURLE_ABORTED_BY_CALLBACK
+pub fn (e Engine) cancel(handle u64) ! {
+	if C.curlrq_cancel(e.handle, handle) != 0 {
+		return error('curlrq_cancel failed')
+	}
+}
+
+fn (req Request) to_c() C.curlrq_request_t {
     mut creq := C.curlrq_request_t{
         url: 0
         method: 0
         body: 0
         headers: 0
+        stream: 0
     }
     creq.url = req.url.str
     creq.method = req.method.str
@@ -160,6 +351,11 @@ pub fn (e Engine) add(req Request, cb Callback) ! {
     creq.max_response_size = req.max_response_size
     creq.verify_ssl = if req.verify_ssl { 1 } else { 0 }
     creq.user_data = req.user_data
+    creq.stream = req.stream
+    creq.output_fd = req.output_fd
+    creq.priority = int(req.priority)
+    creq.deadline_ms = req.deadline_ms
+    creq.no_cache = if req.no_cache { 1 } else { 0 }
 
 	if req.headers.len > 0 {
 		n := req.headers.len
@@ -171,11 +367,7 @@ pub fn (e Engine) add(req Request, cb Callback) ! {
 			creq.headers = hs.data
 		}
 	}
-
-	ret := C.curlrq_add(e.handle, &creq, cb)
-	if ret != 0 {
-		return error('curlrq_add failed')
-	}
+	return creq
 }
 
 pub fn (e Engine) wait() {
@@ -186,10 +378,20 @@ pub fn (e Engine) pending() int {
 	return C.curlrq_pending(e.handle)
 }
 
+pub fn (e Engine) pending_priority(priority Priority) int {
+	return C.curlrq_pending_priority(e.handle, int(priority))
+}
+
 pub fn (e Engine) active() int {
 	return C.curlrq_active(e.handle)
 }
 
+pub fn (e Engine) stats() C.curlrq_stats_t {
+	mut st := C.curlrq_stats_t{}
+	C.curlrq_stats(e.handle, &st)
+	return st
+}
+
 pub fn (e Engine) response_free(resp &C.curlrq_response_t) {
 	C.curlrq_response_free(resp)
 }
@@ -218,6 +420,59 @@ pub fn (e Engine) set_default_header(header string) {
 	C.curlrq_set_default_header(e.handle, header.str)
 }
 
+pub fn (e Engine) set_http2(enable bool) {
+	C.curlrq_set_http2(e.handle, if enable { 1 } else { 0 })
+}
+
+pub fn (e Engine) set_max_host_connections(max_conns int) {
+	C.curlrq_set_max_host_connections(e.handle, max_conns)
+}
+
+pub fn (e Engine) set_retry_policy(policy RetryPolicy) {
+	mut codes := policy.retry_status.clone()
+	codes << 0
+	cpolicy := C.curlrq_retry_policy_t{
+		max_attempts: policy.max_attempts
+		base_delay_ms: policy.base_delay_ms
+		max_delay_ms: policy.max_delay_ms
+		retry_network_errors: if policy.retry_network_errors { 1 } else { 0 }
+		retry_status: if policy.retry_status.len > 0 { &int(codes.data) } else { unsafe { nil } }
+		honor_retry_after: if policy.honor_retry_after { 1 } else { 0 }
+		retry_non_idempotent: if policy.retry_non_idempotent { 1 } else { 0 }
+	}
+	C.curlrq_set_retry_policy(e.handle, &cpolicy)
+}
+
+// clear_retry_policy turns automatic retries off again
+pub fn (e Engine) clear_retry_policy() {
+	C.curlrq_set_retry_policy(e.handle, unsafe { nil })
+}
+
+pub fn (e Engine) set_hedging(enable bool, min_delay_ms int) {
+	C.curlrq_set_hedging(e.handle, if enable { 1 } else { 0 }, min_delay_ms)
+}
+
+// set_rate_limit throttles host ("host[:port]" as in the URL), an empty host sets the default for every host
+pub fn (e Engine) set_rate_limit(host string, requests_per_sec f64, burst int) ! {
+	chost := if host.len > 0 { &char(host.str) } else { unsafe { nil } }
+	if C.curlrq_set_rate_limit(e.handle, chost, requests_per_sec, burst) != 0 {
+		return error('curlrq_set_rate_limit failed')
+	}
+}
+
+// set_cache must be called before the first request of the engine
+pub fn (e Engine) set_cache(config CacheConfig) ! {
+	cconfig := C.curlrq_cache_config_t{
+		max_memory_bytes: config.max_memory_bytes
+		ttl_ms: config.ttl_ms
+		disk_dir: if config.disk_dir.len > 0 { &char(config.disk_dir.str) } else { unsafe { nil } }
+		max_disk_bytes: config.max_disk_bytes
+	}
+	if C.curlrq_set_cache(e.handle, &cconfig) != 0 {
+		return error('curlrq_set_cache failed')
+	}
+}
+
 pub fn (e Engine) cleanup() {
 	C.curlrq_cleanup(e.handle)
 }
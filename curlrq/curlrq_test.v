@@ -75,3 +75,190 @@ fn test_delete_request() {
 	}) or { panic(err) }
 	eng.wait()
 }
+
+fn test_http2_connection_reuse() {
+	eng := new_engine(3) or { panic(err) }
+	defer {
+		eng.cleanup()
+	}
+	eng.set_http2(true)
+	eng.set_max_host_connections(1)
+	mut before := eng.stats()
+	for batch in 0 .. 2 {
+		for i in 0 .. 5 {
+			eng.add(Request{
+				url: 'https://postman-echo.com/get?n=${i}'
+				timeout_ms: 10000
+				verify_ssl: false
+			}, fn (resp &C.curlrq_response_t, _ voidptr) {
+				assert resp.http_code == 200
+				C.curlrq_response_free(resp)
+			}) or { panic(err) }
+		}
+		eng.wait()
+		if batch == 0 {
+			before = eng.stats()
+		}
+	}
+	// the second batch must ride the connection left open by the first
+	after := eng.stats()
+	assert after.transfers - before.transfers == 5
+	assert after.connects == before.connects
+	assert after.reused - before.reused == 5
+}
+
+fn test_multi_worker_engine() {
+	eng := new_engine_workers(16, 4, .by_host) or { panic(err) }
+	defer {
+		eng.cleanup()
+	}
+	for i in 0 .. 20 {
+		eng.add(Request{
+			url: 'https://postman-echo.com/get?n=${i}'
+			timeout_ms: 10000
+			verify_ssl: false
+		}, fn (resp &C.curlrq_response_t, _ voidptr) {
+			assert resp.http_code == 200
+			C.curlrq_response_free(resp)
+		}) or { panic(err) }
+	}
+	eng.wait()
+	assert eng.pending() == 0
+	assert eng.active() == 0
+}
+
+fn test_streaming_response() {
+	eng := new_engine(3) or { panic(err) }
+	defer {
+		eng.cleanup()
+	}
+	mut received := usize(0)
+	stream := C.curlrq_stream_t{
+		on_header: unsafe { nil }
+		on_data:   fn (_ &char, len usize, user_data voidptr) int {
+			unsafe {
+				*(&usize(user_data)) += len
+			}
+			return 0
+		}
+	}
+	eng.add(Request{
+		url: 'https://postman-echo.com/stream/5'
+		timeout_ms: 10000
+		verify_ssl: false
+		user_data: &received
+		stream: &stream
+	}, fn (resp &C.curlrq_response_t, user_data voidptr) {
+		assert resp.http_code == 200
+		assert resp.response_body == unsafe { nil }
+		assert resp.response_body_len == unsafe { *(&usize(user_data)) }
+		C.curlrq_response_free(resp)
+	}) or { panic(err) }
+	eng.wait()
+	assert received > 0
+}
+
+fn test_expired_deadline_is_not_sent() {
+	eng := new_engine(1) or { panic(err) }
+	defer {
+		eng.cleanup()
+	}
+	eng.add(Request{
+		url: 'https://postman-echo.com/get?late=1'
+		priority: .high
+		deadline_ms: now_ms() - 1
+		verify_ssl: false
+	}, fn (resp &C.curlrq_response_t, _ voidptr) {
+		assert resp.http_code == 0
+		assert resp.curl_code == 28 // CURLE_OPERATION_TIMEDOUT
+		C.curlrq_response_free(resp)
+	}) or { panic(err) }
+	eng.wait()
+	assert eng.pending_priority(.high) == 0
+}
+
+fn test_retry_policy_retries_503() {
+	eng := new_engine(1) or { panic(err) }
+	defer {
+		eng.cleanup()
+	}
+	eng.set_retry_policy(RetryPolicy{
+		max_attempts: 3
+		base_delay_ms: 10
+	})
+	eng.add(Request{
+		url: 'https://postman-echo.com/status/503'
+		verify_ssl: false
+	}, fn (resp &C.curlrq_response_t, _ voidptr) {
+		assert resp.http_code == 503
+		assert resp.attempts == 3
+		C.curlrq_response_free(resp)
+	}) or { panic(err) }
+	eng.wait()
+}
+
+fn test_response_cache_hit() {
+	eng := new_engine(1) or { panic(err) }
+	defer {
+		eng.cleanup()
+	}
+	eng.set_cache(CacheConfig{
+		ttl_ms: 60000
+	}) or { panic(err) }
+	url := 'https://postman-echo.com/response-headers?Cache-Control=max-age%3D60'
+	for want in [CacheStatus.@none, CacheStatus.hit] {
+		eng.add(Request{
+			url: url
+			verify_ssl: false
+			user_data: voidptr(int(want))
+		}, fn (resp &C.curlrq_response_t, user_data voidptr) {
+			assert resp.http_code == 200
+			assert resp.cache_status == int(user_data)
+			C.curlrq_response_free(resp)
+		}) or { panic(err) }
+		eng.wait()
+	}
+}
+
+fn test_timing_and_stats() {
+	eng := new_engine(1) or { panic(err) }
+	defer {
+		eng.cleanup()
+	}
+	eng.add(Request{
+		url: 'https://postman-echo.com/get'
+		verify_ssl: false
+	}, fn (resp &C.curlrq_response_t, _ voidptr) {
+		assert resp.http_code == 200
+		assert resp.ttfb_us > 0
+		C.curlrq_response_free(resp)
+	}) or { panic(err) }
+	eng.wait()
+	st := eng.stats()
+	assert st.requests == 1
+	assert st.transfers == 1
+	assert st.bytes_in > 0
+}
+
+fn test_cancel_queued_request() {
+	eng := new_engine(1) or { panic(err) }
+	defer {
+		eng.cleanup()
+	}
+	eng.add(Request{
+		url: 'https://postman-echo.com/delay/1'
+		verify_ssl: false
+	}, fn (resp &C.curlrq_response_t, _ voidptr) {
+		C.curlrq_response_free(resp)
+	}) or { panic(err) }
+	handle := eng.submit(Request{
+		url: 'https://postman-echo.com/get'
+		verify_ssl: false
+	}, fn (resp &C.curlrq_response_t, _ voidptr) {
+		assert resp.curl_code == 42 // CURLE_ABORTED_BY_CALLBACK
+		assert resp.attempts == 0
+		C.curlrq_response_free(resp)
+	}) or { panic(err) }
+	eng.cancel(handle) or { panic(err) }
+	eng.wait()
+}
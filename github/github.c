@@ -27,10 +27,17 @@
 
 #define _DEFAULT_SOURCE
 #include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include <curl/curl.h>
 
@@ -152,13 +159,14 @@ static int
 parse_link_header(const char *header, link_t *links, int count)
 {
     int link_count = 0;
-    char *token = strtok((char *)header, ",");
+    char *save = NULL;
+    char *token = strtok_r((char *)header, ",", &save);
 
     while (token != NULL && link_count < count) {
         char *url_start = strchr(token, '<');
         char *url_end = strchr(token, '>');
         char *rel_start = strstr(token, "rel=\"");
-        char *rel_end = strchr(rel_start, '\"');
+        char *rel_end = rel_start != NULL ? strchr(rel_start + 5, '\"') : NULL;
 
         if (url_start && url_end && rel_start && rel_end) {
             *url_end = '\0';
@@ -170,7 +178,7 @@ parse_link_header(const char *header, link_t *links, int count)
             link_count++;
         }
 
-        token = strtok(NULL, ",");
+        token = strtok_r(NULL, ",", &save);
     }
 
     return link_count;
@@ -197,7 +205,8 @@ header_cb(char *buffer, size_t size, size_t nmemb, void *userdata)
     size_t total_size = size * nmemb;
     gh_client_response_t *response = (gh_client_response_t*)userdata;
 
-    char *line = strtok(buffer, "\r\n");
+    char *save = NULL;
+    char *line = strtok_r(buffer, "\r\n", &save);
     char *key = strsep(&line, ":");
     char *value = strsep(&line, "\n");
 
@@ -220,32 +229,29 @@ header_cb(char *buffer, size_t size, size_t nmemb, void *userdata)
         }
 
         if (strcmp(key, "link") == 0) {
-            int link_count = 0;
+            // a header with a single link has no comma
+            int link_count = 1;
             for (int i = 0; value[i]; i++) {
                 if (value[i] == ',') {
                     link_count++;
                 }
             }
-            if (link_count > 0) {
-                link_count++;
-            }
 
             link_t links[link_count];
-            parse_link_header(value, links, link_count);
-            
+            link_count = parse_link_header(value, links, link_count);
 
             for (int i = 0; i < link_count; i++) {
-                if (strstr(links[i].rel, "first\"") != NULL) {
+                if (strcmp(links[i].rel, "first") == 0) {
                     strcpy(response->first_link, links[i].url);
                 }
-                if (strstr(links[i].rel, "prev\"") != NULL) {
+                if (strcmp(links[i].rel, "prev") == 0) {
                     strcpy(response->prev_link, links[i].url);
                 }
-                if (strstr(links[i].rel, "next") != NULL) {
+                if (strcmp(links[i].rel, "next") == 0) {
                     strcpy(response->next_link, links[i].url);
                 }
 
-                if (strstr(links[i].rel, "last\"") != NULL) {
+                if (strcmp(links[i].rel, "last") == 0) {
                     strcpy(response->last_link, links[i].url);
                 }
             }
@@ -267,6 +273,19 @@ gh_client_response_new()
     return resp;
 }
 
+/**
+ * Store the HTTP status of the last transfer. CURLINFO_RESPONSE_CODE writes
+ * a long, reading it straight into resp_code overwrites the fields after it.
+ */
+static inline void
+response_code_set(CURL *handle, gh_client_response_t *response)
+{
+    long code = 0;
+
+    curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &code);
+    response->resp_code = (uint16_t)code;
+}
+
 gh_client_response_t*
 gh_client_octocat_says()
 {
@@ -286,7 +305,7 @@ gh_client_octocat_says()
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void*)response);
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     if (res != CURLE_OK) {
         char *err_msg = (char*)curl_easy_strerror(res);
@@ -350,7 +369,7 @@ gh_client_repo_list_by_org_name(const char *owner,
     SET_BASIC_CURL_CONFIG;
     
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -405,7 +424,7 @@ gh_client_repo_get(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
     
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -454,7 +473,7 @@ gh_client_repo_release_asset_update(const char *owner, const char *repo,
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -500,7 +519,7 @@ gh_client_repo_release_asset_delete(const char *owner, const char *repo,
     curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -508,9 +527,48 @@ gh_client_repo_release_asset_delete(const char *owner, const char *repo,
     return response; 
 }
 
+/**
+ * State of a streaming asset upload.
+ */
+typedef struct {
+    int fd;
+    gh_client_progress_cb progress;
+    void *user_data;
+} upload_state_t;
+
+static size_t
+upload_read_cb(char *buffer, size_t size, size_t nitems, void *userdata)
+{
+    upload_state_t *state = (upload_state_t*)userdata;
+
+    for (;;) {
+        ssize_t n = read(state->fd, buffer, size * nitems);
+        if (n >= 0) {
+            return (size_t)n;
+        }
+        if (errno != EINTR) {
+            return CURL_READFUNC_ABORT;
+        }
+    }
+}
+
+static int
+transfer_progress_cb(void *clientp, curl_off_t dltotal, curl_off_t dlnow,
+                     curl_off_t ultotal, curl_off_t ulnow)
+{
+    upload_state_t *state = (upload_state_t*)clientp;
+    (void)dltotal;
+    (void)dlnow;
+
+    return state->progress((uint64_t)ulnow, (uint64_t)ultotal, state->user_data);
+}
+
 gh_client_response_t*
-gh_client_repo_release_asset_upload(const char *upload_url, const char *name,
-                                 const char *label, const char *file_path)
+gh_client_repo_release_asset_upload_fd(const char *upload_url, const char *name,
+                                       const char *label, const int fd,
+                                       const char *content_type,
+                                       gh_client_progress_cb progress,
+                                       void *user_data)
 {
     gh_client_response_t *response = gh_client_response_new();
 
@@ -520,81 +578,544 @@ gh_client_repo_release_asset_upload(const char *upload_url, const char *name,
         return response;
     }
 
+    if (name == NULL) {
+        response->err_msg = calloc(24, sizeof(char));
+        strcpy(response->err_msg, "error: name arg is NULL");
+        return response;
+    }
+
+    // GitHub needs the length up front, it is what is left of the file
+    struct stat st;
+    off_t start = lseek(fd, 0, SEEK_CUR);
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || start < 0) {
+        response->err_msg = calloc(32, sizeof(char));
+        strcpy(response->err_msg, "error: fd is not a regular file");
+        return response;
+    }
+    curl_off_t file_size = (curl_off_t)(st.st_size - start);
+
+    CURL *handle = curl_easy_init();
+    if (handle == NULL) {
+        response->err_msg = calloc(30, sizeof(char));
+        strcpy(response->err_msg, "error: curl_easy_init failed");
+        return response;
+    }
+
+    // the upload_url of a release is a template, e.g. .../assets{?name,label}
+    char url[DEFAULT_URL_SIZE] = {0};
+    size_t url_len = strcspn(upload_url, "{");
+    if (url_len >= sizeof(url)) {
+        url_len = sizeof(url) - 1;
+    }
+    memcpy(url, upload_url, url_len);
+
+    char *esc_name = curl_easy_escape(handle, name, 0);
+    char *esc_label = label != NULL && label[0] != '\0' ?
+        curl_easy_escape(handle, label, 0) : NULL;
+    size_t used = strlen(url);
+    snprintf(url + used, sizeof(url) - used, "%cname=%s%s%s",
+             strchr(url, '?') != NULL ? '&' : '?', esc_name ? esc_name : "",
+             esc_label != NULL ? "&label=" : "", esc_label != NULL ? esc_label : "");
+    curl_free(esc_name);
+    curl_free(esc_label);
+
+    char content_type_header[128];
+    snprintf(content_type_header, sizeof(content_type_header),
+             "Content-Type: %s", content_type != NULL ? content_type :
+             "application/octet-stream");
+
+    struct curl_slist *chunk = NULL;
+    chunk = curl_slist_append(chunk, GH_REQ_JSON_HEADER);
+    chunk = curl_slist_append(chunk, token_header);
+    chunk = curl_slist_append(chunk, GH_REQ_VER_HEADER);
+    chunk = curl_slist_append(chunk, GH_REQ_DEF_UA_HEADER);
+    chunk = curl_slist_append(chunk, content_type_header);
+    // large bodies would otherwise wait a second for 100-continue
+    chunk = curl_slist_append(chunk, "Expect:");
+
+    upload_state_t state = {
+        .fd = fd,
+        .progress = progress,
+        .user_data = user_data,
+    };
+
+    curl_easy_setopt(handle, CURLOPT_URL, url);
+    curl_easy_setopt(handle, CURLOPT_POST, 1L);
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE_LARGE, file_size);
+    curl_easy_setopt(handle, CURLOPT_READFUNCTION, upload_read_cb);
+    curl_easy_setopt(handle, CURLOPT_READDATA, &state);
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, chunk);
+    curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, header_cb);
+    curl_easy_setopt(handle, CURLOPT_HEADERDATA, response);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, cb);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, (void*)response);
+    curl_easy_setopt(handle, CURLOPT_UPLOAD_BUFFERSIZE, 512L * 1024);
+    if (progress != NULL) {
+        curl_easy_setopt(handle, CURLOPT_XFERINFOFUNCTION, transfer_progress_cb);
+        curl_easy_setopt(handle, CURLOPT_XFERINFODATA, &state);
+        curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 0L);
+    }
+
+    CURLcode res = curl_easy_perform(handle);
+    response_code_set(handle, response);
+
+    if (res != CURLE_OK) {
+        const char *err_msg = curl_easy_strerror(res);
+        response->err_msg = calloc(strlen(err_msg)+1, sizeof(char));
+        strcpy(response->err_msg, err_msg);
+    }
+
+    curl_slist_free_all(chunk);
+    curl_easy_cleanup(handle);
+
+    return response;
+}
+
+gh_client_response_t*
+gh_client_repo_release_asset_upload(const char *upload_url, const char *name,
+                                 const char *label, const char *file_path)
+{
     if (file_path == NULL) {
+        gh_client_response_t *response = gh_client_response_new();
         response->err_msg = calloc(29, sizeof(char));
         strcpy(response->err_msg, "error: file_path arg is NULL");
         return response;
     }
-    
-    FILE *fp = fopen(file_path, "rb");
-    if (fp == NULL) {
-        response->err_msg = calloc(20, sizeof(char));
+
+    int fd = open(file_path, O_RDONLY);
+    if (fd < 0) {
+        gh_client_response_t *response = gh_client_response_new();
+        response->err_msg = calloc(24, sizeof(char));
         strcpy(response->err_msg, "error: cannot read file");
         return response;
     }
-    
-    fseek(fp, 0, SEEK_END);
-    long file_size = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-    
-    char *file_data = malloc(file_size);
-    fread(file_data, 1, file_size, fp);
-    fclose(fp);
-    
-    char url[DEFAULT_URL_SIZE] = {0};
-    strncpy(url, upload_url, DEFAULT_URL_SIZE - 1);
-    
-    if (strstr(url, "?") == NULL) {
-        strcat(url, "?");
-    } else {
-        strcat(url, "&");
+
+    gh_client_response_t *response = gh_client_repo_release_asset_upload_fd(
+        upload_url, name, label, fd, NULL, NULL, NULL);
+    close(fd);
+
+    return response;
+}
+
+/**
+ * One byte range of a parallel download, written at its offset as it
+ * arrives.
+ */
+typedef struct download_range {
+    struct download_state *state;
+    CURL *easy;
+    curl_off_t pos;
+    curl_off_t end; // inclusive
+    unsigned int attempts;
+    char range[64];
+} download_range_t;
+
+typedef struct download_state {
+    int fd;
+    bool ranged;
+    curl_off_t size;
+    curl_off_t done;
+    int err; // errno of a failed write
+    gh_client_progress_cb progress;
+    void *user_data;
+    bool aborted;
+} download_state_t;
+
+static size_t
+download_write_cb(char *data, size_t size, size_t nmemb, void *userdata)
+{
+    download_range_t *range = (download_range_t*)userdata;
+    download_state_t *state = range->state;
+    size_t len = size * nmemb;
+    long code = 0;
+
+    // a server that ignores Range answers 200 with the whole file
+    curl_easy_getinfo(range->easy, CURLINFO_RESPONSE_CODE, &code);
+    if (code != (state->ranged ? 206 : 200)) {
+        return 0;
     }
-    
-    strcat(url, "name=");
-    if (name) strcat(url, name);
-    
-    if (label && strlen(label) > 0) {
-        strcat(url, "&label=");
-        strcat(url, label);
+    if (state->ranged && range->pos + (curl_off_t)len > range->end + 1) {
+        return 0;
     }
-    
-    CURL *curl = curl_easy_init();
-    if (curl == NULL) {
-        response->err_msg = calloc(30, sizeof(char));
-        strcpy(response->err_msg, "error: curl_easy_init failed");
-        free(file_data);
-        return response;
+
+    for (size_t off = 0; off < len;) {
+        ssize_t n = pwrite(state->fd, data + off, len - off, range->pos);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            state->err = errno;
+            return 0;
+        }
+        off += (size_t)n;
+        range->pos += n;
+    }
+
+    state->done += (curl_off_t)len;
+    if (state->progress != NULL &&
+        state->progress((uint64_t)state->done, (uint64_t)state->size,
+                        state->user_data) != 0) {
+        state->aborted = true;
+        return 0;
+    }
+
+    return len;
+}
+
+/**
+ * Request what is left of a range. Every range gets its own connection,
+ * separate TCP streams move a large file faster than HTTP/2 streams sharing
+ * one.
+ */
+static int
+download_range_start(CURLM *multi, download_range_t *range, const char *url,
+                     struct curl_slist *headers)
+{
+    CURL *easy = range->easy = curl_easy_init();
+    if (easy == NULL) {
+        return 1;
+    }
+
+    curl_easy_setopt(easy, CURLOPT_URL, url);
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(easy, CURLOPT_USERAGENT, "bd-gh-c-lib");
+    curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_1_1);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, download_write_cb);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, range);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, range);
+    curl_easy_setopt(easy, CURLOPT_BUFFERSIZE, 256L * 1024);
+    if (range->state->ranged) {
+        snprintf(range->range, sizeof(range->range), "%" CURL_FORMAT_CURL_OFF_T
+                 "-%" CURL_FORMAT_CURL_OFF_T, range->pos, range->end);
+        curl_easy_setopt(easy, CURLOPT_RANGE, range->range);
+    }
+    range->attempts++;
+
+    if (curl_multi_add_handle(multi, easy) != CURLM_OK) {
+        curl_easy_cleanup(easy);
+        range->easy = NULL;
+        return 1;
+    }
+
+    return 0;
+}
+
+static size_t
+probe_write_cb(char *data, size_t size, size_t nmemb, void *userdata)
+{
+    (void)data;
+    (void)userdata;
+
+    // keep the single byte of a 206, stop a 200 that carries the whole file
+    // and any error page
+    return size * nmemb <= 1 ? size * nmemb : 0;
+}
+
+/**
+ * Follow the asset URL to where the bytes are served and find their size by
+ * asking for the first byte. The API answers with a redirect to a signed
+ * URL, which is signed for GET, and the token is not sent there. Returns the
+ * HTTP code, 200 when the asset can be fetched.
+ */
+static long
+download_probe(const char *url, char *final_url, const size_t final_len,
+               curl_off_t *size, bool *ranged, char **err_msg)
+{
+    CURL *handle = curl_easy_init();
+    if (handle == NULL) {
+        return 0;
     }
 
     struct curl_slist *chunk = NULL;
+    chunk = curl_slist_append(chunk, "Accept: application/octet-stream");
     chunk = curl_slist_append(chunk, token_header);
     chunk = curl_slist_append(chunk, GH_REQ_VER_HEADER);
-    chunk = curl_slist_append(chunk, GH_REQ_DEF_UA_HEADER);
-    chunk = curl_slist_append(chunk, "Content-Type: application/octet-stream");
 
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, file_size);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, file_data);
+    long code = 0;
+    snprintf(final_url, final_len, "%s", url);
+
+    for (int hops = 0; hops < 5; hops++) {
+        curl_easy_setopt(handle, CURLOPT_URL, final_url);
+        curl_easy_setopt(handle, CURLOPT_HTTPHEADER, hops == 0 ? chunk : NULL);
+        curl_easy_setopt(handle, CURLOPT_USERAGENT, "bd-gh-c-lib");
+        curl_easy_setopt(handle, CURLOPT_RANGE, "0-0");
+        curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, probe_write_cb);
+
+        CURLcode res = curl_easy_perform(handle);
+        curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &code);
+        // bodies other than the probed byte are cut short on purpose
+        if (res != CURLE_OK && !(res == CURLE_WRITE_ERROR && code > 0)) {
+            const char *msg = curl_easy_strerror(res);
+            *err_msg = calloc(strlen(msg)+1, sizeof(char));
+            if (*err_msg != NULL) {
+                strcpy(*err_msg, msg);
+            }
+            code = 0;
+            break;
+        }
 
-    char content_length[50];
-    snprintf(content_length, sizeof(content_length), "Content-Length: %ld", file_size);
-    chunk = curl_slist_append(chunk, content_length);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, chunk);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    
-    CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
-    if (res != CURLE_OK) {
-        response->err_msg = calloc(50, sizeof(char));
-        strcpy(response->err_msg, curl_easy_strerror(res));
+        char *location = NULL;
+        curl_easy_getinfo(handle, CURLINFO_REDIRECT_URL, &location);
+        if (code >= 300 && code < 400 && location != NULL) {
+            snprintf(final_url, final_len, "%s", location);
+            continue;
+        }
+
+        struct curl_header *h = NULL;
+        if (code == 206) {
+            // Content-Range: bytes 0-0/12345
+            const char *total = NULL;
+            if (curl_easy_header(handle, "Content-Range", 0, CURLH_HEADER, -1,
+                                 &h) == CURLHE_OK) {
+                total = strchr(h->value, '/');
+            }
+            *ranged = total != NULL && total[1] != '*';
+            *size = *ranged ? (curl_off_t)strtoll(total + 1, NULL, 10) : -1;
+            code = 200;
+        } else if (code == 200) {
+            curl_easy_getinfo(handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, size);
+        } else if (code == 416) {
+            // an empty asset has no first byte
+            *size = 0;
+            code = 200;
+        }
+        break;
     }
 
-    free(file_data);
     curl_slist_free_all(chunk);
-    curl_easy_cleanup(curl);
+    curl_easy_cleanup(handle);
 
-    return response; 
+    return code;
+}
+
+gh_client_response_t*
+gh_client_release_asset_download_url(const char *url, const char *file_path,
+                                     const gh_client_download_opts_t *opts)
+{
+    gh_client_response_t *response = gh_client_response_new();
+
+    if (url == NULL || file_path == NULL) {
+        response->err_msg = calloc(36, sizeof(char));
+        strcpy(response->err_msg, "error: url or file_path arg is NULL");
+        return response;
+    }
+
+    unsigned int connections = opts != NULL && opts->connections > 0 ?
+        opts->connections : GH_CLIENT_DEFAULT_DOWNLOAD_CONNECTIONS;
+    curl_off_t chunk_size = opts != NULL && opts->chunk_size > 0 ?
+        (curl_off_t)opts->chunk_size : GH_CLIENT_DEFAULT_DOWNLOAD_CHUNK;
+
+    char final_url[DEFAULT_URL_SIZE];
+    download_state_t state = {
+        .fd = -1,
+        .size = -1,
+        .progress = opts != NULL ? opts->progress : NULL,
+        .user_data = opts != NULL ? opts->user_data : NULL,
+    };
+
+    long code = download_probe(url, final_url, sizeof(final_url), &state.size,
+                               &state.ranged, &response->err_msg);
+    response->resp_code = (uint16_t)code;
+    if (response->err_msg != NULL) {
+        return response;
+    }
+    if (code != 200) {
+        response->err_msg = calloc(35, sizeof(char));
+        strcpy(response->err_msg, "error: asset cannot be downloaded");
+        return response;
+    }
+
+    // one stream when the size is unknown, ranges are not served or the
+    // file fits one chunk
+    if (state.size < 0 || state.size <= chunk_size) {
+        state.ranged = false;
+    }
+
+    // write into file_path.part so a failed download never leaves a
+    // preallocated file with holes under the real name
+    size_t path_len = strlen(file_path);
+    char *part_path = malloc(path_len + sizeof(".part"));
+    if (part_path == NULL) {
+        response->err_msg = calloc(25, sizeof(char));
+        strcpy(response->err_msg, "error: out of memory");
+        return response;
+    }
+    memcpy(part_path, file_path, path_len);
+    strcpy(part_path + path_len, ".part");
+
+    state.fd = open(part_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (state.fd < 0) {
+        free(part_path);
+        response->err_msg = calloc(26, sizeof(char));
+        strcpy(response->err_msg, "error: cannot create file");
+        return response;
+    }
+
+    // reserve the blocks up front, the ranges land out of order
+    if (state.size > 0) {
+        int err = posix_fallocate(state.fd, 0, (off_t)state.size);
+        if (err != 0 && (err == EINVAL || err == EOPNOTSUPP)) {
+            err = ftruncate(state.fd, (off_t)state.size) == 0 ? 0 : errno;
+        }
+        if (err != 0) {
+            close(state.fd);
+            unlink(part_path);
+            free(part_path);
+            response->err_msg = calloc(strlen(strerror(err))+1, sizeof(char));
+            strcpy(response->err_msg, strerror(err));
+            return response;
+        }
+    }
+
+    unsigned int range_count = 1;
+    if (state.ranged) {
+        range_count = (unsigned int)((state.size + chunk_size - 1) / chunk_size);
+    }
+    if (connections > range_count) {
+        connections = range_count;
+    }
+
+    download_range_t *ranges = calloc(range_count, sizeof(download_range_t));
+    CURLM *multi = curl_multi_init();
+    if (ranges == NULL || multi == NULL) {
+        free(ranges);
+        curl_multi_cleanup(multi);
+        close(state.fd);
+        unlink(part_path);
+        free(part_path);
+        response->err_msg = calloc(25, sizeof(char));
+        strcpy(response->err_msg, "error: out of memory");
+        return response;
+    }
+
+    struct curl_slist *chunk = NULL;
+    chunk = curl_slist_append(chunk, "Accept: application/octet-stream");
+    if (strcmp(final_url, url) == 0) {
+        chunk = curl_slist_append(chunk, token_header);
+        chunk = curl_slist_append(chunk, GH_REQ_VER_HEADER);
+    }
+
+    for (unsigned int i = 0; i < range_count; i++) {
+        ranges[i].state = &state;
+        ranges[i].pos = (curl_off_t)i * chunk_size;
+        ranges[i].end = state.ranged && ranges[i].pos + chunk_size < state.size ?
+            ranges[i].pos + chunk_size - 1 : state.size - 1;
+    }
+
+    unsigned int next = 0;
+    unsigned int running = 0;
+    bool failed = false;
+
+    while (!failed && (next < range_count || running > 0)) {
+        while (next < range_count && running < connections) {
+            if (download_range_start(multi, &ranges[next++], final_url, chunk) != 0) {
+                failed = true;
+                break;
+            }
+            running++;
+        }
+
+        int still = 0;
+        if (curl_multi_perform(multi, &still) != CURLM_OK ||
+            curl_multi_poll(multi, NULL, 0, 1000, NULL) != CURLM_OK) {
+            failed = true;
+            break;
+        }
+
+        CURLMsg *msg;
+        int left = 0;
+        while ((msg = curl_multi_info_read(multi, &left)) != NULL) {
+            if (msg->msg != CURLMSG_DONE) {
+                continue;
+            }
+
+            CURL *easy = msg->easy_handle;
+            CURLcode result = msg->data.result;
+            download_range_t *range = NULL;
+            curl_easy_getinfo(easy, CURLINFO_PRIVATE, (char**)&range);
+            curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &code);
+            curl_multi_remove_handle(multi, easy);
+            curl_easy_cleanup(easy);
+            range->easy = NULL;
+            running--;
+
+            bool complete = result == CURLE_OK &&
+                (state.size < 0 || range->pos == range->end + 1);
+            if (complete) {
+                continue;
+            }
+
+            // a dropped connection resumes the rest of the range once
+            if (state.ranged && result != CURLE_OK &&
+                result != CURLE_WRITE_ERROR && range->attempts < 2 &&
+                download_range_start(multi, range, final_url, chunk) == 0) {
+                running++;
+                continue;
+            }
+
+            response->resp_code = (uint16_t)code;
+            if (state.err != 0) {
+                response->err_msg = calloc(strlen(strerror(state.err))+1, sizeof(char));
+                strcpy(response->err_msg, strerror(state.err));
+            } else {
+                const char *err = state.aborted ? "error: download aborted" :
+                    result != CURLE_OK ? curl_easy_strerror(result) :
+                    "error: incomplete range";
+                response->err_msg = calloc(strlen(err)+1, sizeof(char));
+                strcpy(response->err_msg, err);
+            }
+            failed = true;
+            break;
+        }
+    }
+
+    for (unsigned int i = 0; i < range_count; i++) {
+        if (ranges[i].easy != NULL) {
+            curl_multi_remove_handle(multi, ranges[i].easy);
+            curl_easy_cleanup(ranges[i].easy);
+        }
+    }
+    curl_multi_cleanup(multi);
+    curl_slist_free_all(chunk);
+    free(ranges);
+
+    if (close(state.fd) != 0 && response->err_msg == NULL) {
+        response->err_msg = calloc(strlen(strerror(errno))+1, sizeof(char));
+        strcpy(response->err_msg, strerror(errno));
+    }
+    if (response->err_msg == NULL && rename(part_path, file_path) != 0) {
+        response->err_msg = calloc(strlen(strerror(errno))+1, sizeof(char));
+        strcpy(response->err_msg, strerror(errno));
+    }
+    if (response->err_msg == NULL) {
+        response->resp_code = 200;
+    } else {
+        unlink(part_path);
+    }
+    free(part_path);
+    response->size = (size_t)state.done;
+
+    return response;
+}
+
+gh_client_response_t*
+gh_client_repo_release_asset_download(const char *owner, const char *repo,
+                                      const unsigned int id,
+                                      const char *file_path,
+                                      const gh_client_download_opts_t *opts)
+{
+    if (owner == NULL || repo == NULL) {
+        gh_client_response_t *response = gh_client_response_new();
+        response->err_msg = calloc(33, sizeof(char));
+        strcpy(response->err_msg, "error: owner or repo arg is NULL");
+        return response;
+    }
+
+    char url[DEFAULT_URL_SIZE];
+    snprintf(url, sizeof(url), GH_API_REPO_URL "%s/%s/releases/assets/%u",
+             owner, repo, id);
+
+    return gh_client_release_asset_download_url(url, file_path, opts);
 }
 
 gh_client_response_t*
@@ -637,7 +1158,7 @@ gh_client_repo_create(const char *owner, const char *repo, const char *data)
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -684,7 +1205,7 @@ gh_client_repo_update(const char *owner, const char *repo, const char *data)
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -741,7 +1262,7 @@ gh_client_repo_languages_list(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
     
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -781,7 +1302,7 @@ gh_client_repo_delete(const char *owner, const char *repo)
     curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -839,7 +1360,7 @@ gh_client_repo_releases_list(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
     
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -879,7 +1400,7 @@ gh_client_repo_releases_latest(const char *owner, const char *repo)
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -921,7 +1442,7 @@ gh_client_repo_release_by_tag(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -966,7 +1487,7 @@ gh_client_repo_release_by_id(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1015,7 +1536,7 @@ gh_client_repo_release_create(const char *owner, const char *repo,
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -1068,7 +1589,7 @@ gh_client_repo_release_update(const char *owner, const char *repo,
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -1114,7 +1635,7 @@ gh_client_repo_release_delete(const char *owner, const char *repo,
     curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -1163,7 +1684,7 @@ gh_client_repo_release_gen_notes(const char *owner, const char *repo,
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1224,7 +1745,7 @@ gh_client_repo_release_assets_list(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1270,7 +1791,7 @@ gh_client_repo_release_asset_get(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1325,7 +1846,7 @@ gh_client_repo_stargasers_list(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1410,7 +1931,7 @@ gh_client_repo_commits_list(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1469,7 +1990,7 @@ gh_client_repo_pr_commits_list(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1512,7 +2033,7 @@ gh_client_repo_commit_get(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1557,7 +2078,7 @@ gh_client_repo_commits_compare(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1612,7 +2133,7 @@ gh_client_repo_branches_list(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1654,7 +2175,7 @@ gh_client_repo_branch_get(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1705,7 +2226,7 @@ gh_client_repo_branch_rename(const char *owner, const char *repo,
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1756,7 +2277,7 @@ gh_client_repo_branch_sync_upstream(const char *owner, const char *repo,
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1805,7 +2326,7 @@ gh_client_repo_branch_merge(const char *owner, const char *repo,
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1884,7 +2405,7 @@ gh_client_repo_pull_request_list(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1939,7 +2460,7 @@ gh_client_repo_pull_request_get(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1964,7 +2485,7 @@ gh_client_user_logged_in_get()
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -1995,7 +2516,7 @@ gh_client_user_by_id_get(const char *username)
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -2027,7 +2548,7 @@ gh_client_user_by_id_hovercard_get(const char *username)
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -2065,7 +2586,7 @@ gh_client_user_blocked_list(const gh_client_req_list_opts_t *opts)
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -2096,7 +2617,7 @@ gh_client_user_blocked_by_id(const char *username)
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -2128,7 +2649,7 @@ gh_client_user_block_by_id(const char *username)
     curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT"); 
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -2160,7 +2681,7 @@ gh_client_user_unblock_by_id(const char *username)
     curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE"); 
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -2192,7 +2713,7 @@ gh_client_user_followers_list(const gh_client_req_list_opts_t *opts)
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -2216,7 +2737,7 @@ gh_client_user_rate_limit_info()
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -2263,7 +2784,7 @@ gh_client_user_stars_list(const char *user,
     SET_BASIC_CURL_CONFIG;
     
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -2310,7 +2831,7 @@ gh_client_user_repositories_list(const char *user,
     SET_BASIC_CURL_CONFIG;
     
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -2395,7 +2916,7 @@ gh_client_issues_for_user_list(const gh_client_issues_req_opts_t *opts)
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -2512,7 +3033,7 @@ gh_client_issues_by_repo_list(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -2560,7 +3081,7 @@ gh_client_issue_create(const char *owner, const char *repo, const char *data)
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -2605,7 +3126,7 @@ gh_client_issue_get(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -2658,7 +3179,7 @@ gh_client_issue_update(const char *owner, const char *repo,
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -2712,7 +3233,7 @@ gh_client_issue_lock(const char *owner, const char *repo,
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -2759,7 +3280,7 @@ gh_client_issue_unlock(const char *owner, const char *repo,
     curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -2809,7 +3330,7 @@ gh_client_events_by_org_list(const char *owner,
     SET_BASIC_CURL_CONFIG;
     
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -2857,7 +3378,7 @@ gh_client_events_by_user_list(const char *user,
     SET_BASIC_CURL_CONFIG;
     
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
     CURL_CALL_ERROR_CHECK;
 
     curl_slist_free_all(chunk);
@@ -2889,7 +3410,7 @@ gh_client_actions_billing_by_org(const char *org)
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -2929,7 +3450,7 @@ gh_client_metrics_community_profile(const char *owner, const char *repo)
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -2982,7 +3503,7 @@ gh_client_metrics_repository_clones(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -3022,7 +3543,7 @@ gh_client_metrics_top_referral_paths(const char *owner, const char *repo)
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -3062,7 +3583,7 @@ gh_client_metrics_top_referral_sources(const char *owner, const char *repo)
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -3115,7 +3636,7 @@ gh_client_metrics_page_views(const char *owner, const char *repo,
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -3139,7 +3660,7 @@ gh_client_codes_of_conduct_list()
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -3170,7 +3691,7 @@ gh_client_code_of_conduct_get_by_key(const char *key)
     SET_BASIC_CURL_CONFIG;
 
     CURLcode res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->resp_code);
+    response_code_set(curl, response);
 
     CURL_CALL_ERROR_CHECK;
     curl_slist_free_all(chunk);
@@ -3184,3 +3705,2716 @@ gh_client_free()
     curl_easy_cleanup(curl);
     curl_global_cleanup();
 }
+
+/**
+ * A call submitted to a client context. The struct and the copies of the
+ * method, URL and request body live in one allocation.
+ */
+typedef struct gh_client_call {
+    gh_client_t *client;
+    CURL *easy;
+    gh_client_response_t *response;
+    gh_client_call_cb cb;
+    void *user_data;
+    char *method;
+    char *url;
+    char *data;
+
+    // per-call header list when the call is conditional, and the cached
+    // copy its validators came from, pinned until the call finishes
+    struct curl_slist *headers;
+    struct gh_client_cache_entry *cached;
+    bool conditional;
+    bool unconditional;
+
+    // validators and back-off taken from the response headers
+    char etag[GH_CLIENT_VALIDATOR_LEN];
+    char last_modified[GH_CLIENT_VALIDATOR_LEN];
+    uint64_t retry_after;
+
+    // links in the queue, or in the in-flight list once started
+    struct gh_client_call *prev;
+    struct gh_client_call *next;
+} gh_client_call_t;
+
+/**
+ * A cached GET response, keyed by URL. The strings and the body live in one
+ * allocation after the struct.
+ */
+typedef struct gh_client_cache_entry {
+    uint64_t hash;
+    char *url;
+    char *etag;
+    char *last_modified;
+    char *body;
+    size_t size;
+
+    struct gh_client_cache_entry *chain;
+
+    // calls waiting on the entry for a 304. A pinned entry that is evicted
+    // is only detached, the last call to unpin it frees it.
+    unsigned int pins;
+    bool detached;
+
+    // least recently used order, the head is the most recent
+    struct gh_client_cache_entry *prev;
+    struct gh_client_cache_entry *next;
+} gh_client_cache_entry_t;
+
+typedef struct {
+    gh_client_cache_entry_t **buckets;
+    unsigned int bucket_mask;
+    unsigned int count;
+    unsigned int max_entries;
+    gh_client_cache_entry_t *head;
+    gh_client_cache_entry_t *tail;
+    char *dir;
+    gh_client_cache_stats_t stats;
+} gh_client_cache_t;
+
+struct gh_client {
+    CURLM *multi;
+    struct curl_slist *headers;
+    char base_url[GH_MAX_URL_LEN];
+
+    // derived from base_url unless set with gh_client_set_graphql_url
+    char graphql_url[GH_MAX_URL_LEN];
+    bool graphql_url_set;
+
+    // idle easy handles, reset and kept so connections and TLS sessions
+    // stay warm between calls
+    CURL **idle;
+    unsigned int idle_count;
+
+    unsigned int max_handles;
+    unsigned int active;
+    gh_client_call_t *in_flight;
+
+    // calls waiting for a free handle, in submission order
+    gh_client_call_t *queue_head;
+    gh_client_call_t *queue_tail;
+
+    // running gh_client_paginate listings
+    struct gh_client_pager *pagers;
+
+    // conditional request cache, NULL until gh_client_cache_enable
+    gh_client_cache_t *cache;
+
+    // rate limit pacing. rate_reset is 0 while the budget is unknown. Times
+    // are wall clock milliseconds since X-RateLimit-Reset is epoch based.
+    uint64_t rate_reserve;
+    uint64_t rate_burst;
+    uint64_t rate_remaining;
+    uint64_t rate_reset;
+    uint64_t next_start_ms;
+    uint64_t hold_until_ms;
+};
+
+gh_client_t*
+gh_client_new(const char *token, const unsigned int max_handles)
+{
+    if (token == NULL) {
+        return NULL;
+    }
+
+    gh_client_t *client = calloc(1, sizeof(gh_client_t));
+    if (client == NULL) {
+        return NULL;
+    }
+
+    client->max_handles = max_handles > 0 ? max_handles :
+        GH_CLIENT_DEFAULT_MAX_HANDLES;
+    client->rate_burst = GH_CLIENT_DEFAULT_RATE_BURST;
+    client->idle = calloc(client->max_handles, sizeof(CURL*));
+    client->multi = curl_multi_init();
+    if (client->idle == NULL || client->multi == NULL) {
+        gh_client_destroy(client);
+        return NULL;
+    }
+    strcpy(client->base_url, GH_API_BASE_URL);
+    strcpy(client->graphql_url, GH_API_GRAPHQL_URL);
+
+    // calls to the same host share one HTTP/2 connection when possible
+    curl_multi_setopt(client->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+    char auth[TOKEN_HEADER_SIZE + 32];
+    snprintf(auth, sizeof(auth), "Authorization: Bearer %s", token);
+
+    client->headers = curl_slist_append(client->headers, GH_REQ_JSON_HEADER);
+    client->headers = curl_slist_append(client->headers, auth);
+    client->headers = curl_slist_append(client->headers, GH_REQ_VER_HEADER);
+    client->headers = curl_slist_append(client->headers, GH_REQ_DEF_UA_HEADER);
+
+    return client;
+}
+
+int
+gh_client_set_base_url(gh_client_t *client, const char *base_url)
+{
+    if (client == NULL || base_url == NULL ||
+        strlen(base_url) >= sizeof(client->base_url)) {
+        return 1;
+    }
+
+    strcpy(client->base_url, base_url);
+
+    size_t len = strlen(client->base_url);
+    if (len > 0 && client->base_url[len-1] == '/') {
+        client->base_url[--len] = '\0';
+    }
+
+    // Enterprise Server serves REST under /api/v3 and GraphQL at
+    // /api/graphql
+    if (!client->graphql_url_set) {
+        if (len >= 3 && strcmp(client->base_url + len - 3, "/v3") == 0) {
+            len -= 3;
+        }
+        if (len + sizeof("/graphql") > sizeof(client->graphql_url)) {
+            return 1;
+        }
+        memcpy(client->graphql_url, client->base_url, len);
+        strcpy(client->graphql_url + len, "/graphql");
+    }
+
+    return 0;
+}
+
+int
+gh_client_set_graphql_url(gh_client_t *client, const char *graphql_url)
+{
+    if (client == NULL || graphql_url == NULL ||
+        strlen(graphql_url) >= sizeof(client->graphql_url)) {
+        return 1;
+    }
+
+    strcpy(client->graphql_url, graphql_url);
+    client->graphql_url_set = true;
+
+    return 0;
+}
+
+static uint64_t
+now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/**
+ * FNV-1a, used for the cache buckets and the cache file names.
+ */
+static uint64_t
+cache_hash(const char *str)
+{
+    uint64_t h = 14695981039346656037ULL;
+
+    for (; *str; str++) {
+        h ^= (unsigned char)*str;
+        h *= 1099511628211ULL;
+    }
+
+    return h;
+}
+
+static void
+cache_unlink(gh_client_cache_t *cache, gh_client_cache_entry_t *entry)
+{
+    if (entry->prev != NULL) {
+        entry->prev->next = entry->next;
+    } else {
+        cache->head = entry->next;
+    }
+    if (entry->next != NULL) {
+        entry->next->prev = entry->prev;
+    } else {
+        cache->tail = entry->prev;
+    }
+    entry->prev = entry->next = NULL;
+}
+
+static void
+cache_push_front(gh_client_cache_t *cache, gh_client_cache_entry_t *entry)
+{
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head != NULL) {
+        cache->head->prev = entry;
+    } else {
+        cache->tail = entry;
+    }
+    cache->head = entry;
+}
+
+static void
+cache_remove(gh_client_cache_t *cache, gh_client_cache_entry_t *entry)
+{
+    gh_client_cache_entry_t **pp = &cache->buckets[entry->hash & cache->bucket_mask];
+
+    while (*pp != entry) {
+        pp = &(*pp)->chain;
+    }
+    *pp = entry->chain;
+
+    cache_unlink(cache, entry);
+    cache->count--;
+    if (entry->pins > 0) {
+        entry->detached = true;
+        return;
+    }
+    free(entry);
+}
+
+static void
+cache_unpin(gh_client_cache_entry_t *entry)
+{
+    if (--entry->pins == 0 && entry->detached) {
+        free(entry);
+    }
+}
+
+static gh_client_cache_entry_t*
+cache_insert(gh_client_cache_t *cache, const char *url, const char *etag,
+             const char *last_modified, const char *body, const size_t size)
+{
+    uint64_t hash = cache_hash(url);
+    size_t url_len = strlen(url) + 1;
+    size_t etag_len = strlen(etag) + 1;
+    size_t lm_len = strlen(last_modified) + 1;
+
+    gh_client_cache_entry_t *entry = calloc(1, sizeof(gh_client_cache_entry_t) +
+                                            url_len + etag_len + lm_len +
+                                            size + 1);
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    entry->hash = hash;
+    entry->url = (char*)(entry + 1);
+    entry->etag = entry->url + url_len;
+    entry->last_modified = entry->etag + etag_len;
+    entry->body = entry->last_modified + lm_len;
+    entry->size = size;
+    memcpy(entry->url, url, url_len);
+    memcpy(entry->etag, etag, etag_len);
+    memcpy(entry->last_modified, last_modified, lm_len);
+    memcpy(entry->body, body, size);
+
+    // replace an older copy of the same URL
+    gh_client_cache_entry_t *old = cache->buckets[hash & cache->bucket_mask];
+    for (; old != NULL; old = old->chain) {
+        if (old->hash == hash && strcmp(old->url, url) == 0) {
+            cache_remove(cache, old);
+            break;
+        }
+    }
+
+    while (cache->count >= cache->max_entries && cache->tail != NULL) {
+        cache_remove(cache, cache->tail);
+    }
+
+    entry->chain = cache->buckets[hash & cache->bucket_mask];
+    cache->buckets[hash & cache->bucket_mask] = entry;
+    cache_push_front(cache, entry);
+    cache->count++;
+
+    return entry;
+}
+
+/**
+ * Cache files hold the URL, the ETag and the Last-Modified value on one line
+ * each, followed by the body.
+ */
+static void
+cache_path(const gh_client_cache_t *cache, const uint64_t hash, char *path,
+           const size_t len)
+{
+    snprintf(path, len, "%s/%016llx", cache->dir, (unsigned long long)hash);
+}
+
+static void
+cache_disk_store(const gh_client_cache_t *cache,
+                 const gh_client_cache_entry_t *entry)
+{
+    char path[DEFAULT_URL_SIZE];
+    char tmp[DEFAULT_URL_SIZE + 8];
+
+    cache_path(cache, entry->hash, path, sizeof(path));
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    FILE *f = fopen(tmp, "wb");
+    if (f == NULL) {
+        return;
+    }
+
+    fprintf(f, "%s\n%s\n%s\n", entry->url, entry->etag, entry->last_modified);
+    size_t written = fwrite(entry->body, 1, entry->size, f);
+    if (fclose(f) != 0 || written != entry->size || rename(tmp, path) != 0) {
+        remove(tmp);
+    }
+}
+
+static gh_client_cache_entry_t*
+cache_disk_load(gh_client_cache_t *cache, const char *url, const uint64_t hash)
+{
+    char path[DEFAULT_URL_SIZE];
+    cache_path(cache, hash, path, sizeof(path));
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+
+    gh_client_cache_entry_t *entry = NULL;
+    char *data = NULL;
+    long len;
+
+    if (fseek(f, 0, SEEK_END) != 0 || (len = ftell(f)) <= 0 ||
+        fseek(f, 0, SEEK_SET) != 0) {
+        goto DONE;
+    }
+    data = malloc((size_t)len + 1);
+    if (data == NULL || fread(data, 1, (size_t)len, f) != (size_t)len) {
+        goto DONE;
+    }
+    data[len] = '\0';
+
+    char *lines[3];
+    char *p = data;
+    for (int i = 0; i < 3; i++) {
+        char *nl = memchr(p, '\n', (size_t)(data + len - p));
+        if (nl == NULL) {
+            goto DONE;
+        }
+        *nl = '\0';
+        lines[i] = p;
+        p = nl + 1;
+    }
+
+    // a different URL with the same hash
+    if (strcmp(lines[0], url) == 0) {
+        entry = cache_insert(cache, url, lines[1], lines[2], p,
+                             (size_t)(data + len - p));
+    }
+
+DONE:
+    free(data);
+    fclose(f);
+
+    return entry;
+}
+
+static gh_client_cache_entry_t*
+cache_lookup(gh_client_cache_t *cache, const char *url)
+{
+    uint64_t hash = cache_hash(url);
+    gh_client_cache_entry_t *entry = cache->buckets[hash & cache->bucket_mask];
+
+    for (; entry != NULL; entry = entry->chain) {
+        if (entry->hash == hash && strcmp(entry->url, url) == 0) {
+            cache_unlink(cache, entry);
+            cache_push_front(cache, entry);
+            return entry;
+        }
+    }
+
+    if (cache->dir != NULL) {
+        return cache_disk_load(cache, url, hash);
+    }
+
+    return NULL;
+}
+
+static void
+cache_free(gh_client_cache_t *cache)
+{
+    if (cache == NULL) {
+        return;
+    }
+
+    while (cache->head != NULL) {
+        gh_client_cache_entry_t *entry = cache->head;
+        cache->head = entry->next;
+        free(entry);
+    }
+    free(cache->buckets);
+    free(cache->dir);
+    free(cache);
+}
+
+int
+gh_client_cache_enable(gh_client_t *client, const unsigned int max_entries,
+                       const char *dir)
+{
+    if (client == NULL || client->cache != NULL) {
+        return 1;
+    }
+
+    gh_client_cache_t *cache = calloc(1, sizeof(gh_client_cache_t));
+    if (cache == NULL) {
+        return 1;
+    }
+
+    cache->max_entries = max_entries > 0 ? max_entries :
+        GH_CLIENT_DEFAULT_CACHE_ENTRIES;
+
+    unsigned int buckets = 16;
+    while (buckets < cache->max_entries) {
+        buckets <<= 1;
+    }
+    cache->bucket_mask = buckets - 1;
+    cache->buckets = calloc(buckets, sizeof(gh_client_cache_entry_t*));
+
+    if (dir != NULL) {
+        cache->dir = calloc(strlen(dir)+1, sizeof(char));
+        if (cache->dir != NULL) {
+            strcpy(cache->dir, dir);
+        }
+    }
+
+    if (cache->buckets == NULL || (dir != NULL && cache->dir == NULL)) {
+        cache_free(cache);
+        return 1;
+    }
+    client->cache = cache;
+
+    return 0;
+}
+
+int
+gh_client_cache_stats(const gh_client_t *client, gh_client_cache_stats_t *stats)
+{
+    if (client == NULL || client->cache == NULL || stats == NULL) {
+        return 1;
+    }
+
+    *stats = client->cache->stats;
+    stats->entries = client->cache->count;
+
+    return 0;
+}
+
+void
+gh_client_set_rate_reserve(gh_client_t *client, const uint64_t reserve,
+                           const uint64_t burst)
+{
+    if (client == NULL) {
+        return;
+    }
+
+    client->rate_reserve = reserve;
+    client->rate_burst = burst;
+}
+
+/**
+ * Milliseconds until the next queued call may start. Calls start freely
+ * while more than rate_burst calls are left above the reserve. Below that
+ * the remaining calls are spread evenly until the reset, and once the
+ * reserve is reached nothing starts before the reset.
+ */
+static uint64_t
+client_rate_wait_ms(gh_client_t *client, const uint64_t now)
+{
+    if (now < client->hold_until_ms) {
+        return client->hold_until_ms - now;
+    }
+    if (client->rate_reset == 0) {
+        return 0;
+    }
+
+    uint64_t reset_ms = client->rate_reset * 1000;
+    if (now >= reset_ms) {
+        // a new window, the next response tells the new budget
+        client->rate_reset = 0;
+        return 0;
+    }
+
+    uint64_t left = client->rate_remaining > client->rate_reserve ?
+        client->rate_remaining - client->rate_reserve : 0;
+    if (left == 0) {
+        return reset_ms - now;
+    }
+    if (left > client->rate_burst) {
+        return 0;
+    }
+    if (now < client->next_start_ms) {
+        return client->next_start_ms - now;
+    }
+
+    client->next_start_ms = now + (reset_ms - now) / left;
+
+    return 0;
+}
+
+/**
+ * Update the budget from a finished call. Calls still in flight will count
+ * against what the response reports.
+ */
+static void
+client_rate_update(gh_client_t *client, const gh_client_call_t *call)
+{
+    const gh_client_rate_limit_data_t *rl = call->response->rate_limit_data;
+    uint16_t code = call->response->resp_code;
+
+    // search and the other resources have budgets of their own
+    const char *resource = rl != NULL ? rl->resource : NULL;
+    while (resource != NULL && *resource == ' ') {
+        resource++;
+    }
+
+    if (rl != NULL && rl->limit > 0 && rl->reset >= client->rate_reset &&
+        (resource == NULL || strcmp(resource, "core") == 0)) {
+        uint64_t remaining = rl->remaining > client->active ?
+            rl->remaining - client->active : 0;
+
+        if (rl->reset > client->rate_reset || remaining < client->rate_remaining) {
+            client->rate_remaining = remaining;
+        }
+        client->rate_reset = rl->reset;
+    }
+
+    // secondary rate limits answer 403 or 429 with Retry-After
+    if ((code == 403 || code == 429) && call->retry_after > 0) {
+        uint64_t until = now_ms() + call->retry_after * 1000;
+        if (until > client->hold_until_ms) {
+            client->hold_until_ms = until;
+        }
+    }
+}
+
+/**
+ * Header callback of context calls. Picks up the cache validators and
+ * Retry-After, then hands the line to header_cb.
+ */
+static size_t
+client_header_cb(char *buffer, size_t size, size_t nmemb, void *userdata)
+{
+    gh_client_call_t *call = (gh_client_call_t*)userdata;
+    size_t total_size = size * nmemb;
+    char *dst = NULL;
+    size_t name_len = 0;
+
+    if (total_size > 5 && strncasecmp(buffer, "etag:", 5) == 0) {
+        dst = call->etag;
+        name_len = 5;
+    } else if (total_size > 14 && strncasecmp(buffer, "last-modified:", 14) == 0) {
+        dst = call->last_modified;
+        name_len = 14;
+    } else if (total_size > 12 && strncasecmp(buffer, "retry-after:", 12) == 0) {
+        char value[32] = {0};
+        size_t len = total_size - 12 < sizeof(value) - 1 ? total_size - 12 :
+            sizeof(value) - 1;
+        memcpy(value, buffer + 12, len);
+        call->retry_after = strtoull(value, NULL, 10);
+    }
+
+    if (dst != NULL) {
+        const char *v = buffer + name_len;
+        const char *end = buffer + total_size;
+        while (v < end && (*v == ' ' || *v == '\t')) {
+            v++;
+        }
+        while (end > v && (end[-1] == '\r' || end[-1] == '\n' || end[-1] == ' ')) {
+            end--;
+        }
+        if ((size_t)(end - v) < GH_CLIENT_VALIDATOR_LEN) {
+            memcpy(dst, v, (size_t)(end - v));
+            dst[end - v] = '\0';
+        }
+    }
+
+    return header_cb(buffer, size, nmemb, call->response);
+}
+
+static void
+client_call_set_error(gh_client_call_t *call, const char *msg)
+{
+    call->response->err_msg = calloc(strlen(msg)+1, sizeof(char));
+    if (call->response->err_msg != NULL) {
+        strcpy(call->response->err_msg, msg);
+    }
+}
+
+/**
+ * Make a GET conditional on the cached copy of its URL. The copy is pinned
+ * so eviction while the call is in flight cannot take the body a 304
+ * refers to.
+ */
+static void
+client_call_conditional(gh_client_call_t *call)
+{
+    gh_client_t *client = call->client;
+
+    if (client->cache == NULL || call->data != NULL ||
+        strcmp(call->method, "GET") != 0) {
+        return;
+    }
+    call->conditional = true;
+    if (call->unconditional) {
+        return;
+    }
+
+    gh_client_cache_entry_t *entry = cache_lookup(client->cache, call->url);
+    if (entry == NULL) {
+        return;
+    }
+
+    char line[GH_CLIENT_VALIDATOR_LEN + 32];
+    struct curl_slist *headers = NULL;
+
+    if (entry->etag[0] != '\0') {
+        snprintf(line, sizeof(line), "If-None-Match: %s", entry->etag);
+        headers = curl_slist_append(headers, line);
+    } else if (entry->last_modified[0] != '\0') {
+        snprintf(line, sizeof(line), "If-Modified-Since: %s", entry->last_modified);
+        headers = curl_slist_append(headers, line);
+    }
+    for (struct curl_slist *h = client->headers; h != NULL && headers != NULL; h = h->next) {
+        if (curl_slist_append(headers, h->data) == NULL) {
+            curl_slist_free_all(headers);
+            headers = NULL;
+        }
+    }
+
+    call->headers = headers;
+    if (headers != NULL) {
+        call->cached = entry;
+        entry->pins++;
+    }
+}
+
+/**
+ * Answer a 304 from the cache and store fresh responses that carry a
+ * validator. Returns true when a 304 has no cached copy to answer from and
+ * the call has to be sent again without validators.
+ */
+static bool
+client_cache_complete(gh_client_call_t *call)
+{
+    gh_client_cache_t *cache = call->client->cache;
+    gh_client_response_t *response = call->response;
+
+    if (cache == NULL || !call->conditional || response->err_msg != NULL) {
+        return false;
+    }
+
+    if (response->resp_code == 304) {
+        gh_client_cache_entry_t *entry = call->cached;
+        if (entry == NULL) {
+            return !call->unconditional;
+        }
+
+        char *body = calloc(entry->size + 1, sizeof(char));
+        if (body == NULL) {
+            client_call_set_error(call, "error: unable to allocate cached body");
+            return false;
+        }
+        memcpy(body, entry->body, entry->size);
+        free(response->resp);
+        response->resp = body;
+        response->size = entry->size;
+        response->resp_code = 200;
+        cache->stats.hits++;
+        return false;
+    }
+
+    if (response->resp_code != 200) {
+        return false;
+    }
+    cache->stats.misses++;
+
+    if (call->etag[0] == '\0' && call->last_modified[0] == '\0') {
+        return false;
+    }
+
+    gh_client_cache_entry_t *entry = cache_insert(cache, call->url, call->etag,
+                                                  call->last_modified,
+                                                  response->resp != NULL ? response->resp : "",
+                                                  response->size);
+    if (entry != NULL) {
+        cache->stats.stores++;
+        if (cache->dir != NULL) {
+            cache_disk_store(cache, entry);
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Get an easy handle from the pool or create a new one.
+ */
+static CURL*
+client_handle_get(gh_client_t *client)
+{
+    if (client->idle_count > 0) {
+        return client->idle[--client->idle_count];
+    }
+
+    return curl_easy_init();
+}
+
+/**
+ * Return an easy handle to the pool. curl_easy_reset keeps the connection
+ * cache, TLS session ids and DNS entries of the handle.
+ */
+static void
+client_handle_put(gh_client_t *client, CURL *easy)
+{
+    if (client->idle_count < client->max_handles) {
+        curl_easy_reset(easy);
+        client->idle[client->idle_count++] = easy;
+        return;
+    }
+
+    curl_easy_cleanup(easy);
+}
+
+/**
+ * Hand the response to the callback and free the call. The callback owns
+ * the response.
+ */
+static void
+client_call_finish(gh_client_call_t *call)
+{
+    if (call->cb != NULL) {
+        call->cb(call->response, call->user_data);
+    } else {
+        gh_client_response_free(call->response);
+    }
+
+    curl_slist_free_all(call->headers);
+    if (call->cached != NULL) {
+        cache_unpin(call->cached);
+    }
+    free(call);
+}
+
+/**
+ * Configure a pooled handle for the call and add it to the multi handle.
+ */
+static int
+client_call_start(gh_client_call_t *call)
+{
+    gh_client_t *client = call->client;
+
+    call->easy = client_handle_get(client);
+    if (call->easy == NULL) {
+        return 1;
+    }
+
+    client_call_conditional(call);
+
+    CURL *easy = call->easy;
+    curl_easy_setopt(easy, CURLOPT_URL, call->url);
+    curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER,
+                     call->headers != NULL ? call->headers : client->headers);
+    curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, client_header_cb);
+    curl_easy_setopt(easy, CURLOPT_HEADERDATA, call);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, cb);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, (void*)call->response);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, call);
+    curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+
+    if (call->data != NULL) {
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, (long)strlen(call->data));
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDS, call->data);
+    }
+    if (strcmp(call->method, "GET") != 0 &&
+        (call->data == NULL || strcmp(call->method, "POST") != 0)) {
+        curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, call->method);
+    }
+
+    if (curl_multi_add_handle(client->multi, easy) != CURLM_OK) {
+        client_handle_put(client, easy);
+        call->easy = NULL;
+        return 1;
+    }
+    client->active++;
+
+    call->prev = NULL;
+    call->next = client->in_flight;
+    if (client->in_flight != NULL) {
+        client->in_flight->prev = call;
+    }
+    client->in_flight = call;
+
+    return 0;
+}
+
+/**
+ * Send a finished call again as a plain GET, dropping what the first
+ * attempt received.
+ */
+static int
+client_call_restart(gh_client_call_t *call)
+{
+    gh_client_response_t *response = call->response;
+
+    free(response->resp);
+    response->resp = NULL;
+    response->size = 0;
+    response->resp_code = 0;
+    response->first_link[0] = response->next_link[0] = '\0';
+    response->prev_link[0] = response->last_link[0] = '\0';
+
+    curl_slist_free_all(call->headers);
+    call->headers = NULL;
+    call->etag[0] = call->last_modified[0] = '\0';
+    call->retry_after = 0;
+    call->unconditional = true;
+
+    if (client_call_start(call) != 0) {
+        client_call_set_error(call, "error: cannot start call");
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Start queued calls while there are free handles.
+ */
+static void
+client_start_queued(gh_client_t *client)
+{
+    while (client->queue_head != NULL && client->active < client->max_handles) {
+        if (client_rate_wait_ms(client, now_ms()) > 0) {
+            break;
+        }
+
+        gh_client_call_t *call = client->queue_head;
+
+        client->queue_head = call->next;
+        if (client->queue_head == NULL) {
+            client->queue_tail = NULL;
+        }
+        call->next = NULL;
+
+        if (client_call_start(call) != 0) {
+            client_call_set_error(call, "error: cannot start call");
+            client_call_finish(call);
+        } else if (client->rate_remaining > 0) {
+            client->rate_remaining--;
+        }
+    }
+}
+
+/**
+ * Collect the finished transfers and run their callbacks.
+ */
+static void
+client_read_done(gh_client_t *client)
+{
+    CURLMsg *msg;
+    int left = 0;
+
+    while ((msg = curl_multi_info_read(client->multi, &left)) != NULL) {
+        if (msg->msg != CURLMSG_DONE) {
+            continue;
+        }
+
+        CURL *easy = msg->easy_handle;
+        CURLcode res = msg->data.result;
+        gh_client_call_t *call = NULL;
+        long code = 0;
+
+        curl_easy_getinfo(easy, CURLINFO_PRIVATE, (char**)&call);
+        curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &code);
+        curl_multi_remove_handle(client->multi, easy);
+        client_handle_put(client, easy);
+        client->active--;
+
+        if (call->prev != NULL) {
+            call->prev->next = call->next;
+        } else {
+            client->in_flight = call->next;
+        }
+        if (call->next != NULL) {
+            call->next->prev = call->prev;
+        }
+
+        call->easy = NULL;
+        call->response->resp_code = (uint16_t)code;
+        if (res != CURLE_OK) {
+            client_call_set_error(call, curl_easy_strerror(res));
+            free(call->response->resp);
+            call->response->resp = NULL;
+            call->response->size = 0;
+        }
+
+        client_rate_update(client, call);
+        if (client_cache_complete(call) && client_call_restart(call) == 0) {
+            continue;
+        }
+        client_call_finish(call);
+    }
+}
+
+int
+gh_client_submit(gh_client_t *client, const char *method, const char *url,
+                 const char *data, gh_client_call_cb cb, void *user_data)
+{
+    if (client == NULL || url == NULL) {
+        return 1;
+    }
+    if (method == NULL) {
+        method = data != NULL ? "POST" : "GET";
+    }
+
+    // relative paths are resolved against the base URL
+    const char *base = url[0] == '/' ? client->base_url : "";
+    size_t method_len = strlen(method) + 1;
+    size_t url_len = strlen(base) + strlen(url) + 1;
+    size_t data_len = data != NULL ? strlen(data) + 1 : 0;
+
+    if (url_len > GH_MAX_URL_LEN) {
+        return 1;
+    }
+
+    gh_client_call_t *call = calloc(1, sizeof(gh_client_call_t) + method_len +
+                                    url_len + data_len);
+    if (call == NULL) {
+        return 1;
+    }
+    call->response = gh_client_response_new();
+    if (call->response == NULL || call->response->rate_limit_data == NULL) {
+        gh_client_response_free(call->response);
+        free(call);
+        return 1;
+    }
+
+    call->client = client;
+    call->cb = cb;
+    call->user_data = user_data;
+    call->method = (char*)(call + 1);
+    call->url = call->method + method_len;
+    memcpy(call->method, method, method_len);
+    strcpy(call->url, base);
+    strcat(call->url, url);
+    if (data != NULL) {
+        call->data = call->url + url_len;
+        memcpy(call->data, data, data_len);
+    }
+
+    if (client->queue_tail != NULL) {
+        client->queue_tail->next = call;
+    } else {
+        client->queue_head = call;
+    }
+    client->queue_tail = call;
+
+    return 0;
+}
+
+int
+gh_client_run(gh_client_t *client, const int timeout_ms)
+{
+    if (client == NULL) {
+        return -1;
+    }
+
+    int running = 0;
+
+    client_start_queued(client);
+    if (curl_multi_perform(client->multi, &running) != CURLM_OK) {
+        return -1;
+    }
+    client_read_done(client);
+
+    // callbacks may have submitted more calls
+    client_start_queued(client);
+
+    // wait for network activity, or for the rate limit to let the next
+    // queued call go
+    int wait_ms = timeout_ms;
+    if (client->queue_head != NULL && client->active < client->max_handles) {
+        uint64_t rate_wait = client_rate_wait_ms(client, now_ms());
+        if (rate_wait < (uint64_t)wait_ms) {
+            wait_ms = (int)rate_wait;
+        }
+    }
+
+    if (client->active > 0 || client->queue_head != NULL) {
+        if (curl_multi_poll(client->multi, NULL, 0, wait_ms, NULL) != CURLM_OK) {
+            return -1;
+        }
+        if (curl_multi_perform(client->multi, &running) != CURLM_OK) {
+            return -1;
+        }
+        client_read_done(client);
+    }
+
+    unsigned int pending = client->active;
+    for (gh_client_call_t *call = client->queue_head; call != NULL; call = call->next) {
+        pending++;
+    }
+
+    return (int)pending;
+}
+
+int
+gh_client_perform(gh_client_t *client)
+{
+    int pending;
+
+    while ((pending = gh_client_run(client, 1000)) > 0) {
+        ;
+    }
+
+    return pending < 0 ? 1 : 0;
+}
+
+int
+gh_client_repo_get_async(gh_client_t *client, const char *owner,
+                         const char *repo, gh_client_call_cb cb,
+                         void *user_data)
+{
+    if (owner == NULL || repo == NULL) {
+        return 1;
+    }
+
+    char path[DEFAULT_URL_SIZE];
+    snprintf(path, sizeof(path), "/repos/%s/%s", owner, repo);
+
+    return gh_client_submit(client, "GET", path, NULL, cb, user_data);
+}
+
+int
+gh_client_repo_releases_latest_async(gh_client_t *client, const char *owner,
+                                     const char *repo, gh_client_call_cb cb,
+                                     void *user_data)
+{
+    if (owner == NULL || repo == NULL) {
+        return 1;
+    }
+
+    char path[DEFAULT_URL_SIZE];
+    snprintf(path, sizeof(path), "/repos/%s/%s/releases/latest", owner, repo);
+
+    return gh_client_submit(client, "GET", path, NULL, cb, user_data);
+}
+
+int
+gh_client_repo_release_by_tag_async(gh_client_t *client, const char *owner,
+                                    const char *repo, const char *tag,
+                                    gh_client_call_cb cb, void *user_data)
+{
+    if (owner == NULL || repo == NULL || tag == NULL) {
+        return 1;
+    }
+
+    char path[DEFAULT_URL_SIZE];
+    snprintf(path, sizeof(path), "/repos/%s/%s/releases/tags/%s", owner, repo,
+             tag);
+
+    return gh_client_submit(client, "GET", path, NULL, cb, user_data);
+}
+
+int
+gh_client_issue_get_async(gh_client_t *client, const char *owner,
+                          const char *repo, const unsigned int id,
+                          gh_client_call_cb cb, void *user_data)
+{
+    if (owner == NULL || repo == NULL) {
+        return 1;
+    }
+
+    char path[DEFAULT_URL_SIZE];
+    snprintf(path, sizeof(path), "/repos/%s/%s/issues/%u", owner, repo, id);
+
+    return gh_client_submit(client, "GET", path, NULL, cb, user_data);
+}
+
+typedef struct gh_client_pager gh_client_pager_t;
+
+/**
+ * Callback argument of a page call. A pager has at most window pages in
+ * flight or held, so page % window names a free slot.
+ */
+typedef struct {
+    gh_client_pager_t *pager;
+    unsigned int page;
+} gh_client_page_tag_t;
+
+struct gh_client_pager {
+    gh_client_t *client;
+    gh_client_item_cb item_cb;
+    gh_client_pages_done_cb done_cb;
+    void *user_data;
+
+    unsigned int window;
+    unsigned int max_pages;
+    uint64_t rate_reserve;
+
+    // last_link of the first page, page N is fetched by replacing the page
+    // number in it. last_page is 0 until it is known.
+    char page_url[GH_MAX_URL_LEN];
+    size_t page_at;
+    size_t page_end;
+    unsigned int last_page;
+
+    // next_link of the last delivered page when the listing has no last link
+    char next_url[GH_MAX_URL_LEN];
+
+    unsigned int next_submit;
+    unsigned int next_deliver;
+    unsigned int in_flight;
+    bool stop;
+
+    // pages that arrived before the ones in front of them
+    gh_client_response_t **held;
+    gh_client_page_tag_t *tags;
+
+    gh_client_pages_result_t result;
+    char *err_msg;
+
+    gh_client_pager_t *prev;
+    gh_client_pager_t *next;
+};
+
+/**
+ * Find the end of the JSON value starting at p. Returns a pointer to the ','
+ * or ']' that follows it in the enclosing array, or end.
+ */
+static char*
+json_value_end(char *p, const char *end)
+{
+    unsigned int depth = 0;
+    bool in_string = false;
+
+    for (; p < end; p++) {
+        if (in_string) {
+            if (*p == '\\') {
+                p++;
+            } else if (*p == '"') {
+                in_string = false;
+            }
+            continue;
+        }
+
+        switch (*p) {
+        case '"':
+            in_string = true;
+            break;
+        case '[':
+        case '{':
+            depth++;
+            break;
+        case ']':
+        case '}':
+            if (depth == 0) {
+                return p;
+            }
+            depth--;
+            break;
+        case ',':
+            if (depth == 0) {
+                return p;
+            }
+            break;
+        }
+    }
+
+    return (char*)end;
+}
+
+/**
+ * Pass the elements of the top level array in doc to the item callback.
+ * Each element is NUL terminated in place for the call and restored after.
+ */
+static void
+pager_deliver_items(gh_client_pager_t *pager, char *doc, size_t len)
+{
+    char *end = doc + len;
+    char *p = doc;
+
+    while (p < end && isspace((unsigned char)*p)) {
+        p++;
+    }
+    if (p == end) {
+        return;
+    }
+
+    if (*p != '[') {
+        pager->result.items++;
+        if (pager->item_cb(doc, len, pager->user_data) != 0) {
+            pager->stop = pager->result.stopped = true;
+        }
+        return;
+    }
+
+    for (p++; p < end && *p != ']';) {
+        while (p < end && (isspace((unsigned char)*p) || *p == ',')) {
+            p++;
+        }
+        if (p == end || *p == ']') {
+            break;
+        }
+
+        char *item_end = json_value_end(p, end);
+        char *last = item_end;
+        while (last > p && isspace((unsigned char)last[-1])) {
+            last--;
+        }
+
+        char saved = *last;
+        *last = '\0';
+        pager->result.items++;
+        int stop = pager->item_cb(p, (size_t)(last - p), pager->user_data);
+        *last = saved;
+
+        if (stop != 0) {
+            pager->stop = pager->result.stopped = true;
+            return;
+        }
+        p = item_end;
+    }
+}
+
+/**
+ * Track the lowest X-RateLimit-Remaining of the current rate limit window.
+ * Pages complete out of order, so a later reset starts a new window.
+ */
+static void
+pager_rate_update(gh_client_pager_t *pager, const gh_client_response_t *res)
+{
+    const gh_client_rate_limit_data_t *rl = res->rate_limit_data;
+
+    if (rl == NULL || rl->limit == 0) {
+        return;
+    }
+    if (rl->reset > pager->result.rate_reset ||
+        rl->remaining < pager->result.rate_remaining) {
+        pager->result.rate_remaining = rl->remaining;
+    }
+    if (rl->reset > pager->result.rate_reset) {
+        pager->result.rate_reset = rl->reset;
+    }
+}
+
+/**
+ * Read the page number out of the last link, e.g.
+ * https://api.github.com/repositories/1/issues?per_page=100&page=7
+ */
+static void
+pager_parse_last(gh_client_pager_t *pager, const char *last_link)
+{
+    const char *q = strchr(last_link, '?');
+    const char *p = q;
+
+    while (p != NULL) {
+        if (strncmp(p + 1, "page=", 5) == 0) {
+            break;
+        }
+        p = strchr(p + 1, '&');
+    }
+    if (p == NULL || strlen(last_link) >= sizeof(pager->page_url)) {
+        return;
+    }
+
+    char *digits_end = NULL;
+    unsigned long last = strtoul(p + 6, &digits_end, 10);
+    if (digits_end == p + 6 || last == 0) {
+        return;
+    }
+
+    strcpy(pager->page_url, last_link);
+    pager->page_at = (size_t)(p + 6 - last_link);
+    pager->page_end = (size_t)(digits_end - last_link);
+    pager->last_page = (unsigned int)last;
+}
+
+static void pager_page_cb(gh_client_response_t *res, void *user_data);
+
+static int
+pager_submit(gh_client_pager_t *pager, unsigned int page, const char *url)
+{
+    gh_client_page_tag_t *tag = &pager->tags[page % pager->window];
+
+    tag->pager = pager;
+    tag->page = page;
+    if (gh_client_submit(pager->client, "GET", url, NULL, pager_page_cb, tag) != 0) {
+        return 1;
+    }
+    pager->in_flight++;
+    pager->next_submit = page + 1;
+
+    return 0;
+}
+
+static void
+pager_set_error(gh_client_pager_t *pager, const char *msg)
+{
+    if (pager->err_msg == NULL) {
+        pager->err_msg = calloc(strlen(msg)+1, sizeof(char));
+        if (pager->err_msg != NULL) {
+            strcpy(pager->err_msg, msg);
+        }
+    }
+    pager->stop = true;
+}
+
+/**
+ * Request the pages that fit in the window and the rate limit reserve.
+ */
+static void
+pager_fill(gh_client_pager_t *pager)
+{
+    while (!pager->stop) {
+        unsigned int page = pager->next_submit;
+        char url[GH_MAX_URL_LEN];
+
+        if (pager->max_pages > 0 && page > pager->max_pages) {
+            break;
+        }
+
+        if (pager->last_page > 0) {
+            if (page > pager->last_page ||
+                page >= pager->next_deliver + pager->window) {
+                break;
+            }
+            int n = snprintf(url, sizeof(url), "%.*s%u%s", (int)pager->page_at,
+                             pager->page_url, page,
+                             pager->page_url + pager->page_end);
+            if (n < 0 || (size_t)n >= sizeof(url)) {
+                pager_set_error(pager, "error: page url too long");
+                break;
+            }
+        } else if (pager->next_url[0] != '\0' && pager->in_flight == 0) {
+            strcpy(url, pager->next_url);
+            pager->next_url[0] = '\0';
+        } else {
+            break;
+        }
+
+        // every call in flight will take one more off the remaining count
+        if (pager->result.rate_reset > 0 &&
+            pager->result.rate_remaining < pager->rate_reserve + pager->in_flight + 1) {
+            pager->result.rate_limited = true;
+            break;
+        }
+
+        if (pager_submit(pager, page, url) != 0) {
+            pager_set_error(pager, "error: cannot submit page");
+        }
+    }
+}
+
+static void
+pager_free(gh_client_pager_t *pager)
+{
+    for (unsigned int i = 0; i < pager->window; i++) {
+        gh_client_response_free(pager->held[i]);
+    }
+    free(pager->held);
+    free(pager->tags);
+    free(pager->err_msg);
+    free(pager);
+}
+
+static void
+pager_unlink(gh_client_pager_t *pager)
+{
+    gh_client_t *client = pager->client;
+
+    if (pager->prev != NULL) {
+        pager->prev->next = pager->next;
+    } else {
+        client->pagers = pager->next;
+    }
+    if (pager->next != NULL) {
+        pager->next->prev = pager->prev;
+    }
+}
+
+static void
+pager_page_cb(gh_client_response_t *res, void *user_data)
+{
+    gh_client_page_tag_t *tag = user_data;
+    gh_client_pager_t *pager = tag->pager;
+    unsigned int page = tag->page;
+
+    pager->in_flight--;
+
+    if (res->err_msg != NULL || res->resp_code < 200 || res->resp_code > 299) {
+        if (pager->result.resp_code == 0 || pager->result.resp_code < 300) {
+            pager->result.resp_code = res->resp_code;
+        }
+        if (res->resp_code == 403 || res->resp_code == 429) {
+            pager->result.rate_limited = true;
+        }
+        pager_set_error(pager, res->err_msg != NULL ? res->err_msg :
+                        "error: unexpected response code");
+        gh_client_response_free(res);
+    } else if (pager->stop) {
+        gh_client_response_free(res);
+    } else {
+        pager_rate_update(pager, res);
+        if (pager->result.resp_code == 0) {
+            pager->result.resp_code = res->resp_code;
+        }
+        if (page == 1 && res->last_link[0] != '\0') {
+            pager_parse_last(pager, res->last_link);
+        }
+        if (pager->last_page == 0 && res->next_link[0] != '\0') {
+            strcpy(pager->next_url, res->next_link);
+        }
+        pager->held[page % pager->window] = res;
+    }
+
+    // deliver in page order
+    while (!pager->stop) {
+        gh_client_response_t **slot = &pager->held[pager->next_deliver % pager->window];
+        if (*slot == NULL) {
+            break;
+        }
+
+        if ((*slot)->resp != NULL) {
+            pager_deliver_items(pager, (*slot)->resp, (*slot)->size);
+        }
+        gh_client_response_free(*slot);
+        *slot = NULL;
+        pager->result.pages++;
+        pager->next_deliver++;
+    }
+
+    pager_fill(pager);
+
+    if (pager->in_flight > 0) {
+        return;
+    }
+
+    pager->result.err_msg = pager->err_msg;
+    if (pager->done_cb != NULL) {
+        pager->done_cb(&pager->result, pager->user_data);
+    }
+    pager_unlink(pager);
+    pager_free(pager);
+}
+
+int
+gh_client_paginate(gh_client_t *client, const char *path,
+                   const gh_client_paginate_opts_t *opts,
+                   gh_client_item_cb item_cb, gh_client_pages_done_cb done_cb,
+                   void *user_data)
+{
+    if (client == NULL || path == NULL || item_cb == NULL) {
+        return 1;
+    }
+
+    unsigned int per_page = GH_CLIENT_PER_PAGE_MAX;
+    if (opts != NULL && opts->per_page > 0 && opts->per_page < per_page) {
+        per_page = opts->per_page;
+    }
+
+    char url[GH_MAX_URL_LEN];
+    int n = snprintf(url, sizeof(url), "%s%cper_page=%u%s%s", path,
+                     strchr(path, '?') != NULL ? '&' : '?', per_page,
+                     opts != NULL && opts->query != NULL ? "&" : "",
+                     opts != NULL && opts->query != NULL ? opts->query : "");
+    if (n < 0 || (size_t)n >= sizeof(url)) {
+        return 1;
+    }
+
+    gh_client_pager_t *pager = calloc(1, sizeof(gh_client_pager_t));
+    if (pager == NULL) {
+        return 1;
+    }
+
+    pager->client = client;
+    pager->item_cb = item_cb;
+    pager->done_cb = done_cb;
+    pager->user_data = user_data;
+    pager->window = GH_CLIENT_DEFAULT_PAGE_WINDOW;
+    if (opts != NULL) {
+        if (opts->window > 0) {
+            pager->window = opts->window;
+        }
+        pager->max_pages = opts->max_pages;
+        pager->rate_reserve = opts->rate_reserve;
+    }
+    pager->next_deliver = 1;
+    pager->held = calloc(pager->window, sizeof(gh_client_response_t*));
+    pager->tags = calloc(pager->window, sizeof(gh_client_page_tag_t));
+
+    if (pager->held == NULL || pager->tags == NULL ||
+        pager_submit(pager, 1, url) != 0) {
+        pager_free(pager);
+        return 1;
+    }
+
+    pager->next = client->pagers;
+    if (client->pagers != NULL) {
+        client->pagers->prev = pager;
+    }
+    client->pagers = pager;
+
+    return 0;
+}
+
+static int
+client_paginate_path(gh_client_t *client, const gh_client_paginate_opts_t *opts,
+                     gh_client_item_cb item_cb, gh_client_pages_done_cb done_cb,
+                     void *user_data, const char *fmt, ...)
+{
+    char path[DEFAULT_URL_SIZE];
+    va_list ap;
+
+    va_start(ap, fmt);
+    int n = vsnprintf(path, sizeof(path), fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= sizeof(path)) {
+        return 1;
+    }
+
+    return gh_client_paginate(client, path, opts, item_cb, done_cb, user_data);
+}
+
+int
+gh_client_repo_list_by_org_name_all(gh_client_t *client, const char *owner,
+                                    const gh_client_paginate_opts_t *opts,
+                                    gh_client_item_cb item_cb,
+                                    gh_client_pages_done_cb done_cb,
+                                    void *user_data)
+{
+    if (owner == NULL) {
+        return 1;
+    }
+
+    return client_paginate_path(client, opts, item_cb, done_cb, user_data,
+                                "/orgs/%s/repos", owner);
+}
+
+int
+gh_client_repo_releases_list_all(gh_client_t *client, const char *owner,
+                                 const char *repo,
+                                 const gh_client_paginate_opts_t *opts,
+                                 gh_client_item_cb item_cb,
+                                 gh_client_pages_done_cb done_cb,
+                                 void *user_data)
+{
+    if (owner == NULL || repo == NULL) {
+        return 1;
+    }
+
+    return client_paginate_path(client, opts, item_cb, done_cb, user_data,
+                                "/repos/%s/%s/releases", owner, repo);
+}
+
+int
+gh_client_repo_release_assets_list_all(gh_client_t *client, const char *owner,
+                                       const char *repo, const unsigned int id,
+                                       const gh_client_paginate_opts_t *opts,
+                                       gh_client_item_cb item_cb,
+                                       gh_client_pages_done_cb done_cb,
+                                       void *user_data)
+{
+    if (owner == NULL || repo == NULL) {
+        return 1;
+    }
+
+    return client_paginate_path(client, opts, item_cb, done_cb, user_data,
+                                "/repos/%s/%s/releases/%u/assets", owner, repo,
+                                id);
+}
+
+int
+gh_client_repo_stargazers_list_all(gh_client_t *client, const char *owner,
+                                   const char *repo,
+                                   const gh_client_paginate_opts_t *opts,
+                                   gh_client_item_cb item_cb,
+                                   gh_client_pages_done_cb done_cb,
+                                   void *user_data)
+{
+    if (owner == NULL || repo == NULL) {
+        return 1;
+    }
+
+    return client_paginate_path(client, opts, item_cb, done_cb, user_data,
+                                "/repos/%s/%s/stargazers", owner, repo);
+}
+
+int
+gh_client_repo_commits_list_all(gh_client_t *client, const char *owner,
+                                const char *repo,
+                                const gh_client_paginate_opts_t *opts,
+                                gh_client_item_cb item_cb,
+                                gh_client_pages_done_cb done_cb,
+                                void *user_data)
+{
+    if (owner == NULL || repo == NULL) {
+        return 1;
+    }
+
+    return client_paginate_path(client, opts, item_cb, done_cb, user_data,
+                                "/repos/%s/%s/commits", owner, repo);
+}
+
+int
+gh_client_repo_branches_list_all(gh_client_t *client, const char *owner,
+                                 const char *repo,
+                                 const gh_client_paginate_opts_t *opts,
+                                 gh_client_item_cb item_cb,
+                                 gh_client_pages_done_cb done_cb,
+                                 void *user_data)
+{
+    if (owner == NULL || repo == NULL) {
+        return 1;
+    }
+
+    return client_paginate_path(client, opts, item_cb, done_cb, user_data,
+                                "/repos/%s/%s/branches", owner, repo);
+}
+
+int
+gh_client_repo_pull_request_list_all(gh_client_t *client, const char *owner,
+                                     const char *repo,
+                                     const gh_client_paginate_opts_t *opts,
+                                     gh_client_item_cb item_cb,
+                                     gh_client_pages_done_cb done_cb,
+                                     void *user_data)
+{
+    if (owner == NULL || repo == NULL) {
+        return 1;
+    }
+
+    return client_paginate_path(client, opts, item_cb, done_cb, user_data,
+                                "/repos/%s/%s/pulls", owner, repo);
+}
+
+int
+gh_client_issues_by_repo_list_all(gh_client_t *client, const char *owner,
+                                  const char *repo,
+                                  const gh_client_paginate_opts_t *opts,
+                                  gh_client_item_cb item_cb,
+                                  gh_client_pages_done_cb done_cb,
+                                  void *user_data)
+{
+    if (owner == NULL || repo == NULL) {
+        return 1;
+    }
+
+    return client_paginate_path(client, opts, item_cb, done_cb, user_data,
+                                "/repos/%s/%s/issues", owner, repo);
+}
+
+int
+gh_client_user_repositories_list_all(gh_client_t *client, const char *user,
+                                     const gh_client_paginate_opts_t *opts,
+                                     gh_client_item_cb item_cb,
+                                     gh_client_pages_done_cb done_cb,
+                                     void *user_data)
+{
+    if (user == NULL) {
+        return 1;
+    }
+
+    return client_paginate_path(client, opts, item_cb, done_cb, user_data,
+                                "/users/%s/repos", user);
+}
+
+int
+gh_client_user_stars_list_all(gh_client_t *client, const char *user,
+                              const gh_client_paginate_opts_t *opts,
+                              gh_client_item_cb item_cb,
+                              gh_client_pages_done_cb done_cb,
+                              void *user_data)
+{
+    if (user == NULL) {
+        return 1;
+    }
+
+    return client_paginate_path(client, opts, item_cb, done_cb, user_data,
+                                "/users/%s/starred", user);
+}
+
+int
+gh_client_user_followers_list_all(gh_client_t *client,
+                                  const gh_client_paginate_opts_t *opts,
+                                  gh_client_item_cb item_cb,
+                                  gh_client_pages_done_cb done_cb,
+                                  void *user_data)
+{
+    return gh_client_paginate(client, "/user/followers", opts, item_cb,
+                              done_cb, user_data);
+}
+
+int
+gh_client_events_by_org_list_all(gh_client_t *client, const char *owner,
+                                 const gh_client_paginate_opts_t *opts,
+                                 gh_client_item_cb item_cb,
+                                 gh_client_pages_done_cb done_cb,
+                                 void *user_data)
+{
+    if (owner == NULL) {
+        return 1;
+    }
+
+    return client_paginate_path(client, opts, item_cb, done_cb, user_data,
+                                "/orgs/%s/events", owner);
+}
+
+int
+gh_client_events_by_user_list_all(gh_client_t *client, const char *user,
+                                  const gh_client_paginate_opts_t *opts,
+                                  gh_client_item_cb item_cb,
+                                  gh_client_pages_done_cb done_cb,
+                                  void *user_data)
+{
+    if (user == NULL) {
+        return 1;
+    }
+
+    return client_paginate_path(client, opts, item_cb, done_cb, user_data,
+                                "/users/%s/events/public", user);
+}
+
+void
+gh_client_destroy(gh_client_t *client)
+{
+    if (client == NULL) {
+        return;
+    }
+
+    // calls still queued or in flight are dropped without a callback
+    while (client->queue_head != NULL) {
+        gh_client_call_t *call = client->queue_head;
+        client->queue_head = call->next;
+        gh_client_response_free(call->response);
+        free(call);
+    }
+
+    while (client->in_flight != NULL) {
+        gh_client_call_t *call = client->in_flight;
+        client->in_flight = call->next;
+        curl_multi_remove_handle(client->multi, call->easy);
+        curl_easy_cleanup(call->easy);
+        gh_client_response_free(call->response);
+        curl_slist_free_all(call->headers);
+        if (call->cached != NULL) {
+            cache_unpin(call->cached);
+        }
+        free(call);
+    }
+
+    // their page calls are gone, so the listings never finish
+    while (client->pagers != NULL) {
+        gh_client_pager_t *pager = client->pagers;
+        client->pagers = pager->next;
+        pager_free(pager);
+    }
+
+    for (unsigned int i = 0; i < client->idle_count; i++) {
+        curl_easy_cleanup(client->idle[i]);
+    }
+
+    // the easy handles are cleaned up first, they may still use the multi
+    // handle's connection cache
+    curl_multi_cleanup(client->multi);
+    curl_slist_free_all(client->headers);
+    cache_free(client->cache);
+    free(client->idle);
+    free(client);
+}
+
+static int
+json_push(gh_json_t *doc, const uint8_t type, const size_t start)
+{
+    if (doc->count == doc->cap) {
+        unsigned int cap = doc->cap > 0 ? doc->cap * 2 : 64;
+        gh_json_tok_t *toks = realloc(doc->toks, cap * sizeof(gh_json_tok_t));
+        if (toks == NULL) {
+            return -1;
+        }
+        doc->toks = toks;
+        doc->cap = cap;
+    }
+
+    gh_json_tok_t *tok = &doc->toks[doc->count];
+    tok->type = type;
+    tok->start = (uint32_t)start;
+    tok->end = (uint32_t)start;
+    tok->skip = doc->count + 1;
+    tok->size = 0;
+
+    return (int)doc->count++;
+}
+
+static inline size_t
+json_skip_ws(const char *json, size_t i, const size_t len)
+{
+    while (i < len && (json[i] == ' ' || json[i] == '\n' || json[i] == '\r' ||
+                       json[i] == '\t')) {
+        i++;
+    }
+
+    return i;
+}
+
+/**
+ * Record the string, number or literal at *pos and move past it. Returns
+ * the token index or -1.
+ */
+static int
+json_scalar(gh_json_t *doc, size_t *pos)
+{
+    const char *json = doc->json;
+    size_t len = doc->len;
+    size_t i = *pos;
+    size_t start = i;
+    uint8_t type;
+
+    if (json[i] == '"') {
+        type = GH_JSON_STRING;
+        start = ++i;
+        for (; i < len && json[i] != '"'; i++) {
+            if (json[i] == '\\') {
+                i++;
+            } else if ((unsigned char)json[i] < 0x20) {
+                return -1;
+            }
+        }
+        if (i >= len) {
+            return -1;
+        }
+    } else if (len - i >= 4 && memcmp(json + i, "true", 4) == 0) {
+        type = GH_JSON_TRUE;
+        i += 4;
+    } else if (len - i >= 5 && memcmp(json + i, "false", 5) == 0) {
+        type = GH_JSON_FALSE;
+        i += 5;
+    } else if (len - i >= 4 && memcmp(json + i, "null", 4) == 0) {
+        type = GH_JSON_NULL;
+        i += 4;
+    } else if (json[i] == '-' || isdigit((unsigned char)json[i])) {
+        type = GH_JSON_NUMBER;
+        while (i < len && (isdigit((unsigned char)json[i]) || json[i] == '-' ||
+                           json[i] == '+' || json[i] == '.' ||
+                           json[i] == 'e' || json[i] == 'E')) {
+            i++;
+        }
+    } else {
+        return -1;
+    }
+
+    int t = json_push(doc, type, start);
+    if (t < 0) {
+        return -1;
+    }
+    doc->toks[t].end = (uint32_t)i;
+    *pos = type == GH_JSON_STRING ? i + 1 : i;
+
+    return t;
+}
+
+int
+gh_json_parse(gh_json_t *doc, const char *json, const size_t len)
+{
+    if (doc == NULL || json == NULL || len > UINT32_MAX) {
+        return 1;
+    }
+
+    doc->json = json;
+    doc->len = len;
+    doc->count = 0;
+
+    // open containers, innermost last
+    int stack[GH_JSON_MAX_DEPTH];
+    int depth = 0;
+    size_t i = json_skip_ws(json, 0, len);
+
+    for (;;) {
+        int parent = depth > 0 ? stack[depth-1] : -1;
+        char close = parent < 0 ? 0 :
+            doc->toks[parent].type == GH_JSON_OBJECT ? '}' : ']';
+
+        if (i >= len) {
+            return 1;
+        }
+
+        // a value, a member, or the end of an empty container
+        if (parent < 0 || doc->toks[parent].size > 0 || json[i] != close) {
+            if (close == '}') {
+                int key = json[i] == '"' ? json_scalar(doc, &i) : -1;
+                if (key < 0) {
+                    return 1;
+                }
+                i = json_skip_ws(json, i, len);
+                if (i >= len || json[i] != ':') {
+                    return 1;
+                }
+                i = json_skip_ws(json, i + 1, len);
+                if (i >= len) {
+                    return 1;
+                }
+            }
+            if (parent >= 0) {
+                doc->toks[parent].size++;
+            }
+
+            if (json[i] == '{' || json[i] == '[') {
+                if (depth == GH_JSON_MAX_DEPTH) {
+                    return 1;
+                }
+                int t = json_push(doc, json[i] == '{' ? GH_JSON_OBJECT :
+                                  GH_JSON_ARRAY, i);
+                if (t < 0) {
+                    return 1;
+                }
+                stack[depth++] = t;
+                i = json_skip_ws(json, i + 1, len);
+                continue;
+            }
+            if (json_scalar(doc, &i) < 0) {
+                return 1;
+            }
+        }
+
+        // after a value: a comma, closing brackets or the end
+        for (;;) {
+            i = json_skip_ws(json, i, len);
+            if (depth == 0) {
+                return i == len ? 0 : 1;
+            }
+
+            parent = stack[depth-1];
+            close = doc->toks[parent].type == GH_JSON_OBJECT ? '}' : ']';
+            if (i < len && json[i] == ',') {
+                i = json_skip_ws(json, i + 1, len);
+                break;
+            }
+            if (i >= len || json[i] != close) {
+                return 1;
+            }
+
+            doc->toks[parent].end = (uint32_t)(i + 1);
+            doc->toks[parent].skip = doc->count;
+            depth--;
+            i++;
+        }
+    }
+}
+
+int
+gh_json_parse_response(gh_json_t *doc, const gh_client_response_t *res)
+{
+    if (res == NULL || res->resp == NULL) {
+        return 1;
+    }
+
+    return gh_json_parse(doc, res->resp, res->size);
+}
+
+void
+gh_json_free(gh_json_t *doc)
+{
+    if (doc == NULL) {
+        return;
+    }
+
+    free(doc->toks);
+    doc->toks = NULL;
+    doc->count = doc->cap = 0;
+}
+
+static inline bool
+json_valid(const gh_json_t *doc, const int tok)
+{
+    return doc != NULL && tok >= 0 && (unsigned int)tok < doc->count;
+}
+
+enum gh_json_type
+gh_json_type(const gh_json_t *doc, const int tok)
+{
+    return json_valid(doc, tok) ? (enum gh_json_type)doc->toks[tok].type :
+        GH_JSON_NONE;
+}
+
+unsigned int
+gh_json_size(const gh_json_t *doc, const int tok)
+{
+    return json_valid(doc, tok) ? doc->toks[tok].size : 0;
+}
+
+int
+gh_json_member(const gh_json_t *doc, const int tok, const char *key,
+               const size_t key_len)
+{
+    if (!json_valid(doc, tok) || doc->toks[tok].type != GH_JSON_OBJECT) {
+        return -1;
+    }
+
+    const gh_json_tok_t *obj = &doc->toks[tok];
+    unsigned int t = (unsigned int)tok + 1;
+
+    for (uint32_t n = 0; n < obj->size; n++) {
+        const gh_json_tok_t *k = &doc->toks[t];
+        unsigned int value = t + 1;
+
+        if (k->end - k->start == key_len &&
+            memcmp(doc->json + k->start, key, key_len) == 0) {
+            return (int)value;
+        }
+        t = doc->toks[value].skip;
+    }
+
+    return -1;
+}
+
+int
+gh_json_at(const gh_json_t *doc, const int tok, const unsigned int index)
+{
+    if (!json_valid(doc, tok) || doc->toks[tok].type != GH_JSON_ARRAY ||
+        index >= doc->toks[tok].size) {
+        return -1;
+    }
+
+    unsigned int t = (unsigned int)tok + 1;
+    for (unsigned int n = 0; n < index; n++) {
+        t = doc->toks[t].skip;
+    }
+
+    return (int)t;
+}
+
+int
+gh_json_next(const gh_json_t *doc, const int tok)
+{
+    if (!json_valid(doc, tok)) {
+        return -1;
+    }
+
+    // a sibling follows only when a comma does
+    const gh_json_tok_t *t = &doc->toks[tok];
+    size_t i = t->type == GH_JSON_STRING ? t->end + 1 : t->end;
+    i = json_skip_ws(doc->json, i, doc->len);
+    if (i >= doc->len || doc->json[i] != ',' || t->skip >= doc->count) {
+        return -1;
+    }
+
+    return (int)t->skip;
+}
+
+int
+gh_json_get(const gh_json_t *doc, const int tok, const char *path)
+{
+    int cur = tok;
+
+    if (path == NULL) {
+        return -1;
+    }
+
+    while (*path != '\0' && cur >= 0) {
+        if (*path == '.') {
+            path++;
+        } else if (*path == '[') {
+            char *end = NULL;
+            unsigned long index = strtoul(path + 1, &end, 10);
+            if (end == path + 1 || *end != ']') {
+                return -1;
+            }
+            cur = gh_json_at(doc, cur, (unsigned int)index);
+            path = end + 1;
+        } else {
+            size_t key_len = strcspn(path, ".[");
+            cur = gh_json_member(doc, cur, path, key_len);
+            path += key_len;
+        }
+    }
+
+    return cur;
+}
+
+gh_json_str_t
+gh_json_raw(const gh_json_t *doc, const int tok)
+{
+    gh_json_str_t str = {"", 0};
+
+    if (json_valid(doc, tok)) {
+        str.ptr = doc->json + doc->toks[tok].start;
+        str.len = doc->toks[tok].end - doc->toks[tok].start;
+    }
+
+    return str;
+}
+
+static int
+json_hex4(const char *p, const char *end)
+{
+    int v = 0;
+
+    if (end - p < 4) {
+        return -1;
+    }
+    for (int k = 0; k < 4; k++) {
+        char c = p[k];
+        v <<= 4;
+        if (c >= '0' && c <= '9') {
+            v |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            v |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            v |= c - 'A' + 10;
+        } else {
+            return -1;
+        }
+    }
+
+    return v;
+}
+
+long
+gh_json_string(const gh_json_t *doc, const int tok, char *buf,
+               const size_t buf_len)
+{
+    if (gh_json_type(doc, tok) != GH_JSON_STRING) {
+        return -1;
+    }
+
+    const char *p = doc->json + doc->toks[tok].start;
+    const char *end = doc->json + doc->toks[tok].end;
+    size_t out = 0;
+
+#define JSON_PUT(ch)                            \
+    do {                                        \
+        char c_ = (char)(ch);                   \
+        if (buf != NULL && out + 1 < buf_len) { \
+            buf[out] = c_;                      \
+        }                                       \
+        out++;                                  \
+    } while (0)
+
+    while (p < end) {
+        if (*p != '\\') {
+            JSON_PUT(*p++);
+            continue;
+        }
+
+        p++;
+        if (p >= end) {
+            break;
+        }
+        char e = *p++;
+        switch (e) {
+        case 'b': JSON_PUT('\b'); break;
+        case 'f': JSON_PUT('\f'); break;
+        case 'n': JSON_PUT('\n'); break;
+        case 'r': JSON_PUT('\r'); break;
+        case 't': JSON_PUT('\t'); break;
+        case 'u': {
+            int cp = json_hex4(p, end);
+            if (cp < 0) {
+                break;
+            }
+            p += 4;
+            // a surrogate pair encodes one code point above U+FFFF
+            if (cp >= 0xd800 && cp <= 0xdbff && end - p >= 6 && p[0] == '\\' &&
+                p[1] == 'u') {
+                int lo = json_hex4(p + 2, end);
+                if (lo >= 0xdc00 && lo <= 0xdfff) {
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+                    p += 6;
+                }
+            }
+            if (cp < 0x80) {
+                JSON_PUT(cp);
+            } else if (cp < 0x800) {
+                JSON_PUT(0xc0 | (cp >> 6));
+                JSON_PUT(0x80 | (cp & 0x3f));
+            } else if (cp < 0x10000) {
+                JSON_PUT(0xe0 | (cp >> 12));
+                JSON_PUT(0x80 | ((cp >> 6) & 0x3f));
+                JSON_PUT(0x80 | (cp & 0x3f));
+            } else {
+                JSON_PUT(0xf0 | (cp >> 18));
+                JSON_PUT(0x80 | ((cp >> 12) & 0x3f));
+                JSON_PUT(0x80 | ((cp >> 6) & 0x3f));
+                JSON_PUT(0x80 | (cp & 0x3f));
+            }
+            break;
+        }
+        default:
+            // \" \\ and \/
+            JSON_PUT(e);
+            break;
+        }
+    }
+#undef JSON_PUT
+
+    if (buf != NULL && buf_len > 0) {
+        buf[out < buf_len ? out : buf_len - 1] = '\0';
+    }
+
+    return (long)out;
+}
+
+/**
+ * Copy a number into a terminated buffer, the document is not terminated
+ * after it.
+ */
+static bool
+json_number_text(const gh_json_t *doc, const int tok, char *buf,
+                 const size_t buf_len)
+{
+    if (gh_json_type(doc, tok) != GH_JSON_NUMBER) {
+        return false;
+    }
+
+    gh_json_str_t raw = gh_json_raw(doc, tok);
+    if (raw.len == 0 || raw.len >= buf_len) {
+        return false;
+    }
+    memcpy(buf, raw.ptr, raw.len);
+    buf[raw.len] = '\0';
+
+    return true;
+}
+
+int64_t
+gh_json_int(const gh_json_t *doc, const int tok, const int64_t def)
+{
+    char num[64];
+
+    if (!json_number_text(doc, tok, num, sizeof(num))) {
+        return def;
+    }
+
+    return (int64_t)strtoll(num, NULL, 10);
+}
+
+double
+gh_json_double(const gh_json_t *doc, const int tok, const double def)
+{
+    char num[64];
+
+    if (!json_number_text(doc, tok, num, sizeof(num))) {
+        return def;
+    }
+
+    return strtod(num, NULL);
+}
+
+bool
+gh_json_bool(const gh_json_t *doc, const int tok, const bool def)
+{
+    switch (gh_json_type(doc, tok)) {
+    case GH_JSON_TRUE:
+        return true;
+    case GH_JSON_FALSE:
+        return false;
+    default:
+        return def;
+    }
+}
+
+/**
+ * Raw text of a string member, empty when it is missing or null.
+ */
+static gh_json_str_t
+json_str_at(const gh_json_t *doc, const int tok, const char *path)
+{
+    int t = gh_json_get(doc, tok, path);
+
+    if (gh_json_type(doc, t) != GH_JSON_STRING) {
+        gh_json_str_t empty = {"", 0};
+        return empty;
+    }
+
+    return gh_json_raw(doc, t);
+}
+
+int
+gh_json_repo(const gh_json_t *doc, const int tok, gh_repo_t *repo)
+{
+    if (gh_json_type(doc, tok) != GH_JSON_OBJECT || repo == NULL) {
+        return 1;
+    }
+
+    repo->id = gh_json_int(doc, gh_json_get(doc, tok, "id"), 0);
+    repo->name = json_str_at(doc, tok, "name");
+    repo->full_name = json_str_at(doc, tok, "full_name");
+    repo->owner_login = json_str_at(doc, tok, "owner.login");
+    repo->description = json_str_at(doc, tok, "description");
+    repo->default_branch = json_str_at(doc, tok, "default_branch");
+    repo->language = json_str_at(doc, tok, "language");
+    repo->html_url = json_str_at(doc, tok, "html_url");
+    repo->pushed_at = json_str_at(doc, tok, "pushed_at");
+    repo->stargazers_count = gh_json_int(doc, gh_json_get(doc, tok, "stargazers_count"), 0);
+    repo->forks_count = gh_json_int(doc, gh_json_get(doc, tok, "forks_count"), 0);
+    repo->open_issues_count = gh_json_int(doc, gh_json_get(doc, tok, "open_issues_count"), 0);
+    repo->is_private = gh_json_bool(doc, gh_json_get(doc, tok, "private"), false);
+    repo->fork = gh_json_bool(doc, gh_json_get(doc, tok, "fork"), false);
+    repo->archived = gh_json_bool(doc, gh_json_get(doc, tok, "archived"), false);
+
+    return 0;
+}
+
+int
+gh_json_release(const gh_json_t *doc, const int tok, gh_release_t *release)
+{
+    if (gh_json_type(doc, tok) != GH_JSON_OBJECT || release == NULL) {
+        return 1;
+    }
+
+    release->id = gh_json_int(doc, gh_json_get(doc, tok, "id"), 0);
+    release->tag_name = json_str_at(doc, tok, "tag_name");
+    release->name = json_str_at(doc, tok, "name");
+    release->target_commitish = json_str_at(doc, tok, "target_commitish");
+    release->author_login = json_str_at(doc, tok, "author.login");
+    release->html_url = json_str_at(doc, tok, "html_url");
+    release->upload_url = json_str_at(doc, tok, "upload_url");
+    release->created_at = json_str_at(doc, tok, "created_at");
+    release->published_at = json_str_at(doc, tok, "published_at");
+    release->asset_count = gh_json_size(doc, gh_json_get(doc, tok, "assets"));
+    release->draft = gh_json_bool(doc, gh_json_get(doc, tok, "draft"), false);
+    release->prerelease = gh_json_bool(doc, gh_json_get(doc, tok, "prerelease"), false);
+
+    return 0;
+}
+
+int
+gh_json_issue(const gh_json_t *doc, const int tok, gh_issue_t *issue)
+{
+    if (gh_json_type(doc, tok) != GH_JSON_OBJECT || issue == NULL) {
+        return 1;
+    }
+
+    issue->id = gh_json_int(doc, gh_json_get(doc, tok, "id"), 0);
+    issue->number = gh_json_int(doc, gh_json_get(doc, tok, "number"), 0);
+    issue->title = json_str_at(doc, tok, "title");
+    issue->state = json_str_at(doc, tok, "state");
+    issue->user_login = json_str_at(doc, tok, "user.login");
+    issue->html_url = json_str_at(doc, tok, "html_url");
+    issue->created_at = json_str_at(doc, tok, "created_at");
+    issue->updated_at = json_str_at(doc, tok, "updated_at");
+    issue->closed_at = json_str_at(doc, tok, "closed_at");
+    issue->comments = gh_json_int(doc, gh_json_get(doc, tok, "comments"), 0);
+    issue->label_count = gh_json_size(doc, gh_json_get(doc, tok, "labels"));
+    // the issues API lists pull requests too, they carry this member
+    issue->pull_request = gh_json_get(doc, tok, "pull_request") >= 0;
+
+    return 0;
+}
+
+int
+gh_json_commit(const gh_json_t *doc, const int tok, gh_commit_t *commit)
+{
+    if (gh_json_type(doc, tok) != GH_JSON_OBJECT || commit == NULL) {
+        return 1;
+    }
+
+    int inner = gh_json_get(doc, tok, "commit");
+
+    commit->sha = json_str_at(doc, tok, "sha");
+    commit->message = json_str_at(doc, inner, "message");
+    commit->author_name = json_str_at(doc, inner, "author.name");
+    commit->author_email = json_str_at(doc, inner, "author.email");
+    commit->author_date = json_str_at(doc, inner, "author.date");
+    commit->author_login = json_str_at(doc, tok, "author.login");
+    commit->committer_date = json_str_at(doc, inner, "committer.date");
+    commit->html_url = json_str_at(doc, tok, "html_url");
+    commit->parent_count = gh_json_size(doc, gh_json_get(doc, tok, "parents"));
+
+    return 0;
+}
+
+/**
+ * Growing string for building queries and request bodies. A failed
+ * allocation sticks and the result is dropped at the end.
+ */
+typedef struct {
+    char *ptr;
+    size_t len;
+    size_t cap;
+    bool failed;
+} gql_buf_t;
+
+static void
+gql_append(gql_buf_t *buf, const char *str, const size_t len)
+{
+    if (buf->failed) {
+        return;
+    }
+
+    if (buf->len + len + 1 > buf->cap) {
+        size_t cap = buf->cap > 0 ? buf->cap : 1024;
+        while (cap < buf->len + len + 1) {
+            cap *= 2;
+        }
+        char *ptr = realloc(buf->ptr, cap);
+        if (ptr == NULL) {
+            buf->failed = true;
+            return;
+        }
+        buf->ptr = ptr;
+        buf->cap = cap;
+    }
+
+    memcpy(buf->ptr + buf->len, str, len);
+    buf->len += len;
+    buf->ptr[buf->len] = '\0';
+}
+
+static inline void
+gql_puts(gql_buf_t *buf, const char *str)
+{
+    gql_append(buf, str, strlen(str));
+}
+
+static void
+gql_printf(gql_buf_t *buf, const char *fmt, ...)
+{
+    char tmp[256];
+    va_list ap;
+
+    va_start(ap, fmt);
+    int n = vsnprintf(tmp, sizeof(tmp), fmt, ap);
+    va_end(ap);
+
+    if (n < 0 || (size_t)n >= sizeof(tmp)) {
+        buf->failed = true;
+        return;
+    }
+    gql_append(buf, tmp, (size_t)n);
+}
+
+/**
+ * Append str quoted. JSON and GraphQL strings escape alike.
+ */
+static void
+gql_append_quoted(gql_buf_t *buf, const char *str)
+{
+    const char *run = str;
+
+    gql_puts(buf, "\"");
+    for (const char *p = str; *p != '\0'; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c != '"' && c != '\\' && c >= 0x20) {
+            continue;
+        }
+
+        gql_append(buf, run, (size_t)(p - run));
+        switch (c) {
+        case '"':  gql_puts(buf, "\\\""); break;
+        case '\\': gql_puts(buf, "\\\\"); break;
+        case '\n': gql_puts(buf, "\\n"); break;
+        case '\r': gql_puts(buf, "\\r"); break;
+        case '\t': gql_puts(buf, "\\t"); break;
+        default:   gql_printf(buf, "\\u%04x", c); break;
+        }
+        run = p + 1;
+    }
+    gql_puts(buf, run);
+    gql_puts(buf, "\"");
+}
+
+static char*
+gql_body(const char *query, const char *variables)
+{
+    gql_buf_t buf = {0};
+
+    gql_puts(&buf, "{\"query\":");
+    gql_append_quoted(&buf, query);
+    if (variables != NULL) {
+        gql_puts(&buf, ",\"variables\":");
+        gql_puts(&buf, variables);
+    }
+    gql_puts(&buf, "}");
+
+    if (buf.failed) {
+        free(buf.ptr);
+        return NULL;
+    }
+
+    return buf.ptr;
+}
+
+gh_client_response_t*
+gh_client_graphql(const char *query, const char *variables)
+{
+    gh_client_response_t *response = gh_client_response_new();
+
+    if (query == NULL) {
+        response->err_msg = calloc(25, sizeof(char));
+        strcpy(response->err_msg, "error: query arg is NULL");
+        return response;
+    }
+
+    char *data = gql_body(query, variables);
+    if (data == NULL) {
+        response->err_msg = calloc(29, sizeof(char));
+        strcpy(response->err_msg, "error: unable to build query");
+        return response;
+    }
+
+    struct curl_slist *chunk = NULL;
+    chunk = curl_slist_append(chunk, GH_REQ_JSON_HEADER);
+    chunk = curl_slist_append(chunk, token_header);
+    chunk = curl_slist_append(chunk, GH_REQ_VER_HEADER);
+    chunk = curl_slist_append(chunk, GH_REQ_DEF_UA_HEADER);
+
+    char url[DEFAULT_URL_SIZE] = GH_API_GRAPHQL_URL;
+
+    SET_BASIC_CURL_CONFIG;
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)strlen(data));
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
+
+    CURLcode res = curl_easy_perform(curl);
+    response_code_set(curl, response);
+    free(data);
+
+    CURL_CALL_ERROR_CHECK;
+    curl_slist_free_all(chunk);
+
+    return response;
+}
+
+int
+gh_client_graphql_async(gh_client_t *client, const char *query,
+                        const char *variables, gh_client_call_cb cb,
+                        void *user_data)
+{
+    if (client == NULL || query == NULL) {
+        return 1;
+    }
+
+    char *data = gql_body(query, variables);
+    if (data == NULL) {
+        return 1;
+    }
+
+    int ret = gh_client_submit(client, "POST", client->graphql_url, data, cb,
+                               user_data);
+    free(data);
+
+    return ret;
+}
+
+char*
+gh_graphql_repos_query(const gh_graphql_repo_t *repos, const size_t count,
+                       const size_t first, const gh_graphql_repos_opts_t *opts)
+{
+    if (repos == NULL || count == 0 || count > GH_GRAPHQL_MAX_REPOS) {
+        return NULL;
+    }
+
+    unsigned int fields = GH_GRAPHQL_REPO_ALL;
+    unsigned int releases = GH_GRAPHQL_DEFAULT_RELEASES;
+    unsigned int languages = GH_GRAPHQL_DEFAULT_LANGUAGES;
+
+    if (opts != NULL) {
+        fields = opts->fields > 0 ? opts->fields : fields;
+        releases = opts->releases > 0 ? opts->releases : releases;
+        languages = opts->languages > 0 ? opts->languages : languages;
+    }
+    // connections page at most 100 nodes
+    releases = releases > GH_CLIENT_PER_PAGE_MAX ? GH_CLIENT_PER_PAGE_MAX : releases;
+    languages = languages > GH_CLIENT_PER_PAGE_MAX ? GH_CLIENT_PER_PAGE_MAX : languages;
+
+    gql_buf_t buf = {0};
+
+    gql_puts(&buf, "query {");
+    for (size_t i = 0; i < count; i++) {
+        if (repos[i].owner == NULL || repos[i].name == NULL) {
+            free(buf.ptr);
+            return NULL;
+        }
+        gql_printf(&buf, " r%zu: repository(owner: ", first + i);
+        gql_append_quoted(&buf, repos[i].owner);
+        gql_puts(&buf, ", name: ");
+        gql_append_quoted(&buf, repos[i].name);
+        gql_puts(&buf, ") { ...repo }");
+    }
+    gql_puts(&buf, " rateLimit { cost remaining resetAt } }");
+
+    // the selection is written once and spread into every alias
+    gql_puts(&buf, " fragment repo on Repository { nameWithOwner");
+    if (fields & GH_GRAPHQL_REPO_STARGAZERS) {
+        gql_puts(&buf, " stargazerCount forkCount");
+    }
+    if (fields & GH_GRAPHQL_REPO_LANGUAGES) {
+        gql_printf(&buf, " languages(first: %u, orderBy: {field: SIZE, "
+                   "direction: DESC}) { totalSize edges { size node { name } } }",
+                   languages);
+    }
+    if (fields & GH_GRAPHQL_REPO_RELEASES) {
+        gql_printf(&buf, " latestRelease { tagName name url publishedAt }"
+                   " releases(first: %u, orderBy: {field: CREATED_AT, "
+                   "direction: DESC}) { totalCount nodes { tagName name url "
+                   "publishedAt isPrerelease isDraft } }", releases);
+    }
+    if (fields & GH_GRAPHQL_REPO_LATEST_COMMIT) {
+        gql_printf(&buf, " defaultBranchRef { name target { ... on Commit {"
+                   " oid messageHeadline committedDate url author { name "
+                   "email } } } }");
+    }
+    gql_puts(&buf, " }");
+
+    if (buf.failed) {
+        free(buf.ptr);
+        return NULL;
+    }
+
+    return buf.ptr;
+}
+
+gh_client_response_t*
+gh_client_graphql_repos(const gh_graphql_repo_t *repos, const size_t count,
+                        const gh_graphql_repos_opts_t *opts)
+{
+    if (count > GH_GRAPHQL_MAX_REPOS) {
+        gh_client_response_t *response = gh_client_response_new();
+        response->err_msg = calloc(33, sizeof(char));
+        strcpy(response->err_msg, "error: too many repos in a batch");
+        return response;
+    }
+
+    char *query = gh_graphql_repos_query(repos, count, 0, opts);
+    if (query == NULL) {
+        gh_client_response_t *response = gh_client_response_new();
+        response->err_msg = calloc(26, sizeof(char));
+        strcpy(response->err_msg, "error: invalid repos args");
+        return response;
+    }
+
+    gh_client_response_t *response = gh_client_graphql(query, NULL);
+    free(query);
+
+    return response;
+}
+
+int
+gh_client_graphql_repos_async(gh_client_t *client,
+                              const gh_graphql_repo_t *repos,
+                              const size_t count,
+                              const gh_graphql_repos_opts_t *opts,
+                              gh_client_call_cb cb, void *user_data)
+{
+    if (client == NULL || repos == NULL || count == 0) {
+        return 1;
+    }
+
+    for (size_t first = 0; first < count; first += GH_GRAPHQL_MAX_REPOS) {
+        size_t n = count - first;
+        n = n > GH_GRAPHQL_MAX_REPOS ? GH_GRAPHQL_MAX_REPOS : n;
+
+        char *query = gh_graphql_repos_query(repos + first, n, first, opts);
+        if (query == NULL) {
+            return 1;
+        }
+        int ret = gh_client_graphql_async(client, query, NULL, cb, user_data);
+        free(query);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    return 0;
+}
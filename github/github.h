@@ -50,6 +50,7 @@ extern "C" {
 #define GH_API_USERS_URL  GH_API_BASE_URL "/users/"
 #define GH_API_ISSUE_URL  GH_API_BASE_URL "/issue"
 #define GH_API_ISSUES_URL GH_API_BASE_URL "/issues"
+#define GH_API_GRAPHQL_URL GH_API_BASE_URL "/graphql"
 
 #define GH_MAX_URL_LEN 2048
 
@@ -379,13 +380,76 @@ gh_client_repo_release_asset_delete(const char *owner, const char *repo,
                                  const unsigned int asset_id);
 
 /**
- * Upload a release asset. The response memory needs to be
- * freed by the caller.
+ * Upload a release asset. The file is streamed, not read into memory. The
+ * response memory needs to be freed by the caller.
  */
 gh_client_response_t*
 gh_client_repo_release_asset_upload(const char *upload_url, const char *name,
                                  const char *label, const char *file_path);
 
+/**
+ * Called as a transfer moves with the bytes done and the total, total is 0
+ * while unknown. Return non-zero to abort the transfer.
+ */
+typedef int (*gh_client_progress_cb)(uint64_t done, uint64_t total,
+                                     void *user_data);
+
+/**
+ * Upload a release asset read from fd, from its current offset to the end.
+ * fd must be a regular file since GitHub needs the length up front. The body
+ * is streamed through CURLOPT_READFUNCTION so memory use does not grow with
+ * the asset. upload_url may be the template from the release, e.g.
+ * ".../assets{?name,label}". content_type defaults to
+ * application/octet-stream, progress may be NULL. The response memory needs
+ * to be freed by the caller.
+ */
+gh_client_response_t*
+gh_client_repo_release_asset_upload_fd(const char *upload_url, const char *name,
+                                       const char *label, const int fd,
+                                       const char *content_type,
+                                       gh_client_progress_cb progress,
+                                       void *user_data);
+
+#define GH_CLIENT_DEFAULT_DOWNLOAD_CONNECTIONS 4
+#define GH_CLIENT_DEFAULT_DOWNLOAD_CHUNK       (16 * 1024 * 1024)
+
+/**
+ * Structure used to pass asset download settings.
+ */
+typedef struct {
+    unsigned int connections; // default: GH_CLIENT_DEFAULT_DOWNLOAD_CONNECTIONS
+    uint64_t chunk_size;      // default: GH_CLIENT_DEFAULT_DOWNLOAD_CHUNK
+    gh_client_progress_cb progress;
+    void *user_data;
+} gh_client_download_opts_t;
+
+/**
+ * Download a release asset into file_path. The file is preallocated at the
+ * asset size and, when the server serves byte ranges, split into chunk_size
+ * ranges fetched over up to connections parallel connections, each written
+ * in place with pwrite. Smaller assets and servers without ranges use a
+ * single stream. The data is written to file_path with ".part" appended and
+ * renamed to file_path once every range completed; on failure or when the
+ * progress callback aborts, the .part file is unlinked and an existing
+ * file_path is left untouched. On success resp_code is 200 and size the
+ * number of bytes written, resp stays NULL. The response memory needs to be
+ * freed by the caller.
+ */
+gh_client_response_t*
+gh_client_repo_release_asset_download(const char *owner, const char *repo,
+                                      const unsigned int id,
+                                      const char *file_path,
+                                      const gh_client_download_opts_t *opts);
+
+/**
+ * Same as gh_client_repo_release_asset_download for an asset API URL or a
+ * browser_download_url. The token is only sent to the first host, not to
+ * the signed URL it redirects to.
+ */
+gh_client_response_t*
+gh_client_release_asset_download_url(const char *url, const char *file_path,
+                                     const gh_client_download_opts_t *opts);
+
 /**
  * Retrieve stargazers for a given repository. The response memory needs to be
  * freed by the caller.
@@ -725,6 +789,666 @@ gh_client_code_of_conduct_get_by_key(const char *key);
 void
 gh_client_free();
 
+#define GH_CLIENT_DEFAULT_MAX_HANDLES 16
+
+/**
+ * A client context for concurrent calls. It owns a curl multi handle, a pool
+ * of easy handles and the request headers, which are built once. Calls to
+ * the same host are multiplexed over HTTP/2 when the server supports it.
+ * A context is independent of gh_client_init and is not thread safe, drive
+ * each context from one thread.
+ */
+typedef struct gh_client gh_client_t;
+
+/**
+ * Called once for every submitted call when it completes, from inside
+ * gh_client_run or gh_client_perform. The callback owns the response and
+ * must free it with gh_client_response_free. It may submit more calls but
+ * must not destroy the context.
+ */
+typedef void (*gh_client_call_cb)(gh_client_response_t *res, void *user_data);
+
+/**
+ * Create a client context. max_handles is the number of calls in flight at
+ * once, 0 uses GH_CLIENT_DEFAULT_MAX_HANDLES. Further calls wait in a queue.
+ * Returns NULL on failure. curl_global_init must have been called, which
+ * gh_client_init does.
+ */
+gh_client_t*
+gh_client_new(const char *token, const unsigned int max_handles);
+
+/**
+ * Set the API base URL used for relative paths, e.g. a GitHub Enterprise
+ * server. The default is GH_API_BASE_URL. The GraphQL URL follows it, with
+ * a trailing "/v3" replaced, so "https://host/api/v3" posts queries to
+ * "https://host/api/graphql".
+ */
+int
+gh_client_set_base_url(gh_client_t *client, const char *base_url);
+
+/**
+ * Set the GraphQL endpoint explicitly when it is not derived correctly from
+ * the base URL. It is kept across later gh_client_set_base_url calls.
+ */
+int
+gh_client_set_graphql_url(gh_client_t *client, const char *graphql_url);
+
+/**
+ * Queue a call. url is either an absolute URL or a path such as
+ * "/repos/owner/repo" that is appended to the base URL. method NULL means
+ * GET, or POST when data is given. data is sent as the request body. All
+ * strings are copied. The call starts on the next gh_client_run. Returns 0
+ * on success, the callback is not called when the submit fails.
+ */
+int
+gh_client_submit(gh_client_t *client, const char *method, const char *url,
+                 const char *data, gh_client_call_cb cb, void *user_data);
+
+/**
+ * Start queued calls, wait up to timeout_ms for network activity and run
+ * the callbacks of the calls that completed. Returns the number of calls
+ * still queued or in flight, or -1 on error. Use it to drive the context
+ * from an existing loop.
+ */
+int
+gh_client_run(gh_client_t *client, const int timeout_ms);
+
+/**
+ * Run until every submitted call, including the ones submitted from
+ * callbacks, has completed. Calls held back by the rate limit pacing are
+ * waited for. Returns 0 on success.
+ */
+int
+gh_client_perform(gh_client_t *client);
+
+/**
+ * Queue gh_client_repo_get for the given repository.
+ */
+int
+gh_client_repo_get_async(gh_client_t *client, const char *owner,
+                         const char *repo, gh_client_call_cb cb,
+                         void *user_data);
+
+/**
+ * Queue gh_client_repo_releases_latest for the given repository.
+ */
+int
+gh_client_repo_releases_latest_async(gh_client_t *client, const char *owner,
+                                     const char *repo, gh_client_call_cb cb,
+                                     void *user_data);
+
+/**
+ * Queue gh_client_repo_release_by_tag for the given repository and tag.
+ */
+int
+gh_client_repo_release_by_tag_async(gh_client_t *client, const char *owner,
+                                    const char *repo, const char *tag,
+                                    gh_client_call_cb cb, void *user_data);
+
+/**
+ * Queue gh_client_issue_get for the given repository and issue number.
+ */
+int
+gh_client_issue_get_async(gh_client_t *client, const char *owner,
+                          const char *repo, const unsigned int id,
+                          gh_client_call_cb cb, void *user_data);
+
+#define GH_CLIENT_DEFAULT_CACHE_ENTRIES 256
+#define GH_CLIENT_DEFAULT_RATE_BURST    100
+#define GH_CLIENT_VALIDATOR_LEN         128
+
+/**
+ * Counters of the conditional request cache.
+ */
+typedef struct {
+    uint64_t hits;   // 304 answered from the cache, free of rate limit cost
+    uint64_t misses; // full 200 responses
+    uint64_t stores; // responses stored with an ETag or Last-Modified
+    unsigned int entries;
+} gh_client_cache_stats_t;
+
+/**
+ * Cache GET responses of the context by URL. Each later GET of a cached URL
+ * is sent with If-None-Match or If-Modified-Since, and a 304 is handed to
+ * the callback as a 200 with the cached body. GitHub does not count 304s
+ * against the rate limit. At most max_entries responses are kept in memory,
+ * the least recently used go first. When dir is given every stored response
+ * is also written there and entries missing from memory are read back, so
+ * the cache survives restarts. The directory must exist. Returns 0 on
+ * success.
+ */
+int
+gh_client_cache_enable(gh_client_t *client, const unsigned int max_entries,
+                       const char *dir);
+
+/**
+ * Copy the cache counters into stats. Returns 0 on success, 1 when the cache
+ * is not enabled.
+ */
+int
+gh_client_cache_stats(const gh_client_t *client, gh_client_cache_stats_t *stats);
+
+/**
+ * Pace calls by the X-RateLimit-Remaining and X-RateLimit-Reset headers of
+ * the responses. Calls start freely while more than burst calls are left
+ * above reserve. Below that the calls left are spread evenly until the
+ * reset, and at the reserve queued calls wait for the reset. A 403 or 429
+ * with Retry-After holds the queue for that long. The budget followed is
+ * the core one, search and the other resources only honor Retry-After. The
+ * defaults are a reserve of 0 and GH_CLIENT_DEFAULT_RATE_BURST.
+ */
+void
+gh_client_set_rate_reserve(gh_client_t *client, const uint64_t reserve,
+                           const uint64_t burst);
+
+#define GH_CLIENT_PER_PAGE_MAX      100
+#define GH_CLIENT_DEFAULT_PAGE_WINDOW 4
+
+/**
+ * Called once for every element of the listed JSON array, in page order.
+ * item is NUL terminated and only valid during the call. Return non-zero to
+ * stop the iteration.
+ */
+typedef int (*gh_client_item_cb)(const char *item, size_t len, void *user_data);
+
+/**
+ * Outcome of an auto-paginated listing. err_msg is set when a page failed
+ * and is only valid during the done callback.
+ */
+typedef struct {
+    unsigned int pages;
+    size_t items;
+    uint16_t resp_code;
+    bool stopped;      // the item callback returned non-zero
+    bool rate_limited; // pages were left out to keep the rate reserve
+    uint64_t rate_remaining;
+    uint64_t rate_reset;
+    const char *err_msg;
+} gh_client_pages_result_t;
+
+typedef void (*gh_client_pages_done_cb)(const gh_client_pages_result_t *result,
+                                        void *user_data);
+
+/**
+ * Structure used to pass auto-pagination settings.
+ */
+typedef struct {
+    unsigned int per_page;   // default: GH_CLIENT_PER_PAGE_MAX
+    unsigned int max_pages;  // 0 means every page
+    unsigned int window;     // pages in flight or buffered at once, default: GH_CLIENT_DEFAULT_PAGE_WINDOW
+    uint64_t rate_reserve;   // stop before X-RateLimit-Remaining drops below this
+    const char *query;       // extra query parameters, e.g. "state=all&labels=bug"
+} gh_client_paginate_opts_t;
+
+/**
+ * Walk every page of a list endpoint on the client context. The first page
+ * is fetched alone; once its Link header names the last page the remaining
+ * pages are fetched concurrently, at most window of them in flight or
+ * waiting to be delivered, so memory stays bounded however long the list
+ * is. Listings that only have a next link are followed page by page. The
+ * items are passed to item_cb in order and done_cb runs once at the end.
+ * The rate limit headers of each page, the numbers
+ * gh_client_user_rate_limit_info reports, bound the fan-out: no page is
+ * requested once it would take X-RateLimit-Remaining below rate_reserve.
+ * Documents that are not arrays are passed to item_cb whole. Returns 0 on
+ * success, the callbacks are not called when it fails.
+ */
+int
+gh_client_paginate(gh_client_t *client, const char *path,
+                   const gh_client_paginate_opts_t *opts,
+                   gh_client_item_cb item_cb, gh_client_pages_done_cb done_cb,
+                   void *user_data);
+
+/**
+ * Paginate gh_client_repo_list_by_org_name.
+ */
+int
+gh_client_repo_list_by_org_name_all(gh_client_t *client, const char *owner,
+                                    const gh_client_paginate_opts_t *opts,
+                                    gh_client_item_cb item_cb,
+                                    gh_client_pages_done_cb done_cb,
+                                    void *user_data);
+
+/**
+ * Paginate gh_client_repo_releases_list.
+ */
+int
+gh_client_repo_releases_list_all(gh_client_t *client, const char *owner,
+                                 const char *repo,
+                                 const gh_client_paginate_opts_t *opts,
+                                 gh_client_item_cb item_cb,
+                                 gh_client_pages_done_cb done_cb,
+                                 void *user_data);
+
+/**
+ * Paginate gh_client_repo_release_assets_list.
+ */
+int
+gh_client_repo_release_assets_list_all(gh_client_t *client, const char *owner,
+                                       const char *repo, const unsigned int id,
+                                       const gh_client_paginate_opts_t *opts,
+                                       gh_client_item_cb item_cb,
+                                       gh_client_pages_done_cb done_cb,
+                                       void *user_data);
+
+/**
+ * Paginate gh_client_repo_stargasers_list. The items carry the user objects,
+ * the starred_at variant needs the star media type of the sync call.
+ */
+int
+gh_client_repo_stargazers_list_all(gh_client_t *client, const char *owner,
+                                   const char *repo,
+                                   const gh_client_paginate_opts_t *opts,
+                                   gh_client_item_cb item_cb,
+                                   gh_client_pages_done_cb done_cb,
+                                   void *user_data);
+
+/**
+ * Paginate gh_client_repo_commits_list. Filters such as sha, path or since
+ * go in opts->query.
+ */
+int
+gh_client_repo_commits_list_all(gh_client_t *client, const char *owner,
+                                const char *repo,
+                                const gh_client_paginate_opts_t *opts,
+                                gh_client_item_cb item_cb,
+                                gh_client_pages_done_cb done_cb,
+                                void *user_data);
+
+/**
+ * Paginate gh_client_repo_branches_list.
+ */
+int
+gh_client_repo_branches_list_all(gh_client_t *client, const char *owner,
+                                 const char *repo,
+                                 const gh_client_paginate_opts_t *opts,
+                                 gh_client_item_cb item_cb,
+                                 gh_client_pages_done_cb done_cb,
+                                 void *user_data);
+
+/**
+ * Paginate gh_client_repo_pull_request_list. Filters such as state go in
+ * opts->query.
+ */
+int
+gh_client_repo_pull_request_list_all(gh_client_t *client, const char *owner,
+                                     const char *repo,
+                                     const gh_client_paginate_opts_t *opts,
+                                     gh_client_item_cb item_cb,
+                                     gh_client_pages_done_cb done_cb,
+                                     void *user_data);
+
+/**
+ * Paginate gh_client_issues_by_repo_list. Filters such as state, labels or
+ * since go in opts->query.
+ */
+int
+gh_client_issues_by_repo_list_all(gh_client_t *client, const char *owner,
+                                  const char *repo,
+                                  const gh_client_paginate_opts_t *opts,
+                                  gh_client_item_cb item_cb,
+                                  gh_client_pages_done_cb done_cb,
+                                  void *user_data);
+
+/**
+ * Paginate gh_client_user_repositories_list.
+ */
+int
+gh_client_user_repositories_list_all(gh_client_t *client, const char *user,
+                                     const gh_client_paginate_opts_t *opts,
+                                     gh_client_item_cb item_cb,
+                                     gh_client_pages_done_cb done_cb,
+                                     void *user_data);
+
+/**
+ * Paginate gh_client_user_stars_list.
+ */
+int
+gh_client_user_stars_list_all(gh_client_t *client, const char *user,
+                              const gh_client_paginate_opts_t *opts,
+                              gh_client_item_cb item_cb,
+                              gh_client_pages_done_cb done_cb,
+                              void *user_data);
+
+/**
+ * Paginate gh_client_user_followers_list for the authenticated user.
+ */
+int
+gh_client_user_followers_list_all(gh_client_t *client,
+                                  const gh_client_paginate_opts_t *opts,
+                                  gh_client_item_cb item_cb,
+                                  gh_client_pages_done_cb done_cb,
+                                  void *user_data);
+
+/**
+ * Paginate gh_client_events_by_org_list.
+ */
+int
+gh_client_events_by_org_list_all(gh_client_t *client, const char *owner,
+                                 const gh_client_paginate_opts_t *opts,
+                                 gh_client_item_cb item_cb,
+                                 gh_client_pages_done_cb done_cb,
+                                 void *user_data);
+
+/**
+ * Paginate gh_client_events_by_user_list.
+ */
+int
+gh_client_events_by_user_list_all(gh_client_t *client, const char *user,
+                                  const gh_client_paginate_opts_t *opts,
+                                  gh_client_item_cb item_cb,
+                                  gh_client_pages_done_cb done_cb,
+                                  void *user_data);
+
+/**
+ * Free a client context. Calls that have not completed are dropped without
+ * running their callbacks.
+ */
+void
+gh_client_destroy(gh_client_t *client);
+
+/**
+ * Types of the values in a JSON view.
+ */
+enum gh_json_type {
+    GH_JSON_NONE   = 0, // missing
+    GH_JSON_OBJECT = 1,
+    GH_JSON_ARRAY  = 2,
+    GH_JSON_STRING = 3,
+    GH_JSON_NUMBER = 4,
+    GH_JSON_TRUE   = 5,
+    GH_JSON_FALSE  = 6,
+    GH_JSON_NULL   = 7
+};
+
+#define GH_JSON_MAX_DEPTH 128
+
+/**
+ * One value of the tape. Strings span their contents without the quotes
+ * and still escaped. skip is the index of the first token after the value,
+ * so whole subtrees are stepped over without looking at them. An object
+ * is followed by its keys, each followed by its value.
+ */
+typedef struct {
+    uint32_t start;
+    uint32_t end;
+    uint32_t skip;
+    uint32_t size; // members of an object, elements of an array
+    uint8_t type;
+} gh_json_tok_t;
+
+/**
+ * A read-only view over a JSON document. Parsing records one token per
+ * value in a single pass and allocates nothing per value, only the token
+ * array grows. Values are decoded when they are read. The document is not
+ * copied and must outlive the view. A view can be parsed again to reuse
+ * its token array.
+ */
+typedef struct {
+    const char *json;
+    size_t len;
+    gh_json_tok_t *toks;
+    unsigned int count;
+    unsigned int cap;
+} gh_json_t;
+
+/**
+ * Index len bytes of json. Returns 0 on success, 1 on malformed input or
+ * when the nesting is deeper than GH_JSON_MAX_DEPTH.
+ */
+int
+gh_json_parse(gh_json_t *doc, const char *json, const size_t len);
+
+/**
+ * Index the body of a response.
+ */
+int
+gh_json_parse_response(gh_json_t *doc, const gh_client_response_t *res);
+
+/**
+ * Free the token array of a view.
+ */
+void
+gh_json_free(gh_json_t *doc);
+
+/**
+ * Find a value by path below tok. Object keys are separated by dots and
+ * array elements are indexed in brackets, e.g. "commit.author.name",
+ * "assets[0].name" or "[2].sha". Values are named by their token index,
+ * the root is 0. Lookups return -1 when the value is missing and accept
+ * -1, so they chain.
+ */
+int
+gh_json_get(const gh_json_t *doc, const int tok, const char *path);
+
+/**
+ * Find the member of an object by its exact key.
+ */
+int
+gh_json_member(const gh_json_t *doc, const int tok, const char *key,
+               const size_t key_len);
+
+/**
+ * Return the element at index of an array.
+ */
+int
+gh_json_at(const gh_json_t *doc, const int tok, const unsigned int index);
+
+/**
+ * Step from an array element to the next one, -1 after the last. For an
+ * object member value, the next token is the next key.
+ */
+int
+gh_json_next(const gh_json_t *doc, const int tok);
+
+/**
+ * Return the type of a value, GH_JSON_NONE for -1.
+ */
+enum gh_json_type
+gh_json_type(const gh_json_t *doc, const int tok);
+
+/**
+ * Return the number of elements of an array or members of an object.
+ */
+unsigned int
+gh_json_size(const gh_json_t *doc, const int tok);
+
+/**
+ * A slice of the document. The text of a string is still escaped.
+ */
+typedef struct {
+    const char *ptr;
+    size_t len;
+} gh_json_str_t;
+
+/**
+ * Return the raw text of a value, strings without their quotes.
+ */
+gh_json_str_t
+gh_json_raw(const gh_json_t *doc, const int tok);
+
+/**
+ * Copy the unescaped string into buf, NUL terminated and truncated to
+ * buf_len. Returns the full unescaped length, or -1 when the value is not a
+ * string.
+ */
+long
+gh_json_string(const gh_json_t *doc, const int tok, char *buf,
+               const size_t buf_len);
+
+/**
+ * Read a number, or return def when the value is not a number.
+ */
+int64_t
+gh_json_int(const gh_json_t *doc, const int tok, const int64_t def);
+
+double
+gh_json_double(const gh_json_t *doc, const int tok, const double def);
+
+/**
+ * Read a boolean, or return def when the value is not one.
+ */
+bool
+gh_json_bool(const gh_json_t *doc, const int tok, const bool def);
+
+/**
+ * Typed views of the common API objects. The strings point into the
+ * document and are still escaped, missing fields are empty or 0.
+ */
+typedef struct {
+    int64_t id;
+    gh_json_str_t name;
+    gh_json_str_t full_name;
+    gh_json_str_t owner_login;
+    gh_json_str_t description;
+    gh_json_str_t default_branch;
+    gh_json_str_t language;
+    gh_json_str_t html_url;
+    gh_json_str_t pushed_at;
+    int64_t stargazers_count;
+    int64_t forks_count;
+    int64_t open_issues_count;
+    bool is_private;
+    bool fork;
+    bool archived;
+} gh_repo_t;
+
+typedef struct {
+    int64_t id;
+    gh_json_str_t tag_name;
+    gh_json_str_t name;
+    gh_json_str_t target_commitish;
+    gh_json_str_t author_login;
+    gh_json_str_t html_url;
+    gh_json_str_t upload_url;
+    gh_json_str_t created_at;
+    gh_json_str_t published_at;
+    unsigned int asset_count;
+    bool draft;
+    bool prerelease;
+} gh_release_t;
+
+typedef struct {
+    int64_t id;
+    int64_t number;
+    gh_json_str_t title;
+    gh_json_str_t state;
+    gh_json_str_t user_login;
+    gh_json_str_t html_url;
+    gh_json_str_t created_at;
+    gh_json_str_t updated_at;
+    gh_json_str_t closed_at;
+    int64_t comments;
+    unsigned int label_count;
+    bool pull_request;
+} gh_issue_t;
+
+typedef struct {
+    gh_json_str_t sha;
+    gh_json_str_t message;
+    gh_json_str_t author_name;
+    gh_json_str_t author_email;
+    gh_json_str_t author_date;
+    gh_json_str_t author_login; // the GitHub account, empty when unlinked
+    gh_json_str_t committer_date;
+    gh_json_str_t html_url;
+    unsigned int parent_count;
+} gh_commit_t;
+
+/**
+ * Fill a typed view from the object at tok. Returns 0 on success, 1 when
+ * tok is not an object.
+ */
+int
+gh_json_repo(const gh_json_t *doc, const int tok, gh_repo_t *repo);
+
+int
+gh_json_release(const gh_json_t *doc, const int tok, gh_release_t *release);
+
+int
+gh_json_issue(const gh_json_t *doc, const int tok, gh_issue_t *issue);
+
+int
+gh_json_commit(const gh_json_t *doc, const int tok, gh_commit_t *commit);
+
+/**
+ * Send a GraphQL query. variables is a JSON object or NULL. GitHub answers
+ * 200 for queries that failed to resolve, the "errors" member of the body
+ * tells. GraphQL calls need a token.
+ */
+gh_client_response_t*
+gh_client_graphql(const char *query, const char *variables);
+
+/**
+ * Queue a GraphQL query on a client context, see gh_client_graphql. It is
+ * posted to the context's GraphQL URL, see gh_client_set_base_url.
+ */
+int
+gh_client_graphql_async(gh_client_t *client, const char *query,
+                        const char *variables, gh_client_call_cb cb,
+                        void *user_data);
+
+/**
+ * What a batched repository query selects besides nameWithOwner.
+ */
+enum gh_graphql_repo_field {
+    GH_GRAPHQL_REPO_STARGAZERS    = 1 << 0, // stargazerCount and forkCount
+    GH_GRAPHQL_REPO_LANGUAGES     = 1 << 1, // languages by size
+    GH_GRAPHQL_REPO_RELEASES      = 1 << 2, // latestRelease and the newest releases
+    GH_GRAPHQL_REPO_LATEST_COMMIT = 1 << 3, // head of the default branch
+    GH_GRAPHQL_REPO_ALL           = 0x0f
+};
+
+#define GH_GRAPHQL_MAX_REPOS         100
+#define GH_GRAPHQL_DEFAULT_RELEASES  10
+#define GH_GRAPHQL_DEFAULT_LANGUAGES 10
+
+typedef struct {
+    const char *owner;
+    const char *name;
+} gh_graphql_repo_t;
+
+/**
+ * Options of a batched repository query. Zero values select all fields
+ * and the default counts.
+ */
+typedef struct {
+    unsigned int fields;    // gh_graphql_repo_field flags
+    unsigned int releases;  // releases per repository
+    unsigned int languages; // languages per repository
+} gh_graphql_repos_opts_t;
+
+/**
+ * Build one query for count repositories. Each is aliased by its index,
+ * first + i, so its result is "data.r<index>", null when it does not
+ * exist. The query also selects the rateLimit cost. Returns NULL on
+ * invalid arguments, the caller frees the query.
+ */
+char*
+gh_graphql_repos_query(const gh_graphql_repo_t *repos, const size_t count,
+                       const size_t first, const gh_graphql_repos_opts_t *opts);
+
+/**
+ * Fetch up to GH_GRAPHQL_MAX_REPOS repositories in a single call instead
+ * of separate REST calls per repository. opts can be NULL.
+ */
+gh_client_response_t*
+gh_client_graphql_repos(const gh_graphql_repo_t *repos, const size_t count,
+                        const gh_graphql_repos_opts_t *opts);
+
+/**
+ * Queue any number of repositories on a client context, in batches of
+ * GH_GRAPHQL_MAX_REPOS that run concurrently. cb is called once per batch,
+ * the aliases are indexes into repos across all batches. Returns 0 when
+ * every batch was queued.
+ */
+int
+gh_client_graphql_repos_async(gh_client_t *client,
+                              const gh_graphql_repo_t *repos,
+                              const size_t count,
+                              const gh_graphql_repos_opts_t *opts,
+                              gh_client_call_cb cb, void *user_data);
+
 #endif /** end __CLIENT_H */
 #ifdef __cplusplus
 }
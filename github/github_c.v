@@ -33,6 +33,157 @@ fn C.gh_client_repo_release_asset_update(owner &char, repo &char, asset_id u32,
 fn C.gh_client_repo_release_asset_delete(owner &char, repo &char, asset_id u32) &Response
 fn C.gh_client_repo_release_asset_upload(upload_url &char, name &char, label &char, file_path &char) &Response
 
+pub type ProgressCb = fn (done u64, total u64, user_data voidptr) int
+
+pub struct C.gh_client_download_opts_t {
+    connections u32
+    chunk_size  u64
+    progress    ProgressCb
+    user_data   voidptr
+}
+
+fn C.gh_client_repo_release_asset_upload_fd(upload_url &char, name &char, label &char, fd int, content_type &char, progress ProgressCb, user_data voidptr) &Response
+fn C.gh_client_repo_release_asset_download(owner &char, repo &char, id u32, file_path &char, opts &C.gh_client_download_opts_t) &Response
+fn C.gh_client_release_asset_download_url(url &char, file_path &char, opts &C.gh_client_download_opts_t) &Response
+
+// 并发调用（client context）
+pub struct C.gh_client_t {}
+
+pub type CallCb = fn (res &Response, user_data voidptr)
+
+fn C.gh_client_new(token &char, max_handles u32) &C.gh_client_t
+fn C.gh_client_set_base_url(client &C.gh_client_t, base_url &char) int
+fn C.gh_client_set_graphql_url(client &C.gh_client_t, graphql_url &char) int
+fn C.gh_client_submit(client &C.gh_client_t, method &char, url &char, data &char, cb CallCb, user_data voidptr) int
+fn C.gh_client_run(client &C.gh_client_t, timeout_ms int) int
+fn C.gh_client_perform(client &C.gh_client_t) int
+fn C.gh_client_repo_get_async(client &C.gh_client_t, owner &char, repo &char, cb CallCb, user_data voidptr) int
+fn C.gh_client_repo_releases_latest_async(client &C.gh_client_t, owner &char, repo &char, cb CallCb, user_data voidptr) int
+fn C.gh_client_repo_release_by_tag_async(client &C.gh_client_t, owner &char, repo &char, tag &char, cb CallCb, user_data voidptr) int
+fn C.gh_client_issue_get_async(client &C.gh_client_t, owner &char, repo &char, id u32, cb CallCb, user_data voidptr) int
+fn C.gh_client_destroy(client &C.gh_client_t)
+
+// 条件请求缓存与限流
+pub struct C.gh_client_cache_stats_t {
+    hits    u64
+    misses  u64
+    stores  u64
+    entries u32
+}
+
+fn C.gh_client_cache_enable(client &C.gh_client_t, max_entries u32, dir &char) int
+fn C.gh_client_cache_stats(client &C.gh_client_t, stats &C.gh_client_cache_stats_t) int
+fn C.gh_client_set_rate_reserve(client &C.gh_client_t, reserve u64, burst u64)
+
+// 自动翻页
+pub struct C.gh_client_pages_result_t {
+    pages          u32
+    items          usize
+    resp_code      u16
+    stopped        bool
+    rate_limited   bool
+    rate_remaining u64
+    rate_reset     u64
+    err_msg        &char
+}
+
+pub struct C.gh_client_paginate_opts_t {
+    per_page     u32
+    max_pages    u32
+    window       u32
+    rate_reserve u64
+    query        &char
+}
+
+pub type ItemCb = fn (item &char, len usize, user_data voidptr) int
+
+pub type PagesDoneCb = fn (result &C.gh_client_pages_result_t, user_data voidptr)
+
+fn C.gh_client_paginate(client &C.gh_client_t, path &char, opts &C.gh_client_paginate_opts_t, item_cb ItemCb, done_cb PagesDoneCb, user_data voidptr) int
+fn C.gh_client_repo_list_by_org_name_all(client &C.gh_client_t, owner &char, opts &C.gh_client_paginate_opts_t, item_cb ItemCb, done_cb PagesDoneCb, user_data voidptr) int
+fn C.gh_client_repo_releases_list_all(client &C.gh_client_t, owner &char, repo &char, opts &C.gh_client_paginate_opts_t, item_cb ItemCb, done_cb PagesDoneCb, user_data voidptr) int
+fn C.gh_client_repo_release_assets_list_all(client &C.gh_client_t, owner &char, repo &char, id u32, opts &C.gh_client_paginate_opts_t, item_cb ItemCb, done_cb PagesDoneCb, user_data voidptr) int
+fn C.gh_client_repo_stargazers_list_all(client &C.gh_client_t, owner &char, repo &char, opts &C.gh_client_paginate_opts_t, item_cb ItemCb, done_cb PagesDoneCb, user_data voidptr) int
+fn C.gh_client_repo_commits_list_all(client &C.gh_client_t, owner &char, repo &char, opts &C.gh_client_paginate_opts_t, item_cb ItemCb, done_cb PagesDoneCb, user_data voidptr) int
+fn C.gh_client_repo_branches_list_all(client &C.gh_client_t, owner &char, repo &char, opts &C.gh_client_paginate_opts_t, item_cb ItemCb, done_cb PagesDoneCb, user_data voidptr) int
+fn C.gh_client_repo_pull_request_list_all(client &C.gh_client_t, owner &char, repo &char, opts &C.gh_client_paginate_opts_t, item_cb ItemCb, done_cb PagesDoneCb, user_data voidptr) int
+fn C.gh_client_issues_by_repo_list_all(client &C.gh_client_t, owner &char, repo &char, opts &C.gh_client_paginate_opts_t, item_cb ItemCb, done_cb PagesDoneCb, user_data voidptr) int
+fn C.gh_client_user_repositories_list_all(client &C.gh_client_t, user &char, opts &C.gh_client_paginate_opts_t, item_cb ItemCb, done_cb PagesDoneCb, user_data voidptr) int
+fn C.gh_client_user_stars_list_all(client &C.gh_client_t, user &char, opts &C.gh_client_paginate_opts_t, item_cb ItemCb, done_cb PagesDoneCb, user_data voidptr) int
+fn C.gh_client_user_followers_list_all(client &C.gh_client_t, opts &C.gh_client_paginate_opts_t, item_cb ItemCb, done_cb PagesDoneCb, user_data voidptr) int
+fn C.gh_client_events_by_org_list_all(client &C.gh_client_t, owner &char, opts &C.gh_client_paginate_opts_t, item_cb ItemCb, done_cb PagesDoneCb, user_data voidptr) int
+fn C.gh_client_events_by_user_list_all(client &C.gh_client_t, user &char, opts &C.gh_client_paginate_opts_t, item_cb ItemCb, done_cb PagesDoneCb, user_data voidptr) int
+
+
+// JSON 视图
+pub struct C.gh_json_tok_t {
+    start u32
+    end   u32
+    skip  u32
+    size  u32
+    @type u8
+}
+
+pub struct C.gh_json_t {
+    json  &char
+    len   usize
+    toks  &C.gh_json_tok_t
+    count u32
+    cap   u32
+}
+
+pub struct C.gh_json_str_t {
+    ptr &char
+    len usize
+}
+
+pub struct C.gh_release_t {
+    id               i64
+    tag_name         C.gh_json_str_t
+    name             C.gh_json_str_t
+    target_commitish C.gh_json_str_t
+    author_login     C.gh_json_str_t
+    html_url         C.gh_json_str_t
+    upload_url       C.gh_json_str_t
+    created_at       C.gh_json_str_t
+    published_at     C.gh_json_str_t
+    asset_count      u32
+    draft            bool
+    prerelease       bool
+}
+
+fn C.gh_json_parse(doc &C.gh_json_t, json &char, len usize) int
+fn C.gh_json_parse_response(doc &C.gh_json_t, res &Response) int
+fn C.gh_json_free(doc &C.gh_json_t)
+fn C.gh_json_get(doc &C.gh_json_t, tok int, path &char) int
+fn C.gh_json_at(doc &C.gh_json_t, tok int, index u32) int
+fn C.gh_json_next(doc &C.gh_json_t, tok int) int
+fn C.gh_json_type(doc &C.gh_json_t, tok int) int
+fn C.gh_json_size(doc &C.gh_json_t, tok int) u32
+fn C.gh_json_raw(doc &C.gh_json_t, tok int) C.gh_json_str_t
+fn C.gh_json_string(doc &C.gh_json_t, tok int, buf &char, buf_len usize) i64
+fn C.gh_json_int(doc &C.gh_json_t, tok int, def i64) i64
+fn C.gh_json_double(doc &C.gh_json_t, tok int, def f64) f64
+fn C.gh_json_bool(doc &C.gh_json_t, tok int, def bool) bool
+fn C.gh_json_release(doc &C.gh_json_t, tok int, release &C.gh_release_t) int
+
+// GraphQL 批量查询
+pub struct C.gh_graphql_repo_t {
+    owner &char
+    name  &char
+}
+
+pub struct C.gh_graphql_repos_opts_t {
+    fields    u32
+    releases  u32
+    languages u32
+}
+
+fn C.gh_client_graphql(query &char, variables &char) &Response
+fn C.gh_client_graphql_async(client &C.gh_client_t, query &char, variables &char, cb CallCb, user_data voidptr) int
+fn C.gh_graphql_repos_query(repos &C.gh_graphql_repo_t, count usize, first usize, opts &C.gh_graphql_repos_opts_t) &char
+fn C.gh_client_graphql_repos(repos &C.gh_graphql_repo_t, count usize, opts &C.gh_graphql_repos_opts_t) &Response
+fn C.gh_client_graphql_repos_async(client &C.gh_client_t, repos &C.gh_graphql_repo_t, count usize, opts &C.gh_graphql_repos_opts_t, cb CallCb, user_data voidptr) int
 
 pub struct RateLimitData {
     limit      u64
@@ -25,9 +25,12 @@
  * SUCH DAMAGE.
  */
 
+#define _DEFAULT_SOURCE
 #include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "unity.h"
 #include "../github.h"
@@ -109,6 +112,32 @@ test_gh_client_repo_releases_latest(void)
     gh_client_response_free(res);
 }
 
+void
+test_gh_json_release_latest(void)
+{
+    gh_client_response_t *res = gh_client_repo_releases_latest("briandowns",
+                                                               "spinner");
+    gh_json_t doc = {0};
+    gh_release_t release;
+    char tag[64];
+
+    TEST_ASSERT_NOT_NULL(res);
+    TEST_ASSERT_EQUAL_INT(200, res->resp_code);
+    TEST_ASSERT_EQUAL_INT(0, gh_json_parse_response(&doc, res));
+    TEST_ASSERT_EQUAL_INT(0, gh_json_release(&doc, 0, &release));
+    TEST_ASSERT_TRUE(release.id > 0);
+    TEST_ASSERT_TRUE(release.tag_name.len > 0);
+    TEST_ASSERT_TRUE(gh_json_string(&doc, gh_json_get(&doc, 0, "tag_name"),
+                                    tag, sizeof(tag)) > 0);
+    TEST_ASSERT_EQUAL_STRING_LEN(release.tag_name.ptr, tag,
+                                 release.tag_name.len);
+    TEST_ASSERT_EQUAL_INT(GH_JSON_STRING,
+                          gh_json_type(&doc, gh_json_get(&doc, 0, "author.login")));
+
+    gh_json_free(&doc);
+    gh_client_response_free(res);
+}
+
 void
 test_gh_client_repo_release_by_id(void)
 {
@@ -147,6 +176,58 @@ test_gh_client_repo_release_asset_get(void)
     gh_client_response_free(res);
 }
 
+void
+test_gh_client_repo_release_asset_download(void)
+{
+    char path[] = "/tmp/gh_asset_XXXXXX";
+    int fd = mkstemp(path);
+    gh_client_download_opts_t opts = {.connections = 4, .chunk_size = 1 << 20};
+
+    TEST_ASSERT_TRUE(fd >= 0);
+    close(fd);
+
+    gh_client_response_t *res = gh_client_repo_release_asset_download(
+        "rancher", "rke2", 203030920, path, &opts);
+
+    TEST_ASSERT_NOT_NULL(res);
+    TEST_ASSERT_NULL(res->err_msg);
+    TEST_ASSERT_EQUAL_INT(200, res->resp_code);
+    TEST_ASSERT_TRUE(res->size > 0);
+
+    gh_client_response_free(res);
+    unlink(path);
+}
+
+void
+test_gh_client_graphql_repos(void)
+{
+    gh_graphql_repo_t repos[] = {
+        {"briandowns", "spinner"},
+        {"briandowns", "devops-testing"},
+    };
+    gh_json_t doc = {0};
+    char name[64];
+
+    gh_client_response_t *res = gh_client_graphql_repos(repos, 2, NULL);
+
+    TEST_ASSERT_NOT_NULL(res);
+    TEST_ASSERT_NULL(res->err_msg);
+    TEST_ASSERT_EQUAL_INT(200, res->resp_code);
+    TEST_ASSERT_EQUAL_INT(0, gh_json_parse_response(&doc, res));
+    TEST_ASSERT_EQUAL_INT(-1, gh_json_get(&doc, 0, "errors"));
+
+    gh_json_string(&doc, gh_json_get(&doc, 0, "data.r0.nameWithOwner"), name,
+                   sizeof(name));
+    TEST_ASSERT_EQUAL_STRING("briandowns/spinner", name);
+    TEST_ASSERT_TRUE(gh_json_int(&doc, gh_json_get(&doc, 0,
+                                 "data.r0.stargazerCount"), 0) > 0);
+    TEST_ASSERT_EQUAL_INT(GH_JSON_OBJECT,
+                          gh_json_type(&doc, gh_json_get(&doc, 0, "data.r1")));
+
+    gh_json_free(&doc);
+    gh_client_response_free(res);
+}
+
 void
 test_gh_client_repo_commits_list(void)
 {
@@ -208,6 +289,99 @@ void
 test_gh_client_user_followers_list(void)
 {}
 
+static void
+count_ok_cb(gh_client_response_t *res, void *user_data)
+{
+    int *ok = (int*)user_data;
+
+    if (res->err_msg == NULL && res->resp_code == 200) {
+        (*ok)++;
+    }
+    gh_client_response_free(res);
+}
+
+void
+test_gh_client_async_batch(void)
+{
+    gh_client_t *client = gh_client_new(getenv("GITHUB_TOKEN"), 4);
+    int ok = 0;
+
+    TEST_ASSERT_NOT_NULL(client);
+    TEST_ASSERT_EQUAL_INT(0, gh_client_repo_get_async(client, "briandowns",
+                                                      "spinner", count_ok_cb,
+                                                      &ok));
+    TEST_ASSERT_EQUAL_INT(0, gh_client_repo_releases_latest_async(
+        client, "briandowns", "spinner", count_ok_cb, &ok));
+    TEST_ASSERT_EQUAL_INT(0, gh_client_repo_release_by_tag_async(
+        client, "briandowns", "spinner", "v1.23.1", count_ok_cb, &ok));
+    TEST_ASSERT_EQUAL_INT(0, gh_client_perform(client));
+    TEST_ASSERT_EQUAL_INT(3, ok);
+
+    gh_client_destroy(client);
+}
+
+void
+test_gh_client_cache_revalidate(void)
+{
+    gh_client_t *client = gh_client_new(getenv("GITHUB_TOKEN"), 4);
+    gh_client_cache_stats_t stats = {0};
+    int ok = 0;
+
+    TEST_ASSERT_NOT_NULL(client);
+    TEST_ASSERT_EQUAL_INT(0, gh_client_cache_enable(client, 0, NULL));
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_EQUAL_INT(0, gh_client_repo_get_async(client, "briandowns",
+                                                          "spinner", count_ok_cb,
+                                                          &ok));
+        TEST_ASSERT_EQUAL_INT(0, gh_client_perform(client));
+    }
+    TEST_ASSERT_EQUAL_INT(2, ok);
+    TEST_ASSERT_EQUAL_INT(0, gh_client_cache_stats(client, &stats));
+    TEST_ASSERT_EQUAL_UINT(1, stats.hits);
+
+    gh_client_destroy(client);
+}
+
+typedef struct {
+    size_t items;
+    gh_client_pages_result_t result;
+} pages_state_t;
+
+static int
+count_item_cb(const char *item, size_t len, void *user_data)
+{
+    (void)item;
+    (void)len;
+    ((pages_state_t*)user_data)->items++;
+
+    return 0;
+}
+
+static void
+pages_done_cb(const gh_client_pages_result_t *result, void *user_data)
+{
+    ((pages_state_t*)user_data)->result = *result;
+}
+
+void
+test_gh_client_paginate_releases(void)
+{
+    gh_client_t *client = gh_client_new(getenv("GITHUB_TOKEN"), 4);
+    gh_client_paginate_opts_t opts = {.per_page = 5, .max_pages = 3};
+    pages_state_t state = {0};
+
+    TEST_ASSERT_NOT_NULL(client);
+    TEST_ASSERT_EQUAL_INT(0, gh_client_repo_releases_list_all(
+        client, "briandowns", "spinner", &opts, count_item_cb, pages_done_cb,
+        &state));
+    TEST_ASSERT_EQUAL_INT(0, gh_client_perform(client));
+    TEST_ASSERT_EQUAL_UINT(3, state.result.pages);
+    TEST_ASSERT_EQUAL_UINT(15, state.items);
+    TEST_ASSERT_EQUAL_UINT(state.items, state.result.items);
+
+    gh_client_destroy(client);
+}
+
 int
 main(void)
 {
@@ -227,9 +401,12 @@ main(void)
     RUN_TEST(test_gh_client_repo_releases_list_nonpaginated);
     RUN_TEST(test_gh_client_repo_releases_list_paginated);
     RUN_TEST(test_gh_client_repo_releases_latest);
+    RUN_TEST(test_gh_json_release_latest);
     RUN_TEST(test_gh_client_repo_release_by_id);
     RUN_TEST(test_gh_client_repo_release_assets_list);
     RUN_TEST(test_gh_client_repo_release_asset_get);
+    RUN_TEST(test_gh_client_repo_release_asset_download);
+    RUN_TEST(test_gh_client_graphql_repos);
     RUN_TEST(test_gh_client_repo_commits_list);
     RUN_TEST(test_gh_client_repo_commits_compare);
     RUN_TEST(test_gh_client_repo_pr_commits_list);
@@ -243,6 +420,9 @@ main(void)
     RUN_TEST(test_gh_client_user_blocked_list);
     RUN_TEST(test_gh_client_user_blocked_by_id);
     RUN_TEST(test_gh_client_user_followers_list);
+    RUN_TEST(test_gh_client_async_batch);
+    RUN_TEST(test_gh_client_cache_revalidate);
+    RUN_TEST(test_gh_client_paginate_releases);
 
     gh_client_free();
 
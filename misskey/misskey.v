@@ -98,6 +98,14 @@ fn C.misskey_error_str_detail(client &C.MisskeyClient, err int) charptr
 fn C.misskey_client_new_with_allocator(host charptr, allocator voidptr) &C.MisskeyClient
 fn C.misskey_client_get_allocator(client &C.MisskeyClient) voidptr
 fn C.misskey_request_print_curl(client &C.MisskeyClient, endpoint charptr, body charptr)
+
+pub type RequestCallback = fn (client &C.MisskeyClient, err int, response charptr, user_data voidptr)
+
+fn C.misskey_client_enable_async(client &C.MisskeyClient, max_connections int) int
+fn C.misskey_request_submit(client &C.MisskeyClient, endpoint charptr, body charptr, callback RequestCallback, user_data voidptr) int
+fn C.misskey_client_poll(client &C.MisskeyClient, timeout_ms int) int
+fn C.misskey_client_run(client &C.MisskeyClient) int
+fn C.misskey_client_pending(client &C.MisskeyClient) int
 fn C.misskey_client_get_last_error(client &C.MisskeyClient, http_code &int, error_detail &charptr)
 
 fn C.misskey_client_set_proxy(client &C.MisskeyClient, proxy &C.MisskeyProxy) int
@@ -476,6 +484,39 @@ fn (c &Client) do_request(endpoint string, body string) !string {
 	return result
 }
 
+// Async mode: requests run concurrently, the callback frees its response with C.misskey_free_string
+pub fn (c &Client) enable_async(max_connections int) ! {
+	ret := C.misskey_client_enable_async(c.c_client, max_connections)
+	if ret != 0 {
+		return error('${MisskeyError(ret).detailed(c)}')
+	}
+}
+
+pub fn (c &Client) submit(endpoint string, body string, callback RequestCallback, user_data voidptr) ! {
+	ret := C.misskey_request_submit(c.c_client, endpoint.str, body.str, callback, user_data)
+	if ret != 0 {
+		return error('${MisskeyError(ret).detailed(c)}')
+	}
+}
+
+pub fn (c &Client) poll(timeout_ms int) ! {
+	ret := C.misskey_client_poll(c.c_client, timeout_ms)
+	if ret != 0 {
+		return error('${MisskeyError(ret).detailed(c)}')
+	}
+}
+
+pub fn (c &Client) run() ! {
+	ret := C.misskey_client_run(c.c_client)
+	if ret != 0 {
+		return error('${MisskeyError(ret).detailed(c)}')
+	}
+}
+
+pub fn (c &Client) pending() int {
+	return C.misskey_client_pending(c.c_client)
+}
+
 pub fn (c &Client) meta_raw() !string {
 	return c.do_request('meta', '{"detail":false}')
 }
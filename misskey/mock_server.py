@@ -8,6 +8,7 @@ from flask import Flask, request, jsonify
 import json
 import random
 import string
+import time
 from datetime import datetime
 
 app = Flask(__name__)
@@ -577,6 +578,22 @@ def api_reactions():
     } for i in range(limit)]
     return jsonify(reactions)
 
+@app.route('/api/test/slow', methods=['POST'])
+def api_test_slow():
+    if not check_auth():
+        return jsonify({"error": "Authentication failed"}), 401
+    data = request.get_json() or {}
+    time.sleep(min(float(data.get('delay', 0.2)), 5.0))
+    return jsonify({"seq": data.get('seq', 0)})
+
+@app.route('/api/test/auth', methods=['POST'])
+def api_test_auth():
+    return jsonify({"authorization": request.headers.getlist('Authorization')})
+
+@app.route('/api/test/error', methods=['POST'])
+def api_test_error():
+    return jsonify({"error": "Internal server error"}), 500
+
 @app.route('/health', methods=['GET'])
 def health():
     return jsonify({"status": "ok", "token": TOKEN})
@@ -613,6 +630,9 @@ if __name__ == '__main__':
     print("  /api/drive/folders/delete")
     print("  /api/drive/folders/update")
     print("  /api/notes/translate")
+    print("  /api/test/slow               (async test)")
+    print("  /api/test/error              (async test)")
+    print("  /api/test/auth               (async test)")
     print("=" * 50)
     
     app.run(host='0.0.0.0', port=3000, debug=False)
@@ -0,0 +1,265 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "misskey_client.h"
+#include "cJSON/cJSON.h"
+
+static const char* host = "localhost:3000";
+static const char* token = "test_token_12345";
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+typedef struct {
+    int done;
+    int ok;
+    int http_errors;
+    long last_http_code;
+    int bad_seq;
+    int chain_left;
+} AsyncCounters;
+
+static int response_seq(const char* response) {
+    cJSON* json = cJSON_Parse(response);
+    if (!json) return -1;
+    cJSON* seq = cJSON_GetObjectItem(json, "seq");
+    int value = cJSON_IsNumber(seq) ? seq->valueint : -1;
+    cJSON_Delete(json);
+    return value;
+}
+
+typedef struct {
+    AsyncCounters* counters;
+    int seq;
+} SeqRequest;
+
+static void on_seq(MisskeyClient* client, MisskeyError err, char* response, void* user_data) {
+    SeqRequest* req = user_data;
+    AsyncCounters* c = req->counters;
+    c->done++;
+    if (err == MISSKEY_OK) {
+        c->ok++;
+        if (response_seq(response) != req->seq) c->bad_seq++;
+    } else if (err == MISSKEY_ERROR_HTTP) {
+        c->http_errors++;
+        misskey_client_get_last_error(client, &c->last_http_code, NULL);
+    }
+    if (response) misskey_free_string(client, response);
+}
+
+static MisskeyError submit_seq(MisskeyClient* client, SeqRequest* req, double delay) {
+    char body[64];
+    snprintf(body, sizeof(body), "{\"seq\":%d,\"delay\":%.2f}", req->seq, delay);
+    return misskey_request_submit(client, "test/slow", body, on_seq, req);
+}
+
+void test_concurrent_submits() {
+    printf("=== Test: 200 concurrent submits ===\n");
+
+    MisskeyClient* client = misskey_client_new(host);
+    misskey_client_set_token(client, token);
+    CHECK(misskey_client_enable_async(client, 8) == MISSKEY_OK);
+
+    AsyncCounters counters = {0};
+    SeqRequest reqs[200];
+    for (int i = 0; i < 200; i++) {
+        reqs[i].counters = &counters;
+        reqs[i].seq = i;
+        CHECK(submit_seq(client, &reqs[i], 0.01) == MISSKEY_OK);
+    }
+    CHECK(misskey_client_pending(client) == 200);
+    CHECK(misskey_client_run(client) == MISSKEY_OK);
+
+    printf("done = %d, ok = %d, bad seq = %d\n", counters.done, counters.ok, counters.bad_seq);
+    CHECK(counters.done == 200);
+    CHECK(counters.ok == 200);
+    CHECK(counters.bad_seq == 0);
+    CHECK(misskey_client_pending(client) == 0);
+
+    misskey_client_free(client);
+    printf("%s\n\n", failures ? "FAIL" : "PASS");
+}
+
+static void on_error(MisskeyClient* client, MisskeyError err, char* response, void* user_data) {
+    AsyncCounters* c = user_data;
+    c->done++;
+    if (err == MISSKEY_ERROR_HTTP) {
+        c->http_errors++;
+        char* detail = NULL;
+        misskey_client_get_last_error(client, &c->last_http_code, &detail);
+        printf("last error = %s\n", detail ? detail : "(null)");
+    }
+    CHECK(response == NULL);
+}
+
+void test_server_error() {
+    printf("=== Test: HTTP 500 ===\n");
+
+    MisskeyClient* client = misskey_client_new(host);
+    misskey_client_set_token(client, token);
+
+    AsyncCounters counters = {0};
+    CHECK(misskey_request_submit(client, "test/error", "{}", on_error, &counters) == MISSKEY_OK);
+    CHECK(misskey_client_run(client) == MISSKEY_OK);
+
+    printf("http errors = %d, http code = %ld\n", counters.http_errors, counters.last_http_code);
+    CHECK(counters.done == 1);
+    CHECK(counters.http_errors == 1);
+    CHECK(counters.last_http_code == 500);
+
+    misskey_client_free(client);
+    printf("%s\n\n", failures ? "FAIL" : "PASS");
+}
+
+static void on_chain(MisskeyClient* client, MisskeyError err, char* response, void* user_data) {
+    AsyncCounters* c = user_data;
+    c->done++;
+    if (err == MISSKEY_OK) c->ok++;
+    if (response) misskey_free_string(client, response);
+
+    // each completion queues the next request from inside the callback
+    if (c->chain_left > 0) {
+        c->chain_left--;
+        CHECK(misskey_request_submit(client, "meta", "{}", on_chain, c) == MISSKEY_OK);
+    }
+}
+
+void test_submit_from_callback() {
+    printf("=== Test: Submit from callback ===\n");
+
+    MisskeyClient* client = misskey_client_new(host);
+    misskey_client_set_token(client, token);
+
+    AsyncCounters counters = {0};
+    counters.chain_left = 20;
+    CHECK(misskey_request_submit(client, "meta", "{}", on_chain, &counters) == MISSKEY_OK);
+    CHECK(misskey_request_submit(client, "meta", "{}", on_chain, &counters) == MISSKEY_OK);
+    CHECK(misskey_client_run(client) == MISSKEY_OK);
+
+    printf("done = %d, ok = %d\n", counters.done, counters.ok);
+    CHECK(counters.done == 22);
+    CHECK(counters.ok == 22);
+    CHECK(misskey_client_pending(client) == 0);
+
+    misskey_client_free(client);
+    printf("%s\n\n", failures ? "FAIL" : "PASS");
+}
+
+typedef struct {
+    const char* expected;
+    int done;
+    int matched;
+} AuthRequest;
+
+// the server echoes every Authorization header it received
+static void on_auth(MisskeyClient* client, MisskeyError err, char* response, void* user_data) {
+    AuthRequest* req = user_data;
+    req->done++;
+    if (err != MISSKEY_OK) return;
+
+    cJSON* json = cJSON_Parse(response);
+    cJSON* auth = json ? cJSON_GetObjectItem(json, "authorization") : NULL;
+    cJSON* first = cJSON_GetArrayItem(auth, 0);
+    if (cJSON_GetArraySize(auth) == 1 && cJSON_IsString(first) &&
+        strcmp(first->valuestring, req->expected) == 0) {
+        req->matched++;
+    } else {
+        printf("expected [%s], got %s\n", req->expected, response);
+    }
+    cJSON_Delete(json);
+    misskey_free_string(client, response);
+}
+
+void test_token_change_in_flight() {
+    printf("=== Test: Token change while in flight ===\n");
+
+    MisskeyClient* client = misskey_client_new(host);
+    misskey_client_set_token(client, token);
+
+    AsyncCounters before = {0};
+    AsyncCounters after = {0};
+    SeqRequest reqs[20];
+    for (int i = 0; i < 10; i++) {
+        reqs[i].counters = &before;
+        reqs[i].seq = i;
+        CHECK(submit_seq(client, &reqs[i], 0.3) == MISSKEY_OK);
+    }
+    // let the first batch reach the server before the token changes
+    CHECK(misskey_client_poll(client, 100) == MISSKEY_OK);
+    CHECK(misskey_client_pending(client) == 10);
+
+    misskey_client_set_token(client, "wrong_token");
+    for (int i = 10; i < 20; i++) {
+        reqs[i].counters = &after;
+        reqs[i].seq = i;
+        CHECK(submit_seq(client, &reqs[i], 0.0) == MISSKEY_OK);
+    }
+    CHECK(misskey_client_run(client) == MISSKEY_OK);
+
+    printf("old token ok = %d, new token 401 = %d\n", before.ok, after.http_errors);
+    CHECK(before.done == 10);
+    CHECK(before.ok == 10);
+    CHECK(before.bad_seq == 0);
+    CHECK(after.done == 10);
+    CHECK(after.http_errors == 10);
+    CHECK(after.last_http_code == 401);
+
+    misskey_client_free(client);
+
+    // change the token twice while requests wait for the only connection;
+    // each must go out with exactly the token it was submitted with
+    client = misskey_client_new(host);
+    CHECK(misskey_client_enable_async(client, 1) == MISSKEY_OK);
+
+    AuthRequest auth_reqs[4] = {
+        {"Bearer token_a", 0, 0},
+        {"Bearer token_b", 0, 0},
+        {"Bearer token_b", 0, 0},
+        {"Bearer token_c", 0, 0},
+    };
+    misskey_client_set_token(client, "token_a");
+    CHECK(misskey_request_submit(client, "test/auth", "{}", on_auth, &auth_reqs[0]) == MISSKEY_OK);
+    misskey_client_set_token(client, "token_b");
+    CHECK(misskey_request_submit(client, "test/auth", "{}", on_auth, &auth_reqs[1]) == MISSKEY_OK);
+    CHECK(misskey_request_submit(client, "test/auth", "{}", on_auth, &auth_reqs[2]) == MISSKEY_OK);
+    misskey_client_set_token(client, "token_c");
+    CHECK(misskey_request_submit(client, "test/auth", "{}", on_auth, &auth_reqs[3]) == MISSKEY_OK);
+    CHECK(misskey_client_run(client) == MISSKEY_OK);
+
+    for (int i = 0; i < 4; i++) {
+        CHECK(auth_reqs[i].done == 1);
+        CHECK(auth_reqs[i].matched == 1);
+    }
+
+    misskey_client_free(client);
+    printf("%s\n\n", failures ? "FAIL" : "PASS");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) host = argv[1];
+    if (argc > 2 && argv[2][0]) token = argv[2];
+
+    printf("===========================================\n");
+    printf("  Async Tests - C API\n");
+    printf("===========================================\n\n");
+
+    test_concurrent_submits();
+    test_server_error();
+    test_submit_from_callback();
+    test_token_change_in_flight();
+
+    printf("===========================================\n");
+    if (failures) {
+        printf("  %d async checks failed\n", failures);
+    } else {
+        printf("  All async tests passed!\n");
+    }
+    printf("===========================================\n");
+
+    return failures ? 1 : 0;
+}
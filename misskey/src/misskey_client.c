@@ -98,6 +98,13 @@ static size_t write_callback(void* contents, size_t size, size_t nmemb, void* us
     return realsize;
 };
 
+// A request header list; lists replaced by set_token while requests still
+// use them are kept on their own node until the client goes idle.
+typedef struct MisskeyHeaders {
+    struct curl_slist* list;
+    struct MisskeyHeaders* next;
+} MisskeyHeaders;
+
 struct MisskeyClient {
     char host[256];
     char token[256];
@@ -109,8 +116,26 @@ struct MisskeyClient {
     char* last_error_detail;
     MisskeyProxy proxy;
     int proxy_enabled;
+    char base_url[300];
+    MisskeyHeaders* headers;
+    MisskeyHeaders* retired_headers;
+    CURLM* multi;
+    struct MisskeyTransfer* active;
+    struct MisskeyTransfer* idle;
+    int active_count;
 };
 
+// One pooled request. The easy handle stays with it between requests, so
+// its connection, TLS session and options carry over.
+typedef struct MisskeyTransfer {
+    CURL* easy;
+    WriteData wd;
+    MisskeyRequestCallback callback;
+    void* user_data;
+    struct MisskeyTransfer* prev;
+    struct MisskeyTransfer* next;
+} MisskeyTransfer;
+
 const char* misskey_error_str(MisskeyError err) {
     // Note: This function is kept for backwards compatibility
     // For detailed error messages, use misskey_client_get_last_error instead
@@ -170,6 +195,15 @@ const char* misskey_error_str_detail(MisskeyClient* client, MisskeyError err) {
     return err_buf;
 }
 
+static int host_uses_https(const char* host) {
+    if (strncmp(host, "localhost", 9) == 0 ||
+        strncmp(host, "127.0.0.1", 9) == 0 ||
+        strstr(host, "localhost:") != NULL) {
+        return 0;
+    }
+    return 1;
+}
+
 static MisskeyClient* client_new_internal(const char* host, const MisskeyAllocator* allocator) {
     curl_ensure_init();
     
@@ -185,6 +219,8 @@ static MisskeyClient* client_new_internal(const char* host, const MisskeyAllocat
     }
     
     strncpy(client->host, host ? host : "misskey.io", sizeof(client->host) - 1);
+    snprintf(client->base_url, sizeof(client->base_url), "%s://%s/api/",
+             host_uses_https(client->host) ? "https" : "http", client->host);
     client->timeout = 30;
     client->curl = curl_easy_init();
     memset(&client->proxy, 0, sizeof(MisskeyProxy));
@@ -201,18 +237,41 @@ MisskeyClient* misskey_client_new_with_allocator(const char* host, const Misskey
     return client_new_internal(host, allocator);
 }
 
+static void client_async_free(MisskeyClient* client);
+
+static void headers_free_all(MisskeyClient* client, MisskeyHeaders* headers) {
+    while (headers) {
+        MisskeyHeaders* next = headers->next;
+        curl_slist_free_all(headers->list);
+        free_allocator(&client->allocator, headers);
+        headers = next;
+    }
+}
+
 void misskey_client_free(MisskeyClient* client) {
     if (!client) return;
     if (client->last_error_detail) {
         free_allocator(&client->allocator, client->last_error_detail);
     }
     if (client->curl) curl_easy_cleanup(client->curl);
+    client_async_free(client);
+    headers_free_all(client, client->headers);
+    headers_free_all(client, client->retired_headers);
     free_allocator(&client->allocator, client);
 }
 
 void misskey_client_set_token(MisskeyClient* client, const char* token) {
     if (client && token) {
         strncpy(client->token, token, sizeof(client->token) - 1);
+        // in-flight requests still point at the old headers
+        if (client->headers && client->active_count == 0) {
+            headers_free_all(client, client->headers);
+            client->headers = NULL;
+        } else if (client->headers) {
+            client->headers->next = client->retired_headers;
+            client->retired_headers = client->headers;
+            client->headers = NULL;
+        }
     }
 }
 
@@ -356,18 +415,97 @@ static void apply_proxy_to_curl(CURL* curl, const MisskeyProxy* proxy) {
     }
 }
 
-MisskeyError misskey_request(MisskeyClient* client, const char* endpoint,
-                              const char* request_body, char** response_out) {
-    if (!client || !endpoint || !request_body || !response_out) {
-        return MISSKEY_ERROR_INVALID_PARAM;
-    }
+// Content-Type and Authorization are the same for every call, the list is
+// built once per token.
+static struct curl_slist* client_headers(MisskeyClient* client) {
+    if (client->headers) return client->headers->list;
     
+    struct curl_slist* headers = curl_slist_append(NULL, "Content-Type: application/json");
+    if (!headers) return NULL;
     
+    if (client->token[0] != '\0') {
+        char auth_header[320];
+        snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", client->token);
+        struct curl_slist* tail = curl_slist_append(headers, auth_header);
+        if (!tail) {
+            curl_slist_free_all(headers);
+            return NULL;
+        }
+        headers = tail;
+    }
+    
+    MisskeyHeaders* node = alloc_allocator(&client->allocator, sizeof(MisskeyHeaders));
+    if (!node) {
+        curl_slist_free_all(headers);
+        return NULL;
+    }
+    node->list = headers;
+    node->next = NULL;
+    client->headers = node;
+    return headers;
+}
+
+static void set_last_error(MisskeyClient* client, const char* detail) {
+    size_t err_len = strlen(detail) + 1;
+    client->last_error_detail = alloc_allocator(&client->allocator, err_len);
+    if (client->last_error_detail) {
+        memcpy(client->last_error_detail, detail, err_len);
+    }
+}
+
+static void clear_last_error(MisskeyClient* client) {
     client->last_http_code = 0;
     if (client->last_error_detail) {
         free_allocator(&client->allocator, client->last_error_detail);
         client->last_error_detail = NULL;
     }
+}
+
+// Turns a finished transfer into the result of a call. Takes wd->data, it
+// becomes *response_out on success and is freed otherwise.
+static MisskeyError request_finish(MisskeyClient* client, CURLcode res, long http_code,
+                                   WriteData* wd, char** response_out) {
+    *response_out = NULL;
+    
+    if (res != CURLE_OK) {
+        free(wd->data);
+        wd->data = NULL;
+        client->last_http_code = 0;
+        const char* err_str = curl_easy_strerror(res);
+        if (err_str) {
+            set_last_error(client, err_str);
+        }
+        return MISSKEY_ERROR_NETWORK;
+    }
+    
+    client->last_http_code = http_code;
+    
+    if (http_code >= 400) {
+        wd->data[wd->size] = '\0';
+        char err_buf[1024];
+        if (wd->size > 0) {
+            snprintf(err_buf, sizeof(err_buf), "HTTP %ld: %.*s", http_code, (int)(wd->size > 900 ? 900 : wd->size), wd->data);
+        } else {
+            snprintf(err_buf, sizeof(err_buf), "HTTP %ld", http_code);
+        }
+        set_last_error(client, err_buf);
+        free(wd->data);
+        wd->data = NULL;
+        return MISSKEY_ERROR_HTTP;
+    }
+    
+    *response_out = wd->data;
+    wd->data = NULL;
+    return MISSKEY_OK;
+}
+
+MisskeyError misskey_request(MisskeyClient* client, const char* endpoint,
+                              const char* request_body, char** response_out) {
+    if (!client || !endpoint || !request_body || !response_out) {
+        return MISSKEY_ERROR_INVALID_PARAM;
+    }
+    
+    clear_last_error(client);
     
     if (client->debug_curl) {
         misskey_request_print_curl(client, endpoint, request_body);
@@ -385,32 +523,14 @@ MisskeyError misskey_request(MisskeyClient* client, const char* endpoint,
     }
     
     char url[512];
-    int use_https = 1;
-    if (strncmp(client->host, "localhost", 9) == 0 || 
-        strncmp(client->host, "127.0.0.1", 9) == 0 ||
-        strstr(client->host, "localhost:") != NULL) {
-        use_https = 0;
-    }
-    snprintf(url, sizeof(url), "%s://%s/api/%s", 
-             use_https ? "https" : "http", client->host, endpoint);
+    snprintf(url, sizeof(url), "%s%s", client->base_url, endpoint);
     
-    struct curl_slist* headers = NULL;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
+    struct curl_slist* headers = client_headers(client);
     if (!headers) {
         free(wd.data);
         return MISSKEY_ERROR_ALLOC;
     }
     
-    if (client->token[0] && client->token[0] != '\0') {
-        char auth_header[320];
-        snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", client->token);
-        headers = curl_slist_append(headers, auth_header);
-        if (!headers) {
-            free(wd.data);
-            return MISSKEY_ERROR_ALLOC;
-        }
-    }
-    
     curl_easy_reset(client->curl);
     curl_easy_setopt(client->curl, CURLOPT_URL, url);
     curl_easy_setopt(client->curl, CURLOPT_POSTFIELDS, request_body);
@@ -418,11 +538,8 @@ MisskeyError misskey_request(MisskeyClient* client, const char* endpoint,
     curl_easy_setopt(client->curl, CURLOPT_WRITEFUNCTION, write_callback);
     curl_easy_setopt(client->curl, CURLOPT_WRITEDATA, &wd);
     curl_easy_setopt(client->curl, CURLOPT_TIMEOUT, client->timeout);
-    if (use_https) {
-        curl_easy_setopt(client->curl, CURLOPT_SSL_VERIFYPEER, 1L);
-    } else {
-        curl_easy_setopt(client->curl, CURLOPT_SSL_VERIFYPEER, 0L);
-    }
+    curl_easy_setopt(client->curl, CURLOPT_SSL_VERIFYPEER,
+                     strncmp(client->base_url, "https", 5) == 0 ? 1L : 0L);
     
     if (client->proxy_enabled) {
         apply_proxy_to_curl(client->curl, &client->proxy);
@@ -430,48 +547,209 @@ MisskeyError misskey_request(MisskeyClient* client, const char* endpoint,
     
     CURLcode res = curl_easy_perform(client->curl);
     
-    curl_slist_free_all(headers);
+    long http_code = 0;
+    curl_easy_getinfo(client->curl, CURLINFO_RESPONSE_CODE, &http_code);
     
-    if (res != CURLE_OK) {
-        free(wd.data);
-        client->last_http_code = 0;
-        const char* err_str = curl_easy_strerror(res);
-        if (err_str) {
-            size_t err_len = strlen(err_str) + 1;
-            client->last_error_detail = alloc_allocator(&client->allocator, err_len);
-            if (client->last_error_detail) {
-                memcpy(client->last_error_detail, err_str, err_len);
-            }
-        }
-        return MISSKEY_ERROR_NETWORK;
+    return request_finish(client, res, http_code, &wd, response_out);
+}
+
+MisskeyError misskey_client_enable_async(MisskeyClient* client, int max_connections) {
+    if (!client) return MISSKEY_ERROR_INVALID_PARAM;
+    if (client->multi) return MISSKEY_OK;
+    
+    client->multi = curl_multi_init();
+    if (!client->multi) return MISSKEY_ERROR_ALLOC;
+    
+    // over HTTP/2 all requests to the host share one connection as streams
+    curl_multi_setopt(client->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(client->multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                      (long)(max_connections > 0 ? max_connections : MISSKEY_ASYNC_DEFAULT_CONNECTIONS));
+    return MISSKEY_OK;
+}
+
+static MisskeyTransfer* transfer_acquire(MisskeyClient* client) {
+    MisskeyTransfer* t = client->idle;
+    if (t) {
+        client->idle = t->next;
+        t->next = NULL;
+        return t;
     }
     
-    long http_code = 0;
-    curl_easy_getinfo(client->curl, CURLINFO_RESPONSE_CODE, &http_code);
-    client->last_http_code = http_code;
+    t = alloc_allocator(&client->allocator, sizeof(MisskeyTransfer));
+    if (!t) return NULL;
+    memset(t, 0, sizeof(MisskeyTransfer));
     
-    if (http_code >= 400) {
-        wd.data[wd.size] = '\0';
-        char err_buf[1024];
-        if (wd.size > 0) {
-            snprintf(err_buf, sizeof(err_buf), "HTTP %ld: %.*s", http_code, (int)(wd.size > 900 ? 900 : wd.size), wd.data);
-        } else {
-            snprintf(err_buf, sizeof(err_buf), "HTTP %ld", http_code);
-        }
-        size_t err_len = strlen(err_buf) + 1;
-        client->last_error_detail = alloc_allocator(&client->allocator, err_len);
-        if (client->last_error_detail) {
-            memcpy(client->last_error_detail, err_buf, err_len);
+    t->easy = curl_easy_init();
+    if (!t->easy) {
+        free_allocator(&client->allocator, t);
+        return NULL;
+    }
+    
+    // options that never change are set once per handle
+    curl_easy_setopt(t->easy, CURLOPT_PRIVATE, t);
+    curl_easy_setopt(t->easy, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(t->easy, CURLOPT_WRITEDATA, &t->wd);
+    curl_easy_setopt(t->easy, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+    if (strncmp(client->base_url, "https", 5) == 0) {
+        // wait for the first connection's ALPN rather than opening more;
+        // plain HTTP stays on HTTP/1.1 and must not wait
+        curl_easy_setopt(t->easy, CURLOPT_PIPEWAIT, 1L);
+        curl_easy_setopt(t->easy, CURLOPT_SSL_VERIFYPEER, 1L);
+    } else {
+        curl_easy_setopt(t->easy, CURLOPT_SSL_VERIFYPEER, 0L);
+    }
+    return t;
+}
+
+static void transfer_release(MisskeyClient* client, MisskeyTransfer* t) {
+    if (t->prev) t->prev->next = t->next;
+    else client->active = t->next;
+    if (t->next) t->next->prev = t->prev;
+    client->active_count--;
+    
+    free(t->wd.data);
+    memset(&t->wd, 0, sizeof(WriteData));
+    t->callback = NULL;
+    t->user_data = NULL;
+    t->prev = NULL;
+    t->next = client->idle;
+    client->idle = t;
+    
+    if (client->active_count == 0 && client->retired_headers) {
+        headers_free_all(client, client->retired_headers);
+        client->retired_headers = NULL;
+    }
+}
+
+MisskeyError misskey_request_submit(MisskeyClient* client, const char* endpoint,
+                                    const char* request_body,
+                                    MisskeyRequestCallback callback, void* user_data) {
+    if (!client || !endpoint || !request_body || !callback) {
+        return MISSKEY_ERROR_INVALID_PARAM;
+    }
+    if (!client->multi) {
+        MisskeyError err = misskey_client_enable_async(client, 0);
+        if (err != MISSKEY_OK) return err;
+    }
+    
+    if (client->debug_curl) {
+        misskey_request_print_curl(client, endpoint, request_body);
+    }
+    
+    struct curl_slist* headers = client_headers(client);
+    if (!headers) return MISSKEY_ERROR_ALLOC;
+    
+    MisskeyTransfer* t = transfer_acquire(client);
+    if (!t) return MISSKEY_ERROR_ALLOC;
+    
+    t->wd.data = malloc(1);
+    t->wd.capacity = 1;
+    if (!t->wd.data) {
+        t->next = client->idle;
+        client->idle = t;
+        return MISSKEY_ERROR_ALLOC;
+    }
+    t->callback = callback;
+    t->user_data = user_data;
+    
+    char url[512];
+    snprintf(url, sizeof(url), "%s%s", client->base_url, endpoint);
+    curl_easy_setopt(t->easy, CURLOPT_URL, url);
+    curl_easy_setopt(t->easy, CURLOPT_COPYPOSTFIELDS, request_body);
+    curl_easy_setopt(t->easy, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(t->easy, CURLOPT_TIMEOUT, client->timeout);
+    if (client->proxy_enabled) {
+        apply_proxy_to_curl(t->easy, &client->proxy);
+    } else {
+        curl_easy_setopt(t->easy, CURLOPT_PROXY, NULL);
+    }
+    
+    t->next = client->active;
+    if (client->active) client->active->prev = t;
+    client->active = t;
+    client->active_count++;
+    
+    if (curl_multi_add_handle(client->multi, t->easy) != CURLM_OK) {
+        transfer_release(client, t);
+        return MISSKEY_ERROR_NETWORK;
+    }
+    return MISSKEY_OK;
+}
+
+int misskey_client_pending(const MisskeyClient* client) {
+    return client ? client->active_count : 0;
+}
+
+MisskeyError misskey_client_poll(MisskeyClient* client, int timeout_ms) {
+    if (!client || !client->multi) return MISSKEY_ERROR_INVALID_PARAM;
+    
+    int running = 0;
+    if (curl_multi_perform(client->multi, &running) != CURLM_OK) {
+        return MISSKEY_ERROR_NETWORK;
+    }
+    if (running > 0 && timeout_ms > 0) {
+        if (curl_multi_poll(client->multi, NULL, 0, timeout_ms, NULL) != CURLM_OK ||
+            curl_multi_perform(client->multi, &running) != CURLM_OK) {
+            return MISSKEY_ERROR_NETWORK;
         }
-        free(wd.data);
-        wd.data = NULL;
-        return MISSKEY_ERROR_HTTP;
     }
     
-    *response_out = wd.data;
+    CURLMsg* msg;
+    int queued;
+    while ((msg = curl_multi_info_read(client->multi, &queued))) {
+        if (msg->msg != CURLMSG_DONE) continue;
+        
+        CURL* easy = msg->easy_handle;
+        CURLcode res = msg->data.result;
+        MisskeyTransfer* t = NULL;
+        long http_code = 0;
+        curl_easy_getinfo(easy, CURLINFO_PRIVATE, (char**)&t);
+        curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &http_code);
+        curl_multi_remove_handle(client->multi, easy);
+        
+        MisskeyRequestCallback callback = t->callback;
+        void* user_data = t->user_data;
+        char* response = NULL;
+        
+        clear_last_error(client);
+        MisskeyError err = request_finish(client, res, http_code, &t->wd, &response);
+        // back in the pool first, the callback may submit the next request
+        transfer_release(client, t);
+        callback(client, err, response, user_data);
+    }
     return MISSKEY_OK;
 }
 
+MisskeyError misskey_client_run(MisskeyClient* client) {
+    if (!client || !client->multi) return MISSKEY_ERROR_INVALID_PARAM;
+    
+    while (client->active_count > 0) {
+        MisskeyError err = misskey_client_poll(client, 1000);
+        if (err != MISSKEY_OK) return err;
+    }
+    return MISSKEY_OK;
+}
+
+static void client_async_free(MisskeyClient* client) {
+    while (client->active) {
+        MisskeyTransfer* t = client->active;
+        client->active = t->next;
+        curl_multi_remove_handle(client->multi, t->easy);
+        curl_easy_cleanup(t->easy);
+        free(t->wd.data);
+        free_allocator(&client->allocator, t);
+    }
+    while (client->idle) {
+        MisskeyTransfer* t = client->idle;
+        client->idle = t->next;
+        curl_easy_cleanup(t->easy);
+        free_allocator(&client->allocator, t);
+    }
+    if (client->multi) curl_multi_cleanup(client->multi);
+    client->multi = NULL;
+    client->active_count = 0;
+}
+
 void misskey_client_get_last_error(MisskeyClient* client, long* http_code, char** error_detail) {
     if (!client) return;
     if (http_code) *http_code = client->last_http_code;
@@ -72,6 +72,25 @@ void misskey_request_print_curl(MisskeyClient* client, const char* endpoint,
 
 void misskey_free_string(MisskeyClient* client, char* str);
 
+// Async mode: requests run concurrently on a curl multi handle with pooled
+// easy handles, multiplexed over HTTP/2 when the server supports it.
+// response is owned by the callback (free with misskey_free_string) and is
+// NULL on error; misskey_client_get_last_error holds the details during the
+// callback. Callbacks run inside misskey_client_poll/misskey_client_run and
+// may submit further requests.
+#define MISSKEY_ASYNC_DEFAULT_CONNECTIONS 6
+
+typedef void (*MisskeyRequestCallback)(MisskeyClient* client, MisskeyError err,
+                                       char* response, void* user_data);
+
+MisskeyError misskey_client_enable_async(MisskeyClient* client, int max_connections);
+MisskeyError misskey_request_submit(MisskeyClient* client, const char* endpoint,
+                                    const char* request_body,
+                                    MisskeyRequestCallback callback, void* user_data);
+MisskeyError misskey_client_poll(MisskeyClient* client, int timeout_ms);
+MisskeyError misskey_client_run(MisskeyClient* client);
+int misskey_client_pending(const MisskeyClient* client);
+
 void misskey_set_global_allocator(const MisskeyAllocator* allocator);
 const MisskeyAllocator* misskey_get_default_allocator(void);
 
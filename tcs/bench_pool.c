@@ -0,0 +1,165 @@
+// TcsPool backend benchmark: many mostly idle loopback sockets, a few ready per wait.
+//
+// build: cc -O2 -o bench_pool bench_pool.c
+// run:   ./bench_pool [sockets=10000] [ready_per_wait=8] [rounds=2000]
+//
+// Every socket is a UDP receiver on 127.0.0.1, so one fd per socket.
+// Each round sends one datagram to ready_per_wait random sockets, then waits and drains them.
+// The poll() backend scans all sockets on each wait, epoll only the ready ones.
+
+#define TINYCSOCKET_IMPLEMENTATION
+#include "tinycsocket.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static const char* backend_name(TcsPoolBackend backend)
+{
+    switch (backend)
+    {
+        case TCS_POOL_BACKEND_POLL:
+            return "poll";
+        case TCS_POOL_BACKEND_EPOLL:
+            return "epoll";
+        case TCS_POOL_BACKEND_EPOLL_ET:
+            return "epoll-et";
+        default:
+            return "default";
+    }
+}
+
+static int run(TcsPoolBackend backend,
+               TcsSocket* sockets,
+               struct TcsAddress* addresses,
+               size_t socket_count,
+               TcsSocket sender,
+               size_t ready_per_wait,
+               size_t rounds)
+{
+    struct TcsPool* pool = NULL;
+    TcsResult res = tcs_pool_create_backend(&pool, backend);
+    if (res != TCS_SUCCESS)
+    {
+        printf("%-9s unavailable (%d)\n", backend_name(backend), res);
+        return 0;
+    }
+    for (size_t i = 0; i < socket_count; ++i)
+    {
+        res = tcs_pool_add(pool, sockets[i], &sockets[i], true, false, false);
+        if (res != TCS_SUCCESS)
+        {
+            printf("tcs_pool_add failed: %d\n", res);
+            tcs_pool_destroy(&pool);
+            return -1;
+        }
+    }
+
+    struct TcsPollEvent* events = (struct TcsPollEvent*)calloc(ready_per_wait, sizeof(struct TcsPollEvent));
+    uint8_t buf[64] = "ping";
+    int64_t wait_ns = 0;
+    size_t received = 0;
+    srand(1);
+
+    for (size_t r = 0; r < rounds; ++r)
+    {
+        for (size_t k = 0; k < ready_per_wait; ++k)
+        {
+            size_t idx = (size_t)rand() % socket_count;
+            tcs_send_to(sender, buf, 4, TCS_FLAG_NONE, &addresses[idx], NULL);
+        }
+
+        size_t pending = ready_per_wait;
+        while (pending > 0)
+        {
+            size_t populated = 0;
+            int64_t t0 = now_ns();
+            res = tcs_pool_poll(pool, events, ready_per_wait, &populated, 1000);
+            wait_ns += now_ns() - t0;
+            if (res != TCS_SUCCESS)
+                break;
+            for (size_t i = 0; i < populated; ++i)
+            {
+                // Drain until empty, required for edge-triggered and harmless for the others
+                size_t n = 0;
+                while (tcs_receive(events[i].socket, buf, sizeof buf, TCS_FLAG_NONE, &n) == TCS_SUCCESS)
+                {
+                    ++received;
+                    if (pending > 0)
+                        --pending;
+                }
+            }
+        }
+        if (res != TCS_SUCCESS)
+            break;
+    }
+
+    printf("%-9s sockets=%zu ready/wait=%zu rounds=%zu received=%zu avg wait=%.1f us\n",
+           backend_name(backend),
+           socket_count,
+           ready_per_wait,
+           rounds,
+           received,
+           (double)wait_ns / (double)rounds / 1000.0);
+
+    free(events);
+    tcs_pool_destroy(&pool);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    size_t socket_count = argc > 1 ? (size_t)atol(argv[1]) : 10000;
+    size_t ready_per_wait = argc > 2 ? (size_t)atol(argv[2]) : 8;
+    size_t rounds = argc > 3 ? (size_t)atol(argv[3]) : 2000;
+
+    struct rlimit lim;
+    if (getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur < socket_count + 16)
+    {
+        lim.rlim_cur = lim.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &lim);
+    }
+
+    tcs_lib_init();
+
+    TcsSocket* sockets = (TcsSocket*)malloc(socket_count * sizeof(TcsSocket));
+    struct TcsAddress* addresses = (struct TcsAddress*)malloc(socket_count * sizeof(struct TcsAddress));
+    struct TcsAddress loopback = TCS_ADDRESS_NONE;
+    tcs_address_parse("127.0.0.1:0", &loopback);
+    for (size_t i = 0; i < socket_count; ++i)
+    {
+        sockets[i] = TCS_SOCKET_INVALID;
+        if (tcs_socket_preset(&sockets[i], TCS_PRESET_UDP_IP4) != TCS_SUCCESS ||
+            tcs_bind(sockets[i], &loopback) != TCS_SUCCESS ||
+            tcs_address_socket_local(sockets[i], &addresses[i]) != TCS_SUCCESS)
+        {
+            printf("could only open %zu sockets, raise the fd limit\n", i);
+            socket_count = i;
+            break;
+        }
+        tcs_opt_nonblocking_set(sockets[i], true);
+    }
+
+    TcsSocket sender = TCS_SOCKET_INVALID;
+    tcs_socket_preset(&sender, TCS_PRESET_UDP_IP4);
+
+    TcsPoolBackend backends[] = {TCS_POOL_BACKEND_POLL, TCS_POOL_BACKEND_EPOLL, TCS_POOL_BACKEND_EPOLL_ET};
+    for (size_t b = 0; b < sizeof backends / sizeof backends[0]; ++b)
+        run(backends[b], sockets, addresses, socket_count, sender, ready_per_wait, rounds);
+
+    tcs_close(&sender);
+    for (size_t i = 0; i < socket_count; ++i)
+        tcs_close(&sockets[i]);
+    free(sockets);
+    free(addresses);
+    tcs_lib_free();
+    return 0;
+}
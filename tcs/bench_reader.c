@@ -0,0 +1,210 @@
+// Buffered reader benchmark: many small lines and netstrings over a loopback TCP connection.
+//
+// build: cc -O2 -pthread -o bench_reader bench_reader.c
+// run:   ./bench_reader [frames=500000] [reader_buffer=65536]
+//
+// A writer thread sends all frames in large chunks, the main thread reads them with:
+//   unbuffered  tcs_receive_line() / tcs_receive_netstring(), several receives per frame
+//   copy        tcs_reader_receive_line() / tcs_reader_receive_netstring()
+//   peek        tcs_reader_peek_line() / tcs_reader_peek_netstring() + tcs_reader_skip(), no copy
+// Every mode checks the frame count and a checksum of the payloads.
+
+#define TINYCSOCKET_IMPLEMENTATION
+#include "tinycsocket.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Connected loopback TCP pair
+static int tcp_pair(TcsSocket* client, TcsSocket* server)
+{
+    struct TcsAddress address = TCS_ADDRESS_NONE;
+    tcs_address_parse("127.0.0.1:0", &address);
+    TcsSocket listener = TCS_SOCKET_INVALID;
+    int ret = -1;
+    if (tcs_socket_preset(&listener, TCS_PRESET_TCP_IP4) == TCS_SUCCESS && tcs_bind(listener, &address) == TCS_SUCCESS &&
+        tcs_listen(listener, 1) == TCS_SUCCESS && tcs_address_socket_local(listener, &address) == TCS_SUCCESS &&
+        tcs_socket_preset(client, TCS_PRESET_TCP_IP4) == TCS_SUCCESS && tcs_connect(*client, &address) == TCS_SUCCESS &&
+        tcs_accept(listener, server, NULL) == TCS_SUCCESS)
+        ret = 0;
+    tcs_close(&listener);
+    return ret;
+}
+
+static uint64_t checksum(uint64_t sum, const uint8_t* data, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+        sum = sum * 31 + data[i];
+    return sum;
+}
+
+// Payload of frame i, 8 to 40 bytes, without delimiter or framing
+static size_t make_payload(size_t i, char* out)
+{
+    return (size_t)sprintf(out, "SET key:%zu %.*s", i, (int)(i % 24), "vvvvvvvvvvvvvvvvvvvvvvvv");
+}
+
+struct Stream
+{
+    uint8_t* data;
+    size_t size;
+    uint64_t sum;
+};
+
+static struct Stream build_stream(size_t frames, bool netstring)
+{
+    struct Stream stream = {NULL, 0, 0};
+    size_t capacity = frames * 64;
+    stream.data = (uint8_t*)malloc(capacity);
+    char payload[64];
+    for (size_t i = 0; i < frames; ++i)
+    {
+        size_t n = make_payload(i, payload);
+        if (netstring)
+            stream.size += (size_t)sprintf((char*)stream.data + stream.size, "%zu:%s,", n, payload);
+        else
+            stream.size += (size_t)sprintf((char*)stream.data + stream.size, "%s\n", payload);
+        stream.sum = checksum(stream.sum, (const uint8_t*)payload, n);
+    }
+    return stream;
+}
+
+struct Writer
+{
+    TcsSocket socket;
+    const struct Stream* stream;
+};
+
+static void* writer_thread(void* arg)
+{
+    struct Writer* writer = (struct Writer*)arg;
+    const size_t chunk = 256 * 1024;
+    for (size_t offset = 0; offset < writer->stream->size; offset += chunk)
+    {
+        size_t left = writer->stream->size - offset;
+        if (tcs_send(writer->socket, writer->stream->data + offset, left < chunk ? left : chunk, TCS_MSG_SENDALL, NULL) !=
+            TCS_SUCCESS)
+            break;
+    }
+    tcs_shutdown(writer->socket, TCS_SD_SEND);
+    return NULL;
+}
+
+enum Mode
+{
+    MODE_UNBUFFERED,
+    MODE_COPY,
+    MODE_PEEK,
+};
+
+static const char* mode_name(enum Mode mode)
+{
+    switch (mode)
+    {
+        case MODE_UNBUFFERED:
+            return "unbuffered";
+        case MODE_COPY:
+            return "copy";
+        case MODE_PEEK:
+            return "peek";
+        default:
+            return "?";
+    }
+}
+
+static void run(enum Mode mode, bool netstring, const struct Stream* stream, size_t frames, size_t reader_buffer)
+{
+    TcsSocket client = TCS_SOCKET_INVALID;
+    TcsSocket server = TCS_SOCKET_INVALID;
+    if (tcp_pair(&client, &server) != 0)
+    {
+        printf("could not connect over loopback\n");
+        return;
+    }
+    struct Writer writer = {client, stream};
+    pthread_t writer_id;
+
+    struct TcsReader* reader = NULL;
+    if (mode != MODE_UNBUFFERED)
+        tcs_reader_create(&reader, server, reader_buffer);
+
+    uint8_t buffer[128];
+    size_t count = 0;
+    uint64_t sum = 0;
+    TcsResult res = TCS_SUCCESS;
+    int64_t t0 = now_ns();
+    pthread_create(&writer_id, NULL, writer_thread, &writer);
+    while (res == TCS_SUCCESS)
+    {
+        const uint8_t* data = buffer;
+        size_t size = 0;
+        size_t frame_size = 0;
+        if (mode == MODE_UNBUFFERED && netstring)
+            res = tcs_receive_netstring(server, buffer, sizeof buffer, &size);
+        else if (mode == MODE_UNBUFFERED)
+            res = tcs_receive_line(server, buffer, sizeof buffer, &size, '\n');
+        else if (mode == MODE_COPY && netstring)
+            res = tcs_reader_receive_netstring(reader, buffer, sizeof buffer, &size);
+        else if (mode == MODE_COPY)
+            res = tcs_reader_receive_line(reader, buffer, sizeof buffer, &size, '\n');
+        else if (netstring)
+            res = tcs_reader_peek_netstring(reader, &data, &size, &frame_size);
+        else
+            res = tcs_reader_peek_line(reader, &data, &size, '\n');
+        if (res != TCS_SUCCESS)
+            break;
+
+        if (!netstring)
+            size -= 1; // Delimiter
+        sum = checksum(sum, data, size);
+        ++count;
+        if (mode == MODE_PEEK)
+            tcs_reader_skip(reader, netstring ? frame_size : size + 1);
+    }
+    int64_t elapsed = now_ns() - t0;
+    pthread_join(writer_id, NULL);
+
+    bool ok = res == TCS_SHUTDOWN && count == frames && sum == stream->sum;
+    printf("%-9s %-10s frames=%zu %.2f s %.0f kframes/s %s\n",
+           netstring ? "netstring" : "line",
+           mode_name(mode),
+           count,
+           (double)elapsed / 1e9,
+           (double)count / ((double)elapsed / 1e9) / 1000.0,
+           ok ? "ok" : "MISMATCH");
+
+    if (reader != NULL)
+        tcs_reader_destroy(&reader);
+    tcs_close(&client);
+    tcs_close(&server);
+}
+
+int main(int argc, char** argv)
+{
+    size_t frames = argc > 1 ? (size_t)atol(argv[1]) : 500000;
+    size_t reader_buffer = argc > 2 ? (size_t)atol(argv[2]) : 65536;
+
+    tcs_lib_init();
+    struct Stream lines = build_stream(frames, false);
+    struct Stream netstrings = build_stream(frames, true);
+
+    enum Mode modes[] = {MODE_UNBUFFERED, MODE_COPY, MODE_PEEK};
+    for (size_t m = 0; m < sizeof modes / sizeof modes[0]; ++m)
+        run(modes[m], false, &lines, frames, reader_buffer);
+    for (size_t m = 0; m < sizeof modes / sizeof modes[0]; ++m)
+        run(modes[m], true, &netstrings, frames, reader_buffer);
+
+    free(lines.data);
+    free(netstrings.data);
+    tcs_lib_free();
+    return 0;
+}
@@ -0,0 +1,228 @@
+// Server runtime benchmark: connection storm and request/response load against tcs_server with 1 and N workers.
+//
+// build: cc -O2 -pthread -o bench_server bench_server.c
+// run:   ./bench_server [client_threads=4] [connections=20000] [requests=200000] [workers=0]
+//
+// storm    every client thread connects, sends one request, reads the reply and closes, as fast as it can
+// echo     every client thread keeps 8 connections open and sends requests round robin over them
+// drain    tcs_server_stop() is called while clients still have connections open, they must all get their reply
+// workers=0 runs with one worker per CPU, the single worker run is always done first for comparison.
+
+#define TINYCSOCKET_IMPLEMENTATION
+#include "tinycsocket.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+#define REQUEST_SIZE 64
+#define CONNECTIONS_PER_CLIENT 8
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static bool on_readable(struct TcsServer* server, struct TcsServerConnection* connection)
+{
+    (void)server;
+    uint8_t buffer[4096];
+    size_t received = 0;
+    if (tcs_receive(connection->socket, buffer, sizeof buffer, TCS_FLAG_NONE, &received) != TCS_SUCCESS)
+        return false;
+    return tcs_send(connection->socket, buffer, received, TCS_MSG_SENDALL, NULL) == TCS_SUCCESS;
+}
+
+struct Client
+{
+    struct TcsAddress address;
+    size_t connections;
+    size_t requests;
+    size_t completed;
+    size_t failed;
+};
+
+static bool request(TcsSocket socket_ctx)
+{
+    uint8_t buffer[REQUEST_SIZE];
+    memset(buffer, 'r', sizeof buffer);
+    size_t received = 0;
+    return tcs_send(socket_ctx, buffer, sizeof buffer, TCS_MSG_SENDALL, NULL) == TCS_SUCCESS &&
+           tcs_receive(socket_ctx, buffer, sizeof buffer, TCS_MSG_WAITALL, &received) == TCS_SUCCESS &&
+           received == sizeof buffer;
+}
+
+static void* storm_thread(void* arg)
+{
+    struct Client* client = (struct Client*)arg;
+    for (size_t i = 0; i < client->connections; ++i)
+    {
+        TcsSocket socket_ctx = TCS_SOCKET_INVALID;
+        if (tcs_socket_preset(&socket_ctx, TCS_PRESET_TCP_IP4) == TCS_SUCCESS &&
+            tcs_connect(socket_ctx, &client->address) == TCS_SUCCESS && request(socket_ctx))
+            client->completed++;
+        else
+            client->failed++;
+        // Linger 0 sends a reset, so the client side does not fill up TIME_WAIT and run out of ports
+        tcs_opt_linger_set(socket_ctx, true, 0);
+        tcs_close(&socket_ctx);
+    }
+    return NULL;
+}
+
+static void* echo_thread(void* arg)
+{
+    struct Client* client = (struct Client*)arg;
+    TcsSocket sockets[CONNECTIONS_PER_CLIENT];
+    for (size_t i = 0; i < CONNECTIONS_PER_CLIENT; ++i)
+    {
+        sockets[i] = TCS_SOCKET_INVALID;
+        if (tcs_socket_preset(&sockets[i], TCS_PRESET_TCP_IP4) != TCS_SUCCESS ||
+            tcs_connect(sockets[i], &client->address) != TCS_SUCCESS)
+            tcs_close(&sockets[i]);
+    }
+    for (size_t i = 0; i < client->requests; ++i)
+    {
+        TcsSocket socket_ctx = sockets[i % CONNECTIONS_PER_CLIENT];
+        if (socket_ctx != TCS_SOCKET_INVALID && request(socket_ctx))
+            client->completed++;
+        else
+            client->failed++;
+    }
+    for (size_t i = 0; i < CONNECTIONS_PER_CLIENT; ++i)
+        tcs_close(&sockets[i]);
+    return NULL;
+}
+
+static void run(const char* name,
+                void* (*thread)(void*),
+                unsigned int workers,
+                size_t client_threads,
+                size_t connections,
+                size_t requests)
+{
+    struct TcsServerConfig config = TCS_SERVER_CONFIG_DEFAULT;
+    tcs_address_parse("127.0.0.1:0", &config.address);
+    config.worker_count = workers;
+    struct TcsServerCallbacks callbacks = {NULL, on_readable, NULL};
+    struct TcsServer* server = NULL;
+    if (tcs_server_create(&server, &config, &callbacks, NULL) != TCS_SUCCESS || tcs_server_start(server) != TCS_SUCCESS)
+    {
+        printf("%-6s could not start the server\n", name);
+        tcs_server_destroy(&server);
+        return;
+    }
+
+    struct Client* clients = (struct Client*)calloc(client_threads, sizeof(struct Client));
+    pthread_t* ids = (pthread_t*)calloc(client_threads, sizeof(pthread_t));
+    for (size_t i = 0; i < client_threads; ++i)
+    {
+        tcs_server_address(server, &clients[i].address);
+        clients[i].connections = connections / client_threads;
+        clients[i].requests = requests / client_threads;
+    }
+
+    int64_t t0 = now_ns();
+    for (size_t i = 0; i < client_threads; ++i)
+        pthread_create(&ids[i], NULL, thread, &clients[i]);
+    for (size_t i = 0; i < client_threads; ++i)
+        pthread_join(ids[i], NULL);
+    int64_t elapsed = now_ns() - t0;
+
+    size_t completed = 0;
+    size_t failed = 0;
+    for (size_t i = 0; i < client_threads; ++i)
+    {
+        completed += clients[i].completed;
+        failed += clients[i].failed;
+    }
+    char worker_text[16];
+    snprintf(worker_text, sizeof worker_text, workers == 0 ? "cpu" : "%u", workers);
+    printf("%-6s workers=%-3s completed=%zu failed=%zu %.2f s %.0f ops/s\n",
+           name,
+           worker_text,
+           completed,
+           failed,
+           (double)elapsed / 1e9,
+           (double)completed / ((double)elapsed / 1e9));
+
+    tcs_server_stop(server, 1000);
+    tcs_server_destroy(&server);
+    free(ids);
+    free(clients);
+}
+
+// Clients with open connections get their replies while the server drains, then the server closes them
+static void run_drain(size_t client_threads)
+{
+    struct TcsServerConfig config = TCS_SERVER_CONFIG_DEFAULT;
+    tcs_address_parse("127.0.0.1:0", &config.address);
+    struct TcsServerCallbacks callbacks = {NULL, on_readable, NULL};
+    struct TcsServer* server = NULL;
+    if (tcs_server_create(&server, &config, &callbacks, NULL) != TCS_SUCCESS || tcs_server_start(server) != TCS_SUCCESS)
+    {
+        printf("drain  could not start the server\n");
+        tcs_server_destroy(&server);
+        return;
+    }
+
+    struct Client* clients = (struct Client*)calloc(client_threads, sizeof(struct Client));
+    pthread_t* ids = (pthread_t*)calloc(client_threads, sizeof(pthread_t));
+    for (size_t i = 0; i < client_threads; ++i)
+    {
+        tcs_server_address(server, &clients[i].address);
+        clients[i].requests = 20000;
+        pthread_create(&ids[i], NULL, echo_thread, &clients[i]);
+    }
+    // Let the clients connect and get going before stopping
+    while (tcs_server_connection_count(server) < client_threads * CONNECTIONS_PER_CLIENT)
+    {
+        struct timespec pause = {0, 1000000};
+        nanosleep(&pause, NULL);
+    }
+
+    int64_t t0 = now_ns();
+    tcs_server_stop(server, 60000); // The clients close their connections when done
+    int64_t elapsed = now_ns() - t0;
+    for (size_t i = 0; i < client_threads; ++i)
+        pthread_join(ids[i], NULL);
+
+    size_t completed = 0;
+    size_t failed = 0;
+    for (size_t i = 0; i < client_threads; ++i)
+    {
+        completed += clients[i].completed;
+        failed += clients[i].failed;
+    }
+    printf("drain  completed=%zu failed=%zu stop took %.2f s %s\n",
+           completed,
+           failed,
+           (double)elapsed / 1e9,
+           failed == 0 ? "ok" : "DROPPED");
+
+    tcs_server_destroy(&server);
+    free(ids);
+    free(clients);
+}
+
+int main(int argc, char** argv)
+{
+    size_t client_threads = argc > 1 ? (size_t)atol(argv[1]) : 4;
+    size_t connections = argc > 2 ? (size_t)atol(argv[2]) : 20000;
+    size_t requests = argc > 3 ? (size_t)atol(argv[3]) : 200000;
+    unsigned int workers = argc > 4 ? (unsigned int)atoi(argv[4]) : 0;
+    if (client_threads == 0)
+        client_threads = 1;
+
+    tcs_lib_init();
+    run("storm", storm_thread, 1, client_threads, connections, requests);
+    run("storm", storm_thread, workers, client_threads, connections, requests);
+    run("echo", echo_thread, 1, client_threads, connections, requests);
+    run("echo", echo_thread, workers, client_threads, connections, requests);
+    run_drain(client_threads);
+    tcs_lib_free();
+    return 0;
+}
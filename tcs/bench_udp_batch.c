@@ -0,0 +1,222 @@
+// Batched UDP benchmark: one datagram per syscall vs sendmmsg/recvmmsg vs GSO/GRO over loopback.
+//
+// build: cc -O2 -o bench_udp_batch bench_udp_batch.c
+// run:   ./bench_udp_batch [datagrams=200000] [payload=1200] [batch=32]
+//
+// The sender pushes datagrams in bursts of at most the receive buffer size,
+// the receiver drains each burst before the next one is sent, so no datagrams are dropped.
+// With GSO one send carries a whole batch as one super datagram that the kernel splits into payload sized segments,
+// with GRO the receiver may get them merged back, segment_size tells the size of each segment.
+
+#define TINYCSOCKET_IMPLEMENTATION
+#include "tinycsocket.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+enum Mode
+{
+    MODE_SINGLE,
+    MODE_BATCH,
+    MODE_GSO,
+};
+
+static const char* mode_name(enum Mode mode)
+{
+    switch (mode)
+    {
+        case MODE_SINGLE:
+            return "single";
+        case MODE_BATCH:
+            return "mmsg";
+        case MODE_GSO:
+            return "gso/gro";
+        default:
+            return "?";
+    }
+}
+
+struct Stats
+{
+    size_t datagrams;
+    size_t bytes;
+    size_t send_calls;
+    size_t receive_calls;
+};
+
+// Receives until burst payload sized datagrams have arrived, or the socket times out
+static TcsResult drain(enum Mode mode,
+                       TcsSocket receiver,
+                       struct TcsDatagram* datagrams,
+                       size_t batch,
+                       size_t payload,
+                       size_t burst,
+                       struct Stats* stats)
+{
+    size_t got = 0;
+    while (got < burst)
+    {
+        if (mode == MODE_SINGLE)
+        {
+            size_t n = 0;
+            TcsResult res = tcs_receive(receiver, datagrams[0].data, datagrams[0].capacity, TCS_FLAG_NONE, &n);
+            if (res != TCS_SUCCESS)
+                return res;
+            ++stats->receive_calls;
+            stats->bytes += n;
+            ++got;
+            continue;
+        }
+        size_t received = 0;
+        TcsResult res = tcs_receive_from_batch(receiver, datagrams, batch, TCS_FLAG_NONE, &received);
+        if (res != TCS_SUCCESS)
+            return res;
+        ++stats->receive_calls;
+        for (size_t i = 0; i < received; ++i)
+        {
+            stats->bytes += datagrams[i].size;
+            // A GRO merged datagram contains several segments
+            got += datagrams[i].segment_size > 0 ? (datagrams[i].size + payload - 1) / payload : 1;
+        }
+    }
+    stats->datagrams += got;
+    return TCS_SUCCESS;
+}
+
+static int run(enum Mode mode, size_t total, size_t payload, size_t batch)
+{
+    struct TcsAddress loopback = TCS_ADDRESS_NONE;
+    tcs_address_parse("127.0.0.1:0", &loopback);
+
+    TcsSocket receiver = TCS_SOCKET_INVALID;
+    TcsSocket sender = TCS_SOCKET_INVALID;
+    struct TcsAddress destination = TCS_ADDRESS_NONE;
+    if (tcs_socket_preset(&receiver, TCS_PRESET_UDP_IP4) != TCS_SUCCESS ||
+        tcs_bind(receiver, &loopback) != TCS_SUCCESS ||
+        tcs_address_socket_local(receiver, &destination) != TCS_SUCCESS ||
+        tcs_socket_preset(&sender, TCS_PRESET_UDP_IP4) != TCS_SUCCESS)
+    {
+        printf("could not create sockets\n");
+        return -1;
+    }
+    tcs_opt_receive_buffer_size_set(receiver, 4 * 1024 * 1024);
+    tcs_opt_receive_timeout_set(receiver, 1000);
+
+    if (mode == MODE_GSO && tcs_opt_udp_gro_set(receiver, true) != TCS_SUCCESS)
+    {
+        printf("%-8s unavailable\n", mode_name(mode));
+        tcs_close(&sender);
+        tcs_close(&receiver);
+        return 0;
+    }
+
+    // GRO may merge up to 64 KiB into one datagram
+    size_t capacity = mode == MODE_GSO ? 65536 : payload;
+    uint8_t* memory = (uint8_t*)calloc(batch, capacity);
+    struct TcsDatagram* datagrams = (struct TcsDatagram*)calloc(batch, sizeof(struct TcsDatagram));
+    for (size_t i = 0; i < batch; ++i)
+    {
+        datagrams[i].data = memory + i * capacity;
+        datagrams[i].capacity = capacity;
+    }
+
+    // Keep each burst well below the receive buffer, the loopback truesize overhead is large
+    size_t burst = 1024;
+    struct Stats stats = {0, 0, 0, 0};
+    TcsResult res = TCS_SUCCESS;
+    int64_t t0 = now_ns();
+    size_t sent = 0;
+    while (sent < total && res == TCS_SUCCESS)
+    {
+        size_t this_burst = total - sent < burst ? total - sent : burst;
+        size_t burst_sent = 0;
+        while (burst_sent < this_burst && res == TCS_SUCCESS)
+        {
+            size_t left = this_burst - burst_sent;
+            if (mode == MODE_SINGLE)
+            {
+                res = tcs_send_to(sender, memory, payload, TCS_FLAG_NONE, &destination, NULL);
+                ++stats.send_calls;
+                ++burst_sent;
+            }
+            else if (mode == MODE_BATCH)
+            {
+                size_t count = left < batch ? left : batch;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    datagrams[i].size = payload;
+                    datagrams[i].address = destination;
+                    datagrams[i].segment_size = 0;
+                }
+                size_t n = 0;
+                res = tcs_send_to_batch(sender, datagrams, count, TCS_FLAG_NONE, &n);
+                ++stats.send_calls;
+                burst_sent += n;
+            }
+            else
+            {
+                // One super datagram of up to 64 KiB, split by the kernel into payload sized segments,
+                // the kernel allows at most 64 segments per send
+                size_t segments = 65507 / payload;
+                segments = segments > 64 ? 64 : segments;
+                segments = segments > left ? left : segments;
+                datagrams[0].size = segments * payload;
+                datagrams[0].address = destination;
+                datagrams[0].segment_size = (uint16_t)payload;
+                size_t n = 0;
+                res = tcs_send_to_batch(sender, datagrams, 1, TCS_FLAG_NONE, &n);
+                ++stats.send_calls;
+                burst_sent += segments;
+            }
+        }
+        if (res != TCS_SUCCESS)
+            break;
+        sent += burst_sent;
+        res = drain(mode, receiver, datagrams, batch, payload, burst_sent, &stats);
+    }
+    int64_t elapsed = now_ns() - t0;
+
+    if (res != TCS_SUCCESS)
+        printf("%-8s failed with %d after %zu datagrams\n", mode_name(mode), res, stats.datagrams);
+    else
+        printf("%-8s datagrams=%zu payload=%zu send calls=%zu receive calls=%zu %.0f kpps %.1f MB/s\n",
+               mode_name(mode),
+               stats.datagrams,
+               payload,
+               stats.send_calls,
+               stats.receive_calls,
+               (double)stats.datagrams / ((double)elapsed / 1e9) / 1000.0,
+               (double)stats.bytes / ((double)elapsed / 1e9) / 1e6);
+
+    free(datagrams);
+    free(memory);
+    tcs_close(&sender);
+    tcs_close(&receiver);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    size_t total = argc > 1 ? (size_t)atol(argv[1]) : 200000;
+    size_t payload = argc > 2 ? (size_t)atol(argv[2]) : 1200;
+    size_t batch = argc > 3 ? (size_t)atol(argv[3]) : 32;
+    if (batch > TCS_DATAGRAM_BATCH_MAX)
+        batch = TCS_DATAGRAM_BATCH_MAX;
+    if (payload == 0 || payload > 65507)
+        payload = 1200;
+
+    tcs_lib_init();
+    run(MODE_SINGLE, total, payload, batch);
+    run(MODE_BATCH, total, payload, batch);
+    run(MODE_GSO, total, payload, batch);
+    tcs_lib_free();
+    return 0;
+}
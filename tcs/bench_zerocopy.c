@@ -0,0 +1,364 @@
+// Zero-copy benchmark: move a large file over a loopback TCP connection.
+//
+// build: cc -O2 -pthread -o bench_zerocopy bench_zerocopy.c
+// run:   ./bench_zerocopy [file=/tmp/tcs_bench_zerocopy.bin] [size_mb=2048]
+//
+// The file is created (and filled) if it does not exist or is too small, it is read once first
+// so every mode sends from the page cache. A sink thread drains the receiving end.
+//
+// send modes, file -> socket:
+//   copy      read() into a buffer and tcs_send() it
+//   sendfile  tcs_sendfile(), pages go from the page cache to the socket
+//   zerocopy  tcs_send_zerocopy() from an mmap of the file, loopback makes the kernel copy anyway
+//             (was_copied is reported), a real NIC does not
+// relay modes, socket -> socket, the source is fed with tcs_sendfile():
+//   relay-copy    tcs_receive() + tcs_send()
+//   relay-splice  tcs_splice()
+
+#define TINYCSOCKET_IMPLEMENTATION
+#include "tinycsocket.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define CHUNK_SIZE (256 * 1024)
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Connected loopback TCP pair
+static int tcp_pair(TcsSocket* client, TcsSocket* server)
+{
+    struct TcsAddress address = TCS_ADDRESS_NONE;
+    tcs_address_parse("127.0.0.1:0", &address);
+    TcsSocket listener = TCS_SOCKET_INVALID;
+    int ret = -1;
+    if (tcs_socket_preset(&listener, TCS_PRESET_TCP_IP4) == TCS_SUCCESS && tcs_bind(listener, &address) == TCS_SUCCESS &&
+        tcs_listen(listener, 1) == TCS_SUCCESS && tcs_address_socket_local(listener, &address) == TCS_SUCCESS &&
+        tcs_socket_preset(client, TCS_PRESET_TCP_IP4) == TCS_SUCCESS && tcs_connect(*client, &address) == TCS_SUCCESS &&
+        tcs_accept(listener, server, NULL) == TCS_SUCCESS)
+        ret = 0;
+    tcs_close(&listener);
+    return ret;
+}
+
+struct Sink
+{
+    TcsSocket socket;
+    uint64_t bytes;
+};
+
+static void* sink_thread(void* arg)
+{
+    struct Sink* sink = (struct Sink*)arg;
+    uint8_t* buffer = (uint8_t*)malloc(CHUNK_SIZE);
+    size_t received = 0;
+    while (tcs_receive(sink->socket, buffer, CHUNK_SIZE, TCS_FLAG_NONE, &received) == TCS_SUCCESS)
+        sink->bytes += received;
+    free(buffer);
+    return NULL;
+}
+
+struct Feeder
+{
+    TcsSocket socket;
+    int file;
+    uint64_t size;
+};
+
+static void* feeder_thread(void* arg)
+{
+    struct Feeder* feeder = (struct Feeder*)arg;
+    int64_t offset = 0;
+    tcs_sendfile(feeder->socket, feeder->file, &offset, (size_t)feeder->size, TCS_MSG_SENDALL, NULL);
+    tcs_shutdown(feeder->socket, TCS_SD_SEND);
+    return NULL;
+}
+
+static TcsResult send_copy(TcsSocket socket_ctx, int file, uint64_t size)
+{
+    uint8_t* buffer = (uint8_t*)malloc(CHUNK_SIZE);
+    TcsResult res = TCS_SUCCESS;
+    uint64_t left = size;
+    while (left > 0 && res == TCS_SUCCESS)
+    {
+        ssize_t n = pread(file, buffer, left < CHUNK_SIZE ? (size_t)left : CHUNK_SIZE, (off_t)(size - left));
+        if (n <= 0)
+            break;
+        res = tcs_send(socket_ctx, buffer, (size_t)n, TCS_MSG_SENDALL, NULL);
+        left -= (uint64_t)n;
+    }
+    free(buffer);
+    return res;
+}
+
+static TcsResult send_file(TcsSocket socket_ctx, int file, uint64_t size)
+{
+    int64_t offset = 0;
+    return tcs_sendfile(socket_ctx, file, &offset, (size_t)size, TCS_MSG_SENDALL, NULL);
+}
+
+static TcsResult send_zerocopy(TcsSocket socket_ctx, int file, uint64_t size, uint64_t* copied_notifications)
+{
+    TcsResult res = tcs_opt_zerocopy_set(socket_ctx, true);
+    if (res != TCS_SUCCESS)
+        return res;
+    uint8_t* memory = (uint8_t*)mmap(NULL, (size_t)size, PROT_READ, MAP_SHARED, file, 0);
+    if (memory == MAP_FAILED)
+        return TCS_ERROR_MEMORY;
+
+    uint32_t next_id = 0;  // id of the next successful send
+    uint32_t completed = 0; // all ids below are completed
+    uint64_t offset = 0;
+    while (res == TCS_SUCCESS && (offset < size || completed != next_id))
+    {
+        uint32_t first = 0;
+        uint32_t last = 0;
+        bool copied = false;
+        while (tcs_zerocopy_completions(socket_ctx, &first, &last, &copied) == TCS_SUCCESS)
+        {
+            // Completions arrive in order over TCP
+            completed = last + 1;
+            if (copied)
+                *copied_notifications += 1;
+        }
+        if (offset >= size)
+        {
+            // Only notifications left, they show up as an error event
+            struct pollfd pfd = {socket_ctx, 0, 0};
+            poll(&pfd, 1, 100);
+            continue;
+        }
+        size_t chunk = size - offset < CHUNK_SIZE ? (size_t)(size - offset) : CHUNK_SIZE;
+        size_t sent = 0;
+        res = tcs_send_zerocopy(socket_ctx, memory + offset, chunk, TCS_FLAG_NONE, &sent);
+        if (res == TCS_ERROR_MEMORY) // Too much pinned, wait for completions
+        {
+            struct pollfd pfd = {socket_ctx, 0, 0};
+            poll(&pfd, 1, 100);
+            res = TCS_SUCCESS;
+            continue;
+        }
+        if (res == TCS_SUCCESS)
+        {
+            offset += sent;
+            ++next_id;
+        }
+    }
+    munmap(memory, (size_t)size);
+    return res;
+}
+
+static TcsResult relay_copy(TcsSocket from, TcsSocket to)
+{
+    uint8_t* buffer = (uint8_t*)malloc(CHUNK_SIZE);
+    size_t received = 0;
+    TcsResult res = TCS_SUCCESS;
+    while ((res = tcs_receive(from, buffer, CHUNK_SIZE, TCS_FLAG_NONE, &received)) == TCS_SUCCESS)
+    {
+        res = tcs_send(to, buffer, received, TCS_MSG_SENDALL, NULL);
+        if (res != TCS_SUCCESS)
+            break;
+    }
+    free(buffer);
+    return res == TCS_SHUTDOWN ? TCS_SUCCESS : res;
+}
+
+static TcsResult relay_splice(TcsSocket from, TcsSocket to)
+{
+    struct TcsSplice* splice = NULL;
+    TcsResult res = tcs_splice_create(&splice);
+    if (res != TCS_SUCCESS)
+        return res;
+    size_t moved = 0;
+    while ((res = tcs_splice(splice, from, to, 1024 * 1024, TCS_FLAG_NONE, &moved)) == TCS_SUCCESS)
+        ;
+    tcs_splice_destroy(&splice);
+    return res == TCS_SHUTDOWN ? TCS_SUCCESS : res;
+}
+
+enum Mode
+{
+    MODE_COPY,
+    MODE_SENDFILE,
+    MODE_ZEROCOPY,
+    MODE_RELAY_COPY,
+    MODE_RELAY_SPLICE,
+};
+
+static const char* mode_name(enum Mode mode)
+{
+    switch (mode)
+    {
+        case MODE_COPY:
+            return "copy";
+        case MODE_SENDFILE:
+            return "sendfile";
+        case MODE_ZEROCOPY:
+            return "zerocopy";
+        case MODE_RELAY_COPY:
+            return "relay-copy";
+        case MODE_RELAY_SPLICE:
+            return "relay-splice";
+        default:
+            return "?";
+    }
+}
+
+static int run(enum Mode mode, int file, uint64_t size)
+{
+    TcsSocket client = TCS_SOCKET_INVALID;
+    TcsSocket server = TCS_SOCKET_INVALID;
+    if (tcp_pair(&client, &server) != 0)
+    {
+        printf("could not connect over loopback\n");
+        return -1;
+    }
+
+    struct Sink sink = {server, 0};
+    pthread_t sink_id;
+    pthread_create(&sink_id, NULL, sink_thread, &sink);
+
+    // Relay modes: feeder -> relay_in ... relay_out -> client -> sink
+    TcsSocket relay_in = TCS_SOCKET_INVALID;
+    TcsSocket feeder_socket = TCS_SOCKET_INVALID;
+    pthread_t feeder_id;
+    struct Feeder feeder = {TCS_SOCKET_INVALID, file, size};
+    bool relay = mode == MODE_RELAY_COPY || mode == MODE_RELAY_SPLICE;
+    if (relay && tcp_pair(&feeder_socket, &relay_in) != 0)
+    {
+        printf("could not connect over loopback\n");
+        return -1;
+    }
+
+    uint64_t copied_notifications = 0;
+    int64_t t0 = now_ns();
+    if (relay)
+    {
+        feeder.socket = feeder_socket;
+        pthread_create(&feeder_id, NULL, feeder_thread, &feeder);
+    }
+
+    TcsResult res = TCS_SUCCESS;
+    switch (mode)
+    {
+        case MODE_COPY:
+            res = send_copy(client, file, size);
+            break;
+        case MODE_SENDFILE:
+            res = send_file(client, file, size);
+            break;
+        case MODE_ZEROCOPY:
+            res = send_zerocopy(client, file, size, &copied_notifications);
+            break;
+        case MODE_RELAY_COPY:
+            res = relay_copy(relay_in, client);
+            break;
+        case MODE_RELAY_SPLICE:
+            res = relay_splice(relay_in, client);
+            break;
+    }
+    tcs_shutdown(client, TCS_SD_SEND);
+    pthread_join(sink_id, NULL);
+    int64_t elapsed = now_ns() - t0;
+    if (relay)
+    {
+        pthread_join(feeder_id, NULL);
+        tcs_close(&feeder_socket);
+        tcs_close(&relay_in);
+    }
+
+    if (res == TCS_ERROR_NOT_IMPLEMENTED)
+        printf("%-12s unavailable\n", mode_name(mode));
+    else if (res != TCS_SUCCESS)
+        printf("%-12s failed with %d\n", mode_name(mode), res);
+    else
+        printf("%-12s %llu MB in %.2f s, %.0f MB/s%s\n",
+               mode_name(mode),
+               (unsigned long long)(sink.bytes / (1024 * 1024)),
+               (double)elapsed / 1e9,
+               (double)sink.bytes / (1024.0 * 1024.0) / ((double)elapsed / 1e9),
+               copied_notifications > 0 ? " (kernel copied, loopback)" : "");
+
+    tcs_close(&client);
+    tcs_close(&server);
+    return 0;
+}
+
+static int prepare_file(const char* path, uint64_t size)
+{
+    int file = open(path, O_RDWR | O_CREAT, 0644);
+    if (file < 0)
+        return -1;
+    struct stat st;
+    if (fstat(file, &st) != 0)
+    {
+        close(file);
+        return -1;
+    }
+    uint8_t* buffer = (uint8_t*)malloc(CHUNK_SIZE);
+    for (size_t i = 0; i < CHUNK_SIZE; ++i)
+        buffer[i] = (uint8_t)(i * 31);
+    if ((uint64_t)st.st_size < size)
+    {
+        for (uint64_t written = 0; written < size;)
+        {
+            size_t chunk = size - written < CHUNK_SIZE ? (size_t)(size - written) : CHUNK_SIZE;
+            ssize_t n = pwrite(file, buffer, chunk, (off_t)written);
+            if (n <= 0)
+            {
+                free(buffer);
+                close(file);
+                return -1;
+            }
+            written += (uint64_t)n;
+        }
+    }
+    else
+    {
+        // Warm the page cache
+        for (uint64_t done = 0; done < size;)
+        {
+            ssize_t n = pread(file, buffer, CHUNK_SIZE, (off_t)done);
+            if (n <= 0)
+                break;
+            done += (uint64_t)n;
+        }
+    }
+    free(buffer);
+    return file;
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = argc > 1 ? argv[1] : "/tmp/tcs_bench_zerocopy.bin";
+    uint64_t size = (argc > 2 ? (uint64_t)atol(argv[2]) : 2048) * 1024 * 1024;
+
+    // tcs_sendfile() and tcs_splice() can raise SIGPIPE
+    signal(SIGPIPE, SIG_IGN);
+
+    int file = prepare_file(path, size);
+    if (file < 0)
+    {
+        printf("could not create %s\n", path);
+        return 1;
+    }
+
+    tcs_lib_init();
+    enum Mode modes[] = {MODE_COPY, MODE_SENDFILE, MODE_ZEROCOPY, MODE_RELAY_COPY, MODE_RELAY_SPLICE};
+    for (size_t m = 0; m < sizeof modes / sizeof modes[0]; ++m)
+        run(modes[m], file, size);
+    tcs_lib_free();
+
+    close(file);
+    return 0;
+}
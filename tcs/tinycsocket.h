@@ -107,15 +107,61 @@ static const char* const TCS_LICENSE_TXT =
 * - TcsResult tcs_receive_from(TcsSocket socket_ctx, uint8_t* buffer, size_t buffer_size, uint32_t flags, struct TcsAddress* source_address, size_t* bytes_received);
 * - TcsResult tcs_receive_line(TcsSocket socket_ctx, uint8_t* buffer, size_t buffer_size, size_t* bytes_received, uint8_t delimiter);
 * - TcsResult tcs_receive_netstring(TcsSocket socket_ctx, uint8_t* buffer, size_t buffer_size, size_t* bytes_received);
+* - TcsResult tcs_send_to_batch(TcsSocket socket_ctx, const struct TcsDatagram* datagrams, size_t datagram_count, uint32_t flags, size_t* datagrams_sent);
+* - TcsResult tcs_receive_from_batch(TcsSocket socket_ctx, struct TcsDatagram* datagrams, size_t datagram_count, uint32_t flags, size_t* datagrams_received);
+*
+* Zero-copy Transfer:
+* - TcsResult tcs_sendfile(TcsSocket socket_ctx, int file_descriptor, int64_t* offset, size_t count, uint32_t flags, size_t* bytes_sent);
+* - TcsResult tcs_splice_create(struct TcsSplice** splice);
+* - TcsResult tcs_splice_destroy(struct TcsSplice** splice);
+* - TcsResult tcs_splice(struct TcsSplice* splice, TcsSocket from_socket_ctx, TcsSocket to_socket_ctx, size_t count, uint32_t flags, size_t* bytes_moved);
+* - TcsResult tcs_send_zerocopy(TcsSocket socket_ctx, const uint8_t* buffer, size_t buffer_size, uint32_t flags, size_t* bytes_sent);
+* - TcsResult tcs_zerocopy_completions(TcsSocket socket_ctx, uint32_t* first_id, uint32_t* last_id, bool* was_copied);
+*
+* Buffered Reading:
+* - TcsResult tcs_reader_create(struct TcsReader** reader, TcsSocket socket_ctx, size_t buffer_size);
+* - TcsResult tcs_reader_destroy(struct TcsReader** reader);
+* - size_t tcs_reader_buffered(const struct TcsReader* reader);
+* - TcsResult tcs_reader_receive_line(struct TcsReader* reader, uint8_t* buffer, size_t buffer_size, size_t* bytes_received, uint8_t delimiter);
+* - TcsResult tcs_reader_receive_netstring(struct TcsReader* reader, uint8_t* buffer, size_t buffer_size, size_t* bytes_received);
+* - TcsResult tcs_reader_receive_exact(struct TcsReader* reader, uint8_t* buffer, size_t length);
+* - TcsResult tcs_reader_peek(struct TcsReader* reader, size_t length, const uint8_t** data);
+* - TcsResult tcs_reader_peek_line(struct TcsReader* reader, const uint8_t** line, size_t* line_size, uint8_t delimiter);
+* - TcsResult tcs_reader_peek_netstring(struct TcsReader* reader, const uint8_t** data, size_t* data_size, size_t* frame_size);
+* - TcsResult tcs_reader_skip(struct TcsReader* reader, size_t length);
 
 *
 * Socket Pooling:
 * - TcsResult tcs_pool_create(struct TcsPool** pool);
+* - TcsResult tcs_pool_create_backend(struct TcsPool** pool, TcsPoolBackend backend);
 * - TcsResult tcs_pool_destroy(struct TcsPool** pool);
 * - TcsResult tcs_pool_add(struct TcsPool* pool, TcsSocket socket_ctx, void* user_data, bool poll_can_read, bool poll_can_write, bool poll_error);
 * - TcsResult tcs_pool_remove(struct TcsPool* pool, TcsSocket socket_ctx);
 * - TcsResult tcs_pool_poll(struct TcsPool* pool, struct TcsPollEvent* events, size_t events_count, size_t* events_populated, int64_t timeout_in_ms);
 *
+* Async I/O (io_uring on Linux, TcsPool elsewhere):
+* - TcsResult tcs_ring_create(struct TcsRing** ring, unsigned int queue_depth, bool try_io_uring);
+* - TcsResult tcs_ring_destroy(struct TcsRing** ring);
+* - bool tcs_ring_is_io_uring(const struct TcsRing* ring);
+* - TcsResult tcs_ring_buffers_register(struct TcsRing* ring, uint8_t* memory, size_t buffer_size, size_t buffer_count);
+* - TcsResult tcs_ring_buffer_release(struct TcsRing* ring, int buffer_id);
+* - TcsResult tcs_ring_send(struct TcsRing* ring, TcsSocket socket_ctx, const uint8_t* buffer, size_t buffer_size, void* user_data);
+* - TcsResult tcs_ring_receive(struct TcsRing* ring, TcsSocket socket_ctx, uint8_t* buffer, size_t buffer_size, void* user_data);
+* - TcsResult tcs_ring_receive_multishot(struct TcsRing* ring, TcsSocket socket_ctx, void* user_data);
+* - TcsResult tcs_ring_accept(struct TcsRing* ring, TcsSocket socket_ctx, bool multishot, void* user_data);
+* - TcsResult tcs_ring_cancel(struct TcsRing* ring, TcsSocket socket_ctx);
+* - TcsResult tcs_ring_submit(struct TcsRing* ring);
+* - TcsResult tcs_ring_wait(struct TcsRing* ring, struct TcsRingCompletion* completions, size_t completions_count, size_t* completions_populated, int64_t timeout_in_ms);
+*
+* Server Runtime:
+* - TcsResult tcs_server_create(struct TcsServer** server, const struct TcsServerConfig* config, const struct TcsServerCallbacks* callbacks, void* user_data);
+* - TcsResult tcs_server_start(struct TcsServer* server);
+* - TcsResult tcs_server_stop(struct TcsServer* server, int64_t drain_timeout_ms);
+* - TcsResult tcs_server_destroy(struct TcsServer** server);
+* - TcsResult tcs_server_address(const struct TcsServer* server, struct TcsAddress* local_address);
+* - void* tcs_server_user_data(const struct TcsServer* server);
+* - size_t tcs_server_connection_count(const struct TcsServer* server);
+*
 * Socket Options:
 * - TcsResult tcs_opt_set(TcsSocket socket_ctx, int32_t level, int32_t option_name, const void* option_value, size_t option_size);
 * - TcsResult tcs_opt_get(TcsSocket socket_ctx, int32_t level, int32_t option_name, void* option_value, size_t* option_size);
@@ -125,6 +171,7 @@ static const char* const TCS_LICENSE_TXT =
 * - TcsResult tcs_opt_keep_alive_get(TcsSocket socket_ctx, bool* is_keep_alive_enabled);
 * - TcsResult tcs_opt_reuse_address_set(TcsSocket socket_ctx, bool do_allow_reuse_address);
 * - TcsResult tcs_opt_reuse_address_get(TcsSocket socket_ctx, bool* is_reuse_address_allowed);
+* - TcsResult tcs_opt_reuse_port_set(TcsSocket socket_ctx, bool do_allow_reuse_port);
 * - TcsResult tcs_opt_send_buffer_size_set(TcsSocket socket_ctx, size_t send_buffer_size);
 * - TcsResult tcs_opt_send_buffer_size_get(TcsSocket socket_ctx, size_t* send_buffer_size);
 * - TcsResult tcs_opt_receive_buffer_size_set(TcsSocket socket_ctx, size_t receive_buffer_size);
@@ -141,6 +188,8 @@ static const char* const TCS_LICENSE_TXT =
 * - TcsResult tcs_opt_priority_get(TcsSocket socket_ctx, int* priority);
 * - TcsResult tcs_opt_nonblocking_set(TcsSocket socket_ctx, bool do_nonblocking);
 * - TcsResult tcs_opt_nonblocking_get(TcsSocket socket_ctx, bool* is_nonblocking);
+* - TcsResult tcs_opt_udp_gro_set(TcsSocket socket_ctx, bool do_gro);
+* - TcsResult tcs_opt_zerocopy_set(TcsSocket socket_ctx, bool do_zerocopy);
 * - TcsResult tcs_opt_membership_add(TcsSocket socket_ctx, const struct TcsAddress* multicast_address);
 * - TcsResult tcs_opt_membership_add_to(TcsSocket socket_ctx, const struct TcsAddress* local_address, const struct TcsAddress* multicast_address);
 * - TcsResult tcs_opt_membership_drop(TcsSocket socket_ctx, const struct TcsAddress* multicast_address);
@@ -204,6 +253,18 @@ typedef unsigned int TcsInterfaceId;
 #endif
 #endif
 
+#ifndef TCS_READER_DEFAULT_SIZE
+#define TCS_READER_DEFAULT_SIZE (64 * 1024)
+#endif
+
+#ifndef TCS_DATAGRAM_BATCH_MAX
+#ifdef TCS_SMALL_STACK
+#define TCS_DATAGRAM_BATCH_MAX 16
+#else
+#define TCS_DATAGRAM_BATCH_MAX 64
+#endif
+#endif
+
 /**
  * @brief Address Family
  */
@@ -288,6 +349,20 @@ struct TcsBuffer
     size_t size;
 };
 
+/**
+ * @brief One entry of a datagram batch.
+ *
+ * Used by tcs_send_to_batch() and tcs_receive_from_batch() to move many datagrams per system call.
+*/
+struct TcsDatagram
+{
+    uint8_t* data;             /**< Payload to send, or buffer to receive into */
+    size_t capacity;           /**< Byte size of @p data when receiving, not used when sending */
+    size_t size;               /**< Bytes to send, or bytes received */
+    struct TcsAddress address; /**< Destination, #TCS_AF_ANY for connected sockets. Source when receiving */
+    uint16_t segment_size;     /**< Split/coalesced UDP segment size (GSO/GRO), 0 for a single datagram */
+};
+
 extern const TcsSocket TCS_SOCKET_INVALID; /**< Define new sockets to this value, always. */
 static const uint32_t TCS_FLAG_NONE = 0;
 
@@ -405,6 +480,101 @@ struct TcsPollEvent
 };
 static const struct TcsPollEvent TCS_POOL_EVENT_EMPTY = {0, 0, false, false, TCS_SUCCESS};
 
+/**
+ * @brief Event notification mechanism used by a TcsPool
+ *
+ * @see tcs_pool_create_backend()
+ */
+typedef enum
+{
+    TCS_POOL_BACKEND_DEFAULT,  /**< Best available for the platform. epoll (level-triggered) on Linux, poll/select elsewhere */
+    TCS_POOL_BACKEND_POLL,     /**< poll() on POSIX, select() on Windows. Each wait scans every socket in the pool */
+    TCS_POOL_BACKEND_EPOLL,    /**< Linux epoll, level-triggered. Same semantics as poll, wait cost depends on ready sockets only */
+    TCS_POOL_BACKEND_EPOLL_ET, /**< Linux epoll, edge-triggered. A socket is reported once per readiness change */
+} TcsPoolBackend;
+
+struct TcsSplice;
+
+struct TcsReader;
+
+struct TcsRing;
+
+/**
+ * @brief Kind of operation queued on a TcsRing
+ */
+typedef enum
+{
+    TCS_RING_SEND,
+    TCS_RING_RECEIVE,
+    TCS_RING_ACCEPT,
+} TcsRingOperation;
+
+/**
+ * @brief Result of one operation queued on a TcsRing
+ *
+ * @see tcs_ring_wait()
+ */
+struct TcsRingCompletion
+{
+    TcsSocket socket;           /**< Socket the operation was queued on */
+    void* user_data;            /**< Pointer given when the operation was queued */
+    TcsRingOperation operation; /**< What was queued */
+    TcsResult result;           /**< #TCS_SHUTDOWN for end of stream or a canceled operation */
+    size_t bytes;               /**< Bytes sent or received */
+    TcsSocket accepted;         /**< New connection for #TCS_RING_ACCEPT, otherwise #TCS_SOCKET_INVALID */
+    int buffer_id;              /**< Registered buffer holding the received data, -1 if none was used */
+    bool more;                  /**< A multishot operation is still armed and will complete again */
+};
+
+struct TcsServer;
+
+/**
+ * @brief A client connection owned by one TcsServer worker
+ */
+struct TcsServerConnection
+{
+    TcsSocket socket;          /**< Connected client socket, closed by the server */
+    struct TcsAddress address; /**< Address of the client */
+    unsigned int worker;       /**< Index of the worker thread that owns the connection */
+    void* user_data;           /**< Free for the callbacks, NULL at connect */
+};
+
+/**
+ * @brief Callbacks of a TcsServer, they are called on the worker thread owning the connection
+ *
+ * @see tcs_server_create()
+ */
+struct TcsServerCallbacks
+{
+    /** A new connection, return false to reject it. Can be NULL */
+    bool (*on_connect)(struct TcsServer* server, struct TcsServerConnection* connection);
+    /** The socket can be read without blocking, or has an error. Receive once, return false to close it */
+    bool (*on_readable)(struct TcsServer* server, struct TcsServerConnection* connection);
+    /** Called once for every connection given to on_connect, before the socket is closed. Can be NULL */
+    void (*on_close)(struct TcsServer* server, struct TcsServerConnection* connection);
+};
+
+/**
+ * @brief Settings of a TcsServer
+ *
+ * @see tcs_server_create()
+ */
+struct TcsServerConfig
+{
+    struct TcsAddress address;         /**< IPv4 or IPv6 address and port to listen on, port 0 picks a free port */
+    unsigned int worker_count;         /**< Number of worker threads, 0 for one per CPU */
+    size_t max_connections_per_worker; /**< A full worker stops accepting new connections, 0 for no limit */
+};
+// gcc may trigger bug #53119
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-braces"
+#endif
+static const struct TcsServerConfig TCS_SERVER_CONFIG_DEFAULT = {{TCS_AF_ANY, {0, 0}}, 0, 0};
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+
 // ######## Library Management ########
 
 /**
@@ -1638,7 +1808,7 @@ TcsResult tcs_receive_from(TcsSocket socket_ctx,
 * @brief Read up to and including a delimiter.
 *
 * This function ensures that the socket buffer will keep its data after the delimiter.
-* For performance it is recommended to read everything and split it yourself.
+* This costs several system calls per line, for performance use a TcsReader or read everything and split it yourself.
 * The call will block until the delimiter is received or the supplied buffer is filled.
 * The timeout time will not be per call but between each packet received. Longer call time than timeout is possible.
 *
@@ -1650,6 +1820,7 @@ TcsResult tcs_receive_from(TcsSocket socket_ctx,
 * @return #TCS_AGAIN if no delimiter was found and the supplied buffer was filled.
 * @return #TCS_SUCCESS if the delimiter was found. Otherwise the error code.
 * @see tcs_receive_netstring()
+* @see tcs_reader_receive_line()
 */
 TcsResult tcs_receive_line(TcsSocket socket_ctx,
                            uint8_t* buffer,
@@ -1659,6 +1830,302 @@ TcsResult tcs_receive_line(TcsSocket socket_ctx,
 
 TcsResult tcs_receive_netstring(TcsSocket socket_ctx, uint8_t* buffer, size_t buffer_size, size_t* bytes_received);
 
+/**
+* @brief Send several datagrams with one system call, useful with UDP sockets.
+*
+* On Linux this uses sendmmsg(), other platforms send the datagrams one by one.
+* At most #TCS_DATAGRAM_BATCH_MAX datagrams are sent per call, check @p datagrams_sent and call again for the rest.
+*
+* A datagram with TcsDatagram::segment_size set and a larger TcsDatagram::size is split by the kernel into
+* datagrams of that size (UDP_SEGMENT, Linux 4.18). This saves the per datagram cost in the network stack as well.
+*
+* @param socket_ctx is your in-out socket context.
+* @param datagrams is the array of datagrams to send. TcsDatagram::capacity is not used.
+* @param datagram_count is the number of elements in @p datagrams.
+* @param flags is currently not in use.
+* @param datagrams_sent is how many entries of @p datagrams that were sent.
+* @return #TCS_SUCCESS if at least one datagram was sent, otherwise the error code.
+* @retval #TCS_ERROR_NOT_IMPLEMENTED if segmentation is requested but not supported.
+* @see tcs_receive_from_batch()
+*/
+TcsResult tcs_send_to_batch(TcsSocket socket_ctx,
+                            const struct TcsDatagram* datagrams,
+                            size_t datagram_count,
+                            uint32_t flags,
+                            size_t* datagrams_sent);
+
+/**
+* @brief Receive several datagrams with one system call, useful with UDP sockets.
+*
+* Blocks until at least one datagram has arrived, then fills as many entries as are available without waiting.
+* On Linux this uses recvmmsg(), other platforms receive one datagram per call.
+* At most #TCS_DATAGRAM_BATCH_MAX datagrams are received per call.
+*
+* With tcs_opt_udp_gro_set() enabled the kernel may coalesce datagrams from the same source into one entry.
+* TcsDatagram::segment_size is then set and the entry holds TcsDatagram::size / segment_size datagrams
+* (the last one may be shorter). Use a large TcsDatagram::capacity, 64 KiB, with GRO.
+*
+* @param socket_ctx is your in-out socket context.
+* @param datagrams is the array to fill. Set TcsDatagram::data and TcsDatagram::capacity for every entry.
+* @param datagram_count is the number of elements in @p datagrams.
+* @param flags is currently not in use.
+* @param datagrams_received is how many entries of @p datagrams that were filled.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+* @see tcs_send_to_batch()
+*/
+TcsResult tcs_receive_from_batch(TcsSocket socket_ctx,
+                                 struct TcsDatagram* datagrams,
+                                 size_t datagram_count,
+                                 uint32_t flags,
+                                 size_t* datagrams_received);
+
+/**
+* @brief Send data from a file directly to a socket without copying it through user space.
+*
+* Uses sendfile() on Linux, other POSIX platforms fall back to read() and tcs_send().
+* Unlike tcs_send() this may raise SIGPIPE if the peer has closed, ignore the signal in servers.
+*
+* @param socket_ctx is your in-out socket context, usually a connected TCP socket.
+* @param file_descriptor is an open file (or any fd supporting mmap) to read from.
+* @param offset is where in the file to start and is updated with the bytes sent. If NULL the file position is used and updated.
+* @param count is number of bytes to send.
+* @param flags use #TCS_MSG_SENDALL to keep sending until @p count bytes are sent or the end of the file is reached.
+* @param bytes_sent is how many bytes that was successfully sent.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+* @see tcs_send()
+*/
+TcsResult tcs_sendfile(TcsSocket socket_ctx,
+                       int file_descriptor,
+                       int64_t* offset,
+                       size_t count,
+                       uint32_t flags,
+                       size_t* bytes_sent);
+
+/**
+* @brief Create a context for moving data between sockets with tcs_splice().
+*
+* On Linux the context owns a pipe that the data is moved through inside the kernel,
+* other platforms get a user space buffer. Reuse one context per relay direction.
+*
+* @param splice is a pointer to your context pointer, which must be NULL.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+* @see tcs_splice_destroy()
+*/
+TcsResult tcs_splice_create(struct TcsSplice** splice);
+
+/**
+* @brief Free all resources of a splice context. Data still held by it is lost.
+*
+* @param splice is a pointer to your context pointer, which is set to NULL.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+*/
+TcsResult tcs_splice_destroy(struct TcsSplice** splice);
+
+/**
+* @brief Move data received on one socket to another socket, for example in a proxy.
+*
+* Blocks like tcs_receive() until data is available on @p from_socket_ctx, then writes it to @p to_socket_ctx.
+* If the destination would block (non-blocking socket) the data is kept in @p splice and sent first on the next call.
+* Like tcs_sendfile() this may raise SIGPIPE on Linux.
+*
+* @param splice is a context from tcs_splice_create(), do not share it between socket pairs.
+* @param from_socket_ctx is the socket to read from.
+* @param to_socket_ctx is the socket to write to.
+* @param count is the maximum number of bytes to move.
+* @param flags use #TCS_MSG_SENDALL to keep moving until @p count bytes are moved.
+* @param bytes_moved is how many bytes that were written to @p to_socket_ctx.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+* @retval #TCS_SHUTDOWN if @p from_socket_ctx was closed by the peer.
+*/
+TcsResult tcs_splice(struct TcsSplice* splice,
+                     TcsSocket from_socket_ctx,
+                     TcsSocket to_socket_ctx,
+                     size_t count,
+                     uint32_t flags,
+                     size_t* bytes_moved);
+
+/**
+* @brief Send data without copying it into the kernel (MSG_ZEROCOPY, Linux 4.14).
+*
+* Requires tcs_opt_zerocopy_set() on the socket, otherwise it behaves as tcs_send().
+* The pages of @p buffer are pinned and must not be modified or freed until the kernel reports completion.
+* Every successful call gets the next notification id for the socket, starting from 0.
+* Collect the ids with tcs_zerocopy_completions(). Only worth it for sends of about 10 KiB and more.
+*
+* @param socket_ctx is your in-out socket context.
+* @param buffer is a pointer to your data you want to send.
+* @param buffer_size is number of bytes of the data you want to send.
+* @param flags is currently not in use.
+* @param bytes_sent is how many bytes that was successfully sent.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+* @see tcs_zerocopy_completions()
+*/
+TcsResult tcs_send_zerocopy(TcsSocket socket_ctx,
+                            const uint8_t* buffer,
+                            size_t buffer_size,
+                            uint32_t flags,
+                            size_t* bytes_sent);
+
+/**
+* @brief Read one completion notification of tcs_send_zerocopy() from the socket error queue, never blocks.
+*
+* A notification covers the inclusive id range [@p first_id, @p last_id], all buffers in it can be reused.
+* The socket reports an error event in tcs_pool_poll() when notifications are queued.
+*
+* @param socket_ctx is your in-out socket context.
+* @param first_id is the first completed notification id.
+* @param last_id is the last completed notification id.
+* @param was_copied is set to true if the kernel fell back to copying, for example over loopback. Can be NULL.
+* @return #TCS_SUCCESS if a notification was read, otherwise the error code.
+* @retval #TCS_ERROR_WOULD_BLOCK if no notification is queued.
+*/
+TcsResult tcs_zerocopy_completions(TcsSocket socket_ctx, uint32_t* first_id, uint32_t* last_id, bool* was_copied);
+
+/**
+* @brief Create a read-ahead buffer for a socket.
+*
+* A TcsReader fills its buffer with as large receives as possible and serves line, netstring and fixed-length
+* reads from memory, so line based protocols need about one system call per buffer instead of several per line.
+* Once a reader is used, do not call tcs_receive() on the socket directly, the reader may hold data already received.
+* The reader does not own the socket.
+*
+* @code
+* struct TcsReader* reader = NULL;
+* tcs_reader_create(&reader, client_socket, 0);
+* const uint8_t* line = NULL;
+* size_t line_size = 0;
+* while (tcs_reader_peek_line(reader, &line, &line_size, '\n') == TCS_SUCCESS)
+* {
+*     // Use line[0...line_size-1] here, it is valid until the next call with reader
+*     tcs_reader_skip(reader, line_size);
+* }
+* tcs_reader_destroy(&reader);
+* @endcode
+*
+* @param reader is a pointer to your reader pointer, which must be NULL.
+* @param socket_ctx is the socket to read from, usually a TCP socket.
+* @param buffer_size is the size of the read-ahead buffer and the largest frame that can be peeked. 0 gives #TCS_READER_DEFAULT_SIZE.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+* @see tcs_reader_destroy()
+*/
+TcsResult tcs_reader_create(struct TcsReader** reader, TcsSocket socket_ctx, size_t buffer_size);
+
+/**
+* @brief Free the reader and all data buffered by it. The socket is not closed.
+*
+* @param reader is a pointer to your reader pointer, which is set to NULL.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+*/
+TcsResult tcs_reader_destroy(struct TcsReader** reader);
+
+/**
+* @brief Number of bytes received from the socket but not yet read from the reader.
+*
+* Useful together with tcs_pool_poll(), handle everything buffered before waiting for the socket again.
+*
+* @param reader is your reader.
+* @return number of buffered bytes.
+*/
+size_t tcs_reader_buffered(const struct TcsReader* reader);
+
+/**
+* @brief Read up to and including a delimiter, same as tcs_receive_line() but buffered.
+*
+* Lines longer than the reader buffer are supported as long as they fit in @p buffer.
+*
+* @param reader is your reader.
+* @param buffer is a pointer to your buffer where you want to store the line.
+* @param buffer_size is the byte size of your buffer, for preventing overflows.
+* @param bytes_received is how many bytes that was written to your buffer.
+* @param delimiter is your byte value where you want to stop reading. (including delimiter)
+* @return #TCS_AGAIN if no delimiter was found and the supplied buffer was filled.
+* @return #TCS_SUCCESS if the delimiter was found. Otherwise the error code.
+*/
+TcsResult tcs_reader_receive_line(struct TcsReader* reader,
+                                  uint8_t* buffer,
+                                  size_t buffer_size,
+                                  size_t* bytes_received,
+                                  uint8_t delimiter);
+
+/**
+* @brief Read one netstring, same as tcs_receive_netstring() but buffered.
+*
+* @param reader is your reader.
+* @param buffer is a pointer to your buffer where you want to store the payload.
+* @param buffer_size is the byte size of your buffer.
+* @param bytes_received is the payload size.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+* @retval #TCS_ERROR_MEMORY if the payload does not fit in @p buffer, nothing is consumed from the reader.
+* @retval #TCS_ERROR_ILL_FORMED_MESSAGE if the stream is not a netstring.
+*/
+TcsResult tcs_reader_receive_netstring(struct TcsReader* reader,
+                                       uint8_t* buffer,
+                                       size_t buffer_size,
+                                       size_t* bytes_received);
+
+/**
+* @brief Read exactly @p length bytes, for fixed-length frames and headers. Blocks until all bytes are read.
+*
+* Frames larger than the reader buffer are received directly into @p buffer.
+*
+* @param reader is your reader.
+* @param buffer is a pointer to your buffer of at least @p length bytes.
+* @param length is number of bytes to read.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+*/
+TcsResult tcs_reader_receive_exact(struct TcsReader* reader, uint8_t* buffer, size_t length);
+
+/**
+* @brief Get a view of the next @p length bytes without copying or consuming them.
+*
+* The view points into the reader buffer and is valid until the next call with the reader.
+* Use tcs_reader_skip() to consume it.
+*
+* @param reader is your reader.
+* @param length is number of bytes needed, at most the reader buffer size.
+* @param data is set to the first byte.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+* @retval #TCS_ERROR_MEMORY if @p length is larger than the reader buffer.
+*/
+TcsResult tcs_reader_peek(struct TcsReader* reader, size_t length, const uint8_t** data);
+
+/**
+* @brief Get a view of the next line, including the delimiter, without copying or consuming it.
+*
+* @param reader is your reader.
+* @param line is set to the first byte of the line. Valid until the next call with the reader.
+* @param line_size is the line size including the delimiter, pass it to tcs_reader_skip() when done.
+* @param delimiter is your byte value ending the line.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+* @retval #TCS_ERROR_MEMORY if the line is longer than the reader buffer, use tcs_reader_receive_line() for those.
+*/
+TcsResult tcs_reader_peek_line(struct TcsReader* reader, const uint8_t** line, size_t* line_size, uint8_t delimiter);
+
+/**
+* @brief Get a view of the payload of the next netstring without copying or consuming it.
+*
+* @param reader is your reader.
+* @param data is set to the first byte of the payload. Valid until the next call with the reader.
+* @param data_size is the payload size.
+* @param frame_size is the size of the whole netstring, pass it to tcs_reader_skip() when done.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+* @retval #TCS_ERROR_MEMORY if the netstring is larger than the reader buffer.
+* @retval #TCS_ERROR_ILL_FORMED_MESSAGE if the stream is not a netstring.
+*/
+TcsResult tcs_reader_peek_netstring(struct TcsReader* reader,
+                                    const uint8_t** data,
+                                    size_t* data_size,
+                                    size_t* frame_size);
+
+/**
+* @brief Consume bytes that were viewed with one of the peek functions.
+*
+* @param reader is your reader.
+* @param length is number of bytes to consume, at most tcs_reader_buffered().
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+*/
+TcsResult tcs_reader_skip(struct TcsReader* reader, size_t length);
+
 /**
 * @brief Create a context used for waiting on several sockets.
 *
@@ -1705,6 +2172,25 @@ TcsResult tcs_receive_netstring(TcsSocket socket_ctx, uint8_t* buffer, size_t bu
 */
 TcsResult tcs_pool_create(struct TcsPool** pool);
 
+/**
+* @brief Create a pool context with a specific event backend.
+*
+* tcs_pool_create() is the same as calling this function with #TCS_POOL_BACKEND_DEFAULT.
+* The epoll backends keep the interest list in the kernel, use them when the pool holds many mostly idle sockets.
+*
+* With #TCS_POOL_BACKEND_EPOLL_ET a socket is only reported when its state changes. You must read (or write)
+* until #TCS_ERROR_WOULD_BLOCK before the next tcs_pool_poll(), so use it together with tcs_opt_nonblocking_set().
+*
+* Sockets closed while still in an epoll pool are removed from it by the kernel.
+*
+* @param[out] pool is your out pool context pointer. Initiate a TcsPool pointer to NULL and use the address of this pointer.
+* @param backend is the event mechanism to use.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+* @retval #TCS_ERROR_NOT_IMPLEMENTED if @p backend is not available on this platform.
+* @see tcs_pool_create()
+*/
+TcsResult tcs_pool_create_backend(struct TcsPool** pool, TcsPoolBackend backend);
+
 /**
 * @brief Frees all resources bound to the pool.
 *
@@ -1763,66 +2249,354 @@ TcsResult tcs_pool_poll(struct TcsPool* pool,
                         int64_t timeout_in_ms);
 
 /**
-* @brief Set parameters on a socket. It is recommended to use tcs_set_xxx instead.
+* @brief Create a submission/completion context for asynchronous socket operations.
 *
-* @param socket_ctx is your in-out socket context.
-* @param level is the definition level.
-* @param option_name is the option name.
-* @param option_value is a pointer to the option value.
-* @param option_size is the byte size of the data pointed by @p option_value.
-* @return #TCS_SUCCESS if successful, otherwise the error code.
-*/
-TcsResult tcs_opt_set(TcsSocket socket_ctx,
-                      int32_t level,
-                      int32_t option_name,
-                      const void* option_value,
-                      size_t option_size);
-
-/**
-* @brief Get parameters on a socket. It is recommended to use tcs_get_xxx instead.
+* Operations are queued with tcs_ring_send(), tcs_ring_receive(), tcs_ring_accept() etc. and handed to the kernel in
+* batches by tcs_ring_submit() or tcs_ring_wait(). Their results are reaped with tcs_ring_wait(), so many sends and
+* receives cost one system call instead of one each.
+*
+* On Linux 6.0 or later this is backed by io_uring. Otherwise, or when @p try_io_uring is false, the ring emulates
+* the same API on top of a TcsPool (epoll or poll) and non-blocking system calls.
 *
 * @code
-* uint8_t c;
-* size_t a = sizeof(c);
-* tcs_opt_get(socket, TCS_SOL_IP, TCS_SO_IP_MULTICAST_LOOP, &c, &a);
+* struct TcsRing* ring = NULL;
+* tcs_ring_create(&ring, 256, true);
+* tcs_ring_accept(ring, listen_socket, true, NULL); // Keeps accepting until canceled
+*
+* struct TcsRingCompletion done[64];
+* size_t populated = 0;
+* while (tcs_ring_wait(ring, done, 64, &populated, TCS_WAIT_INF) == TCS_SUCCESS)
+* {
+*     for (size_t i = 0; i < populated; ++i)
+*     {
+*         if (done[i].operation == TCS_RING_ACCEPT && done[i].result == TCS_SUCCESS)
+*             tcs_ring_receive(ring, done[i].accepted, buffer, sizeof buffer, NULL);
+*     }
+* }
+* tcs_ring_destroy(&ring);
 * @endcode
 *
-* @param socket_ctx is your in-out socket context.
-* @param level is the definition level.
-* @param option_name is the option name.
-* @param option_value is a pointer to the option value.
-* @param option_size is a pointer the byte size of the data pointed by @p option_value.
+* @param[out] ring is your out ring context pointer. Initiate a TcsRing pointer to NULL and use the address of this pointer.
+* @param queue_depth is the number of operations that can be queued between two submits, rounded up to a power of two.
+* @param try_io_uring use io_uring if the kernel supports it, false always uses the TcsPool fallback.
 * @return #TCS_SUCCESS if successful, otherwise the error code.
+* @see tcs_ring_destroy()
 */
-TcsResult tcs_opt_get(TcsSocket socket_ctx,
-                      int32_t level,
-                      int32_t option_name,
-                      void* option_value,
-                      size_t* option_size);
+TcsResult tcs_ring_create(struct TcsRing** ring, unsigned int queue_depth, bool try_io_uring);
 
-/*
-* @brief Enable the socket to be allowed to use broadcast.
+/**
+* @brief Frees all resources bound to the ring.
 *
-* Only valid for protocols that support broadcast, for example UDP. Default is false.
+* Operations still in flight are abandoned, their sockets are not closed. Will set @p ring to NULL when successful.
 *
-* @param socket_ctx socket to enable/disable permission to send broadcast on.
-* @param do_allow_broadcast set to true to allow, false to forbid.
+* @param[in, out] ring is your ring context pointer created with tcs_ring_create()
 * @return #TCS_SUCCESS if successful, otherwise the error code.
 */
-TcsResult tcs_opt_broadcast_set(TcsSocket socket_ctx, bool do_allow_broadcast);
-TcsResult tcs_opt_broadcast_get(TcsSocket socket_ctx, bool* is_broadcast_allowed);
+TcsResult tcs_ring_destroy(struct TcsRing** ring);
 
-TcsResult tcs_opt_keep_alive_set(TcsSocket socket_ctx, bool do_keep_alive);
-TcsResult tcs_opt_keep_alive_get(TcsSocket socket_ctx, bool* is_keep_alive_enabled);
+/**
+* @brief Check if the ring is backed by io_uring or by the TcsPool fallback.
+*
+* @param[in] ring is a context pointer created with tcs_ring_create()
+* @return true if io_uring is used.
+*/
+bool tcs_ring_is_io_uring(const struct TcsRing* ring);
 
-TcsResult tcs_opt_reuse_address_set(TcsSocket socket_ctx, bool do_allow_reuse_address);
-TcsResult tcs_opt_reuse_address_get(TcsSocket socket_ctx, bool* is_reuse_address_allowed);
+/**
+* @brief Register memory the ring picks receive buffers from.
+*
+* The memory is split into @p buffer_count buffers of @p buffer_size bytes. A receive queued without a buffer
+* (tcs_ring_receive() with NULL, or tcs_ring_receive_multishot()) gets one of them when data arrives and reports it
+* in TcsRingCompletion::buffer_id. The data is at `memory + buffer_id * buffer_size`. Give the buffer back with
+* tcs_ring_buffer_release() when you are done with it. Receives fail with #TCS_ERROR_MEMORY while all buffers are taken.
+*
+* Can only be called once per ring. The memory must outlive the ring.
+*
+* @param[in] ring is a context pointer created with tcs_ring_create()
+* @param[in] memory is at least @p buffer_size * @p buffer_count bytes.
+* @param buffer_size is the byte size of each buffer.
+* @param buffer_count is the number of buffers, a power of two not larger than 32768.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+*/
+TcsResult tcs_ring_buffers_register(struct TcsRing* ring, uint8_t* memory, size_t buffer_size, size_t buffer_count);
 
-TcsResult tcs_opt_send_buffer_size_set(TcsSocket socket_ctx, size_t send_buffer_size);
-TcsResult tcs_opt_send_buffer_size_get(TcsSocket socket_ctx, size_t* send_buffer_size);
+/**
+* @brief Give a registered buffer back to the ring after its data has been consumed.
+*
+* @param[in] ring is a context pointer created with tcs_ring_create()
+* @param buffer_id is TcsRingCompletion::buffer_id from a receive completion.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+*/
+TcsResult tcs_ring_buffer_release(struct TcsRing* ring, int buffer_id);
 
-TcsResult tcs_opt_receive_buffer_size_set(TcsSocket socket_ctx, size_t receive_buffer_size);
-TcsResult tcs_opt_receive_buffer_size_get(TcsSocket socket_ctx, size_t* receive_buffer_size);
+/**
+* @brief Queue a send. @p buffer must stay valid until the completion is reaped.
+*
+* @param[in] ring is a context pointer created with tcs_ring_create()
+* @param socket_ctx is the socket to send on.
+* @param buffer is a pointer to your data you want to send.
+* @param buffer_size is number of bytes of the data you want to send.
+* @param user_data is returned in the completion.
+* @return #TCS_SUCCESS if queued, otherwise the error code.
+*/
+TcsResult tcs_ring_send(struct TcsRing* ring,
+                        TcsSocket socket_ctx,
+                        const uint8_t* buffer,
+                        size_t buffer_size,
+                        void* user_data);
+
+/**
+* @brief Queue a single receive.
+*
+* @param[in] ring is a context pointer created with tcs_ring_create()
+* @param socket_ctx is the socket to receive from.
+* @param buffer is where to store the data, must stay valid until the completion is reaped. NULL picks a registered buffer.
+* @param buffer_size is the byte size of @p buffer. Ignored when @p buffer is NULL.
+* @param user_data is returned in the completion.
+* @return #TCS_SUCCESS if queued, otherwise the error code.
+* @see tcs_ring_buffers_register()
+*/
+TcsResult tcs_ring_receive(struct TcsRing* ring,
+                           TcsSocket socket_ctx,
+                           uint8_t* buffer,
+                           size_t buffer_size,
+                           void* user_data);
+
+/**
+* @brief Queue a receive that completes once for every chunk of data that arrives.
+*
+* Each completion uses a registered buffer and has TcsRingCompletion::more set while the receive is still armed.
+* It stops at end of stream, on error, when no registered buffer is free or when canceled with tcs_ring_cancel().
+*
+* @param[in] ring is a context pointer created with tcs_ring_create()
+* @param socket_ctx is the socket to receive from.
+* @param user_data is returned in every completion.
+* @return #TCS_SUCCESS if queued, otherwise the error code.
+* @retval #TCS_ERROR_INVALID_ARGUMENT if no buffers are registered.
+*/
+TcsResult tcs_ring_receive_multishot(struct TcsRing* ring, TcsSocket socket_ctx, void* user_data);
+
+/**
+* @brief Queue an accept on a listening socket.
+*
+* @param[in] ring is a context pointer created with tcs_ring_create()
+* @param socket_ctx is your listening socket.
+* @param multishot true to keep accepting, one completion per connection, until canceled.
+* @param user_data is returned in the completion.
+* @return #TCS_SUCCESS if queued, otherwise the error code.
+*/
+TcsResult tcs_ring_accept(struct TcsRing* ring, TcsSocket socket_ctx, bool multishot, void* user_data);
+
+/**
+* @brief Cancel all queued and in-flight operations on a socket.
+*
+* Every canceled operation still produces a completion, with #TCS_SHUTDOWN as result.
+* Cancel before closing a socket that has multishot operations armed.
+*
+* @param[in] ring is a context pointer created with tcs_ring_create()
+* @param socket_ctx is the socket to cancel operations for.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+*/
+TcsResult tcs_ring_cancel(struct TcsRing* ring, TcsSocket socket_ctx);
+
+/**
+* @brief Hand all queued operations to the kernel without waiting.
+*
+* tcs_ring_wait() submits as well, you only need this to start operations before you are ready to wait.
+*
+* @param[in] ring is a context pointer created with tcs_ring_create()
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+*/
+TcsResult tcs_ring_submit(struct TcsRing* ring);
+
+/**
+* @brief Submit queued operations and wait for completions.
+*
+* @param[in] ring is a context pointer created with tcs_ring_create()
+* @param[out] completions is an array to fill with completed operations.
+* @param completions_count is the number of elements in @p completions.
+* @param[out] completions_populated will contain the number of completions written.
+* @param timeout_in_ms is the maximum wait time if nothing has completed yet. Use #TCS_WAIT_INF to wait forever.
+* @return #TCS_SUCCESS if any completion was returned.
+* @retval #TCS_ERROR_TIMED_OUT if nothing completed in time.
+*/
+TcsResult tcs_ring_wait(struct TcsRing* ring,
+                        struct TcsRingCompletion* completions,
+                        size_t completions_count,
+                        size_t* completions_populated,
+                        int64_t timeout_in_ms);
+
+/**
+* @brief Create a multi-threaded TCP server.
+*
+* The server runs one worker thread per CPU (or TcsServerConfig::worker_count), each with its own TcsPool.
+* Where SO_REUSEPORT is available every worker also has its own listening socket on the same port and the kernel
+* spreads new connections between them, otherwise the workers share one listening socket.
+* A connection stays on the worker that accepted it, so the callbacks for one connection never run concurrently.
+* Callbacks for different connections do run concurrently on different workers.
+*
+* Backpressure: a worker with TcsServerConfig::max_connections_per_worker connections stops accepting,
+* new clients wait in the listen backlog until it has room again.
+*
+* On POSIX you need to link with -pthread. Define TCS_MISSING_THREADS to leave the server out on any platform.
+*
+* @code
+* bool on_readable(struct TcsServer* server, struct TcsServerConnection* connection)
+* {
+*     uint8_t buffer[1024];
+*     size_t received = 0;
+*     if (tcs_receive(connection->socket, buffer, sizeof(buffer), TCS_FLAG_NONE, &received) != TCS_SUCCESS)
+*         return false; // Closed by peer or error, let the server close it
+*     return tcs_send(connection->socket, buffer, received, TCS_MSG_SENDALL, NULL) == TCS_SUCCESS;
+* }
+*
+* struct TcsServerConfig config = TCS_SERVER_CONFIG_DEFAULT;
+* tcs_address_parse("0.0.0.0:1212", &config.address);
+* struct TcsServerCallbacks callbacks = {NULL, on_readable, NULL};
+* struct TcsServer* server = NULL;
+* tcs_server_create(&server, &config, &callbacks, NULL);
+* tcs_server_start(server);
+* // ... until it is time to quit
+* tcs_server_stop(server, 5000);
+* tcs_server_destroy(&server);
+* @endcode
+*
+* @param server is a pointer to your server pointer, which must be NULL.
+* @param config is the address and limits, start from #TCS_SERVER_CONFIG_DEFAULT.
+* @param callbacks are called from the worker threads, TcsServerCallbacks::on_readable is required.
+* @param user_data is available in the callbacks with tcs_server_user_data().
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+* @see tcs_server_start()
+*/
+TcsResult tcs_server_create(struct TcsServer** server,
+                            const struct TcsServerConfig* config,
+                            const struct TcsServerCallbacks* callbacks,
+                            void* user_data);
+
+/**
+* @brief Start the worker threads. A server can only be started once.
+*
+* @param server is your server.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+*/
+TcsResult tcs_server_start(struct TcsServer* server);
+
+/**
+* @brief Stop accepting and wait for the open connections to finish, then stop the worker threads.
+*
+* Accepting stops at once. When every worker has its own listener (SO_REUSEPORT), connections already in the
+* backlog are still accepted first. With a single shared listener they are not, and they get a reset when the
+* listener is closed.
+* Open connections keep being served until their callbacks close them or @p drain_timeout_ms has passed,
+* then the rest are closed (TcsServerCallbacks::on_close is called for each). Blocks until all workers have exited.
+* Do not call it from a callback.
+*
+* @param server is your server.
+* @param drain_timeout_ms is how long to wait for open connections. 0 closes them at once, negative waits forever.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+*/
+TcsResult tcs_server_stop(struct TcsServer* server, int64_t drain_timeout_ms);
+
+/**
+* @brief Free all resources of the server, stops it first if it is running.
+*
+* @param server is a pointer to your server pointer, which is set to NULL.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+*/
+TcsResult tcs_server_destroy(struct TcsServer** server);
+
+/**
+* @brief Get the address the server listens on, useful when binding to port 0.
+*
+* @param server is your server.
+* @param local_address is set to the bound address.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+*/
+TcsResult tcs_server_address(const struct TcsServer* server, struct TcsAddress* local_address);
+
+/**
+* @brief Get the user_data given to tcs_server_create().
+*/
+void* tcs_server_user_data(const struct TcsServer* server);
+
+/**
+* @brief Number of open connections over all workers. Only a snapshot while the server is running.
+*/
+size_t tcs_server_connection_count(const struct TcsServer* server);
+
+/**
+* @brief Set parameters on a socket. It is recommended to use tcs_set_xxx instead.
+*
+* @param socket_ctx is your in-out socket context.
+* @param level is the definition level.
+* @param option_name is the option name.
+* @param option_value is a pointer to the option value.
+* @param option_size is the byte size of the data pointed by @p option_value.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+*/
+TcsResult tcs_opt_set(TcsSocket socket_ctx,
+                      int32_t level,
+                      int32_t option_name,
+                      const void* option_value,
+                      size_t option_size);
+
+/**
+* @brief Get parameters on a socket. It is recommended to use tcs_get_xxx instead.
+*
+* @code
+* uint8_t c;
+* size_t a = sizeof(c);
+* tcs_opt_get(socket, TCS_SOL_IP, TCS_SO_IP_MULTICAST_LOOP, &c, &a);
+* @endcode
+*
+* @param socket_ctx is your in-out socket context.
+* @param level is the definition level.
+* @param option_name is the option name.
+* @param option_value is a pointer to the option value.
+* @param option_size is a pointer the byte size of the data pointed by @p option_value.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+*/
+TcsResult tcs_opt_get(TcsSocket socket_ctx,
+                      int32_t level,
+                      int32_t option_name,
+                      void* option_value,
+                      size_t* option_size);
+
+/*
+* @brief Enable the socket to be allowed to use broadcast.
+*
+* Only valid for protocols that support broadcast, for example UDP. Default is false.
+*
+* @param socket_ctx socket to enable/disable permission to send broadcast on.
+* @param do_allow_broadcast set to true to allow, false to forbid.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+*/
+TcsResult tcs_opt_broadcast_set(TcsSocket socket_ctx, bool do_allow_broadcast);
+TcsResult tcs_opt_broadcast_get(TcsSocket socket_ctx, bool* is_broadcast_allowed);
+
+TcsResult tcs_opt_keep_alive_set(TcsSocket socket_ctx, bool do_keep_alive);
+TcsResult tcs_opt_keep_alive_get(TcsSocket socket_ctx, bool* is_keep_alive_enabled);
+
+TcsResult tcs_opt_reuse_address_set(TcsSocket socket_ctx, bool do_allow_reuse_address);
+TcsResult tcs_opt_reuse_address_get(TcsSocket socket_ctx, bool* is_reuse_address_allowed);
+
+/**
+* @brief Let several sockets bind the same address and port, and share the incoming connections (SO_REUSEPORT).
+*
+* Only supported where the kernel load balances between the sockets: Linux 3.9 and FreeBSD 12 (SO_REUSEPORT_LB).
+*
+* @param socket_ctx is your in-out socket context, set it before tcs_bind().
+* @param do_allow_reuse_port true to share the port.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+* @retval #TCS_ERROR_NOT_IMPLEMENTED if the platform does not support it.
+*/
+TcsResult tcs_opt_reuse_port_set(TcsSocket socket_ctx, bool do_allow_reuse_port);
+
+TcsResult tcs_opt_send_buffer_size_set(TcsSocket socket_ctx, size_t send_buffer_size);
+TcsResult tcs_opt_send_buffer_size_get(TcsSocket socket_ctx, size_t* send_buffer_size);
+
+TcsResult tcs_opt_receive_buffer_size_set(TcsSocket socket_ctx, size_t receive_buffer_size);
+TcsResult tcs_opt_receive_buffer_size_get(TcsSocket socket_ctx, size_t* receive_buffer_size);
 
 TcsResult tcs_opt_receive_timeout_set(TcsSocket socket_ctx, int timeout_ms);
 TcsResult tcs_opt_receive_timeout_get(TcsSocket socket_ctx, int* timeout_ms);
@@ -1853,6 +2627,28 @@ TcsResult tcs_opt_membership_drop(TcsSocket socket_ctx, const struct TcsAddress*
 TcsResult tcs_opt_nonblocking_set(TcsSocket socket_ctx, bool do_nonblocking);
 TcsResult tcs_opt_nonblocking_get(TcsSocket socket_ctx, bool* is_nonblocking);
 
+/**
+* @brief Let the kernel coalesce received UDP datagrams (UDP_GRO, Linux 5.0).
+*
+* Only useful together with tcs_receive_from_batch(), which reports the segment size.
+*
+* @param socket_ctx is your in-out socket context.
+* @param do_gro true to enable generic receive offload.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+* @retval #TCS_ERROR_NOT_IMPLEMENTED if the platform does not support it.
+*/
+TcsResult tcs_opt_udp_gro_set(TcsSocket socket_ctx, bool do_gro);
+
+/**
+* @brief Allow tcs_send_zerocopy() on the socket (SO_ZEROCOPY, Linux 4.14).
+*
+* @param socket_ctx is your in-out socket context.
+* @param do_zerocopy true to enable zero-copy sends.
+* @return #TCS_SUCCESS if successful, otherwise the error code.
+* @retval #TCS_ERROR_NOT_IMPLEMENTED if the platform does not support it.
+*/
+TcsResult tcs_opt_zerocopy_set(TcsSocket socket_ctx, bool do_zerocopy);
+
 TcsResult tcs_interface_list(struct TcsInterface interfaces[], size_t capacity, size_t* out_count);
 TcsResult tcs_address_resolve(const char* hostname,
                               TcsAddressFamily address_family,
@@ -2344,11 +3140,108 @@ static inline int tds_map_remove(void** keys,
 #define TCS_AVAILABLE_IFADDRS 0
 #endif
 
+// If you no not use cmake you may need to define TCS_MISSING_EPOLL yourself if your system does not support it
+#if defined(__linux__) && !defined(TCS_MISSING_EPOLL)
+#define TCS_AVAILABLE_EPOLL 1
+#else
+#define TCS_AVAILABLE_EPOLL 0
+#endif
+
 #if TCS_AVAILABLE_AF_PACKET
 #include <linux/if_arp.h>    // sll_hatype (ethernet and not can or firewire etc.)
 #include <linux/if_packet.h> // struct sockaddr_ll
 #endif
 
+// If you no not use cmake you may need to define TCS_MISSING_IO_URING yourself if your kernel headers are older than 6.0
+#if defined(__linux__) && !defined(TCS_MISSING_IO_URING)
+#define TCS_AVAILABLE_IO_URING 1
+#else
+#define TCS_AVAILABLE_IO_URING 0
+#endif
+
+// If you no not use cmake you may need to define TCS_MISSING_THREADS yourself if your system does not have pthreads
+#if !defined(TCS_MISSING_THREADS)
+#define TCS_AVAILABLE_THREADS 1
+#else
+#define TCS_AVAILABLE_THREADS 0
+#endif
+
+// If you no not use cmake you may need to define TCS_MISSING_MMSG yourself if your system does not support it
+#if defined(__linux__) && !defined(TCS_MISSING_MMSG)
+#define TCS_AVAILABLE_MMSG 1
+#else
+#define TCS_AVAILABLE_MMSG 0
+#endif
+
+// If you no not use cmake you may need to define TCS_MISSING_ZEROCOPY yourself if your system does not support it
+#if defined(__linux__) && !defined(TCS_MISSING_ZEROCOPY)
+#define TCS_AVAILABLE_ZEROCOPY 1
+#else
+#define TCS_AVAILABLE_ZEROCOPY 0
+#endif
+
+#if TCS_AVAILABLE_EPOLL
+#include <sys/epoll.h> // epoll_create1(), epoll_ctl(), epoll_wait()
+#endif
+
+#if TCS_AVAILABLE_THREADS
+#include <pthread.h> // TcsServer workers
+#include <time.h>    // clock_gettime()
+#endif
+
+#if TCS_AVAILABLE_ZEROCOPY
+#include <linux/errqueue.h> // struct sock_extended_err
+#include <sys/sendfile.h>   // sendfile()
+#include <sys/syscall.h>    // splice() is only declared with _GNU_SOURCE
+#ifndef SPLICE_F_MOVE
+#define SPLICE_F_MOVE 1
+#endif
+#ifndef F_SETPIPE_SZ
+#define F_SETPIPE_SZ 1031
+#endif
+#ifndef F_GETPIPE_SZ
+#define F_GETPIPE_SZ 1032
+#endif
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SOL_IP
+#define SOL_IP IPPROTO_IP
+#endif
+#ifndef SOL_IPV6
+#define SOL_IPV6 IPPROTO_IPV6
+#endif
+#ifndef IP_RECVERR
+#define IP_RECVERR 11
+#endif
+#ifndef IPV6_RECVERR
+#define IPV6_RECVERR 25
+#endif
+#endif
+
+#if TCS_AVAILABLE_MMSG
+#include <netinet/udp.h>  // UDP_SEGMENT, UDP_GRO
+#include <sys/syscall.h>  // sendmmsg() and recvmmsg() are only declared with _GNU_SOURCE
+#ifndef SOL_UDP
+#define SOL_UDP IPPROTO_UDP
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
+
+#if TCS_AVAILABLE_IO_URING
+#include <linux/io_uring.h> // struct io_uring_sqe etc.
+#include <sys/mman.h>       // mmap() for the rings
+#include <sys/syscall.h>    // io_uring has no libc wrappers
+#endif
+
 #ifndef TDS_MAP_pollfd_pvoid
 #define TDS_MAP_pollfd_pvoid
 TDS_MAP_IMPL(struct pollfd, void*, poll)
@@ -2356,15 +3249,89 @@ TDS_MAP_IMPL(struct pollfd, void*, poll)
 
 struct TcsPool
 {
+    TcsPoolBackend type;
     union __backend
     {
         struct __poll
         {
             struct TdsMap_poll map;
         } poll;
+#if TCS_AVAILABLE_EPOLL
+        struct __epoll
+        {
+            int fd;
+            uint32_t trigger;                 // 0 or EPOLLET
+            void** user_data;                 // Indexed by socket, the kernel keeps the interest list
+            size_t user_data_capacity;
+            struct epoll_event* native_events; // Scratch buffer for epoll_wait()
+            size_t native_events_capacity;
+        } epoll;
+#endif
     } backend;
 };
 
+struct TcsRingOp
+{
+    TcsRingOperation operation;
+    TcsSocket socket;
+    void* user_data;
+    uint8_t* buffer;     // NULL when a registered buffer is picked
+    size_t buffer_size;
+    bool multishot;
+    size_t next;         // index + 1 in the free list or the fallback socket list, 0 ends the list
+};
+
+struct TcsRing
+{
+    bool native;
+
+    struct TcsRingOp* ops; // Indexed by the io_uring user_data
+    size_t ops_capacity;
+    size_t free_ops;       // index + 1
+
+    uint8_t* buffers;
+    size_t buffer_size;
+    size_t buffer_count;
+
+#if TCS_AVAILABLE_IO_URING
+    struct __uring
+    {
+        int fd;
+        void* ring_ptr;
+        size_t ring_size;
+        struct io_uring_sqe* sqes;
+        size_t sqes_size;
+        uint32_t* sq_khead;
+        uint32_t* sq_ktail;
+        uint32_t sq_mask;
+        uint32_t sq_entries;
+        uint32_t sq_tail; // Published to sq_ktail on submit
+        uint32_t to_submit;
+        uint32_t* cq_khead;
+        uint32_t* cq_ktail;
+        uint32_t cq_mask;
+        struct io_uring_cqe* cqes;
+        struct io_uring_buf_ring* buf_ring;
+        size_t buf_ring_size;
+        uint16_t buf_ring_tail;
+    } uring;
+#endif
+
+    struct __fallback
+    {
+        struct TcsPool* pool;
+        size_t* socket_ops;        // Indexed by socket, index + 1 of the first queued op
+        size_t socket_ops_capacity;
+        uint8_t* interest;         // Indexed by socket, what the socket is registered for in the pool
+        size_t interest_capacity;
+        size_t canceled;           // index + 1 of canceled ops waiting to be reported
+        uint16_t* free_buffers;
+        size_t free_buffer_count;
+        struct TcsPollEvent* events;
+        size_t events_capacity;
+    } fallback;
+};
+
 const TcsSocket TCS_SOCKET_INVALID = -1;
 const int TCS_WAIT_INF = -1;
 
@@ -2764,7 +3731,6 @@ TcsResult tcs_accept(TcsSocket socket_ctx, TcsSocket* child_socket_ctx, struct T
     else
     {
         *child_socket_ctx = TCS_SOCKET_INVALID;
-        printf("%d %s\n", errno, strerror(errno));
         return errno2retcode(errno);
     }
 }
@@ -3031,61 +3997,519 @@ TcsResult tcs_receive_from(TcsSocket socket_ctx,
     }
 }
 
-// tcs_receive_line() is defined in tinycsocket_common.c
-// tcs_receive_netstring() is defined in tinycsocket_common.c
-
-// ######## Socket Pooling ########
+#if TCS_AVAILABLE_MMSG
+// glibc only declares struct mmsghdr with _GNU_SOURCE, which we can not rely on in a header
+struct tcs_mmsghdr
+{
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+};
 
-TcsResult tcs_pool_create(struct TcsPool** pool)
+TcsResult tcs_send_to_batch(TcsSocket socket_ctx,
+                            const struct TcsDatagram* datagrams,
+                            size_t datagram_count,
+                            uint32_t flags,
+                            size_t* datagrams_sent)
 {
-    if (pool == NULL || *pool != NULL)
+    if (datagrams_sent != NULL)
+        *datagrams_sent = 0;
+    if (socket_ctx == TCS_SOCKET_INVALID || datagrams == NULL || datagram_count == 0)
         return TCS_ERROR_INVALID_ARGUMENT;
+    if (flags & TCS_MSG_SENDALL)
+        return TCS_ERROR_NOT_IMPLEMENTED;
 
-    *pool = (struct TcsPool*)malloc(sizeof(struct TcsPool));
-    if (*pool == NULL)
-        return TCS_ERROR_MEMORY;
-    memset(*pool, 0, sizeof(struct TcsPool));
+    size_t count = datagram_count > TCS_DATAGRAM_BATCH_MAX ? TCS_DATAGRAM_BATCH_MAX : datagram_count;
 
-    if (tds_map_poll_create(&(*pool)->backend.poll.map) != 0)
+    struct tcs_mmsghdr msgs[TCS_DATAGRAM_BATCH_MAX];
+    struct iovec iovs[TCS_DATAGRAM_BATCH_MAX];
+    struct sockaddr_storage addresses[TCS_DATAGRAM_BATCH_MAX];
+    union
     {
-        free(*pool);
-        *pool = NULL;
-        return TCS_ERROR_MEMORY;
+        char buf[CMSG_SPACE(sizeof(uint16_t))];
+        struct cmsghdr align;
+    } controls[TCS_DATAGRAM_BATCH_MAX];
+    memset(msgs, 0, count * sizeof(struct tcs_mmsghdr));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        // The const on the array does not reach the payload, TcsDatagram::data is already a plain pointer
+        iovs[i].iov_base = datagrams[i].data;
+        iovs[i].iov_len = datagrams[i].size;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+
+        if (datagrams[i].address.family != TCS_AF_ANY)
+        {
+            socklen_t sockaddr_size = 0;
+            memset(&addresses[i], 0, sizeof addresses[i]);
+            TcsResult convert_addr_status = sockaddr2native(&datagrams[i].address, &addresses[i], &sockaddr_size);
+            if (convert_addr_status != TCS_SUCCESS)
+                return convert_addr_status;
+            msgs[i].msg_hdr.msg_name = &addresses[i];
+            msgs[i].msg_hdr.msg_namelen = sockaddr_size;
+        }
+
+        if (datagrams[i].segment_size > 0 && datagrams[i].size > datagrams[i].segment_size)
+        {
+            memset(&controls[i], 0, sizeof controls[i]);
+            msgs[i].msg_hdr.msg_control = controls[i].buf;
+            msgs[i].msg_hdr.msg_controllen = sizeof controls[i].buf;
+            struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr);
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            memcpy(CMSG_DATA(cmsg), &datagrams[i].segment_size, sizeof(uint16_t));
+        }
     }
 
+    long ret = syscall(SYS_sendmmsg, socket_ctx, msgs, (unsigned int)count, TCS_DEFAULT_SEND_FLAGS | (int)flags);
+    if (ret < 0)
+    {
+        if (errno == EIO || errno == ENOPROTOOPT) // No GSO support in the kernel or the device
+            return TCS_ERROR_NOT_IMPLEMENTED;
+        return errno2retcode(errno);
+    }
+    if (datagrams_sent != NULL)
+        *datagrams_sent = (size_t)ret;
     return TCS_SUCCESS;
 }
 
-TcsResult tcs_pool_destroy(struct TcsPool** pool)
+TcsResult tcs_receive_from_batch(TcsSocket socket_ctx,
+                                 struct TcsDatagram* datagrams,
+                                 size_t datagram_count,
+                                 uint32_t flags,
+                                 size_t* datagrams_received)
 {
-    if (pool == NULL || *pool == NULL)
+    if (datagrams_received != NULL)
+        *datagrams_received = 0;
+    if (socket_ctx == TCS_SOCKET_INVALID || datagrams == NULL || datagram_count == 0)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    if (tds_map_poll_destroy(&(*pool)->backend.poll.map) != 0)
+    size_t count = datagram_count > TCS_DATAGRAM_BATCH_MAX ? TCS_DATAGRAM_BATCH_MAX : datagram_count;
+
+    struct tcs_mmsghdr msgs[TCS_DATAGRAM_BATCH_MAX];
+    struct iovec iovs[TCS_DATAGRAM_BATCH_MAX];
+    struct sockaddr_storage addresses[TCS_DATAGRAM_BATCH_MAX];
+    union
     {
-        // Should not happen, but if it does, we may leak memory.
-        // We can not do anything about it.
-        return TCS_ERROR_MEMORY;
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } controls[TCS_DATAGRAM_BATCH_MAX];
+    memset(msgs, 0, count * sizeof(struct tcs_mmsghdr));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        iovs[i].iov_base = datagrams[i].data;
+        iovs[i].iov_len = datagrams[i].capacity;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &addresses[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof addresses[i];
+        msgs[i].msg_hdr.msg_control = controls[i].buf;
+        msgs[i].msg_hdr.msg_controllen = sizeof controls[i].buf;
     }
 
-    free(*pool);
-    *pool = NULL;
+    // MSG_WAITFORONE: block for the first datagram only, then take what is already queued
+    long ret = syscall(
+        SYS_recvmmsg, socket_ctx, msgs, (unsigned int)count, TCS_DEFAULT_RECV_FLAGS | MSG_WAITFORONE | (int)flags, NULL);
+    if (ret < 0)
+        return errno2retcode(errno);
+
+    for (size_t i = 0; i < (size_t)ret; ++i)
+    {
+        datagrams[i].size = msgs[i].msg_len;
+        datagrams[i].segment_size = 0;
+        datagrams[i].address = TCS_ADDRESS_NONE;
+        if (msgs[i].msg_hdr.msg_namelen > 0)
+            native2sockaddr((struct sockaddr*)&addresses[i], &datagrams[i].address);
 
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg != NULL;
+             cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg))
+        {
+            if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO)
+            {
+                int gso_size = 0;
+                memcpy(&gso_size, CMSG_DATA(cmsg), sizeof gso_size);
+                datagrams[i].segment_size = (uint16_t)gso_size;
+            }
+        }
+    }
+    if (datagrams_received != NULL)
+        *datagrams_received = (size_t)ret;
     return TCS_SUCCESS;
 }
+#else
+TcsResult tcs_send_to_batch(TcsSocket socket_ctx,
+                            const struct TcsDatagram* datagrams,
+                            size_t datagram_count,
+                            uint32_t flags,
+                            size_t* datagrams_sent)
+{
+    if (datagrams_sent != NULL)
+        *datagrams_sent = 0;
+    if (socket_ctx == TCS_SOCKET_INVALID || datagrams == NULL || datagram_count == 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-TcsResult tcs_pool_add(struct TcsPool* pool,
-                       TcsSocket socket_ctx,
-                       void* user_data,
-                       bool poll_can_read,
-                       bool poll_can_write,
-                       bool poll_error)
+    size_t count = datagram_count > TCS_DATAGRAM_BATCH_MAX ? TCS_DATAGRAM_BATCH_MAX : datagram_count;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (datagrams[i].segment_size > 0 && datagrams[i].size > datagrams[i].segment_size)
+            return i == 0 ? TCS_ERROR_NOT_IMPLEMENTED : TCS_SUCCESS;
+        TcsResult sts = datagrams[i].address.family == TCS_AF_ANY
+                            ? tcs_send(socket_ctx, datagrams[i].data, datagrams[i].size, flags, NULL)
+                            : tcs_send_to(socket_ctx, datagrams[i].data, datagrams[i].size, flags, &datagrams[i].address, NULL);
+        if (sts != TCS_SUCCESS)
+            return i == 0 ? sts : TCS_SUCCESS;
+        if (datagrams_sent != NULL)
+            *datagrams_sent = i + 1;
+    }
+    return TCS_SUCCESS;
+}
+
+TcsResult tcs_receive_from_batch(TcsSocket socket_ctx,
+                                 struct TcsDatagram* datagrams,
+                                 size_t datagram_count,
+                                 uint32_t flags,
+                                 size_t* datagrams_received)
 {
-    if (pool == NULL)
+    if (datagrams_received != NULL)
+        *datagrams_received = 0;
+    if (socket_ctx == TCS_SOCKET_INVALID || datagrams == NULL || datagram_count == 0)
         return TCS_ERROR_INVALID_ARGUMENT;
-    if (socket_ctx == TCS_SOCKET_INVALID)
+
+    datagrams[0].segment_size = 0;
+    TcsResult sts = tcs_receive_from(
+        socket_ctx, datagrams[0].data, datagrams[0].capacity, flags, &datagrams[0].address, &datagrams[0].size);
+    if (sts == TCS_SUCCESS && datagrams_received != NULL)
+        *datagrams_received = 1;
+    return sts;
+}
+#endif
+
+// ######## Zero-copy Transfer ########
+
+#if TCS_AVAILABLE_ZEROCOPY
+struct TcsSplice
+{
+    int pipe[2];
+    size_t pipe_size;
+    size_t pending; // Bytes in the pipe not yet written to the destination
+};
+#else
+#define TCS_SPLICE_BUFFER_SIZE (64 * 1024)
+struct TcsSplice
+{
+    uint8_t buffer[TCS_SPLICE_BUFFER_SIZE];
+    size_t offset;
+    size_t pending; // Bytes in the buffer, from offset, not yet written to the destination
+};
+#endif
+
+// sendfile() and splice() can not take MSG_NOSIGNAL, ignore SIGPIPE if the peer may close early
+TcsResult tcs_sendfile(TcsSocket socket_ctx,
+                       int file_descriptor,
+                       int64_t* offset,
+                       size_t count,
+                       uint32_t flags,
+                       size_t* bytes_sent)
+{
+    if (bytes_sent != NULL)
+        *bytes_sent = 0;
+    if (socket_ctx == TCS_SOCKET_INVALID || file_descriptor < 0 || count == 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    // Send all
+    if (flags & TCS_MSG_SENDALL)
+    {
+        uint32_t new_flags = flags & ~TCS_MSG_SENDALL; // For recursive call
+        size_t left = count;
+        while (left > 0)
+        {
+            size_t sent = 0;
+            TcsResult sts = tcs_sendfile(socket_ctx, file_descriptor, offset, left, new_flags, &sent);
+            if (bytes_sent != NULL)
+                *bytes_sent += sent;
+            if (sts != TCS_SUCCESS)
+                return sts;
+            if (sent == 0) // End of file
+                break;
+            left -= sent;
+        }
+        return TCS_SUCCESS;
+    }
+
+#if TCS_AVAILABLE_ZEROCOPY
+    off_t native_offset = offset != NULL ? (off_t)*offset : 0;
+    ssize_t ret = sendfile(socket_ctx, file_descriptor, offset != NULL ? &native_offset : NULL, count);
+    if (ret < 0)
+        return errno2retcode(errno);
+    if (offset != NULL)
+        *offset = (int64_t)native_offset;
+    if (bytes_sent != NULL)
+        *bytes_sent = (size_t)ret;
+    return TCS_SUCCESS;
+#else
+    uint8_t buffer[16 * 1024];
+    size_t chunk = count < sizeof buffer ? count : sizeof buffer;
+    ssize_t read_bytes = offset != NULL ? pread(file_descriptor, buffer, chunk, (off_t)*offset)
+                                        : read(file_descriptor, buffer, chunk);
+    if (read_bytes < 0)
+        return errno2retcode(errno);
+    if (read_bytes == 0)
+        return TCS_SUCCESS;
+
+    size_t sent = 0;
+    TcsResult sts = tcs_send(socket_ctx, buffer, (size_t)read_bytes, TCS_MSG_SENDALL, &sent);
+    if (offset != NULL)
+        *offset += (int64_t)sent;
+    else if (sent < (size_t)read_bytes) // Move the file position back to what was actually sent
+        lseek(file_descriptor, -(off_t)((size_t)read_bytes - sent), SEEK_CUR);
+    if (bytes_sent != NULL)
+        *bytes_sent = sent;
+    return sts;
+#endif
+}
+
+TcsResult tcs_splice_create(struct TcsSplice** splice)
+{
+    if (splice == NULL || *splice != NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    *splice = (struct TcsSplice*)malloc(sizeof(struct TcsSplice));
+    if (*splice == NULL)
+        return TCS_ERROR_MEMORY;
+    memset(*splice, 0, sizeof(struct TcsSplice));
+
+#if TCS_AVAILABLE_ZEROCOPY
+    if (pipe((*splice)->pipe) != 0)
+    {
+        int error_code = errno;
+        free(*splice);
+        *splice = NULL;
+        return errno2retcode(error_code);
+    }
+    fcntl((*splice)->pipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl((*splice)->pipe[1], F_SETFD, FD_CLOEXEC);
+
+    // A larger pipe means fewer splice() calls per byte, the default is 64 KiB
+    fcntl((*splice)->pipe[1], F_SETPIPE_SZ, 1024 * 1024);
+    int pipe_size = fcntl((*splice)->pipe[1], F_GETPIPE_SZ);
+    (*splice)->pipe_size = pipe_size > 0 ? (size_t)pipe_size : 64 * 1024;
+#endif
+    return TCS_SUCCESS;
+}
+
+TcsResult tcs_splice_destroy(struct TcsSplice** splice)
+{
+    if (splice == NULL || *splice == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+#if TCS_AVAILABLE_ZEROCOPY
+    close((*splice)->pipe[0]);
+    close((*splice)->pipe[1]);
+#endif
+    free(*splice);
+    *splice = NULL;
+    return TCS_SUCCESS;
+}
+
+TcsResult tcs_splice(struct TcsSplice* splice,
+                     TcsSocket from_socket_ctx,
+                     TcsSocket to_socket_ctx,
+                     size_t count,
+                     uint32_t flags,
+                     size_t* bytes_moved)
+{
+    if (bytes_moved != NULL)
+        *bytes_moved = 0;
+    if (splice == NULL || from_socket_ctx == TCS_SOCKET_INVALID || to_socket_ctx == TCS_SOCKET_INVALID || count == 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    // Move all
+    if (flags & TCS_MSG_SENDALL)
+    {
+        uint32_t new_flags = flags & ~TCS_MSG_SENDALL; // For recursive call
+        size_t left = count;
+        while (left > 0)
+        {
+            size_t moved = 0;
+            TcsResult sts = tcs_splice(splice, from_socket_ctx, to_socket_ctx, left, new_flags, &moved);
+            if (bytes_moved != NULL)
+                *bytes_moved += moved;
+            if (sts != TCS_SUCCESS)
+                return sts;
+            left -= moved < left ? moved : left;
+        }
+        return TCS_SUCCESS;
+    }
+
+    size_t moved = 0;
+#if TCS_AVAILABLE_ZEROCOPY
+    // Data left in the pipe by an earlier call goes out first
+    if (splice->pending == 0)
+    {
+        size_t chunk = count < splice->pipe_size ? count : splice->pipe_size;
+        long in = syscall(SYS_splice, from_socket_ctx, NULL, splice->pipe[1], NULL, chunk, SPLICE_F_MOVE);
+        if (in < 0)
+            return errno2retcode(errno);
+        if (in == 0)
+            return TCS_SHUTDOWN;
+        splice->pending = (size_t)in;
+    }
+    while (splice->pending > 0)
+    {
+        long out = syscall(SYS_splice, splice->pipe[0], NULL, to_socket_ctx, NULL, splice->pending, SPLICE_F_MOVE);
+        if (out < 0)
+        {
+            if (bytes_moved != NULL)
+                *bytes_moved = moved;
+            if (moved > 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return TCS_SUCCESS;
+            return errno2retcode(errno);
+        }
+        splice->pending -= (size_t)out;
+        moved += (size_t)out;
+    }
+#else
+    if (splice->pending == 0)
+    {
+        size_t chunk = count < sizeof splice->buffer ? count : sizeof splice->buffer;
+        size_t received = 0;
+        TcsResult sts = tcs_receive(from_socket_ctx, splice->buffer, chunk, TCS_FLAG_NONE, &received);
+        if (sts != TCS_SUCCESS)
+            return sts;
+        splice->offset = 0;
+        splice->pending = received;
+    }
+    while (splice->pending > 0)
+    {
+        size_t sent = 0;
+        TcsResult sts = tcs_send(to_socket_ctx, splice->buffer + splice->offset, splice->pending, TCS_FLAG_NONE, &sent);
+        if (sts != TCS_SUCCESS)
+        {
+            if (bytes_moved != NULL)
+                *bytes_moved = moved;
+            if (moved > 0 && sts == TCS_ERROR_WOULD_BLOCK)
+                return TCS_SUCCESS;
+            return sts;
+        }
+        splice->offset += sent;
+        splice->pending -= sent;
+        moved += sent;
+    }
+#endif
+    if (bytes_moved != NULL)
+        *bytes_moved = moved;
+    return TCS_SUCCESS;
+}
+
+TcsResult tcs_send_zerocopy(TcsSocket socket_ctx,
+                            const uint8_t* buffer,
+                            size_t buffer_size,
+                            uint32_t flags,
+                            size_t* bytes_sent)
+{
+#if TCS_AVAILABLE_ZEROCOPY
+    if (bytes_sent != NULL)
+        *bytes_sent = 0;
+    if (socket_ctx == TCS_SOCKET_INVALID || buffer == NULL || buffer_size == 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    // Every partial send would get its own notification id, let the caller keep track of them
+    if (flags & TCS_MSG_SENDALL)
+        return TCS_ERROR_NOT_IMPLEMENTED;
+
+    ssize_t ret = send(socket_ctx, (const char*)buffer, buffer_size, TCS_DEFAULT_SEND_FLAGS | MSG_ZEROCOPY | (int)flags);
+    if (ret < 0)
+    {
+        if (errno == ENOBUFS) // Too many pages pinned, reap completions and try again
+            return TCS_ERROR_MEMORY;
+        return errno2retcode(errno);
+    }
+    if (bytes_sent != NULL)
+        *bytes_sent = (size_t)ret;
+    return TCS_SUCCESS;
+#else
+    return tcs_send(socket_ctx, buffer, buffer_size, flags, bytes_sent);
+#endif
+}
+
+TcsResult tcs_zerocopy_completions(TcsSocket socket_ctx, uint32_t* first_id, uint32_t* last_id, bool* was_copied)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID || first_id == NULL || last_id == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
+#if TCS_AVAILABLE_ZEROCOPY
+    // The error queue can hold other errors as well, skip until a zero-copy notification shows up
+    while (true)
+    {
+        union
+        {
+            char buf[CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_in6))];
+            struct cmsghdr align;
+        } control;
+        struct msghdr msg;
+        memset(&msg, 0, sizeof msg);
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof control.buf;
+
+        if (recvmsg(socket_ctx, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+            return errno2retcode(errno);
+
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+                !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))
+                continue;
+            struct sock_extended_err err;
+            memcpy(&err, CMSG_DATA(cmsg), sizeof err);
+            if (err.ee_errno != 0 || err.ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+                continue;
+            *first_id = err.ee_info;
+            *last_id = err.ee_data;
+            if (was_copied != NULL)
+                *was_copied = (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+            return TCS_SUCCESS;
+        }
+    }
+#else
+    // tcs_send_zerocopy() copies on this platform, there is nothing to wait for
+    (void)was_copied;
+    return TCS_ERROR_WOULD_BLOCK;
+#endif
+}
+
+// tcs_receive_line() is defined in tinycsocket_common.c
+// tcs_receive_netstring() is defined in tinycsocket_common.c
+
+// ######## Socket Pooling ########
+
+// poll() backend, every wait scans the whole pool
+
+static TcsResult pool_poll_create(struct TcsPool* pool)
+{
+    if (tds_map_poll_create(&pool->backend.poll.map) != 0)
+        return TCS_ERROR_MEMORY;
+    return TCS_SUCCESS;
+}
+
+static TcsResult pool_poll_destroy(struct TcsPool* pool)
+{
+    if (tds_map_poll_destroy(&pool->backend.poll.map) != 0)
+    {
+        // Should not happen, but if it does, we may leak memory.
+        // We can not do anything about it.
+        return TCS_ERROR_MEMORY;
+    }
+    return TCS_SUCCESS;
+}
+
+static TcsResult pool_poll_add(struct TcsPool* pool,
+                               TcsSocket socket_ctx,
+                               void* user_data,
+                               bool poll_can_read,
+                               bool poll_can_write,
+                               bool poll_error)
+{
     // todo(markusl): Add more events that is input and output events
     short ev = 0;
     if (poll_can_read)
@@ -3106,12 +4530,8 @@ TcsResult tcs_pool_add(struct TcsPool* pool,
     return TCS_SUCCESS;
 }
 
-TcsResult tcs_pool_remove(struct TcsPool* pool, TcsSocket socket_ctx)
+static TcsResult pool_poll_remove(struct TcsPool* pool, TcsSocket socket_ctx)
 {
-    if (pool == NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
-    if (socket_ctx == TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
     struct TdsMap_poll const* map = &pool->backend.poll.map;
 
     bool found = false;
@@ -3131,22 +4551,12 @@ TcsResult tcs_pool_remove(struct TcsPool* pool, TcsSocket socket_ctx)
     return TCS_SUCCESS;
 }
 
-TcsResult tcs_pool_poll(struct TcsPool* pool,
-                        struct TcsPollEvent* events,
-                        size_t events_count,
-                        size_t* events_populated,
-                        int64_t timeout_in_ms)
+static TcsResult pool_poll_wait(struct TcsPool* pool,
+                                struct TcsPollEvent* events,
+                                size_t events_count,
+                                size_t* events_populated,
+                                int64_t timeout_in_ms)
 {
-    if (pool == NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
-    if (events_populated == NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
-
-    // We do not support more more elements or time than signed int32 supports.
-    // todo(markusl): Add support for int64 timeout
-    if (events_count > 0x7FFFFFFF || timeout_in_ms > 0x7FFFFFFF)
-        return TCS_ERROR_INVALID_ARGUMENT;
-
     struct TdsMap_poll* map = &pool->backend.poll.map;
 
     int poll_ret = poll(map->keys, map->count, (int)timeout_in_ms);
@@ -3187,2537 +4597,4665 @@ TcsResult tcs_pool_poll(struct TcsPool* pool,
     return TCS_SUCCESS;
 }
 
-// ######## Socket Options ########
+#if TCS_AVAILABLE_EPOLL
+// epoll backend, the interest list lives in the kernel and a wait only touches ready sockets
 
-TcsResult tcs_opt_set(TcsSocket socket_ctx,
-                      int32_t level,
-                      int32_t option_name,
-                      const void* option_value,
-                      size_t option_size)
+static TcsResult pool_epoll_create(struct TcsPool* pool, bool edge_triggered)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
+    pool->backend.epoll.fd = epoll_create1(EPOLL_CLOEXEC);
+    if (pool->backend.epoll.fd < 0)
+        return errno2retcode(errno);
+    pool->backend.epoll.trigger = edge_triggered ? (uint32_t)EPOLLET : 0;
+    return TCS_SUCCESS;
+}
 
-    if (setsockopt(socket_ctx, (int)level, (int)option_name, (const char*)option_value, (socklen_t)option_size) == 0)
-        return TCS_SUCCESS;
-    else
+static TcsResult pool_epoll_destroy(struct TcsPool* pool)
+{
+    free(pool->backend.epoll.user_data);
+    free(pool->backend.epoll.native_events);
+    pool->backend.epoll.user_data = NULL;
+    pool->backend.epoll.native_events = NULL;
+    if (close(pool->backend.epoll.fd) != 0)
         return errno2retcode(errno);
+    return TCS_SUCCESS;
 }
 
-TcsResult tcs_opt_get(TcsSocket socket_ctx, int32_t level, int32_t option_name, void* option_value, size_t* option_size)
+static TcsResult pool_epoll_add(struct TcsPool* pool,
+                                TcsSocket socket_ctx,
+                                void* user_data,
+                                bool poll_can_read,
+                                bool poll_can_write,
+                                bool poll_error)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID || option_value == NULL || option_size == NULL)
+    if (socket_ctx < 0)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    if (getsockopt(socket_ctx, (int)level, (int)option_name, (void*)option_value, (socklen_t*)option_size) == 0)
+    size_t index = (size_t)socket_ctx;
+    if (index >= pool->backend.epoll.user_data_capacity)
     {
-        // Linux sets the buffer size to the doubled because of internal use and returns the full doubled size including internal part
-#ifdef __linux__
-        if (option_name == TCS_SO_RCVBUF || option_name == TCS_SO_SNDBUF)
-        {
-            *(unsigned int*)option_value /= 2;
-        }
-#endif
-        return TCS_SUCCESS;
+        if (tds_ulist_reserve((void**)&pool->backend.epoll.user_data,
+                              &pool->backend.epoll.user_data_capacity,
+                              sizeof(void*),
+                              index + 1) != 0)
+            return TCS_ERROR_MEMORY;
     }
-    else
+
+    // EPOLLERR and EPOLLHUP are always reported by the kernel, same as for poll()
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof ev);
+    ev.events = pool->backend.epoll.trigger;
+    if (poll_can_read)
+        ev.events |= EPOLLIN;
+    if (poll_can_write)
+        ev.events |= EPOLLOUT;
+    if (poll_error)
+        ev.events |= EPOLLERR;
+    ev.data.fd = socket_ctx;
+
+    if (epoll_ctl(pool->backend.epoll.fd, EPOLL_CTL_ADD, socket_ctx, &ev) != 0)
     {
+        if (errno == EEXIST)
+            return TCS_ERROR_INVALID_ARGUMENT;
         return errno2retcode(errno);
     }
-}
+    pool->backend.epoll.user_data[index] = user_data;
 
-// tcs_opt_broadcast_set() is defined in tinycocket_common.c
-// tcs_opt_broadcast_get() is defined in tinycocket_common.c
-// tcs_opt_keep_alive_set() is defined in inycocket_common.c
-// tcs_opt_keep_alive_get() is defined in tinycocket_common.c
-// tcs_opt_reuse_address_set() is defined in tiinycocket_common.c
-// tcs_opt_reuse_address_get() is defined in tiinycocket_common.c
-// tcs_opt_send_buffer_size_set() is defined in tininycocket_common.c
-// tcs_opt_send_buffer_size_get() is defined in tininycocket_common.c
-// tcs_opt_receive_buffer_size_set() is defined in tinyinycocket_common.c
-// tcs_opt_receive_buffer_size_get() is defined in tinyinycocket_common.c
+    return TCS_SUCCESS;
+}
 
-TcsResult tcs_opt_receive_timeout_set(TcsSocket socket_ctx, int timeout_ms)
+static TcsResult pool_epoll_remove(struct TcsPool* pool, TcsSocket socket_ctx)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
-
-    struct timeval tv;
-    tv.tv_sec = timeout_ms / 1000;
-    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    // Kernels before 2.6.9 require a non-NULL event even for EPOLL_CTL_DEL
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof ev);
+    if (epoll_ctl(pool->backend.epoll.fd, EPOLL_CTL_DEL, socket_ctx, &ev) != 0)
+    {
+        if (errno == ENOENT || errno == EBADF)
+            return TCS_ERROR_INVALID_ARGUMENT;
+        return errno2retcode(errno);
+    }
+    if ((size_t)socket_ctx < pool->backend.epoll.user_data_capacity)
+        pool->backend.epoll.user_data[socket_ctx] = NULL;
 
-    return tcs_opt_set(socket_ctx, TCS_SOL_SOCKET, TCS_SO_RCVTIMEO, &tv, sizeof(tv));
+    return TCS_SUCCESS;
 }
 
-TcsResult tcs_opt_receive_timeout_get(TcsSocket socket_ctx, int* timeout_ms)
+static TcsResult pool_epoll_wait(struct TcsPool* pool,
+                                 struct TcsPollEvent* events,
+                                 size_t events_count,
+                                 size_t* events_populated,
+                                 int64_t timeout_in_ms)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID || timeout_ms == NULL)
+    *events_populated = 0;
+
+    // epoll_wait() consumes the events it returns, we can not wait without somewhere to put them
+    if (events == NULL || events_count == 0)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    struct timeval tv = {0, 0};
-    size_t tv_size = sizeof(tv);
-    TcsResult sts = tcs_opt_get(socket_ctx, TCS_SOL_SOCKET, TCS_SO_RCVTIMEO, &tv, &tv_size);
+    if (events_count > pool->backend.epoll.native_events_capacity)
+    {
+        if (tds_ulist_reserve((void**)&pool->backend.epoll.native_events,
+                              &pool->backend.epoll.native_events_capacity,
+                              sizeof(struct epoll_event),
+                              events_count) != 0)
+            return TCS_ERROR_MEMORY;
+    }
 
-    if (sts == TCS_SUCCESS)
+    struct epoll_event* native_events = pool->backend.epoll.native_events;
+    int wait_ret = epoll_wait(pool->backend.epoll.fd, native_events, (int)events_count, (int)timeout_in_ms);
+    if (wait_ret < 0)
+        return errno2retcode(errno);
+    if ((size_t)wait_ret > events_count)
+        return TCS_ERROR_UNKNOWN; // Corruption
+
+    for (int i = 0; i < wait_ret; ++i)
     {
-        int c = 0;
-        c += (int)tv.tv_sec * 1000;
-        c += (int)tv.tv_usec / 1000;
-        *timeout_ms = c;
+        TcsSocket fd = native_events[i].data.fd;
+        uint32_t revents = native_events[i].events;
+        events[i].socket = fd;
+        events[i].user_data = (size_t)fd < pool->backend.epoll.user_data_capacity ? pool->backend.epoll.user_data[fd]
+                                                                                   : NULL;
+        events[i].can_read = revents & EPOLLIN;
+        events[i].can_write = revents & EPOLLOUT;
+        events[i].error = (revents & EPOLLERR) == 0 ? TCS_SUCCESS
+                                                    : TCS_ERROR_NOT_IMPLEMENTED; // TODO: implement error codes
     }
-    return sts;
+    *events_populated = (size_t)wait_ret;
+
+    if (wait_ret == 0)
+        return TCS_ERROR_TIMED_OUT;
+    return TCS_SUCCESS;
 }
+#endif
 
-TcsResult tcs_opt_linger_set(TcsSocket socket_ctx, bool do_linger, int timeout_seconds)
+TcsResult tcs_pool_create(struct TcsPool** pool)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
-
-    struct linger l = {(u_short)do_linger, (u_short)timeout_seconds};
-    return tcs_opt_set(socket_ctx, TCS_SOL_SOCKET, TCS_SO_LINGER, &l, sizeof(l));
+    return tcs_pool_create_backend(pool, TCS_POOL_BACKEND_DEFAULT);
 }
 
-TcsResult tcs_opt_linger_get(TcsSocket socket_ctx, bool* do_linger, int* timeout_seconds)
+TcsResult tcs_pool_create_backend(struct TcsPool** pool, TcsPoolBackend backend)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID || (do_linger == NULL && timeout_seconds == NULL))
+    if (pool == NULL || *pool != NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    struct linger l = {0, 0};
-    size_t l_size = sizeof(l);
-    TcsResult sts = tcs_opt_get(socket_ctx, TCS_SOL_SOCKET, TCS_SO_LINGER, &l, &l_size);
-    if (sts == TCS_SUCCESS)
+    if (backend == TCS_POOL_BACKEND_DEFAULT)
+        backend = TCS_AVAILABLE_EPOLL ? TCS_POOL_BACKEND_EPOLL : TCS_POOL_BACKEND_POLL;
+
+    if (backend != TCS_POOL_BACKEND_POLL && backend != TCS_POOL_BACKEND_EPOLL && backend != TCS_POOL_BACKEND_EPOLL_ET)
+        return TCS_ERROR_INVALID_ARGUMENT;
+#if !TCS_AVAILABLE_EPOLL
+    if (backend != TCS_POOL_BACKEND_POLL)
+        return TCS_ERROR_NOT_IMPLEMENTED;
+#endif
+
+    *pool = (struct TcsPool*)malloc(sizeof(struct TcsPool));
+    if (*pool == NULL)
+        return TCS_ERROR_MEMORY;
+    memset(*pool, 0, sizeof(struct TcsPool));
+    (*pool)->type = backend;
+
+    TcsResult sts = TCS_ERROR_UNKNOWN;
+    switch (backend)
     {
-        if (do_linger)
-            *do_linger = l.l_onoff;
-        if (timeout_seconds)
-            *timeout_seconds = l.l_linger;
+#if TCS_AVAILABLE_EPOLL
+        case TCS_POOL_BACKEND_EPOLL:
+            sts = pool_epoll_create(*pool, false);
+            break;
+        case TCS_POOL_BACKEND_EPOLL_ET:
+            sts = pool_epoll_create(*pool, true);
+            break;
+#endif
+        default:
+            sts = pool_poll_create(*pool);
+            break;
+    }
+    if (sts != TCS_SUCCESS)
+    {
+        free(*pool);
+        *pool = NULL;
+        return sts;
     }
 
-    return sts;
+    return TCS_SUCCESS;
 }
 
-// tcs_opt_ip_no_delay_set() is defined in tinycsocket_common.c
-// tcs_opt_ip_no_delay_get() is defined in tinycsocket_common.c
-// tcs_opt_out_of_band_inline_set() is defined in tinycsocket_common.c
-// tcs_opt_out_of_band_inline_get() is defined in tinycsocket_common.c
-// tcs_opt_priority_set() is defined in tinycsocket_common.c
-// tcs_opt_priority_get() is defined in tinycsocket_common.c
-
-TcsResult tcs_opt_nonblocking_set(TcsSocket socket_ctx, bool do_non_blocking)
+TcsResult tcs_pool_destroy(struct TcsPool** pool)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID)
+    if (pool == NULL || *pool == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    int flags = fcntl(socket_ctx, F_GETFL, 0);
-    if (flags == -1)
-        return errno2retcode(errno);
-
-    if (do_non_blocking)
-        flags |= O_NONBLOCK; /* sätt biten */
+    TcsResult sts = TCS_ERROR_UNKNOWN;
+#if TCS_AVAILABLE_EPOLL
+    if ((*pool)->type != TCS_POOL_BACKEND_POLL)
+        sts = pool_epoll_destroy(*pool);
     else
-        flags &= ~O_NONBLOCK; /* rensa biten */
+#endif
+        sts = pool_poll_destroy(*pool);
+    if (sts != TCS_SUCCESS)
+        return sts;
 
-    if (fcntl(socket_ctx, F_SETFL, flags) == -1)
-        return errno2retcode(errno);
+    free(*pool);
+    *pool = NULL;
 
     return TCS_SUCCESS;
 }
 
-TcsResult tcs_opt_nonblocking_get(TcsSocket socket_ctx, bool* is_non_blocking)
+TcsResult tcs_pool_add(struct TcsPool* pool,
+                       TcsSocket socket_ctx,
+                       void* user_data,
+                       bool poll_can_read,
+                       bool poll_can_write,
+                       bool poll_error)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID || is_non_blocking == NULL)
+    if (pool == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (socket_ctx == TCS_SOCKET_INVALID)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    int flags = fcntl(socket_ctx, F_GETFL, 0);
-    if (flags == -1)
-        return errno2retcode(errno);
-
-    *is_non_blocking = (flags & O_NONBLOCK) != 0;
-    return TCS_SUCCESS;
+#if TCS_AVAILABLE_EPOLL
+    if (pool->type != TCS_POOL_BACKEND_POLL)
+        return pool_epoll_add(pool, socket_ctx, user_data, poll_can_read, poll_can_write, poll_error);
+#endif
+    return pool_poll_add(pool, socket_ctx, user_data, poll_can_read, poll_can_write, poll_error);
 }
 
-TcsResult tcs_opt_membership_add(TcsSocket socket_ctx, const struct TcsAddress* multicast_address)
+TcsResult tcs_pool_remove(struct TcsPool* pool, TcsSocket socket_ctx)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
-
-    if (multicast_address == NULL)
+    if (pool == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
-
-    // Todo: Replace with tcs_address_socket() when implemented
-    struct sockaddr_storage address_native_local;
-    memset(&address_native_local, 0, sizeof(struct sockaddr_storage));
-    socklen_t address_native_local_size = sizeof(struct sockaddr_storage);
-    if (getsockname(socket_ctx, (struct sockaddr*)&address_native_local, &address_native_local_size) != 0)
-        return errno2retcode(errno);
-
-    struct TcsAddress local_address = TCS_ADDRESS_NONE;
-    TcsResult sts = native2sockaddr((struct sockaddr*)&address_native_local, &local_address);
-    if (sts != TCS_SUCCESS)
-        return sts;
-
-    if (local_address.family != multicast_address->family)
+    if (socket_ctx == TCS_SOCKET_INVALID)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    return tcs_opt_membership_add_to(socket_ctx, &local_address, multicast_address);
+#if TCS_AVAILABLE_EPOLL
+    if (pool->type != TCS_POOL_BACKEND_POLL)
+        return pool_epoll_remove(pool, socket_ctx);
+#endif
+    return pool_poll_remove(pool, socket_ctx);
 }
 
-TcsResult tcs_opt_membership_add_to(TcsSocket socket_ctx,
-                                    const struct TcsAddress* local_address,
-                                    const struct TcsAddress* multicast_address)
+TcsResult tcs_pool_poll(struct TcsPool* pool,
+                        struct TcsPollEvent* events,
+                        size_t events_count,
+                        size_t* events_populated,
+                        int64_t timeout_in_ms)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID)
+    if (pool == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
-
-    if (multicast_address == NULL)
+    if (events_populated == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    if (local_address == NULL)
+    // We do not support more more elements or time than signed int32 supports.
+    // todo(markusl): Add support for int64 timeout
+    if (events_count > 0x7FFFFFFF || timeout_in_ms > 0x7FFFFFFF)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    if (local_address->family != multicast_address->family)
-        return TCS_ERROR_INVALID_ARGUMENT;
+#if TCS_AVAILABLE_EPOLL
+    if (pool->type != TCS_POOL_BACKEND_POLL)
+        return pool_epoll_wait(pool, events, events_count, events_populated, timeout_in_ms);
+#endif
+    return pool_poll_wait(pool, events, events_count, events_populated, timeout_in_ms);
+}
 
-    struct sockaddr_storage local_address_native;
-    memset(&local_address_native, 0, sizeof(struct sockaddr_storage));
-    socklen_t local_address_native_size = sizeof(struct sockaddr_storage);
-    TcsResult sts_la2n = sockaddr2native(local_address, &local_address_native, &local_address_native_size);
-    if (sts_la2n != TCS_SUCCESS)
-        return sts_la2n;
+// ######## Async I/O ########
 
-    struct sockaddr_storage multicast_address_native;
-    memset(&multicast_address_native, 0, sizeof(struct sockaddr_storage));
-    socklen_t multicast_address_native_size = sizeof(struct sockaddr_storage);
-    TcsResult sts_ma2n = sockaddr2native(multicast_address, &multicast_address_native, &multicast_address_native_size);
-    if (sts_ma2n != TCS_SUCCESS)
-        return sts_ma2n;
+#define TCS_RING_INTEREST_READ 1
+#define TCS_RING_INTEREST_WRITE 2
+#define TCS_RING_BUFFER_GROUP 0
+#define TCS_RING_INTERNAL_TAG UINT64_MAX // user_data for sqes that do not belong to a TcsRingOp
 
-    if (multicast_address->family == TCS_AF_IP4)
+static TcsResult ring_errno2retcode(int error_code)
+{
+    switch (error_code)
     {
-        const struct sockaddr_in* address_native_local_p = (struct sockaddr_in*)&local_address_native;
-        const struct sockaddr_in* address_native_multicast_p = (struct sockaddr_in*)&multicast_address_native;
+        case ECANCELED:
+        case EINTR:
+            return TCS_SHUTDOWN;
+        case ENOBUFS:
+            return TCS_ERROR_MEMORY;
+        case ECONNRESET:
+        case EPIPE:
+            return TCS_ERROR_SOCKET_CLOSED;
+        case ENOTCONN:
+            return TCS_ERROR_NOT_CONNECTED;
+        default:
+            return errno2retcode(error_code);
+    }
+}
 
-        struct ip_mreq mreq;
-        memset(&mreq, 0, sizeof mreq);
+static TcsResult ring_op_alloc(struct TcsRing* ring, size_t* index)
+{
+    if (ring->free_ops == 0)
+    {
+        size_t old_capacity = ring->ops_capacity;
+        if (tds_ulist_reserve((void**)&ring->ops, &ring->ops_capacity, sizeof(struct TcsRingOp), old_capacity + 1) != 0)
+            return TCS_ERROR_MEMORY;
+        for (size_t i = ring->ops_capacity; i > old_capacity; --i)
+        {
+            ring->ops[i - 1].next = ring->free_ops;
+            ring->free_ops = i;
+        }
+    }
+    *index = ring->free_ops - 1;
+    ring->free_ops = ring->ops[*index].next;
+    memset(&ring->ops[*index], 0, sizeof(struct TcsRingOp));
+    return TCS_SUCCESS;
+}
 
-        mreq.imr_interface.s_addr = address_native_local_p->sin_addr.s_addr;
-        mreq.imr_multiaddr.s_addr = address_native_multicast_p->sin_addr.s_addr;
+static void ring_op_free(struct TcsRing* ring, size_t index)
+{
+    ring->ops[index].socket = TCS_SOCKET_INVALID;
+    ring->ops[index].next = ring->free_ops;
+    ring->free_ops = index + 1;
+}
 
-        TcsResult sts_opt = tcs_opt_set(socket_ctx, TCS_SOL_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
-        if (sts_opt != TCS_SUCCESS)
-            return sts_opt;
-        return TCS_SUCCESS;
-    }
-    else if (multicast_address->family == TCS_AF_IP6)
+static void ring_completion_init(struct TcsRingCompletion* completion, const struct TcsRingOp* op)
+{
+    completion->socket = op->socket;
+    completion->user_data = op->user_data;
+    completion->operation = op->operation;
+    completion->result = TCS_SUCCESS;
+    completion->bytes = 0;
+    completion->accepted = TCS_SOCKET_INVALID;
+    completion->buffer_id = -1;
+    completion->more = false;
+}
+
+#if TCS_AVAILABLE_IO_URING
+// io_uring backend. liburing is not used to keep the library header only, the ring is driven with raw syscalls.
+
+static TcsResult ring_uring_create(struct TcsRing* ring, unsigned int queue_depth)
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof params);
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+    params.cq_entries = queue_depth * 4; // Multishot operations can complete many times per submission
+
+    int fd = (int)syscall(__NR_io_uring_setup, queue_depth, &params);
+    if (fd < 0)
+        return TCS_ERROR_NOT_IMPLEMENTED;
+
+    const uint32_t required_features = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+    if ((params.features & required_features) != required_features)
     {
+        close(fd);
         return TCS_ERROR_NOT_IMPLEMENTED;
     }
-    else if (multicast_address->family == TCS_AF_PACKET)
-    {
-#if TCS_AVAILABLE_AF_PACKET
-        const struct sockaddr_ll* address_native_local_p = (struct sockaddr_ll*)&local_address_native;
-        const struct sockaddr_ll* address_native_multicast_p = (struct sockaddr_ll*)&multicast_address_native;
-
-        struct packet_mreq mreq;
-        memset(&mreq, 0, sizeof mreq);
-        mreq.mr_ifindex = address_native_local_p->sll_ifindex;
-        mreq.mr_type = PACKET_MR_MULTICAST;
-        memcpy(mreq.mr_address, address_native_multicast_p->sll_addr, ETH_ALEN);
-        mreq.mr_alen = ETH_ALEN;
 
-        TcsResult sts_opt = tcs_opt_set(socket_ctx, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
-        if (sts_opt != TCS_SUCCESS)
-            return sts_opt;
-        return TCS_SUCCESS;
-#else
+    // Multishot receive and buffer rings arrived together with IORING_OP_SEND_ZC in Linux 6.0
+    uint8_t probe_memory[sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op)];
+    memset(probe_memory, 0, sizeof probe_memory);
+    struct io_uring_probe* probe = (struct io_uring_probe*)probe_memory;
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) < 0 ||
+        probe->ops_len <= IORING_OP_SEND_ZC || (probe->ops[IORING_OP_SEND_ZC].flags & IO_URING_OP_SUPPORTED) == 0)
+    {
+        close(fd);
         return TCS_ERROR_NOT_IMPLEMENTED;
-#endif
     }
-    else
+
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    size_t ring_size = sq_size > cq_size ? sq_size : cq_size;
+    void* ring_ptr = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring_ptr == MAP_FAILED)
     {
-        return TCS_ERROR_NOT_IMPLEMENTED;
+        close(fd);
+        return TCS_ERROR_MEMORY;
+    }
+    size_t sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(NULL, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        munmap(ring_ptr, ring_size);
+        close(fd);
+        return TCS_ERROR_MEMORY;
     }
 
-    return TCS_ERROR_UNKNOWN; // Not reachable
+    uint8_t* base = (uint8_t*)ring_ptr;
+    ring->uring.fd = fd;
+    ring->uring.ring_ptr = ring_ptr;
+    ring->uring.ring_size = ring_size;
+    ring->uring.sqes = (struct io_uring_sqe*)sqes;
+    ring->uring.sqes_size = sqes_size;
+    ring->uring.sq_khead = (uint32_t*)(base + params.sq_off.head);
+    ring->uring.sq_ktail = (uint32_t*)(base + params.sq_off.tail);
+    ring->uring.sq_mask = *(uint32_t*)(base + params.sq_off.ring_mask);
+    ring->uring.sq_entries = params.sq_entries;
+    ring->uring.sq_tail = *ring->uring.sq_ktail;
+    ring->uring.cq_khead = (uint32_t*)(base + params.cq_off.head);
+    ring->uring.cq_ktail = (uint32_t*)(base + params.cq_off.tail);
+    ring->uring.cq_mask = *(uint32_t*)(base + params.cq_off.ring_mask);
+    ring->uring.cqes = (struct io_uring_cqe*)(base + params.cq_off.cqes);
+
+    // Slot i of the submission array always points at sqe i
+    uint32_t* sq_array = (uint32_t*)(base + params.sq_off.array);
+    for (uint32_t i = 0; i < params.sq_entries; ++i)
+        sq_array[i] = i;
+
+    return TCS_SUCCESS;
 }
 
-TcsResult tcs_opt_membership_drop(TcsSocket socket_ctx, const struct TcsAddress* multicast_address)
+static void ring_uring_destroy(struct TcsRing* ring)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
+    if (ring->uring.buf_ring != NULL)
+        munmap(ring->uring.buf_ring, ring->uring.buf_ring_size);
+    munmap(ring->uring.sqes, ring->uring.sqes_size);
+    munmap(ring->uring.ring_ptr, ring->uring.ring_size);
+    close(ring->uring.fd); // Also unregisters the buffer ring
+}
 
-    if (multicast_address == NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
+static TcsResult ring_uring_enter(struct TcsRing* ring, unsigned int min_complete, int64_t timeout_in_ms)
+{
+    __atomic_store_n(ring->uring.sq_ktail, ring->uring.sq_tail, __ATOMIC_RELEASE);
 
-    // Todo: Replace with tcs_address_socket() when implemented
-    struct sockaddr_storage address_native_local;
-    memset(&address_native_local, 0, sizeof address_native_local);
-    socklen_t address_native_local_size = sizeof(struct sockaddr_storage);
-    if (getsockname(socket_ctx, (struct sockaddr*)&address_native_local, &address_native_local_size) != 0)
+    unsigned int flags = 0;
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof arg);
+    if (min_complete > 0)
+    {
+        flags |= IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+        if (timeout_in_ms >= 0)
+        {
+            ts.tv_sec = timeout_in_ms / 1000;
+            ts.tv_nsec = (timeout_in_ms % 1000) * 1000000;
+            arg.ts = (uint64_t)(uintptr_t)&ts;
+        }
+    }
+
+    long ret = syscall(__NR_io_uring_enter,
+                       ring->uring.fd,
+                       ring->uring.to_submit,
+                       min_complete,
+                       flags,
+                       flags & IORING_ENTER_EXT_ARG ? &arg : NULL,
+                       sizeof arg);
+    if (ret < 0)
+    {
+        if (errno == ETIME || errno == EINTR)
+            return TCS_ERROR_TIMED_OUT;
+        if (errno == EBUSY) // Completion queue is full, reap before submitting more
+            return TCS_SUCCESS;
         return errno2retcode(errno);
+    }
+    ring->uring.to_submit -= (uint32_t)ret;
+    return TCS_SUCCESS;
+}
 
-    struct TcsAddress local_address = TCS_ADDRESS_NONE;
-    TcsResult sts = native2sockaddr((struct sockaddr*)&address_native_local, &local_address);
-    if (sts != TCS_SUCCESS)
-        return sts;
+static struct io_uring_sqe* ring_uring_sqe(struct TcsRing* ring)
+{
+    uint32_t head = __atomic_load_n(ring->uring.sq_khead, __ATOMIC_ACQUIRE);
+    if (ring->uring.sq_tail - head >= ring->uring.sq_entries)
+    {
+        // Queue is full, hand what we have to the kernel first
+        if (ring_uring_enter(ring, 0, 0) != TCS_SUCCESS)
+            return NULL;
+        head = __atomic_load_n(ring->uring.sq_khead, __ATOMIC_ACQUIRE);
+        if (ring->uring.sq_tail - head >= ring->uring.sq_entries)
+            return NULL;
+    }
+    struct io_uring_sqe* sqe = &ring->uring.sqes[ring->uring.sq_tail & ring->uring.sq_mask];
+    memset(sqe, 0, sizeof *sqe);
+    ring->uring.sq_tail++;
+    ring->uring.to_submit++;
+    return sqe;
+}
 
-    if (local_address.family != multicast_address->family)
-        return TCS_ERROR_INVALID_ARGUMENT;
+static TcsResult ring_uring_queue(struct TcsRing* ring, size_t index)
+{
+    struct io_uring_sqe* sqe = ring_uring_sqe(ring);
+    if (sqe == NULL)
+        return TCS_AGAIN;
 
-    return tcs_opt_membership_drop_from(socket_ctx, &local_address, multicast_address);
+    const struct TcsRingOp* op = &ring->ops[index];
+    sqe->fd = op->socket;
+    sqe->user_data = (uint64_t)index;
+    switch (op->operation)
+    {
+        case TCS_RING_SEND:
+            sqe->opcode = IORING_OP_SEND;
+            sqe->addr = (uint64_t)(uintptr_t)op->buffer;
+            sqe->len = (uint32_t)op->buffer_size;
+            sqe->msg_flags = MSG_NOSIGNAL;
+            break;
+        case TCS_RING_RECEIVE:
+            sqe->opcode = IORING_OP_RECV;
+            if (op->buffer != NULL)
+            {
+                sqe->addr = (uint64_t)(uintptr_t)op->buffer;
+                sqe->len = (uint32_t)op->buffer_size;
+            }
+            else
+            {
+                sqe->flags |= IOSQE_BUFFER_SELECT;
+                sqe->buf_group = TCS_RING_BUFFER_GROUP;
+            }
+            if (op->multishot)
+                sqe->ioprio |= IORING_RECV_MULTISHOT;
+            break;
+        case TCS_RING_ACCEPT:
+            sqe->opcode = IORING_OP_ACCEPT;
+            if (op->multishot)
+                sqe->ioprio |= IORING_ACCEPT_MULTISHOT;
+            break;
+    }
+    return TCS_SUCCESS;
 }
 
-TcsResult tcs_opt_membership_drop_from(TcsSocket socket_ctx,
-                                       const struct TcsAddress* local_address,
-                                       const struct TcsAddress* multicast_address)
+static void ring_uring_buffer_push(struct TcsRing* ring, uint16_t buffer_id)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
-
-    if (multicast_address == NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
+    struct io_uring_buf* buf = &ring->uring.buf_ring->bufs[ring->uring.buf_ring_tail & (ring->buffer_count - 1)];
+    buf->addr = (uint64_t)(uintptr_t)(ring->buffers + (size_t)buffer_id * ring->buffer_size);
+    buf->len = (uint32_t)ring->buffer_size;
+    buf->bid = buffer_id;
+    ring->uring.buf_ring_tail++;
+}
 
-    if (local_address == NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
+static TcsResult ring_uring_buffers_register(struct TcsRing* ring)
+{
+    size_t size = ring->buffer_count * sizeof(struct io_uring_buf);
+    void* buf_ring = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (buf_ring == MAP_FAILED)
+        return TCS_ERROR_MEMORY;
 
-    if (local_address->family != multicast_address->family)
-        return TCS_ERROR_INVALID_ARGUMENT;
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof reg);
+    reg.ring_addr = (uint64_t)(uintptr_t)buf_ring;
+    reg.ring_entries = (uint32_t)ring->buffer_count;
+    reg.bgid = TCS_RING_BUFFER_GROUP;
+    if (syscall(__NR_io_uring_register, ring->uring.fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    {
+        TcsResult sts = errno2retcode(errno);
+        munmap(buf_ring, size);
+        return sts;
+    }
+    ring->uring.buf_ring = (struct io_uring_buf_ring*)buf_ring;
+    ring->uring.buf_ring_size = size;
+    ring->uring.buf_ring_tail = 0;
 
-    struct sockaddr_storage local_address_native;
-    memset(&local_address_native, 0, sizeof(struct sockaddr_storage));
-    socklen_t local_address_native_size = 0;
-    TcsResult sts_la2n = sockaddr2native(local_address, &local_address_native, &local_address_native_size);
-    if (sts_la2n != TCS_SUCCESS)
-        return sts_la2n;
+    for (size_t i = 0; i < ring->buffer_count; ++i)
+        ring_uring_buffer_push(ring, (uint16_t)i);
+    __atomic_store_n(&ring->uring.buf_ring->tail, ring->uring.buf_ring_tail, __ATOMIC_RELEASE);
+    return TCS_SUCCESS;
+}
 
-    struct sockaddr_storage multicast_address_native;
-    memset(&multicast_address_native, 0, sizeof(struct sockaddr_storage));
-    socklen_t multicast_address_native_size = 0;
-    TcsResult sts_ma2n = sockaddr2native(multicast_address, &multicast_address_native, &multicast_address_native_size);
-    if (sts_ma2n != TCS_SUCCESS)
-        return sts_ma2n;
+static size_t ring_uring_reap(struct TcsRing* ring, struct TcsRingCompletion* completions, size_t completions_count)
+{
+    uint32_t head = *ring->uring.cq_khead;
+    uint32_t tail = __atomic_load_n(ring->uring.cq_ktail, __ATOMIC_ACQUIRE);
+    size_t filled = 0;
 
-    if (multicast_address->family == TCS_AF_IP4)
+    while (head != tail && filled < completions_count)
     {
-        const struct sockaddr_in* address_native_local_p = (struct sockaddr_in*)&local_address_native;
-        const struct sockaddr_in* address_native_multicast_p = (struct sockaddr_in*)&multicast_address_native;
+        const struct io_uring_cqe* cqe = &ring->uring.cqes[head & ring->uring.cq_mask];
+        head++;
+        if (cqe->user_data == TCS_RING_INTERNAL_TAG)
+            continue;
 
-        struct ip_mreq mreq;
-        memset(&mreq, 0, sizeof mreq);
+        size_t index = (size_t)cqe->user_data;
+        const struct TcsRingOp* op = &ring->ops[index];
+        struct TcsRingCompletion* completion = &completions[filled++];
+        ring_completion_init(completion, op);
+        completion->more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+        if (cqe->flags & IORING_CQE_F_BUFFER)
+            completion->buffer_id = (int)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+
+        if (cqe->res < 0)
+            completion->result = ring_errno2retcode(-cqe->res);
+        else if (op->operation == TCS_RING_ACCEPT)
+            completion->accepted = cqe->res;
+        else if (op->operation == TCS_RING_RECEIVE && cqe->res == 0)
+            completion->result = TCS_SHUTDOWN;
+        else
+            completion->bytes = (size_t)cqe->res;
 
-        mreq.imr_interface.s_addr = address_native_local_p->sin_addr.s_addr;
-        mreq.imr_multiaddr.s_addr = address_native_multicast_p->sin_addr.s_addr;
+        if (!completion->more)
+            ring_op_free(ring, index);
+    }
+    __atomic_store_n(ring->uring.cq_khead, head, __ATOMIC_RELEASE);
+    return filled;
+}
+#endif
 
-        TcsResult sts_opt = tcs_opt_set(socket_ctx, TCS_SOL_IP, IP_DROP_MEMBERSHIP, &mreq, sizeof(mreq));
-        if (sts_opt != TCS_SUCCESS)
-            return sts_opt;
+// TcsPool fallback. Operations wait per socket until the pool reports the socket ready, then run non-blocking.
+
+static TcsResult ring_fallback_update_interest(struct TcsRing* ring, TcsSocket socket_ctx)
+{
+    uint8_t interest = 0;
+    for (size_t i = ring->fallback.socket_ops[socket_ctx]; i != 0; i = ring->ops[i - 1].next)
+        interest |= ring->ops[i - 1].operation == TCS_RING_SEND ? TCS_RING_INTEREST_WRITE : TCS_RING_INTEREST_READ;
+
+    uint8_t registered = ring->fallback.interest[socket_ctx];
+    if (interest == registered)
         return TCS_SUCCESS;
+    if (registered != 0)
+        tcs_pool_remove(ring->fallback.pool, socket_ctx);
+    ring->fallback.interest[socket_ctx] = 0;
+    if (interest != 0)
+    {
+        TcsResult sts = tcs_pool_add(ring->fallback.pool,
+                                     socket_ctx,
+                                     NULL,
+                                     interest & TCS_RING_INTEREST_READ,
+                                     interest & TCS_RING_INTEREST_WRITE,
+                                     true);
+        if (sts != TCS_SUCCESS)
+            return sts;
     }
-    else if (multicast_address->family == TCS_AF_IP6)
+    ring->fallback.interest[socket_ctx] = interest;
+    return TCS_SUCCESS;
+}
+
+static TcsResult ring_fallback_queue(struct TcsRing* ring, size_t index)
+{
+    TcsSocket socket_ctx = ring->ops[index].socket;
+    if (socket_ctx < 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if ((size_t)socket_ctx >= ring->fallback.socket_ops_capacity &&
+        tds_ulist_reserve((void**)&ring->fallback.socket_ops,
+                          &ring->fallback.socket_ops_capacity,
+                          sizeof(size_t),
+                          (size_t)socket_ctx + 1) != 0)
+        return TCS_ERROR_MEMORY;
+    if ((size_t)socket_ctx >= ring->fallback.interest_capacity &&
+        tds_ulist_reserve((void**)&ring->fallback.interest,
+                          &ring->fallback.interest_capacity,
+                          sizeof(uint8_t),
+                          (size_t)socket_ctx + 1) != 0)
+        return TCS_ERROR_MEMORY;
+
+    // Append to keep operations on a socket in queue order
+    size_t* link = &ring->fallback.socket_ops[socket_ctx];
+    while (*link != 0)
+        link = &ring->ops[*link - 1].next;
+    ring->ops[index].next = 0;
+    *link = index + 1;
+
+    TcsResult sts = ring_fallback_update_interest(ring, socket_ctx);
+    if (sts != TCS_SUCCESS)
     {
-        return TCS_ERROR_NOT_IMPLEMENTED;
+        *link = 0;
+        return sts;
     }
-    else if (multicast_address->family == TCS_AF_PACKET)
-    {
-#if TCS_AVAILABLE_AF_PACKET
-        const struct sockaddr_ll* address_native_local_p = (struct sockaddr_ll*)&local_address_native;
-        const struct sockaddr_ll* address_native_multicast_p = (struct sockaddr_ll*)&multicast_address_native;
+    return TCS_SUCCESS;
+}
 
-        struct packet_mreq mreq;
-        memset(&mreq, 0, sizeof mreq);
-        mreq.mr_ifindex = address_native_local_p->sll_ifindex;
-        mreq.mr_type = PACKET_MR_MULTICAST;
-        memcpy(mreq.mr_address, address_native_multicast_p->sll_addr, ETH_ALEN);
-        mreq.mr_alen = ETH_ALEN;
+// Returns false if the operation would block and stays queued
+static bool ring_fallback_run(struct TcsRing* ring, size_t index, struct TcsRingCompletion* completion)
+{
+    struct TcsRingOp* op = &ring->ops[index];
+    ring_completion_init(completion, op);
 
-        TcsResult sts_opt = tcs_opt_set(socket_ctx, SOL_PACKET, PACKET_DROP_MEMBERSHIP, &mreq, sizeof(mreq));
-        if (sts_opt != TCS_SUCCESS)
-            return sts_opt;
-        return TCS_SUCCESS;
-#else
-        return TCS_ERROR_NOT_IMPLEMENTED;
-#endif
-    }
-    else
+    ssize_t ret = 0;
+    switch (op->operation)
     {
-        return TCS_ERROR_NOT_IMPLEMENTED;
+        case TCS_RING_SEND:
+            ret = send(op->socket, op->buffer, op->buffer_size, MSG_DONTWAIT | TCS_DEFAULT_SEND_FLAGS);
+            break;
+        case TCS_RING_RECEIVE:
+        {
+            uint8_t* buffer = op->buffer;
+            size_t buffer_size = op->buffer_size;
+            if (buffer == NULL)
+            {
+                if (ring->fallback.free_buffer_count == 0)
+                {
+                    completion->result = TCS_ERROR_MEMORY;
+                    return true;
+                }
+                completion->buffer_id = ring->fallback.free_buffers[--ring->fallback.free_buffer_count];
+                buffer = ring->buffers + (size_t)completion->buffer_id * ring->buffer_size;
+                buffer_size = ring->buffer_size;
+            }
+            ret = recv(op->socket, buffer, buffer_size, MSG_DONTWAIT);
+            if (ret < 0 && completion->buffer_id >= 0)
+            {
+                ring->fallback.free_buffers[ring->fallback.free_buffer_count++] = (uint16_t)completion->buffer_id;
+                completion->buffer_id = -1;
+            }
+            break;
+        }
+        case TCS_RING_ACCEPT:
+            ret = accept(op->socket, NULL, NULL);
+            break;
     }
 
-    return TCS_ERROR_UNKNOWN; // Not reachable
+    if (ret < 0)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return false;
+        completion->result = ring_errno2retcode(errno);
+        return true;
+    }
+    if (op->operation == TCS_RING_ACCEPT)
+        completion->accepted = (TcsSocket)ret;
+    else if (op->operation == TCS_RING_RECEIVE && ret == 0)
+        completion->result = TCS_SHUTDOWN;
+    else
+        completion->bytes = (size_t)ret;
+    completion->more = op->multishot && completion->result == TCS_SUCCESS;
+    return true;
 }
 
-// ######## Address and Interface Utilities ########
-
-TcsResult tcs_interface_list(struct TcsInterface* found_interfaces,
-                             size_t interfaces_length,
-                             size_t* interfaces_populated)
+static TcsResult ring_fallback_wait(struct TcsRing* ring,
+                                    struct TcsRingCompletion* completions,
+                                    size_t completions_count,
+                                    size_t* completions_populated,
+                                    int64_t timeout_in_ms)
 {
-    if (found_interfaces == NULL && interfaces_populated == NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
+    size_t filled = 0;
 
-    if (found_interfaces == NULL && interfaces_length != 0)
-        return TCS_ERROR_INVALID_ARGUMENT;
+    // Report canceled operations first, they do not need the pool
+    while (ring->fallback.canceled != 0 && filled < completions_count)
+    {
+        size_t index = ring->fallback.canceled - 1;
+        ring->fallback.canceled = ring->ops[index].next;
+        ring_completion_init(&completions[filled], &ring->ops[index]);
+        completions[filled++].result = TCS_SHUTDOWN;
+        ring_op_free(ring, index);
+    }
+    if (filled > 0)
+    {
+        *completions_populated = filled;
+        return TCS_SUCCESS;
+    }
 
-    if (interfaces_populated != NULL)
-        *interfaces_populated = 0;
+    if (completions_count > ring->fallback.events_capacity &&
+        tds_ulist_reserve((void**)&ring->fallback.events,
+                          &ring->fallback.events_capacity,
+                          sizeof(struct TcsPollEvent),
+                          completions_count) != 0)
+        return TCS_ERROR_MEMORY;
 
-    struct if_nameindex* interfaces = if_nameindex();
-    if (interfaces == NULL)
-        return errno2retcode(errno);
+    size_t populated = 0;
+    TcsResult sts =
+        tcs_pool_poll(ring->fallback.pool, ring->fallback.events, completions_count, &populated, timeout_in_ms);
+    if (sts != TCS_SUCCESS)
+        return errno == EINTR ? TCS_ERROR_TIMED_OUT : sts; // Same as the io_uring backend
 
-    if (found_interfaces != NULL)
+    for (size_t e = 0; e < populated && filled < completions_count; ++e)
     {
-        for (size_t i = 0; i < interfaces_length && interfaces[i].if_index != 0; ++i)
+        const struct TcsPollEvent* ev = &ring->fallback.events[e];
+        TcsSocket socket_ctx = ev->socket;
+        // Hang-up or error without read/write readiness: run everything so the failures are reported
+        bool run_all = ev->error != TCS_SUCCESS || (!ev->can_read && !ev->can_write);
+
+        size_t* link = &ring->fallback.socket_ops[socket_ctx];
+        while (*link != 0 && filled < completions_count)
         {
-            strncpy(found_interfaces[i].name, interfaces[i].if_name, 31);
-            found_interfaces[i].name[31] = '\0';
-            found_interfaces[i].id = interfaces[i].if_index;
-            if (interfaces_populated != NULL)
-                *interfaces_populated += 1;
+            size_t index = *link - 1;
+            struct TcsRingOp* op = &ring->ops[index];
+            bool ready = run_all || (op->operation == TCS_RING_SEND ? ev->can_write : ev->can_read);
+            if (!ready || !ring_fallback_run(ring, index, &completions[filled]))
+            {
+                link = &op->next;
+                continue;
+            }
+            if (completions[filled++].more)
+            {
+                link = &op->next;
+                continue;
+            }
+            *link = op->next;
+            ring_op_free(ring, index);
         }
-    }
-    else // found_interfaces == NULL && interface_populated != NULL
-    {
-        for (size_t i = 0; interfaces[i].if_index != 0; ++i)
-            *interfaces_populated += 1;
+        sts = ring_fallback_update_interest(ring, socket_ctx);
+        if (sts != TCS_SUCCESS)
+            return sts;
     }
 
-    if_freenameindex(interfaces);
-    return TCS_SUCCESS;
+    *completions_populated = filled;
+    return filled > 0 ? TCS_SUCCESS : TCS_ERROR_TIMED_OUT;
 }
 
-TcsResult tcs_address_resolve(const char* hostname,
-                              TcsAddressFamily address_family,
-                              struct TcsAddress found_addresses[],
-                              size_t found_addresses_length,
-                              size_t* no_of_found_addresses)
+static TcsResult ring_queue(struct TcsRing* ring,
+                            TcsRingOperation operation,
+                            TcsSocket socket_ctx,
+                            uint8_t* buffer,
+                            size_t buffer_size,
+                            bool multishot,
+                            void* user_data)
 {
-    if (hostname == NULL)
+    if (ring == NULL || socket_ctx == TCS_SOCKET_INVALID)
         return TCS_ERROR_INVALID_ARGUMENT;
-
-    if (found_addresses == NULL && no_of_found_addresses == NULL)
+    if (buffer_size > UINT32_MAX)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    if (no_of_found_addresses != NULL)
-        *no_of_found_addresses = 0;
-
-    struct addrinfo native_hints;
-    memset(&native_hints, 0, sizeof native_hints);
-    TcsResult family_convert_status = family2native(address_family, (sa_family_t*)&native_hints.ai_family);
-    if (family_convert_status != TCS_SUCCESS)
-        return family_convert_status;
-    native_hints.ai_flags = AI_NUMERICSERV;
-    native_hints.ai_socktype = SOCK_DGRAM;
-    native_hints.ai_protocol = IPPROTO_UDP;
-
-    struct addrinfo* native_addrinfo_list = NULL;
-    int sts = getaddrinfo(hostname, NULL, &native_hints, &native_addrinfo_list);
+    size_t index = 0;
+    TcsResult sts = ring_op_alloc(ring, &index);
+    if (sts != TCS_SUCCESS)
+        return sts;
+    struct TcsRingOp* op = &ring->ops[index];
+    op->operation = operation;
+    op->socket = socket_ctx;
+    op->user_data = user_data;
+    op->buffer = buffer;
+    op->buffer_size = buffer_size;
+    op->multishot = multishot;
+
+#if TCS_AVAILABLE_IO_URING
+    if (ring->native)
+        sts = ring_uring_queue(ring, index);
+    else
+#endif
+        sts = ring_fallback_queue(ring, index);
+    if (sts != TCS_SUCCESS)
+        ring_op_free(ring, index);
+    return sts;
+}
 
-    // TODO: Move error codes to errno2retcode()
-    if (sts == EAI_SYSTEM)
-        return errno2retcode(errno);
-    else if (sts == EAI_AGAIN)
-        return TCS_ERROR_TEMPRORARY_FAILURE;
-    else if (sts == EAI_BADFLAGS)
-        return TCS_ERROR_INVALID_ARGUMENT;
-    else if (sts == EAI_FAIL)
-        return TCS_ERROR_ADDRESS_LOOKUP_FAILED;
-    else if (sts == EAI_FAMILY)
+TcsResult tcs_ring_create(struct TcsRing** ring, unsigned int queue_depth, bool try_io_uring)
+{
+    if (ring == NULL || *ring != NULL || queue_depth == 0 || queue_depth > 32768)
         return TCS_ERROR_INVALID_ARGUMENT;
-    else if (sts == EAI_MEMORY)
+
+    *ring = (struct TcsRing*)malloc(sizeof(struct TcsRing));
+    if (*ring == NULL)
         return TCS_ERROR_MEMORY;
-    else if (sts == EAI_NONAME)
-        return TCS_ERROR_ADDRESS_LOOKUP_FAILED;
-    else if (sts == EAI_SERVICE)
-        return TCS_ERROR_INVALID_ARGUMENT;
-    else if (native_addrinfo_list == NULL)
-        return TCS_ERROR_UNKNOWN;
-    else if (sts != 0)
-        return errno2retcode(sts);
+    memset(*ring, 0, sizeof(struct TcsRing));
 
-    size_t i = 0;
-    if (found_addresses == NULL)
+#if TCS_AVAILABLE_IO_URING
+    if (try_io_uring && ring_uring_create(*ring, queue_depth) == TCS_SUCCESS)
     {
-        for (struct addrinfo* iter = native_addrinfo_list; iter != NULL; iter = iter->ai_next)
-            i++;
+        (*ring)->native = true;
+        return TCS_SUCCESS;
     }
-    else
+#else
+    (void)try_io_uring;
+#endif
+
+    TcsResult sts = tcs_pool_create(&(*ring)->fallback.pool);
+    if (sts != TCS_SUCCESS)
     {
-        for (struct addrinfo* iter = native_addrinfo_list; iter != NULL && i < found_addresses_length;
-             iter = iter->ai_next)
-        {
-            TcsResult convert_address_status = native2sockaddr(iter->ai_addr, &found_addresses[i]);
-            if (convert_address_status != TCS_SUCCESS)
-                continue;
-            i++;
-        }
+        free(*ring);
+        *ring = NULL;
+        return sts;
     }
-    if (no_of_found_addresses != NULL)
-        *no_of_found_addresses = i;
-
-    freeaddrinfo(native_addrinfo_list);
+    return TCS_SUCCESS;
+}
 
-    if (i == 0)
-        return TCS_ERROR_ADDRESS_LOOKUP_FAILED;
+TcsResult tcs_ring_destroy(struct TcsRing** ring)
+{
+    if (ring == NULL || *ring == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
+#if TCS_AVAILABLE_IO_URING
+    if ((*ring)->native)
+        ring_uring_destroy(*ring);
+    else
+#endif
+        tcs_pool_destroy(&(*ring)->fallback.pool);
+
+    free((*ring)->fallback.socket_ops);
+    free((*ring)->fallback.interest);
+    free((*ring)->fallback.free_buffers);
+    free((*ring)->fallback.events);
+    free((*ring)->ops);
+    free(*ring);
+    *ring = NULL;
     return TCS_SUCCESS;
 }
 
-TcsResult tcs_address_resolve_timeout(const char* hostname,
-                                      TcsAddressFamily address_family,
-                                      struct TcsAddress addresses[],
-                                      size_t capacity,
-                                      size_t* out_count,
-                                      int timeout_ms)
+bool tcs_ring_is_io_uring(const struct TcsRing* ring)
 {
-    return TCS_ERROR_NOT_IMPLEMENTED;
+    return ring != NULL && ring->native;
 }
 
-#if TCS_AVAILABLE_IFADDRS // acquired from CMake
-TcsResult tcs_address_list(unsigned int interface_id_filter,
-                           TcsAddressFamily address_family_filter,
-                           struct TcsInterfaceAddress interface_addresses[],
-                           size_t capacity,
-                           size_t* out_count)
+TcsResult tcs_ring_buffers_register(struct TcsRing* ring, uint8_t* memory, size_t buffer_size, size_t buffer_count)
 {
-    if (interface_addresses == NULL && out_count == NULL)
+    if (ring == NULL || memory == NULL || ring->buffers != NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
-    if (interface_addresses == NULL && capacity != 0)
+    if (buffer_size == 0 || buffer_size > UINT32_MAX)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (buffer_count == 0 || buffer_count > 32768 || (buffer_count & (buffer_count - 1)) != 0)
         return TCS_ERROR_INVALID_ARGUMENT;
-    if (out_count != NULL)
-        *out_count = 0;
 
-    struct ifaddrs* ifap = NULL;
-    if (getifaddrs(&ifap) == -1)
+    ring->buffers = memory;
+    ring->buffer_size = buffer_size;
+    ring->buffer_count = buffer_count;
+
+    TcsResult sts = TCS_SUCCESS;
+#if TCS_AVAILABLE_IO_URING
+    if (ring->native)
+        sts = ring_uring_buffers_register(ring);
+    else
+#endif
     {
-        if (ifap != NULL)
-            freeifaddrs(ifap);
-        return errno2retcode(errno);
+        ring->fallback.free_buffers = (uint16_t*)malloc(buffer_count * sizeof(uint16_t));
+        if (ring->fallback.free_buffers == NULL)
+            sts = TCS_ERROR_MEMORY;
+        // Reversed so buffer 0 is handed out first
+        for (size_t i = 0; sts == TCS_SUCCESS && i < buffer_count; ++i)
+            ring->fallback.free_buffers[i] = (uint16_t)(buffer_count - 1 - i);
+        ring->fallback.free_buffer_count = sts == TCS_SUCCESS ? buffer_count : 0;
     }
+    if (sts != TCS_SUCCESS)
+        ring->buffers = NULL;
+    return sts;
+}
 
-    if (ifap == NULL)
-        return TCS_ERROR_UNKNOWN;
+TcsResult tcs_ring_buffer_release(struct TcsRing* ring, int buffer_id)
+{
+    if (ring == NULL || ring->buffers == NULL || buffer_id < 0 || (size_t)buffer_id >= ring->buffer_count)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-    size_t populated = 0;
-    for (struct ifaddrs* iter = ifap; iter != NULL; iter = iter->ifa_next)
+#if TCS_AVAILABLE_IO_URING
+    if (ring->native)
     {
-        if (iter->ifa_addr == NULL)
-            continue;
-
-        if (interface_id_filter != 0)
-        {
-            unsigned int id = if_nametoindex(iter->ifa_name);
-            if (id == 0)
-            {
-                freeifaddrs(ifap);
-                return errno2retcode(errno);
-            }
-            if (id != interface_id_filter)
-                continue;
-        }
-        if (address_family_filter != TCS_AF_ANY)
-        {
-            sa_family_t native_family;
-            TcsResult family_convert_status = family2native(address_family_filter, &native_family);
-            if (family_convert_status == TCS_ERROR_NOT_IMPLEMENTED)
-                continue;
-            if (family_convert_status != TCS_SUCCESS)
-            {
-                freeifaddrs(ifap);
-                return family_convert_status;
-            }
-            if (iter->ifa_addr->sa_family != native_family)
-                continue;
-        }
-
-        struct TcsAddress address = TCS_ADDRESS_NONE;
-        TcsResult convert_address_status = native2sockaddr(iter->ifa_addr, &address);
-        if (convert_address_status == TCS_ERROR_NOT_IMPLEMENTED)
-            continue;
-        if (convert_address_status != TCS_SUCCESS)
-        {
-            freeifaddrs(ifap);
-            return convert_address_status;
-        }
-
-        if (interface_addresses != NULL && populated < capacity)
-        {
-            unsigned int interface_id = if_nametoindex(iter->ifa_name);
-            if (interface_id == 0)
-            {
-                freeifaddrs(ifap);
-                return errno2retcode(errno);
-            }
-
-            strncpy(interface_addresses[populated].iface.name, iter->ifa_name, 31);
-            interface_addresses[populated].iface.name[31] = '\0';
-            interface_addresses[populated].iface.id = interface_id;
-            interface_addresses[populated].address = address;
-            populated++;
-
-            if (out_count != NULL)
-                (*out_count)++;
-        }
-        else if (interface_addresses == NULL && out_count != NULL)
-        {
-            (*out_count)++;
-        }
+        ring_uring_buffer_push(ring, (uint16_t)buffer_id);
+        __atomic_store_n(&ring->uring.buf_ring->tail, ring->uring.buf_ring_tail, __ATOMIC_RELEASE);
+        return TCS_SUCCESS;
     }
-
-    freeifaddrs(ifap);
+#endif
+    if (ring->fallback.free_buffer_count >= ring->buffer_count)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    ring->fallback.free_buffers[ring->fallback.free_buffer_count++] = (uint16_t)buffer_id;
     return TCS_SUCCESS;
 }
-#else
-// SunOS before 2010, HP and AIX does not support getifaddrs
-// ioctl implementation,
-// https://stackoverflow.com/questions/4139405/how-can-i-get-to-know-the-ip-address-for-interfaces-in-c/4139811#4139811
-TcsResult tcs_address_list(unsigned int interface_id_filter,
-                           TcsAddressFamily address_family_filter,
-                           struct TcsInterfaceAddress interface_addresses[],
-                           size_t capacity,
-                           size_t* out_count)
+
+TcsResult tcs_ring_send(struct TcsRing* ring,
+                        TcsSocket socket_ctx,
+                        const uint8_t* buffer,
+                        size_t buffer_size,
+                        void* user_data)
 {
-    return TCS_ERROR_NOT_IMPLEMENTED;
+    if (buffer == NULL || buffer_size == 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    // The ring never writes to send buffers
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-qual"
+    return ring_queue(ring, TCS_RING_SEND, socket_ctx, (uint8_t*)buffer, buffer_size, false, user_data);
+#pragma GCC diagnostic pop
 }
-#endif
 
-TcsResult tcs_address_socket_local(TcsSocket socket_ctx, struct TcsAddress* local_address)
+TcsResult tcs_ring_receive(struct TcsRing* ring,
+                           TcsSocket socket_ctx,
+                           uint8_t* buffer,
+                           size_t buffer_size,
+                           void* user_data)
 {
-    return TCS_ERROR_NOT_IMPLEMENTED;
+    if (ring == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (buffer == NULL && ring->buffers == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (buffer != NULL && buffer_size == 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    return ring_queue(ring, TCS_RING_RECEIVE, socket_ctx, buffer, buffer == NULL ? 0 : buffer_size, false, user_data);
 }
 
-TcsResult tcs_address_socket_remote(TcsSocket socket_ctx, struct TcsAddress* remote_address)
+TcsResult tcs_ring_receive_multishot(struct TcsRing* ring, TcsSocket socket_ctx, void* user_data)
 {
-    return TCS_ERROR_NOT_IMPLEMENTED;
+    if (ring == NULL || ring->buffers == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    return ring_queue(ring, TCS_RING_RECEIVE, socket_ctx, NULL, 0, true, user_data);
 }
 
-TcsResult tcs_address_socket_family(TcsSocket socket_ctx, TcsAddressFamily* out_family)
+TcsResult tcs_ring_accept(struct TcsRing* ring, TcsSocket socket_ctx, bool multishot, void* user_data)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID || out_family == NULL)
+    return ring_queue(ring, TCS_RING_ACCEPT, socket_ctx, NULL, 0, multishot, user_data);
+}
+
+TcsResult tcs_ring_cancel(struct TcsRing* ring, TcsSocket socket_ctx)
+{
+    if (ring == NULL || socket_ctx == TCS_SOCKET_INVALID)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    struct sockaddr_storage native_sockaddr;
-    memset(&native_sockaddr, 0, sizeof native_sockaddr);
-    socklen_t addrlen = sizeof native_sockaddr;
-    if (getsockname(socket_ctx, (struct sockaddr*)&native_sockaddr, &addrlen) != 0)
-        return errno2retcode(errno);
+#if TCS_AVAILABLE_IO_URING
+    if (ring->native)
+    {
+        struct io_uring_sqe* sqe = ring_uring_sqe(ring);
+        if (sqe == NULL)
+            return TCS_AGAIN;
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = socket_ctx;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+        sqe->user_data = TCS_RING_INTERNAL_TAG;
+        return TCS_SUCCESS;
+    }
+#endif
+    if (socket_ctx < 0 || (size_t)socket_ctx >= ring->fallback.socket_ops_capacity)
+        return TCS_SUCCESS;
 
-    TcsAddressFamily family = TCS_AF_ANY;
-    TcsResult family_convert_status = native2family(native_sockaddr.ss_family, &family);
-    if (family_convert_status != TCS_SUCCESS)
-        return family_convert_status;
-    *out_family = family;
-    return TCS_SUCCESS;
+    size_t* link = &ring->fallback.canceled;
+    while (*link != 0)
+        link = &ring->ops[*link - 1].next;
+    *link = ring->fallback.socket_ops[socket_ctx];
+    ring->fallback.socket_ops[socket_ctx] = 0;
+    return ring_fallback_update_interest(ring, socket_ctx);
 }
 
-// tcs_address_parse() is defined in tinycsocket_common.c
-// tcs_address_to_str() is defined in tinycsocket_common.c
-// tcs_address_is_equal() is defined in tinycsocket_common.c
-// tcs_address_is_any() is defined in tinycsocket_common.c
-// tcs_address_is_local() is defined in tinycsocket_common.c
-// tcs_address_is_loopback() is defined in tinycsocket_common.c
-// tcs_address_is_multicast() is defined in tinycsocket_common.c
-// tcs_address_is_broadcast() is defined in tinycsocket_common.c
+TcsResult tcs_ring_submit(struct TcsRing* ring)
+{
+    if (ring == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
+#if TCS_AVAILABLE_IO_URING
+    if (ring->native && ring->uring.to_submit > 0)
+        return ring_uring_enter(ring, 0, 0);
 #endif
+    return TCS_SUCCESS;
+}
 
-/**********************************/
-/****** tinycsocket_win32.h *******/
-/**********************************/
-/*
- * Copyright 2018 Markus Lindelöw
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files(the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
- * SOFTWARE.
- */
-#ifndef TINYCSOCKET_INTERNAL_H_
-#include "tinycsocket_internal.h"
-#endif
-#ifdef TINYCSOCKET_USE_WIN32_IMPL
+TcsResult tcs_ring_wait(struct TcsRing* ring,
+                        struct TcsRingCompletion* completions,
+                        size_t completions_count,
+                        size_t* completions_populated,
+                        int64_t timeout_in_ms)
+{
+    if (ring == NULL || completions == NULL || completions_count == 0 || completions_populated == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (completions_count > 0x7FFFFFFF || timeout_in_ms > 0x7FFFFFFF)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-#ifdef DO_WRAP
-#include "dbg_wrap.h"
-#endif
+    *completions_populated = 0;
 
-#if !defined(NTDDI_VERSION) && !defined(_WIN32_WINNT) && !defined(WINVER)
-#ifdef _WIN64
-#define NTDDI_VERSION 0x05020000
-#define _WIN32_WINNT 0x0502
-#define WINVER 0x0502
-#else
-#define NTDDI_VERSION 0x05010300
-#define _WIN32_WINNT 0x0501
-#define WINVER 0x0501
-#endif
-#endif
-#define WIN32_LEAN_AND_MEAN
-// Header only should not need other files
-#ifndef TINYDATASTRUCTURES_H_
-#include "tinydatastructures.h"
+#if TCS_AVAILABLE_IO_URING
+    if (ring->native)
+    {
+        // Submit and wait in the same syscall, skip the wait if completions are already there
+        *completions_populated = ring_uring_reap(ring, completions, completions_count);
+        if (*completions_populated > 0)
+        {
+            if (ring->uring.to_submit > 0)
+                ring_uring_enter(ring, 0, 0); // Anything left is submitted by the next call
+            return TCS_SUCCESS;
+        }
+
+        TcsResult sts = ring_uring_enter(ring, 1, timeout_in_ms);
+        if (sts != TCS_SUCCESS)
+            return sts;
+        *completions_populated = ring_uring_reap(ring, completions, completions_count);
+        return *completions_populated > 0 ? TCS_SUCCESS : TCS_ERROR_TIMED_OUT;
+    }
 #endif
-// before windows.h
-#include <winsock2.h> // sockets
+    return ring_fallback_wait(ring, completions, completions_count, completions_populated, timeout_in_ms);
+}
 
-#include <windows.h>
+// ######## Threads ########
 
-// after windows.h
-#include <iphlpapi.h> // GetAdaptersAddresses
-#include <ws2tcpip.h> // getaddrinfo
+#if TCS_AVAILABLE_THREADS
+typedef pthread_t TcsThread;
+#define TCS_THREAD_RESULT void*
+#define TCS_THREAD_CALL
 
-#include <stdlib.h> // Malloc for GetAdaptersAddresses
-#include <string.h> // memset
+static TcsResult thread_create(TcsThread* thread, TCS_THREAD_RESULT(TCS_THREAD_CALL* function)(void*), void* argument)
+{
+    int error_code = pthread_create(thread, NULL, function, argument);
+    if (error_code != 0)
+        return errno2retcode(error_code);
+    return TCS_SUCCESS;
+}
 
-#if defined(_MSC_VER) || defined(__clang__)
-#pragma comment(lib, "wsock32.lib")
-#pragma comment(lib, "ws2_32.lib")
-#pragma comment(lib, "Iphlpapi.lib")
-#endif
+static void thread_join(TcsThread thread)
+{
+    pthread_join(thread, NULL);
+}
 
-#ifdef __cplusplus
-using std::min;
-#endif
+static long atomic_load_long(const volatile long* value)
+{
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
 
-// Forwards declaration due to winver dispatch
-// We will dispatch at lib_init() which OS functions to call depending on OS support
+static void atomic_store_long(volatile long* value, long new_value)
+{
+    __atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+}
 
-#ifndef ULIST_SOC
-#define ULIST_SOC
-TDS_ULIST_IMPL(SOCKET, soc)
-#endif
+static int64_t monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
 
-#ifndef ULIST_PVOID
-#define ULIST_PVOID
-TDS_ULIST_IMPL(void*, pvoid)
+static unsigned int cpu_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned int)count : 1;
+}
 #endif
 
-#ifndef ULIST_PVOID
-#define ULIST_PVOID
-TDS_ULIST_IMPL(void*, pvoid)
-#endif
-
-#ifndef TDS_MAP_socket_pvoid
-#define TDS_MAP_socket_pvoid
-TDS_MAP_IMPL(SOCKET, void*, socket_user)
-#endif
-
-// Needs to be compatible with fd_set, hopefully this works. Only used when FD_SETSIZE is to small.
-struct tcs_fd_set
-{
-    u_int fd_count;
-    SOCKET fd_array[1]; // dynamic memory hack that is compatible with Win32 API fd_set
-};
+// ######## Socket Options ########
 
-struct TcsPool
+TcsResult tcs_opt_set(TcsSocket socket_ctx,
+                      int32_t level,
+                      int32_t option_name,
+                      const void* option_value,
+                      size_t option_size)
 {
-    struct TdsUList_soc read_sockets;
-    struct TdsUList_soc write_sockets;
-    struct TdsUList_soc error_sockets;
-    struct TdsMap_socket_user user_data;
-};
-
-const TcsSocket TCS_SOCKET_INVALID = INVALID_SOCKET;
-const int TCS_INF = -1;
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-// Addresses
-const uint32_t TCS_ADDRESS_ANY_IP4 = INADDR_ANY;
-const uint32_t TCS_ADDRESS_LOOPBACK_IP4 = INADDR_LOOPBACK;
-const uint32_t TCS_ADDRESS_BROADCAST_IP4 = INADDR_BROADCAST;
-const uint32_t TCS_ADDRESS_NONE_IP4 = INADDR_NONE;
+    if (setsockopt(socket_ctx, (int)level, (int)option_name, (const char*)option_value, (socklen_t)option_size) == 0)
+        return TCS_SUCCESS;
+    else
+        return errno2retcode(errno);
+}
 
-// Type
-const int TCS_SOCK_STREAM = SOCK_STREAM;
-const int TCS_SOCK_DGRAM = SOCK_DGRAM;
-const int TCS_SOCK_RAW = SOCK_RAW;
+TcsResult tcs_opt_get(TcsSocket socket_ctx, int32_t level, int32_t option_name, void* option_value, size_t* option_size)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID || option_value == NULL || option_size == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-// Protocol
-const uint16_t TCS_PROTOCOL_IP_TCP = IPPROTO_TCP;
-const uint16_t TCS_PROTOCOL_IP_UDP = IPPROTO_UDP;
+    if (getsockopt(socket_ctx, (int)level, (int)option_name, (void*)option_value, (socklen_t*)option_size) == 0)
+    {
+        // Linux sets the buffer size to the doubled because of internal use and returns the full doubled size including internal part
+#ifdef __linux__
+        if (option_name == TCS_SO_RCVBUF || option_name == TCS_SO_SNDBUF)
+        {
+            *(unsigned int*)option_value /= 2;
+        }
+#endif
+        return TCS_SUCCESS;
+    }
+    else
+    {
+        return errno2retcode(errno);
+    }
+}
 
-// Flags
-const uint32_t TCS_AI_PASSIVE = AI_PASSIVE;
+// tcs_opt_broadcast_set() is defined in tinycocket_common.c
+// tcs_opt_broadcast_get() is defined in tinycocket_common.c
+// tcs_opt_keep_alive_set() is defined in inycocket_common.c
+// tcs_opt_keep_alive_get() is defined in tinycocket_common.c
+// tcs_opt_reuse_address_set() is defined in tiinycocket_common.c
+// tcs_opt_reuse_address_get() is defined in tiinycocket_common.c
+// tcs_opt_send_buffer_size_set() is defined in tininycocket_common.c
+// tcs_opt_send_buffer_size_get() is defined in tininycocket_common.c
+// tcs_opt_receive_buffer_size_set() is defined in tinyinycocket_common.c
+// tcs_opt_receive_buffer_size_get() is defined in tinyinycocket_common.c
 
-// Recv flags
-const uint32_t TCS_MSG_PEEK = MSG_PEEK;
-const uint32_t TCS_MSG_OOB = MSG_OOB;
-const uint32_t TCS_MSG_WAITALL = 0x8; // Binary compatible when it does not exist
+TcsResult tcs_opt_receive_timeout_set(TcsSocket socket_ctx, int timeout_ms)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-// Send flags
-const uint32_t TCS_MSG_SENDALL = 0x80000000;
+    struct timeval tv;
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
 
-// Backlog
-const int TCS_BACKLOG_MAX = SOMAXCONN;
+    return tcs_opt_set(socket_ctx, TCS_SOL_SOCKET, TCS_SO_RCVTIMEO, &tv, sizeof(tv));
+}
 
-// Option levels
-const int TCS_SOL_SOCKET = SOL_SOCKET;
-const int TCS_SOL_IP = IPPROTO_IP;
+TcsResult tcs_opt_receive_timeout_get(TcsSocket socket_ctx, int* timeout_ms)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID || timeout_ms == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-// Socket options
-const int TCS_SO_BROADCAST = SO_BROADCAST;
-const int TCS_SO_KEEPALIVE = SO_KEEPALIVE;
-const int TCS_SO_LINGER = SO_LINGER;
-const int TCS_SO_REUSEADDR = SO_REUSEADDR;
-const int TCS_SO_RCVBUF = SO_RCVBUF;
-const int TCS_SO_RCVTIMEO = SO_RCVTIMEO;
-const int TCS_SO_SNDBUF = SO_SNDBUF;
-const int TCS_SO_OOBINLINE = SO_OOBINLINE;
-const int TCS_SO_PRIORITY = -1;
+    struct timeval tv = {0, 0};
+    size_t tv_size = sizeof(tv);
+    TcsResult sts = tcs_opt_get(socket_ctx, TCS_SOL_SOCKET, TCS_SO_RCVTIMEO, &tv, &tv_size);
 
-// IP options
-const int TCS_SO_IP_NODELAY = TCP_NODELAY;
-const int TCS_SO_IP_MEMBERSHIP_ADD = IP_ADD_MEMBERSHIP;
-const int TCS_SO_IP_MEMBERSHIP_DROP = IP_DROP_MEMBERSHIP;
-const int TCS_SO_IP_MULTICAST_LOOP = IP_MULTICAST_LOOP;
+    if (sts == TCS_SUCCESS)
+    {
+        int c = 0;
+        c += (int)tv.tv_sec * 1000;
+        c += (int)tv.tv_usec / 1000;
+        *timeout_ms = c;
+    }
+    return sts;
+}
 
-int g_init_count = 0;
+TcsResult tcs_opt_linger_set(TcsSocket socket_ctx, bool do_linger, int timeout_seconds)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-// ######## Internal Helpers ########
+    struct linger l = {(u_short)do_linger, (u_short)timeout_seconds};
+    return tcs_opt_set(socket_ctx, TCS_SOL_SOCKET, TCS_SO_LINGER, &l, sizeof(l));
+}
 
-static TcsResult wsaerror2retcode(int wsa_error)
+TcsResult tcs_opt_linger_get(TcsSocket socket_ctx, bool* do_linger, int* timeout_seconds)
 {
-    switch (wsa_error)
+    if (socket_ctx == TCS_SOCKET_INVALID || (do_linger == NULL && timeout_seconds == NULL))
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    struct linger l = {0, 0};
+    size_t l_size = sizeof(l);
+    TcsResult sts = tcs_opt_get(socket_ctx, TCS_SOL_SOCKET, TCS_SO_LINGER, &l, &l_size);
+    if (sts == TCS_SUCCESS)
     {
-        case WSANOTINITIALISED:
-            return TCS_ERROR_LIBRARY_NOT_INITIALIZED;
-        case WSAEWOULDBLOCK:
-            return TCS_ERROR_WOULD_BLOCK;
-        case WSAETIMEDOUT:
-            return TCS_ERROR_TIMED_OUT;
-        default:
-            return TCS_ERROR_UNKNOWN;
+        if (do_linger)
+            *do_linger = l.l_onoff;
+        if (timeout_seconds)
+            *timeout_seconds = l.l_linger;
     }
+
+    return sts;
 }
 
-static TcsResult socketstatus2retcode(int status)
+// tcs_opt_ip_no_delay_set() is defined in tinycsocket_common.c
+// tcs_opt_ip_no_delay_get() is defined in tinycsocket_common.c
+// tcs_opt_out_of_band_inline_set() is defined in tinycsocket_common.c
+// tcs_opt_out_of_band_inline_get() is defined in tinycsocket_common.c
+// tcs_opt_priority_set() is defined in tinycsocket_common.c
+// tcs_opt_priority_get() is defined in tinycsocket_common.c
+
+TcsResult tcs_opt_nonblocking_set(TcsSocket socket_ctx, bool do_non_blocking)
 {
-    if (status == 0)
-    {
-        return TCS_SUCCESS;
-    }
-    else if (status == SOCKET_ERROR)
-    {
-        int error_code = WSAGetLastError();
-        return wsaerror2retcode(error_code);
-    }
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    int flags = fcntl(socket_ctx, F_GETFL, 0);
+    if (flags == -1)
+        return errno2retcode(errno);
+
+    if (do_non_blocking)
+        flags |= O_NONBLOCK; /* sätt biten */
     else
-    {
-        return TCS_ERROR_UNKNOWN;
-    }
-}
+        flags &= ~O_NONBLOCK; /* rensa biten */
 
-static TcsResult family2native(const TcsAddressFamily family, short* native_family)
-{
-    switch (family)
-    {
-        case TCS_AF_ANY:
-            *native_family = AF_UNSPEC;
-            return TCS_SUCCESS;
-        case TCS_AF_IP4:
-            *native_family = AF_INET;
-            return TCS_SUCCESS;
-        case TCS_AF_IP6:
-            *native_family = AF_INET6;
-            return TCS_SUCCESS;
+    if (fcntl(socket_ctx, F_SETFL, flags) == -1)
+        return errno2retcode(errno);
 
-        case TCS_AF_PACKET:
-#if TCS_AVAILABLE_AF_PACKET
-            *native_family = AF_PACKET;
-#else
-            return TCS_ERROR_NOT_IMPLEMENTED;
-#endif
-            return TCS_SUCCESS;
-        default:
-            return TCS_ERROR_INVALID_ARGUMENT;
-    }
     return TCS_SUCCESS;
 }
 
-static TcsResult sockaddr2native(const struct TcsAddress* in_addr, PSOCKADDR out_addr, int* out_addrlen)
+TcsResult tcs_opt_nonblocking_get(TcsSocket socket_ctx, bool* is_non_blocking)
 {
-    if (in_addr == NULL || out_addr == NULL)
+    if (socket_ctx == TCS_SOCKET_INVALID || is_non_blocking == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    if (in_addr->family == TCS_AF_ANY)
-    {
-        return TCS_ERROR_NOT_IMPLEMENTED;
-    }
-    if (in_addr->family == TCS_AF_IP4)
-    {
-        PSOCKADDR_IN addr = (PSOCKADDR_IN)out_addr;
-        addr->sin_family = (ADDRESS_FAMILY)AF_INET;
-        addr->sin_port = htons((USHORT)in_addr->data.ip4.port);
-        addr->sin_addr.S_un.S_addr = htonl((ULONG)in_addr->data.ip4.address);
+    int flags = fcntl(socket_ctx, F_GETFL, 0);
+    if (flags == -1)
+        return errno2retcode(errno);
 
-        if (out_addrlen != NULL)
-            *out_addrlen = sizeof(SOCKADDR_IN);
+    *is_non_blocking = (flags & O_NONBLOCK) != 0;
+    return TCS_SUCCESS;
+}
 
+TcsResult tcs_opt_udp_gro_set(TcsSocket socket_ctx, bool do_gro)
+{
+#if TCS_AVAILABLE_MMSG
+    int b = do_gro ? 1 : 0;
+    if (setsockopt(socket_ctx, SOL_UDP, UDP_GRO, &b, sizeof b) == 0)
         return TCS_SUCCESS;
-    }
-    else if (in_addr->family == TCS_AF_IP6)
-    {
-        return TCS_ERROR_NOT_IMPLEMENTED;
-    }
-    else if (in_addr->family == TCS_AF_PACKET)
-    {
+    if (errno == ENOPROTOOPT)
         return TCS_ERROR_NOT_IMPLEMENTED;
-    }
+    return errno2retcode(errno);
+#else
+    (void)socket_ctx;
+    (void)do_gro;
     return TCS_ERROR_NOT_IMPLEMENTED;
+#endif
 }
 
-static TcsResult native2sockaddr(const PSOCKADDR in_addr, struct TcsAddress* out_addr)
+TcsResult tcs_opt_zerocopy_set(TcsSocket socket_ctx, bool do_zerocopy)
 {
-    if (in_addr == NULL || out_addr == NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
-
-    if (in_addr->sa_family == AF_INET)
-    {
-        PSOCKADDR_IN addr = (PSOCKADDR_IN)in_addr;
-        out_addr->family = TCS_AF_IP4;
-        out_addr->data.ip4.port = ntohs((uint16_t)addr->sin_port);
-        out_addr->data.ip4.address = ntohl((uint32_t)addr->sin_addr.S_un.S_addr);
-    }
-    else if (in_addr->sa_family == AF_INET6)
-    {
-        return TCS_ERROR_NOT_IMPLEMENTED;
-    }
-    else if (in_addr->sa_family == AF_UNSPEC)
-    {
-        return TCS_ERROR_INVALID_ARGUMENT;
-    }
-    else
-    {
+#if TCS_AVAILABLE_ZEROCOPY
+    int b = do_zerocopy ? 1 : 0;
+    if (setsockopt(socket_ctx, SOL_SOCKET, SO_ZEROCOPY, &b, sizeof b) == 0)
+        return TCS_SUCCESS;
+    if (errno == ENOPROTOOPT || errno == EOPNOTSUPP)
         return TCS_ERROR_NOT_IMPLEMENTED;
-    }
-
-    return TCS_SUCCESS;
+    return errno2retcode(errno);
+#else
+    (void)socket_ctx;
+    (void)do_zerocopy;
+    return TCS_ERROR_NOT_IMPLEMENTED;
+#endif
 }
 
-TcsResult tcs_lib_init(void)
+TcsResult tcs_opt_reuse_port_set(TcsSocket socket_ctx, bool do_allow_reuse_port)
 {
-    if (g_init_count <= 0)
-    {
-        WSADATA wsa_data;
-        int wsa_startup_status_code = WSAStartup(MAKEWORD(2, 2), &wsa_data);
-        if (wsa_startup_status_code != 0)
-            return TCS_ERROR_SYSTEM;
-    }
-    ++g_init_count;
-    return TCS_SUCCESS;
-}
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-TcsResult tcs_lib_free(void)
-{
-    g_init_count--;
-    if (g_init_count <= 0)
-    {
-        WSACleanup();
-    }
-    return TCS_SUCCESS;
+    int b = do_allow_reuse_port ? 1 : 0;
+#if defined(SO_REUSEPORT_LB)
+    if (setsockopt(socket_ctx, SOL_SOCKET, SO_REUSEPORT_LB, &b, sizeof b) == 0)
+        return TCS_SUCCESS;
+#elif defined(__linux__) && defined(SO_REUSEPORT)
+    if (setsockopt(socket_ctx, SOL_SOCKET, SO_REUSEPORT, &b, sizeof b) == 0)
+        return TCS_SUCCESS;
+#else
+    // SO_REUSEPORT on other BSDs and macOS does not spread connections between the sockets
+    (void)b;
+    return TCS_ERROR_NOT_IMPLEMENTED;
+#endif
+    if (errno == ENOPROTOOPT)
+        return TCS_ERROR_NOT_IMPLEMENTED;
+    return errno2retcode(errno);
 }
 
-TcsResult tcs_socket(TcsSocket* socket_ctx, TcsAddressFamily family, int type, int protocol)
+TcsResult tcs_opt_membership_add(TcsSocket socket_ctx, const struct TcsAddress* multicast_address)
 {
-    if (socket_ctx == NULL || *socket_ctx != TCS_SOCKET_INVALID)
+    if (socket_ctx == TCS_SOCKET_INVALID)
         return TCS_ERROR_INVALID_ARGUMENT;
-    if (*socket_ctx != TCS_SOCKET_INVALID)
+
+    if (multicast_address == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    short native_family = AF_UNSPEC;
-    TcsResult sts = family2native(family, &native_family);
+    // Todo: Replace with tcs_address_socket() when implemented
+    struct sockaddr_storage address_native_local;
+    memset(&address_native_local, 0, sizeof(struct sockaddr_storage));
+    socklen_t address_native_local_size = sizeof(struct sockaddr_storage);
+    if (getsockname(socket_ctx, (struct sockaddr*)&address_native_local, &address_native_local_size) != 0)
+        return errno2retcode(errno);
+
+    struct TcsAddress local_address = TCS_ADDRESS_NONE;
+    TcsResult sts = native2sockaddr((struct sockaddr*)&address_native_local, &local_address);
     if (sts != TCS_SUCCESS)
         return sts;
 
-    TcsSocket new_socket = socket(native_family, type, protocol);
+    if (local_address.family != multicast_address->family)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-    if (new_socket != INVALID_SOCKET)
+    return tcs_opt_membership_add_to(socket_ctx, &local_address, multicast_address);
+}
+
+TcsResult tcs_opt_membership_add_to(TcsSocket socket_ctx,
+                                    const struct TcsAddress* local_address,
+                                    const struct TcsAddress* multicast_address)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    if (multicast_address == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    if (local_address == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    if (local_address->family != multicast_address->family)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    struct sockaddr_storage local_address_native;
+    memset(&local_address_native, 0, sizeof(struct sockaddr_storage));
+    socklen_t local_address_native_size = sizeof(struct sockaddr_storage);
+    TcsResult sts_la2n = sockaddr2native(local_address, &local_address_native, &local_address_native_size);
+    if (sts_la2n != TCS_SUCCESS)
+        return sts_la2n;
+
+    struct sockaddr_storage multicast_address_native;
+    memset(&multicast_address_native, 0, sizeof(struct sockaddr_storage));
+    socklen_t multicast_address_native_size = sizeof(struct sockaddr_storage);
+    TcsResult sts_ma2n = sockaddr2native(multicast_address, &multicast_address_native, &multicast_address_native_size);
+    if (sts_ma2n != TCS_SUCCESS)
+        return sts_ma2n;
+
+    if (multicast_address->family == TCS_AF_IP4)
     {
-        *socket_ctx = new_socket;
+        const struct sockaddr_in* address_native_local_p = (struct sockaddr_in*)&local_address_native;
+        const struct sockaddr_in* address_native_multicast_p = (struct sockaddr_in*)&multicast_address_native;
+
+        struct ip_mreq mreq;
+        memset(&mreq, 0, sizeof mreq);
+
+        mreq.imr_interface.s_addr = address_native_local_p->sin_addr.s_addr;
+        mreq.imr_multiaddr.s_addr = address_native_multicast_p->sin_addr.s_addr;
+
+        TcsResult sts_opt = tcs_opt_set(socket_ctx, TCS_SOL_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
+        if (sts_opt != TCS_SUCCESS)
+            return sts_opt;
         return TCS_SUCCESS;
     }
-    else
+    else if (multicast_address->family == TCS_AF_IP6)
     {
-        int error_code = WSAGetLastError();
-        return wsaerror2retcode(error_code);
+        return TCS_ERROR_NOT_IMPLEMENTED;
     }
-}
-
-// tcs_socket_preset() is defined in tinycsocket_common.c
+    else if (multicast_address->family == TCS_AF_PACKET)
+    {
+#if TCS_AVAILABLE_AF_PACKET
+        const struct sockaddr_ll* address_native_local_p = (struct sockaddr_ll*)&local_address_native;
+        const struct sockaddr_ll* address_native_multicast_p = (struct sockaddr_ll*)&multicast_address_native;
 
-TcsResult tcs_close(TcsSocket* socket_ctx)
-{
-    if (socket_ctx == NULL || *socket_ctx == TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
+        struct packet_mreq mreq;
+        memset(&mreq, 0, sizeof mreq);
+        mreq.mr_ifindex = address_native_local_p->sll_ifindex;
+        mreq.mr_type = PACKET_MR_MULTICAST;
+        memcpy(mreq.mr_address, address_native_multicast_p->sll_addr, ETH_ALEN);
+        mreq.mr_alen = ETH_ALEN;
 
-    int close_status = closesocket(*socket_ctx);
-    if (close_status != SOCKET_ERROR)
-    {
-        *socket_ctx = TCS_SOCKET_INVALID;
+        TcsResult sts_opt = tcs_opt_set(socket_ctx, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
+        if (sts_opt != TCS_SUCCESS)
+            return sts_opt;
         return TCS_SUCCESS;
+#else
+        return TCS_ERROR_NOT_IMPLEMENTED;
+#endif
     }
     else
     {
-        return socketstatus2retcode(close_status);
+        return TCS_ERROR_NOT_IMPLEMENTED;
     }
-}
 
-// ######## High-level Socket Creation ########
+    return TCS_ERROR_UNKNOWN; // Not reachable
+}
 
-// tcs_tcp_server_str() is defined in tinycsocket_common.c
-// tcs_tcp_server() is defined in tinycsocket_common.c
-// tcs_tcp_client_str() is defined in tinycsocket_common.c
-// tcs_tcp_client() is defined in tinycsocket_common.c
-// tcs_udp_receiver_str() is defined in tinycsocket_common.c
-// tcs_udp_receiver() is defined in tinycsocket_common.c
-// tcs_udp_sender_str() is defined in tinycsocket_common.c
-// tcs_udp_sender() is defined in tinycsocket_common.c
-// tcs_udp_peer_str() is defined in tinycsocket_common.c
-// tcs_udp_peer() is defined in tinycsocket_common.c
+TcsResult tcs_opt_membership_drop(TcsSocket socket_ctx, const struct TcsAddress* multicast_address)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-// ######## High-level Raw L2-Packet Sockets (Experimental) ########
+    if (multicast_address == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-// tcs_packet_sender_str() is defined in tinycsocket_common.c
-// tcs_packet_sender() is defined in tinycsocket_common.c
-// tcs_packet_peer_str() is defined in tinycsocket_common.c
-// tcs_packet_peer() is defined in tinycsocket_common.c
-// tcs_packet_capture_iface() is defined in tinycsocket_common.c
-// tcs_packet_capture_ifname() is defined in tinycsocket_common.c
+    // Todo: Replace with tcs_address_socket() when implemented
+    struct sockaddr_storage address_native_local;
+    memset(&address_native_local, 0, sizeof address_native_local);
+    socklen_t address_native_local_size = sizeof(struct sockaddr_storage);
+    if (getsockname(socket_ctx, (struct sockaddr*)&address_native_local, &address_native_local_size) != 0)
+        return errno2retcode(errno);
 
-// ######## Socket Operations ########
+    struct TcsAddress local_address = TCS_ADDRESS_NONE;
+    TcsResult sts = native2sockaddr((struct sockaddr*)&address_native_local, &local_address);
+    if (sts != TCS_SUCCESS)
+        return sts;
 
-TcsResult tcs_bind(TcsSocket socket_ctx, const struct TcsAddress* address)
-{
-    if (socket_ctx == TCS_SOCKET_INVALID)
+    if (local_address.family != multicast_address->family)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    SOCKADDR_STORAGE native_sockaddr;
-    memset(&native_sockaddr, 0, sizeof native_sockaddr);
-    int addrlen = 0;
-    TcsResult convert_addr_status = sockaddr2native(address, (PSOCKADDR)&native_sockaddr, &addrlen);
-    if (convert_addr_status != TCS_SUCCESS)
-        return convert_addr_status;
-    int bind_status = bind(socket_ctx, (PSOCKADDR)&native_sockaddr, addrlen);
-    return socketstatus2retcode(bind_status);
+    return tcs_opt_membership_drop_from(socket_ctx, &local_address, multicast_address);
 }
 
-TcsResult tcs_connect(TcsSocket socket_ctx, const struct TcsAddress* address)
+TcsResult tcs_opt_membership_drop_from(TcsSocket socket_ctx,
+                                       const struct TcsAddress* local_address,
+                                       const struct TcsAddress* multicast_address)
 {
     if (socket_ctx == TCS_SOCKET_INVALID)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    if (address == NULL)
+    if (multicast_address == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    SOCKADDR_STORAGE native_sockaddr;
-    memset(&native_sockaddr, 0, sizeof native_sockaddr);
-    int addrlen = 0;
-    TcsResult convert_addr_status = sockaddr2native(address, (PSOCKADDR)&native_sockaddr, &addrlen);
-    if (convert_addr_status != TCS_SUCCESS)
-        return convert_addr_status;
-    int connect_status = connect(socket_ctx, (PSOCKADDR)&native_sockaddr, addrlen);
-    return socketstatus2retcode(connect_status);
-}
-
-// tcs_connect_str() is defined in tinycsocket_common.c
+    if (local_address == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-TcsResult tcs_listen(TcsSocket socket_ctx, int backlog)
-{
-    if (socket_ctx == TCS_SOCKET_INVALID)
+    if (local_address->family != multicast_address->family)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    int status = listen(socket_ctx, (int)backlog);
-    return socketstatus2retcode(status);
-}
+    struct sockaddr_storage local_address_native;
+    memset(&local_address_native, 0, sizeof(struct sockaddr_storage));
+    socklen_t local_address_native_size = 0;
+    TcsResult sts_la2n = sockaddr2native(local_address, &local_address_native, &local_address_native_size);
+    if (sts_la2n != TCS_SUCCESS)
+        return sts_la2n;
 
-TcsResult tcs_accept(TcsSocket socket_ctx, TcsSocket* child_socket_ctx, struct TcsAddress* address)
-{
-    if (socket_ctx == TCS_SOCKET_INVALID || child_socket_ctx == NULL || *child_socket_ctx != TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
+    struct sockaddr_storage multicast_address_native;
+    memset(&multicast_address_native, 0, sizeof(struct sockaddr_storage));
+    socklen_t multicast_address_native_size = 0;
+    TcsResult sts_ma2n = sockaddr2native(multicast_address, &multicast_address_native, &multicast_address_native_size);
+    if (sts_ma2n != TCS_SUCCESS)
+        return sts_ma2n;
 
-    SOCKADDR_STORAGE native_sockaddr;
-    memset(&native_sockaddr, 0, sizeof native_sockaddr);
-    int addr_len = sizeof(native_sockaddr);
-    *child_socket_ctx = accept(socket_ctx, (PSOCKADDR)&native_sockaddr, &addr_len);
-    if (*child_socket_ctx != INVALID_SOCKET)
+    if (multicast_address->family == TCS_AF_IP4)
     {
-        if (address != NULL)
-        {
-            TcsResult convert_addr_status = native2sockaddr((PSOCKADDR)&native_sockaddr, address);
-            if (convert_addr_status != TCS_SUCCESS)
-                return convert_addr_status;
-        }
+        const struct sockaddr_in* address_native_local_p = (struct sockaddr_in*)&local_address_native;
+        const struct sockaddr_in* address_native_multicast_p = (struct sockaddr_in*)&multicast_address_native;
+
+        struct ip_mreq mreq;
+        memset(&mreq, 0, sizeof mreq);
+
+        mreq.imr_interface.s_addr = address_native_local_p->sin_addr.s_addr;
+        mreq.imr_multiaddr.s_addr = address_native_multicast_p->sin_addr.s_addr;
+
+        TcsResult sts_opt = tcs_opt_set(socket_ctx, TCS_SOL_IP, IP_DROP_MEMBERSHIP, &mreq, sizeof(mreq));
+        if (sts_opt != TCS_SUCCESS)
+            return sts_opt;
         return TCS_SUCCESS;
     }
-    else
+    else if (multicast_address->family == TCS_AF_IP6)
     {
-        *child_socket_ctx = TCS_SOCKET_INVALID;
-        int error_code = WSAGetLastError();
-        return wsaerror2retcode(error_code);
+        return TCS_ERROR_NOT_IMPLEMENTED;
     }
-}
+    else if (multicast_address->family == TCS_AF_PACKET)
+    {
+#if TCS_AVAILABLE_AF_PACKET
+        const struct sockaddr_ll* address_native_local_p = (struct sockaddr_ll*)&local_address_native;
+        const struct sockaddr_ll* address_native_multicast_p = (struct sockaddr_ll*)&multicast_address_native;
 
-TcsResult tcs_shutdown(TcsSocket socket_ctx, TcsSocketDirection direction)
-{
-    const int LUT[] = {SD_RECEIVE, SD_SEND, SD_BOTH};
+        struct packet_mreq mreq;
+        memset(&mreq, 0, sizeof mreq);
+        mreq.mr_ifindex = address_native_local_p->sll_ifindex;
+        mreq.mr_type = PACKET_MR_MULTICAST;
+        memcpy(mreq.mr_address, address_native_multicast_p->sll_addr, ETH_ALEN);
+        mreq.mr_alen = ETH_ALEN;
 
-    if (socket_ctx == TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
+        TcsResult sts_opt = tcs_opt_set(socket_ctx, SOL_PACKET, PACKET_DROP_MEMBERSHIP, &mreq, sizeof(mreq));
+        if (sts_opt != TCS_SUCCESS)
+            return sts_opt;
+        return TCS_SUCCESS;
+#else
+        return TCS_ERROR_NOT_IMPLEMENTED;
+#endif
+    }
+    else
+    {
+        return TCS_ERROR_NOT_IMPLEMENTED;
+    }
 
-    const int how = LUT[direction];
-    int shutdown_status = shutdown(socket_ctx, how);
-    return socketstatus2retcode(shutdown_status);
+    return TCS_ERROR_UNKNOWN; // Not reachable
 }
 
-// ######## Data Transfer ########
+// ######## Address and Interface Utilities ########
 
-TcsResult tcs_send(TcsSocket socket_ctx, const uint8_t* buffer, size_t buffer_size, uint32_t flags, size_t* bytes_sent)
+TcsResult tcs_interface_list(struct TcsInterface* found_interfaces,
+                             size_t interfaces_length,
+                             size_t* interfaces_populated)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID)
+    if (found_interfaces == NULL && interfaces_populated == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    if (bytes_sent != NULL)
-        *bytes_sent = 0;
-
-    if (buffer == NULL || buffer_size == 0)
+    if (found_interfaces == NULL && interfaces_length != 0)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    // Send all
-    if (flags & TCS_MSG_SENDALL)
-    {
-        uint32_t new_flags = flags & ~TCS_MSG_SENDALL; // For recursive call
-        size_t left = buffer_size;
-        const uint8_t* iterator = buffer;
+    if (interfaces_populated != NULL)
+        *interfaces_populated = 0;
 
-        while (left > 0)
+    struct if_nameindex* interfaces = if_nameindex();
+    if (interfaces == NULL)
+        return errno2retcode(errno);
+
+    if (found_interfaces != NULL)
+    {
+        for (size_t i = 0; i < interfaces_length && interfaces[i].if_index != 0; ++i)
         {
-            size_t sent = 0;
-            TcsResult sts = tcs_send(socket_ctx, iterator, left, new_flags, &sent);
-            if (bytes_sent != NULL)
-                *bytes_sent += sent;
-            if (sts != TCS_SUCCESS)
-                return sts;
-            left -= sent;
-            iterator += sent;
+            strncpy(found_interfaces[i].name, interfaces[i].if_name, 31);
+            found_interfaces[i].name[31] = '\0';
+            found_interfaces[i].id = interfaces[i].if_index;
+            if (interfaces_populated != NULL)
+                *interfaces_populated += 1;
         }
-        return TCS_SUCCESS;
     }
-    else // Send
+    else // found_interfaces == NULL && interface_populated != NULL
     {
-        int send_status = send(socket_ctx, (const char*)buffer, (int)buffer_size, (int)flags);
-        if (send_status != SOCKET_ERROR)
-        {
-            if (bytes_sent != NULL)
-                *bytes_sent = (size_t)send_status;
-            return TCS_SUCCESS;
-        }
-        else
-        {
-            if (bytes_sent != NULL)
-                *bytes_sent = 0;
-
-            return socketstatus2retcode(send_status);
-        }
+        for (size_t i = 0; interfaces[i].if_index != 0; ++i)
+            *interfaces_populated += 1;
     }
+
+    if_freenameindex(interfaces);
+    return TCS_SUCCESS;
 }
 
-TcsResult tcs_send_to(TcsSocket socket_ctx,
-                      const uint8_t* buffer,
-                      size_t buffer_size,
-                      uint32_t flags,
-                      const struct TcsAddress* destination_address,
-                      size_t* bytes_sent)
+TcsResult tcs_address_resolve(const char* hostname,
+                              TcsAddressFamily address_family,
+                              struct TcsAddress found_addresses[],
+                              size_t found_addresses_length,
+                              size_t* no_of_found_addresses)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID)
+    if (hostname == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    if (flags & TCS_MSG_SENDALL)
-        return TCS_ERROR_NOT_IMPLEMENTED;
+    if (found_addresses == NULL && no_of_found_addresses == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-    SOCKADDR_STORAGE native_sockaddr;
-    memset(&native_sockaddr, 0, sizeof native_sockaddr);
-    int addrlen = 0;
-    TcsResult convert_addr_status = sockaddr2native(destination_address, (PSOCKADDR)&native_sockaddr, &addrlen);
-    if (convert_addr_status != TCS_SUCCESS)
-        return convert_addr_status;
+    if (no_of_found_addresses != NULL)
+        *no_of_found_addresses = 0;
 
-    int sendto_status =
-        sendto(socket_ctx, (const char*)buffer, (int)buffer_size, (int)flags, (PSOCKADDR)&native_sockaddr, addrlen);
+    struct addrinfo native_hints;
+    memset(&native_hints, 0, sizeof native_hints);
+    TcsResult family_convert_status = family2native(address_family, (sa_family_t*)&native_hints.ai_family);
+    if (family_convert_status != TCS_SUCCESS)
+        return family_convert_status;
+    native_hints.ai_flags = AI_NUMERICSERV;
+    native_hints.ai_socktype = SOCK_DGRAM;
+    native_hints.ai_protocol = IPPROTO_UDP;
 
-    if (sendto_status != SOCKET_ERROR)
+    struct addrinfo* native_addrinfo_list = NULL;
+    int sts = getaddrinfo(hostname, NULL, &native_hints, &native_addrinfo_list);
+
+    // TODO: Move error codes to errno2retcode()
+    if (sts == EAI_SYSTEM)
+        return errno2retcode(errno);
+    else if (sts == EAI_AGAIN)
+        return TCS_ERROR_TEMPRORARY_FAILURE;
+    else if (sts == EAI_BADFLAGS)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    else if (sts == EAI_FAIL)
+        return TCS_ERROR_ADDRESS_LOOKUP_FAILED;
+    else if (sts == EAI_FAMILY)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    else if (sts == EAI_MEMORY)
+        return TCS_ERROR_MEMORY;
+    else if (sts == EAI_NONAME)
+        return TCS_ERROR_ADDRESS_LOOKUP_FAILED;
+    else if (sts == EAI_SERVICE)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    else if (native_addrinfo_list == NULL)
+        return TCS_ERROR_UNKNOWN;
+    else if (sts != 0)
+        return errno2retcode(sts);
+
+    size_t i = 0;
+    if (found_addresses == NULL)
     {
-        if (bytes_sent != NULL)
-            *bytes_sent = (size_t)sendto_status;
-        return TCS_SUCCESS;
+        for (struct addrinfo* iter = native_addrinfo_list; iter != NULL; iter = iter->ai_next)
+            i++;
     }
     else
     {
-        if (bytes_sent != NULL)
-            *bytes_sent = 0;
-
-        return socketstatus2retcode(sendto_status);
+        for (struct addrinfo* iter = native_addrinfo_list; iter != NULL && i < found_addresses_length;
+             iter = iter->ai_next)
+        {
+            TcsResult convert_address_status = native2sockaddr(iter->ai_addr, &found_addresses[i]);
+            if (convert_address_status != TCS_SUCCESS)
+                continue;
+            i++;
+        }
     }
+    if (no_of_found_addresses != NULL)
+        *no_of_found_addresses = i;
+
+    freeaddrinfo(native_addrinfo_list);
+
+    if (i == 0)
+        return TCS_ERROR_ADDRESS_LOOKUP_FAILED;
+
+    return TCS_SUCCESS;
 }
 
-TcsResult tcs_sendv(TcsSocket socket_ctx,
-                    const struct TcsBuffer* buffers,
-                    size_t buffer_count,
-                    uint32_t flags,
-                    size_t* bytes_sent)
+TcsResult tcs_address_resolve_timeout(const char* hostname,
+                                      TcsAddressFamily address_family,
+                                      struct TcsAddress addresses[],
+                                      size_t capacity,
+                                      size_t* out_count,
+                                      int timeout_ms)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID || buffers == NULL || buffer_count == 0)
-        return TCS_ERROR_INVALID_ARGUMENT;
-
-    if (flags & TCS_MSG_SENDALL)
-        return TCS_ERROR_NOT_IMPLEMENTED;
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
 
-    if (buffer_count > TCS_SENDV_MAX)
+#if TCS_AVAILABLE_IFADDRS // acquired from CMake
+TcsResult tcs_address_list(unsigned int interface_id_filter,
+                           TcsAddressFamily address_family_filter,
+                           struct TcsInterfaceAddress interface_addresses[],
+                           size_t capacity,
+                           size_t* out_count)
+{
+    if (interface_addresses == NULL && out_count == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (interface_addresses == NULL && capacity != 0)
         return TCS_ERROR_INVALID_ARGUMENT;
+    if (out_count != NULL)
+        *out_count = 0;
 
-    WSABUF native_buffers[TCS_SENDV_MAX];
-    for (size_t i = 0; i < buffer_count; ++i)
+    struct ifaddrs* ifap = NULL;
+    if (getifaddrs(&ifap) == -1)
     {
-        native_buffers[i].buf = (CHAR*)buffers[i].data;
-        native_buffers[i].len = (ULONG)buffers[i].size;
+        if (ifap != NULL)
+            freeifaddrs(ifap);
+        return errno2retcode(errno);
     }
 
-    DWORD sent = 0;
-    int wsasend_status = WSASend(socket_ctx, native_buffers, (DWORD)buffer_count, &sent, (DWORD)flags, NULL, NULL);
-
-    if (bytes_sent != NULL)
-        *bytes_sent = (size_t)sent;
+    if (ifap == NULL)
+        return TCS_ERROR_UNKNOWN;
 
-    if (wsasend_status != SOCKET_ERROR)
-        return TCS_SUCCESS;
-    else
-        return socketstatus2retcode(wsasend_status);
-}
-
-TcsResult tcs_receive(TcsSocket socket_ctx, uint8_t* buffer, size_t buffer_size, uint32_t flags, size_t* bytes_received)
-{
-    if (socket_ctx == TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
-
-#if WINVER <= 0x501
-    if (flags & TCS_MSG_WAITALL)
+    size_t populated = 0;
+    for (struct ifaddrs* iter = ifap; iter != NULL; iter = iter->ifa_next)
     {
-        uint32_t new_flags = flags & ~TCS_MSG_WAITALL; // Unmask for recursive call
-        size_t received_so_far = 0;
-        while (received_so_far < buffer_size)
+        if (iter->ifa_addr == NULL)
+            continue;
+
+        if (interface_id_filter != 0)
         {
-            size_t received_now = 0;
-            uint8_t* cursor = buffer + received_so_far;
-            size_t left = buffer_size - received_so_far;
-            TcsResult sts = tcs_receive(socket_ctx, cursor, left, new_flags, &received_now);
-            if (sts != TCS_SUCCESS)
+            unsigned int id = if_nametoindex(iter->ifa_name);
+            if (id == 0)
             {
-                if (bytes_received != NULL)
-                    *bytes_received = received_so_far;
-                return sts;
+                freeifaddrs(ifap);
+                return errno2retcode(errno);
             }
-            received_so_far += received_now;
+            if (id != interface_id_filter)
+                continue;
+        }
+        if (address_family_filter != TCS_AF_ANY)
+        {
+            sa_family_t native_family;
+            TcsResult family_convert_status = family2native(address_family_filter, &native_family);
+            if (family_convert_status == TCS_ERROR_NOT_IMPLEMENTED)
+                continue;
+            if (family_convert_status != TCS_SUCCESS)
+            {
+                freeifaddrs(ifap);
+                return family_convert_status;
+            }
+            if (iter->ifa_addr->sa_family != native_family)
+                continue;
         }
-        if (bytes_received != NULL)
-            *bytes_received = received_so_far;
-        return TCS_SUCCESS;
-    }
-#endif
-
-    int recv_status = recv(socket_ctx, (char*)buffer, (int)buffer_size, (int)flags);
-
-    if (recv_status == 0)
-    {
-        if (bytes_received != NULL)
-            *bytes_received = 0;
-        return TCS_ERROR_SOCKET_CLOSED;
-    }
-    else if (recv_status != SOCKET_ERROR)
-    {
-        if (bytes_received != NULL)
-            *bytes_received = (size_t)recv_status;
-        return TCS_SUCCESS;
-    }
-    else
-    {
-        if (bytes_received != NULL)
-            *bytes_received = 0;
-
-        return socketstatus2retcode(recv_status);
-    }
-}
-
-TcsResult tcs_receive_from(TcsSocket socket_ctx,
-                           uint8_t* buffer,
-                           size_t buffer_size,
-                           uint32_t flags,
-                           struct TcsAddress* source_address,
-                           size_t* bytes_received)
-{
-    if (socket_ctx == TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
 
-    SOCKADDR_STORAGE native_sockaddr;
-    memset(&native_sockaddr, 0, sizeof native_sockaddr);
-    int addrlen = sizeof(native_sockaddr);
+        struct TcsAddress address = TCS_ADDRESS_NONE;
+        TcsResult convert_address_status = native2sockaddr(iter->ifa_addr, &address);
+        if (convert_address_status == TCS_ERROR_NOT_IMPLEMENTED)
+            continue;
+        if (convert_address_status != TCS_SUCCESS)
+        {
+            freeifaddrs(ifap);
+            return convert_address_status;
+        }
 
-    int recvfrom_status =
-        recvfrom(socket_ctx, (char*)buffer, (int)buffer_size, (int)flags, (PSOCKADDR)&native_sockaddr, &addrlen);
+        if (interface_addresses != NULL && populated < capacity)
+        {
+            unsigned int interface_id = if_nametoindex(iter->ifa_name);
+            if (interface_id == 0)
+            {
+                freeifaddrs(ifap);
+                return errno2retcode(errno);
+            }
 
-    if (recvfrom_status == 0)
-    {
-        return TCS_ERROR_SOCKET_CLOSED;
-    }
-    else if (recvfrom_status != SOCKET_ERROR)
-    {
-        if (bytes_received != NULL)
-            *bytes_received = (size_t)recvfrom_status;
+            strncpy(interface_addresses[populated].iface.name, iter->ifa_name, 31);
+            interface_addresses[populated].iface.name[31] = '\0';
+            interface_addresses[populated].iface.id = interface_id;
+            interface_addresses[populated].address = address;
+            populated++;
 
-        if (source_address != NULL)
+            if (out_count != NULL)
+                (*out_count)++;
+        }
+        else if (interface_addresses == NULL && out_count != NULL)
         {
-            TcsResult convert_address_status = native2sockaddr((PSOCKADDR)&native_sockaddr, source_address);
-            return convert_address_status;
+            (*out_count)++;
         }
-
-        return TCS_SUCCESS;
     }
-    else
-    {
-        if (bytes_received != NULL)
-            *bytes_received = 0;
 
-        return socketstatus2retcode(recvfrom_status);
-    }
+    freeifaddrs(ifap);
+    return TCS_SUCCESS;
 }
-
-// tcs_receive_line() is defined in tinycsocket_common.c
-// tcs_receive_netstring() is defined in tinycsocket_common.c
-
-// ######## Socket Pooling ########
-
-TcsResult tcs_pool_create(struct TcsPool** pool)
+#else
+// SunOS before 2010, HP and AIX does not support getifaddrs
+// ioctl implementation,
+// https://stackoverflow.com/questions/4139405/how-can-i-get-to-know-the-ip-address-for-interfaces-in-c/4139811#4139811
+TcsResult tcs_address_list(unsigned int interface_id_filter,
+                           TcsAddressFamily address_family_filter,
+                           struct TcsInterfaceAddress interface_addresses[],
+                           size_t capacity,
+                           size_t* out_count)
 {
-    if (pool == NULL || *pool != NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
-
-    *pool = (struct TcsPool*)malloc(sizeof(struct TcsPool));
-    if (*pool == NULL)
-        return TCS_ERROR_MEMORY;
-    memset(*pool, 0, sizeof(struct TcsPool)); // Just to be safe
-    int sts_read_array = tds_ulist_soc_create(&(*pool)->read_sockets);
-    int sts_write_array = tds_ulist_soc_create(&(*pool)->write_sockets);
-    int sts_error_array = tds_ulist_soc_create(&(*pool)->error_sockets);
-    int sts_user_data = tds_map_socket_user_create(&(*pool)->user_data);
-
-    if (sts_read_array != 0 || sts_write_array != 0 || sts_error_array != 0 || sts_user_data != 0)
-    {
-        tcs_pool_destroy(pool);
-        return TCS_ERROR_MEMORY;
-    }
-    return TCS_SUCCESS;
+    return TCS_ERROR_NOT_IMPLEMENTED;
 }
+#endif
 
-TcsResult tcs_pool_destroy(struct TcsPool** pool)
+TcsResult tcs_address_socket_local(TcsSocket socket_ctx, struct TcsAddress* local_address)
 {
-    if (pool == NULL || *pool == NULL)
+    if (socket_ctx == TCS_SOCKET_INVALID || local_address == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    // Free away!
-    tds_ulist_soc_destroy(&(*pool)->read_sockets);
-    tds_ulist_soc_destroy(&(*pool)->write_sockets);
-    tds_ulist_soc_destroy(&(*pool)->error_sockets);
-    tds_map_socket_user_destroy(&(*pool)->user_data);
+    struct sockaddr_storage native_sockaddr;
+    memset(&native_sockaddr, 0, sizeof native_sockaddr);
+    socklen_t addrlen = sizeof native_sockaddr;
+    if (getsockname(socket_ctx, (struct sockaddr*)&native_sockaddr, &addrlen) != 0)
+        return errno2retcode(errno);
 
-    free(*pool);
-    *pool = NULL;
+    return native2sockaddr((struct sockaddr*)&native_sockaddr, local_address);
+}
 
-    return TCS_SUCCESS;
+TcsResult tcs_address_socket_remote(TcsSocket socket_ctx, struct TcsAddress* remote_address)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
 }
 
-TcsResult tcs_pool_add(struct TcsPool* pool,
-                       TcsSocket socket_ctx,
-                       void* user_data,
-                       bool poll_can_read,
-                       bool poll_can_write,
-                       bool poll_error)
+TcsResult tcs_address_socket_family(TcsSocket socket_ctx, TcsAddressFamily* out_family)
 {
-    if (pool == NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
-    if (!poll_can_read && !poll_can_write && !poll_error)
+    if (socket_ctx == TCS_SOCKET_INVALID || out_family == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    tds_map_socket_user_add(&pool->user_data, socket_ctx, user_data);
+    struct sockaddr_storage native_sockaddr;
+    memset(&native_sockaddr, 0, sizeof native_sockaddr);
+    socklen_t addrlen = sizeof native_sockaddr;
+    if (getsockname(socket_ctx, (struct sockaddr*)&native_sockaddr, &addrlen) != 0)
+        return errno2retcode(errno);
 
-    if (poll_can_read)
-    {
-        int sts = tds_ulist_soc_add(&pool->read_sockets, &socket_ctx, 1);
-        if (sts != 0)
-        {
-            return TCS_ERROR_MEMORY;
-        }
-    }
-    if (poll_can_write)
-    {
-        int sts = tds_ulist_soc_add(&pool->write_sockets, &socket_ctx, 1);
-        if (sts != 0)
-        {
-            tds_ulist_soc_remove(&pool->read_sockets, pool->read_sockets.count, 1);
-            return TCS_ERROR_MEMORY;
-        }
-    }
-    if (poll_error)
-    {
-        int sts = tds_ulist_soc_add(&pool->error_sockets, &socket_ctx, 1);
-        if (sts != 0)
-        {
-            tds_ulist_soc_remove(&pool->read_sockets, pool->read_sockets.count, 1);
-            tds_ulist_soc_remove(&pool->write_sockets, pool->write_sockets.count, 1);
-            return TCS_ERROR_MEMORY;
-        }
-    }
+    TcsAddressFamily family = TCS_AF_ANY;
+    TcsResult family_convert_status = native2family(native_sockaddr.ss_family, &family);
+    if (family_convert_status != TCS_SUCCESS)
+        return family_convert_status;
+    *out_family = family;
     return TCS_SUCCESS;
 }
 
-TcsResult tcs_pool_remove(struct TcsPool* pool, TcsSocket socket_ctx)
-{
-    for (size_t i = 0; i < pool->read_sockets.count; ++i)
-    {
-        if (pool->read_sockets.data[i] == socket_ctx)
-        {
-            tds_ulist_soc_remove(&pool->read_sockets, i, 1);
-            break;
-        }
-    }
+// tcs_address_parse() is defined in tinycsocket_common.c
+// tcs_address_to_str() is defined in tinycsocket_common.c
+// tcs_address_is_equal() is defined in tinycsocket_common.c
+// tcs_address_is_any() is defined in tinycsocket_common.c
+// tcs_address_is_local() is defined in tinycsocket_common.c
+// tcs_address_is_loopback() is defined in tinycsocket_common.c
+// tcs_address_is_multicast() is defined in tinycsocket_common.c
+// tcs_address_is_broadcast() is defined in tinycsocket_common.c
+
+#endif
+
+/**********************************/
+/****** tinycsocket_win32.h *******/
+/**********************************/
+/*
+ * Copyright 2018 Markus Lindelöw
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef TINYCSOCKET_INTERNAL_H_
+#include "tinycsocket_internal.h"
+#endif
+#ifdef TINYCSOCKET_USE_WIN32_IMPL
+
+#ifdef DO_WRAP
+#include "dbg_wrap.h"
+#endif
+
+#if !defined(NTDDI_VERSION) && !defined(_WIN32_WINNT) && !defined(WINVER)
+#ifdef _WIN64
+#define NTDDI_VERSION 0x05020000
+#define _WIN32_WINNT 0x0502
+#define WINVER 0x0502
+#else
+#define NTDDI_VERSION 0x05010300
+#define _WIN32_WINNT 0x0501
+#define WINVER 0x0501
+#endif
+#endif
+#define WIN32_LEAN_AND_MEAN
+// Header only should not need other files
+#ifndef TINYDATASTRUCTURES_H_
+#include "tinydatastructures.h"
+#endif
+// before windows.h
+#include <winsock2.h> // sockets
+
+#include <windows.h>
+
+// after windows.h
+#include <iphlpapi.h> // GetAdaptersAddresses
+#include <ws2tcpip.h> // getaddrinfo
+
+#include <stdlib.h> // Malloc for GetAdaptersAddresses
+#include <string.h> // memset
+
+// Define TCS_MISSING_THREADS to leave the server out, same as on POSIX
+#if !defined(TCS_MISSING_THREADS)
+#define TCS_AVAILABLE_THREADS 1
+#else
+#define TCS_AVAILABLE_THREADS 0
+#endif
+
+#if defined(_MSC_VER) || defined(__clang__)
+#pragma comment(lib, "wsock32.lib")
+#pragma comment(lib, "ws2_32.lib")
+#pragma comment(lib, "Iphlpapi.lib")
+#endif
+
+#ifdef __cplusplus
+using std::min;
+#endif
+
+// Forwards declaration due to winver dispatch
+// We will dispatch at lib_init() which OS functions to call depending on OS support
+
+#ifndef ULIST_SOC
+#define ULIST_SOC
+TDS_ULIST_IMPL(SOCKET, soc)
+#endif
+
+#ifndef ULIST_PVOID
+#define ULIST_PVOID
+TDS_ULIST_IMPL(void*, pvoid)
+#endif
+
+#ifndef ULIST_PVOID
+#define ULIST_PVOID
+TDS_ULIST_IMPL(void*, pvoid)
+#endif
+
+#ifndef TDS_MAP_socket_pvoid
+#define TDS_MAP_socket_pvoid
+TDS_MAP_IMPL(SOCKET, void*, socket_user)
+#endif
+
+// Needs to be compatible with fd_set, hopefully this works. Only used when FD_SETSIZE is to small.
+struct tcs_fd_set
+{
+    u_int fd_count;
+    SOCKET fd_array[1]; // dynamic memory hack that is compatible with Win32 API fd_set
+};
+
+struct TcsPool
+{
+    struct TdsUList_soc read_sockets;
+    struct TdsUList_soc write_sockets;
+    struct TdsUList_soc error_sockets;
+    struct TdsMap_socket_user user_data;
+};
+
+const TcsSocket TCS_SOCKET_INVALID = INVALID_SOCKET;
+const int TCS_INF = -1;
+
+// Addresses
+const uint32_t TCS_ADDRESS_ANY_IP4 = INADDR_ANY;
+const uint32_t TCS_ADDRESS_LOOPBACK_IP4 = INADDR_LOOPBACK;
+const uint32_t TCS_ADDRESS_BROADCAST_IP4 = INADDR_BROADCAST;
+const uint32_t TCS_ADDRESS_NONE_IP4 = INADDR_NONE;
+
+// Type
+const int TCS_SOCK_STREAM = SOCK_STREAM;
+const int TCS_SOCK_DGRAM = SOCK_DGRAM;
+const int TCS_SOCK_RAW = SOCK_RAW;
+
+// Protocol
+const uint16_t TCS_PROTOCOL_IP_TCP = IPPROTO_TCP;
+const uint16_t TCS_PROTOCOL_IP_UDP = IPPROTO_UDP;
+
+// Flags
+const uint32_t TCS_AI_PASSIVE = AI_PASSIVE;
+
+// Recv flags
+const uint32_t TCS_MSG_PEEK = MSG_PEEK;
+const uint32_t TCS_MSG_OOB = MSG_OOB;
+const uint32_t TCS_MSG_WAITALL = 0x8; // Binary compatible when it does not exist
+
+// Send flags
+const uint32_t TCS_MSG_SENDALL = 0x80000000;
+
+// Backlog
+const int TCS_BACKLOG_MAX = SOMAXCONN;
+
+// Option levels
+const int TCS_SOL_SOCKET = SOL_SOCKET;
+const int TCS_SOL_IP = IPPROTO_IP;
+
+// Socket options
+const int TCS_SO_BROADCAST = SO_BROADCAST;
+const int TCS_SO_KEEPALIVE = SO_KEEPALIVE;
+const int TCS_SO_LINGER = SO_LINGER;
+const int TCS_SO_REUSEADDR = SO_REUSEADDR;
+const int TCS_SO_RCVBUF = SO_RCVBUF;
+const int TCS_SO_RCVTIMEO = SO_RCVTIMEO;
+const int TCS_SO_SNDBUF = SO_SNDBUF;
+const int TCS_SO_OOBINLINE = SO_OOBINLINE;
+const int TCS_SO_PRIORITY = -1;
+
+// IP options
+const int TCS_SO_IP_NODELAY = TCP_NODELAY;
+const int TCS_SO_IP_MEMBERSHIP_ADD = IP_ADD_MEMBERSHIP;
+const int TCS_SO_IP_MEMBERSHIP_DROP = IP_DROP_MEMBERSHIP;
+const int TCS_SO_IP_MULTICAST_LOOP = IP_MULTICAST_LOOP;
+
+int g_init_count = 0;
+
+// ######## Internal Helpers ########
+
+static TcsResult wsaerror2retcode(int wsa_error)
+{
+    switch (wsa_error)
+    {
+        case WSANOTINITIALISED:
+            return TCS_ERROR_LIBRARY_NOT_INITIALIZED;
+        case WSAEWOULDBLOCK:
+            return TCS_ERROR_WOULD_BLOCK;
+        case WSAETIMEDOUT:
+            return TCS_ERROR_TIMED_OUT;
+        default:
+            return TCS_ERROR_UNKNOWN;
+    }
+}
+
+static TcsResult socketstatus2retcode(int status)
+{
+    if (status == 0)
+    {
+        return TCS_SUCCESS;
+    }
+    else if (status == SOCKET_ERROR)
+    {
+        int error_code = WSAGetLastError();
+        return wsaerror2retcode(error_code);
+    }
+    else
+    {
+        return TCS_ERROR_UNKNOWN;
+    }
+}
+
+static TcsResult family2native(const TcsAddressFamily family, short* native_family)
+{
+    switch (family)
+    {
+        case TCS_AF_ANY:
+            *native_family = AF_UNSPEC;
+            return TCS_SUCCESS;
+        case TCS_AF_IP4:
+            *native_family = AF_INET;
+            return TCS_SUCCESS;
+        case TCS_AF_IP6:
+            *native_family = AF_INET6;
+            return TCS_SUCCESS;
+
+        case TCS_AF_PACKET:
+#if TCS_AVAILABLE_AF_PACKET
+            *native_family = AF_PACKET;
+#else
+            return TCS_ERROR_NOT_IMPLEMENTED;
+#endif
+            return TCS_SUCCESS;
+        default:
+            return TCS_ERROR_INVALID_ARGUMENT;
+    }
+    return TCS_SUCCESS;
+}
+
+static TcsResult sockaddr2native(const struct TcsAddress* in_addr, PSOCKADDR out_addr, int* out_addrlen)
+{
+    if (in_addr == NULL || out_addr == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    if (in_addr->family == TCS_AF_ANY)
+    {
+        return TCS_ERROR_NOT_IMPLEMENTED;
+    }
+    if (in_addr->family == TCS_AF_IP4)
+    {
+        PSOCKADDR_IN addr = (PSOCKADDR_IN)out_addr;
+        addr->sin_family = (ADDRESS_FAMILY)AF_INET;
+        addr->sin_port = htons((USHORT)in_addr->data.ip4.port);
+        addr->sin_addr.S_un.S_addr = htonl((ULONG)in_addr->data.ip4.address);
+
+        if (out_addrlen != NULL)
+            *out_addrlen = sizeof(SOCKADDR_IN);
+
+        return TCS_SUCCESS;
+    }
+    else if (in_addr->family == TCS_AF_IP6)
+    {
+        return TCS_ERROR_NOT_IMPLEMENTED;
+    }
+    else if (in_addr->family == TCS_AF_PACKET)
+    {
+        return TCS_ERROR_NOT_IMPLEMENTED;
+    }
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+static TcsResult native2sockaddr(const PSOCKADDR in_addr, struct TcsAddress* out_addr)
+{
+    if (in_addr == NULL || out_addr == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    if (in_addr->sa_family == AF_INET)
+    {
+        PSOCKADDR_IN addr = (PSOCKADDR_IN)in_addr;
+        out_addr->family = TCS_AF_IP4;
+        out_addr->data.ip4.port = ntohs((uint16_t)addr->sin_port);
+        out_addr->data.ip4.address = ntohl((uint32_t)addr->sin_addr.S_un.S_addr);
+    }
+    else if (in_addr->sa_family == AF_INET6)
+    {
+        return TCS_ERROR_NOT_IMPLEMENTED;
+    }
+    else if (in_addr->sa_family == AF_UNSPEC)
+    {
+        return TCS_ERROR_INVALID_ARGUMENT;
+    }
+    else
+    {
+        return TCS_ERROR_NOT_IMPLEMENTED;
+    }
+
+    return TCS_SUCCESS;
+}
+
+TcsResult tcs_lib_init(void)
+{
+    if (g_init_count <= 0)
+    {
+        WSADATA wsa_data;
+        int wsa_startup_status_code = WSAStartup(MAKEWORD(2, 2), &wsa_data);
+        if (wsa_startup_status_code != 0)
+            return TCS_ERROR_SYSTEM;
+    }
+    ++g_init_count;
+    return TCS_SUCCESS;
+}
+
+TcsResult tcs_lib_free(void)
+{
+    g_init_count--;
+    if (g_init_count <= 0)
+    {
+        WSACleanup();
+    }
+    return TCS_SUCCESS;
+}
+
+TcsResult tcs_socket(TcsSocket* socket_ctx, TcsAddressFamily family, int type, int protocol)
+{
+    if (socket_ctx == NULL || *socket_ctx != TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (*socket_ctx != TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    short native_family = AF_UNSPEC;
+    TcsResult sts = family2native(family, &native_family);
+    if (sts != TCS_SUCCESS)
+        return sts;
+
+    TcsSocket new_socket = socket(native_family, type, protocol);
+
+    if (new_socket != INVALID_SOCKET)
+    {
+        *socket_ctx = new_socket;
+        return TCS_SUCCESS;
+    }
+    else
+    {
+        int error_code = WSAGetLastError();
+        return wsaerror2retcode(error_code);
+    }
+}
+
+// tcs_socket_preset() is defined in tinycsocket_common.c
+
+TcsResult tcs_close(TcsSocket* socket_ctx)
+{
+    if (socket_ctx == NULL || *socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    int close_status = closesocket(*socket_ctx);
+    if (close_status != SOCKET_ERROR)
+    {
+        *socket_ctx = TCS_SOCKET_INVALID;
+        return TCS_SUCCESS;
+    }
+    else
+    {
+        return socketstatus2retcode(close_status);
+    }
+}
+
+// ######## High-level Socket Creation ########
+
+// tcs_tcp_server_str() is defined in tinycsocket_common.c
+// tcs_tcp_server() is defined in tinycsocket_common.c
+// tcs_tcp_client_str() is defined in tinycsocket_common.c
+// tcs_tcp_client() is defined in tinycsocket_common.c
+// tcs_udp_receiver_str() is defined in tinycsocket_common.c
+// tcs_udp_receiver() is defined in tinycsocket_common.c
+// tcs_udp_sender_str() is defined in tinycsocket_common.c
+// tcs_udp_sender() is defined in tinycsocket_common.c
+// tcs_udp_peer_str() is defined in tinycsocket_common.c
+// tcs_udp_peer() is defined in tinycsocket_common.c
+
+// ######## High-level Raw L2-Packet Sockets (Experimental) ########
+
+// tcs_packet_sender_str() is defined in tinycsocket_common.c
+// tcs_packet_sender() is defined in tinycsocket_common.c
+// tcs_packet_peer_str() is defined in tinycsocket_common.c
+// tcs_packet_peer() is defined in tinycsocket_common.c
+// tcs_packet_capture_iface() is defined in tinycsocket_common.c
+// tcs_packet_capture_ifname() is defined in tinycsocket_common.c
+
+// ######## Socket Operations ########
+
+TcsResult tcs_bind(TcsSocket socket_ctx, const struct TcsAddress* address)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    SOCKADDR_STORAGE native_sockaddr;
+    memset(&native_sockaddr, 0, sizeof native_sockaddr);
+    int addrlen = 0;
+    TcsResult convert_addr_status = sockaddr2native(address, (PSOCKADDR)&native_sockaddr, &addrlen);
+    if (convert_addr_status != TCS_SUCCESS)
+        return convert_addr_status;
+    int bind_status = bind(socket_ctx, (PSOCKADDR)&native_sockaddr, addrlen);
+    return socketstatus2retcode(bind_status);
+}
+
+TcsResult tcs_connect(TcsSocket socket_ctx, const struct TcsAddress* address)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    if (address == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    SOCKADDR_STORAGE native_sockaddr;
+    memset(&native_sockaddr, 0, sizeof native_sockaddr);
+    int addrlen = 0;
+    TcsResult convert_addr_status = sockaddr2native(address, (PSOCKADDR)&native_sockaddr, &addrlen);
+    if (convert_addr_status != TCS_SUCCESS)
+        return convert_addr_status;
+    int connect_status = connect(socket_ctx, (PSOCKADDR)&native_sockaddr, addrlen);
+    return socketstatus2retcode(connect_status);
+}
+
+// tcs_connect_str() is defined in tinycsocket_common.c
+
+TcsResult tcs_listen(TcsSocket socket_ctx, int backlog)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    int status = listen(socket_ctx, (int)backlog);
+    return socketstatus2retcode(status);
+}
+
+TcsResult tcs_accept(TcsSocket socket_ctx, TcsSocket* child_socket_ctx, struct TcsAddress* address)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID || child_socket_ctx == NULL || *child_socket_ctx != TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    SOCKADDR_STORAGE native_sockaddr;
+    memset(&native_sockaddr, 0, sizeof native_sockaddr);
+    int addr_len = sizeof(native_sockaddr);
+    *child_socket_ctx = accept(socket_ctx, (PSOCKADDR)&native_sockaddr, &addr_len);
+    if (*child_socket_ctx != INVALID_SOCKET)
+    {
+        if (address != NULL)
+        {
+            TcsResult convert_addr_status = native2sockaddr((PSOCKADDR)&native_sockaddr, address);
+            if (convert_addr_status != TCS_SUCCESS)
+                return convert_addr_status;
+        }
+        return TCS_SUCCESS;
+    }
+    else
+    {
+        *child_socket_ctx = TCS_SOCKET_INVALID;
+        int error_code = WSAGetLastError();
+        return wsaerror2retcode(error_code);
+    }
+}
+
+TcsResult tcs_shutdown(TcsSocket socket_ctx, TcsSocketDirection direction)
+{
+    const int LUT[] = {SD_RECEIVE, SD_SEND, SD_BOTH};
+
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    const int how = LUT[direction];
+    int shutdown_status = shutdown(socket_ctx, how);
+    return socketstatus2retcode(shutdown_status);
+}
+
+// ######## Data Transfer ########
+
+TcsResult tcs_send(TcsSocket socket_ctx, const uint8_t* buffer, size_t buffer_size, uint32_t flags, size_t* bytes_sent)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    if (bytes_sent != NULL)
+        *bytes_sent = 0;
+
+    if (buffer == NULL || buffer_size == 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    // Send all
+    if (flags & TCS_MSG_SENDALL)
+    {
+        uint32_t new_flags = flags & ~TCS_MSG_SENDALL; // For recursive call
+        size_t left = buffer_size;
+        const uint8_t* iterator = buffer;
+
+        while (left > 0)
+        {
+            size_t sent = 0;
+            TcsResult sts = tcs_send(socket_ctx, iterator, left, new_flags, &sent);
+            if (bytes_sent != NULL)
+                *bytes_sent += sent;
+            if (sts != TCS_SUCCESS)
+                return sts;
+            left -= sent;
+            iterator += sent;
+        }
+        return TCS_SUCCESS;
+    }
+    else // Send
+    {
+        int send_status = send(socket_ctx, (const char*)buffer, (int)buffer_size, (int)flags);
+        if (send_status != SOCKET_ERROR)
+        {
+            if (bytes_sent != NULL)
+                *bytes_sent = (size_t)send_status;
+            return TCS_SUCCESS;
+        }
+        else
+        {
+            if (bytes_sent != NULL)
+                *bytes_sent = 0;
+
+            return socketstatus2retcode(send_status);
+        }
+    }
+}
+
+TcsResult tcs_send_to(TcsSocket socket_ctx,
+                      const uint8_t* buffer,
+                      size_t buffer_size,
+                      uint32_t flags,
+                      const struct TcsAddress* destination_address,
+                      size_t* bytes_sent)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    if (flags & TCS_MSG_SENDALL)
+        return TCS_ERROR_NOT_IMPLEMENTED;
+
+    SOCKADDR_STORAGE native_sockaddr;
+    memset(&native_sockaddr, 0, sizeof native_sockaddr);
+    int addrlen = 0;
+    TcsResult convert_addr_status = sockaddr2native(destination_address, (PSOCKADDR)&native_sockaddr, &addrlen);
+    if (convert_addr_status != TCS_SUCCESS)
+        return convert_addr_status;
+
+    int sendto_status =
+        sendto(socket_ctx, (const char*)buffer, (int)buffer_size, (int)flags, (PSOCKADDR)&native_sockaddr, addrlen);
+
+    if (sendto_status != SOCKET_ERROR)
+    {
+        if (bytes_sent != NULL)
+            *bytes_sent = (size_t)sendto_status;
+        return TCS_SUCCESS;
+    }
+    else
+    {
+        if (bytes_sent != NULL)
+            *bytes_sent = 0;
+
+        return socketstatus2retcode(sendto_status);
+    }
+}
+
+TcsResult tcs_sendv(TcsSocket socket_ctx,
+                    const struct TcsBuffer* buffers,
+                    size_t buffer_count,
+                    uint32_t flags,
+                    size_t* bytes_sent)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID || buffers == NULL || buffer_count == 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    if (flags & TCS_MSG_SENDALL)
+        return TCS_ERROR_NOT_IMPLEMENTED;
+
+    if (buffer_count > TCS_SENDV_MAX)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    WSABUF native_buffers[TCS_SENDV_MAX];
+    for (size_t i = 0; i < buffer_count; ++i)
+    {
+        native_buffers[i].buf = (CHAR*)buffers[i].data;
+        native_buffers[i].len = (ULONG)buffers[i].size;
+    }
+
+    DWORD sent = 0;
+    int wsasend_status = WSASend(socket_ctx, native_buffers, (DWORD)buffer_count, &sent, (DWORD)flags, NULL, NULL);
+
+    if (bytes_sent != NULL)
+        *bytes_sent = (size_t)sent;
+
+    if (wsasend_status != SOCKET_ERROR)
+        return TCS_SUCCESS;
+    else
+        return socketstatus2retcode(wsasend_status);
+}
+
+TcsResult tcs_receive(TcsSocket socket_ctx, uint8_t* buffer, size_t buffer_size, uint32_t flags, size_t* bytes_received)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+#if WINVER <= 0x501
+    if (flags & TCS_MSG_WAITALL)
+    {
+        uint32_t new_flags = flags & ~TCS_MSG_WAITALL; // Unmask for recursive call
+        size_t received_so_far = 0;
+        while (received_so_far < buffer_size)
+        {
+            size_t received_now = 0;
+            uint8_t* cursor = buffer + received_so_far;
+            size_t left = buffer_size - received_so_far;
+            TcsResult sts = tcs_receive(socket_ctx, cursor, left, new_flags, &received_now);
+            if (sts != TCS_SUCCESS)
+            {
+                if (bytes_received != NULL)
+                    *bytes_received = received_so_far;
+                return sts;
+            }
+            received_so_far += received_now;
+        }
+        if (bytes_received != NULL)
+            *bytes_received = received_so_far;
+        return TCS_SUCCESS;
+    }
+#endif
+
+    int recv_status = recv(socket_ctx, (char*)buffer, (int)buffer_size, (int)flags);
+
+    if (recv_status == 0)
+    {
+        if (bytes_received != NULL)
+            *bytes_received = 0;
+        return TCS_ERROR_SOCKET_CLOSED;
+    }
+    else if (recv_status != SOCKET_ERROR)
+    {
+        if (bytes_received != NULL)
+            *bytes_received = (size_t)recv_status;
+        return TCS_SUCCESS;
+    }
+    else
+    {
+        if (bytes_received != NULL)
+            *bytes_received = 0;
+
+        return socketstatus2retcode(recv_status);
+    }
+}
+
+TcsResult tcs_receive_from(TcsSocket socket_ctx,
+                           uint8_t* buffer,
+                           size_t buffer_size,
+                           uint32_t flags,
+                           struct TcsAddress* source_address,
+                           size_t* bytes_received)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    SOCKADDR_STORAGE native_sockaddr;
+    memset(&native_sockaddr, 0, sizeof native_sockaddr);
+    int addrlen = sizeof(native_sockaddr);
+
+    int recvfrom_status =
+        recvfrom(socket_ctx, (char*)buffer, (int)buffer_size, (int)flags, (PSOCKADDR)&native_sockaddr, &addrlen);
+
+    if (recvfrom_status == 0)
+    {
+        return TCS_ERROR_SOCKET_CLOSED;
+    }
+    else if (recvfrom_status != SOCKET_ERROR)
+    {
+        if (bytes_received != NULL)
+            *bytes_received = (size_t)recvfrom_status;
+
+        if (source_address != NULL)
+        {
+            TcsResult convert_address_status = native2sockaddr((PSOCKADDR)&native_sockaddr, source_address);
+            return convert_address_status;
+        }
+
+        return TCS_SUCCESS;
+    }
+    else
+    {
+        if (bytes_received != NULL)
+            *bytes_received = 0;
+
+        return socketstatus2retcode(recvfrom_status);
+    }
+}
+
+TcsResult tcs_send_to_batch(TcsSocket socket_ctx,
+                            const struct TcsDatagram* datagrams,
+                            size_t datagram_count,
+                            uint32_t flags,
+                            size_t* datagrams_sent)
+{
+    if (datagrams_sent != NULL)
+        *datagrams_sent = 0;
+    if (socket_ctx == TCS_SOCKET_INVALID || datagrams == NULL || datagram_count == 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    size_t count = datagram_count > TCS_DATAGRAM_BATCH_MAX ? TCS_DATAGRAM_BATCH_MAX : datagram_count;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (datagrams[i].segment_size > 0 && datagrams[i].size > datagrams[i].segment_size)
+            return i == 0 ? TCS_ERROR_NOT_IMPLEMENTED : TCS_SUCCESS;
+        TcsResult sts = datagrams[i].address.family == TCS_AF_ANY
+                            ? tcs_send(socket_ctx, datagrams[i].data, datagrams[i].size, flags, NULL)
+                            : tcs_send_to(socket_ctx, datagrams[i].data, datagrams[i].size, flags, &datagrams[i].address, NULL);
+        if (sts != TCS_SUCCESS)
+            return i == 0 ? sts : TCS_SUCCESS;
+        if (datagrams_sent != NULL)
+            *datagrams_sent = i + 1;
+    }
+    return TCS_SUCCESS;
+}
+
+TcsResult tcs_receive_from_batch(TcsSocket socket_ctx,
+                                 struct TcsDatagram* datagrams,
+                                 size_t datagram_count,
+                                 uint32_t flags,
+                                 size_t* datagrams_received)
+{
+    if (datagrams_received != NULL)
+        *datagrams_received = 0;
+    if (socket_ctx == TCS_SOCKET_INVALID || datagrams == NULL || datagram_count == 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    datagrams[0].segment_size = 0;
+    TcsResult sts = tcs_receive_from(
+        socket_ctx, datagrams[0].data, datagrams[0].capacity, flags, &datagrams[0].address, &datagrams[0].size);
+    if (sts == TCS_SUCCESS && datagrams_received != NULL)
+        *datagrams_received = 1;
+    return sts;
+}
+
+// todo: Implement with TransmitFile()
+TcsResult tcs_sendfile(TcsSocket socket_ctx,
+                       int file_descriptor,
+                       int64_t* offset,
+                       size_t count,
+                       uint32_t flags,
+                       size_t* bytes_sent)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_splice_create(struct TcsSplice** splice)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_splice_destroy(struct TcsSplice** splice)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_splice(struct TcsSplice* splice,
+                     TcsSocket from_socket_ctx,
+                     TcsSocket to_socket_ctx,
+                     size_t count,
+                     uint32_t flags,
+                     size_t* bytes_moved)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+// Winsock has no zero-copy send, the data is copied and the buffer can be reused at once
+TcsResult tcs_send_zerocopy(TcsSocket socket_ctx,
+                            const uint8_t* buffer,
+                            size_t buffer_size,
+                            uint32_t flags,
+                            size_t* bytes_sent)
+{
+    return tcs_send(socket_ctx, buffer, buffer_size, flags, bytes_sent);
+}
+
+TcsResult tcs_zerocopy_completions(TcsSocket socket_ctx, uint32_t* first_id, uint32_t* last_id, bool* was_copied)
+{
+    return TCS_ERROR_WOULD_BLOCK;
+}
+
+// tcs_receive_line() is defined in tinycsocket_common.c
+// tcs_receive_netstring() is defined in tinycsocket_common.c
+
+// ######## Socket Pooling ########
+
+TcsResult tcs_pool_create(struct TcsPool** pool)
+{
+    if (pool == NULL || *pool != NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    *pool = (struct TcsPool*)malloc(sizeof(struct TcsPool));
+    if (*pool == NULL)
+        return TCS_ERROR_MEMORY;
+    memset(*pool, 0, sizeof(struct TcsPool)); // Just to be safe
+    int sts_read_array = tds_ulist_soc_create(&(*pool)->read_sockets);
+    int sts_write_array = tds_ulist_soc_create(&(*pool)->write_sockets);
+    int sts_error_array = tds_ulist_soc_create(&(*pool)->error_sockets);
+    int sts_user_data = tds_map_socket_user_create(&(*pool)->user_data);
+
+    if (sts_read_array != 0 || sts_write_array != 0 || sts_error_array != 0 || sts_user_data != 0)
+    {
+        tcs_pool_destroy(pool);
+        return TCS_ERROR_MEMORY;
+    }
+    return TCS_SUCCESS;
+}
+
+TcsResult tcs_pool_create_backend(struct TcsPool** pool, TcsPoolBackend backend)
+{
+    if (backend == TCS_POOL_BACKEND_DEFAULT || backend == TCS_POOL_BACKEND_POLL)
+        return tcs_pool_create(pool);
+    if (backend == TCS_POOL_BACKEND_EPOLL || backend == TCS_POOL_BACKEND_EPOLL_ET)
+        return TCS_ERROR_NOT_IMPLEMENTED;
+    return TCS_ERROR_INVALID_ARGUMENT;
+}
+
+TcsResult tcs_pool_destroy(struct TcsPool** pool)
+{
+    if (pool == NULL || *pool == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    // Free away!
+    tds_ulist_soc_destroy(&(*pool)->read_sockets);
+    tds_ulist_soc_destroy(&(*pool)->write_sockets);
+    tds_ulist_soc_destroy(&(*pool)->error_sockets);
+    tds_map_socket_user_destroy(&(*pool)->user_data);
+
+    free(*pool);
+    *pool = NULL;
+
+    return TCS_SUCCESS;
+}
+
+TcsResult tcs_pool_add(struct TcsPool* pool,
+                       TcsSocket socket_ctx,
+                       void* user_data,
+                       bool poll_can_read,
+                       bool poll_can_write,
+                       bool poll_error)
+{
+    if (pool == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (!poll_can_read && !poll_can_write && !poll_error)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    tds_map_socket_user_add(&pool->user_data, socket_ctx, user_data);
+
+    if (poll_can_read)
+    {
+        int sts = tds_ulist_soc_add(&pool->read_sockets, &socket_ctx, 1);
+        if (sts != 0)
+        {
+            return TCS_ERROR_MEMORY;
+        }
+    }
+    if (poll_can_write)
+    {
+        int sts = tds_ulist_soc_add(&pool->write_sockets, &socket_ctx, 1);
+        if (sts != 0)
+        {
+            tds_ulist_soc_remove(&pool->read_sockets, pool->read_sockets.count, 1);
+            return TCS_ERROR_MEMORY;
+        }
+    }
+    if (poll_error)
+    {
+        int sts = tds_ulist_soc_add(&pool->error_sockets, &socket_ctx, 1);
+        if (sts != 0)
+        {
+            tds_ulist_soc_remove(&pool->read_sockets, pool->read_sockets.count, 1);
+            tds_ulist_soc_remove(&pool->write_sockets, pool->write_sockets.count, 1);
+            return TCS_ERROR_MEMORY;
+        }
+    }
+    return TCS_SUCCESS;
+}
+
+TcsResult tcs_pool_remove(struct TcsPool* pool, TcsSocket socket_ctx)
+{
+    for (size_t i = 0; i < pool->read_sockets.count; ++i)
+    {
+        if (pool->read_sockets.data[i] == socket_ctx)
+        {
+            tds_ulist_soc_remove(&pool->read_sockets, i, 1);
+            break;
+        }
+    }
     for (size_t i = 0; i < pool->write_sockets.count; ++i)
     {
-        if (pool->write_sockets.data[i] == socket_ctx)
-        {
-            tds_ulist_soc_remove(&pool->write_sockets, i, 1);
-            break;
-        }
+        if (pool->write_sockets.data[i] == socket_ctx)
+        {
+            tds_ulist_soc_remove(&pool->write_sockets, i, 1);
+            break;
+        }
+    }
+    for (size_t i = 0; i < pool->error_sockets.count; ++i)
+    {
+        if (pool->error_sockets.data[i] == socket_ctx)
+        {
+            tds_ulist_soc_remove(&pool->error_sockets, i, 1);
+            break;
+        }
+    }
+    for (size_t i = 0; i < pool->user_data.count; ++i)
+    {
+        if (pool->user_data.keys[i] == socket_ctx)
+        {
+            tds_map_socket_user_remove(&pool->user_data, i);
+        }
+    }
+
+    return TCS_SUCCESS;
+}
+
+TcsResult tcs_pool_poll(struct TcsPool* pool,
+                        struct TcsPollEvent* events,
+                        size_t events_capacity,
+                        size_t* events_populated,
+                        int64_t timeout_in_ms)
+{
+    if (pool == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (timeout_in_ms != TCS_INF && (timeout_in_ms > 0xffffffff || timeout_in_ms < 0))
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (events == NULL || events_populated == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    // Todo: add more modern implementation. Maybe dispatch att init?
+    // SELECT IMPLEMENTATION
+
+    // Copy fds, use auto storage if possible, otherwise use dynamic memory
+
+    // Allocate so that we can access fd_array out of nominal bounds
+    // We need this hack to be able to use dynamic memory for select
+    const size_t data_offset = offsetof(struct tcs_fd_set, fd_array);
+
+    struct fd_set rfds_stack;
+    struct fd_set wfds_stack;
+    struct fd_set efds_stack;
+
+    struct tcs_fd_set* rfds_heap = NULL;
+    struct tcs_fd_set* wfds_heap = NULL;
+    struct tcs_fd_set* efds_heap = NULL;
+
+    struct tcs_fd_set* rfds_cpy = NULL;
+    struct tcs_fd_set* wfds_cpy = NULL;
+    struct tcs_fd_set* efds_cpy = NULL;
+
+    if (pool->read_sockets.count <= FD_SETSIZE)
+    {
+        FD_ZERO(&rfds_stack);
+        rfds_cpy = (struct tcs_fd_set*)&rfds_stack;
     }
-    for (size_t i = 0; i < pool->error_sockets.count; ++i)
+    else
     {
-        if (pool->error_sockets.data[i] == socket_ctx)
-        {
-            tds_ulist_soc_remove(&pool->error_sockets, i, 1);
-            break;
-        }
+        rfds_heap = (struct tcs_fd_set*)malloc(data_offset + sizeof(SOCKET) * pool->read_sockets.count);
+        rfds_cpy = rfds_heap;
     }
-    for (size_t i = 0; i < pool->user_data.count; ++i)
+
+    if (pool->write_sockets.count >= FD_SETSIZE)
     {
-        if (pool->user_data.keys[i] == socket_ctx)
+        FD_ZERO(&wfds_stack);
+        wfds_cpy = (struct tcs_fd_set*)&wfds_stack;
+    }
+    else
+    {
+        wfds_heap = (struct tcs_fd_set*)malloc(data_offset + sizeof(SOCKET) * pool->write_sockets.count);
+        wfds_cpy = wfds_heap;
+    }
+
+    if (pool->error_sockets.count <= FD_SETSIZE)
+    {
+        FD_ZERO(&efds_stack);
+        efds_cpy = (struct tcs_fd_set*)&efds_stack;
+    }
+    else
+    {
+        wfds_heap = (struct tcs_fd_set*)malloc(data_offset + sizeof(SOCKET) * pool->error_sockets.count);
+        wfds_cpy = wfds_heap;
+    }
+
+    if (rfds_cpy == NULL || wfds_cpy == NULL || efds_cpy == NULL)
+    {
+        if (rfds_heap != NULL)
+            free(rfds_heap);
+        if (wfds_heap != NULL)
+            free(wfds_heap);
+        if (efds_heap != NULL)
+            free(efds_heap);
+
+        return TCS_ERROR_MEMORY;
+    }
+    rfds_cpy->fd_count = (u_int)pool->read_sockets.count;
+    wfds_cpy->fd_count = (u_int)pool->write_sockets.count;
+    efds_cpy->fd_count = (u_int)pool->error_sockets.count;
+
+    memcpy(rfds_cpy->fd_array, pool->read_sockets.data, sizeof(SOCKET) * pool->read_sockets.count);
+    memcpy(wfds_cpy->fd_array, pool->write_sockets.data, sizeof(SOCKET) * pool->write_sockets.count);
+    memcpy(efds_cpy->fd_array, pool->error_sockets.data, sizeof(SOCKET) * pool->error_sockets.count);
+
+    memset(events, 0, sizeof(struct TcsPollEvent) * events_capacity);
+    *events_populated = 0;
+
+    // Run select
+    struct timeval* t_ptr = NULL;
+    struct timeval t = {0, 0};
+    if (timeout_in_ms != TCS_INF)
+    {
+        t.tv_sec = (long)(timeout_in_ms / 1000);
+        t.tv_usec = (long)(timeout_in_ms % 1000) * 1000;
+        t_ptr = &t;
+    }
+    int no = select(IGNORE, (fd_set*)rfds_cpy, (fd_set*)wfds_cpy, (fd_set*)efds_cpy, t_ptr);
+
+    size_t events_added = 0;
+
+    if (no > 0)
+    {
+        for (u_int n = 0; n < rfds_cpy->fd_count && events_added < events_capacity; ++n)
         {
-            tds_map_socket_user_remove(&pool->user_data, i);
+            events[events_added].socket = rfds_cpy->fd_array[n];
+            events[events_added].can_read = true;
+            for (size_t i = 0; i < pool->user_data.count; ++i)
+            {
+                if (events[events_added].socket == pool->user_data.keys[i])
+                {
+                    events[events_added].user_data = pool->user_data.values[i];
+                    break;
+                }
+            }
+            events_added++;
+        }
+        for (u_int n = 0; n < wfds_cpy->fd_count && events_added < events_capacity; ++n)
+        {
+            // Check already added events
+            size_t new_n = events_added;
+            for (size_t m = 0; m < events_added; ++m)
+            {
+                if (events[m].socket == wfds_cpy->fd_array[n])
+                {
+                    new_n = m;
+                    break;
+                }
+            }
+            events[new_n].can_write = true;
+            // Check for new events
+            if (events_added == new_n)
+            {
+                events[new_n].socket = wfds_cpy->fd_array[n];
+
+                for (size_t i = 0; i < pool->user_data.count; ++i)
+                {
+                    if (events[new_n].socket == pool->user_data.keys[i])
+                    {
+                        events[new_n].user_data = pool->user_data.values[i];
+                        break;
+                    }
+                }
+                events_added++;
+            }
+        }
+        for (u_int n = 0; n < efds_cpy->fd_count && events_added < events_capacity; ++n)
+        {
+            // Check already added events
+            size_t new_n = events_added;
+            for (size_t m = 0; m < events_added; ++m)
+            {
+                if (events[m].socket == efds_cpy->fd_array[n])
+                {
+                    new_n = m;
+                    break;
+                }
+            }
+            // Check for new events
+            events[new_n].error = TCS_ERROR_NOT_IMPLEMENTED; //TODO(markusl): Make this a proper error
+            if (events_added == new_n)
+            {
+                events[new_n].socket = efds_cpy->fd_array[n];
+
+                for (size_t i = 0; i < pool->user_data.count; ++i)
+                {
+                    if (events[new_n].socket == pool->user_data.keys[i])
+                    {
+                        events[new_n].user_data = pool->user_data.values[i];
+                        break;
+                    }
+                }
+
+                events_added++;
+            }
         }
     }
 
-    return TCS_SUCCESS;
+    *events_populated = events_added;
+
+    // Clean up
+    if (rfds_heap != NULL)
+        free(rfds_heap);
+    if (wfds_heap != NULL)
+        free(wfds_heap);
+    if (efds_heap != NULL)
+        free(efds_heap);
+
+    if (no == 0)
+    {
+        return TCS_ERROR_TIMED_OUT;
+    }
+    if (no == SOCKET_ERROR)
+    {
+        int error_code = WSAGetLastError();
+        return wsaerror2retcode(error_code);
+    }
+
+    return TCS_SUCCESS;
+}
+
+// ######## Async I/O ########
+
+// todo: Implement TcsRing with I/O completion ports
+
+TcsResult tcs_ring_create(struct TcsRing** ring, unsigned int queue_depth, bool try_io_uring)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_ring_destroy(struct TcsRing** ring)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+bool tcs_ring_is_io_uring(const struct TcsRing* ring)
+{
+    return false;
+}
+
+TcsResult tcs_ring_buffers_register(struct TcsRing* ring, uint8_t* memory, size_t buffer_size, size_t buffer_count)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_ring_buffer_release(struct TcsRing* ring, int buffer_id)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_ring_send(struct TcsRing* ring,
+                        TcsSocket socket_ctx,
+                        const uint8_t* buffer,
+                        size_t buffer_size,
+                        void* user_data)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_ring_receive(struct TcsRing* ring,
+                           TcsSocket socket_ctx,
+                           uint8_t* buffer,
+                           size_t buffer_size,
+                           void* user_data)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_ring_receive_multishot(struct TcsRing* ring, TcsSocket socket_ctx, void* user_data)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_ring_accept(struct TcsRing* ring, TcsSocket socket_ctx, bool multishot, void* user_data)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_ring_cancel(struct TcsRing* ring, TcsSocket socket_ctx)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_ring_submit(struct TcsRing* ring)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_ring_wait(struct TcsRing* ring,
+                        struct TcsRingCompletion* completions,
+                        size_t completions_count,
+                        size_t* completions_populated,
+                        int64_t timeout_in_ms)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+// ######## Threads ########
+
+typedef HANDLE TcsThread;
+#define TCS_THREAD_RESULT DWORD
+#define TCS_THREAD_CALL WINAPI
+
+static TcsResult thread_create(TcsThread* thread, TCS_THREAD_RESULT(TCS_THREAD_CALL* function)(void*), void* argument)
+{
+    *thread = CreateThread(NULL, 0, function, argument, 0, NULL);
+    if (*thread == NULL)
+        return TCS_ERROR_SYSTEM;
+    return TCS_SUCCESS;
+}
+
+static void thread_join(TcsThread thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+static long atomic_load_long(const volatile long* value)
+{
+    return InterlockedCompareExchange((volatile long*)value, 0, 0);
 }
 
-TcsResult tcs_pool_poll(struct TcsPool* pool,
-                        struct TcsPollEvent* events,
-                        size_t events_capacity,
-                        size_t* events_populated,
-                        int64_t timeout_in_ms)
+static void atomic_store_long(volatile long* value, long new_value)
 {
-    if (pool == NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
-    if (timeout_in_ms != TCS_INF && (timeout_in_ms > 0xffffffff || timeout_in_ms < 0))
+    InterlockedExchange(value, new_value);
+}
+
+static int64_t monotonic_ms(void)
+{
+    // GetTickCount64() needs Vista
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (int64_t)(counter.QuadPart * 1000 / frequency.QuadPart);
+}
+
+static unsigned int cpu_count(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (unsigned int)info.dwNumberOfProcessors : 1;
+}
+
+// ######## Socket Options ########
+
+TcsResult tcs_opt_set(TcsSocket socket_ctx,
+                      int32_t level,
+                      int32_t option_name,
+                      const void* option_value,
+                      size_t option_size)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID)
         return TCS_ERROR_INVALID_ARGUMENT;
-    if (events == NULL || events_populated == NULL)
+
+    if (option_name == -1)
+        return TCS_ERROR_NOT_IMPLEMENTED;
+
+    int sockopt_status =
+        setsockopt(socket_ctx, (int)level, (int)option_name, (const char*)option_value, (int)option_size);
+    return socketstatus2retcode(sockopt_status);
+}
+
+TcsResult tcs_opt_get(TcsSocket socket_ctx, int32_t level, int32_t option_name, void* option_value, size_t* option_size)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID || option_value == NULL || option_size == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    // Todo: add more modern implementation. Maybe dispatch att init?
-    // SELECT IMPLEMENTATION
+    if (option_name == -1)
+        return TCS_ERROR_NOT_IMPLEMENTED;
 
-    // Copy fds, use auto storage if possible, otherwise use dynamic memory
+    int sockopt_status = getsockopt(socket_ctx, (int)level, (int)option_name, (char*)option_value, (int*)option_size);
+    return socketstatus2retcode(sockopt_status);
+}
 
-    // Allocate so that we can access fd_array out of nominal bounds
-    // We need this hack to be able to use dynamic memory for select
-    const size_t data_offset = offsetof(struct tcs_fd_set, fd_array);
+// tcs_opt_broadcast_set() is defined in tinycocket_common.c
+// tcs_opt_broadcast_get() is defined in tinycocket_common.c
+// tcs_opt_keep_alive_set() is defined in inycocket_common.c
+// tcs_opt_keep_alive_get() is defined in tinycocket_common.c
+// tcs_opt_reuse_address_set() is defined in tiinycocket_common.c
+// tcs_opt_reuse_address_get() is defined in tiinycocket_common.c
+// tcs_opt_send_buffer_size_set() is defined in tininycocket_common.c
+// tcs_opt_send_buffer_size_get() is defined in tininycocket_common.c
+// tcs_opt_receive_buffer_size_set() is defined in tinyinycocket_common.c
+// tcs_opt_receive_buffer_size_get() is defined in tinyinycocket_common.c
 
-    struct fd_set rfds_stack;
-    struct fd_set wfds_stack;
-    struct fd_set efds_stack;
+TcsResult tcs_opt_receive_timeout_set(TcsSocket socket_ctx, int timeout_ms)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-    struct tcs_fd_set* rfds_heap = NULL;
-    struct tcs_fd_set* wfds_heap = NULL;
-    struct tcs_fd_set* efds_heap = NULL;
+    return tcs_opt_set(socket_ctx, TCS_SOL_SOCKET, TCS_SO_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+}
 
-    struct tcs_fd_set* rfds_cpy = NULL;
-    struct tcs_fd_set* wfds_cpy = NULL;
-    struct tcs_fd_set* efds_cpy = NULL;
+TcsResult tcs_opt_receive_timeout_get(TcsSocket socket_ctx, int* timeout_ms)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID || timeout_ms == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-    if (pool->read_sockets.count <= FD_SETSIZE)
-    {
-        FD_ZERO(&rfds_stack);
-        rfds_cpy = (struct tcs_fd_set*)&rfds_stack;
-    }
-    else
-    {
-        rfds_heap = (struct tcs_fd_set*)malloc(data_offset + sizeof(SOCKET) * pool->read_sockets.count);
-        rfds_cpy = rfds_heap;
-    }
+    DWORD t = 0;
+    size_t t_size = sizeof(t);
+    TcsResult sts = tcs_opt_get(socket_ctx, TCS_SOL_SOCKET, TCS_SO_RCVTIMEO, &t, &t_size);
 
-    if (pool->write_sockets.count >= FD_SETSIZE)
+    if (sts == TCS_SUCCESS)
     {
-        FD_ZERO(&wfds_stack);
-        wfds_cpy = (struct tcs_fd_set*)&wfds_stack;
+        *timeout_ms = (int)t;
     }
-    else
+    return sts;
+}
+
+TcsResult tcs_opt_linger_set(TcsSocket socket_ctx, bool do_linger, int timeout_seconds)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    struct linger l = {(u_short)do_linger, (u_short)timeout_seconds};
+    return tcs_opt_set(socket_ctx, TCS_SOL_SOCKET, TCS_SO_LINGER, &l, sizeof(l));
+}
+
+TcsResult tcs_opt_linger_get(TcsSocket socket_ctx, bool* do_linger, int* timeout_seconds)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID || (do_linger == NULL && timeout_seconds == NULL))
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    struct linger l = {0, 0};
+    size_t l_size = sizeof(l);
+    TcsResult sts = tcs_opt_get(socket_ctx, TCS_SOL_SOCKET, TCS_SO_LINGER, &l, &l_size);
+    if (sts == TCS_SUCCESS)
     {
-        wfds_heap = (struct tcs_fd_set*)malloc(data_offset + sizeof(SOCKET) * pool->write_sockets.count);
-        wfds_cpy = wfds_heap;
+        if (do_linger)
+            *do_linger = l.l_onoff;
+        if (timeout_seconds)
+            *timeout_seconds = l.l_linger;
     }
 
-    if (pool->error_sockets.count <= FD_SETSIZE)
+    return sts;
+}
+
+// tcs_opt_ip_no_delay_set() is defined in tinycsocket_common.c
+// tcs_opt_ip_no_delay_get() is defined in tinycsocket_common.c
+// tcs_opt_out_of_band_inline_set() is defined in tinycsocket_common.c
+// tcs_opt_out_of_band_inline_get() is defined in tinycsocket_common.c
+// tcs_opt_priority_set() is defined in tinycsocket_common.c
+// tcs_opt_priority_get() is defined in tinycsocket_common.c
+
+TcsResult tcs_opt_nonblocking_set(TcsSocket socket_ctx, bool do_non_blocking)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_opt_nonblocking_get(TcsSocket socket_ctx, bool* is_non_blocking)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_opt_udp_gro_set(TcsSocket socket_ctx, bool do_gro)
+{
+    (void)socket_ctx;
+    (void)do_gro;
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_opt_zerocopy_set(TcsSocket socket_ctx, bool do_zerocopy)
+{
+    (void)socket_ctx;
+    (void)do_zerocopy;
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_opt_reuse_port_set(TcsSocket socket_ctx, bool do_allow_reuse_port)
+{
+    (void)socket_ctx;
+    (void)do_allow_reuse_port;
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_opt_membership_add(TcsSocket socket_ctx, const struct TcsAddress* multicast_address)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_opt_membership_add_to(TcsSocket socket_ctx,
+                                    const struct TcsAddress* local_address,
+                                    const struct TcsAddress* multicast_address)
+{
+    if (multicast_address == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    // TODO(markusl): Add ipv6 support
+    if (multicast_address->family != TCS_AF_IP4)
+        return TCS_ERROR_NOT_IMPLEMENTED;
+
+    struct ip_mreq imr;
+    memset(&imr, 0, sizeof imr);
+    imr.imr_multiaddr.s_addr = htonl(multicast_address->data.ip4.address);
+    if (local_address != NULL)
+        imr.imr_interface.s_addr = htonl(local_address->data.ip4.address);
+
+    return tcs_opt_set(socket_ctx, TCS_SOL_IP, TCS_SO_IP_MEMBERSHIP_ADD, &imr, sizeof(imr));
+}
+
+TcsResult tcs_opt_membership_drop(TcsSocket socket_ctx, const struct TcsAddress* multicast_address)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_opt_membership_drop_from(TcsSocket socket_ctx,
+                                       const struct TcsAddress* local_address,
+                                       const struct TcsAddress* multicast_address)
+{
+    if (multicast_address == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    // TODO(markusl): Add ipv6 support
+    if (multicast_address->family != TCS_AF_IP4)
+        return TCS_ERROR_NOT_IMPLEMENTED;
+
+    struct ip_mreq imr;
+    memset(&imr, 0, sizeof imr);
+    imr.imr_multiaddr.s_addr = htonl(multicast_address->data.ip4.address);
+    if (local_address != NULL)
+        imr.imr_interface.s_addr = htonl(local_address->data.ip4.address);
+
+    return tcs_opt_set(socket_ctx, TCS_SOL_IP, TCS_SO_IP_MEMBERSHIP_DROP, &imr, sizeof(imr));
+}
+
+// ######## Address and Interface Utilities ########
+
+TcsResult tcs_interface_list(struct TcsInterface interfaces[], size_t capacity, size_t* out_count)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
+
+TcsResult tcs_address_resolve(const char* hostname,
+                              TcsAddressFamily address_family,
+                              struct TcsAddress addresses[],
+                              size_t capacity,
+                              size_t* out_count)
+{
+    if (hostname == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    if (addresses == NULL && out_count == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    if (out_count != NULL)
+        *out_count = 0;
+
+    ADDRINFOA native_hints;
+    memset(&native_hints, 0, sizeof native_hints);
+    TcsResult sts = family2native(address_family, (short*)&native_hints.ai_family);
+    if (sts != TCS_SUCCESS)
+        return sts;
+
+    PADDRINFOA native_addrinfo_list = NULL;
+    int getaddrinfo_status = getaddrinfo(hostname, NULL, &native_hints, &native_addrinfo_list);
+    if (getaddrinfo_status != 0)
+        return TCS_ERROR_ADDRESS_LOOKUP_FAILED;
+
+    if (native_addrinfo_list == NULL)
+        return TCS_ERROR_UNKNOWN;
+
+    size_t i = 0;
+    if (addresses == NULL)
     {
-        FD_ZERO(&efds_stack);
-        efds_cpy = (struct tcs_fd_set*)&efds_stack;
+        for (PADDRINFOA iter = native_addrinfo_list; iter != NULL; iter = iter->ai_next)
+            i++;
     }
     else
-    {
-        wfds_heap = (struct tcs_fd_set*)malloc(data_offset + sizeof(SOCKET) * pool->error_sockets.count);
-        wfds_cpy = wfds_heap;
+    {
+        for (PADDRINFOA iter = native_addrinfo_list; iter != NULL && i < capacity; iter = iter->ai_next)
+        {
+            TcsResult address_convert_status = native2sockaddr(iter->ai_addr, &addresses[i]);
+            if (address_convert_status != TCS_SUCCESS)
+                continue;
+            i++;
+        }
     }
+    if (out_count != NULL)
+        *out_count = i;
 
-    if (rfds_cpy == NULL || wfds_cpy == NULL || efds_cpy == NULL)
-    {
-        if (rfds_heap != NULL)
-            free(rfds_heap);
-        if (wfds_heap != NULL)
-            free(wfds_heap);
-        if (efds_heap != NULL)
-            free(efds_heap);
+    freeaddrinfo(native_addrinfo_list);
 
-        return TCS_ERROR_MEMORY;
-    }
-    rfds_cpy->fd_count = (u_int)pool->read_sockets.count;
-    wfds_cpy->fd_count = (u_int)pool->write_sockets.count;
-    efds_cpy->fd_count = (u_int)pool->error_sockets.count;
+    if (i == 0)
+        return TCS_ERROR_ADDRESS_LOOKUP_FAILED;
 
-    memcpy(rfds_cpy->fd_array, pool->read_sockets.data, sizeof(SOCKET) * pool->read_sockets.count);
-    memcpy(wfds_cpy->fd_array, pool->write_sockets.data, sizeof(SOCKET) * pool->write_sockets.count);
-    memcpy(efds_cpy->fd_array, pool->error_sockets.data, sizeof(SOCKET) * pool->error_sockets.count);
+    return TCS_SUCCESS;
+}
 
-    memset(events, 0, sizeof(struct TcsPollEvent) * events_capacity);
-    *events_populated = 0;
+TcsResult tcs_address_resolve_timeout(const char* hostname,
+                                      TcsAddressFamily address_family,
+                                      struct TcsAddress addresses[],
+                                      size_t capacity,
+                                      size_t* out_count,
+                                      int timeout_ms)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
 
-    // Run select
-    struct timeval* t_ptr = NULL;
-    struct timeval t = {0, 0};
-    if (timeout_in_ms != TCS_INF)
-    {
-        t.tv_sec = (long)(timeout_in_ms / 1000);
-        t.tv_usec = (long)(timeout_in_ms % 1000) * 1000;
-        t_ptr = &t;
-    }
-    int no = select(IGNORE, (fd_set*)rfds_cpy, (fd_set*)wfds_cpy, (fd_set*)efds_cpy, t_ptr);
+TcsResult tcs_address_list(unsigned int interface_id_filter,
+                           TcsAddressFamily address_family_filter,
+                           struct TcsInterfaceAddress interface_addresses[],
+                           size_t capacity,
+                           size_t* out_count)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+    /*
+    if (found_interfaces == NULL && no_of_found_interfaces == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-    size_t events_added = 0;
+    if (found_interfaces == NULL && found_interfaces_length != 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-    if (no > 0)
+    if (no_of_found_interfaces != NULL)
+        *no_of_found_interfaces = 0;
+
+    const int MAX_TRIES = 3;
+    ULONG adapeters_buffer_size = 15000;
+    PIP_ADAPTER_ADDRESSES adapters = NULL;
+    ULONG adapter_sts = ERROR_NO_DATA;
+    for (int i = 0; i < MAX_TRIES; ++i)
     {
-        for (u_int n = 0; n < rfds_cpy->fd_count && events_added < events_capacity; ++n)
+        adapters = (PIP_ADAPTER_ADDRESSES)malloc(adapeters_buffer_size);
+        adapter_sts = GetAdaptersAddresses(AF_UNSPEC, 0, NULL, adapters, &adapeters_buffer_size);
+        if (adapter_sts == ERROR_BUFFER_OVERFLOW)
         {
-            events[events_added].socket = rfds_cpy->fd_array[n];
-            events[events_added].can_read = true;
-            for (size_t i = 0; i < pool->user_data.count; ++i)
-            {
-                if (events[events_added].socket == pool->user_data.keys[i])
-                {
-                    events[events_added].user_data = pool->user_data.values[i];
-                    break;
-                }
-            }
-            events_added++;
+            free(adapters);
+            adapters = NULL;
         }
-        for (u_int n = 0; n < wfds_cpy->fd_count && events_added < events_capacity; ++n)
+        else
         {
-            // Check already added events
-            size_t new_n = events_added;
-            for (size_t m = 0; m < events_added; ++m)
-            {
-                if (events[m].socket == wfds_cpy->fd_array[n])
-                {
-                    new_n = m;
-                    break;
-                }
-            }
-            events[new_n].can_write = true;
-            // Check for new events
-            if (events_added == new_n)
-            {
-                events[new_n].socket = wfds_cpy->fd_array[n];
-
-                for (size_t i = 0; i < pool->user_data.count; ++i)
-                {
-                    if (events[new_n].socket == pool->user_data.keys[i])
-                    {
-                        events[new_n].user_data = pool->user_data.values[i];
-                        break;
-                    }
-                }
-                events_added++;
-            }
+            break;
         }
-        for (u_int n = 0; n < efds_cpy->fd_count && events_added < events_capacity; ++n)
+    }
+    if (adapter_sts != NO_ERROR)
+    {
+        if (adapters != NULL)
+            free(adapters);
+        return TCS_ERROR_UNKNOWN;
+    }
+
+    size_t i = 0;
+    for (PIP_ADAPTER_ADDRESSES iter = adapters;
+         iter != NULL && (found_interfaces == NULL || i < found_interfaces_length);
+         iter = iter->Next)
+    {
+        if (iter->OperStatus != IfOperStatusUp)
+            continue;
+        for (PIP_ADAPTER_UNICAST_ADDRESS address_iter = iter->FirstUnicastAddress; address_iter != NULL;
+             address_iter = address_iter->Next)
         {
-            // Check already added events
-            size_t new_n = events_added;
-            for (size_t m = 0; m < events_added; ++m)
-            {
-                if (events[m].socket == efds_cpy->fd_array[n])
-                {
-                    new_n = m;
-                    break;
-                }
-            }
-            // Check for new events
-            events[new_n].error = TCS_ERROR_NOT_IMPLEMENTED; //TODO(markusl): Make this a proper error
-            if (events_added == new_n)
+            struct TcsAddress t;
+            if (native2sockaddr(address_iter->Address.lpSockaddr, &t) != TCS_SUCCESS)
+                continue;
+            if (found_interfaces != NULL)
             {
-                events[new_n].socket = efds_cpy->fd_array[n];
-
-                for (size_t i = 0; i < pool->user_data.count; ++i)
-                {
-                    if (events[new_n].socket == pool->user_data.keys[i])
-                    {
-                        events[new_n].user_data = pool->user_data.values[i];
-                        break;
-                    }
-                }
-
-                events_added++;
+                found_interfaces[i].address = t;
+                memset(found_interfaces[i].name, '\0', 32);
+                WideCharToMultiByte(CP_UTF8, 0, iter->FriendlyName, -1, found_interfaces[i].name, 31, NULL, NULL);
             }
+            ++i;
         }
     }
+    if (adapters != NULL)
+        free(adapters);
+    if (no_of_found_interfaces != NULL)
+        *no_of_found_interfaces = i;
 
-    *events_populated = events_added;
+    return TCS_SUCCESS;
+    */
+}
 
-    // Clean up
-    if (rfds_heap != NULL)
-        free(rfds_heap);
-    if (wfds_heap != NULL)
-        free(wfds_heap);
-    if (efds_heap != NULL)
-        free(efds_heap);
+TcsResult tcs_address_socket_local(TcsSocket socket_ctx, struct TcsAddress* local_address)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
 
-    if (no == 0)
-    {
-        return TCS_ERROR_TIMED_OUT;
-    }
-    if (no == SOCKET_ERROR)
-    {
-        int error_code = WSAGetLastError();
-        return wsaerror2retcode(error_code);
-    }
+TcsResult tcs_address_socket_remote(TcsSocket socket_ctx, struct TcsAddress* remote_address)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
 
-    return TCS_SUCCESS;
+TcsResult tcs_address_socket_family(TcsSocket socket_ctx, TcsAddressFamily* out_family)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
 }
 
-// ######## Socket Options ########
+// tcs_address_parse() is defined in tinycsocket_common.c
+// tcs_address_to_str() is defined in tinycsocket_common.c
+// tcs_address_is_equal() is defined in tinycsocket_common.c
+// tcs_address_is_any() is defined in tinycsocket_common.c
+// tcs_address_is_local() is defined in tinycsocket_common.c
+// tcs_address_is_loopback() is defined in tinycsocket_common.c
+// tcs_address_is_multicast() is defined in tinycsocket_common.c
+// tcs_address_is_broadcast() is defined in tinycsocket_common.c
+
+#endif
+
+/**********************************/
+/****** tinycsocket_common.h ******/
+/**********************************/
+/*
+ * Copyright 2018 Markus Lindelöw
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef TINYCSOCKET_INTERNAL_H_
+#include "tinycsocket_internal.h"
+#endif
+
+// This file should never call OS dependent code. Do not include OS files of OS specific ifdefs
+
+#ifdef DO_WRAP
+#include "dbg_wrap.h"
+#endif
+
+#include <stdbool.h>
+#include <stdio.h>  //sprintf
+#include <string.h> // memset
+
+// ######## Library Management ########
 
-TcsResult tcs_opt_set(TcsSocket socket_ctx,
-                      int32_t level,
-                      int32_t option_name,
-                      const void* option_value,
-                      size_t option_size)
-{
-    if (socket_ctx == TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
+// tcs_lib_init() is defined in OS specific files
+// tcs_lib_free() is defined in OS specific files
 
-    if (option_name == -1)
-        return TCS_ERROR_NOT_IMPLEMENTED;
+// ######## Socket Creation ########
 
-    int sockopt_status =
-        setsockopt(socket_ctx, (int)level, (int)option_name, (const char*)option_value, (int)option_size);
-    return socketstatus2retcode(sockopt_status);
-}
+// tcs_socket() is defined in OS specific files
 
-TcsResult tcs_opt_get(TcsSocket socket_ctx, int32_t level, int32_t option_name, void* option_value, size_t* option_size)
+TcsResult tcs_socket_preset(TcsSocket* socket_ctx, TcsPreset socket_type)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID || option_value == NULL || option_size == NULL)
+    if (socket_ctx == NULL || *socket_ctx != TCS_SOCKET_INVALID)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    if (option_name == -1)
-        return TCS_ERROR_NOT_IMPLEMENTED;
+    TcsAddressFamily family = TCS_AF_ANY;
+    int type = 0;
+    int protocol = 0;
 
-    int sockopt_status = getsockopt(socket_ctx, (int)level, (int)option_name, (char*)option_value, (int*)option_size);
-    return socketstatus2retcode(sockopt_status);
+    switch (socket_type)
+    {
+        case TCS_PRESET_TCP_IP4:
+            family = TCS_AF_IP4;
+            type = TCS_SOCK_STREAM;
+            protocol = TCS_PROTOCOL_IP_TCP;
+            break;
+        case TCS_PRESET_UDP_IP4:
+            family = TCS_AF_IP4;
+            type = TCS_SOCK_DGRAM;
+            protocol = TCS_PROTOCOL_IP_UDP;
+            break;
+        case TCS_PRESET_PACKET:
+            family = TCS_AF_PACKET;
+            type = TCS_SOCK_RAW;
+            protocol = 0; // Block all traffic, unblock with tcs_bind_addr()
+            break;
+        case TCS_PRESET_TCP_IP6:
+            family = TCS_AF_IP6;
+            type = TCS_SOCK_STREAM;
+            protocol = TCS_PROTOCOL_IP_TCP;
+            break;
+        case TCS_PRESET_UDP_IP6:
+            family = TCS_AF_IP6;
+            type = TCS_SOCK_DGRAM;
+            protocol = TCS_PROTOCOL_IP_UDP;
+            break;
+        default:
+            return TCS_ERROR_NOT_IMPLEMENTED;
+            break;
+    }
+    return tcs_socket(socket_ctx, family, type, protocol);
 }
 
-// tcs_opt_broadcast_set() is defined in tinycocket_common.c
-// tcs_opt_broadcast_get() is defined in tinycocket_common.c
-// tcs_opt_keep_alive_set() is defined in inycocket_common.c
-// tcs_opt_keep_alive_get() is defined in tinycocket_common.c
-// tcs_opt_reuse_address_set() is defined in tiinycocket_common.c
-// tcs_opt_reuse_address_get() is defined in tiinycocket_common.c
-// tcs_opt_send_buffer_size_set() is defined in tininycocket_common.c
-// tcs_opt_send_buffer_size_get() is defined in tininycocket_common.c
-// tcs_opt_receive_buffer_size_set() is defined in tinyinycocket_common.c
-// tcs_opt_receive_buffer_size_get() is defined in tinyinycocket_common.c
+// tcs_close() is defined in OS specific files
 
-TcsResult tcs_opt_receive_timeout_set(TcsSocket socket_ctx, int timeout_ms)
+// ######## High-level Socket Creation ########
+
+TcsResult tcs_tcp_server(TcsSocket* socket_ctx, const struct TcsAddress* local_address)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID)
+    if (socket_ctx == NULL || *socket_ctx != TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (local_address == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    return tcs_opt_set(socket_ctx, TCS_SOL_SOCKET, TCS_SO_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+    TcsResult res = tcs_socket(socket_ctx, local_address->family, TCS_SOCK_STREAM, TCS_PROTOCOL_IP_TCP);
+    if (res != TCS_SUCCESS)
+        return res;
+    res = tcs_opt_reuse_address_set(*socket_ctx, true);
+    if (res != TCS_SUCCESS)
+		return res;
+		
+    res = tcs_bind(*socket_ctx, local_address);
+    if (res != TCS_SUCCESS)
+    {
+        tcs_close(socket_ctx);
+        return res;
+    }
+    res = tcs_listen(*socket_ctx, TCS_BACKLOG_MAX);
+    if (res != TCS_SUCCESS)
+    {
+        tcs_close(socket_ctx);
+        return res;
+    }
+    return TCS_SUCCESS;
 }
 
-TcsResult tcs_opt_receive_timeout_get(TcsSocket socket_ctx, int* timeout_ms)
+TcsResult tcs_tcp_server_str(TcsSocket* socket_ctx, const char* local_address, uint16_t port)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID || timeout_ms == NULL)
+    if (socket_ctx == NULL || *socket_ctx != TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (local_address == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    DWORD t = 0;
-    size_t t_size = sizeof(t);
-    TcsResult sts = tcs_opt_get(socket_ctx, TCS_SOL_SOCKET, TCS_SO_RCVTIMEO, &t, &t_size);
+    struct TcsAddress bind_address = TCS_ADDRESS_NONE;
+    TcsResult res = tcs_address_parse(local_address, &bind_address);
+    if (res != TCS_SUCCESS)
+        return res;
 
-    if (sts == TCS_SUCCESS)
+    if (bind_address.family != TCS_AF_IP4 && bind_address.family != TCS_AF_IP6)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    uint16_t* parsed_port = NULL;
+    if (bind_address.family == TCS_AF_IP4)
     {
-        *timeout_ms = (int)t;
+        parsed_port = &bind_address.data.ip4.port;
+    }
+    else if (bind_address.family == TCS_AF_IP6)
+    {
+        parsed_port = &bind_address.data.ip6.port;
+    }
+    else
+    {
+        return TCS_ERROR_UNKNOWN;
     }
-    return sts;
-}
 
-TcsResult tcs_opt_linger_set(TcsSocket socket_ctx, bool do_linger, int timeout_seconds)
-{
-    if (socket_ctx == TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
+    if (port == 0 && *parsed_port == 0)
+        return TCS_ERROR_INVALID_ARGUMENT; // No port specified
+    if (port != 0 && *parsed_port != 0)
+        return TCS_ERROR_INVALID_ARGUMENT; // Port specified in both string and argument
 
-    struct linger l = {(u_short)do_linger, (u_short)timeout_seconds};
-    return tcs_opt_set(socket_ctx, TCS_SOL_SOCKET, TCS_SO_LINGER, &l, sizeof(l));
+    if (port != 0 && *parsed_port == 0)
+        *parsed_port = port;
+
+    return tcs_tcp_server(socket_ctx, &bind_address);
 }
 
-TcsResult tcs_opt_linger_get(TcsSocket socket_ctx, bool* do_linger, int* timeout_seconds)
+TcsResult tcs_tcp_client(TcsSocket* socket_ctx, const struct TcsAddress* remote_address, int timeout_ms)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID || (do_linger == NULL && timeout_seconds == NULL))
+    if (socket_ctx == NULL || *socket_ctx != TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (timeout_ms < 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (remote_address == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (remote_address->family != TCS_AF_IP4 && remote_address->family != TCS_AF_IP6)
+        return TCS_ERROR_NOT_IMPLEMENTED;
+    if (remote_address->family == TCS_AF_IP4 && remote_address->data.ip4.port == 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (remote_address->family == TCS_AF_IP6 && remote_address->data.ip6.port == 0)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    struct linger l = {0, 0};
-    size_t l_size = sizeof(l);
-    TcsResult sts = tcs_opt_get(socket_ctx, TCS_SOL_SOCKET, TCS_SO_LINGER, &l, &l_size);
-    if (sts == TCS_SUCCESS)
+    TcsResult res = tcs_socket(socket_ctx, remote_address->family, TCS_SOCK_STREAM, TCS_PROTOCOL_IP_TCP);
+    if (res != TCS_SUCCESS)
+        return res;
+
+    struct TcsPool* timeout_pool = NULL;
+    res = tcs_pool_create(&timeout_pool);
+    if (res != TCS_SUCCESS)
     {
-        if (do_linger)
-            *do_linger = l.l_onoff;
-        if (timeout_seconds)
-            *timeout_seconds = l.l_linger;
+        tcs_close(socket_ctx);
+        return res;
     }
 
-    return sts;
+    res = tcs_opt_nonblocking_set(*socket_ctx, true);
+    if (res != TCS_SUCCESS)
+    {
+        tcs_pool_destroy(&timeout_pool);
+        tcs_close(socket_ctx);
+        return res;
+    }
+    res = tcs_connect(*socket_ctx, remote_address);
+    // // TODO: kolla vad tcs_connect returnerar i icke-blockande läge
+
+    // tcs_pool_add(timeout_pool, *socket_ctx, NULL, true, true, true);
+
+    // struct TcsPollEvent event;
+    // size_t events_populated = 0;
+    // tcs_pool_poll(timeout_pool, &event, 1, &events_populated, timeout_ms);
+    // if (events_populated == 0)
+    //     res = TCS_ERROR_TIMED_OUT;
+    // else if ((event.events & TCS_POLLERR) != 0)
+    //     res = TCS_ERROR_CONNECTION_REFUSED;
+    // else if ((event.events & TCS_POLLHUP) != 0)
+    //     res = TCS_ERROR_CONNECTION_REFUSED;
+    // else if ((event.events & TCS_POLLOUT) != 0)
+    //     res = TCS_SUCCESS;
+    // else
+    //     res = TCS_ERROR_UNKNOWN;
+    return TCS_ERROR_UNKNOWN;
 }
 
-// tcs_opt_ip_no_delay_set() is defined in tinycsocket_common.c
-// tcs_opt_ip_no_delay_get() is defined in tinycsocket_common.c
-// tcs_opt_out_of_band_inline_set() is defined in tinycsocket_common.c
-// tcs_opt_out_of_band_inline_get() is defined in tinycsocket_common.c
-// tcs_opt_priority_set() is defined in tinycsocket_common.c
-// tcs_opt_priority_get() is defined in tinycsocket_common.c
+TcsResult tcs_tcp_client_str(TcsSocket* socket_ctx, const char* remote_address, uint16_t port, int timeout_ms)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
 
-TcsResult tcs_opt_nonblocking_set(TcsSocket socket_ctx, bool do_non_blocking)
+TcsResult tcs_udp_receiver(TcsSocket* socket_ctx, const struct TcsAddress* local_address)
 {
     return TCS_ERROR_NOT_IMPLEMENTED;
 }
 
-TcsResult tcs_opt_nonblocking_get(TcsSocket socket_ctx, bool* is_non_blocking)
+TcsResult tcs_udp_receiver_str(TcsSocket* socket_ctx, const char* local_address, uint16_t port)
 {
     return TCS_ERROR_NOT_IMPLEMENTED;
 }
 
-TcsResult tcs_opt_membership_add(TcsSocket socket_ctx, const struct TcsAddress* multicast_address)
+TcsResult tcs_udp_sender(TcsSocket* socket_ctx, const struct TcsAddress* remote_address)
 {
     return TCS_ERROR_NOT_IMPLEMENTED;
 }
 
-TcsResult tcs_opt_membership_add_to(TcsSocket socket_ctx,
-                                    const struct TcsAddress* local_address,
-                                    const struct TcsAddress* multicast_address)
+TcsResult tcs_udp_sender_str(TcsSocket* socket_ctx, const char* remote_address, uint16_t port)
 {
-    if (multicast_address == NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
 
-    // TODO(markusl): Add ipv6 support
-    if (multicast_address->family != TCS_AF_IP4)
-        return TCS_ERROR_NOT_IMPLEMENTED;
+TcsResult tcs_udp_peer(TcsSocket* socket_ctx,
+                       const struct TcsAddress* local_address,
+                       const struct TcsAddress* remote_address)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
 
-    struct ip_mreq imr;
-    memset(&imr, 0, sizeof imr);
-    imr.imr_multiaddr.s_addr = htonl(multicast_address->data.ip4.address);
-    if (local_address != NULL)
-        imr.imr_interface.s_addr = htonl(local_address->data.ip4.address);
+TcsResult tcs_udp_peer_str(TcsSocket* socket_ctx,
+                           const char* local_address,
+                           uint16_t local_port,
+                           const char* remote_address,
+                           uint16_t remote_port)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
 
-    return tcs_opt_set(socket_ctx, TCS_SOL_IP, TCS_SO_IP_MEMBERSHIP_ADD, &imr, sizeof(imr));
+// ######## High-level Raw L2-Packet Sockets (Experimental) ########
+
+TcsResult tcs_packet_sender_str(TcsSocket* socket_ctx,
+                                const char* interface_name,
+                                const uint8_t destination_mac[6],
+                                uint16_t protocol)
+{
+    return TCS_ERROR_NOT_IMPLEMENTED;
 }
 
-TcsResult tcs_opt_membership_drop(TcsSocket socket_ctx, const struct TcsAddress* multicast_address)
+TcsResult tcs_packet_sender(TcsSocket* socket_ctx, const struct TcsAddress* remote_address)
 {
     return TCS_ERROR_NOT_IMPLEMENTED;
 }
 
-TcsResult tcs_opt_membership_drop_from(TcsSocket socket_ctx,
-                                       const struct TcsAddress* local_address,
-                                       const struct TcsAddress* multicast_address)
+TcsResult tcs_packet_peer_str(TcsSocket* socket_ctx,
+                              const char* interface_name,
+                              const uint8_t destination_mac[6],
+                              uint16_t protocol)
 {
-    if (multicast_address == NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
-
-    // TODO(markusl): Add ipv6 support
-    if (multicast_address->family != TCS_AF_IP4)
-        return TCS_ERROR_NOT_IMPLEMENTED;
-
-    struct ip_mreq imr;
-    memset(&imr, 0, sizeof imr);
-    imr.imr_multiaddr.s_addr = htonl(multicast_address->data.ip4.address);
-    if (local_address != NULL)
-        imr.imr_interface.s_addr = htonl(local_address->data.ip4.address);
-
-    return tcs_opt_set(socket_ctx, TCS_SOL_IP, TCS_SO_IP_MEMBERSHIP_DROP, &imr, sizeof(imr));
+    return TCS_ERROR_NOT_IMPLEMENTED;
 }
 
-// ######## Address and Interface Utilities ########
-
-TcsResult tcs_interface_list(struct TcsInterface interfaces[], size_t capacity, size_t* out_count)
+TcsResult tcs_packet_peer(TcsSocket* socket_ctx,
+                          const struct TcsAddress* local_address,
+                          const struct TcsAddress* remote_address)
 {
     return TCS_ERROR_NOT_IMPLEMENTED;
 }
 
-TcsResult tcs_address_resolve(const char* hostname,
-                              TcsAddressFamily address_family,
-                              struct TcsAddress addresses[],
-                              size_t capacity,
-                              size_t* out_count)
+TcsResult tcs_packet_capture_iface(TcsSocket* socket_ctx, const struct TcsInterface* iface)
 {
-    if (hostname == NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
-
-    if (addresses == NULL && out_count == NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
-
-    if (out_count != NULL)
-        *out_count = 0;
-
-    ADDRINFOA native_hints;
-    memset(&native_hints, 0, sizeof native_hints);
-    TcsResult sts = family2native(address_family, (short*)&native_hints.ai_family);
-    if (sts != TCS_SUCCESS)
-        return sts;
-
-    PADDRINFOA native_addrinfo_list = NULL;
-    int getaddrinfo_status = getaddrinfo(hostname, NULL, &native_hints, &native_addrinfo_list);
-    if (getaddrinfo_status != 0)
-        return TCS_ERROR_ADDRESS_LOOKUP_FAILED;
-
-    if (native_addrinfo_list == NULL)
-        return TCS_ERROR_UNKNOWN;
-
-    size_t i = 0;
-    if (addresses == NULL)
-    {
-        for (PADDRINFOA iter = native_addrinfo_list; iter != NULL; iter = iter->ai_next)
-            i++;
-    }
-    else
-    {
-        for (PADDRINFOA iter = native_addrinfo_list; iter != NULL && i < capacity; iter = iter->ai_next)
-        {
-            TcsResult address_convert_status = native2sockaddr(iter->ai_addr, &addresses[i]);
-            if (address_convert_status != TCS_SUCCESS)
-                continue;
-            i++;
-        }
-    }
-    if (out_count != NULL)
-        *out_count = i;
-
-    freeaddrinfo(native_addrinfo_list);
-
-    if (i == 0)
-        return TCS_ERROR_ADDRESS_LOOKUP_FAILED;
-
-    return TCS_SUCCESS;
+    return TCS_ERROR_NOT_IMPLEMENTED;
 }
 
-TcsResult tcs_address_resolve_timeout(const char* hostname,
-                                      TcsAddressFamily address_family,
-                                      struct TcsAddress addresses[],
-                                      size_t capacity,
-                                      size_t* out_count,
-                                      int timeout_ms)
+TcsResult tcs_packet_capture_ifname(TcsSocket* socket_ctx, const char* interface_name)
 {
     return TCS_ERROR_NOT_IMPLEMENTED;
 }
 
-TcsResult tcs_address_list(unsigned int interface_id_filter,
-                           TcsAddressFamily address_family_filter,
-                           struct TcsInterfaceAddress interface_addresses[],
-                           size_t capacity,
-                           size_t* out_count)
+// ######## Socket Operations ########
+
+// tcs_bind() is defined in OS specific files
+// tcs_connect() is defined in OS specific files
+
+TcsResult tcs_connect_str(TcsSocket socket_ctx, const char* remote_address, uint16_t port)
 {
-    return TCS_ERROR_NOT_IMPLEMENTED;
-    /*
-    if (found_interfaces == NULL && no_of_found_interfaces == NULL)
+    if (socket_ctx == TCS_SOCKET_INVALID)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    if (found_interfaces == NULL && found_interfaces_length != 0)
+    if (remote_address == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    if (no_of_found_interfaces != NULL)
-        *no_of_found_interfaces = 0;
+    TcsAddressFamily socket_family = TCS_AF_ANY;
+    TcsResult res = tcs_address_socket_family(socket_ctx, &socket_family);
+    if (res != TCS_SUCCESS)
+        return res;
 
-    const int MAX_TRIES = 3;
-    ULONG adapeters_buffer_size = 15000;
-    PIP_ADAPTER_ADDRESSES adapters = NULL;
-    ULONG adapter_sts = ERROR_NO_DATA;
-    for (int i = 0; i < MAX_TRIES; ++i)
-    {
-        adapters = (PIP_ADAPTER_ADDRESSES)malloc(adapeters_buffer_size);
-        adapter_sts = GetAdaptersAddresses(AF_UNSPEC, 0, NULL, adapters, &adapeters_buffer_size);
-        if (adapter_sts == ERROR_BUFFER_OVERFLOW)
-        {
-            free(adapters);
-            adapters = NULL;
-        }
-        else
-        {
-            break;
-        }
-    }
-    if (adapter_sts != NO_ERROR)
-    {
-        if (adapters != NULL)
-            free(adapters);
-        return TCS_ERROR_UNKNOWN;
-    }
+    if (socket_family != TCS_AF_IP4 && socket_family != TCS_AF_IP6)
+        return TCS_ERROR_NOT_IMPLEMENTED;
 
-    size_t i = 0;
-    for (PIP_ADAPTER_ADDRESSES iter = adapters;
-         iter != NULL && (found_interfaces == NULL || i < found_interfaces_length);
-         iter = iter->Next)
-    {
-        if (iter->OperStatus != IfOperStatusUp)
-            continue;
-        for (PIP_ADAPTER_UNICAST_ADDRESS address_iter = iter->FirstUnicastAddress; address_iter != NULL;
-             address_iter = address_iter->Next)
-        {
-            struct TcsAddress t;
-            if (native2sockaddr(address_iter->Address.lpSockaddr, &t) != TCS_SUCCESS)
-                continue;
-            if (found_interfaces != NULL)
-            {
-                found_interfaces[i].address = t;
-                memset(found_interfaces[i].name, '\0', 32);
-                WideCharToMultiByte(CP_UTF8, 0, iter->FriendlyName, -1, found_interfaces[i].name, 31, NULL, NULL);
-            }
-            ++i;
-        }
-    }
-    if (adapters != NULL)
-        free(adapters);
-    if (no_of_found_interfaces != NULL)
-        *no_of_found_interfaces = i;
+    struct TcsAddress found_addresses;
+    size_t no_of_found_addresses = 0;
 
-    return TCS_SUCCESS;
-    */
-}
+    res = tcs_address_resolve(remote_address, socket_family, &found_addresses, 1, &no_of_found_addresses);
+    if (res != TCS_SUCCESS)
+        return res;
 
-TcsResult tcs_address_socket_local(TcsSocket socket_ctx, struct TcsAddress* local_address)
-{
-    return TCS_ERROR_NOT_IMPLEMENTED;
-}
+    if (no_of_found_addresses == 0)
+        return TCS_ERROR_ADDRESS_LOOKUP_FAILED;
 
-TcsResult tcs_address_socket_remote(TcsSocket socket_ctx, struct TcsAddress* remote_address)
-{
-    return TCS_ERROR_NOT_IMPLEMENTED;
+    switch (socket_family)
+    {
+        case TCS_AF_IP4:
+            if (found_addresses.data.ip4.port == 0)
+                found_addresses.data.ip4.port = port;
+            else if (port != 0)
+                return TCS_ERROR_INVALID_ARGUMENT;
+            break;
+        case TCS_AF_IP6:
+            if (found_addresses.data.ip6.port == 0)
+                found_addresses.data.ip6.port = port;
+            else if (port != 0)
+                return TCS_ERROR_INVALID_ARGUMENT;
+            break;
+        case TCS_AF_ANY:
+            break;
+        default:
+            return TCS_ERROR_INVALID_ARGUMENT;
+    }
+    return tcs_connect(socket_ctx, &found_addresses);
 }
 
-TcsResult tcs_address_socket_family(TcsSocket socket_ctx, TcsAddressFamily* out_family)
-{
-    return TCS_ERROR_NOT_IMPLEMENTED;
-}
+// tcs_listen() is defined in OS specific files
+// tcs_accept() is defined in OS specific files
+// tcs_shutdown() is defined in OS specific files
 
-// tcs_address_parse() is defined in tinycsocket_common.c
-// tcs_address_to_str() is defined in tinycsocket_common.c
-// tcs_address_is_equal() is defined in tinycsocket_common.c
-// tcs_address_is_any() is defined in tinycsocket_common.c
-// tcs_address_is_local() is defined in tinycsocket_common.c
-// tcs_address_is_loopback() is defined in tinycsocket_common.c
-// tcs_address_is_multicast() is defined in tinycsocket_common.c
-// tcs_address_is_broadcast() is defined in tinycsocket_common.c
+// ######## Data Transfer ########
 
-#endif
+// tcs_send() is defined in OS specific files
+// tcs_send_to() is defined in OS specific files
+// tcs_sendv() is defined in OS specific files
 
-/**********************************/
-/****** tinycsocket_common.h ******/
-/**********************************/
-/*
- * Copyright 2018 Markus Lindelöw
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files(the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
- * SOFTWARE.
- */
-#ifndef TINYCSOCKET_INTERNAL_H_
-#include "tinycsocket_internal.h"
-#endif
+TcsResult tcs_send_netstring(TcsSocket socket_ctx, const uint8_t* buffer, size_t buffer_length)
+{
+    if (socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-// This file should never call OS dependent code. Do not include OS files of OS specific ifdefs
+    if (buffer == NULL || buffer_length == 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-#ifdef DO_WRAP
-#include "dbg_wrap.h"
+#if SIZE_MAX > 0xffffffffffffffffULL
+    // buffer_length bigger than 64 bits? (size_t can be bigger on some systems)
+    if (buffer_length > 0xffffffffffffffffULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
 #endif
 
-#include <stdbool.h>
-#include <stdio.h>  //sprintf
-#include <string.h> // memset
-
-// ######## Library Management ########
+    int header_length = 0;
+    char netstring_header[21];
+    memset(netstring_header, 0, sizeof netstring_header);
 
-// tcs_lib_init() is defined in OS specific files
-// tcs_lib_free() is defined in OS specific files
+    // %zu is not supported by all compilers, therefor we cast it to llu
+    header_length = snprintf(netstring_header, 21, "%llu:", (unsigned long long)buffer_length);
 
-// ######## Socket Creation ########
+    if (header_length < 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-// tcs_socket() is defined in OS specific files
+    TcsResult sts = TCS_SUCCESS;
+    sts = tcs_send(socket_ctx, (uint8_t*)netstring_header, (size_t)header_length, TCS_MSG_SENDALL, NULL);
+    if (sts != TCS_SUCCESS)
+        return sts;
 
-TcsResult tcs_socket_preset(TcsSocket* socket_ctx, TcsPreset socket_type)
-{
-    if (socket_ctx == NULL || *socket_ctx != TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
+    sts = tcs_send(socket_ctx, buffer, buffer_length, TCS_MSG_SENDALL, NULL);
+    if (sts != TCS_SUCCESS)
+        return sts;
 
-    TcsAddressFamily family = TCS_AF_ANY;
-    int type = 0;
-    int protocol = 0;
+    sts = tcs_send(socket_ctx, (const uint8_t*)",", 1, TCS_MSG_SENDALL, NULL);
+    if (sts != TCS_SUCCESS)
+        return sts;
 
-    switch (socket_type)
-    {
-        case TCS_PRESET_TCP_IP4:
-            family = TCS_AF_IP4;
-            type = TCS_SOCK_STREAM;
-            protocol = TCS_PROTOCOL_IP_TCP;
-            break;
-        case TCS_PRESET_UDP_IP4:
-            family = TCS_AF_IP4;
-            type = TCS_SOCK_DGRAM;
-            protocol = TCS_PROTOCOL_IP_UDP;
-            break;
-        case TCS_PRESET_PACKET:
-            family = TCS_AF_PACKET;
-            type = TCS_SOCK_RAW;
-            protocol = 0; // Block all traffic, unblock with tcs_bind_addr()
-            break;
-        case TCS_PRESET_TCP_IP6:
-            family = TCS_AF_IP6;
-            type = TCS_SOCK_STREAM;
-            protocol = TCS_PROTOCOL_IP_TCP;
-            break;
-        case TCS_PRESET_UDP_IP6:
-            family = TCS_AF_IP6;
-            type = TCS_SOCK_DGRAM;
-            protocol = TCS_PROTOCOL_IP_UDP;
-            break;
-        default:
-            return TCS_ERROR_NOT_IMPLEMENTED;
-            break;
-    }
-    return tcs_socket(socket_ctx, family, type, protocol);
+    return TCS_SUCCESS;
 }
 
-// tcs_close() is defined in OS specific files
-
-// ######## High-level Socket Creation ########
+// tcs_receive() is defined in OS specific files
+// tcs_receive_from() is defined in OS specific files
+// tcs_send_to_batch() is defined in OS specific files
+// tcs_receive_from_batch() is defined in OS specific files
+// tcs_sendfile() is defined in OS specific files
+// tcs_splice_create() is defined in OS specific files
+// tcs_splice_destroy() is defined in OS specific files
+// tcs_splice() is defined in OS specific files
+// tcs_send_zerocopy() is defined in OS specific files
+// tcs_zerocopy_completions() is defined in OS specific files
 
-TcsResult tcs_tcp_server(TcsSocket* socket_ctx, const struct TcsAddress* local_address)
+TcsResult tcs_receive_line(TcsSocket socket_ctx,
+                           uint8_t* buffer,
+                           size_t buffer_length,
+                           size_t* bytes_received,
+                           uint8_t delimiter)
 {
-    if (socket_ctx == NULL || *socket_ctx != TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
-    if (local_address == NULL)
+    if (socket_ctx == TCS_SOCKET_INVALID || buffer == NULL || buffer_length <= 0)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    TcsResult res = tcs_socket(socket_ctx, local_address->family, TCS_SOCK_STREAM, TCS_PROTOCOL_IP_TCP);
-    if (res != TCS_SUCCESS)
-        return res;
-    res = tcs_opt_reuse_address_set(*socket_ctx, true);
-    if (res != TCS_SUCCESS)
-		return res;
-		
-    res = tcs_bind(*socket_ctx, local_address);
-    if (res != TCS_SUCCESS)
-    {
-        tcs_close(socket_ctx);
-        return res;
-    }
-    res = tcs_listen(*socket_ctx, TCS_BACKLOG_MAX);
-    if (res != TCS_SUCCESS)
+    /*
+    *                    data in kernel buffer
+    *   |12345yyyyyyyyyyyyyyyyyyyyyyyy..............|
+    *
+    *       buffer_length ----------------------------------.
+    *       searched ----------------------.                |
+    *                                      |                |
+    *       bytes_peeked ------------------.                |
+    *       bytes_read ---------------.    |                |
+    *                                 v    v                v
+    *       data in arg buffer
+    *   |xxxxxxxxxxxxxxxxxxxxxxxxxxxxxx12345................|
+    */
+    size_t bytes_read = 0;
+    size_t bytes_peeked = 0;
+    size_t bytes_searched = 0;
+    while (bytes_read < buffer_length)
     {
-        tcs_close(socket_ctx);
-        return res;
+        TcsResult sts = TCS_SUCCESS;
+        size_t bytes_free_in_buffer = buffer_length - bytes_read;
+        size_t current_peeked = 0;
+        sts = tcs_receive(socket_ctx, buffer + bytes_read, bytes_free_in_buffer, TCS_MSG_PEEK, &current_peeked);
+        if (sts != TCS_SUCCESS)
+        {
+            if (bytes_received != NULL)
+                *bytes_received = bytes_read;
+            return sts;
+        }
+        bytes_peeked += current_peeked;
+
+        if (current_peeked == 0)
+        {
+            // Make sure we block so we do not fast loop previous PEEK.
+            // Can not assume that peek with waitall is not crossplatform, needs to read
+            size_t current_read = 0;
+            sts = tcs_receive(socket_ctx, buffer + bytes_read, 1, TCS_MSG_WAITALL, &current_read);
+            bytes_read += current_read;
+            bytes_peeked += current_read;
+
+            if (sts != TCS_SUCCESS)
+            {
+                if (bytes_received != NULL)
+                    *bytes_received = bytes_read;
+                return sts;
+            }
+        }
+
+        bool found_delimiter = false;
+
+        while (bytes_searched < bytes_peeked)
+        {
+            if (buffer[bytes_searched++] == delimiter)
+            {
+                found_delimiter = true;
+                break;
+            }
+        }
+
+        // byte_searched == bytes_peeked if no delimiter was found
+        // after this block, bytes_read will also has the same value as they have
+        if (bytes_searched > bytes_read)
+        {
+            size_t bytes = 0;
+            size_t bytes_to_read_to_catch_up = bytes_searched - bytes_read;
+            sts = tcs_receive(socket_ctx, buffer + bytes_read, bytes_to_read_to_catch_up, TCS_MSG_WAITALL, &bytes);
+            bytes_read += bytes;
+            if (sts != TCS_SUCCESS)
+            {
+                if (bytes_received != NULL)
+                    *bytes_received = bytes_read;
+                return sts;
+            }
+        }
+        if (found_delimiter)
+        {
+            if (bytes_received != NULL)
+                *bytes_received = bytes_read;
+            return sts;
+        }
     }
-    return TCS_SUCCESS;
+    if (bytes_received != NULL)
+        *bytes_received = bytes_read;
+    return TCS_AGAIN;
 }
 
-TcsResult tcs_tcp_server_str(TcsSocket* socket_ctx, const char* local_address, uint16_t port)
+TcsResult tcs_receive_netstring(TcsSocket socket_ctx, uint8_t* buffer, size_t buffer_length, size_t* bytes_received)
 {
-    if (socket_ctx == NULL || *socket_ctx != TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
-    if (local_address == NULL)
+    if (socket_ctx == TCS_SOCKET_INVALID || buffer == NULL || buffer_length <= 0)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    struct TcsAddress bind_address = TCS_ADDRESS_NONE;
-    TcsResult res = tcs_address_parse(local_address, &bind_address);
-    if (res != TCS_SUCCESS)
-        return res;
-
-    if (bind_address.family != TCS_AF_IP4 && bind_address.family != TCS_AF_IP6)
-        return TCS_ERROR_INVALID_ARGUMENT;
-    uint16_t* parsed_port = NULL;
-    if (bind_address.family == TCS_AF_IP4)
-    {
-        parsed_port = &bind_address.data.ip4.port;
-    }
-    else if (bind_address.family == TCS_AF_IP6)
-    {
-        parsed_port = &bind_address.data.ip6.port;
-    }
-    else
+    size_t expected_length = 0;
+    int parsed = 0;
+    TcsResult sts = TCS_SUCCESS;
+    char t = '\0';
+    const int max_header = 21;
+    while (t != ':' && parsed < max_header)
     {
-        return TCS_ERROR_UNKNOWN;
+        sts = tcs_receive(socket_ctx, (uint8_t*)&t, 1, TCS_MSG_WAITALL, NULL);
+        if (sts != TCS_SUCCESS)
+            return sts;
+
+        parsed += 1;
+
+        bool is_num = t >= '0' && t <= '9';
+        bool is_end = t == ':';
+        if (!is_num && !is_end)
+            return TCS_ERROR_ILL_FORMED_MESSAGE;
+
+        if (is_end)
+            break;
+
+        expected_length = expected_length * 10 + (size_t)(t - '0');
     }
 
-    if (port == 0 && *parsed_port == 0)
-        return TCS_ERROR_INVALID_ARGUMENT; // No port specified
-    if (port != 0 && *parsed_port != 0)
-        return TCS_ERROR_INVALID_ARGUMENT; // Port specified in both string and argument
+    if (parsed >= max_header)
+        return TCS_ERROR_ILL_FORMED_MESSAGE;
+
+    if (buffer_length < expected_length)
+        return TCS_ERROR_MEMORY;
+
+    sts = tcs_receive(socket_ctx, buffer, expected_length, TCS_MSG_WAITALL, NULL);
+    if (sts != TCS_SUCCESS)
+        return sts;
+
+    sts = tcs_receive(socket_ctx, (uint8_t*)&t, 1, TCS_MSG_WAITALL, NULL);
+    if (sts != TCS_SUCCESS)
+        return sts;
+
+    if (t != ',')
+        return TCS_ERROR_ILL_FORMED_MESSAGE;
 
-    if (port != 0 && *parsed_port == 0)
-        *parsed_port = port;
+    if (bytes_received != NULL)
+        *bytes_received = expected_length;
 
-    return tcs_tcp_server(socket_ctx, &bind_address);
+    return TCS_SUCCESS;
 }
 
-TcsResult tcs_tcp_client(TcsSocket* socket_ctx, const struct TcsAddress* remote_address, int timeout_ms)
-{
-    if (socket_ctx == NULL || *socket_ctx != TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
-    if (timeout_ms < 0)
-        return TCS_ERROR_INVALID_ARGUMENT;
-    if (remote_address == NULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
-    if (remote_address->family != TCS_AF_IP4 && remote_address->family != TCS_AF_IP6)
-        return TCS_ERROR_NOT_IMPLEMENTED;
-    if (remote_address->family == TCS_AF_IP4 && remote_address->data.ip4.port == 0)
-        return TCS_ERROR_INVALID_ARGUMENT;
-    if (remote_address->family == TCS_AF_IP6 && remote_address->data.ip6.port == 0)
-        return TCS_ERROR_INVALID_ARGUMENT;
-
-    TcsResult res = tcs_socket(socket_ctx, remote_address->family, TCS_SOCK_STREAM, TCS_PROTOCOL_IP_TCP);
-    if (res != TCS_SUCCESS)
-        return res;
+// ######## Buffered Reading ########
 
-    struct TcsPool* timeout_pool = NULL;
-    res = tcs_pool_create(&timeout_pool);
-    if (res != TCS_SUCCESS)
-    {
-        tcs_close(socket_ctx);
-        return res;
-    }
+// The unread bytes are always kept in one piece, [start, end), so frames can be viewed in place.
+// Instead of wrapping around, the unread bytes are moved to the front when more room is needed,
+// this is usually only a partial frame.
+struct TcsReader
+{
+    TcsSocket socket;
+    uint8_t* buffer;
+    size_t capacity;
+    size_t start;
+    size_t end;
+};
 
-    res = tcs_opt_nonblocking_set(*socket_ctx, true);
-    if (res != TCS_SUCCESS)
+// One large receive into the free space, blocks until at least one byte has arrived
+static TcsResult reader_fill(struct TcsReader* reader)
+{
+    if (reader->start > 0)
     {
-        tcs_pool_destroy(&timeout_pool);
-        tcs_close(socket_ctx);
-        return res;
+        memmove(reader->buffer, reader->buffer + reader->start, reader->end - reader->start);
+        reader->end -= reader->start;
+        reader->start = 0;
     }
-    res = tcs_connect(*socket_ctx, remote_address);
-    // // TODO: kolla vad tcs_connect returnerar i icke-blockande läge
-
-    // tcs_pool_add(timeout_pool, *socket_ctx, NULL, true, true, true);
+    if (reader->end == reader->capacity)
+        return TCS_ERROR_MEMORY;
 
-    // struct TcsPollEvent event;
-    // size_t events_populated = 0;
-    // tcs_pool_poll(timeout_pool, &event, 1, &events_populated, timeout_ms);
-    // if (events_populated == 0)
-    //     res = TCS_ERROR_TIMED_OUT;
-    // else if ((event.events & TCS_POLLERR) != 0)
-    //     res = TCS_ERROR_CONNECTION_REFUSED;
-    // else if ((event.events & TCS_POLLHUP) != 0)
-    //     res = TCS_ERROR_CONNECTION_REFUSED;
-    // else if ((event.events & TCS_POLLOUT) != 0)
-    //     res = TCS_SUCCESS;
-    // else
-    //     res = TCS_ERROR_UNKNOWN;
-    return TCS_ERROR_UNKNOWN;
+    size_t received = 0;
+    TcsResult sts = tcs_receive(
+        reader->socket, reader->buffer + reader->end, reader->capacity - reader->end, TCS_FLAG_NONE, &received);
+    if (sts != TCS_SUCCESS)
+        return sts;
+    reader->end += received;
+    return TCS_SUCCESS;
 }
 
-TcsResult tcs_tcp_client_str(TcsSocket* socket_ctx, const char* remote_address, uint16_t port, int timeout_ms)
+// Parses the netstring header at the start of the unread data
+// TCS_AGAIN means the header is not complete yet
+static TcsResult reader_netstring_header(const struct TcsReader* reader, size_t* header_length, size_t* data_length)
 {
-    return TCS_ERROR_NOT_IMPLEMENTED;
+    const int max_header = 21;
+    size_t available = reader->end - reader->start;
+    const uint8_t* data = reader->buffer + reader->start;
+    size_t length = 0;
+    for (size_t i = 0; i < available; ++i)
+    {
+        if (data[i] == ':')
+        {
+            if (i == 0)
+                return TCS_ERROR_ILL_FORMED_MESSAGE;
+            *header_length = i + 1;
+            *data_length = length;
+            return TCS_SUCCESS;
+        }
+        if (data[i] < '0' || data[i] > '9' || (int)i + 1 >= max_header || length > (SIZE_MAX - 9) / 10)
+            return TCS_ERROR_ILL_FORMED_MESSAGE;
+        length = length * 10 + (size_t)(data[i] - '0');
+    }
+    return TCS_AGAIN;
 }
 
-TcsResult tcs_udp_receiver(TcsSocket* socket_ctx, const struct TcsAddress* local_address)
+TcsResult tcs_reader_create(struct TcsReader** reader, TcsSocket socket_ctx, size_t buffer_size)
 {
-    return TCS_ERROR_NOT_IMPLEMENTED;
-}
+    if (reader == NULL || *reader != NULL || socket_ctx == TCS_SOCKET_INVALID)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-TcsResult tcs_udp_receiver_str(TcsSocket* socket_ctx, const char* local_address, uint16_t port)
-{
-    return TCS_ERROR_NOT_IMPLEMENTED;
-}
+    if (buffer_size == 0)
+        buffer_size = TCS_READER_DEFAULT_SIZE;
 
-TcsResult tcs_udp_sender(TcsSocket* socket_ctx, const struct TcsAddress* remote_address)
-{
-    return TCS_ERROR_NOT_IMPLEMENTED;
+    *reader = (struct TcsReader*)malloc(sizeof(struct TcsReader));
+    if (*reader == NULL)
+        return TCS_ERROR_MEMORY;
+    (*reader)->buffer = (uint8_t*)malloc(buffer_size);
+    if ((*reader)->buffer == NULL)
+    {
+        free(*reader);
+        *reader = NULL;
+        return TCS_ERROR_MEMORY;
+    }
+    (*reader)->socket = socket_ctx;
+    (*reader)->capacity = buffer_size;
+    (*reader)->start = 0;
+    (*reader)->end = 0;
+    return TCS_SUCCESS;
 }
 
-TcsResult tcs_udp_sender_str(TcsSocket* socket_ctx, const char* remote_address, uint16_t port)
+TcsResult tcs_reader_destroy(struct TcsReader** reader)
 {
-    return TCS_ERROR_NOT_IMPLEMENTED;
+    if (reader == NULL || *reader == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    free((*reader)->buffer);
+    free(*reader);
+    *reader = NULL;
+    return TCS_SUCCESS;
 }
 
-TcsResult tcs_udp_peer(TcsSocket* socket_ctx,
-                       const struct TcsAddress* local_address,
-                       const struct TcsAddress* remote_address)
+size_t tcs_reader_buffered(const struct TcsReader* reader)
 {
-    return TCS_ERROR_NOT_IMPLEMENTED;
+    if (reader == NULL)
+        return 0;
+    return reader->end - reader->start;
 }
 
-TcsResult tcs_udp_peer_str(TcsSocket* socket_ctx,
-                           const char* local_address,
-                           uint16_t local_port,
-                           const char* remote_address,
-                           uint16_t remote_port)
+TcsResult tcs_reader_receive_line(struct TcsReader* reader,
+                                  uint8_t* buffer,
+                                  size_t buffer_size,
+                                  size_t* bytes_received,
+                                  uint8_t delimiter)
 {
-    return TCS_ERROR_NOT_IMPLEMENTED;
-}
+    if (bytes_received != NULL)
+        *bytes_received = 0;
+    if (reader == NULL || buffer == NULL || buffer_size == 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-// ######## High-level Raw L2-Packet Sockets (Experimental) ########
+    // Lines longer than the reader buffer are copied out piece by piece
+    size_t copied = 0;
+    while (true)
+    {
+        size_t available = reader->end - reader->start;
+        const uint8_t* data = reader->buffer + reader->start;
+        const uint8_t* found = available > 0 ? (const uint8_t*)memchr(data, delimiter, available) : NULL;
+        size_t length = found != NULL ? (size_t)(found - data) + 1 : available;
+        size_t room = buffer_size - copied;
+        size_t to_copy = length < room ? length : room;
 
-TcsResult tcs_packet_sender_str(TcsSocket* socket_ctx,
-                                const char* interface_name,
-                                const uint8_t destination_mac[6],
-                                uint16_t protocol)
-{
-    return TCS_ERROR_NOT_IMPLEMENTED;
-}
+        memcpy(buffer + copied, data, to_copy);
+        reader->start += to_copy;
+        copied += to_copy;
+        if (bytes_received != NULL)
+            *bytes_received = copied;
 
-TcsResult tcs_packet_sender(TcsSocket* socket_ctx, const struct TcsAddress* remote_address)
-{
-    return TCS_ERROR_NOT_IMPLEMENTED;
+        if (found != NULL && to_copy == length)
+            return TCS_SUCCESS;
+        if (copied == buffer_size)
+            return TCS_AGAIN;
+
+        TcsResult sts = reader_fill(reader);
+        if (sts != TCS_SUCCESS)
+            return sts;
+    }
 }
 
-TcsResult tcs_packet_peer_str(TcsSocket* socket_ctx,
-                              const char* interface_name,
-                              const uint8_t destination_mac[6],
-                              uint16_t protocol)
+TcsResult tcs_reader_receive_netstring(struct TcsReader* reader,
+                                       uint8_t* buffer,
+                                       size_t buffer_size,
+                                       size_t* bytes_received)
 {
-    return TCS_ERROR_NOT_IMPLEMENTED;
+    if (bytes_received != NULL)
+        *bytes_received = 0;
+    if (reader == NULL || buffer == NULL || buffer_size == 0)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    size_t header_length = 0;
+    size_t data_length = 0;
+    TcsResult sts = TCS_AGAIN;
+    while ((sts = reader_netstring_header(reader, &header_length, &data_length)) == TCS_AGAIN)
+    {
+        sts = reader_fill(reader);
+        if (sts != TCS_SUCCESS)
+            return sts;
+    }
+    if (sts != TCS_SUCCESS)
+        return sts;
+    if (buffer_size < data_length)
+        return TCS_ERROR_MEMORY;
+
+    reader->start += header_length;
+    sts = tcs_reader_receive_exact(reader, buffer, data_length);
+    if (sts != TCS_SUCCESS)
+        return sts;
+
+    uint8_t t = '\0';
+    sts = tcs_reader_receive_exact(reader, &t, 1);
+    if (sts != TCS_SUCCESS)
+        return sts;
+    if (t != ',')
+        return TCS_ERROR_ILL_FORMED_MESSAGE;
+
+    if (bytes_received != NULL)
+        *bytes_received = data_length;
+    return TCS_SUCCESS;
 }
 
-TcsResult tcs_packet_peer(TcsSocket* socket_ctx,
-                          const struct TcsAddress* local_address,
-                          const struct TcsAddress* remote_address)
+TcsResult tcs_reader_receive_exact(struct TcsReader* reader, uint8_t* buffer, size_t length)
 {
-    return TCS_ERROR_NOT_IMPLEMENTED;
+    if (reader == NULL || (buffer == NULL && length > 0))
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (length == 0)
+        return TCS_SUCCESS;
+
+    size_t copied = 0;
+    while (true)
+    {
+        size_t available = reader->end - reader->start;
+        size_t to_copy = length - copied < available ? length - copied : available;
+        memcpy(buffer + copied, reader->buffer + reader->start, to_copy);
+        reader->start += to_copy;
+        copied += to_copy;
+        if (copied == length)
+            return TCS_SUCCESS;
+
+        // Big frames skip the reader buffer
+        if (length - copied >= reader->capacity)
+        {
+            size_t received = 0;
+            TcsResult sts = tcs_receive(reader->socket, buffer + copied, length - copied, TCS_MSG_WAITALL, &received);
+            copied += received;
+            if (sts != TCS_SUCCESS)
+                return sts;
+            if (copied == length)
+                return TCS_SUCCESS;
+            continue;
+        }
+
+        TcsResult sts = reader_fill(reader);
+        if (sts != TCS_SUCCESS)
+            return sts;
+    }
 }
 
-TcsResult tcs_packet_capture_iface(TcsSocket* socket_ctx, const struct TcsInterface* iface)
+TcsResult tcs_reader_peek(struct TcsReader* reader, size_t length, const uint8_t** data)
 {
-    return TCS_ERROR_NOT_IMPLEMENTED;
+    if (reader == NULL || data == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (length > reader->capacity)
+        return TCS_ERROR_MEMORY;
+
+    while (reader->end - reader->start < length)
+    {
+        TcsResult sts = reader_fill(reader);
+        if (sts != TCS_SUCCESS)
+            return sts;
+    }
+    *data = reader->buffer + reader->start;
+    return TCS_SUCCESS;
 }
 
-TcsResult tcs_packet_capture_ifname(TcsSocket* socket_ctx, const char* interface_name)
+TcsResult tcs_reader_peek_line(struct TcsReader* reader, const uint8_t** line, size_t* line_size, uint8_t delimiter)
 {
-    return TCS_ERROR_NOT_IMPLEMENTED;
-}
+    if (reader == NULL || line == NULL || line_size == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-// ######## Socket Operations ########
+    size_t searched = 0;
+    while (true)
+    {
+        size_t available = reader->end - reader->start;
+        const uint8_t* data = reader->buffer + reader->start;
+        const uint8_t* found =
+            available > searched ? (const uint8_t*)memchr(data + searched, delimiter, available - searched) : NULL;
+        if (found != NULL)
+        {
+            *line = data;
+            *line_size = (size_t)(found - data) + 1;
+            return TCS_SUCCESS;
+        }
+        searched = available;
 
-// tcs_bind() is defined in OS specific files
-// tcs_connect() is defined in OS specific files
+        TcsResult sts = reader_fill(reader);
+        if (sts != TCS_SUCCESS)
+            return sts;
+    }
+}
 
-TcsResult tcs_connect_str(TcsSocket socket_ctx, const char* remote_address, uint16_t port)
+TcsResult tcs_reader_peek_netstring(struct TcsReader* reader,
+                                    const uint8_t** data,
+                                    size_t* data_size,
+                                    size_t* frame_size)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
-
-    if (remote_address == NULL)
+    if (reader == NULL || data == NULL || data_size == NULL || frame_size == NULL)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    TcsAddressFamily socket_family = TCS_AF_ANY;
-    TcsResult res = tcs_address_socket_family(socket_ctx, &socket_family);
-    if (res != TCS_SUCCESS)
-        return res;
-
-    if (socket_family != TCS_AF_IP4 && socket_family != TCS_AF_IP6)
-        return TCS_ERROR_NOT_IMPLEMENTED;
+    size_t header_length = 0;
+    size_t data_length = 0;
+    TcsResult sts = TCS_AGAIN;
+    while ((sts = reader_netstring_header(reader, &header_length, &data_length)) == TCS_AGAIN)
+    {
+        sts = reader_fill(reader);
+        if (sts != TCS_SUCCESS)
+            return sts;
+    }
+    if (sts != TCS_SUCCESS)
+        return sts;
 
-    struct TcsAddress found_addresses;
-    size_t no_of_found_addresses = 0;
+    if (data_length > reader->capacity - header_length - 1)
+        return TCS_ERROR_MEMORY;
+    const uint8_t* frame = NULL;
+    sts = tcs_reader_peek(reader, header_length + data_length + 1, &frame);
+    if (sts != TCS_SUCCESS)
+        return sts;
+    if (frame[header_length + data_length] != ',')
+        return TCS_ERROR_ILL_FORMED_MESSAGE;
 
-    res = tcs_address_resolve(remote_address, socket_family, &found_addresses, 1, &no_of_found_addresses);
-    if (res != TCS_SUCCESS)
-        return res;
+    *data = frame + header_length;
+    *data_size = data_length;
+    *frame_size = header_length + data_length + 1;
+    return TCS_SUCCESS;
+}
 
-    if (no_of_found_addresses == 0)
-        return TCS_ERROR_ADDRESS_LOOKUP_FAILED;
+TcsResult tcs_reader_skip(struct TcsReader* reader, size_t length)
+{
+    if (reader == NULL || length > reader->end - reader->start)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-    switch (socket_family)
+    reader->start += length;
+    // Cheap reset so the next fill does not have to move anything
+    if (reader->start == reader->end)
     {
-        case TCS_AF_IP4:
-            if (found_addresses.data.ip4.port == 0)
-                found_addresses.data.ip4.port = port;
-            else if (port != 0)
-                return TCS_ERROR_INVALID_ARGUMENT;
-            break;
-        case TCS_AF_IP6:
-            if (found_addresses.data.ip6.port == 0)
-                found_addresses.data.ip6.port = port;
-            else if (port != 0)
-                return TCS_ERROR_INVALID_ARGUMENT;
-            break;
-        case TCS_AF_ANY:
-            break;
-        default:
-            return TCS_ERROR_INVALID_ARGUMENT;
+        reader->start = 0;
+        reader->end = 0;
     }
-    return tcs_connect(socket_ctx, &found_addresses);
+    return TCS_SUCCESS;
 }
 
-// tcs_listen() is defined in OS specific files
-// tcs_accept() is defined in OS specific files
-// tcs_shutdown() is defined in OS specific files
+// ######## Socket Pooling ########
+
+// tcs_pool_create() is defined in OS specific files
+// tcs_pool_create_backend() is defined in OS specific files
+// tcs_pool_destroy() is defined in OS specific files
+// tcs_pool_add() is defined in OS specific files
+// tcs_pool_remove() is defined in OS specific files
+// tcs_pool_poll() is defined in OS specific files
+
+// ######## Async I/O ########
+
+// tcs_ring_xxx() are defined in OS specific files
 
-// ######## Data Transfer ########
+// ######## Server Runtime ########
 
-// tcs_send() is defined in OS specific files
-// tcs_send_to() is defined in OS specific files
-// tcs_sendv() is defined in OS specific files
+#if TCS_AVAILABLE_THREADS
 
-TcsResult tcs_send_netstring(TcsSocket socket_ctx, const uint8_t* buffer, size_t buffer_length)
+#define TCS_SERVER_TICK_MS 100           // How often a worker looks at the server state
+#define TCS_SERVER_EVENTS 64             // Events handled per worker wakeup
+#define TCS_SERVER_ACCEPTS_PER_EVENT 64  // Limits how long one worker may accept during a connection storm
+
+enum
 {
-    if (socket_ctx == TCS_SOCKET_INVALID)
-        return TCS_ERROR_INVALID_ARGUMENT;
+    TCS_SERVER_STATE_CREATED,
+    TCS_SERVER_STATE_RUNNING,
+    TCS_SERVER_STATE_DRAINING,
+    TCS_SERVER_STATE_STOPPED,
+};
 
-    if (buffer == NULL || buffer_length == 0)
-        return TCS_ERROR_INVALID_ARGUMENT;
+struct TcsServerLink
+{
+    struct TcsServerConnection connection;
+    struct TcsServerLink* prev;
+    struct TcsServerLink* next;
+};
 
-#if SIZE_MAX > 0xffffffffffffffffULL
-    // buffer_length bigger than 64 bits? (size_t can be bigger on some systems)
-    if (buffer_length > 0xffffffffffffffffULL)
-        return TCS_ERROR_INVALID_ARGUMENT;
-#endif
+struct TcsServerWorker
+{
+    struct TcsServer* server;
+    unsigned int index;
+    TcsThread thread;
+    bool thread_started;
+    TcsSocket listener;
+    bool owns_listener; // false when all workers share one listener, SO_REUSEPORT is missing
+    bool is_listening;  // listener is in the pool
+    struct TcsPool* pool;
+    struct TcsServerLink* connections;
+    volatile long connection_count;
+};
 
-    int header_length = 0;
-    char netstring_header[21];
-    memset(netstring_header, 0, sizeof netstring_header);
+struct TcsServer
+{
+    struct TcsServerConfig config;
+    struct TcsServerCallbacks callbacks;
+    void* user_data;
+    struct TcsServerWorker* workers;
+    unsigned int worker_count;
+    struct TcsAddress address;
+    bool reuse_port; // Every worker has its own listener
+    volatile long state;
+    int64_t drain_deadline; // Written before state is set to draining, negative waits forever
+};
 
-    // %zu is not supported by all compilers, therefor we cast it to llu
-    header_length = snprintf(netstring_header, 21, "%llu:", (unsigned long long)buffer_length);
+static TcsResult server_listener_create(TcsSocket* listener, const struct TcsAddress* address, bool* reuse_port)
+{
+    TcsResult res = tcs_socket(listener, address->family, TCS_SOCK_STREAM, TCS_PROTOCOL_IP_TCP);
+    if (res != TCS_SUCCESS)
+        return res;
+    res = tcs_opt_reuse_address_set(*listener, true);
+    if (res == TCS_SUCCESS && *reuse_port)
+        *reuse_port = tcs_opt_reuse_port_set(*listener, true) == TCS_SUCCESS;
+    if (res == TCS_SUCCESS)
+        res = tcs_bind(*listener, address);
+    if (res == TCS_SUCCESS)
+        res = tcs_listen(*listener, TCS_BACKLOG_MAX);
+    // Several workers may wake up for the same connection, the losers must not block in accept
+    if (res == TCS_SUCCESS)
+        res = tcs_opt_nonblocking_set(*listener, true);
+    if (res != TCS_SUCCESS)
+        tcs_close(listener);
+    return res;
+}
 
-    if (header_length < 0)
-        return TCS_ERROR_INVALID_ARGUMENT;
+static void server_connection_close(struct TcsServerWorker* worker, struct TcsServerLink* link)
+{
+    struct TcsServer* server = worker->server;
+    if (server->callbacks.on_close != NULL)
+        server->callbacks.on_close(server, &link->connection);
 
-    TcsResult sts = TCS_SUCCESS;
-    sts = tcs_send(socket_ctx, (uint8_t*)netstring_header, (size_t)header_length, TCS_MSG_SENDALL, NULL);
-    if (sts != TCS_SUCCESS)
-        return sts;
+    tcs_pool_remove(worker->pool, link->connection.socket);
+    tcs_close(&link->connection.socket);
 
-    sts = tcs_send(socket_ctx, buffer, buffer_length, TCS_MSG_SENDALL, NULL);
-    if (sts != TCS_SUCCESS)
-        return sts;
+    if (link->prev != NULL)
+        link->prev->next = link->next;
+    else
+        worker->connections = link->next;
+    if (link->next != NULL)
+        link->next->prev = link->prev;
+    free(link);
+    atomic_store_long(&worker->connection_count, worker->connection_count - 1);
+}
 
-    sts = tcs_send(socket_ctx, (const uint8_t*)",", 1, TCS_MSG_SENDALL, NULL);
-    if (sts != TCS_SUCCESS)
-        return sts;
+static void server_accept(struct TcsServerWorker* worker)
+{
+    struct TcsServer* server = worker->server;
+    size_t max_connections = server->config.max_connections_per_worker;
+    for (int i = 0; i < TCS_SERVER_ACCEPTS_PER_EVENT; ++i)
+    {
+        if (max_connections > 0 && (size_t)worker->connection_count >= max_connections)
+            return;
 
-    return TCS_SUCCESS;
-}
+        TcsSocket client = TCS_SOCKET_INVALID;
+        struct TcsAddress address = TCS_ADDRESS_NONE;
+        if (tcs_accept(worker->listener, &client, &address) != TCS_SUCCESS)
+            return; // Backlog is empty or another worker got it
 
-// tcs_receive() is defined in OS specific files
-// tcs_receive_from() is defined in OS specific files
+        struct TcsServerLink* link = (struct TcsServerLink*)malloc(sizeof(struct TcsServerLink));
+        if (link == NULL)
+        {
+            tcs_close(&client);
+            return;
+        }
+        memset(link, 0, sizeof(struct TcsServerLink));
+        link->connection.socket = client;
+        link->connection.address = address;
+        link->connection.worker = worker->index;
 
-TcsResult tcs_receive_line(TcsSocket socket_ctx,
-                           uint8_t* buffer,
-                           size_t buffer_length,
-                           size_t* bytes_received,
-                           uint8_t delimiter)
+        if (tcs_pool_add(worker->pool, client, link, true, false, false) != TCS_SUCCESS)
+        {
+            tcs_close(&client);
+            free(link);
+            continue;
+        }
+        link->next = worker->connections;
+        if (worker->connections != NULL)
+            worker->connections->prev = link;
+        worker->connections = link;
+        atomic_store_long(&worker->connection_count, worker->connection_count + 1);
+
+        if (server->callbacks.on_connect != NULL && !server->callbacks.on_connect(server, &link->connection))
+            server_connection_close(worker, link);
+    }
+}
+
+static void server_worker_run(struct TcsServerWorker* worker)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID || buffer == NULL || buffer_length <= 0)
-        return TCS_ERROR_INVALID_ARGUMENT;
+    struct TcsServer* server = worker->server;
+    struct TcsPollEvent events[TCS_SERVER_EVENTS];
+    size_t max_connections = server->config.max_connections_per_worker;
 
-    /*
-    *                    data in kernel buffer
-    *   |12345yyyyyyyyyyyyyyyyyyyyyyyy..............|
-    *
-    *       buffer_length ----------------------------------.
-    *       searched ----------------------.                |
-    *                                      |                |
-    *       bytes_peeked ------------------.                |
-    *       bytes_read ---------------.    |                |
-    *                                 v    v                v
-    *       data in arg buffer
-    *   |xxxxxxxxxxxxxxxxxxxxxxxxxxxxxx12345................|
-    */
-    size_t bytes_read = 0;
-    size_t bytes_peeked = 0;
-    size_t bytes_searched = 0;
-    while (bytes_read < buffer_length)
+    while (true)
     {
-        TcsResult sts = TCS_SUCCESS;
-        size_t bytes_free_in_buffer = buffer_length - bytes_read;
-        size_t current_peeked = 0;
-        sts = tcs_receive(socket_ctx, buffer + bytes_read, bytes_free_in_buffer, TCS_MSG_PEEK, &current_peeked);
-        if (sts != TCS_SUCCESS)
+        long state = atomic_load_long(&server->state);
+        if (state != TCS_SERVER_STATE_RUNNING)
         {
-            if (bytes_received != NULL)
-                *bytes_received = bytes_read;
-            return sts;
+            if (worker->is_listening)
+            {
+                // Take what is already in the backlog before closing, those clients would get a reset otherwise
+                if (server->reuse_port)
+                    server_accept(worker);
+                tcs_pool_remove(worker->pool, worker->listener);
+                worker->is_listening = false;
+                // A shared listener is still in the pools of the other workers, it is closed in tcs_server_destroy()
+                if (server->reuse_port)
+                    tcs_close(&worker->listener);
+            }
+            bool deadline_passed = server->drain_deadline >= 0 && monotonic_ms() >= server->drain_deadline;
+            if (worker->connections == NULL || deadline_passed)
+                break;
         }
-        bytes_peeked += current_peeked;
-
-        if (current_peeked == 0)
+        else if (max_connections > 0)
         {
-            // Make sure we block so we do not fast loop previous PEEK.
-            // Can not assume that peek with waitall is not crossplatform, needs to read
-            size_t current_read = 0;
-            sts = tcs_receive(socket_ctx, buffer + bytes_read, 1, TCS_MSG_WAITALL, &current_read);
-            bytes_read += current_read;
-            bytes_peeked += current_read;
-
-            if (sts != TCS_SUCCESS)
+            // Backpressure, new connections wait in the listen backlog while the worker is full
+            bool is_full = (size_t)worker->connection_count >= max_connections;
+            if (is_full && worker->is_listening)
             {
-                if (bytes_received != NULL)
-                    *bytes_received = bytes_read;
-                return sts;
+                tcs_pool_remove(worker->pool, worker->listener);
+                worker->is_listening = false;
+            }
+            else if (!is_full && !worker->is_listening)
+            {
+                worker->is_listening =
+                    tcs_pool_add(worker->pool, worker->listener, worker, true, false, false) == TCS_SUCCESS;
             }
         }
 
-        bool found_delimiter = false;
+        size_t populated = 0;
+        TcsResult res = tcs_pool_poll(worker->pool, events, TCS_SERVER_EVENTS, &populated, TCS_SERVER_TICK_MS);
+        if (res != TCS_SUCCESS)
+            continue;
 
-        while (bytes_searched < bytes_peeked)
+        for (size_t i = 0; i < populated; ++i)
         {
-            if (buffer[bytes_searched++] == delimiter)
+            if (events[i].user_data == worker)
             {
-                found_delimiter = true;
-                break;
+                if (worker->is_listening)
+                    server_accept(worker);
+                continue;
             }
+            struct TcsServerLink* link = (struct TcsServerLink*)events[i].user_data;
+            if (!server->callbacks.on_readable(server, &link->connection))
+                server_connection_close(worker, link);
         }
+    }
 
-        // byte_searched == bytes_peeked if no delimiter was found
-        // after this block, bytes_read will also has the same value as they have
-        if (bytes_searched > bytes_read)
+    while (worker->connections != NULL)
+        server_connection_close(worker, worker->connections);
+}
+
+static TCS_THREAD_RESULT TCS_THREAD_CALL server_worker_thread(void* argument)
+{
+    server_worker_run((struct TcsServerWorker*)argument);
+    return 0;
+}
+
+TcsResult tcs_server_create(struct TcsServer** server,
+                            const struct TcsServerConfig* config,
+                            const struct TcsServerCallbacks* callbacks,
+                            void* user_data)
+{
+    if (server == NULL || *server != NULL || config == NULL || callbacks == NULL || callbacks->on_readable == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    if (config->address.family != TCS_AF_IP4 && config->address.family != TCS_AF_IP6)
+        return TCS_ERROR_INVALID_ARGUMENT;
+
+    *server = (struct TcsServer*)malloc(sizeof(struct TcsServer));
+    if (*server == NULL)
+        return TCS_ERROR_MEMORY;
+    memset(*server, 0, sizeof(struct TcsServer));
+    (*server)->config = *config;
+    (*server)->callbacks = *callbacks;
+    (*server)->user_data = user_data;
+    (*server)->address = config->address;
+    (*server)->state = TCS_SERVER_STATE_CREATED;
+    (*server)->worker_count = config->worker_count > 0 ? config->worker_count : cpu_count();
+
+    (*server)->workers = (struct TcsServerWorker*)calloc((*server)->worker_count, sizeof(struct TcsServerWorker));
+    if ((*server)->workers == NULL)
+    {
+        free(*server);
+        *server = NULL;
+        return TCS_ERROR_MEMORY;
+    }
+
+    TcsResult res = TCS_SUCCESS;
+    bool reuse_port = true;
+    for (unsigned int i = 0; i < (*server)->worker_count; ++i)
+    {
+        struct TcsServerWorker* worker = &(*server)->workers[i];
+        worker->server = *server;
+        worker->index = i;
+        worker->listener = TCS_SOCKET_INVALID;
+        if (res != TCS_SUCCESS)
+            continue;
+
+        res = tcs_pool_create(&worker->pool);
+        if (res != TCS_SUCCESS)
+            continue;
+
+        if (i == 0 || reuse_port)
         {
-            size_t bytes = 0;
-            size_t bytes_to_read_to_catch_up = bytes_searched - bytes_read;
-            sts = tcs_receive(socket_ctx, buffer + bytes_read, bytes_to_read_to_catch_up, TCS_MSG_WAITALL, &bytes);
-            bytes_read += bytes;
-            if (sts != TCS_SUCCESS)
-            {
-                if (bytes_received != NULL)
-                    *bytes_received = bytes_read;
-                return sts;
-            }
+            // Every worker gets its own listener on the same port, the kernel spreads new connections between them
+            res = server_listener_create(&worker->listener, &(*server)->address, &reuse_port);
+            worker->owns_listener = true;
+            // With port 0 the rest must bind to the port the first one got
+            if (res == TCS_SUCCESS && i == 0)
+                tcs_address_socket_local(worker->listener, &(*server)->address);
         }
-        if (found_delimiter)
+        else
         {
-            if (bytes_received != NULL)
-                *bytes_received = bytes_read;
-            return sts;
+            worker->listener = (*server)->workers[0].listener;
+            worker->owns_listener = false;
+        }
+        if (res == TCS_SUCCESS)
+        {
+            res = tcs_pool_add(worker->pool, worker->listener, worker, true, false, false);
+            worker->is_listening = res == TCS_SUCCESS;
         }
     }
-    if (bytes_received != NULL)
-        *bytes_received = bytes_read;
-    return TCS_AGAIN;
+
+    (*server)->reuse_port = reuse_port;
+
+    if (res != TCS_SUCCESS)
+        tcs_server_destroy(server);
+    return res;
 }
 
-TcsResult tcs_receive_netstring(TcsSocket socket_ctx, uint8_t* buffer, size_t buffer_length, size_t* bytes_received)
+TcsResult tcs_server_start(struct TcsServer* server)
 {
-    if (socket_ctx == TCS_SOCKET_INVALID || buffer == NULL || buffer_length <= 0)
+    if (server == NULL || atomic_load_long(&server->state) != TCS_SERVER_STATE_CREATED)
         return TCS_ERROR_INVALID_ARGUMENT;
 
-    size_t expected_length = 0;
-    int parsed = 0;
-    TcsResult sts = TCS_SUCCESS;
-    char t = '\0';
-    const int max_header = 21;
-    while (t != ':' && parsed < max_header)
+    atomic_store_long(&server->state, TCS_SERVER_STATE_RUNNING);
+    for (unsigned int i = 0; i < server->worker_count; ++i)
     {
-        sts = tcs_receive(socket_ctx, (uint8_t*)&t, 1, TCS_MSG_WAITALL, NULL);
-        if (sts != TCS_SUCCESS)
-            return sts;
+        struct TcsServerWorker* worker = &server->workers[i];
+        TcsResult res = thread_create(&worker->thread, server_worker_thread, worker);
+        if (res != TCS_SUCCESS)
+        {
+            tcs_server_stop(server, 0);
+            return res;
+        }
+        worker->thread_started = true;
+    }
+    return TCS_SUCCESS;
+}
 
-        parsed += 1;
+TcsResult tcs_server_stop(struct TcsServer* server, int64_t drain_timeout_ms)
+{
+    if (server == NULL || atomic_load_long(&server->state) != TCS_SERVER_STATE_RUNNING)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-        bool is_num = t >= '0' && t <= '9';
-        bool is_end = t == ':';
-        if (!is_num && !is_end)
-            return TCS_ERROR_ILL_FORMED_MESSAGE;
+    server->drain_deadline = drain_timeout_ms < 0 ? -1 : monotonic_ms() + drain_timeout_ms;
+    atomic_store_long(&server->state, TCS_SERVER_STATE_DRAINING);
+    for (unsigned int i = 0; i < server->worker_count; ++i)
+    {
+        struct TcsServerWorker* worker = &server->workers[i];
+        if (worker->thread_started)
+            thread_join(worker->thread);
+        worker->thread_started = false;
+    }
+    atomic_store_long(&server->state, TCS_SERVER_STATE_STOPPED);
+    return TCS_SUCCESS;
+}
 
-        if (is_end)
-            break;
+TcsResult tcs_server_destroy(struct TcsServer** server)
+{
+    if (server == NULL || *server == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
 
-        expected_length += (size_t)t - '0';
+    if (atomic_load_long(&(*server)->state) == TCS_SERVER_STATE_RUNNING)
+        tcs_server_stop(*server, 0);
+
+    for (unsigned int i = 0; i < (*server)->worker_count; ++i)
+    {
+        struct TcsServerWorker* worker = &(*server)->workers[i];
+        if (worker->owns_listener && worker->listener != TCS_SOCKET_INVALID)
+            tcs_close(&worker->listener);
+        if (worker->pool != NULL)
+            tcs_pool_destroy(&worker->pool);
     }
+    free((*server)->workers);
+    free(*server);
+    *server = NULL;
+    return TCS_SUCCESS;
+}
 
-    if (parsed >= max_header)
-        return TCS_ERROR_ILL_FORMED_MESSAGE;
+TcsResult tcs_server_address(const struct TcsServer* server, struct TcsAddress* local_address)
+{
+    if (server == NULL || local_address == NULL)
+        return TCS_ERROR_INVALID_ARGUMENT;
+    *local_address = server->address;
+    return TCS_SUCCESS;
+}
 
-    if (buffer_length < expected_length)
-        return TCS_ERROR_MEMORY;
+void* tcs_server_user_data(const struct TcsServer* server)
+{
+    if (server == NULL)
+        return NULL;
+    return server->user_data;
+}
 
-    sts = tcs_receive(socket_ctx, buffer, expected_length, TCS_MSG_WAITALL, NULL);
-    if (sts != TCS_SUCCESS)
-        return sts;
+size_t tcs_server_connection_count(const struct TcsServer* server)
+{
+    if (server == NULL)
+        return 0;
+    size_t count = 0;
+    for (unsigned int i = 0; i < server->worker_count; ++i)
+        count += (size_t)atomic_load_long(&server->workers[i].connection_count);
+    return count;
+}
+#else
+TcsResult tcs_server_create(struct TcsServer** server,
+                            const struct TcsServerConfig* config,
+                            const struct TcsServerCallbacks* callbacks,
+                            void* user_data)
+{
+    (void)server;
+    (void)config;
+    (void)callbacks;
+    (void)user_data;
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
 
-    sts = tcs_receive(socket_ctx, (uint8_t*)&t, 1, TCS_MSG_WAITALL, NULL);
-    if (sts != TCS_SUCCESS)
-        return sts;
+TcsResult tcs_server_start(struct TcsServer* server)
+{
+    (void)server;
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
 
-    if (t != ',')
-        return TCS_ERROR_ILL_FORMED_MESSAGE;
+TcsResult tcs_server_stop(struct TcsServer* server, int64_t drain_timeout_ms)
+{
+    (void)server;
+    (void)drain_timeout_ms;
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
 
-    if (bytes_received != NULL)
-        *bytes_received = expected_length;
+TcsResult tcs_server_destroy(struct TcsServer** server)
+{
+    (void)server;
+    return TCS_ERROR_NOT_IMPLEMENTED;
+}
 
-    return TCS_SUCCESS;
+TcsResult tcs_server_address(const struct TcsServer* server, struct TcsAddress* local_address)
+{
+    (void)server;
+    (void)local_address;
+    return TCS_ERROR_NOT_IMPLEMENTED;
 }
 
-// ######## Socket Pooling ########
+void* tcs_server_user_data(const struct TcsServer* server)
+{
+    (void)server;
+    return NULL;
+}
 
-// tcs_pool_create() is defined in OS specific files
-// tcs_pool_destroy() is defined in OS specific files
-// tcs_pool_add() is defined in OS specific files
-// tcs_pool_remove() is defined in OS specific files
-// tcs_pool_poll() is defined in OS specific files
+size_t tcs_server_connection_count(const struct TcsServer* server)
+{
+    (void)server;
+    return 0;
+}
+#endif
 
 // ######## Socket Options ########
 
@@ -5888,6 +9426,9 @@ TcsResult tcs_opt_priority_get(TcsSocket socket_ctx, int* priority)
 
 // tcs_opt_nonblocking_set() is defined in OS specific files
 // tcs_opt_nonblocking_get() is defined in OS specific files
+// tcs_opt_udp_gro_set() is defined in OS specific files
+// tcs_opt_zerocopy_set() is defined in OS specific files
+// tcs_opt_reuse_port_set() is defined in OS specific files
 
 // tcs_opt_membership_add() is defined in OS specific files
 // tcs_opt_membership_add_to() is defined in OS specific files
@@ -418,23 +418,69 @@ fn C.tcs_send(...voidptr) Result
 // * - TcsResult tcs_send_to(TcsSocket socket_ctx, const uint8_t* buffer, size_t buffer_size, uint32_t flags, const struct TcsAddress* destination_address, size_t* bytes_sent);
 fn C.tcs_send_to(...voidptr) Result
 // * - TcsResult tcs_sendv(TcsSocket socket_ctx, const struct TcsBuffer* buffers, size_t buffer_count, uint32_t flags, size_t* bytes_sent);
+// * - TcsResult tcs_send_to_batch(TcsSocket socket_ctx, const struct TcsDatagram* datagrams, size_t datagram_count, uint32_t flags, size_t* datagrams_sent);
 // * - TcsResult tcs_send_netstring(TcsSocket socket_ctx, const uint8_t* buffer, size_t buffer_size);
 // * - TcsResult tcs_receive(TcsSocket socket_ctx, uint8_t* buffer, size_t buffer_size, uint32_t flags, size_t* bytes_received);
 fn C.tcs_receive(...voidptr) Result
 // * - TcsResult tcs_receive_from(TcsSocket socket_ctx, uint8_t* buffer, size_t buffer_size, uint32_t flags, struct TcsAddress* source_address, size_t* bytes_received);
 fn  C.tcs_receive_from(...voidptr) Result
+// * - TcsResult tcs_receive_from_batch(TcsSocket socket_ctx, struct TcsDatagram* datagrams, size_t datagram_count, uint32_t flags, size_t* datagrams_received);
 // * - TcsResult tcs_receive_line(TcsSocket socket_ctx, uint8_t* buffer, size_t buffer_size, size_t* bytes_received, uint8_t delimiter);
 fn C.tcs_receive_line(...voidptr) Result
 // * - TcsResult tcs_receive_netstring(TcsSocket socket_ctx, uint8_t* buffer, size_t buffer_size, size_t* bytes_received);
+// *
+// * Zero-copy Transfer:
+// * - TcsResult tcs_sendfile(TcsSocket socket_ctx, int file_descriptor, int64_t* offset, size_t count, uint32_t flags, size_t* bytes_sent);
+// * - TcsResult tcs_splice_create(struct TcsSplice** splice);
+// * - TcsResult tcs_splice_destroy(struct TcsSplice** splice);
+// * - TcsResult tcs_splice(struct TcsSplice* splice, TcsSocket from_socket_ctx, TcsSocket to_socket_ctx, size_t count, uint32_t flags, size_t* bytes_moved);
+// * - TcsResult tcs_send_zerocopy(TcsSocket socket_ctx, const uint8_t* buffer, size_t buffer_size, uint32_t flags, size_t* bytes_sent);
+// * - TcsResult tcs_zerocopy_completions(TcsSocket socket_ctx, uint32_t* first_id, uint32_t* last_id, bool* was_copied);
+// *
+// * Buffered Reading:
+// * - TcsResult tcs_reader_create(struct TcsReader** reader, TcsSocket socket_ctx, size_t buffer_size);
+// * - TcsResult tcs_reader_destroy(struct TcsReader** reader);
+// * - size_t tcs_reader_buffered(const struct TcsReader* reader);
+// * - TcsResult tcs_reader_receive_line(struct TcsReader* reader, uint8_t* buffer, size_t buffer_size, size_t* bytes_received, uint8_t delimiter);
+// * - TcsResult tcs_reader_receive_netstring(struct TcsReader* reader, uint8_t* buffer, size_t buffer_size, size_t* bytes_received);
+// * - TcsResult tcs_reader_receive_exact(struct TcsReader* reader, uint8_t* buffer, size_t length);
+// * - TcsResult tcs_reader_peek(struct TcsReader* reader, size_t length, const uint8_t** data);
+// * - TcsResult tcs_reader_peek_line(struct TcsReader* reader, const uint8_t** line, size_t* line_size, uint8_t delimiter);
+// * - TcsResult tcs_reader_peek_netstring(struct TcsReader* reader, const uint8_t** data, size_t* data_size, size_t* frame_size);
+// * - TcsResult tcs_reader_skip(struct TcsReader* reader, size_t length);
 //
 // *
 // * Socket Pooling:
 // * - TcsResult tcs_pool_create(struct TcsPool** pool);
+// * - TcsResult tcs_pool_create_backend(struct TcsPool** pool, TcsPoolBackend backend);
 // * - TcsResult tcs_pool_destroy(struct TcsPool** pool);
 // * - TcsResult tcs_pool_add(struct TcsPool* pool, TcsSocket socket_ctx, void* user_data, bool poll_can_read, bool poll_can_write, bool poll_error);
 // * - TcsResult tcs_pool_remove(struct TcsPool* pool, TcsSocket socket_ctx);
 // * - TcsResult tcs_pool_poll(struct TcsPool* pool, struct TcsPollEvent* events, size_t events_count, size_t* events_populated, int64_t timeout_in_ms);
 // *
+// * Async I/O (io_uring on Linux, TcsPool elsewhere):
+// * - TcsResult tcs_ring_create(struct TcsRing** ring, unsigned int queue_depth, bool try_io_uring);
+// * - TcsResult tcs_ring_destroy(struct TcsRing** ring);
+// * - bool tcs_ring_is_io_uring(const struct TcsRing* ring);
+// * - TcsResult tcs_ring_buffers_register(struct TcsRing* ring, uint8_t* memory, size_t buffer_size, size_t buffer_count);
+// * - TcsResult tcs_ring_buffer_release(struct TcsRing* ring, int buffer_id);
+// * - TcsResult tcs_ring_send(struct TcsRing* ring, TcsSocket socket_ctx, const uint8_t* buffer, size_t buffer_size, void* user_data);
+// * - TcsResult tcs_ring_receive(struct TcsRing* ring, TcsSocket socket_ctx, uint8_t* buffer, size_t buffer_size, void* user_data);
+// * - TcsResult tcs_ring_receive_multishot(struct TcsRing* ring, TcsSocket socket_ctx, void* user_data);
+// * - TcsResult tcs_ring_accept(struct TcsRing* ring, TcsSocket socket_ctx, bool multishot, void* user_data);
+// * - TcsResult tcs_ring_cancel(struct TcsRing* ring, TcsSocket socket_ctx);
+// * - TcsResult tcs_ring_submit(struct TcsRing* ring);
+// * - TcsResult tcs_ring_wait(struct TcsRing* ring, struct TcsRingCompletion* completions, size_t completions_count, size_t* completions_populated, int64_t timeout_in_ms);
+// *
+// * Server Runtime:
+// * - TcsResult tcs_server_create(struct TcsServer** server, const struct TcsServerConfig* config, const struct TcsServerCallbacks* callbacks, void* user_data);
+// * - TcsResult tcs_server_start(struct TcsServer* server);
+// * - TcsResult tcs_server_stop(struct TcsServer* server, int64_t drain_timeout_ms);
+// * - TcsResult tcs_server_destroy(struct TcsServer** server);
+// * - TcsResult tcs_server_address(const struct TcsServer* server, struct TcsAddress* local_address);
+// * - void* tcs_server_user_data(const struct TcsServer* server);
+// * - size_t tcs_server_connection_count(const struct TcsServer* server);
+// *
 // * Socket Options:
 // * - TcsResult tcs_opt_set(TcsSocket socket_ctx, int32_t level, int32_t option_name, const void* option_value, size_t option_size);
 // * - TcsResult tcs_opt_get(TcsSocket socket_ctx, int32_t level, int32_t option_name, void* option_value, size_t* option_size);
@@ -446,6 +492,7 @@ fn C.tcs_opt_broadcast_set(...voidptr) Result
 // * - TcsResult tcs_opt_reuse_address_set(TcsSocket socket_ctx, bool do_allow_reuse_address);
 fn C.tcs_opt_reuse_address_set(...voidptr) Result
 // * - TcsResult tcs_opt_reuse_address_get(TcsSocket socket_ctx, bool* is_reuse_address_allowed);
+// * - TcsResult tcs_opt_reuse_port_set(TcsSocket socket_ctx, bool do_allow_reuse_port);
 // * - TcsResult tcs_opt_send_buffer_size_set(TcsSocket socket_ctx, size_t send_buffer_size);
 // * - TcsResult tcs_opt_send_buffer_size_get(TcsSocket socket_ctx, size_t* send_buffer_size);
 // * - TcsResult tcs_opt_receive_buffer_size_set(TcsSocket socket_ctx, size_t receive_buffer_size);
@@ -463,6 +510,8 @@ fn C.tcs_opt_receive_timeout_set(...voidptr) Result
 // * - TcsResult tcs_opt_priority_get(TcsSocket socket_ctx, int* priority);
 // * - TcsResult tcs_opt_nonblocking_set(TcsSocket socket_ctx, bool do_nonblocking);
 // * - TcsResult tcs_opt_nonblocking_get(TcsSocket socket_ctx, bool* is_nonblocking);
+// * - TcsResult tcs_opt_udp_gro_set(TcsSocket socket_ctx, bool do_gro);
+// * - TcsResult tcs_opt_zerocopy_set(TcsSocket socket_ctx, bool do_zerocopy);
 // * - TcsResult tcs_opt_membership_add(TcsSocket socket_ctx, const struct TcsAddress* multicast_address);
 // * - TcsResult tcs_opt_membership_add_to(TcsSocket socket_ctx, const struct TcsAddress* local_address, const struct TcsAddress* multicast_address);
 // * - TcsResult tcs_opt_membership_drop(TcsSocket socket_ctx, const struct TcsAddress* multicast_address);